@@ -15,6 +15,7 @@ using boost::assign::map_list_of;
 #include <evaluation/util/CartesianProductParameterSetGenerator.h>
 using namespace evaluation;
 
+#include <rafl/core/CompiledForest.h>
 #include <rafl/examples/ExampleUtil.h>
 #include <rafl/examples/UnitCircleExampleGenerator.h>
 using namespace rafl;
@@ -22,6 +23,7 @@ using namespace rafl;
 #include <raflevaluation/RandomForestEvaluator.h>
 using namespace raflevaluation;
 
+#include <tvgutil/containers/MapUtil.h>
 #include <tvgutil/timing/Timer.h>
 #include <tvgutil/timing/TimeUtil.h>
 using namespace tvgutil;
@@ -33,6 +35,55 @@ typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
 
 //#################### FUNCTIONS ####################
 
+/**
+ * \brief Compares the time taken to predict labels for a set of examples using a live random forest and a compiled version of it.
+ *
+ * \param examples  The examples.
+ * \param params    The parameter set with which to train the random forest.
+ */
+static void benchmark_prediction(const std::vector<Example_CPtr>& examples, const ParamSet& params)
+{
+  // Train a random forest on the examples.
+  size_t splitBudget, treeCount;
+  MapUtil::typed_lookup(params, "splitBudget", splitBudget);
+  MapUtil::typed_lookup(params, "treeCount", treeCount);
+  RandomForest<Label> forest(treeCount, DecisionTree<Label>::Settings(params));
+  forest.add_examples(examples);
+  forest.train(splitBudget);
+
+  // Pack the example descriptors into a single row-major feature array.
+  const size_t descriptorCount = examples.size();
+  const size_t featureCount = examples[0]->get_descriptor()->size();
+  std::vector<float> features;
+  features.reserve(descriptorCount * featureCount);
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    const Descriptor& descriptor = *examples[i]->get_descriptor();
+    features.insert(features.end(), descriptor.begin(), descriptor.end());
+  }
+
+  // Predict labels for the examples using the live forest.
+  std::vector<Label> liveLabels(descriptorCount), compiledLabels(descriptorCount);
+  Timer<boost::chrono::microseconds> liveTimer("LivePrediction");
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    liveLabels[i] = forest.predict(examples[i]->get_descriptor());
+  }
+  liveTimer.stop();
+
+  // Compile the forest and predict labels for the examples using the compiled forest.
+  Timer<boost::chrono::microseconds> compileTimer("Compilation");
+  CompiledForest<Label> compiledForest(forest);
+  compileTimer.stop();
+
+  Timer<boost::chrono::microseconds> compiledTimer("CompiledPrediction");
+  compiledForest.predict_batch(&features[0], descriptorCount, featureCount, &compiledLabels[0]);
+  compiledTimer.stop();
+
+  std::cout << liveTimer << '\n' << compileTimer << '\n' << compiledTimer << '\n';
+  std::cout << "Compiled predictions match: " << (liveLabels == compiledLabels ? "yes" : "no") << "\n\n";
+}
+
 int main(int argc, char *argv[])
 {
 #if WITH_OPENMP
@@ -158,6 +209,9 @@ int main(int argc, char *argv[])
   timer.stop();
   std::cout << timer << '\n';
 
+  // Compare the prediction speed of the live and compiled forests.
+  benchmark_prediction(examples, params[0]);
+
   // Output the performance table to the screen.
   results.output(std::cout);
 
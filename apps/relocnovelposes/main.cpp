@@ -12,6 +12,7 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include "orx/geometry/PoseProximityIndex.h"
 #include "tvgutil/filesystem/PathFinder.h"
 #include "tvgutil/timing/TimeUtil.h"
 
@@ -180,6 +181,9 @@ std::vector<BinnedPoses> classify_poses(
 
   res.resize(thresholds.size() + 1);
 
+  // Index the training poses, so that we can quickly find the ones that are close to each test pose.
+  const orx::PoseProximityIndex trainIndex(trainPoses);
+
   // For each test pose:
 #ifdef WITH_OPENMP
   #pragma omp parallel for
@@ -198,25 +202,22 @@ std::vector<BinnedPoses> classify_poses(
     Eigen::Matrix4f closestTrainPose;
     closestTrainPose.setConstant(std::numeric_limits<float>::quiet_NaN());
 
-    // Determine a difficulty bin for the test.
+    // Determine a difficulty bin for the test, namely the first bin whose thresholds are satisfied by at least one training pose.
+    // Note: The training pose recorded is the lowest-indexed one that satisfies the thresholds of the chosen bin. There could be
+    //       a closer one, but it's gonna be in the same bin, that is what we care about.
     size_t chosenBin = thresholds.size();
-    for (size_t trainIndex = 0, trainCount = trainPoses.size(); trainIndex < trainCount; ++trainIndex)
+    for (size_t binIndex = 0; binIndex < thresholds.size(); ++binIndex)
     {
-      const Eigen::Matrix4f& trainPose = trainPoses[trainIndex];
-      for (size_t binIndex = 0; binIndex < chosenBin; ++binIndex)
+      const std::vector<size_t> matchingTrainIndices = trainIndex.find_within(testPose,
+          thresholds[binIndex].translationMaxError,
+          thresholds[binIndex].angleMaxError);
+
+      if (!matchingTrainIndices.empty())
       {
-        if (pose_matches(trainPose, testPose,
-            thresholds[binIndex].translationMaxError,
-            thresholds[binIndex].angleMaxError))
-        {
-          if(binIndex < chosenBin)
-          {
-            closestTrainPose = trainPose; // There could be a closer one, but it's gonna be in the same bin, that is what we care about.
-            closestTrainingIdx = trainIndex;
-            chosenBin = binIndex;
-            break;
-          }
-        }
+        closestTrainingIdx = matchingTrainIndices.front();
+        closestTrainPose = trainPoses[closestTrainingIdx];
+        chosenBin = binIndex;
+        break;
       }
     }
 
@@ -0,0 +1,452 @@
+/**
+ * relocopt: RelocaliserEvaluator.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include "RelocaliserEvaluator.h"
+using namespace ORUtils;
+using namespace evaluation;
+using namespace grove;
+using namespace orx;
+using namespace tvgutil;
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/format.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <Eigen/Geometry>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <ITMLib/Engines/ViewBuilding/Shared/ITMViewBuilder_Shared.h>
+#include <ITMLib/Objects/Camera/ITMCalibIO.h>
+
+#include <grove/forests/DecisionForestFactory.h>
+#include <grove/relocalisation/ScoreRelocaliserFactory.h>
+
+#include <orx/base/MemoryBlockFactory.h>
+#include <orx/persistence/ImagePersister.h>
+
+#include <tvgutil/misc/ConcurrencyUtil.h>
+#include <tvgutil/timing/AverageTimer.h>
+
+namespace bf = boost::filesystem;
+
+namespace relocopt {
+
+//#################### ANONYMOUS FREE FUNCTIONS ####################
+
+namespace {
+
+/**
+ * \brief Checks whether a pose matrix is within 5cm/5deg of a ground truth pose matrix (the 7-Scenes criterion).
+ *
+ * \param gtPose    The ground truth pose matrix.
+ * \param testPose  The candidate pose matrix.
+ * \return          true, if the candidate pose is within 5cm/5deg of the ground truth pose, or false otherwise.
+ */
+bool pose_matches(const Matrix4f& gtPose, const Matrix4f& testPose)
+{
+  static const float translationMaxError = 0.05f;
+  static const float angleMaxError = 5.0f * static_cast<float>(M_PI) / 180.0f;
+
+  // Both our Matrix type and Eigen's are column major, so we can just use Map here.
+  const Eigen::Map<const Eigen::Matrix4f> gtPoseEigen(gtPose.m);
+  const Eigen::Map<const Eigen::Matrix4f> testPoseEigen(testPose.m);
+
+  const Eigen::Matrix3f gtR = gtPoseEigen.block<3,3>(0, 0);
+  const Eigen::Matrix3f testR = testPoseEigen.block<3,3>(0, 0);
+  const Eigen::Vector3f gtT = gtPoseEigen.block<3,1>(0, 3);
+  const Eigen::Vector3f testT = testPoseEigen.block<3,1>(0, 3);
+
+  const float translationError = (gtT - testT).norm();
+  const float angleError = Eigen::AngleAxisf(testR * gtR.transpose()).angle();
+
+  return translationError <= translationMaxError && angleError <= angleMaxError;
+}
+
+/**
+ * \brief Prepares the images to pass to the relocaliser for the specified frame.
+ *
+ * \param frameRgbImage       The frame's colour image (on the CPU only).
+ * \param frameRawDepthImage  The frame's raw depth image (on the CPU only).
+ * \param depthCalibParams    The parameters used to convert the raw depth values to metres.
+ * \param rgbImage            The image into which to copy the frame's colour image.
+ * \param depthImage          The image into which to write the frame's depth image (in metres).
+ */
+void prepare_images(const ORUChar4Image_CPtr& frameRgbImage, const ORShortImage_CPtr& frameRawDepthImage, const Vector2f& depthCalibParams,
+                    const ORUChar4Image_Ptr& rgbImage, const ORFloatImage_Ptr& depthImage)
+{
+  rgbImage->ChangeDims(frameRgbImage->noDims);
+  rgbImage->SetFrom(frameRgbImage.get(), ORUtils::MemoryBlock<Vector4u>::CPU_TO_CPU);
+  rgbImage->UpdateDeviceFromHost();
+
+  const Vector2i depthDims = frameRawDepthImage->noDims;
+  depthImage->ChangeDims(depthDims);
+  const short *rawDepth = frameRawDepthImage->GetData(MEMORYDEVICE_CPU);
+  float *depth = depthImage->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = 0; y < depthDims.y; ++y)
+  {
+    for(int x = 0; x < depthDims.x; ++x)
+    {
+      convertDepthAffineToFloat(depth, x, y, rawDepth, depthDims, depthCalibParams);
+    }
+  }
+
+  depthImage->UpdateDeviceFromHost();
+}
+
+/**
+ * \brief Reads a 4x4 pose matrix from a text file.
+ *
+ * \param path  The path to the text file.
+ * \return      The pose matrix.
+ *
+ * \throws std::runtime_error If the file has the wrong format.
+ */
+Matrix4f read_pose_from_file(const bf::path& path)
+{
+  std::ifstream fs(path.string().c_str());
+
+  Matrix4f m;
+  fs >> m(0,0) >> m(1,0) >> m(2,0) >> m(3,0);
+  fs >> m(0,1) >> m(1,1) >> m(2,1) >> m(3,1);
+  fs >> m(0,2) >> m(1,2) >> m(2,2) >> m(3,2);
+  fs >> m(0,3) >> m(1,3) >> m(2,3) >> m(3,3);
+
+  if(!fs) throw std::runtime_error("Error: Could not read a pose matrix from '" + path.string() + "'");
+
+  return m;
+}
+
+}
+
+//#################### CONSTRUCTORS ####################
+
+RelocaliserEvaluator::RelocaliserEvaluator(const bf::path& datasetDir, const std::vector<std::string>& sequenceNames,
+                                           const std::string& trainingSplitName, const std::string& validationSplitName,
+                                           const SettingsContainer_CPtr& baseSettings, DeviceType deviceType,
+                                           size_t threadCount, const bf::path& logPath)
+: m_baseSettings(baseSettings), m_deviceType(deviceType), m_logPath(logPath), m_threadCount(std::max<size_t>(threadCount, 1))
+{
+  // Read in the camera calibration parameters (these are shared by all of the sequences).
+  ITMLib::ITMRGBDCalib calib;
+  const bf::path calibPath = datasetDir / "calib.txt";
+  if(!ITMLib::readRGBDCalib(calibPath.string().c_str(), calib))
+  {
+    throw std::runtime_error("Error: Could not read the calibration parameters from '" + calibPath.string() + "'");
+  }
+
+  // Load the frames of each sequence.
+  for(size_t i = 0, size = sequenceNames.size(); i < size; ++i)
+  {
+    Sequence sequence;
+    sequence.depthCalibParams = calib.disparityCalib.GetParams();
+    sequence.depthIntrinsics = calib.intrinsics_d.projectionParamsSimple.all;
+    sequence.name = sequenceNames[i];
+
+    std::cout << "Loading sequence '" << sequence.name << "'...\n";
+    sequence.trainingFrames = load_frames(datasetDir / sequence.name / trainingSplitName);
+    sequence.validationFrames = load_frames(datasetDir / sequence.name / validationSplitName);
+
+    m_sequences.push_back(sequence);
+  }
+
+  // Load the pre-trained forest. The relocalisers we make later will share this rather than each loading their own copy.
+  const std::string modelFilename = m_baseSettings->get_first_value<std::string>("ScoreRelocaliser.modelFilename");
+  m_forest = DecisionForestFactory<ScoreForestRelocaliser::DescriptorType,ScoreForestRelocaliser::FOREST_TREE_COUNT>::make_shared_forest(modelFilename, deviceType);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+float RelocaliserEvaluator::evaluate(const ParamSet& params)
+{
+  return evaluate_batch(std::vector<ParamSet>(1, params))[0];
+}
+
+std::vector<float> RelocaliserEvaluator::evaluate_batch(const std::vector<ParamSet>& paramSets)
+{
+  const size_t paramSetCount = paramSets.size();
+  const size_t sequenceCount = m_sequences.size();
+  std::vector<float> costs(paramSetCount);
+
+  // Look up any parameter sets whose costs have already been computed, and make the settings for the others.
+  // Note that a parameter set can appear more than once in a batch, in which case we only evaluate it once.
+  std::vector<std::string> keys(paramSetCount);
+  std::set<std::string> pendingKeys;
+  std::vector<size_t> pending;
+  std::vector<SettingsContainer_CPtr> settings;
+
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    for(size_t i = 0; i < paramSetCount; ++i)
+    {
+      keys[i] = ParamSetUtil::param_set_to_string(paramSets[i]);
+      std::map<std::string,float>::const_iterator jt = m_costCache.find(keys[i]);
+      if(jt != m_costCache.end()) costs[i] = jt->second;
+      else if(pendingKeys.insert(keys[i]).second)
+      {
+        pending.push_back(i);
+        settings.push_back(make_settings(paramSets[i]));
+      }
+    }
+  }
+
+  if(pending.empty()) return costs;
+
+  // Evaluate each (pending parameter set, sequence) pair as a separate task.
+  std::vector<SequenceResult> results(pending.size() * sequenceCount);
+  const boost::chrono::steady_clock::time_point batchStart = boost::chrono::steady_clock::now();
+  ConcurrencyUtil::run_tasks(results.size(), m_threadCount, boost::bind(&RelocaliserEvaluator::evaluate_task, this, _1, boost::cref(settings), boost::ref(results)));
+  const float batchSeconds = boost::chrono::duration<float>(boost::chrono::steady_clock::now() - batchStart).count();
+
+  // The timings of the tasks were measured while other tasks were running concurrently, and so are inflated by an amount
+  // that depends on the number of worker threads. To stop the budget penalty (and hence the optimum) from depending on
+  // the thread count, we re-time each parameter set that appears to have exceeded its budget with nothing else running.
+  // Contention only ever slows a task down, so a parameter set that met its budget under contention would also have met
+  // it in isolation, and need not be re-timed.
+  if(m_threadCount > 1 && results.size() > 1)
+  {
+    for(size_t p = 0, size = pending.size(); p < size; ++p)
+    {
+      if(!exceeds_budget(results, p)) continue;
+
+      for(size_t s = 0; s < sequenceCount; ++s)
+      {
+        // Note: We keep the correct frame counts from the concurrent run, and only replace the timings.
+        SequenceResult& result = results[p * sequenceCount + s];
+        const SequenceResult isolatedResult = evaluate_on_sequence(settings[p], m_sequences[s]);
+        result.relocalisationMicroseconds = isolatedResult.relocalisationMicroseconds;
+        result.trainingMicroseconds = isolatedResult.trainingMicroseconds;
+        result.updateMicroseconds = isolatedResult.updateMicroseconds;
+      }
+    }
+  }
+
+  // Compute the costs of the pending parameter sets from the results, and update the cache and log accordingly.
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+
+  std::ofstream logStream;
+  if(!m_logPath.empty()) logStream.open(m_logPath.string().c_str(), std::ios::app);
+
+  for(size_t p = 0, size = pending.size(); p < size; ++p)
+  {
+    float relocLoss = 0.0f;
+    for(size_t s = 0; s < sequenceCount; ++s)
+    {
+      const SequenceResult& result = results[p * sequenceCount + s];
+      const size_t validationFrameCount = std::max<size_t>(m_sequences[s].validationFrames.size(), 1);
+      const float fractionCorrect = static_cast<float>(result.correctFrameCount) / validationFrameCount;
+      relocLoss += (1.0f - fractionCorrect) * (1.0f - fractionCorrect);
+    }
+
+    double trainingTime, relocalisationTime, updateTime;
+    compute_average_timings(results, p, trainingTime, relocalisationTime, updateTime);
+
+    // If we ran past the computation budget, penalise the cost.
+    float cost = relocLoss;
+    if(exceeds_budget(results, p)) cost += 100.0f;
+
+    const std::string& key = keys[pending[p]];
+    m_costCache[key] = cost;
+
+    // Note: ICP is not used when evaluating in-process, so we log its loss and timing as the pre-ICP values and zero respectively.
+    //       The total time logged is the wall-clock time taken to evaluate the whole batch.
+    if(logStream)
+    {
+      logStream << cost << ';'
+                << batchSeconds << ';'
+                << relocLoss << ';'
+                << relocLoss << ';'
+                << trainingTime << ';'
+                << updateTime << ';'
+                << relocalisationTime << ';'
+                << 0 << ';'
+                << relocalisationTime << ';'
+                << key << '\n';
+    }
+  }
+
+  // Fill in the costs of the parameter sets that were evaluated as part of this batch.
+  for(size_t i = 0; i < paramSetCount; ++i)
+  {
+    if(pendingKeys.find(keys[i]) != pendingKeys.end()) costs[i] = m_costCache[keys[i]];
+  }
+
+  return costs;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void RelocaliserEvaluator::compute_average_timings(const std::vector<SequenceResult>& results, size_t paramSetIndex,
+                                                   double& trainingTime, double& relocalisationTime, double& updateTime) const
+{
+  const size_t sequenceCount = m_sequences.size();
+  trainingTime = relocalisationTime = updateTime = 0.0;
+
+  for(size_t s = 0; s < sequenceCount; ++s)
+  {
+    const Sequence& sequence = m_sequences[s];
+    const SequenceResult& result = results[paramSetIndex * sequenceCount + s];
+    const size_t trainingFrameCount = std::max<size_t>(sequence.trainingFrames.size(), 1);
+    const size_t validationFrameCount = std::max<size_t>(sequence.validationFrames.size(), 1);
+
+    trainingTime += result.trainingMicroseconds / trainingFrameCount;
+    relocalisationTime += result.relocalisationMicroseconds / validationFrameCount;
+    updateTime += result.updateMicroseconds / validationFrameCount;
+  }
+
+  // Average the timings over the sequences (as the evaluation script does).
+  if(sequenceCount > 0)
+  {
+    trainingTime /= sequenceCount;
+    relocalisationTime /= sequenceCount;
+    updateTime /= sequenceCount;
+  }
+}
+
+RelocaliserEvaluator::SequenceResult RelocaliserEvaluator::evaluate_on_sequence(const SettingsContainer_CPtr& settings, const Sequence& sequence) const
+{
+  SequenceResult result;
+
+  // Make the relocaliser.
+  ScoreRelocaliser_Ptr relocaliser = ScoreRelocaliserFactory::make_score_relocaliser("forest", "ScoreRelocaliser.", settings, m_deviceType);
+
+  // Allocate the images that will be passed to the relocaliser (these are per-task, so that the tasks can run concurrently).
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  ORUChar4Image_Ptr rgbImage = mbf.make_image<Vector4u>();
+  ORFloatImage_Ptr depthImage = mbf.make_image<float>();
+
+  AverageTimer<boost::chrono::microseconds> trainingTimer("Training");
+  AverageTimer<boost::chrono::microseconds> relocalisationTimer("Relocalisation");
+  AverageTimer<boost::chrono::microseconds> updateTimer("Update");
+
+  // Train the relocaliser on the training frames.
+  for(size_t i = 0, size = sequence.trainingFrames.size(); i < size; ++i)
+  {
+    const Frame& frame = sequence.trainingFrames[i];
+    prepare_images(frame.rgbImage, frame.rawDepthImage, sequence.depthCalibParams, rgbImage, depthImage);
+
+    trainingTimer.start_sync();
+    relocaliser->train(rgbImage.get(), depthImage.get(), sequence.depthIntrinsics, frame.cameraPose);
+    trainingTimer.stop_sync();
+  }
+
+  // Relocalise each of the validation frames, updating the relocaliser after each one (as the pipeline would).
+  for(size_t i = 0, size = sequence.validationFrames.size(); i < size; ++i)
+  {
+    const Frame& frame = sequence.validationFrames[i];
+    prepare_images(frame.rgbImage, frame.rawDepthImage, sequence.depthCalibParams, rgbImage, depthImage);
+
+    relocalisationTimer.start_sync();
+    std::vector<Relocaliser::Result> relocaliserResults = relocaliser->relocalise(rgbImage.get(), depthImage.get(), sequence.depthIntrinsics);
+    relocalisationTimer.stop_sync();
+
+    if(!relocaliserResults.empty() && pose_matches(frame.cameraPose.GetInvM(), relocaliserResults[0].pose.GetInvM()))
+    {
+      ++result.correctFrameCount;
+    }
+
+    updateTimer.start_sync();
+    relocaliser->update();
+    updateTimer.stop_sync();
+  }
+
+  result.trainingMicroseconds = static_cast<double>(trainingTimer.total_duration().count());
+  result.relocalisationMicroseconds = static_cast<double>(relocalisationTimer.total_duration().count());
+  result.updateMicroseconds = static_cast<double>(updateTimer.total_duration().count());
+
+  return result;
+}
+
+bool RelocaliserEvaluator::exceeds_budget(const std::vector<SequenceResult>& results, size_t paramSetIndex) const
+{
+  static const double maxTrainingTime = 10000.0;        // 10ms
+  static const double maxRelocalisationTime = 150000.0; // 150ms
+  static const double maxUpdateTime = 10000.0;          // 10ms
+
+  double trainingTime, relocalisationTime, updateTime;
+  compute_average_timings(results, paramSetIndex, trainingTime, relocalisationTime, updateTime);
+  return trainingTime > maxTrainingTime || relocalisationTime > maxRelocalisationTime || updateTime > maxUpdateTime;
+}
+
+void RelocaliserEvaluator::evaluate_task(size_t taskIndex, const std::vector<SettingsContainer_CPtr>& settings, std::vector<SequenceResult>& results) const
+{
+  const size_t sequenceCount = m_sequences.size();
+  const SettingsContainer_CPtr& taskSettings = settings[taskIndex / sequenceCount];
+  const Sequence& sequence = m_sequences[taskIndex % sequenceCount];
+
+#ifdef WITH_OPENMP
+  // Divide the cores between the worker threads, rather than letting each of them spawn a full team of OpenMP threads.
+  // Note: The task may be running on the calling thread, so its OpenMP thread count must be restored afterwards.
+  const int ompThreadCount = omp_get_max_threads();
+  omp_set_num_threads(std::max(ompThreadCount / static_cast<int>(m_threadCount), 1));
+  try
+  {
+    results[taskIndex] = evaluate_on_sequence(taskSettings, sequence);
+  }
+  catch(...)
+  {
+    omp_set_num_threads(ompThreadCount);
+    throw;
+  }
+  omp_set_num_threads(ompThreadCount);
+#else
+  results[taskIndex] = evaluate_on_sequence(taskSettings, sequence);
+#endif
+}
+
+SettingsContainer_CPtr RelocaliserEvaluator::make_settings(const ParamSet& params) const
+{
+  SettingsContainer_Ptr settings(new SettingsContainer(*m_baseSettings));
+  for(ParamSet::const_iterator it = params.begin(), iend = params.end(); it != iend; ++it)
+  {
+    settings->set_value(it->first, it->second);
+  }
+  return settings;
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+std::vector<RelocaliserEvaluator::Frame> RelocaliserEvaluator::load_frames(const bf::path& dir)
+{
+  if(!bf::is_directory(dir)) throw std::runtime_error("Error: The directory '" + dir.string() + "' does not exist");
+
+  std::vector<Frame> frames;
+  for(int i = 0;; ++i)
+  {
+    const std::string stem = (boost::format("frame-%06d") % i).str();
+    const bf::path depthPath = dir / (stem + ".depth.png");
+    const bf::path posePath = dir / (stem + ".pose.txt");
+    const bf::path rgbPath = dir / (stem + ".color.png");
+    if(!bf::is_regular(depthPath) || !bf::is_regular(posePath) || !bf::is_regular(rgbPath)) break;
+
+    Frame frame;
+
+    // Note: The pose files store the inverse camera poses.
+    frame.cameraPose.SetInvM(read_pose_from_file(posePath));
+    frame.rawDepthImage = ImagePersister::load_short_image(depthPath.string());
+    frame.rgbImage = ImagePersister::load_rgba_image(rgbPath.string());
+
+    frames.push_back(frame);
+  }
+
+  if(frames.empty()) throw std::runtime_error("Error: The directory '" + dir.string() + "' does not contain any frames");
+
+  return frames;
+}
+
+}
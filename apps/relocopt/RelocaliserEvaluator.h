@@ -0,0 +1,239 @@
+/**
+ * relocopt: RelocaliserEvaluator.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#ifndef H_RELOCOPT_RELOCALISEREVALUATOR
+#define H_RELOCOPT_RELOCALISEREVALUATOR
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <ORUtils/SE3Pose.h>
+
+#include <evaluation/core/ParamSetUtil.h>
+
+#include <grove/relocalisation/interface/ScoreForestRelocaliser.h>
+
+#include <orx/base/ORImagePtrTypes.h>
+
+#include <tvgutil/misc/SettingsContainer.h>
+
+namespace relocopt {
+
+/**
+ * \brief An instance of this class can be used to evaluate the cost of a relocaliser parameter set in-process.
+ *
+ * The frames of the training and validation splits of each sequence are loaded from disk once, when the evaluator is
+ * constructed, and the pre-trained forest is loaded once and shared by all of the relocalisers that the evaluator makes.
+ * Evaluating a parameter set then involves making one SCoRe relocaliser per sequence (configured using the parameter
+ * set), training it on the training split and relocalising each frame of the validation split. The (parameter set,
+ * sequence) pairs of a batch are evaluated concurrently by a set of worker threads, and the costs of parameter sets
+ * that have already been evaluated are cached, so that optimisers that revisit a parameter set do not pay for it twice.
+ *
+ * The cost computed is the same as that computed by the evaluate_relocaliser script (using the relocalisation results
+ * prior to any ICP refinement): the sum over all sequences of (1 - fraction of validation frames relocalised to within
+ * 5cm/5deg)^2, plus a penalty of 100 if the average training, relocalisation or update time exceeds its budget. Since
+ * timings measured while other tasks are running are inflated, any parameter set that appears to exceed its budget is
+ * re-timed in isolation before being penalised, so that the costs do not depend on the number of worker threads.
+ */
+class RelocaliserEvaluator
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a single RGB-D frame in a sequence.
+   */
+  struct Frame
+  {
+    /** The ground truth camera pose for the frame. */
+    ORUtils::SE3Pose cameraPose;
+
+    /** The raw depth image for the frame (on the CPU only). */
+    ORShortImage_Ptr rawDepthImage;
+
+    /** The colour image for the frame (on the CPU only). */
+    ORUChar4Image_Ptr rgbImage;
+  };
+
+  /**
+   * \brief An instance of this struct represents a sequence on which to evaluate the relocaliser.
+   */
+  struct Sequence
+  {
+    /** The parameters used to convert the raw depth values to metres. */
+    Vector2f depthCalibParams;
+
+    /** The depth camera intrinsics. */
+    Vector4f depthIntrinsics;
+
+    /** The name of the sequence. */
+    std::string name;
+
+    /** The frames on which to train the relocaliser. */
+    std::vector<Frame> trainingFrames;
+
+    /** The frames on which to test the relocaliser. */
+    std::vector<Frame> validationFrames;
+  };
+
+  /**
+   * \brief An instance of this struct represents the results of evaluating a relocaliser on a single sequence.
+   */
+  struct SequenceResult
+  {
+    /** The number of validation frames that were relocalised correctly. */
+    size_t correctFrameCount;
+
+    /** The total time spent relocalising the validation frames (in microseconds). */
+    double relocalisationMicroseconds;
+
+    /** The total time spent training the relocaliser (in microseconds). */
+    double trainingMicroseconds;
+
+    /** The total time spent updating the relocaliser (in microseconds). */
+    double updateMicroseconds;
+
+    SequenceResult()
+    : correctFrameCount(0), relocalisationMicroseconds(0.0), trainingMicroseconds(0.0), updateMicroseconds(0.0)
+    {}
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The settings on which the settings for each parameter set are based. */
+  tvgutil::SettingsContainer_CPtr m_baseSettings;
+
+  /** A cache of the costs of the parameter sets that have already been evaluated (indexed by their string representations). */
+  std::map<std::string,float> m_costCache;
+
+  /** The device on which the relocalisers should operate. */
+  ORUtils::DeviceType m_deviceType;
+
+  /** The pre-trained forest, held so that it remains loaded for the lifetime of the evaluator. */
+  grove::ScoreForestRelocaliser::ScoreForest_Ptr m_forest;
+
+  /** The file to which to log the results of each evaluation (if any). */
+  boost::filesystem::path m_logPath;
+
+  /** The synchronisation mutex. */
+  mutable boost::mutex m_mutex;
+
+  /** The sequences on which to evaluate the relocaliser. */
+  std::vector<Sequence> m_sequences;
+
+  /** The number of worker threads to use. */
+  size_t m_threadCount;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a relocaliser evaluator.
+   *
+   * \param datasetDir          The dataset directory (containing a calib.txt file and one subdirectory per sequence).
+   * \param sequenceNames       The names of the sequences on which to evaluate the relocaliser.
+   * \param trainingSplitName   The name of the split (within each sequence directory) on which to train the relocaliser.
+   * \param validationSplitName The name of the split (within each sequence directory) on which to test the relocaliser.
+   * \param baseSettings        The settings on which the settings for each parameter set should be based.
+   * \param deviceType          The device on which the relocalisers should operate.
+   * \param threadCount         The number of worker threads to use.
+   * \param logPath             The file to which to log the results of each evaluation (if any).
+   *
+   * \throws std::runtime_error If the sequences cannot be loaded.
+   */
+  RelocaliserEvaluator(const boost::filesystem::path& datasetDir, const std::vector<std::string>& sequenceNames,
+                       const std::string& trainingSplitName, const std::string& validationSplitName,
+                       const tvgutil::SettingsContainer_CPtr& baseSettings, ORUtils::DeviceType deviceType,
+                       size_t threadCount, const boost::filesystem::path& logPath = boost::filesystem::path());
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  RelocaliserEvaluator(const RelocaliserEvaluator&);
+  RelocaliserEvaluator& operator=(const RelocaliserEvaluator&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Computes the cost of the specified parameter set.
+   *
+   * \param params  The parameter set.
+   * \return        The cost of the parameter set.
+   */
+  float evaluate(const evaluation::ParamSet& params);
+
+  /**
+   * \brief Computes the costs of the specified parameter sets, evaluating them concurrently.
+   *
+   * \param paramSets The parameter sets.
+   * \return          The costs of the parameter sets (in the same order as the parameter sets).
+   */
+  std::vector<float> evaluate_batch(const std::vector<evaluation::ParamSet>& paramSets);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the average training, relocalisation and update times (per frame, in microseconds) for the specified parameter set.
+   *
+   * \param results             The results of the tasks (indexed as for evaluate_task).
+   * \param paramSetIndex       The index of the parameter set (among those whose results are in results).
+   * \param trainingTime        A place in which to store the average training time.
+   * \param relocalisationTime  A place in which to store the average relocalisation time.
+   * \param updateTime          A place in which to store the average update time.
+   */
+  void compute_average_timings(const std::vector<SequenceResult>& results, size_t paramSetIndex,
+                               double& trainingTime, double& relocalisationTime, double& updateTime) const;
+
+  /**
+   * \brief Evaluates a relocaliser configured using the specified settings on the specified sequence.
+   *
+   * \param settings  The settings for the relocaliser.
+   * \param sequence  The sequence.
+   * \return          The results of the evaluation.
+   */
+  SequenceResult evaluate_on_sequence(const tvgutil::SettingsContainer_CPtr& settings, const Sequence& sequence) const;
+
+  /**
+   * \brief Checks whether any of the average timings for the specified parameter set exceeds its budget.
+   *
+   * \param results       The results of the tasks (indexed as for evaluate_task).
+   * \param paramSetIndex The index of the parameter set (among those whose results are in results).
+   * \return              true, if any of the average timings exceeds its budget, or false otherwise.
+   */
+  bool exceeds_budget(const std::vector<SequenceResult>& results, size_t paramSetIndex) const;
+
+  /**
+   * \brief Runs the evaluation task with the specified index (each task evaluates one parameter set on one sequence).
+   *
+   * \param taskIndex The index of the task (the parameter set index multiplied by the number of sequences, plus the sequence index).
+   * \param settings  The settings for each of the parameter sets being evaluated.
+   * \param results   The vector into which to write the results of the tasks.
+   */
+  void evaluate_task(size_t taskIndex, const std::vector<tvgutil::SettingsContainer_CPtr>& settings, std::vector<SequenceResult>& results) const;
+
+  /**
+   * \brief Makes the settings for the specified parameter set by overriding the relevant base settings.
+   *
+   * \param params  The parameter set.
+   * \return        The settings for the parameter set.
+   */
+  tvgutil::SettingsContainer_CPtr make_settings(const evaluation::ParamSet& params) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Loads the frames in the specified directory.
+   *
+   * \param dir The directory (containing frame-%06d.{color.png,depth.png,pose.txt} files).
+   * \return    The frames.
+   */
+  static std::vector<Frame> load_frames(const boost::filesystem::path& dir);
+};
+
+}
+
+#endif
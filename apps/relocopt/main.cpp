@@ -20,8 +20,12 @@ using boost::assign::list_of;
 using namespace evaluation;
 
 #include <tvgutil/filesystem/PathFinder.h>
+#include <tvgutil/misc/SettingsContainer.h>
 using namespace tvgutil;
 
+#include "RelocaliserEvaluator.h"
+using namespace relocopt;
+
 //#define COST_IS_TIME
 
 //#define USE_RANDOM
@@ -39,17 +43,23 @@ struct Arguments
 {
   std::string datasetDir;
   bf::path dir;
+  std::string forestFilename;
+  bool inProcess;
   std::string iniSpecifier;
   bf::path logPath;
   std::string logSpecifier;
   std::string outputSpecifier;
   bf::path scriptPath;
   std::string scriptSpecifier;
+  std::vector<std::string> sequenceNames;
+  size_t threadCount;
 
   Arguments()
   : dir(find_subdir_from_executable("resources")),
+    inProcess(false),
     iniSpecifier("temp"),
-    outputSpecifier("temp")
+    outputSpecifier("temp"),
+    threadCount(1)
   {}
 };
 
@@ -138,6 +148,30 @@ float grove_cost_fn(const Arguments& args, const ParamSet& params)
 #endif
 }
 
+SettingsContainer_CPtr make_base_settings(const Arguments& args)
+{
+  SettingsContainer_Ptr settings(new SettingsContainer);
+
+  // Add the default parameters (the same ones that the evaluation script passes to spaintgui).
+  const bf::path defaultParametersPath = args.dir / "default_parameters.ini";
+  po::options_description noOptions;
+  po::parsed_options parsedOptions = po::parse_config_file<char>(defaultParametersPath.string().c_str(), noOptions, true);
+  for(size_t i = 0, optionCount = parsedOptions.options.size(); i < optionCount; ++i)
+  {
+    const po::basic_option<char>& option = parsedOptions.options[i];
+    for(size_t j = 0, valueCount = option.value.size(); j < valueCount; ++j)
+    {
+      settings->add_value(option.string_key, option.value[j]);
+    }
+  }
+
+  // Make all of the relocalisers share the pre-trained forest rather than each loading their own copy of it.
+  if(!args.forestFilename.empty()) settings->set_value("ScoreRelocaliser.modelFilename", args.forestFilename);
+  settings->set_value("ScoreRelocaliser.shareForest", "true");
+
+  return settings;
+}
+
 bool parse_command_line(int argc, char *argv[], Arguments& args)
 {
   // Specify the possible options.
@@ -145,8 +179,12 @@ bool parse_command_line(int argc, char *argv[], Arguments& args)
   options.add_options()
     ("help", "produce help message")
     ("datasetDir,d", po::value<std::string>(&args.datasetDir)->default_value(""), "the dataset directory")
+    ("forest", po::value<std::string>(&args.forestFilename)->default_value(""), "the pre-trained forest to use when evaluating in-process (required with --inProcess)")
+    ("inProcess", po::bool_switch(&args.inProcess), "evaluate the parameter sets in-process rather than by running a script")
     ("logSpecifier,l", po::value<std::string>(&args.logSpecifier)->default_value("relocopt.log"), "the log specifier")
     ("scriptSpecifier,s", po::value<std::string>(&args.scriptSpecifier)->default_value(""), "the script specifier")
+    ("sequence", po::value<std::vector<std::string> >(&args.sequenceNames)->multitoken(), "the sequences on which to evaluate in-process (defaults to those used by the evaluation script)")
+    ("threads,t", po::value<size_t>(&args.threadCount)->default_value(1), "the number of threads to use when evaluating in-process")
   ;
 
   // Actually parse the command line.
@@ -164,16 +202,33 @@ bool parse_command_line(int argc, char *argv[], Arguments& args)
   // Prepare the log path.
   args.logPath = args.dir / args.logSpecifier;
 
-  // Attempt to find the specified script file.
+  if(args.inProcess)
+  {
+    // Attempt to find the pre-trained forest (there is no default, so it must be specified explicitly).
+    if(args.forestFilename.empty() || !bf::is_regular_file(args.forestFilename))
+    {
+      throw std::runtime_error("The pre-trained forest was not specified (using --forest) or does not exist");
+    }
+
+    // If no sequences were specified, use the same ones that the evaluation script uses.
+    if(args.sequenceNames.empty())
+    {
+      list_of<std::string>("chess")("fire")("office")("pumpkin")("redkitchen")("stairs").to_container(args.sequenceNames);
+    }
+  }
+  else
+  {
+    // Attempt to find the specified script file.
 #if _MSC_VER
-  args.scriptPath = args.dir / (args.scriptSpecifier + ".bat");
+    args.scriptPath = args.dir / (args.scriptSpecifier + ".bat");
 #else
-  args.scriptPath = args.dir / (args.scriptSpecifier + ".sh");
+    args.scriptPath = args.dir / (args.scriptSpecifier + ".sh");
 #endif
 
-  if(!bf::exists(args.scriptPath))
-  {
-    throw std::runtime_error("The script file was not specified or does not exist");
+    if(!bf::exists(args.scriptPath))
+    {
+      throw std::runtime_error("The script file was not specified or does not exist");
+    }
   }
 
   // Attempt to find the dataset directory.
@@ -200,16 +255,38 @@ try
     std::ofstream(args.logPath.c_str(), std::ios::trunc);
   }
 
+  // Set up the cost function. If we're evaluating in-process, the sequences and forest are loaded once up-front,
+  // and the evaluator is then used for every evaluation; otherwise, each evaluation runs the evaluation script.
+  boost::shared_ptr<RelocaliserEvaluator> evaluator;
+  EpochBasedParameterOptimiser::CostFunction costFn;
+  if(args.inProcess)
+  {
+#ifdef WITH_CUDA
+    const ORUtils::DeviceType deviceType = ORUtils::DEVICE_CUDA;
+#else
+    const ORUtils::DeviceType deviceType = ORUtils::DEVICE_CPU;
+#endif
+
+    evaluator.reset(new RelocaliserEvaluator(args.datasetDir, args.sequenceNames, "train", "validation", make_base_settings(args), deviceType, args.threadCount, args.logPath));
+    costFn = boost::bind(&RelocaliserEvaluator::evaluate, evaluator.get(), _1);
+  }
+  else costFn = boost::bind(grove_cost_fn, args, _1);
+
   // Set up the optimiser.
   const unsigned seed = 12345;
 #ifdef USE_RANDOM
   const size_t epochCount = 100;
-  RandomParameterOptimiser optimiser(boost::bind(grove_cost_fn, args, _1), epochCount, seed);
+  const size_t threadCount = 1, batchSize = evaluator ? args.threadCount : 1;
+  RandomParameterOptimiser optimiser(costFn, epochCount, seed, threadCount, batchSize);
 #else
   const size_t epochCount = 5;
-  CoordinateDescentParameterOptimiser optimiser(boost::bind(grove_cost_fn, args, _1), epochCount, seed);
+  CoordinateDescentParameterOptimiser optimiser(costFn, epochCount, seed);
 #endif
 
+  // If we're evaluating in-process, let the evaluator evaluate each batch of parameter sets concurrently (it shares
+  // its worker threads between all of the (parameter set, sequence) pairs in the batch).
+  if(evaluator) optimiser.set_batch_cost_function(boost::bind(&RelocaliserEvaluator::evaluate_batch, evaluator.get(), _1));
+
 //  // Scene parameters.
 //  optimiser.add_param("SceneParams.mu", list_of<float>(2.0f)(4.0f)(6.0f)(8.0f)(10.0f)); // It's a multiplicative coefficient applied to the voxelSize, requires a change in the main spaintgui app at the moment.
 //  optimiser.add_param("SceneParams.voxelSize", list_of<float>(0.005f)(0.010f)(0.015f)(0.020f)(0.025f)(0.030f)(0.040f)(0.050f));
@@ -25,7 +25,6 @@ using namespace itmx;
 #include <oglx/WrappedGL.h>
 
 #include <orx/persistence/ImagePersister.h>
-#include <orx/persistence/PosePersister.h>
 using namespace orx;
 
 #include <rigging/MoveableCamera.h>
@@ -54,12 +53,14 @@ using namespace tvgutil;
 Application::Application(const MultiScenePipeline_Ptr& pipeline, bool renderFiducials)
 : m_activeSubwindowIndex(0),
   m_batchModeEnabled(false),
-  m_commandManager(10),
+  m_commandManager(10, pipeline->get_model()->get_settings()->get_first_value<size_t>("Application.maxUndoMemory", 64 * 1024 * 1024)),
   m_pauseBetweenFrames(true),
   m_paused(true),
   m_pipeline(pipeline),
+  m_renderClientImages(pipeline->get_model()->get_settings(), "Application.renderClientImages", true),
   m_renderFiducials(renderFiducials),
   m_saveModelsOnExit(false),
+  m_scenesChangedSinceClientRender(true),
   m_usePoseMirroring(true),
   m_voiceCommandStream("localhost", "23984")
 {
@@ -93,6 +94,23 @@ bool Application::run()
     if(m_batchModeEnabled) { if(eventQuit) return false; }
     else                   { if(eventQuit || escQuit) break; }
 
+    // If we're running a mapping server, start timing the frame (we keep separate timings for each number of active clients).
+    const MappingServer_CPtr mappingServer = m_pipeline->get_model()->get_mapping_server();
+    ServerFrameTimer *serverFrameTimer = NULL;
+    if(mappingServer)
+    {
+      const size_t clientCount = mappingServer->get_active_clients().size();
+      std::map<size_t,ServerFrameTimer>::iterator it = m_serverFrameTimers.find(clientCount);
+      if(it == m_serverFrameTimers.end())
+      {
+        const std::string timerName = "Server Frame (" + boost::lexical_cast<std::string>(clientCount) + " Clients)";
+        it = m_serverFrameTimers.insert(std::make_pair(clientCount, ServerFrameTimer(timerName))).first;
+      }
+
+      serverFrameTimer = &it->second;
+      serverFrameTimer->start_nosync();
+    }
+
     // If desired, save the memory usage for later analysis.
     if(m_memoryUsageOutputStream) save_current_memory_usage();
 
@@ -107,11 +125,14 @@ bool Application::run()
 
       if(!scenesProcessed.empty())
       {
+        // Record that the scenes have changed, so that the images requested by the clients of the mapping server (if any) will be re-rendered.
+        m_scenesChangedSinceClientRender = true;
+
         // If a frame debug hook is active, call it.
         if(m_frameDebugHook) m_frameDebugHook(m_pipeline->get_model());
 
         // If we're currently recording the sequence, save the frame to disk.
-        if(m_sequencePathGenerator) save_sequence_frame();
+        if(m_sequenceRecorder) save_sequence_frame();
       }
       else if(m_batchModeEnabled)
       {
@@ -120,26 +141,58 @@ bool Application::run()
       }
     }
 
+    // If we're recording latencies, start timing the stages of the application that follow the main section of the pipeline.
+    LatencyRecorder::StageTimer stageTimer(m_latencyRecorder, "Application: ");
+
     // Render the scene.
     m_renderer->render(m_fracWindowPos, m_renderFiducials);
 
     // If we're running a mapping server and we want to render any scene images requested by remote clients, do so.
-    const Model_CPtr model = m_pipeline->get_model();
-    if(model->get_mapping_server() && model->get_settings()->get_first_value<bool>("Application.renderClientImages", true))
+    if(mappingServer && m_renderClientImages.get())
     {
-      m_renderer->render_client_images();
+      m_renderer->render_client_images(m_scenesChangedSinceClientRender);
+      m_scenesChangedSinceClientRender = false;
     }
 
+    stageTimer.finish_stage("Render");
+
     // If the application is unpaused, run the mode-specific section of the pipeline for the active scene.
-    if(!m_paused) m_pipeline->run_mode_specific_section(get_active_scene_id(), get_monocular_render_state());
+    if(!m_paused)
+    {
+      m_pipeline->run_mode_specific_section(get_active_scene_id(), get_monocular_render_state());
+
+      // If the mode-specific section may have changed the labels of the active scene, record that the scenes have changed.
+      switch(m_pipeline->get_mode())
+      {
+        case MultiScenePipeline::MODE_PREDICTION:
+        case MultiScenePipeline::MODE_PROPAGATION:
+        case MultiScenePipeline::MODE_SMOOTHING:
+        case MultiScenePipeline::MODE_TRAIN_AND_PREDICT:
+          m_scenesChangedSinceClientRender = true;
+          break;
+        default:
+          break;
+      }
+
+      stageTimer.finish_stage("Mode-Specific Section");
+    }
 
     // If we're currently recording a video, save the next frame of it to disk.
     if(m_videoPathGenerator) save_video_frame();
 
     // If desired, pause at the end of each frame for debugging purposes.
     if(m_pauseBetweenFrames) m_paused = true;
+
+    // If we're timing the frame, stop the timer.
+    if(serverFrameTimer) serverFrameTimer->stop_nosync();
   }
 
+  // If we were running a mapping server, print out how long it took to process a frame for each number of active clients.
+  print_server_frame_times();
+
+  // If we were recording latencies, print out the latency report.
+  print_latency_report();
+
   // If desired, save a mesh of the scene before the application terminates.
   if(m_saveMeshOnExit) save_mesh();
 
@@ -165,6 +218,14 @@ void Application::set_frame_debug_hook(const FrameDebugHook& frameDebugHook)
   m_frameDebugHook = frameDebugHook;
 }
 
+void Application::set_latency_recorder(const LatencyRecorder_Ptr& latencyRecorder)
+{
+  m_latencyRecorder = latencyRecorder;
+
+  // Make sure that we can mesh the scenes, since the latency report includes a checksum of each scene's mesh.
+  if(!m_meshingEngine) setup_meshing();
+}
+
 void Application::set_save_memory_usage(bool saveMemoryUsage)
 {
 #ifdef WITH_CUDA
@@ -303,7 +364,7 @@ void Application::handle_key_down(const SDL_Keysym& keysym)
   // If right shift + / is pressed, toggle video recording.
   if(keysym.sym == SDLK_SLASH)
   {
-    if(m_inputState.key_down(KEYCODE_LSHIFT)) toggle_recording("sequence", m_sequencePathGenerator);
+    if(m_inputState.key_down(KEYCODE_LSHIFT)) toggle_sequence_recording();
     else if(m_inputState.key_down(KEYCODE_RSHIFT)) toggle_recording("video", m_videoPathGenerator);
     else save_screenshot();
   }
@@ -342,12 +403,14 @@ void Application::handle_key_down(const SDL_Keysym& keysym)
   if(keysym.sym == KEYCODE_r && m_inputState.key_down(KEYCODE_LCTRL))
   {
     m_pipeline->reset_scene(get_active_scene_id());
+    m_scenesChangedSinceClientRender = true;
   }
 
   if(keysym.sym == KEYCODE_BACKSPACE)
   {
     const Model_Ptr& model = m_pipeline->get_model();
     const std::string& sceneID = get_active_scene_id();
+    m_scenesChangedSinceClientRender = true;
     if(m_inputState.key_down(KEYCODE_RCTRL) && m_inputState.key_down(KEYCODE_RSHIFT))
     {
       // If right control + right shift + backspace is pressed, clear the semantic labels of all the voxels in the active scene, and reset the random forest and command manager.
@@ -498,6 +561,65 @@ void Application::handle_mousebutton_up(const SDL_MouseButtonEvent& e)
   }
 }
 
+void Application::print_latency_report() const
+{
+  // If we weren't recording latencies, early out.
+  if(!m_latencyRecorder) return;
+
+  std::cout << "[spaint] Latency report:\n";
+  m_latencyRecorder->output_report(std::cout);
+
+  // Compute checksums of the final pose and mesh of each scene, so that the results of different runs can be compared.
+  Model_CPtr model = m_pipeline->get_model();
+  const std::vector<std::string> sceneIDs = model->get_scene_ids();
+
+  std::cout << '\n' << boost::format("%-40s %16s %16s %12s\n") % "Scene" % "Pose Checksum" % "Mesh Checksum" % "Triangles";
+  for(size_t sceneIdx = 0; sceneIdx < sceneIDs.size(); ++sceneIdx)
+  {
+    const std::string& sceneID = sceneIDs[sceneIdx];
+    SLAMState_CPtr slamState = model->get_slam_state(sceneID);
+
+    // Hash the elements of the scene's final pose matrix.
+    const Matrix4f pose = slamState->get_pose().GetM();
+    const boost::uint64_t poseChecksum = hash_bytes(pose.m, sizeof(pose.m));
+
+    // Mesh the scene, and hash its triangles. We combine the hashes of the individual triangles by summing them, since the order in
+    // which the meshing engine outputs the triangles is not deterministic on the GPU. The mesh is constructed as in save_mesh.
+    typedef ITMMesh::Triangle Triangle;
+    typedef ORUtils::MemoryBlock<Triangle> TriangleBlock;
+    Mesh_Ptr mesh(new ITMMesh(model->get_settings()->GetMemoryType(), 1 << 24));
+    m_meshingEngine->MeshScene(mesh.get(), slamState->get_voxel_scene().get());
+
+    // If the mesh is on the GPU, copy its triangles across to the CPU so that we can hash them.
+    boost::shared_ptr<TriangleBlock> cpuTriangles;
+    if(mesh->memoryType == MEMORYDEVICE_CUDA)
+    {
+      cpuTriangles.reset(new TriangleBlock(mesh->noMaxTriangles, MEMORYDEVICE_CPU));
+      cpuTriangles->SetFrom(mesh->triangles, TriangleBlock::CUDA_TO_CPU);
+    }
+
+    const Triangle *trianglesData = (cpuTriangles ? cpuTriangles.get() : mesh->triangles)->GetData(MEMORYDEVICE_CPU);
+    boost::uint64_t meshChecksum = hash_bytes(&mesh->noTotalTriangles, sizeof(mesh->noTotalTriangles));
+    for(size_t triangleIdx = 0; triangleIdx < mesh->noTotalTriangles; ++triangleIdx)
+    {
+      meshChecksum += hash_bytes(&trianglesData[triangleIdx], sizeof(Triangle));
+    }
+
+    std::cout << boost::format("%-40s %016x %016x %12d\n") % sceneID % poseChecksum % meshChecksum % mesh->noTotalTriangles;
+  }
+}
+
+void Application::print_server_frame_times() const
+{
+  for(std::map<size_t,ServerFrameTimer>::const_iterator it = m_serverFrameTimers.begin(), iend = m_serverFrameTimers.end(); it != iend; ++it)
+  {
+    const ServerFrameTimer& timer = it->second;
+    const boost::chrono::microseconds averageDuration = timer.average_duration();
+    const double framesPerSecond = averageDuration.count() > 0 ? 1000000.0 / averageDuration.count() : 0.0;
+    std::cout << timer.name() << ": " << timer.count() << " frames, avg: " << averageDuration << " (" << framesPerSecond << " frames/s)\n";
+  }
+}
+
 void Application::process_camera_input()
 {
   // Allow the user to change the camera mode of the active sub-window.
@@ -605,6 +727,7 @@ void Application::process_command_input()
     if(!blockUndo && m_commandManager.can_undo())
     {
       m_commandManager.undo();
+      m_scenesChangedSinceClientRender = true;
       blockUndo = true;
     }
   }
@@ -616,6 +739,7 @@ void Application::process_command_input()
     if(!blockRedo && m_commandManager.can_redo())
     {
       m_commandManager.redo();
+      m_scenesChangedSinceClientRender = true;
       blockRedo = true;
     }
   }
@@ -759,6 +883,8 @@ void Application::process_labelling_input()
         m_commandManager.execute_compressible_command(Command_CPtr(new MarkVoxelsCommand(get_active_scene_id(), selection, packedLabel, model)), precursors);
       }
       else model->mark_voxels(get_active_scene_id(), selection, packedLabel, NORMAL_MARKING);
+
+      m_scenesChangedSinceClientRender = true;
     }
   }
   else if(currentlyMarking)
@@ -1063,21 +1189,17 @@ void Application::save_sequence_frame()
   const std::string& sceneID = mainSubwindow.get_scene_id();
 
   // If the RGBD calibration hasn't already been saved, save it now.
-  SLAMState_CPtr slamState = m_pipeline->get_model()->get_slam_state(sceneID);
-  boost::filesystem::path calibrationFile = m_sequencePathGenerator->get_base_dir() / "calib.txt";
+  const SLAMState_Ptr& slamState = m_pipeline->get_model()->get_slam_state(sceneID);
+  boost::filesystem::path calibrationFile = m_sequenceRecorder->get_base_dir() / "calib.txt";
   if(!boost::filesystem::exists(calibrationFile))
   {
     writeRGBDCalib(calibrationFile.string().c_str(), slamState->get_view()->calib);
   }
 
-  // Save the current input images.
-  ImagePersister::save_image_on_thread(slamState->get_input_raw_depth_image_copy(), m_sequencePathGenerator->make_path("frame-%06i.depth.png"));
-  ImagePersister::save_image_on_thread(slamState->get_input_rgb_image_copy(), m_sequencePathGenerator->make_path("frame-%06i.color.png"));
-
-  // Save the inverse pose (i.e. the camera -> world transformation).
-  PosePersister::save_pose_on_thread(slamState->get_pose().GetInvM(), m_sequencePathGenerator->make_path("frame-%06i.pose.txt"));
-
-  m_sequencePathGenerator->increment_index();
+  // Pass the current input images and the inverse pose (i.e. the camera -> world transformation) to the recorder,
+  // which copies them into one of its buffers and writes them to disk asynchronously. Depending on the recorder's
+  // settings, this may block (or drop the frame) if the recorder's writer threads are falling behind.
+  m_sequenceRecorder->record_frame(slamState->get_input_rgb_image(), slamState->get_input_raw_depth_image(), slamState->get_pose().GetInvM());
 }
 
 void Application::save_video_frame()
@@ -1127,7 +1249,7 @@ void Application::setup_labels()
 void Application::setup_meshing()
 {
   const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
-  if(settings->createMeshingEngine || m_saveMeshOnExit)
+  if(settings->createMeshingEngine || m_saveMeshOnExit || m_latencyRecorder)
   {
     m_meshingEngine.reset(ITMMeshingEngineFactory::MakeMeshingEngine<SpaintVoxel,ITMVoxelBlockHash>(settings->deviceType));
   }
@@ -1173,3 +1295,52 @@ void Application::toggle_recording(const std::string& type, boost::optional<tvgu
     std::cout << "[spaint] Started saving " << type << " to " << pathGenerator->get_base_dir() << "...\n";
   }
 }
+
+void Application::toggle_sequence_recording()
+{
+  if(m_sequenceRecorder)
+  {
+    // Wait for any frames that are still in the recorder's queue to be written, and then report how well the recorder kept up.
+    m_sequenceRecorder->finish();
+    const SequenceRecorder::Statistics stats = m_sequenceRecorder->get_statistics();
+    m_sequenceRecorder.reset();
+
+    std::cout << "[spaint] Stopped saving sequence.\n";
+    std::cout << boost::format("[spaint] Frames written: %d/%d (%d failed); dropped: %d; delayed: %d (total %.1fms, worst %.1fms)\n")
+                 % stats.writtenFrameCount % stats.recordedFrameCount % stats.failedFrameCount % stats.droppedFrameCount
+                 % stats.delayedFrameCount % stats.totalDelayMs % stats.maxDelayMs;
+    if(stats.writtenFrameCount > 0)
+    {
+      std::cout << boost::format("[spaint] Write latency: mean %.1fms, worst %.1fms; peak queue size: %d\n")
+                   % (stats.totalWriteLatencyMs / stats.writtenFrameCount) % stats.maxWriteLatencyMs % stats.maxQueueSize;
+    }
+  }
+  else
+  {
+    const Settings_CPtr& settings = m_pipeline->get_model()->get_settings();
+    const size_t capacity = settings->get_first_value<size_t>("Application.sequenceRecorderCapacity", 8);
+    const size_t writerCount = settings->get_first_value<size_t>("Application.sequenceRecorderWriterCount", 2);
+    const pooled_queue::PoolEmptyStrategy poolEmptyStrategy = settings->get_first_value<pooled_queue::PoolEmptyStrategy>("Application.sequenceRecorderPoolEmptyStrategy", pooled_queue::PES_WAIT);
+
+    // By default, the images are stored uncompressed, since encoding them is then cheap enough for a single core to keep up with a 30Hz camera.
+    const ImagePersister::PNGCompressionLevel compressionLevel = settings->get_first_value<ImagePersister::PNGCompressionLevel>("Application.sequenceRecorderCompressionLevel", ImagePersister::PCL_NONE);
+
+    const boost::filesystem::path baseDir = find_subdir_from_executable("sequences") / TimeUtil::get_iso_timestamp();
+    boost::filesystem::create_directories(baseDir);
+    m_sequenceRecorder.reset(new SequenceRecorder(baseDir, capacity, writerCount, poolEmptyStrategy, compressionLevel));
+    std::cout << "[spaint] Started saving sequence to " << baseDir << "...\n";
+  }
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+boost::uint64_t Application::hash_bytes(const void *data, size_t size, boost::uint64_t hash)
+{
+  const unsigned char *bytes = static_cast<const unsigned char*>(data);
+  for(size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
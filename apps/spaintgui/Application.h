@@ -7,6 +7,7 @@
 #define H_SPAINTGUI_APPLICATION
 
 #include <tvgutil/boost/WrappedAsio.h>
+#include <boost/cstdint.hpp>
 #include <boost/function.hpp>
 
 // Prevent SDL from trying to define M_PI.
@@ -16,10 +17,15 @@
 
 #include <ITMLib/Engines/Meshing/Interface/ITMMeshingEngine.h>
 
+#include <orx/persistence/SequenceRecorder.h>
+
 #include <tvginput/InputState.h>
 
 #include <tvgutil/commands/CommandManager.h>
+#include <tvgutil/misc/CachedSetting.h>
 #include <tvgutil/filesystem/SequentialPathGenerator.h>
+#include <tvgutil/timing/AverageTimer.h>
+#include <tvgutil/timing/LatencyRecorder.h>
 
 #include "core/MultiScenePipeline.h"
 #include "renderers/Renderer.h"
@@ -39,6 +45,7 @@ private:
   typedef ITMLib::ITMMeshingEngine<spaint::SpaintVoxel,ITMVoxelIndex> MeshingEngine;
   typedef boost::shared_ptr<MeshingEngine> MeshingEngine_Ptr;
   typedef boost::shared_ptr<Renderer> Renderer_Ptr;
+  typedef tvgutil::AverageTimer<boost::chrono::microseconds> ServerFrameTimer;
 
 public:
   typedef boost::function<void(const Model_Ptr&)> FrameDebugHook;
@@ -63,6 +70,9 @@ private:
   /** The current state of the keyboard and mouse. */
   tvginput::InputState m_inputState;
 
+  /** The recorder (if any) in which to record the latencies of the application's stages, and from which to print a report on exit. */
+  tvgutil::LatencyRecorder_Ptr m_latencyRecorder;
+
   /** The stream on which to output the memory usage (if memory usage saving is enabled). */
   boost::shared_ptr<std::ofstream> m_memoryUsageOutputStream;
 
@@ -81,6 +91,9 @@ private:
   /** The current renderer. */
   Renderer_Ptr m_renderer;
 
+  /** Whether or not to render any scene images requested by remote clients (if we're running a mapping server). */
+  tvgutil::CachedSetting<bool> m_renderClientImages;
+
   /** Whether or not to render the fiducials (if any) that have been detected in the 3D scene. */
   bool m_renderFiducials;
 
@@ -90,8 +103,14 @@ private:
   /** Whether or not to save models of the scenes on exiting the application. */
   bool m_saveModelsOnExit;
 
-  /** The path generator for the current sequence recording (if any). */
-  boost::optional<tvgutil::SequentialPathGenerator> m_sequencePathGenerator;
+  /** Whether or not the scenes may have changed since the images requested by the clients of the mapping server (if any) were last rendered. */
+  bool m_scenesChangedSinceClientRender;
+
+  /** The recorder for the current sequence recording (if any). */
+  orx::SequenceRecorder_Ptr m_sequenceRecorder;
+
+  /** Timers recording the time taken to process each frame when running a mapping server, indexed by the number of active clients. */
+  std::map<size_t,ServerFrameTimer> m_serverFrameTimers;
 
   /** A set of sub-window configurations that the user can switch between as desired. */
   mutable std::vector<SubwindowConfiguration_Ptr> m_subwindowConfigurations;
@@ -138,6 +157,16 @@ public:
    */
   void set_frame_debug_hook(const FrameDebugHook& frameDebugHook);
 
+  /**
+   * \brief Sets the recorder (if any) in which to record the latencies of the application's stages.
+   *
+   * If a recorder is set, a report containing the recorded latencies and counts, together with checksums of
+   * the final pose and mesh of each scene, is printed when the application terminates normally.
+   *
+   * \param latencyRecorder The recorder (if any) in which to record the latencies of the application's stages.
+   */
+  void set_latency_recorder(const tvgutil::LatencyRecorder_Ptr& latencyRecorder);
+
   /**
    * \brief Sets whether or not to profile the memory usage of the application and save it before processing each frame.
    *
@@ -243,6 +272,19 @@ private:
    */
   void handle_mousebutton_up(const SDL_MouseButtonEvent& e);
 
+  /**
+   * \brief Prints the latencies and counts recorded in the latency recorder (if any), together with checksums of the final pose and mesh of each scene.
+   *
+   * The checksums make it possible to check that a change has not altered the results of a run. Note that they are only
+   * expected to be reproducible if no frames were dropped, since which frames are dropped depends on the timing of the run.
+   */
+  void print_latency_report() const;
+
+  /**
+   * \brief Prints the average time taken to process a frame (and the corresponding frame rate) for each number of active mapping server clients seen (if any).
+   */
+  void print_server_frame_times() const;
+
   /**
    * \brief Processes user input that deals with the camera.
    */
@@ -353,6 +395,26 @@ private:
    * \param pathGenerator The path generator associated with that type of recording.
    */
   void toggle_recording(const std::string& type, boost::optional<tvgutil::SequentialPathGenerator>& pathGenerator);
+
+  /**
+   * \brief Toggles sequence recording on or off.
+   *
+   * When recording is toggled off, any frames that are still waiting to be written are written
+   * to disk, and statistics on how well the recorder kept up with the frame rate are output.
+   */
+  void toggle_sequence_recording();
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Updates a 64-bit FNV-1a hash with the specified bytes.
+   *
+   * \param data  The bytes with which to update the hash.
+   * \param size  The number of bytes.
+   * \param hash  The hash to update (by default, the FNV-1a offset basis).
+   * \return      The updated hash.
+   */
+  static boost::uint64_t hash_bytes(const void *data, size_t size, boost::uint64_t hash = 14695981039346656037ULL);
 };
 
 #endif
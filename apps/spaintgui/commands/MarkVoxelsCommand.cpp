@@ -5,6 +5,12 @@
 
 #include "MarkVoxelsCommand.h"
 using namespace spaint;
+using namespace tvgutil;
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/cstdint.hpp>
 
 #include <orx/base/MemoryBlockFactory.h>
 using orx::MemoryBlockFactory;
@@ -15,8 +21,21 @@ MarkVoxelsCommand::MarkVoxelsCommand(const std::string& sceneID, const boost::sh
                                      SpaintVoxel::PackedLabel label, const Model_Ptr& model)
 : Command(get_static_description()),
   m_label(label),
+  m_mayContainDuplicates(false),
+  m_model(model),
+  m_pruned(false),
+  m_sceneID(sceneID),
+  m_voxelLocationsMB(voxelLocationsMB)
+{}
+
+MarkVoxelsCommand::MarkVoxelsCommand(const std::string& sceneID, const VoxelLocations_CPtr& voxelLocationsMB, const std::vector<LabelRun>& oldLabelRuns,
+                                     SpaintVoxel::PackedLabel label, const Model_Ptr& model, const std::string& description)
+: Command(description),
+  m_label(label),
+  m_mayContainDuplicates(true),
   m_model(model),
-  m_oldVoxelLabelsMB(MemoryBlockFactory::instance().make_block<SpaintVoxel::PackedLabel>(voxelLocationsMB->dataSize)),
+  m_oldLabelRuns(oldLabelRuns),
+  m_pruned(true),
   m_sceneID(sceneID),
   m_voxelLocationsMB(voxelLocationsMB)
 {}
@@ -25,12 +44,93 @@ MarkVoxelsCommand::MarkVoxelsCommand(const std::string& sceneID, const boost::sh
 
 void MarkVoxelsCommand::execute() const
 {
-  m_model->mark_voxels(m_sceneID, m_voxelLocationsMB, m_label, NORMAL_MARKING, m_oldVoxelLabelsMB);
+  const size_t voxelCount = m_voxelLocationsMB->dataSize;
+  if(voxelCount == 0) return;
+
+  // Mark the voxels, recording their old labels. The old labels are initialised to the new label so that
+  // any voxels that are not in the scene (and whose old labels will thus not be written) are pruned below.
+  Model::PackedLabels_Ptr oldLabelsMB = MemoryBlockFactory::instance().make_block<SpaintVoxel::PackedLabel>(voxelCount);
+  std::fill(oldLabelsMB->GetData(MEMORYDEVICE_CPU), oldLabelsMB->GetData(MEMORYDEVICE_CPU) + voxelCount, m_label);
+  oldLabelsMB->UpdateDeviceFromHost();
+
+  m_model->mark_voxels(m_sceneID, m_voxelLocationsMB, m_label, NORMAL_MARKING, oldLabelsMB);
+
+  oldLabelsMB->UpdateHostFromDevice();
+  const SpaintVoxel::PackedLabel *oldLabels = oldLabelsMB->GetData(MEMORYDEVICE_CPU);
+
+  m_oldLabelRuns.clear();
+
+  if(m_pruned)
+  {
+    // If the command has been executed before, simply re-record the old labels of the voxels.
+    for(size_t i = 0; i < voxelCount; ++i)
+    {
+      encode_label(oldLabels[i], m_oldLabelRuns);
+    }
+  }
+  else
+  {
+    // Otherwise, drop any voxels whose labels were already equal to the new label, since undoing the marking
+    // of such voxels would have no effect. Often, this removes the bulk of the voxels in the selection.
+    m_voxelLocationsMB->UpdateHostFromDevice();
+    const Vector3s *voxelLocations = m_voxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+
+    std::vector<Vector3s> keptVoxelLocations;
+    for(size_t i = 0; i < voxelCount; ++i)
+    {
+      if(oldLabels[i] == m_label) continue;
+      keptVoxelLocations.push_back(voxelLocations[i]);
+      encode_label(oldLabels[i], m_oldLabelRuns);
+    }
+
+    m_voxelLocationsMB = make_voxel_locations(keptVoxelLocations);
+    m_pruned = true;
+  }
+
+  // Release any spare capacity in the old label runs, so as to keep the command history compact.
+  std::vector<LabelRun>(m_oldLabelRuns).swap(m_oldLabelRuns);
+}
+
+size_t MarkVoxelsCommand::get_memory_usage() const
+{
+  return m_voxelLocationsMB->dataSize * sizeof(Vector3s) + m_oldLabelRuns.capacity() * sizeof(LabelRun);
+}
+
+Command_CPtr MarkVoxelsCommand::merge_with(const Command_CPtr& next, const std::string& description) const
+{
+  // Check that the next command marks voxels in the same scene with the same label, and has been executed.
+  const MarkVoxelsCommand *nextMark = dynamic_cast<const MarkVoxelsCommand*>(next.get());
+  if(!nextMark || nextMark->m_sceneID != m_sceneID || !(nextMark->m_label == m_label) || nextMark->m_model != m_model) return Command_CPtr();
+  if(!m_pruned || !nextMark->m_pruned) return Command_CPtr();
+
+  // Concatenate the voxel locations from the two commands. Note that the host copies of the locations are up-to-date,
+  // since they were made on the host when the commands were pruned.
+  const size_t voxelCount = m_voxelLocationsMB->dataSize, nextVoxelCount = nextMark->m_voxelLocationsMB->dataSize;
+  std::vector<Vector3s> voxelLocations(voxelCount + nextVoxelCount);
+  if(voxelCount > 0) memcpy(&voxelLocations[0], m_voxelLocationsMB->GetData(MEMORYDEVICE_CPU), voxelCount * sizeof(Vector3s));
+  if(nextVoxelCount > 0) memcpy(&voxelLocations[voxelCount], nextMark->m_voxelLocationsMB->GetData(MEMORYDEVICE_CPU), nextVoxelCount * sizeof(Vector3s));
+
+  // Concatenate the old label runs from the two commands, joining the runs at the boundary if possible.
+  std::vector<LabelRun> oldLabelRuns;
+  oldLabelRuns.reserve(m_oldLabelRuns.size() + nextMark->m_oldLabelRuns.size());
+  oldLabelRuns.insert(oldLabelRuns.end(), m_oldLabelRuns.begin(), m_oldLabelRuns.end());
+  for(std::vector<LabelRun>::const_iterator it = nextMark->m_oldLabelRuns.begin(), iend = nextMark->m_oldLabelRuns.end(); it != iend; ++it)
+  {
+    if(!oldLabelRuns.empty() && oldLabelRuns.back().label == it->label) oldLabelRuns.back().length += it->length;
+    else oldLabelRuns.push_back(*it);
+  }
+
+  return Command_CPtr(new MarkVoxelsCommand(m_sceneID, make_voxel_locations(voxelLocations), oldLabelRuns, m_label, m_model, description));
 }
 
 void MarkVoxelsCommand::undo() const
 {
-  m_model->mark_voxels(m_sceneID, m_voxelLocationsMB, m_oldVoxelLabelsMB, FORCED_MARKING);
+  if(m_mayContainDuplicates) remove_duplicates();
+
+  const size_t voxelCount = m_voxelLocationsMB->dataSize;
+  if(voxelCount == 0) return;
+
+  m_model->mark_voxels(m_sceneID, m_voxelLocationsMB, decode_labels(m_oldLabelRuns, voxelCount), FORCED_MARKING);
 }
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
@@ -39,3 +139,89 @@ std::string MarkVoxelsCommand::get_static_description()
 {
   return "Mark Voxels";
 }
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void MarkVoxelsCommand::remove_duplicates() const
+{
+  const size_t voxelCount = m_voxelLocationsMB->dataSize;
+  const Vector3s *voxelLocations = m_voxelLocationsMB->GetData(MEMORYDEVICE_CPU);
+
+  // Sort the voxels by location (breaking ties by index), so that duplicates end up next to each other, with the first occurrence first.
+  std::vector<std::pair<boost::uint64_t,size_t> > keys(voxelCount);
+  for(size_t i = 0; i < voxelCount; ++i)
+  {
+    const Vector3s& loc = voxelLocations[i];
+    const boost::uint64_t key = (static_cast<boost::uint64_t>(static_cast<unsigned short>(loc.x)) << 32) |
+                                (static_cast<boost::uint64_t>(static_cast<unsigned short>(loc.y)) << 16) |
+                                static_cast<boost::uint64_t>(static_cast<unsigned short>(loc.z));
+    keys[i] = std::make_pair(key, i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  // Flag the later occurrences of any duplicated voxels for removal.
+  std::vector<unsigned char> keep(voxelCount, 1);
+  for(size_t i = 1; i < voxelCount; ++i)
+  {
+    if(keys[i].first == keys[i-1].first) keep[keys[i].second] = 0;
+  }
+
+  // Rebuild the voxel locations and old label runs, preserving the original order of the voxels that are kept.
+  std::vector<Vector3s> keptVoxelLocations;
+  std::vector<LabelRun> keptOldLabelRuns;
+  size_t i = 0;
+  for(std::vector<LabelRun>::const_iterator it = m_oldLabelRuns.begin(), iend = m_oldLabelRuns.end(); it != iend; ++it)
+  {
+    for(unsigned int j = 0; j < it->length; ++j, ++i)
+    {
+      if(!keep[i]) continue;
+      keptVoxelLocations.push_back(voxelLocations[i]);
+      encode_label(it->label, keptOldLabelRuns);
+    }
+  }
+
+  m_voxelLocationsMB = make_voxel_locations(keptVoxelLocations);
+  std::vector<LabelRun>(keptOldLabelRuns).swap(m_oldLabelRuns);
+  m_mayContainDuplicates = false;
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+Model::PackedLabels_Ptr MarkVoxelsCommand::decode_labels(const std::vector<LabelRun>& runs, size_t size)
+{
+  Model::PackedLabels_Ptr labelsMB = MemoryBlockFactory::instance().make_block<SpaintVoxel::PackedLabel>(size);
+  SpaintVoxel::PackedLabel *labels = labelsMB->GetData(MEMORYDEVICE_CPU);
+  for(std::vector<LabelRun>::const_iterator it = runs.begin(), iend = runs.end(); it != iend; ++it)
+  {
+    std::fill(labels, labels + it->length, it->label);
+    labels += it->length;
+  }
+  labelsMB->UpdateDeviceFromHost();
+  return labelsMB;
+}
+
+void MarkVoxelsCommand::encode_label(SpaintVoxel::PackedLabel label, std::vector<LabelRun>& runs)
+{
+  if(!runs.empty() && runs.back().label == label)
+  {
+    ++runs.back().length;
+  }
+  else
+  {
+    LabelRun run;
+    run.label = label;
+    run.length = 1;
+    runs.push_back(run);
+  }
+}
+
+MarkVoxelsCommand::VoxelLocations_CPtr MarkVoxelsCommand::make_voxel_locations(const std::vector<Vector3s>& voxelLocations)
+{
+  boost::shared_ptr<ORUtils::MemoryBlock<Vector3s> > voxelLocationsMB = MemoryBlockFactory::instance().make_block<Vector3s>(voxelLocations.size());
+  if(!voxelLocations.empty())
+  {
+    memcpy(voxelLocationsMB->GetData(MEMORYDEVICE_CPU), &voxelLocations[0], voxelLocations.size() * sizeof(Vector3s));
+    voxelLocationsMB->UpdateDeviceFromHost();
+  }
+  return voxelLocationsMB;
+}
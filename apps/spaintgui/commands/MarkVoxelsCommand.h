@@ -6,31 +6,63 @@
 #ifndef H_SPAINTGUI_MARKVOXELSCOMMAND
 #define H_SPAINTGUI_MARKVOXELSCOMMAND
 
+#include <vector>
+
 #include <tvgutil/commands/Command.h>
 
 #include "../core/Model.h"
 
 /**
  * \brief An instance of this class represents a command that can be used to mark voxels in a scene.
+ *
+ * To keep the undo history compact, the command only keeps the state it needs once it has been executed:
+ * voxels whose labels were not changed by the marking are dropped from the command, and the old labels
+ * of the remaining voxels are stored in run-length encoded form on the CPU. Consecutive commands that
+ * mark voxels in the same scene with the same label (e.g. the successive frames of a brush stroke)
+ * can be merged into a single command.
  */
 class MarkVoxelsCommand : public tvgutil::Command
 {
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a run of consecutive voxels that had the same old label.
+   */
+  struct LabelRun
+  {
+    /** The old label of the voxels in the run. */
+    spaint::SpaintVoxel::PackedLabel label;
+
+    /** The number of voxels in the run. */
+    unsigned int length;
+  };
+
+  //#################### TYPEDEFS ####################
+private:
+  typedef boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > VoxelLocations_CPtr;
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The semantic label with which to mark the voxels. */
   spaint::SpaintVoxel::PackedLabel m_label;
 
+  /** Whether or not the voxel locations may contain duplicates (as a result of merging commands). */
+  mutable bool m_mayContainDuplicates;
+
   /** The spaint model. */
   Model_Ptr m_model;
 
-  /** A memory block into which to store the old labels of the voxels being marked. */
-  boost::shared_ptr<ORUtils::MemoryBlock<spaint::SpaintVoxel::PackedLabel> > m_oldVoxelLabelsMB;
+  /** The old labels of the voxels being marked, in run-length encoded form. */
+  mutable std::vector<LabelRun> m_oldLabelRuns;
+
+  /** Whether or not the voxels whose labels were not changed by the marking have been dropped from the command. */
+  mutable bool m_pruned;
 
   /** The ID of the scene in which to mark voxels. */
   std::string m_sceneID;
 
   /** The locations of the voxels in the scene to mark. */
-  boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> > m_voxelLocationsMB;
+  mutable VoxelLocations_CPtr m_voxelLocationsMB;
 
   //#################### CONSTRUCTORS ####################
 public:
@@ -45,11 +77,39 @@ public:
   MarkVoxelsCommand(const std::string& sceneID, const boost::shared_ptr<const ORUtils::MemoryBlock<Vector3s> >& voxelLocationsMB,
                     spaint::SpaintVoxel::PackedLabel label, const Model_Ptr& model);
 
+private:
+  /**
+   * \brief Constructs a mark voxels command that has already been executed (this is used when merging commands).
+   *
+   * \param sceneID           The ID of the scene in which to mark voxels.
+   * \param voxelLocationsMB  The locations of the voxels in the scene to mark.
+   * \param oldLabelRuns      The old labels of the voxels, in run-length encoded form.
+   * \param label             The semantic label with which to mark the voxels.
+   * \param model             The spaint model.
+   * \param description       The description to give the command.
+   */
+  MarkVoxelsCommand(const std::string& sceneID, const VoxelLocations_CPtr& voxelLocationsMB, const std::vector<LabelRun>& oldLabelRuns,
+                    spaint::SpaintVoxel::PackedLabel label, const Model_Ptr& model, const std::string& description);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /** Override */
   virtual void execute() const;
 
+  /** Override */
+  virtual size_t get_memory_usage() const;
+
+  /**
+   * \brief Attempts to merge this command with a command that has just been executed after it.
+   *
+   * This succeeds if the next command is also a mark voxels command that marks voxels in the same scene with the same label.
+   *
+   * \param next        The command that has just been executed after this one.
+   * \param description The description to give the merged command.
+   * \return            The merged command, if the commands can be merged, or NULL otherwise.
+   */
+  virtual tvgutil::Command_CPtr merge_with(const tvgutil::Command_CPtr& next, const std::string& description) const;
+
   /** Override */
   virtual void undo() const;
 
@@ -61,6 +121,44 @@ public:
    * \return  A short description of what the command does.
    */
   static std::string get_static_description();
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Removes any duplicate voxel locations from the command, keeping the old label from the first occurrence of each.
+   *
+   * \note  When commands are merged, a voxel may appear in both of them. The old label from the earlier command is the one
+   *        that should be restored by an undo, but marking the voxels in parallel would not guarantee this, so we remove
+   *        the later occurrences before the first undo.
+   */
+  void remove_duplicates() const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Decodes a run-length encoded sequence of labels.
+   *
+   * \param runs  The run-length encoded labels.
+   * \param size  The total number of labels in the sequence.
+   * \return      A memory block containing the decoded labels (available on both the CPU and, if relevant, the GPU).
+   */
+  static boost::shared_ptr<ORUtils::MemoryBlock<spaint::SpaintVoxel::PackedLabel> > decode_labels(const std::vector<LabelRun>& runs, size_t size);
+
+  /**
+   * \brief Appends a label to a run-length encoded sequence of labels.
+   *
+   * \param label The label to append.
+   * \param runs  The run-length encoded labels.
+   */
+  static void encode_label(spaint::SpaintVoxel::PackedLabel label, std::vector<LabelRun>& runs);
+
+  /**
+   * \brief Makes a memory block containing the specified voxel locations (available on both the CPU and, if relevant, the GPU).
+   *
+   * \param voxelLocations  The voxel locations.
+   * \return                The memory block.
+   */
+  static VoxelLocations_CPtr make_voxel_locations(const std::vector<Vector3s>& voxelLocations);
 };
 
 #endif
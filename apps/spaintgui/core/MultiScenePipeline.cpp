@@ -7,11 +7,19 @@
 using namespace itmx;
 using namespace spaint;
 
+#include <algorithm>
+
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 #include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
 namespace bf = boost::filesystem;
 
 #include <tvgutil/containers/MapUtil.h>
+#include <tvgutil/misc/ConcurrencyUtil.h>
 using namespace tvgutil;
 
 //#################### CONSTRUCTORS ####################
@@ -29,6 +37,11 @@ MultiScenePipeline::MultiScenePipeline(const std::string& type, const Settings_P
   }
 #endif
 
+  // Determine how many scenes can be processed concurrently. By default, we use one worker thread per core when running on the CPU.
+  // When running on the GPU, the scenes' kernels would be serialised anyway, so we process the scenes in turn as before.
+  const size_t defaultSceneThreadCount = settings->deviceType == ORUtils::DEVICE_CPU ? std::max(boost::thread::hardware_concurrency(), 1u) : 1;
+  m_sceneThreadCount = settings->get_first_value<size_t>("MultiScenePipeline.sceneThreadCount", defaultSceneThreadCount);
+
   // Set up the spaint model.
   m_model.reset(new Model(settings, resourcesDir, maxLabelCount, mappingServer));
 }
@@ -76,11 +89,38 @@ void MultiScenePipeline::reset_scene(const std::string& sceneID)
 
 std::set<std::string> MultiScenePipeline::run_main_section()
 {
-  std::set<std::string> result;
+  // Divide the scenes into those that can be processed independently of each other, and those that mirror the pose of
+  // another scene (which must be processed after the scene whose pose they mirror, since they read its current pose).
+  std::vector<std::string> independentSceneIDs, mirroringSceneIDs;
+  std::vector<SLAMComponent_Ptr> independentSLAMComponents, mirroringSLAMComponents;
   for(std::map<std::string,SLAMComponent_Ptr>::const_iterator it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it)
   {
-    if(it->second->process_frame()) result.insert(it->first);
+    const bool mirroring = !it->second->get_mirror_scene_id().empty();
+    (mirroring ? mirroringSceneIDs : independentSceneIDs).push_back(it->first);
+    (mirroring ? mirroringSLAMComponents : independentSLAMComponents).push_back(it->second);
   }
+
+  // Process the independent scenes concurrently.
+  // Note: We use a vector of char rather than of bool, since the worker threads need to write to separate elements concurrently.
+  const size_t threadCount = std::min(m_sceneThreadCount, independentSLAMComponents.size());
+  std::vector<char> processed(independentSLAMComponents.size(), 0);
+  ConcurrencyUtil::run_tasks(
+    independentSLAMComponents.size(), threadCount,
+    boost::bind(&MultiScenePipeline::process_scene_frame, boost::cref(independentSLAMComponents), threadCount, boost::ref(processed), _1)
+  );
+
+  std::set<std::string> result;
+  for(size_t i = 0, size = independentSceneIDs.size(); i < size; ++i)
+  {
+    if(processed[i]) result.insert(independentSceneIDs[i]);
+  }
+
+  // Process the mirroring scenes in turn.
+  for(size_t i = 0, size = mirroringSceneIDs.size(); i < size; ++i)
+  {
+    if(mirroringSLAMComponents[i]->process_frame()) result.insert(mirroringSceneIDs[i]);
+  }
+
   return result;
 }
 
@@ -148,6 +188,14 @@ void MultiScenePipeline::set_fusion_enabled(const std::string& sceneID, bool fus
   MapUtil::lookup(m_slamComponents, sceneID)->set_fusion_enabled(fusionEnabled);
 }
 
+void MultiScenePipeline::set_latency_recorder(const LatencyRecorder_Ptr& latencyRecorder)
+{
+  for(std::map<std::string,SLAMComponent_Ptr>::const_iterator it = m_slamComponents.begin(), iend = m_slamComponents.end(); it != iend; ++it)
+  {
+    it->second->set_latency_recorder(latencyRecorder);
+  }
+}
+
 void MultiScenePipeline::set_mapping_client(const std::string& sceneID, const itmx::MappingClient_Ptr& mappingClient)
 {
   MapUtil::call_if_found(m_slamComponents, sceneID, boost::bind(&SLAMComponent::set_mapping_client, _1, mappingClient));
@@ -178,3 +226,27 @@ void MultiScenePipeline::load_models(const SLAMComponent_Ptr& slamComponent, con
   std::cout << "Loading models for " << slamComponent->get_scene_id() << " from: " << inputDir << std::endl;
   slamComponent->load_models(inputDir);
 }
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+void MultiScenePipeline::process_scene_frame(const std::vector<SLAMComponent_Ptr>& slamComponents, size_t threadCount, std::vector<char>& processed, size_t i)
+{
+#ifdef WITH_OPENMP
+  // Divide the cores between the worker threads, rather than letting each of them spawn a full team of OpenMP threads.
+  // Note: The scene may be being processed on the calling thread, so its OpenMP thread count must be restored afterwards.
+  const int ompThreadCount = omp_get_max_threads();
+  omp_set_num_threads(std::max(ompThreadCount / static_cast<int>(std::max<size_t>(threadCount, 1)), 1));
+  try
+  {
+    processed[i] = slamComponents[i]->process_frame();
+  }
+  catch(...)
+  {
+    omp_set_num_threads(ompThreadCount);
+    throw;
+  }
+  omp_set_num_threads(ompThreadCount);
+#else
+  processed[i] = slamComponents[i]->process_frame();
+#endif
+}
@@ -68,6 +68,9 @@ protected:
   /** The propagation components for the scenes. */
   std::map<std::string,spaint::PropagationComponent_Ptr> m_propagationComponents;
 
+  /** The maximum number of scenes whose frames can be processed concurrently in the main section of the pipeline. */
+  size_t m_sceneThreadCount;
+
   /** The semantic segmentation components for the scenes. */
   std::map<std::string,spaint::SemanticSegmentationComponent_Ptr> m_semanticSegmentationComponents;
 
@@ -164,7 +167,9 @@ public:
   /**
    * \brief Runs the main section of the multi-scene pipeline.
    *
-   * This involves processing the next frame (if any) for each individual scene.
+   * This involves processing the next frame (if any) for each individual scene. Since each scene has its own SLAM component
+   * and SLAM state, the scenes are processed concurrently (on up to m_sceneThreadCount worker threads), except that scenes
+   * that mirror the pose of another scene are processed afterwards, in turn, so that the poses they mirror are up to date.
    *
    * \return  The scenes for a which a new frame was available.
    */
@@ -204,6 +209,13 @@ public:
    */
   void set_fusion_enabled(const std::string& sceneID, bool fusionEnabled);
 
+  /**
+   * \brief Sets the recorder (if any) in which the SLAM components for all of the scenes should record the latencies of their stages.
+   *
+   * \param latencyRecorder The recorder (if any) in which the SLAM components should record the latencies of their stages.
+   */
+  void set_latency_recorder(const tvgutil::LatencyRecorder_Ptr& latencyRecorder);
+
   /**
    * \brief Sets the mapping client (if any) for the specified scene.
    *
@@ -235,6 +247,18 @@ protected:
    * \throws std::runtime_error If the input directory does not contain at least a voxel model for a SLAM component.
    */
   void load_models(const spaint::SLAMComponent_Ptr& slamComponent, const std::string& inputDir);
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Processes the next frame (if any) for one of a set of scenes that are being processed concurrently.
+   *
+   * \param slamComponents  The SLAM components for the scenes.
+   * \param threadCount     The number of worker threads on which the scenes are being processed.
+   * \param processed       A vector in which to record whether or not a new frame was available for each scene.
+   * \param i               The index of the scene whose frame should be processed.
+   */
+  static void process_scene_frame(const std::vector<spaint::SLAMComponent_Ptr>& slamComponents, size_t threadCount, std::vector<char>& processed, size_t i);
 };
 
 //#################### TYPEDEFS ####################
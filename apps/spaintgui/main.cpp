@@ -46,6 +46,7 @@
 
 #include <itmx/imagesources/AsyncImageSourceEngine.h>
 #include <itmx/imagesources/RemoteImageSourceEngine.h>
+#include <itmx/imagesources/SensorClockImageSourceEngine.h>
 #ifdef WITH_ZED
 #include <itmx/imagesources/ZedImageSourceEngine.h>
 #endif
@@ -54,6 +55,8 @@
 #include <orx/geometry/GeometryUtil.h>
 
 #include <tvgutil/filesystem/PathFinder.h>
+#include <tvgutil/timing/LatencyRecorder.h>
+#include <tvgutil/timing/Tracer.h>
 
 #include "core/CollaborativePipeline.h"
 #include "core/ObjectivePipeline.h"
@@ -112,17 +115,21 @@ struct CommandLineArguments
   bool saveMeshOnExit;
   bool saveModelsOnExit;
   std::vector<std::string> semanticImageMasks;
+  size_t sensorQueueCapacity;
+  double sensorRate;
   std::vector<std::string> sequenceSpecifiers;
   std::vector<std::string> sequenceTypes;
   std::string subwindowConfigurationIndex;
   std::vector<std::string> trackerSpecifiers;
   bool trackObject;
   bool trackSurfels;
+  std::string traceFilename;
   bool useVicon;
   bool verbose;
   std::string viconHost;
 
   // Derived arguments
+  LatencyRecorder_Ptr latencyRecorder;
   boost::optional<bf::path> modelDir;
   std::vector<Sequence_CPtr> sequences;
 
@@ -174,12 +181,15 @@ struct CommandLineArguments
       ADD_SETTING(saveMeshOnExit);
       ADD_SETTING(saveModelsOnExit);
       ADD_SETTINGS(semanticImageMasks);
+      ADD_SETTING(sensorQueueCapacity);
+      ADD_SETTING(sensorRate);
       ADD_SETTINGS(sequenceSpecifiers);
       ADD_SETTINGS(sequenceTypes);
       ADD_SETTING(subwindowConfigurationIndex);
       ADD_SETTINGS(trackerSpecifiers);
       ADD_SETTING(trackObject);
       ADD_SETTING(trackSurfels);
+      ADD_SETTING(traceFilename);
       ADD_SETTING(useVicon);
       ADD_SETTING(verbose);
       ADD_SETTING(viconHost);
@@ -421,6 +431,26 @@ ImageSourceEngine *make_camera_subengine(const CommandLineArguments& args)
   return cameraSubengine;
 }
 
+/**
+ * \brief Makes a subengine to read images from the specified disk sequence.
+ *
+ * The images are prefetched asynchronously. If the user specified a sensor rate, the prefetched images are then
+ * released on a simulated sensor clock, so that the sequence is replayed as if it were being captured live.
+ *
+ * \param args                The program's command-line arguments.
+ * \param sequence            The disk sequence.
+ * \param calibrationFilename The name of the calibration file to use for the sequence.
+ * \return                    The disk subengine.
+ */
+ImageSourceEngine *make_disk_subengine(const CommandLineArguments& args, const Sequence_CPtr& sequence, const std::string& calibrationFilename)
+{
+  AsyncImageSourceEngine *asyncSubengine = new AsyncImageSourceEngine(sequence->make_image_source_engine(calibrationFilename), args.prefetchBufferCapacity);
+  if(args.sensorRate <= 0.0) return asyncSubengine;
+
+  std::cout << "[spaint] Replaying " << sequence->id() << " on a simulated " << args.sensorRate << "Hz sensor clock\n";
+  return new SensorClockImageSourceEngine(asyncSubengine, args.sensorRate, args.sensorQueueCapacity, args.latencyRecorder, sequence->id());
+}
+
 boost::shared_ptr<CompositeImageSourceEngine> make_image_source_engine(const CommandLineArguments& args)
 {
   boost::shared_ptr<CompositeImageSourceEngine> imageSourceEngine(new CompositeImageSourceEngine);
@@ -442,7 +472,7 @@ boost::shared_ptr<CompositeImageSourceEngine> make_image_source_engine(const Com
     const std::string calibrationFilename = (args.calibrationFilename != "" || !bf::exists(calibrationPath)) ? args.calibrationFilename : calibrationPath.string();
 
     std::cout << "[spaint] Reading images from disk: " << *args.sequences[i] << '\n';
-    imageSourceEngine->addSubengine(new AsyncImageSourceEngine(args.sequences[i]->make_image_source_engine(calibrationFilename), args.prefetchBufferCapacity));
+    imageSourceEngine->addSubengine(make_disk_subengine(args, args.sequences[i], calibrationFilename));
   }
 
   // If no model and no disk sequences were specified, or we want to switch to the camera once all the disk sequences finish, add a camera subengine.
@@ -649,6 +679,15 @@ void postprocess_arguments(CommandLineArguments& args, const po::options_descrip
     throw std::runtime_error("Error: Cannot enable both batch mode and server mode at the same time.");
   }
 
+  // If the user wants to replay the disk sequences on a simulated sensor clock, make sure that batch mode is enabled, since the
+  // simulated sensor starts as soon as the first frame is requested, and so the application must not start off paused. In that
+  // case, also create the recorder in which the latencies of the stages of processing each frame will be recorded.
+  if(args.sensorRate > 0.0)
+  {
+    if(!args.batch) throw std::runtime_error("Error: Replaying disk sequences on a simulated sensor clock requires batch mode.");
+    args.latencyRecorder.reset(new LatencyRecorder);
+  }
+
   // Add the post-processed arguments to the application settings.
   args.add_to_settings(settings);
 }
@@ -696,6 +735,7 @@ bool parse_command_line(int argc, char *argv[], CommandLineArguments& args, cons
     ("subwindowConfigurationIndex", po::value<std::string>(&args.subwindowConfigurationIndex)->default_value("1"), "subwindow configuration index")
     ("trackerSpecifier,t", po::value<std::vector<std::string> >(&args.trackerSpecifiers)->multitoken(), "tracker specifier")
     ("trackSurfels", po::bool_switch(&args.trackSurfels), "enable surfel mapping and tracking")
+    ("traceFile", po::value<std::string>(&args.traceFilename)->default_value(""), "the file to which to write a Chrome trace of the timed spans (requires USE_TRACING)")
     ("useVicon", po::bool_switch(&args.useVicon)->default_value(false), "whether or not to use the Vicon system")
     ("verbose,v", po::bool_switch(&args.verbose), "enable verbose output")
     ("viconHost", po::value<std::string>(&args.viconHost)->default_value("192.168.0.101"), "Vicon host")
@@ -713,6 +753,8 @@ bool parse_command_line(int argc, char *argv[], CommandLineArguments& args, cons
     ("poseMask,p", po::value<std::vector<std::string> >(&args.poseFileMasks)->multitoken(), "pose file mask")
     ("prefetchBufferCapacity,b", po::value<size_t>(&args.prefetchBufferCapacity)->default_value(60), "capacity of the prefetch buffer")
     ("rgbMask,r", po::value<std::vector<std::string> >(&args.rgbImageMasks)->multitoken(), "RGB image mask")
+    ("sensorQueueCapacity", po::value<size_t>(&args.sensorQueueCapacity)->default_value(1), "capacity of the simulated sensor's frame queue (0 = unbounded, i.e. never drop frames)")
+    ("sensorRate", po::value<double>(&args.sensorRate)->default_value(0.0), "rate (in Hz) at which to replay disk sequences on a simulated sensor clock (0 = as fast as possible)")
     ("sequenceSpecifier,s", po::value<std::vector<std::string> >(&args.sequenceSpecifiers)->multitoken(), "sequence specifier")
     ("sequenceType", po::value<std::vector<std::string> >(&args.sequenceTypes)->multitoken(), "sequence type")
   ;
@@ -924,7 +966,7 @@ try
 
       std::cout << "[spaint] Adding local agent for disk sequence: " << *args.sequences[i] << '\n';
       CompositeImageSourceEngine_Ptr imageSourceEngine(new CompositeImageSourceEngine);
-      imageSourceEngine->addSubengine(new AsyncImageSourceEngine(args.sequences[i]->make_image_source_engine(calibrationFilename), args.prefetchBufferCapacity));
+      imageSourceEngine->addSubengine(make_disk_subengine(args, args.sequences[i], calibrationFilename));
 
       imageSourceEngines.push_back(imageSourceEngine);
     }
@@ -959,7 +1001,9 @@ try
   {
     std::cout << "Setting mapping client for host '" << args.host << "' and port '" << args.port << "'\n";
     const pooled_queue::PoolEmptyStrategy poolEmptyStrategy = settings->get_first_value<pooled_queue::PoolEmptyStrategy>("MappingClient.poolEmptyStrategy", pooled_queue::PES_DISCARD);
-    pipeline->set_mapping_client(Model::get_world_scene_id(), MappingClient_Ptr(new MappingClient(args.host, args.port, poolEmptyStrategy)));
+    MappingClient_Ptr mappingClient(new MappingClient(args.host, args.port, poolEmptyStrategy));
+    mappingClient->set_rate_control_enabled(settings->get_first_value<bool>("MappingClient.rateControl", true));
+    pipeline->set_mapping_client(Model::get_world_scene_id(), mappingClient);
   }
 
 #ifdef WITH_LEAP
@@ -967,6 +1011,12 @@ try
   pipeline->get_model()->set_leap_fiducial_id(args.leapFiducialID);
 #endif
 
+  // If requested, record the latencies of the stages of processing each frame.
+  if(args.latencyRecorder) pipeline->set_latency_recorder(args.latencyRecorder);
+
+  // If requested, enable tracing.
+  if(args.traceFilename != "") Tracer::instance().set_enabled(true);
+
   // Configure and run the application.
   Application app(pipeline, args.renderFiducials);
   if(args.batch) app.set_batch_mode_enabled(true);
@@ -974,8 +1024,17 @@ try
   app.set_save_memory_usage(args.profileMemory);
   app.set_save_mesh_on_exit(args.saveMeshOnExit);
   app.set_save_models_on_exit(args.saveModelsOnExit);
+  if(args.latencyRecorder) app.set_latency_recorder(args.latencyRecorder);
   bool runSucceeded = app.run();
 
+  // If tracing was enabled, output the span statistics and write out the trace.
+  if(args.traceFilename != "")
+  {
+    Tracer::instance().set_enabled(false);
+    Tracer::instance().output_statistics(std::cout);
+    Tracer::instance().write_chrome_trace(args.traceFilename);
+  }
+
   // Close all open joysticks.
   joysticks.clear();
 
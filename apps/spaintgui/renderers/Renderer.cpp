@@ -10,6 +10,11 @@ using namespace orx;
 using namespace rigging;
 using namespace tvgutil;
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
 #include <itmx/util/CameraPoseConverter.h>
 using namespace itmx;
 
@@ -26,6 +31,8 @@ using namespace orx;
 #include <spaint/util/CameraFactory.h>
 using namespace spaint;
 
+#include <tvgutil/misc/ConcurrencyUtil.h>
+
 #ifdef WITH_ARRAYFIRE
 #include <spaint/imageprocessing/MedianFilterer.h>
 #include <spaint/selectors/TouchSelector.h>
@@ -190,8 +197,10 @@ private:
 
 Renderer::Renderer(const Model_CPtr& model, const SubwindowConfiguration_Ptr& subwindowConfiguration, const Vector2i& windowViewportSize)
 : m_model(model),
+  m_renderCamera(model->get_settings(), "renderCamera", true),
   m_subwindowConfiguration(subwindowConfiguration),
   m_supersamplingEnabled(false),
+  m_usePixelDebugging(model->get_settings(), "usePixelDebugging", true),
   m_windowViewportSize(windowViewportSize)
 {
   const std::string pipelineType = model->get_settings()->get_first_value<std::string>("pipelineType");
@@ -257,44 +266,29 @@ bool Renderer::get_supersampling_enabled() const
   return m_supersamplingEnabled;
 }
 
-void Renderer::render_client_images() const
+void Renderer::render_client_images(bool scenesChanged) const
 {
   // If a mapping server is not running, early out.
   MappingServer_CPtr mappingServer = m_model->get_mapping_server();
   if(!mappingServer) return;
 
-  // Otherwise, for each client of the mapping server:
-  std::vector<int> clients = mappingServer->get_active_clients();
+  // Make sure that there is a cached render state for each active client of the mapping server, and discard the render states of any clients that have gone away.
+  const std::vector<int> clients = mappingServer->get_active_clients();
+  std::map<int,ClientRenderState_Ptr> clientRenderStates;
   for(size_t i = 0, size = clients.size(); i < size; ++i)
   {
-    // Get the most recent rendering request from the client.
-    const boost::optional<RenderingRequestMessage> request = mappingServer->get_rendering_request(clients[i]);
-    if(!request) continue;
-
-    // Get a handle to the image into which to write.
-    ExclusiveHandle_Ptr<ORUChar4Image_Ptr>::Type imageHandle = mappingServer->get_rendered_image(clients[i]);
-    if(!imageHandle) continue;
-
-    // Make sure the image exists and is of the right size to store the response to the request.
-    ORUChar4Image_Ptr& image = imageHandle->get();
-    if(!image) image.reset(new ORUChar4Image(request->extract_image_size(), true, true));
-    image->ChangeDims(request->extract_image_size());
-
-    // Render the requested image for the client.
-    // FIXME: The camera intrinsics shouldn't be hard-coded.
-    // FIXME: The render states should be cached unless the size changes.
-    std::string primarySceneID = mappingServer->get_scene_id(clients[i]);
-    if(primarySceneID == "") primarySceneID = Model::get_world_scene_id();
-    ITMIntrinsics intrinsics(image->noDims);
-    VoxelRenderState_Ptr voxelRenderState;
-    SurfelRenderState_Ptr surfelRenderState;
-    const bool surfelFlag = false;
-
-    render_all_reconstructed_scenes(
-      request->extract_pose(), primarySceneID, static_cast<VisualisationGenerator::VisualisationType>(request->extract_visualisation_type()),
-      voxelRenderState, surfelRenderState, intrinsics, surfelFlag, image
-    );
+    ClientRenderState_Ptr& clientRenderState = clientRenderStates[clients[i]];
+    std::map<int,ClientRenderState_Ptr>::const_iterator it = m_clientRenderStates.find(clients[i]);
+    if(it != m_clientRenderStates.end()) clientRenderState = it->second;
+    else clientRenderState.reset(new ClientRenderState);
   }
+  m_clientRenderStates.swap(clientRenderStates);
+
+  // Render the images requested by the clients. In CPU mode, we render the images concurrently using the persistent task pool (this is
+  // safe because the scenes are not modified whilst we are rendering, and each client has its own render state). In CUDA mode, the
+  // rendering is already parallelised on the GPU, so we simply render the images one at a time.
+  const size_t threadCount = m_model->get_settings()->deviceType == DEVICE_CPU ? std::max(boost::thread::hardware_concurrency(), 1U) : 1;
+  ConcurrencyUtil::run_tasks(clients.size(), threadCount, boost::bind(&Renderer::render_client_image_at, this, boost::cref(clients), scenesChanged, _1));
 }
 
 void Renderer::set_median_filtering_enabled(bool medianFilteringEnabled)
@@ -407,7 +401,7 @@ void Renderer::render_scene(const Vector2f& fracWindowPos, bool renderFiducials,
 
 #if WITH_GLUT && USE_PIXEL_DEBUGGING
     // If desired, render the value of the pixel to which the user is pointing (for debugging purposes).
-    if(m_model->get_settings()->get_first_value<bool>("usePixelDebugging", true))
+    if(m_usePixelDebugging.get())
     {
       render_pixel_value(fracWindowPos, subwindow);
     }
@@ -434,79 +428,12 @@ void Renderer::set_window(const SDL_Window_Ptr& window)
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
-void Renderer::generate_visualisation(const ORUChar4Image_Ptr& output, const SpaintVoxelScene_CPtr& voxelScene, const SpaintSurfelScene_CPtr& surfelScene,
-                                      VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState, const Relocaliser_CPtr& relocaliser,
-                                      const ORUtils::SE3Pose& pose, const View_CPtr& view, const ITMIntrinsics& intrinsics,
-                                      VisualisationGenerator::VisualisationType visualisationType, bool surfelFlag) const
+void Renderer::generate_composite_visualisation(const ORUtils::SE3Pose& primaryPose, const std::string& primarySceneID,
+                                                VisualisationGenerator::VisualisationType primaryVisualisationType,
+                                                VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState,
+                                                const ITMIntrinsics& intrinsics, bool surfelFlag, std::vector<ORUChar4Image_Ptr>& colourImages,
+                                                std::vector<ORFloatImage_Ptr>& depthImages, const ORUChar4Image_Ptr& output) const
 {
-  VisualisationGenerator_CPtr visualisationGenerator = m_model->get_visualisation_generator();
-
-  switch(visualisationType)
-  {
-    case VisualisationGenerator::VT_INPUT_COLOUR:
-      visualisationGenerator->get_rgb_input(output, view);
-      break;
-    case VisualisationGenerator::VT_INPUT_DEPTH:
-      visualisationGenerator->get_depth_input(output, view);
-      break;
-    case VisualisationGenerator::VT_RELOCALISER_GTPOINTS:
-    case VisualisationGenerator::VT_RELOCALISER_LEAVES:
-    case VisualisationGenerator::VT_RELOCALISER_POINTS:
-    {
-      std::string key = "gtpoints";
-      if(visualisationType == VisualisationGenerator::VT_RELOCALISER_LEAVES) key = "leaves";
-      if(visualisationType == VisualisationGenerator::VT_RELOCALISER_POINTS) key = "points";
-
-      ORUChar4Image_CPtr visualisationImage = relocaliser->get_visualisation_image(key);
-
-      if(visualisationImage)
-      {
-        output->SetFrom(visualisationImage.get(), ORUChar4Image::CPU_TO_CPU);
-        output->UpdateDeviceFromHost();
-      }
-      else output->Clear();
-
-      break;
-    }
-    default:
-    {
-      if(view)
-      {
-        if(surfelFlag) visualisationGenerator->generate_surfel_visualisation(output, surfelScene, pose, intrinsics, surfelRenderState, visualisationType);
-        else visualisationGenerator->generate_voxel_visualisation(output, voxelScene, pose, intrinsics, voxelRenderState, visualisationType, get_postprocessor());
-      }
-      else output->Clear();
-
-      break;
-    }
-  }
-}
-
-const boost::optional<VisualisationGenerator::Postprocessor>& Renderer::get_postprocessor() const
-{
-  // FIXME: At present, median filtering breaks in CPU mode, so we prevent it from running, but we should investigate why.
-  static boost::optional<VisualisationGenerator::Postprocessor> postprocessor = boost::none;
-  if(!m_medianFilteringEnabled && postprocessor)
-  {
-    postprocessor.reset();
-  }
-  else if(m_medianFilteringEnabled && !postprocessor && m_model->get_settings()->deviceType == DEVICE_CUDA)
-  {
-#if defined(WITH_ARRAYFIRE) && !defined(USE_LOW_POWER_MODE)
-    const unsigned int kernelWidth = 3;
-    postprocessor = MedianFilterer(kernelWidth, m_model->get_settings()->deviceType);
-#endif
-  }
-  return postprocessor;
-}
-
-void Renderer::render_all_reconstructed_scenes(const ORUtils::SE3Pose& primaryPose, const std::string& primarySceneID,
-                                               VisualisationGenerator::VisualisationType primaryVisualisationType,
-                                               VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState,
-                                               const ITMIntrinsics& intrinsics, bool surfelFlag, const ORUChar4Image_Ptr& output) const
-{
-  static std::vector<ORUChar4Image_Ptr> colourImages;
-  static std::vector<ORFloatImage_Ptr> depthImages;
   const std::vector<std::string> sceneIDs = m_model->get_scene_ids();
   std::vector<VisualisationGenerator::VisualisationType> visualisationTypes(sceneIDs.size());
 
@@ -601,17 +528,143 @@ void Renderer::render_all_reconstructed_scenes(const ORUtils::SE3Pose& primaryPo
       }
     }
   }
+}
+
+void Renderer::generate_visualisation(const ORUChar4Image_Ptr& output, const SpaintVoxelScene_CPtr& voxelScene, const SpaintSurfelScene_CPtr& surfelScene,
+                                      VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState, const Relocaliser_CPtr& relocaliser,
+                                      const ORUtils::SE3Pose& pose, const View_CPtr& view, const ITMIntrinsics& intrinsics,
+                                      VisualisationGenerator::VisualisationType visualisationType, bool surfelFlag) const
+{
+  VisualisationGenerator_CPtr visualisationGenerator = m_model->get_visualisation_generator();
 
-  // Step 5: Render a quad textured with the final output image.
-  render_image(output);
+  switch(visualisationType)
+  {
+    case VisualisationGenerator::VT_INPUT_COLOUR:
+      visualisationGenerator->get_rgb_input(output, view);
+      break;
+    case VisualisationGenerator::VT_INPUT_DEPTH:
+      visualisationGenerator->get_depth_input(output, view);
+      break;
+    case VisualisationGenerator::VT_RELOCALISER_GTPOINTS:
+    case VisualisationGenerator::VT_RELOCALISER_LEAVES:
+    case VisualisationGenerator::VT_RELOCALISER_POINTS:
+    {
+      std::string key = "gtpoints";
+      if(visualisationType == VisualisationGenerator::VT_RELOCALISER_LEAVES) key = "leaves";
+      if(visualisationType == VisualisationGenerator::VT_RELOCALISER_POINTS) key = "points";
+
+      ORUChar4Image_CPtr visualisationImage = relocaliser->get_visualisation_image(key);
+
+      if(visualisationImage)
+      {
+        output->SetFrom(visualisationImage.get(), ORUChar4Image::CPU_TO_CPU);
+        output->UpdateDeviceFromHost();
+      }
+      else output->Clear();
+
+      break;
+    }
+    default:
+    {
+      if(view)
+      {
+        if(surfelFlag) visualisationGenerator->generate_surfel_visualisation(output, surfelScene, pose, intrinsics, surfelRenderState, visualisationType);
+        else visualisationGenerator->generate_voxel_visualisation(output, voxelScene, pose, intrinsics, voxelRenderState, visualisationType, get_postprocessor());
+      }
+      else output->Clear();
+
+      break;
+    }
+  }
+}
+
+const boost::optional<VisualisationGenerator::Postprocessor>& Renderer::get_postprocessor() const
+{
+  // FIXME: At present, median filtering breaks in CPU mode, so we prevent it from running, but we should investigate why.
+  static boost::optional<VisualisationGenerator::Postprocessor> postprocessor = boost::none;
+  if(!m_medianFilteringEnabled && postprocessor)
+  {
+    postprocessor.reset();
+  }
+  else if(m_medianFilteringEnabled && !postprocessor && m_model->get_settings()->deviceType == DEVICE_CUDA)
+  {
+#if defined(WITH_ARRAYFIRE) && !defined(USE_LOW_POWER_MODE)
+    const unsigned int kernelWidth = 3;
+    postprocessor = MedianFilterer(kernelWidth, m_model->get_settings()->deviceType);
+#endif
+  }
+  return postprocessor;
 }
 
 void Renderer::render_all_reconstructed_scenes(const ORUtils::SE3Pose& primaryPose, Subwindow& subwindow, int viewIndex) const
 {
-  render_all_reconstructed_scenes(
+  // Generate the subwindow image.
+  static std::vector<ORUChar4Image_Ptr> colourImages;
+  static std::vector<ORFloatImage_Ptr> depthImages;
+  generate_composite_visualisation(
     primaryPose, subwindow.get_scene_id(), subwindow.get_type(), subwindow.get_voxel_render_state(viewIndex), subwindow.get_surfel_render_state(viewIndex),
-    subwindow.get_camera_intrinsics(), subwindow.get_surfel_flag(), subwindow.get_image()
+    subwindow.get_camera_intrinsics(), subwindow.get_surfel_flag(), colourImages, depthImages, subwindow.get_image()
   );
+
+  // Render a quad textured with the subwindow image.
+  render_image(subwindow.get_image());
+}
+
+void Renderer::render_client_image(int clientID, const ClientRenderState_Ptr& clientRenderState, bool scenesChanged) const
+{
+  MappingServer_CPtr mappingServer = m_model->get_mapping_server();
+
+  // Get the most recent rendering request from the client.
+  const boost::optional<RenderingRequestMessage> request = mappingServer->get_rendering_request(clientID);
+  if(!request) return;
+
+  // Get a handle to the image into which to write.
+  ExclusiveHandle_Ptr<ORUChar4Image_Ptr>::Type imageHandle = mappingServer->get_rendered_image(clientID);
+  if(!imageHandle) return;
+
+  // Determine the primary scene from which to render the image.
+  std::string primarySceneID = mappingServer->get_scene_id(clientID);
+  if(primarySceneID == "") primarySceneID = Model::get_world_scene_id();
+
+  // If the client's current image is a response to an identical request, and the scenes have not changed since it was rendered, early out.
+  ORUChar4Image_Ptr& image = imageHandle->get();
+  const char *requestBegin = request->get_data_ptr(), *requestEnd = requestBegin + request->get_size();
+  const bool requestChanged = clientRenderState->lastRequest.size() != request->get_size() || !std::equal(requestBegin, requestEnd, clientRenderState->lastRequest.begin());
+  if(image && !scenesChanged && !requestChanged && primarySceneID == clientRenderState->lastPrimarySceneID) return;
+
+  // Make sure the image exists and is of the right size to store the response to the request. If the size has changed,
+  // discard the cached render states so that they will be reallocated at the new size (the scene images are reallocated
+  // automatically by generate_composite_visualisation).
+  const Vector2i imgSize = request->extract_image_size();
+  if(!image) image.reset(new ORUChar4Image(imgSize, true, true));
+  image->ChangeDims(imgSize);
+
+  if(imgSize != clientRenderState->imgSize)
+  {
+    clientRenderState->surfelRenderState.reset();
+    clientRenderState->voxelRenderState.reset();
+    clientRenderState->imgSize = imgSize;
+  }
+
+  // Render the requested image for the client.
+  // FIXME: The camera intrinsics shouldn't be hard-coded.
+  ITMIntrinsics intrinsics(image->noDims);
+  const bool surfelFlag = false;
+  generate_composite_visualisation(
+    request->extract_pose(), primarySceneID, static_cast<VisualisationGenerator::VisualisationType>(request->extract_visualisation_type()),
+    clientRenderState->voxelRenderState, clientRenderState->surfelRenderState, intrinsics, surfelFlag,
+    clientRenderState->colourImages, clientRenderState->depthImages, image
+  );
+
+  // Record the request to which the image is a response, so that we can avoid re-rendering it unnecessarily.
+  clientRenderState->lastRequest.assign(requestBegin, requestEnd);
+  clientRenderState->lastPrimarySceneID = primarySceneID;
+}
+
+void Renderer::render_client_image_at(const std::vector<int>& clientIDs, bool scenesChanged, size_t i) const
+{
+  // Note: The map of client render states is not modified whilst the client images are being rendered, so looking up a render state here is thread-safe.
+  render_client_image(clientIDs[i], m_clientRenderStates.find(clientIDs[i])->second, scenesChanged);
 }
 
 void Renderer::render_image(const ORUChar4Image_CPtr& image, bool useAlphaBlending) const
@@ -704,7 +757,7 @@ void Renderer::render_synthetic_scene(const std::string& sceneID, const SE3Pose&
       glLoadMatrixf(CameraPoseConverter::pose_to_modelview(pose).data());
 
       // If desired, render the default camera.
-      if(m_model->get_settings()->get_first_value<bool>("renderCamera", true))
+      if(m_renderCamera.get())
       {
         static SimpleCamera defaultCam = *CameraFactory::make_default_camera();
         CameraRenderer::render_camera(defaultCam);
@@ -19,6 +19,8 @@
 
 #include <rigging/MoveableCamera.h>
 
+#include <tvgutil/misc/CachedSetting.h>
+
 #include "../core/Model.h"
 #include "../subwindows/SubwindowConfiguration.h"
 
@@ -32,8 +34,43 @@ protected:
   typedef boost::shared_ptr<void> SDL_GLContext_Ptr;
   typedef boost::shared_ptr<SDL_Window> SDL_Window_Ptr;
 
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct holds the state that is cached between frames when rendering images for a client of the mapping server.
+   */
+  struct ClientRenderState
+  {
+
+    /** The colour images into which to render the individual scenes. */
+    std::vector<ORUChar4Image_Ptr> colourImages;
+
+    /** The depth images into which to render the individual scenes. */
+    std::vector<ORFloatImage_Ptr> depthImages;
+
+    /** The size of image for which the render states were allocated. */
+    Vector2i imgSize;
+
+    /** The raw bytes of the rendering request to which the client's current image is a response (empty if no image has been rendered yet). */
+    std::vector<char> lastRequest;
+
+    /** The ID of the primary scene from which the client's current image was rendered. */
+    std::string lastPrimarySceneID;
+
+    /** The surfel render state to use when rendering images for the client. */
+    SurfelRenderState_Ptr surfelRenderState;
+
+    /** The voxel render state to use when rendering images for the client. */
+    VoxelRenderState_Ptr voxelRenderState;
+  };
+
+  typedef boost::shared_ptr<ClientRenderState> ClientRenderState_Ptr;
+
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** The cached render states for the clients of the mapping server (if any), indexed by client ID. */
+  mutable std::map<int,ClientRenderState_Ptr> m_clientRenderStates;
+
   /** The OpenGL context for the window. */
   SDL_GLContext_Ptr m_context;
 
@@ -43,6 +80,9 @@ private:
   /** The spaint model. */
   Model_CPtr m_model;
 
+  /** Whether or not to render the default camera when rendering the synthetic scene. */
+  tvgutil::CachedSetting<bool> m_renderCamera;
+
   /** The sub-window configuration to use for visualising the scene. */
   SubwindowConfiguration_Ptr m_subwindowConfiguration;
 
@@ -52,6 +92,9 @@ private:
   /** The ID of a texture in which to temporarily store the scene raycast and touch image when rendering. */
   GLuint m_textureID;
 
+  /** Whether or not to render the value of the pixel to which the user is pointing (if pixel debugging has been compiled in). */
+  tvgutil::CachedSetting<bool> m_usePixelDebugging;
+
   /** The window into which to render. */
   SDL_Window_Ptr m_window;
 
@@ -151,8 +194,14 @@ public:
 
   /**
    * \brief Renders any images that were requested by clients of the mapping server (if one is active).
+   *
+   * A client's image is only re-rendered if the client has made a different rendering request since its
+   * current image was rendered, or if the scenes may have changed. In CPU mode, the images for different
+   * clients are rendered concurrently.
+   *
+   * \param scenesChanged  Whether or not the scenes may have changed since the client images were last rendered.
    */
-  void render_client_images() const;
+  void render_client_images(bool scenesChanged) const;
 
   /**
    * \brief Sets whether or not to use median filtering when rendering the scene raycast.
@@ -220,6 +269,26 @@ protected:
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Generates a visualisation of all the reconstructed scenes, with appropriate depth testing.
+   *
+   * \param primaryPose               The camera pose in the primary scene.
+   * \param primarySceneID            The ID of the primary scene.
+   * \param primaryVisualisationType  The type of visualisation to use for the primary scene.
+   * \param voxelRenderState          The voxel render state to use for intermediate storage (if relevant).
+   * \param surfelRenderState         The surfel render state to use for intermediate storage (if relevant).
+   * \param intrinsics                The intrinsics to use when rendering synthetic scene visualisations.
+   * \param surfelFlag                Whether or not to render a surfel visualisation rather than a voxel one.
+   * \param colourImages              The colour images into which to render the individual scenes (reallocated as needed).
+   * \param depthImages               The depth images into which to render the individual scenes (reallocated as needed).
+   * \param output                    The location into which to put the output image.
+   */
+  void generate_composite_visualisation(const ORUtils::SE3Pose& primaryPose, const std::string& primarySceneID,
+                                        spaint::VisualisationGenerator::VisualisationType primaryVisualisationType,
+                                        VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState,
+                                        const ITMLib::ITMIntrinsics& intrinsics, bool surfelFlag, std::vector<ORUChar4Image_Ptr>& colourImages,
+                                        std::vector<ORFloatImage_Ptr>& depthImages, const ORUChar4Image_Ptr& output) const;
+
   /**
    * \brief Generates a visualisation of the scene.
    *
@@ -248,21 +317,22 @@ private:
   const boost::optional<spaint::VisualisationGenerator::Postprocessor>& get_postprocessor() const;
 
   /**
-   * \brief Renders all the reconstructed scenes into an image, with appropriate depth testing.
+   * \brief Renders the image requested by the specified client of the mapping server (if necessary).
    *
-   * \param primaryPose               The camera pose in the primary scene.
-   * \param primarySceneID            The ID of the primary scene.
-   * \param primaryVisualisationType  The type of visualisation to use for the primary scene.
-   * \param voxelRenderState          The voxel render state to use for intermediate storage (if relevant).
-   * \param surfelRenderState         The surfel render state to use for intermediate storage (if relevant).
-   * \param intrinsics                The intrinsics to use when rendering synthetic scene visualisations.
-   * \param surfelFlag                Whether or not to render a surfel visualisation rather than a voxel one.
-   * \param output                    The location into which to put the output image.
+   * \param clientID          The ID of the client.
+   * \param clientRenderState The cached render state for the client.
+   * \param scenesChanged     Whether or not the scenes may have changed since the client's image was last rendered.
+   */
+  void render_client_image(int clientID, const ClientRenderState_Ptr& clientRenderState, bool scenesChanged) const;
+
+  /**
+   * \brief Renders the image requested by the client of the mapping server with the specified index.
+   *
+   * \param clientIDs     The IDs of the clients.
+   * \param scenesChanged Whether or not the scenes may have changed since the client images were last rendered.
+   * \param i             The index of the client whose image should be rendered.
    */
-  void render_all_reconstructed_scenes(const ORUtils::SE3Pose& primaryPose, const std::string& primarySceneID,
-                                       spaint::VisualisationGenerator::VisualisationType primaryVisualisationType,
-                                       VoxelRenderState_Ptr& voxelRenderState, SurfelRenderState_Ptr& surfelRenderState,
-                                       const ITMLib::ITMIntrinsics& intrinsics, bool surfelFlag, const ORUChar4Image_Ptr& output) const;
+  void render_client_image_at(const std::vector<int>& clientIDs, bool scenesChanged, size_t i) const;
 
   /**
    * \brief Renders all the reconstructed scenes into a sub-window, with appropriate depth testing.
@@ -0,0 +1,207 @@
+/**
+ * touchtrain: DescriptorCache.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_TOUCHTRAIN_DESCRIPTORCACHE
+#define H_TOUCHTRAIN_DESCRIPTORCACHE
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+
+#include <rafl/base/Descriptor.h>
+
+/**
+ * \brief An instance of this class represents a disk-based cache of the descriptors computed for the images in a touchtrain dataset.
+ *
+ * Decoding the images and computing their descriptors is expensive, and the images rarely change between runs, so the
+ * descriptors are saved to disk and reused until the corresponding images are modified. Each image is identified by its
+ * path, and is assumed to have been modified if either its last write time or its size has changed.
+ *
+ * The cache file starts with a header line, in the format: DescriptorCache <formatVersion> <descriptorVersion>, and then contains
+ * one line per image, in the format: <lastWriteTime> <fileSize> <descriptorSize> <values...> <path>. If the header does not match
+ * the current format version and the version of the descriptors being computed, the whole cache is ignored, since its descriptors
+ * may have been computed differently.
+ */
+class DescriptorCache
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a cached descriptor.
+   */
+  struct Entry
+  {
+    /** The descriptor. */
+    rafl::Descriptor_CPtr descriptor;
+
+    /** The size of the image when the descriptor was computed. */
+    boost::uintmax_t fileSize;
+
+    /** The last write time of the image when the descriptor was computed. */
+    std::time_t lastWriteTime;
+  };
+
+  //#################### CONSTANTS ####################
+private:
+  /** The version of the cache file format. This must be incremented whenever the format changes. */
+  static const int FORMAT_VERSION = 1;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The version of the descriptors in the cache. */
+  int m_descriptorVersion;
+
+  /** The cached descriptors (indexed by image path). */
+  std::map<std::string,Entry> m_entries;
+
+  /** The path to the cache file. */
+  std::string m_path;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a descriptor cache, loading any descriptors that have previously been saved to the specified cache file.
+   *
+   * Any malformed lines in the cache file are ignored (the corresponding descriptors will simply be recomputed). If the cache file
+   * was written in a different format, or for a different version of the descriptors, none of its descriptors are loaded.
+   *
+   * \param path              The path to the cache file.
+   * \param descriptorVersion The version of the descriptors being computed.
+   */
+  DescriptorCache(const std::string& path, int descriptorVersion)
+  : m_descriptorVersion(descriptorVersion), m_path(path)
+  {
+    std::ifstream fs(path.c_str());
+    std::string line;
+    if(!std::getline(fs, line)) return;
+
+    if(line != make_header())
+    {
+      std::cerr << "Warning: The descriptor cache file '" << path << "' was written in a different format or for different descriptors, and will be ignored\n";
+      return;
+    }
+
+    while(std::getline(fs, line))
+    {
+      std::istringstream is(line);
+      Entry entry;
+      size_t descriptorSize;
+      if(!(is >> entry.lastWriteTime >> entry.fileSize >> descriptorSize)) continue;
+
+      rafl::Descriptor_Ptr descriptor(new rafl::Descriptor(descriptorSize));
+      for(size_t i = 0; i < descriptorSize; ++i) is >> (*descriptor)[i];
+
+      std::string imagePath;
+      if(!(is >> std::ws) || !std::getline(is, imagePath)) continue;
+
+      entry.descriptor = descriptor;
+      m_entries[imagePath] = entry;
+    }
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Looks up the cached descriptor for the specified image.
+   *
+   * \param imagePath The path to the image.
+   * \return          The cached descriptor for the image, if the image has not been modified since it was computed, or NULL otherwise.
+   */
+  rafl::Descriptor_CPtr lookup(const std::string& imagePath) const
+  {
+    std::map<std::string,Entry>::const_iterator it = m_entries.find(imagePath);
+    if(it == m_entries.end()) return rafl::Descriptor_CPtr();
+
+    std::time_t lastWriteTime;
+    boost::uintmax_t fileSize;
+    if(!get_file_stats(imagePath, lastWriteTime, fileSize) || lastWriteTime != it->second.lastWriteTime || fileSize != it->second.fileSize)
+    {
+      return rafl::Descriptor_CPtr();
+    }
+
+    return it->second.descriptor;
+  }
+
+  /**
+   * \brief Saves the cached descriptors to the cache file.
+   *
+   * \throws std::runtime_error If the cache file cannot be written.
+   */
+  void save() const
+  {
+    std::ofstream fs(m_path.c_str());
+    if(!fs) throw std::runtime_error("Error: The descriptor cache file '" + m_path + "' could not be opened for writing");
+
+    // Note: The values are written with enough precision to ensure that they will be read back exactly.
+    fs << make_header() << '\n' << std::setprecision(9);
+    for(std::map<std::string,Entry>::const_iterator it = m_entries.begin(), iend = m_entries.end(); it != iend; ++it)
+    {
+      const Entry& entry = it->second;
+      fs << entry.lastWriteTime << ' ' << entry.fileSize << ' ' << entry.descriptor->size();
+      for(size_t i = 0, size = entry.descriptor->size(); i < size; ++i)
+      {
+        fs << ' ' << (*entry.descriptor)[i];
+      }
+      fs << ' ' << it->first << '\n';
+    }
+  }
+
+  /**
+   * \brief Stores the descriptor computed for the specified image in the cache.
+   *
+   * If the image cannot be found, the descriptor is not stored.
+   *
+   * \param imagePath   The path to the image.
+   * \param descriptor  The descriptor computed for the image.
+   */
+  void store(const std::string& imagePath, const rafl::Descriptor_CPtr& descriptor)
+  {
+    Entry entry;
+    entry.descriptor = descriptor;
+    if(get_file_stats(imagePath, entry.lastWriteTime, entry.fileSize)) m_entries[imagePath] = entry;
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Makes the header line for the cache file.
+   *
+   * \return The header line for the cache file.
+   */
+  std::string make_header() const
+  {
+    std::ostringstream oss;
+    oss << "DescriptorCache " << FORMAT_VERSION << ' ' << m_descriptorVersion;
+    return oss.str();
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Gets the last write time and size of the specified file.
+   *
+   * \param path          The path to the file.
+   * \param lastWriteTime A variable into which to write the last write time of the file.
+   * \param fileSize      A variable into which to write the size of the file.
+   * \return              true, if the file's statistics could be determined, or false otherwise.
+   */
+  static bool get_file_stats(const std::string& path, std::time_t& lastWriteTime, boost::uintmax_t& fileSize)
+  {
+    boost::system::error_code timeError, sizeError;
+    lastWriteTime = boost::filesystem::last_write_time(path, timeError);
+    fileSize = boost::filesystem::file_size(path, sizeError);
+    return !timeError && !sizeError;
+  }
+};
+
+#endif
@@ -28,6 +28,9 @@ private:
   /** The directory in which to store the tables of results generated during cross-validation. */
   std::string m_crossValidationResultsDir;
 
+  /** The path to the file in which to cache the descriptors computed for the training images. */
+  std::string m_descriptorCachePath;
+
   /** The directory in which to store the output models (i.e. the random forests). */
   std::string m_modelsDir;
 
@@ -46,7 +49,7 @@ public:
    * \param sequenceNumbers The sequence numbers to be included during training.
    */
   TouchTrainDataset(const std::string& rootDir, const std::vector<size_t>& sequenceNumbers)
-  : m_rootDir(rootDir)
+  : m_descriptorCachePath(rootDir + "/descriptorcache.txt"), m_rootDir(rootDir)
   {
     // Maintain a count of the files and directories that are unexpectedly not found.
     size_t invalidCount = 0;
@@ -104,6 +107,16 @@ public:
     return m_crossValidationResultsDir;
   }
 
+  /**
+   * \brief Gets the path to the file in which to cache the descriptors computed for the training images.
+   *
+   * \return  The path to the file in which to cache the descriptors computed for the training images.
+   */
+  const std::string& get_descriptor_cache_path() const
+  {
+    return m_descriptorCachePath;
+  }
+
   /**
    * \brief Gets the directory in which to store the output models.
    *
@@ -3,7 +3,12 @@
  * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
  */
 
+#include <algorithm>
+
 #include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
 using boost::assign::list_of;
 
 #include <evaluation/core/ParamSetUtil.h>
@@ -21,11 +26,13 @@ using namespace raflevaluation;
 #include <spaint/touch/TouchDescriptorCalculator.h>
 using namespace spaint;
 
+#include <tvgutil/misc/ConcurrencyUtil.h>
 #include <tvgutil/persistence/SerializationUtil.h>
 #include <tvgutil/timing/Timer.h>
 #include <tvgutil/timing/TimeUtil.h>
 using namespace tvgutil;
 
+#include "DescriptorCache.h"
 #include "LabelledPath.h"
 #include "TouchTrainDataset.h"
 
@@ -34,29 +41,78 @@ using namespace tvgutil;
 typedef int Label;
 typedef DecisionTree<Label> DT;
 typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+typedef LearnerEvaluator<Example<Label>,PerformanceResult> LE;
+typedef boost::shared_ptr<const LE> LE_CPtr;
 typedef RandomForest<Label> RF;
 typedef boost::shared_ptr<RF> RF_Ptr;
 
 //#################### FUNCTIONS ####################
 
+/**
+ * \brief Decodes one of a set of images and calculates its histogram descriptor.
+ *
+ * \param labelledImagePaths  The labelled image paths.
+ * \param imageIndices        The indices of the images whose descriptors need to be calculated.
+ * \param descriptors         The descriptors for the images (indexed by labelled image path).
+ * \param i                   The index (in imageIndices) of the image whose descriptor should be calculated.
+ */
+void calculate_descriptor(const std::vector<LabelledPath<Label> >& labelledImagePaths, const std::vector<size_t>& imageIndices,
+                          std::vector<Descriptor_CPtr>& descriptors, size_t i)
+{
+  const size_t imageIndex = imageIndices[i];
+  af::array img = af::loadImage(labelledImagePaths[imageIndex].path.c_str());
+  descriptors[imageIndex] = TouchDescriptorCalculator::calculate_histogram_descriptor(img);
+}
+
 /**
  * \brief Generates an array of examples given an array of labelled image paths.
  *
+ * The descriptors for any images that are not in the descriptor cache (or that have been modified since their descriptors were
+ * cached) are calculated in parallel and added to the cache, which is then saved.
+ *
  * \param labelledImagePaths  The labelled image paths.
+ * \param descriptorCache     The descriptor cache.
+ * \param threadCount         The maximum number of threads to use to calculate descriptors.
  * \return                    The examples.
  */
-std::vector<boost::shared_ptr<const Example<Label> > > generate_examples(const std::vector<LabelledPath<Label> >& labelledImagePaths)
+std::vector<boost::shared_ptr<const Example<Label> > > generate_examples(const std::vector<LabelledPath<Label> >& labelledImagePaths, DescriptorCache& descriptorCache, size_t threadCount)
 {
   const size_t labelledImagePathCount = labelledImagePaths.size();
 
-  typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
-  std::vector<Example_CPtr> examples(labelledImagePathCount);
+  // Look up the descriptors for the images in the cache, and note the images whose descriptors need to be calculated.
+  std::vector<Descriptor_CPtr> descriptors(labelledImagePathCount);
+  std::vector<size_t> uncachedImageIndices;
+  for(size_t i = 0; i < labelledImagePathCount; ++i)
+  {
+    descriptors[i] = descriptorCache.lookup(labelledImagePaths[i].path);
+    if(!descriptors[i]) uncachedImageIndices.push_back(i);
+  }
 
+  std::cout << "[touchtrain] Calculating descriptors for " << uncachedImageIndices.size() << " uncached images...\n";
+
+  // Calculate the missing descriptors in parallel.
+  ConcurrencyUtil::run_tasks(
+    uncachedImageIndices.size(), threadCount,
+    boost::bind(calculate_descriptor, boost::cref(labelledImagePaths), boost::cref(uncachedImageIndices), boost::ref(descriptors), _1)
+  );
+
+  // Add the newly-calculated descriptors to the cache, and save it.
+  if(!uncachedImageIndices.empty())
+  {
+    for(size_t i = 0, size = uncachedImageIndices.size(); i < size; ++i)
+    {
+      const size_t imageIndex = uncachedImageIndices[i];
+      descriptorCache.store(labelledImagePaths[imageIndex].path, descriptors[imageIndex]);
+    }
+
+    descriptorCache.save();
+  }
+
+  // Make the examples.
+  std::vector<Example_CPtr> examples(labelledImagePathCount);
   for(size_t i = 0; i < labelledImagePathCount; ++i)
   {
-    af::array img = af::loadImage(labelledImagePaths[i].path.c_str());
-    Descriptor_CPtr descriptor = TouchDescriptorCalculator::calculate_histogram_descriptor(img);
-    examples[i].reset(new Example<Label>(descriptor, labelledImagePaths[i].label));
+    examples[i].reset(new Example<Label>(descriptors[i], labelledImagePaths[i].label));
   }
 
   return examples;
@@ -64,12 +120,16 @@ std::vector<boost::shared_ptr<const Example<Label> > > generate_examples(const s
 
 int main(int argc, char *argv[])
 {
-  if(argc != 2)
+  if(argc != 2 && argc != 3)
   {
-    std::cerr << "Usage: touchtrain [<touch training set path>]\n";
+    std::cerr << "Usage: touchtrain <touch training set path> [<thread count>]\n";
     return EXIT_FAILURE;
   }
 
+  // Determine the number of threads to use (by default, one per hardware thread).
+  const size_t threadCount = argc == 3 ? boost::lexical_cast<size_t>(argv[2]) : std::max<size_t>(boost::thread::hardware_concurrency(), 1);
+  std::cout << "[touchtrain] Using " << threadCount << " threads\n";
+
 #if WITH_OPENMP
   omp_set_nested(1);
 #endif
@@ -79,8 +139,12 @@ int main(int argc, char *argv[])
 
   // Generate the examples with which to train the random forest.
   std::cout << "[touchtrain] Generating examples...\n";
-  std::vector<Example_CPtr> examples = generate_examples(dataset.get_training_image_paths());
+  Timer<boost::chrono::milliseconds> examplesTimer("ExampleGenerationTime");
+  DescriptorCache descriptorCache(dataset.get_descriptor_cache_path(), TouchDescriptorCalculator::DESCRIPTOR_VERSION);
+  std::vector<Example_CPtr> examples = generate_examples(dataset.get_training_image_paths(), descriptorCache, threadCount);
+  examplesTimer.stop();
   std::cout << "[touchtrain] Number of examples = " << examples.size() << '\n';
+  std::cout << "[touchtrain] " << examplesTimer << '\n';
 
   // Generate the parameter sets with which to test the random forest.
   const unsigned int seed = 12345;
@@ -111,15 +175,21 @@ int main(int argc, char *argv[])
   // Time the evaluation of the random forest.
   Timer<boost::chrono::seconds> timer("ForestEvaluationTime");
 
-  // Evaluate the random forest on the various different parameter sets.
+  // Evaluate the random forest on the various different parameter sets. Each (parameter set, fold) pair is evaluated as
+  // a separate task, and the results are identical to those that would be obtained by evaluating the parameter sets in turn.
   std::cout << "[touchtrain] Cross-validating the performance of the forest on various parameter sets...\n";
+  std::vector<LE_CPtr> evaluators;
+  for(size_t n = 0, size = params.size(); n < size; ++n)
+  {
+    evaluators.push_back(LE_CPtr(new RandomForestEvaluator<Label>(splitGenerator, params[n])));
+  }
+
+  std::vector<PerformanceResult> evaluationResults = LE::evaluate_concurrently(evaluators, examples, threadCount);
+
   PerformanceTable results(list_of("Accuracy"));
-  boost::shared_ptr<RandomForestEvaluator<Label> > evaluator;
   for(size_t n = 0, size = params.size(); n < size; ++n)
   {
-    evaluator.reset(new RandomForestEvaluator<Label>(splitGenerator, params[n]));
-    PerformanceResult result = evaluator->evaluate(examples);
-    results.record_performance(params[n], result);
+    results.record_performance(params[n], evaluationResults[n]);
   }
 
   // Output the performance table.
@@ -0,0 +1,15 @@
+##########################
+# OfferAVX2Support.cmake #
+##########################
+
+OPTION(WITH_AVX2 "Enable AVX2 code paths (the resulting binaries will only run on CPUs that support AVX2)?" OFF)
+
+IF(WITH_AVX2)
+  # Note: We deliberately don't enable FMA here, since allowing the compiler to fuse multiplies and adds
+  #       would change the results of some floating-point computations (e.g. the RGBD patch features).
+  IF(MSVC_IDE)
+    SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /arch:AVX2")
+  ELSE()
+    SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2")
+  ENDIF()
+ENDIF()
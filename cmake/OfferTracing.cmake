@@ -0,0 +1,9 @@
+######################
+# OfferTracing.cmake #
+######################
+
+OPTION(USE_TRACING "Compile in support for tracing spans (timed sections of code)?" OFF)
+
+IF(USE_TRACING)
+  ADD_DEFINITIONS(-DUSE_TRACING)
+ENDIF()
@@ -6,6 +6,14 @@
 #ifndef H_EVALUATION_LEARNEREVALUATOR
 #define H_EVALUATION_LEARNEREVALUATOR
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/misc/ConcurrencyUtil.h>
+
 #include "../splitgenerators/SplitGenerator.h"
 
 namespace evaluation {
@@ -74,25 +82,116 @@ public:
    */
   Result evaluate(const std::vector<Example_CPtr>& examples) const
   {
-    std::vector<Result> results;
     std::vector<SplitGenerator::Split> splits = m_splitGenerator->generate_splits(examples.size());
     int size = static_cast<int>(splits.size());
 
+    // Note: Each result is written to the slot corresponding to its split, so that the results are always averaged in the same order.
+    std::vector<Result> results(size);
+
 #ifdef WITH_OPENMP
     #pragma omp parallel for
 #endif
     for(int i = 0; i < size; ++i)
     {
-      Result evaluationResult = evaluate_on_split(examples, splits[i]);
-
-#ifdef WITH_OPENMP
-      #pragma omp critical
-#endif
-      results.push_back(evaluationResult);
+      results[i] = evaluate_on_split(examples, splits[i]);
     }
 
     return average_results(results);
   }
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Evaluates a set of learners (e.g. the same learner with different parameter sets) on the specified set of examples.
+   *
+   * Evaluating a learner on a split is an independent task, so rather than evaluating the learners one at a time, the tasks for
+   * all of the learners are scheduled together on a pool of worker threads. This keeps all of the threads busy, even when there
+   * are fewer splits than threads or the tasks take very different lengths of time. Since the threads already run the tasks in
+   * parallel, any OpenMP loops within the tasks are run serially.
+   *
+   * The splits for each learner are generated in turn, before any of the tasks are run, so each learner is evaluated on the same
+   * splits as it would be if evaluate were called on the learners in sequence (even if they share a split generator). Any random
+   * numbers used by a task must come from a generator that is owned by the task (e.g. one seeded from the learner's parameters),
+   * so that the results are identical to those of a sequential evaluation, whatever the thread count.
+   *
+   * \param evaluators  The evaluators for the learners.
+   * \param examples    The examples on which to evaluate the learners.
+   * \param threadCount The maximum number of worker threads to use.
+   * \return            The results of evaluating each learner.
+   */
+  static std::vector<Result> evaluate_concurrently(const std::vector<boost::shared_ptr<const LearnerEvaluator> >& evaluators,
+                                                   const std::vector<Example_CPtr>& examples, size_t threadCount)
+  {
+    const size_t evaluatorCount = evaluators.size();
+    std::vector<std::vector<SplitGenerator::Split> > splits(evaluatorCount);
+    std::vector<std::vector<Result> > splitResults(evaluatorCount);
+    std::vector<std::pair<size_t,size_t> > tasks;
+
+    // Generate the splits for each learner in turn, and make a task for each (learner, split) pair.
+    for(size_t i = 0; i < evaluatorCount; ++i)
+    {
+      splits[i] = evaluators[i]->m_splitGenerator->generate_splits(examples.size());
+      splitResults[i].resize(splits[i].size());
+      for(size_t j = 0, splitCount = splits[i].size(); j < splitCount; ++j)
+      {
+        tasks.push_back(std::make_pair(i, j));
+      }
+    }
+
+    // Run the tasks.
+    tvgutil::ConcurrencyUtil::run_tasks(
+      tasks.size(), threadCount,
+      boost::bind(&LearnerEvaluator::run_split_task, boost::cref(evaluators), boost::cref(examples), boost::cref(splits), boost::cref(tasks), boost::ref(splitResults), _1)
+    );
+
+    // Average the results for each learner.
+    std::vector<Result> results;
+    results.reserve(evaluatorCount);
+    for(size_t i = 0; i < evaluatorCount; ++i)
+    {
+      results.push_back(evaluators[i]->average_results(splitResults[i]));
+    }
+
+    return results;
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Evaluates a learner on one of its splits.
+   *
+   * \param evaluators    The evaluators for the learners.
+   * \param examples      The examples on which to evaluate the learners.
+   * \param splits        The splits for each learner.
+   * \param tasks         The (learner, split) pairs to evaluate.
+   * \param splitResults  The results for each split of each learner.
+   * \param taskIndex     The index of the (learner, split) pair to evaluate.
+   */
+  static void run_split_task(const std::vector<boost::shared_ptr<const LearnerEvaluator> >& evaluators, const std::vector<Example_CPtr>& examples,
+                             const std::vector<std::vector<SplitGenerator::Split> >& splits, const std::vector<std::pair<size_t,size_t> >& tasks,
+                             std::vector<std::vector<Result> >& splitResults, size_t taskIndex)
+  {
+    const size_t evaluatorIndex = tasks[taskIndex].first, splitIndex = tasks[taskIndex].second;
+
+#ifdef WITH_OPENMP
+    // The tasks already keep all of the worker threads busy, so avoid spawning a team of OpenMP threads within each of them.
+    // Note: The task may be running on the calling thread, so its OpenMP thread count must be restored afterwards.
+    const int ompThreadCount = omp_get_max_threads();
+    omp_set_num_threads(1);
+    try
+    {
+      splitResults[evaluatorIndex][splitIndex] = evaluators[evaluatorIndex]->evaluate_on_split(examples, splits[evaluatorIndex][splitIndex]);
+    }
+    catch(...)
+    {
+      omp_set_num_threads(ompThreadCount);
+      throw;
+    }
+    omp_set_num_threads(ompThreadCount);
+#else
+    splitResults[evaluatorIndex][splitIndex] = evaluators[evaluatorIndex]->evaluate_on_split(examples, splits[evaluatorIndex][splitIndex]);
+#endif
+  }
 };
 
 }
@@ -12,6 +12,8 @@ namespace evaluation {
 
 /**
  * \brief An instance of this class uses coordinate descent with random restarts to find a parameter set with as low a cost as possible.
+ *
+ * The costs of all of the values along each coordinate axis are computed as a single batch, and so can be evaluated concurrently.
  */
 class CoordinateDescentParameterOptimiser : public EpochBasedParameterOptimiser
 {
@@ -23,8 +25,9 @@ public:
    * \param costFunction  The cost function to use to evaluate the different parameter sets.
    * \param epochCount    The number of epochs for which coordinate descent should be run.
    * \param seed          The seed for the random number generator.
+   * \param threadCount   The maximum number of parameter sets to evaluate concurrently (the cost function must be thread-safe if this is > 1).
    */
-  CoordinateDescentParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed);
+  CoordinateDescentParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed, size_t threadCount = 1);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
@@ -21,13 +21,14 @@ namespace evaluation {
 class EpochBasedParameterOptimiser
 {
   //#################### TYPEDEFS ####################
-protected:
+public:
+  typedef boost::function<std::vector<float>(const std::vector<ParamSet>&)> BatchCostFunction;
   typedef boost::function<float(const ParamSet&)> CostFunction;
 
   //#################### PRIVATE VARIABLES ####################
 private:
-  /** The cost function to use to evaluate the different parameter sets. */
-  CostFunction m_costFunction;
+  /** The function to use to evaluate batches of parameter sets (the sets in a batch are independent, so may be evaluated concurrently). */
+  BatchCostFunction m_batchCostFunction;
 
   /** The number of epochs for which optimisation should be run. */
   size_t m_epochCount;
@@ -48,8 +49,16 @@ public:
    * \param costFunction  The cost function to use to evaluate the different parameter sets.
    * \param epochCount    The number of epochs for which coordinate descent should be run.
    * \param seed          The seed for the random number generator.
+   * \param threadCount   The maximum number of parameter sets to evaluate concurrently (the cost function must be thread-safe if this is > 1).
+   */
+  EpochBasedParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed, size_t threadCount = 1);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the optimiser.
    */
-  EpochBasedParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed);
+  virtual ~EpochBasedParameterOptimiser();
 
   //#################### PRIVATE ABSTRACT MEMBER FUNCTIONS ####################
 private:
@@ -61,6 +70,20 @@ private:
    */
   virtual std::pair<std::vector<size_t>,float> optimise_value_indices(const std::vector<size_t>& initialValueIndices) const = 0;
 
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes a batch cost function that evaluates the parameter sets in each batch using the specified cost function.
+   *
+   * The costs are always returned in the same order as the parameter sets, irrespective of the order in which
+   * the evaluations finish, so the results of an optimisation do not depend on the number of threads used.
+   *
+   * \param costFunction  The cost function to use to evaluate each parameter set (must be thread-safe if threadCount > 1).
+   * \param threadCount   The maximum number of parameter sets to evaluate concurrently.
+   * \return              The batch cost function.
+   */
+  static BatchCostFunction make_batch_cost_function(const CostFunction& costFunction, size_t threadCount);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -94,6 +117,16 @@ public:
    */
   ParamSet optimise_for_parameters(float *bestCost = NULL) const;
 
+  /**
+   * \brief Replaces the function used to evaluate batches of parameter sets.
+   *
+   * This can be used by clients that can evaluate a batch of parameter sets more efficiently than by evaluating them individually
+   * (e.g. because they can share work between the sets in the batch).
+   *
+   * \param batchCostFunction The new batch cost function.
+   */
+  virtual void set_batch_cost_function(const BatchCostFunction& batchCostFunction);
+
   //#################### PROTECTED MEMBER FUNCTIONS ####################
 protected:
   /**
@@ -105,8 +138,31 @@ protected:
    */
   float compute_cost(const std::vector<size_t>& valueIndices) const;
 
+  /**
+   * \brief Computes the costs associated with several sets of parameter value indices as a single batch.
+   *
+   * \param valueIndicesBatch The sets of parameter value indices.
+   * \return                  The costs associated with the sets of parameter value indices (in the same order).
+   */
+  std::vector<float> compute_costs(const std::vector<std::vector<size_t> >& valueIndicesBatch) const;
+
+  /**
+   * \brief Makes the parameter set corresponding to the specified parameter value indices.
+   *
+   * \param valueIndices  A set of parameter value indices, denoting particular settings for the parameters.
+   * \return              The corresponding parameter set.
+   */
+  ParamSet make_param_set(const std::vector<size_t>& valueIndices) const;
+
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Gets the number of epochs whose initial parameter value indices should be optimised together as a batch.
+   *
+   * \return  The number of epochs whose initial parameter value indices should be optimised together as a batch.
+   */
+  virtual size_t epoch_batch_size() const;
+
   /**
    * \brief Generates a random set of parameter value indices, denoting particular settings for the parameters.
    *
@@ -115,12 +171,39 @@ private:
   std::vector<size_t> generate_random_value_indices() const;
 
   /**
-   * \brief Makes the parameter set corresponding to the specified parameter value indices.
+   * \brief Optimises the initial sets of parameter value indices for a batch of epochs.
    *
-   * \param valueIndices  A set of parameter value indices, denoting particular settings for the parameters.
-   * \return              The corresponding parameter set.
+   * By default, this simply optimises each set of initial indices in turn using optimise_value_indices.
+   *
+   * \param initialValueIndicesBatch  The initial sets of parameter value indices.
+   * \return                          The optimised candidate sets of parameter value indices and their associated costs.
    */
-  ParamSet make_param_set(const std::vector<size_t>& valueIndices) const;
+  virtual std::vector<std::pair<std::vector<size_t>,float> > optimise_value_indices_batch(const std::vector<std::vector<size_t> >& initialValueIndicesBatch) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Evaluates a single parameter set in a batch using the specified cost function.
+   *
+   * \param costFunction  The cost function to use to evaluate the parameter set.
+   * \param paramSets     The parameter sets in the batch.
+   * \param costs         The vector into which to write the costs of the parameter sets.
+   * \param i             The index of the parameter set to evaluate.
+   */
+  static void compute_cost_task(const CostFunction& costFunction, const std::vector<ParamSet>& paramSets, std::vector<float>& costs, size_t i);
+
+  /**
+   * \brief Evaluates a batch of parameter sets using the specified cost function, using up to the specified number of threads.
+   *
+   * The parameter sets are evaluated as tasks on tvgutil::ConcurrencyUtil's persistent thread pool. If the cost function throws
+   * for any parameter set, the exception is rethrown (with its original type) once the evaluations that are running have finished.
+   *
+   * \param costFunction  The cost function to use to evaluate each parameter set.
+   * \param threadCount   The maximum number of parameter sets to evaluate concurrently.
+   * \param paramSets     The parameter sets.
+   * \return              The costs of the parameter sets (in the same order as the parameter sets).
+   */
+  static std::vector<float> compute_costs_concurrently(const CostFunction& costFunction, size_t threadCount, const std::vector<ParamSet>& paramSets);
 };
 
 }
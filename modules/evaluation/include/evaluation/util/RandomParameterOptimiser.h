@@ -12,9 +12,17 @@ namespace evaluation {
 
 /**
  * \brief An instance of this class uses random parameter generation to find a parameter set with as low a cost as possible.
+ *
+ * The parameter sets are generated in batches, and the costs of the sets in each batch are computed together (and so can be
+ * evaluated concurrently). The parameter sets generated, and hence the results, do not depend on the batch size.
  */
 class RandomParameterOptimiser : public EpochBasedParameterOptimiser
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The number of parameter sets to generate and evaluate as a single batch. */
+  size_t m_batchSize;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -23,13 +31,21 @@ public:
    * \param costFunction  The cost function to use to evaluate the different parameter sets.
    * \param epochCount    The number of epochs for which the random parameter generation should be run.
    * \param seed          The seed for the random number generator.
+   * \param threadCount   The maximum number of parameter sets to evaluate concurrently (the cost function must be thread-safe if this is > 1).
+   * \param batchSize     The number of parameter sets to generate and evaluate as a single batch (defaults to the thread count).
    */
-  RandomParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed);
+  RandomParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed, size_t threadCount = 1, size_t batchSize = 0);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /** Override */
+  virtual size_t epoch_batch_size() const;
+
   /** Override */
   virtual std::pair<std::vector<size_t>,float> optimise_value_indices(const std::vector<size_t>& initialValueIndices) const;
+
+  /** Override */
+  virtual std::vector<std::pair<std::vector<size_t>,float> > optimise_value_indices_batch(const std::vector<std::vector<size_t> >& initialValueIndicesBatch) const;
 };
 
 }
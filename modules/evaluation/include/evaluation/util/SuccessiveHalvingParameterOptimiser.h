@@ -0,0 +1,152 @@
+/**
+ * evaluation: SuccessiveHalvingParameterOptimiser.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#ifndef H_EVALUATION_SUCCESSIVEHALVINGPARAMETEROPTIMISER
+#define H_EVALUATION_SUCCESSIVEHALVINGPARAMETEROPTIMISER
+
+#include "EpochBasedParameterOptimiser.h"
+
+namespace evaluation {
+
+/**
+ * \brief An instance of this class uses successive halving to find a parameter set with as low a cost as possible.
+ *
+ * Each bracket of the optimisation starts by generating a number of random parameter sets and evaluating them all with a small
+ * budget (e.g. on only a prefix of the evaluation sequences). The best 1/reductionFactor of the parameter sets are then kept,
+ * and evaluated again with a budget that is reductionFactor times larger, and so on, until either only one parameter set
+ * remains or the maximum budget is reached. The survivors of the final round of each bracket are always evaluated with the
+ * maximum budget, so that their costs can be compared between brackets. Poor parameter sets are thus abandoned early,
+ * without paying for a full evaluation.
+ *
+ * The costs of the parameter sets in each round are computed as a single batch, and so can be evaluated concurrently. Since
+ * each batch must be evaluated with a specific budget, custom batch evaluation is supported via set_budgeted_batch_cost_function
+ * rather than set_batch_cost_function.
+ * Ties between parameter sets with the same cost are broken by the order in which they were generated, so the results
+ * do not depend on the number of threads used.
+ */
+class SuccessiveHalvingParameterOptimiser : public EpochBasedParameterOptimiser
+{
+  //#################### TYPEDEFS ####################
+public:
+  /**
+   * A function that computes the cost of a parameter set using a specified budget. The cost for the maximum budget should be the
+   * "true" cost of the parameter set; the costs for smaller budgets should be cheaper-to-compute approximations of the true cost.
+   */
+  typedef boost::function<float(const ParamSet&,size_t)> BudgetedCostFunction;
+
+  /**
+   * A function that computes the costs of a batch of parameter sets using a specified budget (the costs must be returned in the same
+   * order as the parameter sets).
+   */
+  typedef boost::function<std::vector<float>(const std::vector<ParamSet>&,size_t)> BudgetedBatchCostFunction;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The function to use to evaluate batches of parameter sets using a specified budget. */
+  BudgetedBatchCostFunction m_budgetedBatchCostFunction;
+
+  /** The number of random parameter sets with which to start each bracket. */
+  size_t m_initialParamSetCount;
+
+  /** The maximum budget with which to evaluate a parameter set. */
+  size_t m_maxBudget;
+
+  /** The budget with which to evaluate the parameter sets in the first round of each bracket. */
+  size_t m_minBudget;
+
+  /** The factor by which to reduce the number of parameter sets (and increase the budget) after each round. */
+  size_t m_reductionFactor;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a successive halving parameter optimiser.
+   *
+   * \param budgetedCostFunction  The function to use to evaluate the parameter sets using a specified budget.
+   * \param bracketCount          The number of brackets for which successive halving should be run.
+   * \param initialParamSetCount  The number of random parameter sets with which to start each bracket.
+   * \param minBudget             The budget with which to evaluate the parameter sets in the first round of each bracket.
+   * \param maxBudget             The maximum budget with which to evaluate a parameter set.
+   * \param seed                  The seed for the random number generator.
+   * \param threadCount           The maximum number of parameter sets to evaluate concurrently (the cost function must be thread-safe if this is > 1).
+   * \param reductionFactor       The factor by which to reduce the number of parameter sets (and increase the budget) after each round.
+   *
+   * \throws std::invalid_argument  If any of the counts or budgets are zero, if minBudget > maxBudget or if reductionFactor < 2.
+   */
+  SuccessiveHalvingParameterOptimiser(const BudgetedCostFunction& budgetedCostFunction, size_t bracketCount, size_t initialParamSetCount,
+                                      size_t minBudget, size_t maxBudget, unsigned int seed, size_t threadCount = 1, size_t reductionFactor = 2);
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Makes a budgeted batch cost function that evaluates the parameter sets in each batch using the specified budgeted cost function.
+   *
+   * As with make_batch_cost_function, the costs are always returned in the same order as the parameter sets.
+   *
+   * \param budgetedCostFunction  The function to use to evaluate each parameter set (must be thread-safe if threadCount > 1).
+   * \param threadCount           The maximum number of parameter sets to evaluate concurrently.
+   * \return                      The budgeted batch cost function.
+   */
+  static BudgetedBatchCostFunction make_budgeted_batch_cost_function(const BudgetedCostFunction& budgetedCostFunction, size_t threadCount);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Throws, since a successive halving optimiser needs to evaluate each batch with a specific budget.
+   *
+   * \param batchCostFunction The batch cost function (ignored).
+   *
+   * \throws std::runtime_error Always (use set_budgeted_batch_cost_function instead).
+   */
+  virtual void set_batch_cost_function(const BatchCostFunction& batchCostFunction);
+
+  /**
+   * \brief Replaces the function used to evaluate batches of parameter sets using a specified budget.
+   *
+   * This can be used by clients that can evaluate a batch of parameter sets more efficiently than by evaluating them individually
+   * (e.g. because they can share work between the sets in the batch).
+   *
+   * \param budgetedBatchCostFunction The new budgeted batch cost function.
+   */
+  void set_budgeted_batch_cost_function(const BudgetedBatchCostFunction& budgetedBatchCostFunction);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the costs associated with several sets of parameter value indices using the specified budget.
+   *
+   * \param valueIndicesBatch The sets of parameter value indices.
+   * \param budget            The budget with which to evaluate the parameter sets.
+   * \return                  The costs associated with the sets of parameter value indices (in the same order).
+   */
+  std::vector<float> compute_budgeted_costs(const std::vector<std::vector<size_t> >& valueIndicesBatch, size_t budget) const;
+
+  /** Override */
+  virtual size_t epoch_batch_size() const;
+
+  /** Override */
+  virtual std::pair<std::vector<size_t>,float> optimise_value_indices(const std::vector<size_t>& initialValueIndices) const;
+
+  /** Override */
+  virtual std::vector<std::pair<std::vector<size_t>,float> > optimise_value_indices_batch(const std::vector<std::vector<size_t> >& initialValueIndicesBatch) const;
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Evaluates a batch of parameter sets using the specified budgeted cost function and budget, using up to the specified number of threads.
+   *
+   * \param budgetedCostFunction  The function to use to evaluate each parameter set.
+   * \param threadCount           The maximum number of parameter sets to evaluate concurrently.
+   * \param paramSets             The parameter sets.
+   * \param budget                The budget with which to evaluate the parameter sets.
+   * \return                      The costs of the parameter sets (in the same order as the parameter sets).
+   */
+  static std::vector<float> compute_budgeted_costs_concurrently(const BudgetedCostFunction& budgetedCostFunction, size_t threadCount,
+                                                                const std::vector<ParamSet>& paramSets, size_t budget);
+};
+
+}
+
+#endif
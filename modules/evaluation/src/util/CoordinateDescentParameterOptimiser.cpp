@@ -9,8 +9,8 @@ namespace evaluation {
 
 //#################### CONSTRUCTORS ####################
 
-CoordinateDescentParameterOptimiser::CoordinateDescentParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed)
-: EpochBasedParameterOptimiser(costFunction, epochCount, seed)
+CoordinateDescentParameterOptimiser::CoordinateDescentParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed, size_t threadCount)
+: EpochBasedParameterOptimiser(costFunction, epochCount, seed, threadCount)
 {}
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
@@ -41,20 +41,31 @@ std::pair<std::vector<size_t>,float> CoordinateDescentParameterOptimiser::optimi
     // Record the parameter value for which we already have the corresponding cost so that we can avoid re-evaluating it.
     size_t originalValueIndex = currentValueIndices[paramIndex];
 
-    // For each possible new value that the parameter can take:
+    // Make a set of parameter value indices for each possible new value that the parameter can take. Since these only
+    // differ from the current indices along this parameter's axis, their costs are independent of each other, and so
+    // we can compute them all as a single batch.
     std::vector<size_t> newValueIndices = currentValueIndices;
+    std::vector<std::vector<size_t> > newValueIndicesBatch;
+    std::vector<size_t> newValues;
     for(size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex)
     {
       // If we already know that the cost for the new value is no better than the cost for the current value, skip it.
       if(valueIndex == originalValueIndex) continue;
 
-      // Compute the cost for the new value. If it's better than the cost for the current value, update the current value.
       newValueIndices[paramIndex] = valueIndex;
-      float newCost = compute_cost(newValueIndices);
-      if(newCost < currentCost)
+      newValueIndicesBatch.push_back(newValueIndices);
+      newValues.push_back(valueIndex);
+    }
+
+    std::vector<float> newCosts = compute_costs(newValueIndicesBatch);
+
+    // For each new value (in order), if its cost is better than the cost for the current value, update the current value.
+    for(size_t i = 0, size = newValues.size(); i < size; ++i)
+    {
+      if(newCosts[i] < currentCost)
       {
-        currentValueIndices[paramIndex] = valueIndex;
-        currentCost = newCost;
+        currentValueIndices[paramIndex] = newValues[i];
+        currentCost = newCosts[i];
       }
     }
 
@@ -5,19 +5,36 @@
 
 #include "util/EpochBasedParameterOptimiser.h"
 
+#include <algorithm>
 #include <limits>
+#include <stdexcept>
 
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 using boost::spirit::hold_any;
 
+#include <tvgutil/misc/ConcurrencyUtil.h>
+using namespace tvgutil;
+
 namespace evaluation {
 
 //#################### CONSTRUCTORS ####################
 
-EpochBasedParameterOptimiser::EpochBasedParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed)
-: m_costFunction(costFunction), m_epochCount(epochCount), m_rng(seed)
+EpochBasedParameterOptimiser::EpochBasedParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed, size_t threadCount)
+: m_batchCostFunction(make_batch_cost_function(costFunction, threadCount)), m_epochCount(epochCount), m_rng(seed)
 {}
 
+//#################### DESTRUCTOR ####################
+
+EpochBasedParameterOptimiser::~EpochBasedParameterOptimiser() {}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+EpochBasedParameterOptimiser::BatchCostFunction EpochBasedParameterOptimiser::make_batch_cost_function(const CostFunction& costFunction, size_t threadCount)
+{
+  return boost::bind(&EpochBasedParameterOptimiser::compute_costs_concurrently, costFunction, std::max<size_t>(threadCount, 1), _1);
+}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 EpochBasedParameterOptimiser& EpochBasedParameterOptimiser::add_param(const std::string& param, const std::vector<hold_any>& values)
@@ -31,22 +48,29 @@ ParamSet EpochBasedParameterOptimiser::optimise_for_parameters(float *bestCost)
   std::vector<size_t> bestValueIndicesAllTime;
   float bestCostAllTime = std::numeric_limits<float>::max();
 
-  // For each epoch:
-  for(size_t i = 0; i < m_epochCount; ++i)
+  // For each batch of epochs:
+  const size_t epochBatchSize = std::max<size_t>(epoch_batch_size(), 1);
+  for(size_t i = 0; i < m_epochCount; i += epochBatchSize)
   {
-    // Randomly generate an initial set of parameter value indices.
-    std::vector<size_t> initialValueIndices = generate_random_value_indices();
+    // Randomly generate an initial set of parameter value indices for each epoch in the batch.
+    std::vector<std::vector<size_t> > initialValueIndicesBatch;
+    for(size_t j = i, jend = std::min(i + epochBatchSize, m_epochCount); j < jend; ++j)
+    {
+      initialValueIndicesBatch.push_back(generate_random_value_indices());
+    }
 
-    // Optimise the initial set of parameter value indices.
-    std::vector<size_t> optimisedValueIndices;
-    float optimisedCost;
-    boost::tie(optimisedValueIndices, optimisedCost) = optimise_value_indices(initialValueIndices);
+    // Optimise the initial sets of parameter value indices.
+    std::vector<std::pair<std::vector<size_t>,float> > candidates = optimise_value_indices_batch(initialValueIndicesBatch);
 
-    // If the optimised cost is the best we've seen so far, update the best cost and best parameter value indices.
-    if(optimisedCost < bestCostAllTime)
+    // If any of the optimised costs is the best we've seen so far, update the best cost and best parameter value indices.
+    // Note that we consider the candidates in order, so that ties are always broken in the same way.
+    for(size_t j = 0, candidateCount = candidates.size(); j < candidateCount; ++j)
     {
-      bestCostAllTime = optimisedCost;
-      bestValueIndicesAllTime = optimisedValueIndices;
+      if(candidates[j].second < bestCostAllTime)
+      {
+        bestCostAllTime = candidates[j].second;
+        bestValueIndicesAllTime = candidates[j].first;
+      }
     }
   }
 
@@ -55,21 +79,31 @@ ParamSet EpochBasedParameterOptimiser::optimise_for_parameters(float *bestCost)
   return make_param_set(bestValueIndicesAllTime);
 }
 
-//#################### PRIVATE MEMBER FUNCTIONS ####################
+void EpochBasedParameterOptimiser::set_batch_cost_function(const BatchCostFunction& batchCostFunction)
+{
+  m_batchCostFunction = batchCostFunction;
+}
+
+//#################### PROTECTED MEMBER FUNCTIONS ####################
 
 float EpochBasedParameterOptimiser::compute_cost(const std::vector<size_t>& valueIndices) const
 {
-  return m_costFunction(make_param_set(valueIndices));
+  return m_batchCostFunction(std::vector<ParamSet>(1, make_param_set(valueIndices)))[0];
 }
 
-std::vector<size_t> EpochBasedParameterOptimiser::generate_random_value_indices() const
+std::vector<float> EpochBasedParameterOptimiser::compute_costs(const std::vector<std::vector<size_t> >& valueIndicesBatch) const
 {
-  std::vector<size_t> valueIndices;
-  for(size_t i = 0, paramCount = m_paramValues.size(); i < paramCount; ++i)
+  std::vector<ParamSet> paramSets;
+  paramSets.reserve(valueIndicesBatch.size());
+  for(size_t i = 0, size = valueIndicesBatch.size(); i < size; ++i)
   {
-    valueIndices.push_back(m_rng.generate_int_from_uniform(0, static_cast<int>(m_paramValues[i].second.size()) - 1));
+    paramSets.push_back(make_param_set(valueIndicesBatch[i]));
   }
-  return valueIndices;
+
+  std::vector<float> costs = m_batchCostFunction(paramSets);
+  if(costs.size() != paramSets.size()) throw std::runtime_error("Error: The batch cost function returned the wrong number of costs");
+
+  return costs;
 }
 
 ParamSet EpochBasedParameterOptimiser::make_param_set(const std::vector<size_t>& valueIndices) const
@@ -84,4 +118,47 @@ ParamSet EpochBasedParameterOptimiser::make_param_set(const std::vector<size_t>&
   return paramSet;
 }
 
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+size_t EpochBasedParameterOptimiser::epoch_batch_size() const
+{
+  return 1;
+}
+
+std::vector<size_t> EpochBasedParameterOptimiser::generate_random_value_indices() const
+{
+  std::vector<size_t> valueIndices;
+  for(size_t i = 0, paramCount = m_paramValues.size(); i < paramCount; ++i)
+  {
+    valueIndices.push_back(m_rng.generate_int_from_uniform(0, static_cast<int>(m_paramValues[i].second.size()) - 1));
+  }
+  return valueIndices;
+}
+
+std::vector<std::pair<std::vector<size_t>,float> >
+EpochBasedParameterOptimiser::optimise_value_indices_batch(const std::vector<std::vector<size_t> >& initialValueIndicesBatch) const
+{
+  std::vector<std::pair<std::vector<size_t>,float> > results;
+  for(size_t i = 0, size = initialValueIndicesBatch.size(); i < size; ++i)
+  {
+    results.push_back(optimise_value_indices(initialValueIndicesBatch[i]));
+  }
+  return results;
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+void EpochBasedParameterOptimiser::compute_cost_task(const CostFunction& costFunction, const std::vector<ParamSet>& paramSets, std::vector<float>& costs, size_t i)
+{
+  costs[i] = costFunction(paramSets[i]);
+}
+
+std::vector<float> EpochBasedParameterOptimiser::compute_costs_concurrently(const CostFunction& costFunction, size_t threadCount, const std::vector<ParamSet>& paramSets)
+{
+  // Each cost is written to the slot corresponding to its parameter set, so the order in which the evaluations finish doesn't matter.
+  std::vector<float> costs(paramSets.size());
+  ConcurrencyUtil::run_tasks(paramSets.size(), threadCount, boost::bind(&EpochBasedParameterOptimiser::compute_cost_task, boost::cref(costFunction), boost::cref(paramSets), boost::ref(costs), _1));
+  return costs;
+}
+
 }
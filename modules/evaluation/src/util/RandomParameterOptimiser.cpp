@@ -5,20 +5,41 @@
 
 #include "util/RandomParameterOptimiser.h"
 
+#include <algorithm>
+
 namespace evaluation {
 
 //#################### CONSTRUCTORS ####################
 
-RandomParameterOptimiser::RandomParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed)
-: EpochBasedParameterOptimiser(costFunction, epochCount, seed)
+RandomParameterOptimiser::RandomParameterOptimiser(const CostFunction& costFunction, size_t epochCount, unsigned int seed, size_t threadCount, size_t batchSize)
+: EpochBasedParameterOptimiser(costFunction, epochCount, seed, threadCount), m_batchSize(batchSize != 0 ? batchSize : std::max<size_t>(threadCount, 1))
 {}
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+size_t RandomParameterOptimiser::epoch_batch_size() const
+{
+  return m_batchSize;
+}
+
 std::pair<std::vector<size_t>,float> RandomParameterOptimiser::optimise_value_indices(const std::vector<size_t>& initialValueIndices) const
 {
   // Don't perform any actual optimisation, just compute the cost of the initial parameters.
   return std::make_pair(initialValueIndices, compute_cost(initialValueIndices));
 }
 
+std::vector<std::pair<std::vector<size_t>,float> >
+RandomParameterOptimiser::optimise_value_indices_batch(const std::vector<std::vector<size_t> >& initialValueIndicesBatch) const
+{
+  // As above, but compute the costs of all of the initial parameters in the batch together.
+  std::vector<float> costs = compute_costs(initialValueIndicesBatch);
+
+  std::vector<std::pair<std::vector<size_t>,float> > results;
+  for(size_t i = 0, size = initialValueIndicesBatch.size(); i < size; ++i)
+  {
+    results.push_back(std::make_pair(initialValueIndicesBatch[i], costs[i]));
+  }
+  return results;
+}
+
 }
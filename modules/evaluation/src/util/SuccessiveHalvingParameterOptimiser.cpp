@@ -0,0 +1,137 @@
+/**
+ * evaluation: SuccessiveHalvingParameterOptimiser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include "util/SuccessiveHalvingParameterOptimiser.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace evaluation {
+
+//#################### CONSTRUCTORS ####################
+
+SuccessiveHalvingParameterOptimiser::SuccessiveHalvingParameterOptimiser(const BudgetedCostFunction& budgetedCostFunction, size_t bracketCount,
+                                                                         size_t initialParamSetCount, size_t minBudget, size_t maxBudget,
+                                                                         unsigned int seed, size_t threadCount, size_t reductionFactor)
+: EpochBasedParameterOptimiser(boost::bind(budgetedCostFunction, _1, maxBudget), bracketCount * initialParamSetCount, seed, threadCount),
+  m_budgetedBatchCostFunction(make_budgeted_batch_cost_function(budgetedCostFunction, threadCount)),
+  m_initialParamSetCount(initialParamSetCount),
+  m_maxBudget(maxBudget),
+  m_minBudget(minBudget),
+  m_reductionFactor(reductionFactor)
+{
+  if(bracketCount == 0 || initialParamSetCount == 0) throw std::invalid_argument("Error: The bracket and parameter set counts must be non-zero");
+  if(minBudget == 0 || minBudget > maxBudget) throw std::invalid_argument("Error: The budgets must satisfy 0 < minBudget <= maxBudget");
+  if(reductionFactor < 2) throw std::invalid_argument("Error: The reduction factor must be at least 2");
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+SuccessiveHalvingParameterOptimiser::BudgetedBatchCostFunction
+SuccessiveHalvingParameterOptimiser::make_budgeted_batch_cost_function(const BudgetedCostFunction& budgetedCostFunction, size_t threadCount)
+{
+  return boost::bind(&SuccessiveHalvingParameterOptimiser::compute_budgeted_costs_concurrently, budgetedCostFunction, std::max<size_t>(threadCount, 1), _1, _2);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SuccessiveHalvingParameterOptimiser::set_batch_cost_function(const BatchCostFunction&)
+{
+  throw std::runtime_error("Error: A successive halving optimiser needs a budgeted batch cost function (use set_budgeted_batch_cost_function instead)");
+}
+
+void SuccessiveHalvingParameterOptimiser::set_budgeted_batch_cost_function(const BudgetedBatchCostFunction& budgetedBatchCostFunction)
+{
+  m_budgetedBatchCostFunction = budgetedBatchCostFunction;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+std::vector<float> SuccessiveHalvingParameterOptimiser::compute_budgeted_costs(const std::vector<std::vector<size_t> >& valueIndicesBatch, size_t budget) const
+{
+  std::vector<ParamSet> paramSets;
+  paramSets.reserve(valueIndicesBatch.size());
+  for(size_t i = 0, size = valueIndicesBatch.size(); i < size; ++i)
+  {
+    paramSets.push_back(make_param_set(valueIndicesBatch[i]));
+  }
+
+  std::vector<float> costs = m_budgetedBatchCostFunction(paramSets, budget);
+  if(costs.size() != paramSets.size()) throw std::runtime_error("Error: The budgeted batch cost function returned the wrong number of costs");
+
+  return costs;
+}
+
+size_t SuccessiveHalvingParameterOptimiser::epoch_batch_size() const
+{
+  // Each bracket consumes one epoch per initial parameter set.
+  return m_initialParamSetCount;
+}
+
+std::pair<std::vector<size_t>,float> SuccessiveHalvingParameterOptimiser::optimise_value_indices(const std::vector<size_t>& initialValueIndices) const
+{
+  // A bracket containing a single parameter set just evaluates it with the maximum budget.
+  return std::make_pair(initialValueIndices, compute_budgeted_costs(std::vector<std::vector<size_t> >(1, initialValueIndices), m_maxBudget)[0]);
+}
+
+std::vector<std::pair<std::vector<size_t>,float> >
+SuccessiveHalvingParameterOptimiser::optimise_value_indices_batch(const std::vector<std::vector<size_t> >& initialValueIndicesBatch) const
+{
+  // Start with all of the initial parameter sets, and the minimum budget.
+  std::vector<std::vector<size_t> > survivors = initialValueIndicesBatch;
+  size_t budget = m_minBudget;
+
+  for(;;)
+  {
+    // If this is the final round, make sure that we evaluate the survivors with the maximum budget.
+    const bool finalRound = survivors.size() <= 1 || budget >= m_maxBudget;
+    if(finalRound) budget = m_maxBudget;
+
+    // Evaluate the surviving parameter sets with the current budget.
+    std::vector<float> costs = compute_budgeted_costs(survivors, budget);
+
+    // Sort the survivors into non-decreasing order of cost, breaking ties by the order in which they were generated.
+    std::vector<std::pair<float,size_t> > ranking;
+    for(size_t i = 0, size = survivors.size(); i < size; ++i)
+    {
+      ranking.push_back(std::make_pair(costs[i], i));
+    }
+    std::sort(ranking.begin(), ranking.end());
+
+    // If this is the final round, return the survivors (best first).
+    if(finalRound)
+    {
+      std::vector<std::pair<std::vector<size_t>,float> > results;
+      for(size_t i = 0, size = ranking.size(); i < size; ++i)
+      {
+        results.push_back(std::make_pair(survivors[ranking[i].second], ranking[i].first));
+      }
+      return results;
+    }
+
+    // Otherwise, keep the best 1/reductionFactor of the survivors (rounding up), and increase the budget accordingly.
+    const size_t keepCount = (survivors.size() + m_reductionFactor - 1) / m_reductionFactor;
+    std::vector<std::vector<size_t> > newSurvivors;
+    for(size_t i = 0; i < keepCount; ++i)
+    {
+      newSurvivors.push_back(survivors[ranking[i].second]);
+    }
+    survivors.swap(newSurvivors);
+
+    budget = std::min(budget * m_reductionFactor, m_maxBudget);
+  }
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+std::vector<float> SuccessiveHalvingParameterOptimiser::compute_budgeted_costs_concurrently(const BudgetedCostFunction& budgetedCostFunction, size_t threadCount,
+                                                                                             const std::vector<ParamSet>& paramSets, size_t budget)
+{
+  return make_batch_cost_function(boost::bind(budgetedCostFunction, _1, budget), threadCount)(paramSets);
+}
+
+}
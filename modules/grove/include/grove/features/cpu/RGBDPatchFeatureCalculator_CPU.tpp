@@ -5,7 +5,9 @@
 
 #include "features/cpu/RGBDPatchFeatureCalculator_CPU.h"
 
-#include "features/shared/RGBDPatchFeatureCalculator_Shared.h"
+#include <algorithm>
+
+#include "features/cpu/RGBDPatchFeatureKernels_CPU.h"
 
 namespace grove {
 
@@ -29,12 +31,9 @@ void RGBDPatchFeatureCalculator_CPU<KeypointType,DescriptorType>::compute_keypoi
                                                                                                  const Matrix4f& cameraPose, const Vector4f& intrinsics,
                                                                                                  KeypointsImage *keypointsImage, DescriptorsImage *descriptorsImage) const
 {
-  const Vector4i *depthOffsets = this->m_depthOffsets->GetData(MEMORYDEVICE_CPU);
   const float *depths = depthImage ? depthImage->GetData(MEMORYDEVICE_CPU) : NULL;
   const Vector2i& depthSize = depthImage->noDims;
   const Vector4u *rgb = rgbImage ? rgbImage->GetData(MEMORYDEVICE_CPU): NULL;
-  const uchar *rgbChannels = this->m_rgbChannels->GetData(MEMORYDEVICE_CPU);
-  const Vector4i *rgbOffsets = this->m_rgbOffsets->GetData(MEMORYDEVICE_CPU);
   const Vector2i& rgbSize = rgbImage->noDims;
 
   // Check that the input images are valid and compute the output dimensions.
@@ -48,60 +47,73 @@ void RGBDPatchFeatureCalculator_CPU<KeypointType,DescriptorType>::compute_keypoi
   KeypointType *keypoints = keypointsImage->GetData(MEMORYDEVICE_CPU);
   DescriptorType *descriptors = descriptorsImage->GetData(MEMORYDEVICE_CPU);
 
-  // For each pixel in the RGBD image:
+  // Precompute the feature offsets, rescaled to the sizes of the input images.
+  const RGBDPatchFeatureOffsetTable depthTable(this->m_depthOffsets->GetData(MEMORYDEVICE_CPU), NULL, this->m_depthFeatureCount, depthSize);
+  const RGBDPatchFeatureOffsetTable rgbTable(this->m_rgbOffsets->GetData(MEMORYDEVICE_CPU), this->m_rgbChannels->GetData(MEMORYDEVICE_CPU), this->m_rgbFeatureCount, rgbSize);
+
+  // Divide the output image into square tiles. Processing the keypoints a tile at a time (rather than a row at a time)
+  // means that the regions of the input images from which the features for nearby keypoints are sampled overlap far
+  // more, and so are far more likely to stay in cache.
+  const int tileSize = 16;
+  const int tileCountX = (outSize.width + tileSize - 1) / tileSize;
+  const int tileCount = tileCountX * ((outSize.height + tileSize - 1) / tileSize);
+
+  // For each tile:
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for schedule(dynamic)
 #endif
-  for(int yOut = 0; yOut < outSize.height; ++yOut)
+  for(int tileIdx = 0; tileIdx < tileCount; ++tileIdx)
   {
-    for(int xOut = 0; xOut < outSize.width; ++xOut)
+    const int xBegin = (tileIdx % tileCountX) * tileSize, xEnd = std::min(xBegin + tileSize, outSize.width);
+    const int yBegin = (tileIdx / tileCountX) * tileSize, yEnd = std::min(yBegin + tileSize, outSize.height);
+
+    // For each pixel in the tile:
+    for(int yOut = yBegin; yOut < yEnd; ++yOut)
     {
-      const Vector2i xyOut(xOut, yOut);
-      const Vector2i xyDepth = map_pixel_coordinates(xyOut, outSize, depthSize);
-      const Vector2i xyRgb = map_pixel_coordinates(xyOut, outSize, rgbSize);
+      for(int xOut = xBegin; xOut < xEnd; ++xOut)
+      {
+        const Vector2i xyOut(xOut, yOut);
+        const Vector2i xyDepth = map_pixel_coordinates(xyOut, outSize, depthSize);
+        const Vector2i xyRgb = map_pixel_coordinates(xyOut, outSize, rgbSize);
 
-      // Compute the keypoint for the pixel.
-      compute_keypoint(xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, cameraPose, intrinsics, keypoints);
+        // Compute the keypoint for the pixel. If it's not valid, no features need to be computed for it.
+        compute_keypoint(xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, cameraPose, intrinsics, keypoints);
 
-      // If there is a depth image available and any depth features need to be computed for the keypoint, compute them.
-      if(depths && this->m_depthFeatureCount > 0)
-      {
-        if(this->m_depthDifferenceType == PAIRWISE_DIFFERENCE)
-        {
-          compute_depth_features<PAIRWISE_DIFFERENCE>(
-            xyDepth, xyOut, depthSize, outSize, depths, depthOffsets, keypoints,
-            this->m_depthFeatureCount, this->m_depthFeatureOffset,
-            this->m_normaliseDepth, descriptors
-          );
-        }
-        else
-        {
-          compute_depth_features<CENTRAL_DIFFERENCE>(
-            xyDepth, xyOut, depthSize, outSize, depths, depthOffsets, keypoints,
-            this->m_depthFeatureCount, this->m_depthFeatureOffset,
-            this->m_normaliseDepth, descriptors
-          );
-        }
-      }
+        const int rasterIdxOut = yOut * outSize.width + xOut;
+        if(!keypoints[rasterIdxOut].valid) continue;
 
-      // If there is a colour image available and any colour features need to be computed for the keypoint, compute them.
-      if(rgb && this->m_rgbFeatureCount > 0)
-      {
-        if(this->m_rgbDifferenceType == PAIRWISE_DIFFERENCE)
+        DescriptorType& descriptor = descriptors[rasterIdxOut];
+
+        // If there is a depth image available and any depth features need to be computed for the keypoint, compute them.
+        if(depths && this->m_depthFeatureCount > 0)
         {
-          compute_colour_features<PAIRWISE_DIFFERENCE>(
-            xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, rgbOffsets, rgbChannels,
-            keypoints, this->m_rgbFeatureCount, this->m_rgbFeatureOffset,
-            this->m_normaliseRgb, descriptors
-          );
+          float *features = descriptor.data + this->m_depthFeatureOffset;
+          if(this->m_depthDifferenceType == PAIRWISE_DIFFERENCE)
+          {
+            compute_depth_features_tabulated<PAIRWISE_DIFFERENCE>(xyDepth, depthSize, depths, depthTable, this->m_normaliseDepth, features);
+          }
+          else
+          {
+            compute_depth_features_tabulated<CENTRAL_DIFFERENCE>(xyDepth, depthSize, depths, depthTable, this->m_normaliseDepth, features);
+          }
         }
-        else
+
+        // If there is a colour image available and any colour features need to be computed for the keypoint, compute them.
+        if(rgb && this->m_rgbFeatureCount > 0)
         {
-          compute_colour_features<CENTRAL_DIFFERENCE>(
-            xyDepth, xyRgb, xyOut, depthSize, rgbSize, outSize, depths, rgb, rgbOffsets, rgbChannels,
-            keypoints, this->m_rgbFeatureCount, this->m_rgbFeatureOffset,
-            this->m_normaliseRgb, descriptors
-          );
+          // If we're normalising the RGB offsets based on depth, and depth information is available,
+          // look up the depth for the input pixel; otherwise, default to 1.
+          const float depth = this->m_normaliseRgb && depths ? depths[xyDepth.y * depthSize.width + xyDepth.x] : 1.0f;
+
+          float *features = descriptor.data + this->m_rgbFeatureOffset;
+          if(this->m_rgbDifferenceType == PAIRWISE_DIFFERENCE)
+          {
+            compute_colour_features_tabulated<PAIRWISE_DIFFERENCE>(xyRgb, rgbSize, rgb, rgbTable, this->m_normaliseRgb, depth, features);
+          }
+          else
+          {
+            compute_colour_features_tabulated<CENTRAL_DIFFERENCE>(xyRgb, rgbSize, rgb, rgbTable, this->m_normaliseRgb, depth, features);
+          }
         }
       }
     }
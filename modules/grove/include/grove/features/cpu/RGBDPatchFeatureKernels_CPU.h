@@ -0,0 +1,267 @@
+/**
+ * grove: RGBDPatchFeatureKernels_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#ifndef H_GROVE_RGBDPATCHFEATUREKERNELS_CPU
+#define H_GROVE_RGBDPATCHFEATUREKERNELS_CPU
+
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "../shared/RGBDPatchFeatureCalculator_Shared.h"
+
+namespace grove {
+
+/**
+ * \brief An instance of this struct stores the offsets for a set of RGBD patch features in structure-of-arrays form,
+ *        rescaled to the size of the image from which the features are to be computed.
+ *
+ * The rescaling only depends on the image size, so precomputing it once per frame (rather than once per feature per
+ * keypoint, as the shared functions do) saves a great deal of redundant work. The structure-of-arrays layout allows
+ * the offsets of several adjacent features to be loaded into a single SIMD register.
+ */
+struct RGBDPatchFeatureOffsetTable
+{
+  /** The colour channels to sample for the features, each multiplied by 8 (i.e. the shifts needed to extract them from a packed RGBA pixel). */
+  std::vector<int> channelShifts;
+
+  /** The x components of the offsets of the first secondary points. */
+  std::vector<int> x1;
+
+  /** The x components of the offsets of the first secondary points, as floats (for use when normalising by depth). */
+  std::vector<float> x1f;
+
+  /** The x components of the offsets of the second secondary points. */
+  std::vector<int> x2;
+
+  /** The x components of the offsets of the second secondary points, as floats (for use when normalising by depth). */
+  std::vector<float> x2f;
+
+  /** The y components of the offsets of the first secondary points. */
+  std::vector<int> y1;
+
+  /** The y components of the offsets of the first secondary points, as floats (for use when normalising by depth). */
+  std::vector<float> y1f;
+
+  /** The y components of the offsets of the second secondary points. */
+  std::vector<int> y2;
+
+  /** The y components of the offsets of the second secondary points, as floats (for use when normalising by depth). */
+  std::vector<float> y2f;
+
+  /**
+   * \brief Constructs an offset table.
+   *
+   * \param offsets       The unnormalised offsets of the features (as used to train the forest).
+   * \param channels      The colour channels to sample for the features (NULL for depth features).
+   * \param featureCount  The number of features.
+   * \param imgSize       The size of the image from which the features are to be computed.
+   */
+  RGBDPatchFeatureOffsetTable(const Vector4i *offsets, const uchar *channels, uint32_t featureCount, const Vector2i& imgSize)
+  : channelShifts(featureCount), x1(featureCount), x1f(featureCount), x2(featureCount), x2f(featureCount),
+    y1(featureCount), y1f(featureCount), y2(featureCount), y2f(featureCount)
+  {
+    // Compute the ratio between the size of the image we're currently using and the size of image used to train the forest,
+    // and use it to rescale the offsets. Note that this must exactly match the computation in the shared functions.
+    // FIXME: The training image size should be passed in, not hard-coded.
+    const Vector2f trainSize(640.0f, 480.0f);
+    const Vector2f offsetRatio(imgSize.x / trainSize.x, imgSize.y / trainSize.y);
+
+    for(uint32_t i = 0; i < featureCount; ++i)
+    {
+      channelShifts[i] = channels ? channels[i] * 8 : 0;
+      x1[i] = static_cast<int>(offsets[i][0] * offsetRatio.x);
+      y1[i] = static_cast<int>(offsets[i][1] * offsetRatio.y);
+      x2[i] = static_cast<int>(offsets[i][2] * offsetRatio.x);
+      y2[i] = static_cast<int>(offsets[i][3] * offsetRatio.y);
+      x1f[i] = static_cast<float>(x1[i]);
+      y1f[i] = static_cast<float>(y1[i]);
+      x2f[i] = static_cast<float>(x2[i]);
+      y2f[i] = static_cast<float>(y2[i]);
+    }
+  }
+
+  /**
+   * \brief Gets the number of features in the table.
+   *
+   * \return  The number of features in the table.
+   */
+  uint32_t size() const
+  {
+    return static_cast<uint32_t>(x1.size());
+  }
+};
+
+#ifdef __AVX2__
+/**
+ * \brief Calculates the raster positions of one of the secondary points for eight adjacent features at once.
+ *
+ * This is a vectorised equivalent of calculate_secondary_points, and produces exactly the same results.
+ *
+ * \param xyIn      The coordinates of the pixel (in either the RGB or depth image) for which features are being computed.
+ * \param xs        A pointer to the x components of the offsets of the secondary point for the eight features.
+ * \param ys        A pointer to the y components of the offsets of the secondary point for the eight features.
+ * \param xsf       A pointer to the x components of the offsets as floats.
+ * \param ysf       A pointer to the y components of the offsets as floats.
+ * \param imgSize   The size of the RGB or depth image (whichever is being used).
+ * \param normalise Whether or not to normalise the offsets by the pixel's depth value.
+ * \param depth     The pixel's depth value.
+ * \return          The raster positions of the secondary point for the eight features.
+ */
+inline __m256i calculate_secondary_rasters_avx2(const Vector2i& xyIn, const int *xs, const int *ys, const float *xsf, const float *ysf,
+                                                const Vector2i& imgSize, bool normalise, float depth)
+{
+  __m256i dx, dy;
+  if(normalise)
+  {
+    // Note: Division (rather than multiplication by the reciprocal of the depth) and truncation are needed for exactness.
+    const __m256 depths = _mm256_set1_ps(depth);
+    dx = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_loadu_ps(xsf), depths));
+    dy = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_loadu_ps(ysf), depths));
+  }
+  else
+  {
+    dx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs));
+    dy = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys));
+  }
+
+  // Constrain the secondary points to be within the image.
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i x = _mm256_add_epi32(_mm256_set1_epi32(xyIn.x), dx);
+  __m256i y = _mm256_add_epi32(_mm256_set1_epi32(xyIn.y), dy);
+  x = _mm256_min_epi32(_mm256_max_epi32(x, zero), _mm256_set1_epi32(imgSize.width - 1));
+  y = _mm256_min_epi32(_mm256_max_epi32(y, zero), _mm256_set1_epi32(imgSize.height - 1));
+
+  // Calculate the raster positions of the secondary points.
+  return _mm256_add_epi32(_mm256_mullo_epi32(y, _mm256_set1_epi32(imgSize.width)), x);
+}
+#endif
+
+/**
+ * \brief Computes colour features for a pixel in the RGBD image using a precomputed offset table.
+ *
+ * The results are bit-identical to those of compute_colour_features. The caller is responsible for checking that
+ * the pixel's keypoint is valid before calling this function.
+ *
+ * \param xyRgb     The coordinates of the pixel in the colour image.
+ * \param rgbSize   The size of the colour image.
+ * \param rgb       A pointer to the colour image.
+ * \param table     The offset table for the colour features.
+ * \param normalise Whether or not to normalise the RGB offsets by the pixel's depth value.
+ * \param depth     The pixel's depth value (1 if the offsets are not being normalised).
+ * \param features  A pointer to the location in the descriptor into which to write the features.
+ */
+template <RGBDPatchFeatureDifferenceType DifferenceType>
+inline void compute_colour_features_tabulated(const Vector2i& xyRgb, const Vector2i& rgbSize, const Vector4u *rgb,
+                                              const RGBDPatchFeatureOffsetTable& table, bool normalise, float depth, float *features)
+{
+  const int rasterIdxRgb = xyRgb.y * rgbSize.width + xyRgb.x;
+  const uint32_t featureCount = table.size();
+  uint32_t featIdx = 0;
+
+#ifdef __AVX2__
+  // Compute the features eight at a time, gathering the (packed RGBA) secondary pixels and extracting the relevant channels using per-feature shifts.
+  const int *pixels = reinterpret_cast<const int*>(rgb);
+  const __m256i byteMask = _mm256_set1_epi32(0xFF);
+  const __m256i centralPixel = _mm256_set1_epi32(pixels[rasterIdxRgb]);
+  for(; featIdx + 8 <= featureCount; featIdx += 8)
+  {
+    const __m256i shifts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&table.channelShifts[featIdx]));
+    const __m256i raster1 = calculate_secondary_rasters_avx2(xyRgb, &table.x1[featIdx], &table.y1[featIdx], &table.x1f[featIdx], &table.y1f[featIdx], rgbSize, normalise, depth);
+    const __m256i colour1 = _mm256_and_si256(_mm256_srlv_epi32(_mm256_i32gather_epi32(pixels, raster1, 4), shifts), byteMask);
+
+    __m256i colour2;
+    if(DifferenceType == PAIRWISE_DIFFERENCE)
+    {
+      const __m256i raster2 = calculate_secondary_rasters_avx2(xyRgb, &table.x2[featIdx], &table.y2[featIdx], &table.x2f[featIdx], &table.y2f[featIdx], rgbSize, normalise, depth);
+      colour2 = _mm256_and_si256(_mm256_srlv_epi32(_mm256_i32gather_epi32(pixels, raster2, 4), shifts), byteMask);
+    }
+    else
+    {
+      colour2 = _mm256_and_si256(_mm256_srlv_epi32(centralPixel, shifts), byteMask);
+    }
+
+    _mm256_storeu_ps(features + featIdx, _mm256_cvtepi32_ps(_mm256_sub_epi32(colour1, colour2)));
+  }
+#endif
+
+  // Compute any remaining features one at a time.
+  for(; featIdx < featureCount; ++featIdx)
+  {
+    const int channel = table.channelShifts[featIdx] / 8;
+    const Vector4i offsets(table.x1[featIdx], table.y1[featIdx], table.x2[featIdx], table.y2[featIdx]);
+
+    int raster1, raster2;
+    calculate_secondary_points<DifferenceType>(xyRgb, offsets, rgbSize, normalise, depth, raster1, raster2);
+
+    if(DifferenceType == PAIRWISE_DIFFERENCE) features[featIdx] = static_cast<float>(rgb[raster1][channel] - rgb[raster2][channel]);
+    else features[featIdx] = static_cast<float>(rgb[raster1][channel] - rgb[rasterIdxRgb][channel]);
+  }
+}
+
+/**
+ * \brief Computes depth features for a pixel in the RGBD image using a precomputed offset table.
+ *
+ * The results are bit-identical to those of compute_depth_features. The caller is responsible for checking that
+ * the pixel's keypoint is valid before calling this function.
+ *
+ * \param xyDepth   The coordinates of the pixel in the depth image.
+ * \param depthSize The size of the depth image.
+ * \param depths    A pointer to the depth image.
+ * \param table     The offset table for the depth features.
+ * \param normalise Whether or not to normalise the depth offsets by the pixel's depth value.
+ * \param features  A pointer to the location in the descriptor into which to write the features.
+ */
+template <RGBDPatchFeatureDifferenceType DifferenceType>
+inline void compute_depth_features_tabulated(const Vector2i& xyDepth, const Vector2i& depthSize, const float *depths,
+                                             const RGBDPatchFeatureOffsetTable& table, bool normalise, float *features)
+{
+  const float depth = depths[xyDepth.y * depthSize.width + xyDepth.x];
+  const float depthMm = depth * 1000.0f;
+  const uint32_t featureCount = table.size();
+  uint32_t featIdx = 0;
+
+#ifdef __AVX2__
+  // Compute the features eight at a time. Note that _mm256_max_ps returns its second operand if either operand is NaN,
+  // which matches the behaviour of fmaxf in the shared code.
+  const __m256 thousand = _mm256_set1_ps(1000.0f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 centralDepthMm = _mm256_set1_ps(depthMm);
+  for(; featIdx + 8 <= featureCount; featIdx += 8)
+  {
+    const __m256i raster1 = calculate_secondary_rasters_avx2(xyDepth, &table.x1[featIdx], &table.y1[featIdx], &table.x1f[featIdx], &table.y1f[featIdx], depthSize, normalise, depth);
+    const __m256 depth1Mm = _mm256_max_ps(_mm256_mul_ps(_mm256_i32gather_ps(depths, raster1, 4), thousand), zero);
+
+    __m256 depth2Mm;
+    if(DifferenceType == PAIRWISE_DIFFERENCE)
+    {
+      const __m256i raster2 = calculate_secondary_rasters_avx2(xyDepth, &table.x2[featIdx], &table.y2[featIdx], &table.x2f[featIdx], &table.y2f[featIdx], depthSize, normalise, depth);
+      depth2Mm = _mm256_max_ps(_mm256_mul_ps(_mm256_i32gather_ps(depths, raster2, 4), thousand), zero);
+    }
+    else depth2Mm = centralDepthMm;
+
+    _mm256_storeu_ps(features + featIdx, _mm256_sub_ps(depth1Mm, depth2Mm));
+  }
+#endif
+
+  // Compute any remaining features one at a time.
+  for(; featIdx < featureCount; ++featIdx)
+  {
+    const Vector4i offsets(table.x1[featIdx], table.y1[featIdx], table.x2[featIdx], table.y2[featIdx]);
+
+    int raster1, raster2;
+    calculate_secondary_points<DifferenceType>(xyDepth, offsets, depthSize, normalise, depth, raster1, raster2);
+
+    const float depth1Mm = fmaxf(depths[raster1] * 1000.f, 0.0f);
+    if(DifferenceType == PAIRWISE_DIFFERENCE) features[featIdx] = depth1Mm - fmaxf(depths[raster2] * 1000.0f, 0.0f);
+    else features[featIdx] = depth1Mm - depthMm;
+  }
+}
+
+}
+
+#endif
@@ -63,6 +63,21 @@ struct DecisionForestFactory
    * \throws std::runtime_error If the forest cannot be created.
    */
   static Forest_Ptr make_randomly_generated_forest(const tvgutil::SettingsContainer_CPtr& settings, ORUtils::DeviceType deviceType);
+
+  /**
+   * \brief Gets a decision forest that has been loaded from a file on disk, sharing it with any other clients that are using the same forest.
+   *
+   * The forest is only loaded from disk if no other client currently holds it. This allows e.g. several relocalisers
+   * that are using the same pre-trained forest to avoid each paying the cost of loading it and storing a copy of it.
+   * Clients must treat the forest as read-only.
+   *
+   * \param filename   The path to the file containing the forest.
+   * \param deviceType The device on which the decision forest should operate.
+   * \return           The shared forest.
+   *
+   * \throws std::runtime_error If the forest cannot be loaded.
+   */
+  static Forest_Ptr make_shared_forest(const std::string& filename, ORUtils::DeviceType deviceType);
 };
 
 }
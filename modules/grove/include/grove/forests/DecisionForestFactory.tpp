@@ -5,6 +5,11 @@
 
 #include "DecisionForestFactory.h"
 
+#include <map>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
 #include "cpu/DecisionForest_CPU.h"
 
 #ifdef WITH_CUDA
@@ -83,4 +88,25 @@ DecisionForestFactory<DescriptorType,TreeCount>::make_randomly_generated_forest(
   return forest;
 }
 
+template <typename DescriptorType, int TreeCount>
+typename DecisionForestFactory<DescriptorType,TreeCount>::Forest_Ptr
+DecisionForestFactory<DescriptorType,TreeCount>::make_shared_forest(const std::string& filename, ORUtils::DeviceType deviceType)
+{
+  // Note: We only hold weak references to the forests, so that each forest is destroyed once its last client has finished with it.
+  static std::map<std::pair<std::string,ORUtils::DeviceType>,boost::weak_ptr<Forest> > s_forests;
+  static boost::mutex s_mutex;
+
+  boost::lock_guard<boost::mutex> lock(s_mutex);
+
+  boost::weak_ptr<Forest>& weakForest = s_forests[std::make_pair(filename, deviceType)];
+  Forest_Ptr forest = weakForest.lock();
+  if(!forest)
+  {
+    forest = make_forest(filename, deviceType);
+    weakForest = forest;
+  }
+
+  return forest;
+}
+
 }
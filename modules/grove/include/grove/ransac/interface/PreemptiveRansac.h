@@ -71,6 +71,12 @@ private:
   /** Whether or not to print a summary of the timings of the various steps of preemptive RANSAC on destruction. */
   bool m_printTimers;
 
+  /**
+   * The motion of the camera since the last call to estimate_pose (a transformation from the current camera's space to
+   * that of the previous camera), used to transform the warm-start candidates (if any) during the next call.
+   */
+  Matrix4f m_relativeCameraMotion;
+
   /** The timer for the pose hypothesis generation phase. */
   AverageTimer m_timerCandidateGeneration;
 
@@ -95,6 +101,9 @@ private:
   /** The timer for the entire preemptive RANSAC process. */
   AverageTimer m_timerTotal;
 
+  /** The best candidates that survived the last call to estimate_pose, with which to warm-start the next call (if enabled). */
+  std::vector<PoseCandidate> m_warmStartCandidates;
+
   //#################### PROTECTED VARIABLES ####################
 protected:
   /**
@@ -130,6 +139,12 @@ protected:
    */
   float m_maxTranslationErrorForCorrectPose;
 
+  /**
+   * The maximum number of the best candidates that survived one call to estimate_pose to add to the candidates generated
+   * during the next call (0 disables warm-starting). Useful when consecutive calls are made for very similar images.
+   */
+  uint32_t m_maxWarmStartCandidates;
+
   /** The minimum distance (squared) between sampled modes (if m_checkMinDistanceBetweenSampledModes is enabled). */
   float m_minSquaredDistanceBetweenSampledModes;
 
@@ -276,8 +291,26 @@ public:
    */
   uint32_t get_min_nb_required_points() const;
 
+  /**
+   * \brief Sets the motion of the camera since the last call to estimate_pose.
+   *
+   * \note  This is used to transform the candidates (if any) with which the next call to estimate_pose is warm-started,
+   *        and is reset to the identity after that call.
+   *
+   * \param relativeCameraMotion A transformation from the current camera's space to that of the previous camera.
+   */
+  void set_relative_camera_motion(const Matrix4f& relativeCameraMotion);
+
   //#################### PROTECTED MEMBER FUNCTIONS ####################
 protected:
+  /**
+   * \brief Adds the candidates that survived the last call to estimate_pose (if warm-starting is enabled) to the generated
+   *        pose candidates, after transforming them by the relative camera motion.
+   *
+   * \note  This operates on the CPU copy of the pose candidates (non-CPU subclasses must copy them across afterwards).
+   */
+  void add_warm_start_candidates();
+
   /**
    * \brief Runs the Kabsch algorithm on the three camera/world point correspondences of each generated pose candidate
    *        to obtain an estimate of the camera pose (a rigid transformation matrix from camera space to world space).
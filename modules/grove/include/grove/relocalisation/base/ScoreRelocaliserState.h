@@ -6,6 +6,8 @@
 #ifndef H_GROVE_SCORERELOCALISERSTATE
 #define H_GROVE_SCORERELOCALISERSTATE
 
+#include <vector>
+
 #include <ORUtils/DeviceType.h>
 
 #include "../../keypoints/Keypoint3DColour.h"
@@ -54,9 +56,15 @@ public:
   /** A memory block storing the 3D modal clusters associated with each leaf in the forest. */
   ScorePredictionsMemoryBlock_Ptr predictionsBlock;
 
+  /** A counter that is incremented whenever any of the clusters in the predictions block change. */
+  uint32_t predictionsVersion;
+
   /** The index of the first reservoir to cluster when the relocaliser is updated. */
   uint32_t reservoirUpdateStartIdx;
 
+  /** The value of predictionsVersion at which the clusters associated with each reservoir last changed. */
+  std::vector<uint32_t> reservoirVersions;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -80,6 +88,14 @@ public:
    */
   void load_from_disk(const std::string& inputFolder);
 
+  /**
+   * \brief Records that the clusters associated with a contiguous range of reservoirs have changed.
+   *
+   * \param startIdx The index of the first reservoir whose clusters have changed.
+   * \param count    The number of reservoirs whose clusters have changed.
+   */
+  void mark_predictions_changed(uint32_t startIdx, uint32_t count);
+
   /**
    * \brief Resets the relocaliser state.
    */
@@ -16,6 +16,26 @@ namespace grove {
  */
 class ScoreForestRelocaliser_CPU : public ScoreForestRelocaliser
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A copy of the leaf indices image that was used the last time the predictions were merged (if we're reusing predictions). */
+  mutable LeafIndicesImage_Ptr m_previousLeafIndicesImage;
+
+  /** The image into which the predictions were merged the last time they were merged (if we're reusing predictions). */
+  mutable ScorePredictionsImage_CPtr m_previousOutputPredictions;
+
+  /** The value of the relocaliser state's predictions version the last time the predictions were merged (if we're reusing predictions). */
+  mutable uint32_t m_previousPredictionsVersion;
+
+  /** The relocaliser state that was used the last time the predictions were merged (if we're reusing predictions). */
+  mutable const ScoreRelocaliserState *m_previousRelocaliserState;
+
+  /**
+   * Whether or not to reuse the merged prediction for a keypoint from the previous relocalisation query if its leaves (and
+   * their clusters) are unchanged since then. This is worthwhile when consecutive queries are of very similar images.
+   */
+  bool m_reusePredictions;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -11,6 +11,8 @@
 
 #include <orx/relocalisation/Relocaliser.h>
 
+#include <tvgutil/misc/CachedSetting.h>
+
 #include "../base/ScoreRelocaliserState.h"
 #include "../../clustering/interface/ExampleClusterer.h"
 #include "../../features/interface/RGBDPatchFeatureCalculator.h"
@@ -89,6 +91,9 @@ protected:
   /** The image containing the keypoints extracted from the RGB-D image. */
   Keypoint3DColourImage_Ptr m_keypointsImage;
 
+  /** Whether or not to make a visualisation of the ground truth mapping from pixels to world-space points (if available). */
+  tvgutil::CachedSetting<bool> m_makeGroundTruthPointsImage;
+
   /** The maximum number of clusters to store in each reservoir (used during clustering). */
   uint32_t m_maxClusterCount;
 
@@ -236,6 +241,17 @@ public:
    */
   void set_ground_truth_trajectory(const std::vector<ORUtils::SE3Pose>& groundTruthTrajectory);
 
+  /**
+   * \brief Sets the motion of the camera since the last call to relocalise (e.g. as estimated by a tracker).
+   *
+   * \note  This is only used if P-RANSAC has been configured to warm-start each call with the best candidates that survived
+   *        the previous one (see PreemptiveRansac.maxWarmStartCandidates), in which case it is used to transform them.
+   *        If it is not set, the camera is assumed not to have moved between calls.
+   *
+   * \param relativeCameraMotion A transformation from the current camera's space to that of the camera in the last call to relocalise.
+   */
+  void set_relative_camera_motion(const Matrix4f& relativeCameraMotion);
+
   /** Override */
   virtual void train(const ORUChar4Image *colourImage, const ORFloatImage *depthImage, const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose);
 
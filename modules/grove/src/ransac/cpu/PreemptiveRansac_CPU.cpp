@@ -110,6 +110,9 @@ void PreemptiveRansac_CPU::generate_pose_candidates()
 
   // Run Kabsch on all the generated candidates to estimate the rigid transformations.
   compute_candidate_poses_kabsch();
+
+  // If warm-starting is enabled, add the candidates that survived the last call to estimate_pose.
+  add_warm_start_candidates();
 }
 
 void PreemptiveRansac_CPU::prepare_inliers_for_optimisation()
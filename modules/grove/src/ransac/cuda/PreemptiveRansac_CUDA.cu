@@ -249,7 +249,10 @@ void PreemptiveRansac_CUDA::generate_pose_candidates()
   // Run Kabsch on all the generated candidates to estimate the rigid transformations.
   compute_candidate_poses_kabsch();
 
-  // Copy the computed rigid transformations back across to the device.
+  // If warm-starting is enabled, add the candidates that survived the last call to estimate_pose.
+  add_warm_start_candidates();
+
+  // Copy the computed rigid transformations (and any warm-start candidates) back across to the device.
   m_poseCandidates->UpdateDeviceFromHost();
 }
 
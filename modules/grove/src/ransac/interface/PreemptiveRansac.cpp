@@ -6,6 +6,8 @@
 #include "ransac/interface/PreemptiveRansac.h"
 using namespace tvgutil;
 
+#include <algorithm>
+
 #ifdef WITH_ALGLIB
 #include <alglib/optimization.h>
 #endif
@@ -40,6 +42,8 @@ PreemptiveRansac::PreemptiveRansac(const SettingsContainer_CPtr& settings, const
   m_poseCandidatesAfterCull(0),
   m_settings(settings)
 {
+  m_relativeCameraMotion.setIdentity();
+
   // By default, we set all parameters as in SCoRe forests.
   m_checkMinDistanceBetweenSampledModes = m_settings->get_first_value<bool>(settingsNamespace + "checkMinDistanceBetweenSampledModes", true);                   // Whether or not to force sampled modes to have a minimum distance between them.
   m_checkRigidTransformationConstraint = m_settings->get_first_value<bool>(settingsNamespace + "checkRigidTransformationConstraint", true);                     // Setting this to false speeds things up a lot, at the expense of quality.
@@ -47,6 +51,7 @@ PreemptiveRansac::PreemptiveRansac(const SettingsContainer_CPtr& settings, const
   m_maxPoseCandidates = m_settings->get_first_value<uint32_t>(settingsNamespace + "maxPoseCandidates", 1024);                                                   // The number of initial pose candidates.
   m_maxPoseCandidatesAfterCull = m_settings->get_first_value<uint32_t>(settingsNamespace + "maxPoseCandidatesAfterCull", 64);                                   // Aggressively cull hypotheses to this number.
   m_maxTranslationErrorForCorrectPose = m_settings->get_first_value<float>(settingsNamespace + "maxTranslationErrorForCorrectPose", 0.05f);                     // In m.
+  m_maxWarmStartCandidates = m_settings->get_first_value<uint32_t>(settingsNamespace + "maxWarmStartCandidates", 0);                                           // The number of surviving candidates to carry over to the next call (0 = disabled).
   m_minSquaredDistanceBetweenSampledModes = m_settings->get_first_value<float>(settingsNamespace + "minSquaredDistanceBetweenSampledModes", 0.3f * 0.3f);       // In m.
 
   // Optimisation parameters defaulted as in Valentin's paper.
@@ -283,6 +288,17 @@ boost::optional<PoseCandidate> PreemptiveRansac::estimate_pose(const Keypoint3DC
   // Make sure the pose candidates available on the host are up to date.
   update_host_pose_candidates();
 
+  // If warm-starting is enabled, keep the best candidates that survived the initial cull for use during the next call.
+  // Note that we reset the relative camera motion whether or not this is enabled, since it only applies to a single call.
+  m_warmStartCandidates.clear();
+  if(m_maxWarmStartCandidates > 0)
+  {
+    std::vector<PoseCandidate> bestPoses;
+    get_best_poses(bestPoses);
+    m_warmStartCandidates.assign(bestPoses.begin(), bestPoses.begin() + std::min<size_t>(bestPoses.size(), m_maxWarmStartCandidates));
+  }
+  m_relativeCameraMotion.setIdentity();
+
   // Step 5: If we managed to generate at least one candidate, return the best one.
   const PoseCandidate *candidates = m_poseCandidates->GetData(MEMORYDEVICE_CPU);
   return m_poseCandidates->dataSize > 0 ? boost::optional<PoseCandidate>(candidates[0]) : boost::none;
@@ -310,8 +326,42 @@ uint32_t PreemptiveRansac::get_min_nb_required_points() const
   return m_ransacInliersPerIteration;
 }
 
+void PreemptiveRansac::set_relative_camera_motion(const Matrix4f& relativeCameraMotion)
+{
+  m_relativeCameraMotion = relativeCameraMotion;
+}
+
 //#################### PROTECTED MEMBER FUNCTIONS ####################
 
+void PreemptiveRansac::add_warm_start_candidates()
+{
+  const uint32_t warmStartCount = std::min<uint32_t>(static_cast<uint32_t>(m_warmStartCandidates.size()), m_maxPoseCandidates);
+  if(warmStartCount == 0) return;
+
+  // Append the warm-start candidates to the generated ones if there is space for them; if not, overwrite the last few
+  // generated candidates (these are not in any particular order, so this is equivalent to having generated fewer).
+  const uint32_t firstIdx = std::min<uint32_t>(static_cast<uint32_t>(m_poseCandidates->dataSize), m_maxPoseCandidates - warmStartCount);
+  PoseCandidate *poseCandidates = m_poseCandidates->GetData(MEMORYDEVICE_CPU);
+
+  // Transform each warm-start candidate by the relative camera motion. The camera points used to generate the candidate
+  // are transformed into the current camera's space, so that they still correspond to the same world points.
+  Matrix4f invRelativeCameraMotion;
+  m_relativeCameraMotion.inv(invRelativeCameraMotion);
+  for(uint32_t i = 0; i < warmStartCount; ++i)
+  {
+    PoseCandidate candidate = m_warmStartCandidates[i];
+    candidate.cameraPose = candidate.cameraPose * m_relativeCameraMotion;
+    for(int j = 0; j < PoseCandidate::KABSCH_CORRESPONDENCES_NEEDED; ++j)
+    {
+      candidate.pointsCamera[j] = invRelativeCameraMotion * candidate.pointsCamera[j];
+    }
+
+    poseCandidates[firstIdx + i] = candidate;
+  }
+
+  m_poseCandidates->dataSize = firstIdx + warmStartCount;
+}
+
 void PreemptiveRansac::compute_candidate_poses_kabsch()
 {
   // We assume that the data on the CPU is up-to-date (the CUDA subclass must ensure this).
@@ -5,6 +5,8 @@
 
 #include "relocalisation/base/ScoreRelocaliserState.h"
 
+#include <algorithm>
+
 #include <boost/filesystem.hpp>
 namespace bf = boost::filesystem;
 
@@ -21,7 +23,8 @@ namespace grove {
 //#################### CONSTRUCTORS ####################
 
 ScoreRelocaliserState::ScoreRelocaliserState(uint32_t reservoirCount, uint32_t reservoirCapacity, DeviceType deviceType, uint32_t rngSeed)
-: m_deviceType(deviceType), m_reservoirCapacity(reservoirCapacity), m_reservoirCount(reservoirCount), m_rngSeed(rngSeed)
+: m_deviceType(deviceType), m_reservoirCapacity(reservoirCapacity), m_reservoirCount(reservoirCount), m_rngSeed(rngSeed),
+  predictionsVersion(0), reservoirVersions(reservoirCount, 0)
 {
   reset();
 }
@@ -41,6 +44,9 @@ void ScoreRelocaliserState::load_from_disk(const std::string& inputFolder)
   // If we're using the GPU, copy the predictions across.
   predictionsBlock->UpdateDeviceFromHost();
 
+  // Record that all of the predictions have changed.
+  mark_predictions_changed(0, m_reservoirCount);
+
   // Load the rest of the data.
   const std::string dataFile = (inputPath / "scoreState.txt").string();
   std::ifstream inFile(dataFile.c_str());
@@ -48,6 +54,12 @@ void ScoreRelocaliserState::load_from_disk(const std::string& inputFolder)
   if(!inFile) throw std::runtime_error("Error: Couldn't load relocaliser data from " + dataFile);
 }
 
+void ScoreRelocaliserState::mark_predictions_changed(uint32_t startIdx, uint32_t count)
+{
+  ++predictionsVersion;
+  std::fill(reservoirVersions.begin() + startIdx, reservoirVersions.begin() + startIdx + count, predictionsVersion);
+}
+
 void ScoreRelocaliserState::reset()
 {
   // Set up the reservoirs if they aren't currently allocated.
@@ -66,6 +78,7 @@ void ScoreRelocaliserState::reset()
   lastExamplesAddedStartIdx = 0;
   predictionsBlock->Clear();
   reservoirUpdateStartIdx = 0;
+  mark_predictions_changed(0, m_reservoirCount);
 }
 
 void ScoreRelocaliserState::save_to_disk(const std::string& outputFolder) const
@@ -14,8 +14,12 @@ namespace grove {
 //#################### CONSTRUCTORS ####################
 
 ScoreForestRelocaliser_CPU::ScoreForestRelocaliser_CPU(const SettingsContainer_CPtr& settings, const std::string& settingsNamespace)
-: ScoreForestRelocaliser(settings, settingsNamespace, DEVICE_CPU)
-{}
+: ScoreForestRelocaliser(settings, settingsNamespace, DEVICE_CPU),
+  m_previousPredictionsVersion(0),
+  m_previousRelocaliserState(NULL)
+{
+  m_reusePredictions = m_settings->get_first_value<bool>(settingsNamespace + "reusePredictions", false);
+}
 
 //#################### PROTECTED MEMBER FUNCTIONS ####################
 
@@ -30,6 +34,15 @@ void ScoreForestRelocaliser_CPU::merge_predictions_for_keypoints(const LeafIndic
   ScorePrediction *outputPredictionsPtr = outputPredictions->GetData(MEMORYDEVICE_CPU);
   const ScorePrediction *predictionsBlockPtr = m_relocaliserState->predictionsBlock->GetData(MEMORYDEVICE_CPU);
 
+  // If we're reusing predictions, determine whether the predictions from the previous call are still in the output image.
+  // If so, we can skip merging the predictions for any keypoint whose leaves are unchanged and whose leaves' clusters
+  // have not been changed (by training or updating the relocaliser) since the previous call.
+  const bool canReusePredictions =
+    m_reusePredictions && m_previousLeafIndicesImage && m_previousLeafIndicesImage->noDims == imgSize &&
+    m_previousOutputPredictions == outputPredictions && m_previousRelocaliserState == m_relocaliserState.get();
+  const LeafIndices *previousLeafIndicesPtr = canReusePredictions ? m_previousLeafIndicesImage->GetData(MEMORYDEVICE_CPU) : NULL;
+  const uint32_t *reservoirVersionsPtr = &m_relocaliserState->reservoirVersions[0];
+
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
@@ -37,9 +50,40 @@ void ScoreForestRelocaliser_CPU::merge_predictions_for_keypoints(const LeafIndic
   {
     for(int x = 0; x < imgSize.x; ++x)
     {
+      if(canReusePredictions)
+      {
+        const int rasterIdx = y * imgSize.x + x;
+        const LeafIndices& keypointLeafIndices = leafIndicesPtr[rasterIdx];
+        const LeafIndices& previousKeypointLeafIndices = previousLeafIndicesPtr[rasterIdx];
+
+        bool unchanged = true;
+        for(int treeIdx = 0; treeIdx < FOREST_TREE_COUNT; ++treeIdx)
+        {
+          const int leafIdx = keypointLeafIndices[treeIdx];
+          if(leafIdx != previousKeypointLeafIndices[treeIdx] || reservoirVersionsPtr[leafIdx] > m_previousPredictionsVersion)
+          {
+            unchanged = false;
+            break;
+          }
+        }
+
+        if(unchanged) continue;
+      }
+
       merge_predictions_for_keypoint(x, y, leafIndicesPtr, predictionsBlockPtr, imgSize, m_maxClusterCount, outputPredictionsPtr);
     }
   }
+
+  // If we're reusing predictions, record what we need to reuse the predictions we just merged next time.
+  if(m_reusePredictions)
+  {
+    if(!m_previousLeafIndicesImage) m_previousLeafIndicesImage.reset(new LeafIndicesImage(imgSize, true, false));
+    m_previousLeafIndicesImage->ChangeDims(imgSize);
+    m_previousLeafIndicesImage->SetFrom(leafIndices.get(), LeafIndicesImage::CPU_TO_CPU);
+    m_previousOutputPredictions = outputPredictions;
+    m_previousPredictionsVersion = m_relocaliserState->predictionsVersion;
+    m_previousRelocaliserState = m_relocaliserState.get();
+  }
 }
 
 }
@@ -38,8 +38,11 @@ ScoreForestRelocaliser::ScoreForestRelocaliser(const SettingsContainer_CPtr& set
   else
   {
     const std::string modelFilename = m_settings->get_first_value<std::string>(settingsNamespace + "modelFilename", (find_subdir_from_executable("resources") / "DefaultRelocalisationForest.rf").string());
+    const bool shareForest = m_settings->get_first_value<bool>(settingsNamespace + "shareForest", false);
     std::cout << "Loading relocalisation forest from: " << modelFilename << '\n';
-    m_scoreForest = DecisionForestFactory<DescriptorType,FOREST_TREE_COUNT>::make_forest(modelFilename, deviceType);
+    m_scoreForest = shareForest
+      ? DecisionForestFactory<DescriptorType,FOREST_TREE_COUNT>::make_shared_forest(modelFilename, deviceType)
+      : DecisionForestFactory<DescriptorType,FOREST_TREE_COUNT>::make_forest(modelFilename, deviceType);
   }
 
   // Set the number of reservoirs to allocate to the number of leaves in the forest (i.e. there will be one reservoir per leaf).
@@ -25,6 +25,7 @@ namespace grove {
 ScoreRelocaliser::ScoreRelocaliser(const SettingsContainer_CPtr& settings, const std::string& settingsNamespace, DeviceType deviceType)
 : m_backed(false),
   m_deviceType(deviceType),
+  m_makeGroundTruthPointsImage(settings, settingsNamespace + "makeGroundTruthPointsImage", false),
   m_maxX(static_cast<float>(INT_MIN)),
   m_maxY(static_cast<float>(INT_MIN)),
   m_maxZ(static_cast<float>(INT_MIN)),
@@ -234,6 +235,12 @@ void ScoreRelocaliser::set_ground_truth_trajectory(const std::vector<ORUtils::SE
   m_groundTruthTrajectory = groundTruthTrajectory;
 }
 
+void ScoreRelocaliser::set_relative_camera_motion(const Matrix4f& relativeCameraMotion)
+{
+  boost::lock_guard<boost::recursive_mutex> lock(m_mutex);
+  m_preemptiveRansac->set_relative_camera_motion(relativeCameraMotion);
+}
+
 void ScoreRelocaliser::train(const ORUChar4Image *colourImage, const ORFloatImage *depthImage,
                              const Vector4f& depthIntrinsics, const ORUtils::SE3Pose& cameraPose)
 {
@@ -271,6 +278,7 @@ void ScoreRelocaliser::train(const ORUChar4Image *colourImage, const ORFloatImag
       m_relocaliserState->exampleReservoirs->get_reservoirs(), m_relocaliserState->exampleReservoirs->get_reservoir_sizes(),
       m_relocaliserState->reservoirUpdateStartIdx, nbReservoirsToUpdate, m_relocaliserState->predictionsBlock
     );
+    m_relocaliserState->mark_predictions_changed(m_relocaliserState->reservoirUpdateStartIdx, nbReservoirsToUpdate);
 
     // Store the index of the first reservoir that was just updated so that we can tell when there are no more clusters to update.
     m_relocaliserState->lastExamplesAddedStartIdx = m_relocaliserState->reservoirUpdateStartIdx;
@@ -304,6 +312,7 @@ void ScoreRelocaliser::update()
     m_relocaliserState->exampleReservoirs->get_reservoirs(), m_relocaliserState->exampleReservoirs->get_reservoir_sizes(),
     m_relocaliserState->reservoirUpdateStartIdx, updateCount, m_relocaliserState->predictionsBlock
   );
+  m_relocaliserState->mark_predictions_changed(m_relocaliserState->reservoirUpdateStartIdx, updateCount);
 
   update_reservoir_start_idx();
 }
@@ -333,7 +342,7 @@ void ScoreRelocaliser::make_visualisation_images(const ORFloatImage *depthImage,
     update_pixels_to_points_image(worldToCamera, m_predictionsImage, m_pixelsToPointsImage);
 
     // If requested, also update the ground truth pixel to points image.
-    if(m_settings->get_first_value<bool>(m_settingsNamespace + "makeGroundTruthPointsImage", false))
+    if(m_makeGroundTruthPointsImage.get())
     {
       const Matrix4f& cameraToWorld = (*m_groundTruthTrajectory)[m_groundTruthFrameIndex].GetInvM();
       set_ground_truth_predictions_for_keypoints(m_keypointsImage, cameraToWorld, m_groundTruthPredictionsImage);
@@ -20,11 +20,16 @@ namespace itmx {
  * \brief An instance of this class can be used to read RGB-D images asynchronously from an existing image source.
  *        Images are read from the existing source on a separate thread and stored in an in-memory queue. This
  *        leads to lower latency when processing a disk sequence.
+ *
+ * Images can be obtained from the queue in one of two ways. The standard getImages function copies them into images
+ * provided by the caller. Alternatively, borrow_images can be used to borrow the next RGB-D image in the queue directly,
+ * avoiding the need for any copying. A borrowed RGB-D image is returned to the engine's pool of reusable images when the
+ * last reference to it is released.
  */
 class AsyncImageSourceEngine : public InputSource::ImageSourceEngine
 {
   //#################### NESTED TYPES ####################
-private:
+public:
   /**
    * \brief An instance of this struct can be used to represent an RGB-D image.
    */
@@ -40,6 +45,32 @@ private:
     ORUChar4Image_Ptr rgb;
   };
 
+private:
+  /**
+   * \brief An instance of this struct represents a pool of reusable RGB-D images.
+   *
+   * The pool is shared with any RGB-D images that have been borrowed from the engine, so that they
+   * can be safely returned to it whenever they are released, even if the engine no longer exists.
+   */
+  struct RGBDImagePool
+  {
+    /** The maximum number of RGB-D images that can be stored in the pool. */
+    size_t capacity;
+
+    /** The RGB-D images in the pool. */
+    std::queue<RGBDImage> images;
+
+    /** The synchronisation mutex for the pool. */
+    boost::mutex mutex;
+  };
+
+  //#################### TYPEDEFS ####################
+public:
+  typedef boost::shared_ptr<const RGBDImage> RGBDImage_CPtr;
+
+private:
+  typedef boost::shared_ptr<RGBDImagePool> RGBDImagePool_Ptr;
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The thread on which images are grabbed from the existing image source. */
@@ -51,14 +82,17 @@ private:
   /** The image source from which to obtain the images to cache. */
   ImageSourceEngine_Ptr m_innerSource;
 
-  /** The synchronisation mutex. */
+  /** A flag set by the image grabber once the inner source has run out of images. */
+  bool m_innerSourceFinished;
+
+  /** The synchronisation mutex for the inner source (this must never be held whilst waiting for the main synchronisation mutex). */
+  mutable boost::mutex m_innerSourceMutex;
+
+  /** The main synchronisation mutex (this protects the queue and the flags). */
   mutable boost::mutex m_mutex;
 
   /** A pool of reusable RGB-D images. */
-  std::queue<RGBDImage> m_pool;
-
-  /** The maximum number of elements that can be stored in the RGB-D image pool. */
-  size_t m_poolCapacity;
+  RGBDImagePool_Ptr m_pool;
 
   /** A queue in which to cache images from the inner source. */
   std::queue<RGBDImage> m_queue;
@@ -91,6 +125,18 @@ public:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Borrows the next RGB-D image from the queue, without copying it.
+   *
+   * The RGB-D image is removed from the queue, and is returned to the engine's pool of reusable images (to be
+   * overwritten by a subsequent image from the inner source) when the last reference to it is released. As a
+   * result, the caller must not retain references to its component images once it has released it.
+   *
+   * \return The RGB-D image.
+   * \throws std::runtime_error If there are no more images available.
+   */
+  RGBDImage_CPtr borrow_images();
+
   /** Override */
   virtual ITMLib::ITMRGBDCalib getCalib() const;
 
@@ -112,6 +158,16 @@ private:
    * \brief Runs the image grabber.
    */
   void run_image_grabber();
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Returns an RGB-D image that has been released by its borrower to the specified pool (if there is space available).
+   *
+   * \param pool       The pool.
+   * \param rgbdImage  The RGB-D image.
+   */
+  static void return_to_pool(const RGBDImagePool_Ptr& pool, RGBDImage *rgbdImage);
 };
 
 }
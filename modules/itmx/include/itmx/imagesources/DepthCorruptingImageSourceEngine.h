@@ -8,6 +8,7 @@
 
 #include <orx/base/ORImagePtrTypes.h>
 
+#include <tvgutil/numbers/CounterBasedRandomNumberGenerator.h>
 #include <tvgutil/numbers/RandomNumberGenerator.h>
 
 #include "../base/ITMObjectPtrTypes.h"
@@ -24,13 +25,19 @@ private:
   /** The sigma of the Gaussian to use when corrupting the depth with zero-mean, depth-dependent Gaussian noise (0 = disabled). */
   float m_depthNoiseSigma;
 
+  /** The index of the next frame to be yielded (used to ensure that the noise differs between frames). */
+  boost::uint64_t m_frameIndex;
+
   /** The image source from which to obtain the uncorrupted images. */
   ImageSourceEngine_Ptr m_innerSource;
 
   /** A mask indicating which pixels have missing depth. */
   ORBoolImage_Ptr m_missingDepthMask;
 
-  /** The random number generator. */
+  /** The counter-based random number generator used to generate the per-pixel noise (keyed by frame and pixel block index). */
+  tvgutil::CounterBasedRandomNumberGenerator m_noiseRng;
+
+  /** The random number generator used to generate the missing depth mask. */
   tvgutil::RandomNumberGenerator m_rng;
 
   //#################### CONSTRUCTORS ####################
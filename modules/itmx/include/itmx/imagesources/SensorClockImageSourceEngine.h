@@ -0,0 +1,200 @@
+/**
+ * itmx: SensorClockImageSourceEngine.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ITMX_SENSORCLOCKIMAGESOURCEENGINE
+#define H_ITMX_SENSORCLOCKIMAGESOURCEENGINE
+
+#include <deque>
+#include <string>
+
+#include <boost/chrono.hpp>
+#include <boost/optional.hpp>
+
+#include <tvgutil/timing/LatencyRecorder.h>
+
+#include "AsyncImageSourceEngine.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to replay a disk sequence as if it were being captured by a live sensor.
+ *
+ * The frames of the sequence are released on a simulated sensor clock: frame i is "captured" i / frameRate seconds after the
+ * consumer first asks for a frame, regardless of how quickly the consumer is processing the frames. Captured frames are placed
+ * in a queue of limited capacity, and frames captured whilst the queue is full are dropped, just as they would be if a live
+ * sensor were being read by an AsyncImageSourceEngine whose grabber was blocked on a full queue. If the consumer asks for a
+ * frame before the next one has been captured, it waits for it, as it would for a live sensor.
+ *
+ * The frames themselves are borrowed from an inner AsyncImageSourceEngine that prefetches them from disk (and so stands in for
+ * the sensor's driver), so dropping a frame costs no more than releasing it back to the inner source. If a latency recorder is
+ * specified, the engine records the following (each prefixed by its name) for every frame that the consumer processes:
+ *
+ * - Queue Wait: The time between the frame being captured and the consumer taking it from the queue.
+ * - End-to-End: The time between the frame being captured and the consumer coming back for the next frame.
+ * - Capture: The time the consumer spent waiting for the inner source to supply frames (this should be close to zero,
+ *            unless the disk cannot keep up with the simulated sensor, in which case the other latencies are inflated).
+ * - Idle: The time the consumer spent waiting for the simulated sensor to capture the frame (i.e. its slack).
+ *
+ * It also counts the frames that were captured, processed and dropped, and the number of deadline misses, i.e. the number of
+ * processed frames whose end-to-end latency exceeded one frame period (meaning that a live system would have fallen behind).
+ */
+class SensorClockImageSourceEngine : public InputSource::ImageSourceEngine
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef AsyncImageSourceEngine::RGBDImage_CPtr RGBDImage_CPtr;
+
+private:
+  typedef boost::chrono::steady_clock Clock;
+
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a frame that has been captured by the simulated sensor.
+   */
+  struct CapturedFrame
+  {
+    /** The time at which the frame was captured. */
+    Clock::time_point captureTime;
+
+    /** The RGB-D image (borrowed from the inner source). */
+    RGBDImage_CPtr rgbdImage;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The time the consumer has spent waiting for the inner source to supply frames since it was last handed a frame. */
+  mutable Clock::duration m_captureDuration;
+
+  /** The number of frames that have been captured by the simulated sensor so far. */
+  mutable size_t m_capturedFrameCount;
+
+  /** The capture time of the frame that the consumer is currently processing (if any). */
+  mutable boost::optional<Clock::time_point> m_currentCaptureTime;
+
+  /** The time at which the simulated sensor captured its first frame (set when the consumer first asks for a frame). */
+  mutable boost::optional<Clock::time_point> m_epoch;
+
+  /** The period of the simulated sensor (i.e. the time between consecutive frames). */
+  Clock::duration m_framePeriod;
+
+  /** The time the consumer has spent waiting for the simulated sensor to capture the next frame since it was last handed a frame. */
+  mutable Clock::duration m_idleDuration;
+
+  /** The asynchronous image source from which to borrow the frames. */
+  boost::shared_ptr<AsyncImageSourceEngine> m_innerSource;
+
+  /** The recorder (if any) in which to record the latencies and counts of frames. */
+  tvgutil::LatencyRecorder_Ptr m_latencyRecorder;
+
+  /** The name of the engine (used to prefix the names of the recorded latencies and counts). */
+  std::string m_name;
+
+  /** The frames that have been captured but not yet taken by the consumer. */
+  mutable std::deque<CapturedFrame> m_queue;
+
+  /** The maximum number of captured frames that can be waiting for the consumer (0 means no limit). */
+  size_t m_queueCapacity;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a sensor clock image source engine.
+   *
+   * \param innerSource     The asynchronous image source from which to borrow the frames (the engine takes ownership of this).
+   * \param frameRate       The rate (in Hz) at which the simulated sensor captures frames.
+   * \param queueCapacity   The maximum number of captured frames that can be waiting for the consumer (0 means no limit, i.e. no frames are dropped).
+   * \param latencyRecorder The recorder (if any) in which to record the latencies and counts of frames.
+   * \param name            The name of the engine (used to prefix the names of the recorded latencies and counts).
+   * \throws std::runtime_error If the inner source is NULL or the frame rate is not positive.
+   */
+  SensorClockImageSourceEngine(AsyncImageSourceEngine *innerSource, double frameRate, size_t queueCapacity = 1,
+                               const tvgutil::LatencyRecorder_Ptr& latencyRecorder = tvgutil::LatencyRecorder_Ptr(),
+                               const std::string& name = "Sensor");
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Borrows the next captured RGB-D image from the queue, without copying it, waiting for it to be captured if necessary.
+   *
+   * As for AsyncImageSourceEngine::borrow_images, the RGB-D image is returned to the inner source's pool of reusable images
+   * when the last reference to it is released.
+   *
+   * \return The RGB-D image.
+   * \throws std::runtime_error If there are no more images available.
+   */
+  RGBDImage_CPtr borrow_images();
+
+  /** Override */
+  virtual ITMLib::ITMRGBDCalib getCalib() const;
+
+  /** Override */
+  virtual Vector2i getDepthImageSize() const;
+
+  /** Override */
+  virtual void getImages(ORUChar4Image *rgb, ORShortImage *rawDepth);
+
+  /** Override */
+  virtual Vector2i getRGBImageSize() const;
+
+  /**
+   * \brief Gets whether or not a captured frame is available, waiting for the next frame to be captured if necessary.
+   *
+   * Calling this also marks the end of the processing of the previous frame (if any), which is when its end-to-end latency is recorded.
+   *
+   * \return  true, if a captured frame is available, or false if the sequence has finished.
+   */
+  virtual bool hasImagesNow() const;
+
+  /**
+   * \brief Gets whether or not there are any more frames to come (without waiting for the next frame to be captured).
+   *
+   * \return  true, if there are more frames to come, or false otherwise.
+   */
+  virtual bool hasMoreImages() const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Adds the specified amount to one of the engine's counters in the latency recorder (if any).
+   *
+   * \param counter The name of the counter (without the engine's prefix).
+   * \param amount  The amount to add to the counter.
+   */
+  void add_to_counter(const char *counter, size_t amount = 1) const;
+
+  /**
+   * \brief Captures all of the frames whose capture times have passed, queueing each one if there is space in the queue or dropping it otherwise.
+   *
+   * \param now The current time.
+   */
+  void capture_frames(const Clock::time_point& now) const;
+
+  /**
+   * \brief Records the end-to-end latency of the frame that the consumer was processing (if any), and whether or not it missed its deadline.
+   *
+   * \param now The current time (at which the consumer has come back for another frame).
+   */
+  void finish_current_frame(const Clock::time_point& now) const;
+
+  /**
+   * \brief Records a latency for one of the engine's stages in the latency recorder (if any).
+   *
+   * \param stage   The name of the stage (without the engine's prefix).
+   * \param latency The latency of the stage.
+   */
+  void record_latency(const char *stage, const Clock::duration& latency) const;
+
+  /**
+   * \brief Waits until either a captured frame is available or the sequence has finished.
+   *
+   * \return  true, if a captured frame is available, or false if the sequence has finished.
+   */
+  bool wait_for_frame() const;
+};
+
+}
+
+#endif
@@ -25,7 +25,7 @@ enum InteractionType
   /** An interaction in which the client asks the server whether it has ever rendered an image of the scene for that client. */
   IT_HASRENDEREDIMAGE = 1,
 
-  /** An interaction in which the client sends a single RGB-D frame to the server. */
+  /** An interaction in which the client sends a single RGB-D frame to the server (which responds with a mapping status message). */
   IT_SENDFRAME = 2,
 
   /** An interaction in which the client sends a new rendering request to the server. */
@@ -6,9 +6,13 @@
 #ifndef H_ITMX_MAPPINGCLIENT
 #define H_ITMX_MAPPINGCLIENT
 
+#include <boost/atomic.hpp>
+
 #include <tvgutil/boost/WrappedAsio.h>
 #include <tvgutil/containers/PooledQueue.h>
 
+#include "MappingRateController.h"
+#include "RenderingResponseCompressor.h"
 #include "RGBDCalibrationMessage.h"
 #include "RGBDFrameCompressor.h"
 #include "RGBDFrameMessage.h"
@@ -24,6 +28,38 @@ class MappingClient
 public:
   typedef tvgutil::PooledQueue<RGBDFrameMessage_Ptr> RGBDFrameMessageQueue;
 
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains statistics about the frames that a mapping client has sent to the server,
+   *        and about the server-rendered images it has received in return.
+   */
+  struct Statistics
+  {
+    /** The total number of bytes of rendering responses received from the server. */
+    uint64_t bytesReceived;
+
+    /** The total number of bytes of frame data sent to the server. */
+    uint64_t bytesSent;
+
+    /** The number of frames that the server has reported having to drop after receiving them. */
+    uint32_t framesDroppedByServer;
+
+    /** The number of frames sent to the server. */
+    uint32_t framesSent;
+
+    /** The number of frames skipped by the client (without being compressed or sent) to avoid overloading the server. */
+    uint32_t framesSkipped;
+
+    /** The number of rendering responses received from the server. */
+    uint32_t renderingResponsesReceived;
+
+    /**
+     * \brief Constructs an empty set of statistics.
+     */
+    Statistics();
+  };
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** A frame compressor, used to compress frame messages to reduce the network bandwidth they consume. */
@@ -35,9 +71,30 @@ private:
   /** A mutex used to synchronise interactions with the server to avoid overlaps. */
   mutable boost::mutex m_interactionMutex;
 
+  /** The controller used to adapt the rate at which frames are sent to the server (and the quality with which they are compressed). */
+  MappingRateController m_rateController;
+
+  /** Whether or not to adapt the rate at which frames are sent to the server (and the quality with which they are compressed). */
+  boost::atomic<bool> m_rateControlEnabled;
+
   /** The image in which remote scene renderings retrieved from the server are stored. */
   mutable ORUChar4Image_Ptr m_remoteImage;
 
+  /** The compressor used to apply the rendering responses received from the server to the remote image. */
+  RenderingResponseCompressor_Ptr m_renderingResponseCompressor;
+
+  /** A place in which to store rendering response header messages. */
+  mutable RenderingResponseHeaderMessage m_renderingResponseHeaderMessage;
+
+  /** A place in which to store rendering response messages. */
+  mutable RenderingResponseMessage m_renderingResponseMessage;
+
+  /** Statistics about the frames that have been sent to the server. */
+  mutable Statistics m_statistics;
+
+  /** The synchronisation mutex for the statistics. */
+  mutable boost::mutex m_statisticsMutex;
+
   /** The TCP stream used as a wrapper around the connection to the server. */
   mutable boost::asio::ip::tcp::iostream m_stream;
 
@@ -66,6 +123,13 @@ public:
    */
   ORUChar4Image_CPtr get_remote_image() const;
 
+  /**
+   * \brief Gets statistics about the frames that have been sent to the server.
+   *
+   * \return  Statistics about the frames that have been sent to the server.
+   */
+  Statistics get_statistics() const;
+
   /**
    * \brief Sends a calibration message to the server.
    *
@@ -73,6 +137,15 @@ public:
    */
   void send_calibration_message(const RGBDCalibrationMessage& msg);
 
+  /**
+   * \brief Sets whether or not to adapt the rate at which frames are sent to the server (and the quality with which they are compressed).
+   *
+   * Rate control is enabled by default. When it is disabled, every frame pushed onto the frame message queue is sent to the server.
+   *
+   * \param rateControlEnabled Whether or not to adapt the rate at which frames are sent to the server.
+   */
+  void set_rate_control_enabled(bool rateControlEnabled);
+
   /**
    * \brief Sends a request to the server to render a visualisation of the scene for the client.
    *
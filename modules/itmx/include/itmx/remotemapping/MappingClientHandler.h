@@ -6,6 +6,8 @@
 #ifndef H_ITMX_MAPPINGCLIENTHANDLER
 #define H_ITMX_MAPPINGCLIENTHANDLER
 
+#include <boost/chrono.hpp>
+
 #include <ITMLib/Objects/Camera/ITMRGBDCalib.h>
 
 #include <tvgutil/containers/PooledQueue.h>
@@ -13,6 +15,7 @@
 #include <tvgutil/net/ClientHandler.h>
 
 #include "RenderingRequestMessage.h"
+#include "RenderingResponseCompressor.h"
 #include "RGBDFrameCompressor.h"
 
 namespace itmx {
@@ -32,6 +35,9 @@ private:
   /** The calibration parameters of the camera associated with the client. */
   ITMLib::ITMRGBDCalib m_calib;
 
+  /** The number of frames from the client that have had to be dropped because the frame message queue was full. */
+  uint32_t m_droppedFrameCount;
+
   /** A dummy frame message to consume messages that cannot be pushed onto the queue. */
   RGBDFrameMessage_Ptr m_dummyFrameMessage;
 
@@ -44,15 +50,27 @@ private:
   /** A queue containing the RGB-D frame messages received from the client. */
   RGBDFrameMessageQueue_Ptr m_frameMessageQueue;
 
+  /** The capacity of the frame message queue. */
+  size_t m_frameMessageQueueCapacity;
+
   /** A place in which to store compressed RGB-D frame header messages. */
   CompressedRGBDFrameHeaderMessage m_headerMessage;
 
   /** A flag indicating whether or not the images associated with the first message in the queue have already been read. */
   bool m_imagesDirty;
 
+  /** The time at which a frame message was last popped from the queue (if any). */
+  boost::optional<boost::chrono::steady_clock::time_point> m_lastPopTime;
+
   /** A flag indicating whether or not the pose associated with the first message in the queue has already been read. */
   bool m_poseDirty;
 
+  /** A running average of the interval (in seconds) between successive frame messages being popped from the queue (0 if unknown). */
+  double m_processingInterval;
+
+  /** The synchronisation mutex for the processing interval. */
+  mutable boost::mutex m_processingIntervalMutex;
+
   /** An optional image into which to render the scene for the client. */
   ORUChar4Image_Ptr m_renderedImage;
 
@@ -65,8 +83,14 @@ private:
   /** The synchronisation mutex for the rendering request. */
   boost::mutex m_renderingRequestMutex;
 
-  /** A place in which to store uncompressed RGB-D frame messages that can be used to send server-rendered images back to the client. */
-  RGBDFrameMessage_Ptr m_renderingResponseMessage;
+  /** The compressor used to send the changes to the server-rendered images back to the client. */
+  RenderingResponseCompressor_Ptr m_renderingResponseCompressor;
+
+  /** A place in which to store rendering response header messages. */
+  RenderingResponseHeaderMessage m_renderingResponseHeaderMessage;
+
+  /** A place in which to store rendering response messages. */
+  boost::shared_ptr<RenderingResponseMessage> m_renderingResponseMessage;
 
   /** The scene ID that is associated with the client. */
   std::string m_sceneID;
@@ -140,6 +164,13 @@ public:
    */
   bool pose_dirty() const;
 
+  /**
+   * \brief Pops the first frame message from the queue, and records the fact that the server has finished processing it.
+   *
+   * This also resets the flags indicating whether or not the images and pose associated with the first message in the queue have been read.
+   */
+  void pop_frame_message();
+
   /**
    * \brief Gets the size of the colour images produced by the client.
    *
@@ -0,0 +1,88 @@
+/**
+ * itmx: MappingRateController.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ITMX_MAPPINGRATECONTROLLER
+#define H_ITMX_MAPPINGRATECONTROLLER
+
+#include "MappingStatusMessage.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used by a mapping client to adapt the rate at which it sends frames to a mapping server,
+ *        and the quality with which it compresses them, based on the status messages it receives from the server.
+ *
+ * Two different bottlenecks are handled:
+ *
+ * - If the server is not keeping up with the frames it receives (i.e. its frame queue for the client is filling up, or it is
+ *   having to drop frames), the controller increases the minimum interval between the frames the client sends, so that the
+ *   client drops the excess frames before compressing and sending them, rather than the server dropping them afterwards.
+ *   When the server is keeping up again, the interval is gradually reduced, so that the client probes for spare capacity.
+ *
+ * - If sending a frame (and waiting for the server to acknowledge it) takes longer than the specified link budget, the link
+ *   is assumed to be the bottleneck, and the controller reduces the quality used for JPG compression of the RGB images.
+ *   When transfers are comfortably within the budget again, the quality is gradually restored.
+ */
+class MappingRateController
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The quality (in [0,100]) that should currently be used for JPG compression of the RGB images. */
+  int m_jpegQuality;
+
+  /** The number of frames from the client that the server had dropped as of the last status message received. */
+  uint32_t m_lastDroppedFrameCount;
+
+  /** The maximum time (in seconds) that sending a frame to the server should take. */
+  double m_linkBudget;
+
+  /** The maximum quality to use for JPG compression of the RGB images. */
+  int m_maxJpegQuality;
+
+  /** The minimum quality to use for JPG compression of the RGB images. */
+  int m_minJpegQuality;
+
+  /** The minimum interval (in seconds) that should currently be left between sending successive frames. */
+  double m_minSendInterval;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a mapping rate controller.
+   *
+   * \param linkBudget      The maximum time (in seconds) that sending a frame to the server should take.
+   * \param minJpegQuality  The minimum quality to use for JPG compression of the RGB images.
+   * \param maxJpegQuality  The maximum quality to use for JPG compression of the RGB images.
+   */
+  explicit MappingRateController(double linkBudget = 1.0 / 30.0, int minJpegQuality = 50, int maxJpegQuality = 95);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the quality (in [0,100]) that should currently be used for JPG compression of the RGB images.
+   *
+   * \return  The quality that should currently be used for JPG compression of the RGB images.
+   */
+  int get_jpeg_quality() const;
+
+  /**
+   * \brief Gets the minimum interval (in seconds) that should currently be left between sending successive frames.
+   *
+   * \return  The minimum interval (in seconds) that should currently be left between sending successive frames.
+   */
+  double get_min_send_interval() const;
+
+  /**
+   * \brief Updates the controller based on the status message received from the server in acknowledgement of a frame.
+   *
+   * \param status        The status message received from the server.
+   * \param transferTime  The time (in seconds) it took to send the frame and receive the status message.
+   */
+  void update(const MappingStatusMessage& status, double transferTime);
+};
+
+}
+
+#endif
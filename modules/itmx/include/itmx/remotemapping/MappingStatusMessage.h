@@ -0,0 +1,105 @@
+/**
+ * itmx: MappingStatusMessage.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ITMX_MAPPINGSTATUSMESSAGE
+#define H_ITMX_MAPPINGSTATUSMESSAGE
+
+#include <boost/cstdint.hpp>
+
+#include "MappingMessage.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class represents a message containing the status of a mapping server's processing of the frames from a client.
+ *
+ * A mapping server sends one of these to a client in acknowledgement of each frame it receives, so that the client can
+ * adapt the rate at which it sends frames (and the quality with which it compresses them) to what the server can handle.
+ */
+class MappingStatusMessage : public MappingMessage
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The byte segment within the message data that corresponds to the number of frames from the client that the server has had to drop. */
+  Segment m_droppedFrameCountSegment;
+
+  /** The byte segment within the message data that corresponds to the rate (in frames per second) at which the server is processing frames from the client. */
+  Segment m_processingRateSegment;
+
+  /** The byte segment within the message data that corresponds to the capacity of the server's frame queue for the client. */
+  Segment m_queueCapacitySegment;
+
+  /** The byte segment within the message data that corresponds to the number of frames in the server's frame queue for the client. */
+  Segment m_queueSizeSegment;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a mapping status message.
+   */
+  MappingStatusMessage();
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Extracts the number of frames from the client that the server has had to drop from the message.
+   *
+   * \return  The number of frames from the client that the server has had to drop.
+   */
+  uint32_t extract_dropped_frame_count() const;
+
+  /**
+   * \brief Extracts the rate (in frames per second) at which the server is processing frames from the client from the message.
+   *
+   * \return  The rate (in frames per second) at which the server is processing frames from the client (0 if unknown).
+   */
+  float extract_processing_rate() const;
+
+  /**
+   * \brief Extracts the capacity of the server's frame queue for the client from the message.
+   *
+   * \return  The capacity of the server's frame queue for the client.
+   */
+  uint32_t extract_queue_capacity() const;
+
+  /**
+   * \brief Extracts the number of frames in the server's frame queue for the client from the message.
+   *
+   * \return  The number of frames in the server's frame queue for the client.
+   */
+  uint32_t extract_queue_size() const;
+
+  /**
+   * \brief Sets the number of frames from the client that the server has had to drop.
+   *
+   * \param droppedFrameCount The number of frames from the client that the server has had to drop.
+   */
+  void set_dropped_frame_count(uint32_t droppedFrameCount);
+
+  /**
+   * \brief Sets the rate (in frames per second) at which the server is processing frames from the client.
+   *
+   * \param processingRate  The rate (in frames per second) at which the server is processing frames from the client.
+   */
+  void set_processing_rate(float processingRate);
+
+  /**
+   * \brief Sets the capacity of the server's frame queue for the client.
+   *
+   * \param queueCapacity The capacity of the server's frame queue for the client.
+   */
+  void set_queue_capacity(uint32_t queueCapacity);
+
+  /**
+   * \brief Sets the number of frames in the server's frame queue for the client.
+   *
+   * \param queueSize The number of frames in the server's frame queue for the client.
+   */
+  void set_queue_size(uint32_t queueSize);
+};
+
+}
+
+#endif
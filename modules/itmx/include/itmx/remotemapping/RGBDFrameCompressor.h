@@ -56,6 +56,16 @@ public:
    */
   void compress_rgbd_frame(const RGBDFrameMessage& uncompressedFrame, CompressedRGBDFrameHeaderMessage& compressedHeader, CompressedRGBDFrameMessage& compressedFrame);
 
+  /**
+   * \brief Sets the quality to use when compressing RGB images using JPG compression.
+   *
+   * Note that this has no effect unless JPG compression is being used for the RGB images. The quality used is not needed
+   * to uncompress the images, so it can be changed at any point without needing to notify the uncompressing side.
+   *
+   * \param rgbJpegQuality The quality (in [0,100]) to use when compressing RGB images using JPG compression.
+   */
+  void set_rgb_jpeg_quality(int rgbJpegQuality);
+
   /**
    * \brief Uncompresses an RGB-D frame message.
    *
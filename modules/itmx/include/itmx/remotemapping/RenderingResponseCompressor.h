@@ -0,0 +1,144 @@
+/**
+ * itmx: RenderingResponseCompressor.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ITMX_RENDERINGRESPONSECOMPRESSOR
+#define H_ITMX_RENDERINGRESPONSECOMPRESSOR
+
+#include <orx/base/ORImagePtrTypes.h>
+
+#include "RGBCompressionType.h"
+#include "RenderingResponseMessage.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to compress or decompress the responses a mapping server sends to a client's requests for its rendered image.
+ *
+ * On the server, the compressor remembers the last image the client acknowledged receiving, and compresses each new rendered image as a
+ * delta against it: the image is divided into square tiles, and only the tiles that have changed are sent (packed into a single mosaic
+ * image that is compressed as a whole). If no tiles have changed, the response is a "not modified" reply. On the client, the compressor
+ * applies each response to the image the client already has.
+ */
+class RenderingResponseCompressor
+{
+  //#################### NESTED TYPES ####################
+private:
+  /** Forward declare a nested structure holding private implementation data. */
+  struct Impl;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A pointer to the implementation details. */
+  boost::shared_ptr<Impl> m_impl;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a rendering response compressor.
+   *
+   * \param rgbCompressionType  The type of compression to apply to the mosaics of changed tiles.
+   * \param tileSize            The size (in pixels) of each (square) tile (ignored when uncompressing, since the server specifies it).
+   *
+   * \throws std::invalid_argument  If the specified compression type cannot be used (e.g. when building without OpenCV).
+   */
+  explicit RenderingResponseCompressor(RGBCompressionType rgbCompressionType = RGB_COMPRESSION_NONE, int tileSize = 64);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Records the fact that the client has acknowledged receiving the most recently compressed response.
+   *
+   * Subsequent responses will be compressed as deltas against the image from which that response was compressed.
+   */
+  void acknowledge_rendering_response();
+
+  /**
+   * \brief Compresses a response containing the specified rendered image as a delta against the last image the client acknowledged.
+   *
+   * \note  The image must be accessible on the CPU.
+   *
+   * \param image             The rendered image.
+   * \param compressedHeader  Will contain the header data for the response (with a tile count of 0 for a "not modified" reply).
+   * \param compressedMsg     Will contain the changed tiles (if any).
+   */
+  void compress_rendering_response(const ORUChar4Image *image, RenderingResponseHeaderMessage& compressedHeader, RenderingResponseMessage& compressedMsg);
+
+  /**
+   * \brief Records the fact that the client was unable to apply the most recently compressed response.
+   *
+   * Since the server can then no longer be sure which image the client has, the next response will contain all of the tiles.
+   */
+  void reject_rendering_response();
+
+  /**
+   * \brief Uncompresses a response, and applies it to the image the client already has.
+   *
+   * \param compressedHeader  The header data for the response.
+   * \param compressedMsg     The changed tiles (ignored for a "not modified" reply).
+   * \param image             The image the client already has, which will be resized as necessary and updated in place.
+   *
+   * \throws std::runtime_error If the response is invalid (in which case the image is left unchanged).
+   */
+  void uncompress_rendering_response(const RenderingResponseHeaderMessage& compressedHeader, const RenderingResponseMessage& compressedMsg, ORUChar4Image *image);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Compresses the mosaic on which we are currently working.
+   */
+  void compress_mosaic();
+
+  /**
+   * \brief Uncompresses the compressed mosaic on which we are currently working.
+   */
+  void uncompress_mosaic();
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the size of the mosaic needed to hold the specified number of tiles from an image.
+   *
+   * The mosaic is as wide as the image (in tiles) wherever possible, so a response that contains all of the tiles has the same layout as the image.
+   *
+   * \param imgSize   The size of the image.
+   * \param tileCount The number of tiles.
+   * \param tileSize  The size (in pixels) of each tile.
+   * \return          The size of the mosaic.
+   */
+  static Vector2i compute_mosaic_size(const Vector2i& imgSize, int tileCount, int tileSize);
+
+  /**
+   * \brief Copies a tile from one image to another.
+   *
+   * Only the part of the tile that lies within both images is copied.
+   *
+   * \param source    The source image.
+   * \param sourcePos The position of the top-left corner of the tile in the source image.
+   * \param target    The target image.
+   * \param targetPos The position of the top-left corner of the tile in the target image.
+   * \param tileSize  The size (in pixels) of the tile.
+   */
+  static void copy_tile(const ORUChar4Image *source, const Vector2i& sourcePos, ORUChar4Image *target, const Vector2i& targetPos, int tileSize);
+
+  /**
+   * \brief Determines whether or not the specified tile differs between two images of the same size.
+   *
+   * \param image1    The first image.
+   * \param image2    The second image.
+   * \param pos       The position of the top-left corner of the tile.
+   * \param tileSize  The size (in pixels) of the tile.
+   * \return          true, if the tile differs between the two images, or false otherwise.
+   */
+  static bool tile_differs(const ORUChar4Image *image1, const ORUChar4Image *image2, const Vector2i& pos, int tileSize);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<RenderingResponseCompressor> RenderingResponseCompressor_Ptr;
+typedef boost::shared_ptr<const RenderingResponseCompressor> RenderingResponseCompressor_CPtr;
+
+}
+
+#endif
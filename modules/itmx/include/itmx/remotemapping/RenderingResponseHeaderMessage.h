@@ -0,0 +1,108 @@
+/**
+ * itmx: RenderingResponseHeaderMessage.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ITMX_RENDERINGRESPONSEHEADERMESSAGE
+#define H_ITMX_RENDERINGRESPONSEHEADERMESSAGE
+
+#include <boost/cstdint.hpp>
+
+#include <ORUtils/Math.h>
+
+#include "MappingMessage.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class represents a message describing a response from a mapping server to a request for its rendered image of the scene.
+ *
+ * A rendering response updates the image the client already has by replacing those square tiles of it that have changed since the
+ * last response the client acknowledged. The changed tiles are sent in a separate rendering response message. If no tiles have
+ * changed, the response is a "not modified" reply, and no rendering response message follows the header.
+ */
+class RenderingResponseHeaderMessage : public MappingMessage
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The byte segment within the message data that corresponds to the size in bytes of the compressed tile data. */
+  Segment m_compressedTileDataByteSizeSegment;
+
+  /** The byte segment within the message data that corresponds to the dimensions of the rendered image. */
+  Segment m_imageSizeSegment;
+
+  /** The byte segment within the message data that corresponds to the number of tiles in the response. */
+  Segment m_tileCountSegment;
+
+  /** The byte segment within the message data that corresponds to the size (in pixels) of each (square) tile. */
+  Segment m_tileSizeSegment;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a rendering response header message.
+   */
+  RenderingResponseHeaderMessage();
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Extracts the size (in bytes) of the compressed tile data from the message.
+   *
+   * \return  The size (in bytes) of the compressed tile data.
+   */
+  uint32_t extract_compressed_tile_data_byte_size() const;
+
+  /**
+   * \brief Extracts the dimensions of the rendered image from the message.
+   *
+   * \return  The dimensions of the rendered image.
+   */
+  Vector2i extract_image_size() const;
+
+  /**
+   * \brief Extracts the number of tiles in the response from the message.
+   *
+   * \return  The number of tiles in the response (0 for a "not modified" reply).
+   */
+  uint32_t extract_tile_count() const;
+
+  /**
+   * \brief Extracts the size (in pixels) of each (square) tile from the message.
+   *
+   * \return  The size (in pixels) of each tile.
+   */
+  uint32_t extract_tile_size() const;
+
+  /**
+   * \brief Sets the size (in bytes) of the compressed tile data.
+   *
+   * \param compressedTileDataByteSize  The size (in bytes) of the compressed tile data.
+   */
+  void set_compressed_tile_data_byte_size(uint32_t compressedTileDataByteSize);
+
+  /**
+   * \brief Sets the dimensions of the rendered image.
+   *
+   * \param imageSize The dimensions of the rendered image.
+   */
+  void set_image_size(const Vector2i& imageSize);
+
+  /**
+   * \brief Sets the number of tiles in the response.
+   *
+   * \param tileCount The number of tiles in the response (0 for a "not modified" reply).
+   */
+  void set_tile_count(uint32_t tileCount);
+
+  /**
+   * \brief Sets the size (in pixels) of each (square) tile.
+   *
+   * \param tileSize  The size (in pixels) of each tile.
+   */
+  void set_tile_size(uint32_t tileSize);
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * itmx: RenderingResponseMessage.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ITMX_RENDERINGRESPONSEMESSAGE
+#define H_ITMX_RENDERINGRESPONSEMESSAGE
+
+#include "RenderingResponseHeaderMessage.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class represents a message containing the changed tiles of an image rendered by a mapping server for a client.
+ *
+ * The message contains the indices of the changed tiles (in raster order within the rendered image), followed by the compressed data
+ * for a mosaic image into which the tiles have been packed (in the same order as their indices).
+ */
+class RenderingResponseMessage : public MappingMessage
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The byte segment within the message data that corresponds to the compressed tile data. */
+  Segment m_compressedTileDataSegment;
+
+  /** The byte segment within the message data that corresponds to the tile indices. */
+  Segment m_tileIndicesSegment;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a rendering response message.
+   *
+   * \param headerMsg The header message corresponding to this message, which specifies the number of tiles and the size of the compressed tile data.
+   */
+  explicit RenderingResponseMessage(const RenderingResponseHeaderMessage& headerMsg);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Extracts the compressed tile data from the message and writes it into the specified destination vector.
+   *
+   * \param compressedTileData  The vector into which to write the compressed tile data. It will be resized as necessary.
+   */
+  void extract_compressed_tile_data(std::vector<uint8_t>& compressedTileData) const;
+
+  /**
+   * \brief Extracts the tile indices from the message and writes them into the specified destination vector.
+   *
+   * \param tileIndices The vector into which to write the tile indices. It will be resized as necessary.
+   */
+  void extract_tile_indices(std::vector<uint32_t>& tileIndices) const;
+
+  /**
+   * \brief Copies the compressed tile data into the appropriate byte segment in the message.
+   *
+   * \param compressedTileData  The compressed tile data.
+   * \throws std::runtime_error If the size of the compressed tile data does not match that of the corresponding segment in the message.
+   */
+  void set_compressed_tile_data(const std::vector<uint8_t>& compressedTileData);
+
+  /**
+   * \brief Sets the segment sizes for the tile indices and compressed tile data according to the header message. Resizes the raw data storage accordingly.
+   *
+   * \param headerMsg The header message corresponding to this message, which specifies the number of tiles and the size of the compressed tile data.
+   */
+  void set_segment_sizes(const RenderingResponseHeaderMessage& headerMsg);
+
+  /**
+   * \brief Copies the tile indices into the appropriate byte segment in the message.
+   *
+   * \param tileIndices The tile indices.
+   * \throws std::runtime_error If the number of tile indices does not match the size of the corresponding segment in the message.
+   */
+  void set_tile_indices(const std::vector<uint32_t>& tileIndices);
+};
+
+}
+
+#endif
@@ -0,0 +1,216 @@
+/**
+ * itmx: ConcurrentCompositeTracker.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ITMX_CONCURRENTCOMPOSITETRACKER
+#define H_ITMX_CONCURRENTCOMPOSITETRACKER
+
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread.hpp>
+
+#ifndef BOOST_NO_CXX11_HDR_EXCEPTION
+  #include <exception>
+#else
+  #include <boost/exception_ptr.hpp>
+#endif
+
+#include "../base/ITMObjectPtrTypes.h"
+
+namespace itmx {
+
+/**
+ * \brief An instance of this class can be used to run a number of independent trackers concurrently and adopt the first good result by priority.
+ *
+ * This is a concurrent alternative to an ITMCompositeTracker with the stop-on-first-success policy. Each nested tracker runs on its
+ * own worker thread, starting from its own copy of the tracking state, so a failing high-priority tracker no longer delays the start
+ * of the lower-priority trackers that may succeed in its place. The result of a tracker is adopted as soon as it is good and all of
+ * the trackers with a higher priority (i.e. that were added earlier) have finished without a good result. If no tracker produces a
+ * good result, the highest-priority poor result is adopted instead; if every tracker fails, tracking is deemed to have failed.
+ *
+ * The nested trackers cannot be interrupted, so trackers whose results are not needed are cancelled in the sense that their results
+ * are discarded: they finish tracking the frame in the background, using the composite's own copies of the view and point cloud,
+ * and the composite waits for them before the next frame is tracked. A nested tracker can also be marked as one that must always
+ * finish before the composite returns, which is needed for a tracker (such as a FallibleTracker) whose state is inspected after
+ * tracking.
+ */
+class ConcurrentCompositeTracker : public ITMLib::ITMTracker
+{
+  //#################### NESTED TYPES ####################
+private:
+#ifndef BOOST_NO_CXX11_HDR_EXCEPTION
+  typedef std::exception_ptr ExceptionPtr;
+#else
+  typedef boost::exception_ptr ExceptionPtr;
+#endif
+
+  /**
+   * \brief An instance of this struct holds the state associated with a nested tracker.
+   */
+  struct NestedTracker
+  {
+    /** The exception thrown by the nested tracker's most recent run (if any). */
+    ExceptionPtr error;
+
+    /** Whether or not the composite must wait for the nested tracker to finish before returning. */
+    bool mustFinish;
+
+    /** Whether or not the nested tracker is currently tracking a frame. */
+    bool running;
+
+    /** The nested tracker itself. */
+    Tracker_Ptr tracker;
+
+    /** The nested tracker's own copy of the tracking state (which shares the composite's copy of the point cloud). */
+    TrackingState_Ptr trackingState;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The type of memory on which the views and tracking states are stored. */
+  MemoryDeviceType m_memoryType;
+
+  /** The synchronisation mutex. */
+  boost::mutex m_mutex;
+
+  /** The nested trackers, in priority order. */
+  std::vector<NestedTracker> m_nestedTrackers;
+
+  /** The composite's own copy of the point cloud being tracked against, which is shared (read-only) by the nested trackers. */
+  boost::shared_ptr<ITMLib::ITMPointCloud> m_pointCloud;
+
+  /** Whether or not the worker threads should terminate. */
+  bool m_shuttingDown;
+
+  /** The worker threads (one per nested tracker). */
+  boost::thread_group m_threads;
+
+  /** A condition variable used to wake the worker threads when a frame is ready to be tracked. */
+  boost::condition_variable m_trackingStarted;
+
+  /** A condition variable used to signal that a nested tracker has finished tracking a frame. */
+  boost::condition_variable m_trackerFinished;
+
+  /** The composite's own copy of the view being tracked, which is shared (read-only) by the nested trackers. */
+  View_Ptr m_view;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a concurrent composite tracker.
+   *
+   * \param memoryType  The type of memory on which the views and tracking states that will be passed to the tracker are stored.
+   */
+  explicit ConcurrentCompositeTracker(MemoryDeviceType memoryType);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the concurrent composite tracker, waiting for any nested trackers that are still running to finish.
+   */
+  ~ConcurrentCompositeTracker();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  ConcurrentCompositeTracker(const ConcurrentCompositeTracker&);
+  ConcurrentCompositeTracker& operator=(const ConcurrentCompositeTracker&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds a nested tracker to the composite, with a lower priority than any nested tracker that has already been added.
+   *
+   * \note  Nested trackers must be added before the composite is first used to track a frame.
+   *
+   * \param tracker     The nested tracker.
+   * \param mustFinish  Whether or not the composite must always wait for the nested tracker to finish before returning.
+   * \throws std::runtime_error If the composite has already been used to track a frame.
+   */
+  void add_tracker(const Tracker_Ptr& tracker, bool mustFinish = false);
+
+  /** Override */
+  virtual bool CanKeepTracking() const;
+
+  /** Override */
+  virtual bool requiresColourRendering() const;
+
+  /** Override */
+  virtual bool requiresDepthReliability() const;
+
+  /** Override */
+  virtual bool requiresPointCloudRendering() const;
+
+  /** Override */
+  virtual void TrackCamera(ITMLib::ITMTrackingState *trackingState, const ITMLib::ITMView *view);
+
+  /** Override */
+  virtual void UpdateInitialPose(ITMLib::ITMTrackingState *trackingState);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Copies the specified image into another image of the same type, using memory of the type on which the composite's images are stored.
+   *
+   * \param source  The image to copy.
+   * \param target  The image into which to copy it.
+   */
+  template <typename T>
+  void copy_image(const ORUtils::Image<T> *source, ORUtils::Image<T> *target) const;
+
+  /**
+   * \brief Copies the specified point cloud into the composite's own copy of the point cloud (if any of the nested trackers needs it).
+   *
+   * \param pointCloud The point cloud to copy.
+   */
+  void copy_point_cloud(const ITMLib::ITMPointCloud *pointCloud);
+
+  /**
+   * \brief Copies the pose and tracking result from the specified tracking state into a nested tracker's own copy of the tracking state.
+   *
+   * \param source          The tracking state to copy.
+   * \param nestedTracker   The nested tracker.
+   */
+  void copy_tracking_state(const ITMLib::ITMTrackingState *source, NestedTracker& nestedTracker) const;
+
+  /**
+   * \brief Copies the specified view into the composite's own copy of the view.
+   *
+   * \param view  The view to copy.
+   */
+  void copy_view(const ITMLib::ITMView *view);
+
+  /**
+   * \brief Runs the worker thread for the specified nested tracker.
+   *
+   * The worker thread repeatedly waits for a frame to be ready and then tracks it, until the composite is destroyed.
+   *
+   * \param i The index of the nested tracker.
+   */
+  void run_worker(size_t i);
+
+  /**
+   * \brief Attempts to select the nested tracker whose result should be adopted for the current frame.
+   *
+   * \note  This must be called with the synchronisation mutex held.
+   *
+   * \param adoptedTracker  A location into which to store the index of the nested tracker whose result should be adopted (if any).
+   * \return                true, if a decision has been made, or false if it depends on nested trackers that are still running.
+   * \throws ...  The exception (with its original type) thrown by a higher-priority nested tracker that has finished, if any.
+   */
+  bool try_select_result(boost::optional<size_t>& adoptedTracker) const;
+
+  /**
+   * \brief Waits for all of the nested trackers to finish tracking the frame (if any) that they are currently tracking.
+   *
+   * \param lock  A lock on the synchronisation mutex.
+   */
+  void wait_for_trackers(boost::unique_lock<boost::mutex>& lock);
+};
+
+}
+
+#endif
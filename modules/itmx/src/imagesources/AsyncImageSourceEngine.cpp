@@ -14,6 +14,8 @@ namespace itmx {
 AsyncImageSourceEngine::AsyncImageSourceEngine(ImageSourceEngine *innerSource, size_t queueCapacity)
 : m_grabberShouldTerminate(false),
   m_innerSource(innerSource),
+  m_innerSourceFinished(false),
+  m_pool(new RGBDImagePool),
   m_queueCapacity(queueCapacity > 0 ? queueCapacity : std::numeric_limits<size_t>::max())
 {
   if(!innerSource)
@@ -23,18 +25,18 @@ AsyncImageSourceEngine::AsyncImageSourceEngine(ImageSourceEngine *innerSource, s
 
   // Determine the maximum number of RGB-D images to store in the pool.
   const size_t MAX_POOL_CAPACITY = 60;
-  m_poolCapacity = std::min(m_queueCapacity, MAX_POOL_CAPACITY);
+  m_pool->capacity = std::min(m_queueCapacity, MAX_POOL_CAPACITY);
 
   // If the inner source has images available, fill the pool to avoid allocating memory at runtime.
   // If the inner source doesn't have any images available, there is no need to allocate.
   if(m_innerSource->hasMoreImages())
   {
-    for(size_t i = 0; i < m_poolCapacity; ++i)
+    for(size_t i = 0; i < m_pool->capacity; ++i)
     {
       RGBDImage rgbdImage;
       rgbdImage.rawDepth.reset(new ORShortImage(m_innerSource->getDepthImageSize(), true, false));
       rgbdImage.rgb.reset(new ORUChar4Image(m_innerSource->getRGBImageSize(), true, false));
-      m_pool.push(rgbdImage);
+      m_pool->images.push(rgbdImage);
     }
   }
 
@@ -46,8 +48,12 @@ AsyncImageSourceEngine::AsyncImageSourceEngine(ImageSourceEngine *innerSource, s
 
 AsyncImageSourceEngine::~AsyncImageSourceEngine()
 {
-  // Set the flag that informs the image grabber that it should terminate.
-  m_grabberShouldTerminate = true;
+  // Set the flag that informs the image grabber that it should terminate. Note that we must hold the
+  // mutex when doing this, or the image grabber could miss the notification if it was about to wait.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_grabberShouldTerminate = true;
+  }
 
   // Wake the image grabber (it might be waiting on a full queue).
   m_queueNotFull.notify_one();
@@ -58,12 +64,34 @@ AsyncImageSourceEngine::~AsyncImageSourceEngine()
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
+AsyncImageSourceEngine::RGBDImage_CPtr AsyncImageSourceEngine::borrow_images()
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+
+  // If there are no more images available, early out.
+  if(m_queue.empty())
+  {
+    throw std::runtime_error("Error: No more images to get. Make sure to call hasMoreImages before calling borrow_images.");
+  }
+
+  // Otherwise, remove the first RGB-D image from the queue and inform the image grabber that the queue is not full.
+  RGBDImage *rgbdImage = new RGBDImage(m_queue.front());
+  m_queue.pop();
+  m_queueNotFull.notify_one();
+
+  // Hand the RGB-D image to the caller, arranging for it to be returned to the pool when the caller releases it.
+  return RGBDImage_CPtr(rgbdImage, boost::bind(&AsyncImageSourceEngine::return_to_pool, m_pool, _1));
+}
+
 ITMLib::ITMRGBDCalib AsyncImageSourceEngine::getCalib() const
 {
   boost::unique_lock<boost::mutex> lock(m_mutex);
 
   // If there are images in the queue, return the first image's calibration; if not, defer to the inner source.
-  return !m_queue.empty() ? m_queue.front().calib : m_innerSource->getCalib();
+  if(!m_queue.empty()) return m_queue.front().calib;
+
+  boost::lock_guard<boost::mutex> innerLock(m_innerSourceMutex);
+  return m_innerSource->getCalib();
 }
 
 Vector2i AsyncImageSourceEngine::getDepthImageSize() const
@@ -71,36 +99,24 @@ Vector2i AsyncImageSourceEngine::getDepthImageSize() const
   boost::unique_lock<boost::mutex> lock(m_mutex);
 
   // If there are images in the queue, return the first image's depth size; if not, defer to the inner source.
-  return !m_queue.empty() ? m_queue.front().rawDepth->noDims : m_innerSource->getDepthImageSize();
+  if(!m_queue.empty()) return m_queue.front().rawDepth->noDims;
+
+  boost::lock_guard<boost::mutex> innerLock(m_innerSourceMutex);
+  return m_innerSource->getDepthImageSize();
 }
 
 void AsyncImageSourceEngine::getImages(ORUChar4Image *rgb, ORShortImage *rawDepth)
 {
-  boost::unique_lock<boost::mutex> lock(m_mutex);
-
-  // If there are no more images available, early out.
-  if(m_queue.empty())
-  {
-    throw std::runtime_error("Error: No more images to get. Make sure to call hasMoreImages before calling getImages.");
-  }
-
-  // Otherwise, get the first RGB-D image from the queue.
-  RGBDImage& rgbdImage = m_queue.front();
+  // Borrow the first RGB-D image from the queue (it will be returned to the pool when we release it at the end of this function).
+  RGBDImage_CPtr rgbdImage = borrow_images();
 
   // Ensure that the output images have the correct size (this is generally a no-op).
-  rawDepth->ChangeDims(rgbdImage.rawDepth->noDims);
-  rgb->ChangeDims(rgbdImage.rgb->noDims);
-
-  // Copy the depth and RGB images from the queued image into the output images.
-  rawDepth->SetFrom(rgbdImage.rawDepth.get(), ORShortImage::CPU_TO_CPU);
-  rgb->SetFrom(rgbdImage.rgb.get(), ORUChar4Image::CPU_TO_CPU);
+  rawDepth->ChangeDims(rgbdImage->rawDepth->noDims);
+  rgb->ChangeDims(rgbdImage->rgb->noDims);
 
-  // If there is space available in the RGB-D image pool, store the RGB-D image to avoid reallocating memory later.
-  if(m_pool.size() < m_poolCapacity) m_pool.push(rgbdImage);
-
-  // Remove the RGB-D image from the queue and inform the image grabber that the queue is not full.
-  m_queue.pop();
-  m_queueNotFull.notify_one();
+  // Copy the depth and RGB images from the borrowed image into the output images.
+  rawDepth->SetFrom(rgbdImage->rawDepth.get(), ORShortImage::CPU_TO_CPU);
+  rgb->SetFrom(rgbdImage->rgb.get(), ORUChar4Image::CPU_TO_CPU);
 }
 
 Vector2i AsyncImageSourceEngine::getRGBImageSize() const
@@ -108,7 +124,10 @@ Vector2i AsyncImageSourceEngine::getRGBImageSize() const
   boost::unique_lock<boost::mutex> lock(m_mutex);
 
   // If there are images in the queue, return the first image's RGB size; if not, defer to the inner source.
-  return !m_queue.empty() ? m_queue.front().rgb->noDims : m_innerSource->getRGBImageSize();
+  if(!m_queue.empty()) return m_queue.front().rgb->noDims;
+
+  boost::lock_guard<boost::mutex> innerLock(m_innerSourceMutex);
+  return m_innerSource->getRGBImageSize();
 }
 
 bool AsyncImageSourceEngine::hasMoreImages() const
@@ -116,8 +135,8 @@ bool AsyncImageSourceEngine::hasMoreImages() const
   // We need to grab the mutex in case the queue is empty, in which case we need to wait to see if an image becomes available.
   boost::unique_lock<boost::mutex> lock(m_mutex);
 
-  // If the inner source has more images, wait for one to be added to the queue by the image grabber.
-  while(m_innerSource->hasMoreImages() && m_queue.empty()) m_queueNotEmpty.wait(lock);
+  // If the inner source may have more images, wait for one to be added to the queue by the image grabber.
+  while(!m_innerSourceFinished && m_queue.empty()) m_queueNotEmpty.wait(lock);
 
   // At this point, either there is now an image in the queue, in which case we return true,
   // or the inner source has terminated, in which case we return false.
@@ -128,53 +147,84 @@ bool AsyncImageSourceEngine::hasMoreImages() const
 
 void AsyncImageSourceEngine::run_image_grabber()
 {
-  while(!m_grabberShouldTerminate)
+  for(;;)
   {
-    boost::unique_lock<boost::mutex> lock(m_mutex);
-
     // If the queue is full, wait until some images have been consumed or termination is requested.
-    while(!m_grabberShouldTerminate && m_queue.size() >= m_queueCapacity) m_queueNotFull.wait(lock);
-
-    // If we were asked to terminate, do so.
-    if(m_grabberShouldTerminate) return;
-
-    // If there are no more images available from the inner source, notify anyone waiting for an image and terminate.
-    if(!m_innerSource->hasMoreImages())
     {
-      m_queueNotEmpty.notify_one();
-      return;
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(!m_grabberShouldTerminate && m_queue.size() >= m_queueCapacity) m_queueNotFull.wait(lock);
+
+      // If we were asked to terminate, do so.
+      if(m_grabberShouldTerminate) return;
     }
 
-    // Construct an RGB-D image into which to copy the data from the inner source.
+    // Read the next RGB-D image from the inner source. Note that we do this without holding the main mutex,
+    // so that the consumer can carry on taking images from the queue whilst the inner source is being read.
     RGBDImage rgbdImage;
-    if(!m_pool.empty())
     {
-      // If possible, reuse an existing RGB-D image from the pool rather than allocating new memory.
-      rgbdImage = m_pool.front();
-      m_pool.pop();
+      boost::lock_guard<boost::mutex> innerLock(m_innerSourceMutex);
+
+      // If there are no more images available from the inner source, stop reading from it.
+      if(!m_innerSource->hasMoreImages()) break;
 
-      // Ensure that the depth and RGB images have the correct size (this is a no-op unless the size of
-      // the images produced by the inner source has changed since we put the RGB-D image in the pool).
-      rgbdImage.rawDepth->ChangeDims(m_innerSource->getDepthImageSize());
-      rgbdImage.rgb->ChangeDims(m_innerSource->getRGBImageSize());
+      // If possible, reuse an existing RGB-D image from the pool rather than allocating new memory.
+      {
+        boost::lock_guard<boost::mutex> poolLock(m_pool->mutex);
+        if(!m_pool->images.empty())
+        {
+          rgbdImage = m_pool->images.front();
+          m_pool->images.pop();
+        }
+      }
+
+      if(rgbdImage.rgb)
+      {
+        // Ensure that the depth and RGB images have the correct size (this is a no-op unless the size of
+        // the images produced by the inner source has changed since we put the RGB-D image in the pool).
+        rgbdImage.rawDepth->ChangeDims(m_innerSource->getDepthImageSize());
+        rgbdImage.rgb->ChangeDims(m_innerSource->getRGBImageSize());
+      }
+      else
+      {
+        // If there was no existing image available from the pool, allocate new memory for the RGB-D image.
+        rgbdImage.rawDepth.reset(new ORShortImage(m_innerSource->getDepthImageSize(), true, false));
+        rgbdImage.rgb.reset(new ORUChar4Image(m_innerSource->getRGBImageSize(), true, false));
+      }
+
+      // Get the calibration for the RGB-D image from the inner source.
+      rgbdImage.calib = m_innerSource->getCalib();
+
+      // Copy the images from the inner source into the RGB-D image.
+      m_innerSource->getImages(rgbdImage.rgb.get(), rgbdImage.rawDepth.get());
     }
-    else
+
+    // Add the RGB-D image to the queue and inform the main thread that images are available.
     {
-      // If there was no existing image available from the pool, allocate new memory for the RGB-D image.
-      rgbdImage.rawDepth.reset(new ORShortImage(m_innerSource->getDepthImageSize(), true, false));
-      rgbdImage.rgb.reset(new ORUChar4Image(m_innerSource->getRGBImageSize(), true, false));
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      m_queue.push(rgbdImage);
     }
+    m_queueNotEmpty.notify_one();
+  }
 
-    // Get the calibration for the RGB-D image from the inner source.
-    rgbdImage.calib = m_innerSource->getCalib();
+  // If we get here, there are no more images available from the inner source, so notify anyone waiting for an image and terminate.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_innerSourceFinished = true;
+  }
+  m_queueNotEmpty.notify_all();
+}
 
-    // Copy the images from the inner source into the RGB-D image.
-    m_innerSource->getImages(rgbdImage.rgb.get(), rgbdImage.rawDepth.get());
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
 
-    // Add the RGB-D image to the queue and inform the main thread that images are available.
-    m_queue.push(rgbdImage);
-    m_queueNotEmpty.notify_one();
+void AsyncImageSourceEngine::return_to_pool(const RGBDImagePool_Ptr& pool, RGBDImage *rgbdImage)
+{
+  // If there is space available in the pool, store the RGB-D image to avoid reallocating memory later.
+  {
+    boost::lock_guard<boost::mutex> lock(pool->mutex);
+    if(pool->images.size() < pool->capacity) pool->images.push(*rgbdImage);
   }
+
+  delete rgbdImage;
 }
 
 }
@@ -5,6 +5,8 @@
 
 #include "imagesources/DepthCorruptingImageSourceEngine.h"
 
+#include <algorithm>
+
 #include <ITMLib/Engines/ViewBuilding/Shared/ITMViewBuilder_Shared.h>
 using namespace ITMLib;
 
@@ -13,7 +15,7 @@ namespace itmx {
 //#################### CONSTRUCTORS ####################
 
 DepthCorruptingImageSourceEngine::DepthCorruptingImageSourceEngine(ImageSourceEngine *innerSource, double missingDepthFraction, float depthNoiseSigma)
-: m_depthNoiseSigma(depthNoiseSigma), m_innerSource(innerSource), m_rng(12345)
+: m_depthNoiseSigma(depthNoiseSigma), m_frameIndex(0), m_innerSource(innerSource), m_noiseRng(12345), m_rng(12345)
 {
   if(missingDepthFraction > 0.0)
   {
@@ -45,18 +47,29 @@ void DepthCorruptingImageSourceEngine::getImages(ORUChar4Image *rgb, ORShortImag
   // Get the uncorrupted images.
   m_innerSource->getImages(rgb, rawDepth);
 
+  short *rawDepthData = rawDepth->GetData(MEMORYDEVICE_CPU);
+  const bool *missingDepthMask = m_missingDepthMask ? m_missingDepthMask->GetData(MEMORYDEVICE_CPU) : NULL;
+  const int pixelCount = static_cast<int>(rawDepth->dataSize);
+  const boost::uint64_t frameIndex = m_frameIndex++;
+
+  // Note: The noise is generated by a counter-based generator keyed by the frame index and the index of a block of four pixels,
+  //       each call to which yields the noise for a whole block. This allows the blocks to be corrupted in parallel without any
+  //       synchronisation, and makes the corrupted depths independent of the number of threads used.
+  const int blockCount = (pixelCount + 3) / 4;
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
-  for(int y = 0; y < rawDepth->noDims.y; ++y)
+  for(int block = 0; block < blockCount; ++block)
   {
-    for(int x = 0; x < rawDepth->noDims.x; ++x)
+    float noise[4];
+    bool noiseGenerated = false;
+
+    for(int offset = block * 4, end = std::min(offset + 4, pixelCount); offset < end; ++offset)
     {
-      const int offset = y * rawDepth->noDims.x + x;
-      short& rawDepthValue = rawDepth->GetData(MEMORYDEVICE_CPU)[offset];
+      short& rawDepthValue = rawDepthData[offset];
 
       // If desired, zero out any depth values that should be missing.
-      if(m_missingDepthMask && m_missingDepthMask->GetData(MEMORYDEVICE_CPU)[offset])
+      if(missingDepthMask && missingDepthMask[offset])
       {
         rawDepthValue = 0;
       }
@@ -67,10 +80,13 @@ void DepthCorruptingImageSourceEngine::getImages(ORUChar4Image *rgb, ORShortImag
         float depth = 0.0f;
         convertDepthAffineToFloat(&depth, 0, 0, &rawDepthValue, rawDepth->noDims, depthCalibParams);
 
-      #ifdef WITH_OPENMP
-        #pragma omp critical
-      #endif
-        depth += m_rng.generate_from_gaussian(0.0f, m_depthNoiseSigma) * depth;
+        if(!noiseGenerated)
+        {
+          m_noiseRng.generate_from_gaussian(frameIndex, block, 0.0f, m_depthNoiseSigma, noise);
+          noiseGenerated = true;
+        }
+
+        depth += noise[offset - block * 4] * depth;
 
         rawDepthValue = CLAMP(static_cast<short>(ROUND((depth - depthCalibParams.y) / depthCalibParams.x)), 1, 32000);
       }
@@ -0,0 +1,182 @@
+/**
+ * itmx: SensorClockImageSourceEngine.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "imagesources/SensorClockImageSourceEngine.h"
+using namespace tvgutil;
+
+#include <stdexcept>
+
+#include <boost/thread/thread.hpp>
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+SensorClockImageSourceEngine::SensorClockImageSourceEngine(AsyncImageSourceEngine *innerSource, double frameRate, size_t queueCapacity,
+                                                           const LatencyRecorder_Ptr& latencyRecorder, const std::string& name)
+: m_captureDuration(Clock::duration::zero()),
+  m_capturedFrameCount(0),
+  m_idleDuration(Clock::duration::zero()),
+  m_innerSource(innerSource),
+  m_latencyRecorder(latencyRecorder),
+  m_name(name),
+  m_queueCapacity(queueCapacity)
+{
+  if(!innerSource)
+  {
+    throw std::runtime_error("Error: Cannot initialise a SensorClockImageSourceEngine with a NULL AsyncImageSourceEngine.");
+  }
+
+  if(frameRate <= 0.0)
+  {
+    throw std::runtime_error("Error: The frame rate of a SensorClockImageSourceEngine must be positive.");
+  }
+
+  m_framePeriod = boost::chrono::duration_cast<Clock::duration>(boost::chrono::duration<double>(1.0 / frameRate));
+
+  // Make sure that all of the counters appear in the latency report, even if nothing is ever added to them.
+  add_to_counter("Captured Frames", 0);
+  add_to_counter("Deadline Misses", 0);
+  add_to_counter("Dropped Frames", 0);
+  add_to_counter("Processed Frames", 0);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+SensorClockImageSourceEngine::RGBDImage_CPtr SensorClockImageSourceEngine::borrow_images()
+{
+  // Note: Normally, the consumer will already have called hasImagesNow, in which case these are no-ops.
+  finish_current_frame(Clock::now());
+  if(!wait_for_frame())
+  {
+    throw std::runtime_error("Error: No more images to get. Make sure to call hasImagesNow before calling borrow_images.");
+  }
+
+  // Remove the first captured frame from the queue and hand its RGB-D image to the consumer.
+  CapturedFrame frame = m_queue.front();
+  m_queue.pop_front();
+
+  // Record how long the frame waited in the queue, and how long the consumer waited for it to become available.
+  record_latency("Queue Wait", Clock::now() - frame.captureTime);
+  record_latency("Capture", m_captureDuration);
+  record_latency("Idle", m_idleDuration);
+  add_to_counter("Processed Frames");
+
+  m_captureDuration = m_idleDuration = Clock::duration::zero();
+  m_currentCaptureTime = frame.captureTime;
+
+  return frame.rgbdImage;
+}
+
+ITMLib::ITMRGBDCalib SensorClockImageSourceEngine::getCalib() const
+{
+  // If there are frames in the queue, return the first frame's calibration; if not, defer to the inner source.
+  return !m_queue.empty() ? m_queue.front().rgbdImage->calib : m_innerSource->getCalib();
+}
+
+Vector2i SensorClockImageSourceEngine::getDepthImageSize() const
+{
+  // If there are frames in the queue, return the first frame's depth size; if not, defer to the inner source.
+  return !m_queue.empty() ? m_queue.front().rgbdImage->rawDepth->noDims : m_innerSource->getDepthImageSize();
+}
+
+void SensorClockImageSourceEngine::getImages(ORUChar4Image *rgb, ORShortImage *rawDepth)
+{
+  // Borrow the next captured RGB-D image (it will be returned to the inner source's pool when we release it at the end of this function).
+  RGBDImage_CPtr rgbdImage = borrow_images();
+
+  // Copy the depth and RGB images from the borrowed image into the output images.
+  rawDepth->ChangeDims(rgbdImage->rawDepth->noDims);
+  rgb->ChangeDims(rgbdImage->rgb->noDims);
+  rawDepth->SetFrom(rgbdImage->rawDepth.get(), ORShortImage::CPU_TO_CPU);
+  rgb->SetFrom(rgbdImage->rgb.get(), ORUChar4Image::CPU_TO_CPU);
+}
+
+Vector2i SensorClockImageSourceEngine::getRGBImageSize() const
+{
+  // If there are frames in the queue, return the first frame's RGB size; if not, defer to the inner source.
+  return !m_queue.empty() ? m_queue.front().rgbdImage->rgb->noDims : m_innerSource->getRGBImageSize();
+}
+
+bool SensorClockImageSourceEngine::hasImagesNow() const
+{
+  // The consumer has come back for another frame, so it has finished processing the previous one (if any).
+  finish_current_frame(Clock::now());
+  return wait_for_frame();
+}
+
+bool SensorClockImageSourceEngine::hasMoreImages() const
+{
+  return !m_queue.empty() || m_innerSource->hasMoreImages();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void SensorClockImageSourceEngine::add_to_counter(const char *counter, size_t amount) const
+{
+  if(m_latencyRecorder) m_latencyRecorder->add_to_counter(m_name + ": " + counter, amount);
+}
+
+void SensorClockImageSourceEngine::capture_frames(const Clock::time_point& now) const
+{
+  // Capture each frame whose capture time has passed, in order. Note that we check the capture time before asking the inner
+  // source whether it has more images, since the latter may need to wait for the next image to be read from disk.
+  while(*m_epoch + m_framePeriod * static_cast<Clock::rep>(m_capturedFrameCount) <= now && m_innerSource->hasMoreImages())
+  {
+    CapturedFrame frame;
+    frame.captureTime = *m_epoch + m_framePeriod * static_cast<Clock::rep>(m_capturedFrameCount);
+    frame.rgbdImage = m_innerSource->borrow_images();
+    ++m_capturedFrameCount;
+    add_to_counter("Captured Frames");
+
+    // If there is space in the queue, add the frame to it. If not, drop the frame (its RGB-D image is returned to the inner
+    // source when it goes out of scope). The frame captured next will be the first one to be queued once space is available.
+    if(m_queueCapacity == 0 || m_queue.size() < m_queueCapacity) m_queue.push_back(frame);
+    else add_to_counter("Dropped Frames");
+  }
+}
+
+void SensorClockImageSourceEngine::finish_current_frame(const Clock::time_point& now) const
+{
+  if(!m_currentCaptureTime) return;
+
+  record_latency("End-to-End", now - *m_currentCaptureTime);
+  if(now - *m_currentCaptureTime > m_framePeriod) add_to_counter("Deadline Misses");
+
+  m_currentCaptureTime.reset();
+}
+
+void SensorClockImageSourceEngine::record_latency(const char *stage, const Clock::duration& latency) const
+{
+  if(m_latencyRecorder) m_latencyRecorder->record_latency(m_name + ": " + stage, boost::chrono::duration<double,boost::milli>(latency).count());
+}
+
+bool SensorClockImageSourceEngine::wait_for_frame() const
+{
+  Clock::time_point t0 = Clock::now();
+
+  // If this is the first time the consumer has asked for a frame, start the simulated sensor.
+  if(!m_epoch) m_epoch = t0;
+
+  // Repeatedly capture any frames whose capture times have passed, until a frame is available or the sequence has finished.
+  // If no frame is available yet, sleep until the next frame is due to be captured. We keep track of how long the consumer
+  // spends waiting for the inner source to supply frames and how long it spends waiting for the simulated sensor separately.
+  for(;;)
+  {
+    capture_frames(t0);
+    const bool frameAvailable = !m_queue.empty();
+    const bool finished = !frameAvailable && !m_innerSource->hasMoreImages();
+
+    const Clock::time_point t1 = Clock::now();
+    m_captureDuration += t1 - t0;
+    if(frameAvailable || finished) return frameAvailable;
+
+    boost::this_thread::sleep_until(*m_epoch + m_framePeriod * static_cast<Clock::rep>(m_capturedFrameCount));
+    t0 = Clock::now();
+    m_idleDuration += t0 - t1;
+  }
+}
+
+}
@@ -5,8 +5,12 @@
 
 #include "remotemapping/MappingClient.h"
 
+#include <iostream>
 #include <stdexcept>
 
+#include <boost/chrono.hpp>
+#include <boost/optional.hpp>
+
 #include <tvgutil/boost/WrappedAsio.h>
 #include <tvgutil/net/AckMessage.h>
 using boost::asio::ip::tcp;
@@ -19,10 +23,22 @@ namespace itmx {
 
 //#################### CONSTRUCTORS ####################
 
+MappingClient::Statistics::Statistics()
+: bytesReceived(0), bytesSent(0), framesDroppedByServer(0), framesSent(0), framesSkipped(0), renderingResponsesReceived(0)
+{}
+
 MappingClient::MappingClient(const std::string& host, const std::string& port, pooled_queue::PoolEmptyStrategy poolEmptyStrategy)
-: m_frameMessageQueue(poolEmptyStrategy), m_stream(host, port)
+: m_frameMessageQueue(poolEmptyStrategy),
+  m_rateControlEnabled(true),
+  m_renderingResponseMessage(m_renderingResponseHeaderMessage),
+  m_stream(host, port)
 {
   if(!m_stream) throw std::runtime_error("Error: Could not connect to server");
+
+  // Disable Nagle's algorithm on the connection. Our interactions with the server consist of short messages that wait
+  // for replies, so holding them back to coalesce them into larger packets would just add to the latency of each one.
+  boost::system::error_code err;
+  m_stream.rdbuf()->set_option(tcp::no_delay(true), err);
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
@@ -39,40 +55,63 @@ ORUChar4Image_CPtr MappingClient::get_remote_image() const
 
   boost::lock_guard<boost::mutex> lock(m_interactionMutex);
 
-  // Ask the server whether it has ever rendered an RGB-D image for this client.
-  if(m_stream.write(interactionTypeMsg.get_data_ptr(), interactionTypeMsg.get_size()))
+  // Unless we have already received an image from the server (in which case it will always have one for us),
+  // ask the server whether it has ever rendered an RGB-D image for this client.
+  bool serverHasImage = m_remoteImage.get() != NULL;
+  if(!serverHasImage && m_stream.write(interactionTypeMsg.get_data_ptr(), interactionTypeMsg.get_size()))
   {
     SimpleMessage<bool> flag;
-    if(m_stream.read(flag.get_data_ptr(), flag.get_size()) && m_stream.write(ackMsg.get_data_ptr(), ackMsg.get_size()) && flag.extract_value())
+    serverHasImage = m_stream.read(flag.get_data_ptr(), flag.get_size()) && m_stream.write(ackMsg.get_data_ptr(), ackMsg.get_size()) && flag.extract_value();
+  }
+
+  if(serverHasImage)
+  {
+    // If it has, ask it to send across the RGB-D image it has rendered for this client.
+    interactionTypeMsg.set_value(IT_GETRENDEREDIMAGE);
+    if(m_stream.write(interactionTypeMsg.get_data_ptr(), interactionTypeMsg.get_size()))
     {
-      // If it has, ask it to send across the RGB-D image it has rendered for this client.
-      interactionTypeMsg.set_value(IT_GETRENDEREDIMAGE);
-      if(m_stream.write(interactionTypeMsg.get_data_ptr(), interactionTypeMsg.get_size()))
+      // Read the rendering response it sends across. If the image has not changed since the last one we received,
+      // the response consists only of a header; otherwise, the header is followed by the tiles that have changed.
+      if(m_stream.read(m_renderingResponseHeaderMessage.get_data_ptr(), m_renderingResponseHeaderMessage.get_size()))
       {
-        // Read the compressed RGB-D frame it sends across.
-        CompressedRGBDFrameHeaderMessage headerMsg;
-        if(m_stream.read(headerMsg.get_data_ptr(), headerMsg.get_size()))
+        m_renderingResponseMessage.set_segment_sizes(m_renderingResponseHeaderMessage);
+        const bool modified = m_renderingResponseHeaderMessage.extract_tile_count() > 0;
+        if(!modified || m_stream.read(m_renderingResponseMessage.get_data_ptr(), m_renderingResponseMessage.get_size()))
         {
-          CompressedRGBDFrameMessage frameMsg(headerMsg);
-          if(m_stream.read(frameMsg.get_data_ptr(), frameMsg.get_size()))
+          // Apply the response to the remote image for this client (updating it in place). The server will make the image
+          // from which it compressed the response the reference image for subsequent responses once we acknowledge it, so
+          // we only send a (positive) acknowledgement once the response has been successfully applied. If it could not be
+          // applied, we send a negative acknowledgement instead (a non-zero value), so that the server knows to send all of
+          // the tiles next time, and discard our copy of the image.
+          bool applied = true;
+          try
+          {
+            if(!m_remoteImage) m_remoteImage.reset(new ORUChar4Image(m_renderingResponseHeaderMessage.extract_image_size(), true, false));
+            m_renderingResponseCompressor->uncompress_rendering_response(m_renderingResponseHeaderMessage, m_renderingResponseMessage, m_remoteImage.get());
+          }
+          catch(std::exception& e)
+          {
+            std::cerr << "Warning: Could not apply a rendering response from the server: " << e.what() << '\n';
+            ackMsg.set_value(1);
+            applied = false;
+          }
+
+          m_stream.write(ackMsg.get_data_ptr(), ackMsg.get_size());
+
+          if(!applied)
           {
-            // Send an acknowledgement that we've received the frame.
-            m_stream.write(ackMsg.get_data_ptr(), ackMsg.get_size());
-
-            // Uncompress the frame.
-            // FIXME: Avoid creating a new uncompressed frame every time.
-            const Vector2i rgbImageSize = headerMsg.extract_rgb_image_size();
-            const Vector2i depthImageSize = headerMsg.extract_depth_image_size();
-            RGBDFrameMessage uncompressedFrameMsg(rgbImageSize, depthImageSize);
-            m_frameCompressor->uncompress_rgbd_frame(frameMsg, uncompressedFrameMsg);
-
-            // Extract the colour image from the frame and use it to update the remote image for this client.
-            if(!m_remoteImage) m_remoteImage.reset(new ORUChar4Image(rgbImageSize, true, false));
-            m_remoteImage->ChangeDims(rgbImageSize);
-            uncompressedFrameMsg.extract_rgb_image(m_remoteImage.get());
-
-            return m_remoteImage;
+            m_remoteImage.reset();
+            return ORUChar4Image_CPtr();
           }
+
+          // Update the statistics.
+          {
+            boost::lock_guard<boost::mutex> statisticsLock(m_statisticsMutex);
+            m_statistics.bytesReceived += m_renderingResponseHeaderMessage.get_size() + (modified ? m_renderingResponseMessage.get_size() : 0);
+            ++m_statistics.renderingResponsesReceived;
+          }
+
+          return m_remoteImage;
         }
       }
     }
@@ -82,6 +121,12 @@ ORUChar4Image_CPtr MappingClient::get_remote_image() const
   return ORUChar4Image_CPtr();
 }
 
+MappingClient::Statistics MappingClient::get_statistics() const
+{
+  boost::lock_guard<boost::mutex> lock(m_statisticsMutex);
+  return m_statistics;
+}
+
 void MappingClient::send_calibration_message(const RGBDCalibrationMessage& msg)
 {
   bool connectionOk = true;
@@ -106,10 +151,18 @@ void MappingClient::send_calibration_message(const RGBDCalibrationMessage& msg)
   // Set up the RGB-D frame compressor.
   m_frameCompressor.reset(new RGBDFrameCompressor(rgbImageSize, depthImageSize, msg.extract_rgb_compression_type(), msg.extract_depth_compression_type()));
 
+  // Set up the compressor used to apply the rendering responses received from the server (this must match the one used by the server).
+  m_renderingResponseCompressor.reset(new RenderingResponseCompressor(msg.extract_rgb_compression_type()));
+
   // Start the message sender thread.
   boost::thread messageSender(&MappingClient::run_message_sender, this);
 }
 
+void MappingClient::set_rate_control_enabled(bool rateControlEnabled)
+{
+  m_rateControlEnabled = rateControlEnabled;
+}
+
 void MappingClient::update_rendering_request(const Vector2i& imgSize, const ORUtils::SE3Pose& pose, int visualisationType)
 {
   AckMessage ackMsg;
@@ -134,10 +187,13 @@ void MappingClient::update_rendering_request(const Vector2i& imgSize, const ORUt
 
 void MappingClient::run_message_sender()
 {
-  AckMessage ackMsg;
+  typedef boost::chrono::steady_clock Clock;
+
   CompressedRGBDFrameHeaderMessage headerMsg;
   CompressedRGBDFrameMessage frameMsg(headerMsg);
   InteractionTypeMessage interactionTypeMsg(IT_SENDFRAME);
+  boost::optional<Clock::time_point> lastSendTime;
+  MappingStatusMessage statusMsg;
 
   bool connectionOk = true;
 
@@ -146,26 +202,59 @@ void MappingClient::run_message_sender()
     // Read the first frame message from the queue (this will block until a message is available).
     RGBDFrameMessage_Ptr msg = m_frameMessageQueue.peek();
 
+    // If rate control is enabled and the server is currently unable to keep up with the frames we are sending, skip any frame
+    // that arrives too soon after the last one we sent. Doing this before compressing the frame avoids wasting time compressing
+    // and sending a frame that the server would only have dropped anyway.
+    if(m_rateControlEnabled && lastSendTime)
+    {
+      const double timeSinceLastSend = boost::chrono::duration<double>(Clock::now() - *lastSendTime).count();
+      if(timeSinceLastSend < m_rateController.get_min_send_interval())
+      {
+        m_frameMessageQueue.pop();
+
+        boost::lock_guard<boost::mutex> lock(m_statisticsMutex);
+        ++m_statistics.framesSkipped;
+        continue;
+      }
+    }
+
     // Compress the frame. The compressed frame is split into two messages - a header message,
     // which tells the server how large a frame to expect, and a separate message containing
     // the actual frame data.
+    if(m_rateControlEnabled) m_frameCompressor->set_rgb_jpeg_quality(m_rateController.get_jpeg_quality());
     m_frameCompressor->compress_rgbd_frame(*msg, headerMsg, frameMsg);
 
+    const Clock::time_point sendTime = Clock::now();
+
     {
       boost::lock_guard<boost::mutex> lock(m_interactionMutex);
 
       // First send the interaction type message, then send the frame header message, then send
-      // the frame message itself, then wait for an acknowledgement from the server. We chain
-      // all of these with && so as to early out in case of failure.
+      // the frame message itself, then wait for the server to send back a status message in
+      // acknowledgement. We chain all of these with && so as to early out in case of failure.
       connectionOk = connectionOk
         && m_stream.write(interactionTypeMsg.get_data_ptr(), interactionTypeMsg.get_size())
         && m_stream.write(headerMsg.get_data_ptr(), headerMsg.get_size())
         && m_stream.write(frameMsg.get_data_ptr(), frameMsg.get_size())
-        && m_stream.read(ackMsg.get_data_ptr(), ackMsg.get_size());
+        && m_stream.read(statusMsg.get_data_ptr(), statusMsg.get_size());
     }
 
     // Remove the frame message that we have just sent from the queue.
     m_frameMessageQueue.pop();
+
+    if(connectionOk)
+    {
+      // Update the rate controller based on the status of the server.
+      const double transferTime = boost::chrono::duration<double>(Clock::now() - sendTime).count();
+      m_rateController.update(statusMsg, transferTime);
+      lastSendTime = sendTime;
+
+      // Update the statistics.
+      boost::lock_guard<boost::mutex> lock(m_statisticsMutex);
+      m_statistics.bytesSent += interactionTypeMsg.get_size() + headerMsg.get_size() + frameMsg.get_size();
+      m_statistics.framesDroppedByServer = statusMsg.extract_dropped_frame_count();
+      ++m_statistics.framesSent;
+    }
   }
 }
 
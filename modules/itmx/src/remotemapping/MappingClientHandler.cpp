@@ -13,6 +13,7 @@ using namespace tvgutil;
 #endif
 
 #include "remotemapping/InteractionTypeMessage.h"
+#include "remotemapping/MappingStatusMessage.h"
 #include "remotemapping/RenderingRequestMessage.h"
 #include "remotemapping/RGBDCalibrationMessage.h"
 
@@ -25,11 +26,15 @@ namespace itmx {
 MappingClientHandler::MappingClientHandler(int clientID, const boost::shared_ptr<boost::asio::ip::tcp::socket>& sock,
                                            const boost::shared_ptr<const boost::atomic<bool> >& shouldTerminate)
 : ClientHandler(clientID, sock, shouldTerminate),
+  m_droppedFrameCount(0),
   m_frameMessageQueue(new RGBDFrameMessageQueue(tvgutil::pooled_queue::PES_DISCARD)),
+  m_frameMessageQueueCapacity(0),
   m_imagesDirty(false),
-  m_poseDirty(false)
+  m_poseDirty(false),
+  m_processingInterval(0.0)
 {
   m_frameMessage.reset(new CompressedRGBDFrameMessage(m_headerMessage));
+  m_renderingResponseMessage.reset(new RenderingResponseMessage(m_renderingResponseHeaderMessage));
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
@@ -79,6 +84,23 @@ bool MappingClientHandler::pose_dirty() const
   return m_poseDirty;
 }
 
+void MappingClientHandler::pop_frame_message()
+{
+  m_frameMessageQueue->pop();
+  m_imagesDirty = false;
+  m_poseDirty = false;
+
+  // Update the running average of the interval between successive pops, which tells us how quickly the server is processing frames.
+  const boost::chrono::steady_clock::time_point now = boost::chrono::steady_clock::now();
+  if(m_lastPopTime)
+  {
+    const double interval = boost::chrono::duration<double>(now - *m_lastPopTime).count();
+    boost::lock_guard<boost::mutex> lock(m_processingIntervalMutex);
+    m_processingInterval = m_processingInterval > 0.0 ? 0.9 * m_processingInterval + 0.1 * interval : interval;
+  }
+  m_lastPopTime = now;
+}
+
 void MappingClientHandler::run_iter()
 {
   InteractionTypeMessage interactionTypeMsg;
@@ -96,32 +118,35 @@ void MappingClientHandler::run_iter()
         std::cout << "Receiving get rendered image request from client" << std::endl;
 #endif
 
-        // Try to grab the rendered image to send across to the client, locking the associated mutex for the duration of the process.
-        // If no image has been rendered for the client, early out.
-        ExclusiveHandle_Ptr<ORUChar4Image_Ptr>::Type imageHandle = get_rendered_image();
-        if(!imageHandle->get())
+        // Try to grab the rendered image to send across to the client. If no image has been rendered for the client, early out.
         {
-          std::cerr << "Warning: Client " << m_clientID << " attempted to read a non-existent server-rendered image and is probably deadlocked.\n";
-          m_connectionOk = false;
-          break;
-        }
+          ExclusiveHandle_Ptr<ORUChar4Image_Ptr>::Type imageHandle = get_rendered_image();
+          if(!imageHandle->get())
+          {
+            std::cerr << "Warning: Client " << m_clientID << " attempted to read a non-existent server-rendered image and is probably deadlocked.\n";
+            m_connectionOk = false;
+            break;
+          }
 
-        // Prepare the rendering response message (we reuse an uncompressed RGB-D frame for this to avoid creating a new message type).
-        if(!m_renderingResponseMessage || m_renderingResponseMessage->get_rgb_image_size() != imageHandle->get()->noDims)
-        {
-          m_renderingResponseMessage.reset(new RGBDFrameMessage(imageHandle->get()->noDims, Vector2i(1,1)));
+          // Compress the rendering response for transmission over the network. Only the tiles of the image that have changed since
+          // the last image the client acknowledged are sent (if none of them has changed, the response is just a "not modified" header).
+          // Note that the compressor keeps its own copy of the image, so we only need to lock the image for the duration of this step,
+          // and the renderer can carry on rendering the next image for the client while the response is being sent.
+          m_renderingResponseCompressor->compress_rendering_response(imageHandle->get().get(), m_renderingResponseHeaderMessage, *m_renderingResponseMessage);
         }
 
-        m_renderingResponseMessage->set_frame_index(-1);
-        m_renderingResponseMessage->set_rgb_image(imageHandle->get());
-
-        // Compress the rendering response message for transmission over the network.
-        // FIXME: Consider using a separate frame compressor for rendering responses (to avoid continually resizing this one's internal images).
-        m_frameCompressor->compress_rgbd_frame(*m_renderingResponseMessage, m_headerMessage, *m_frameMessage);
-
-        // Send the rendering response to the client, and wait for an acknowledgement before proceeding.
+        // Send the rendering response to the client, and wait for an acknowledgement before proceeding. Once the client
+        // has acknowledged the response, we know that it has the new image, so subsequent responses can be relative to it.
+        // If the client instead reports that it could not apply the response (by sending a non-zero acknowledgement),
+        // we no longer know which image it has, so the next response must contain all of the tiles.
         AckMessage ackMsg;
-        m_connectionOk = m_connectionOk && write_message(m_headerMessage) && write_message(*m_frameMessage) && read_message(ackMsg);
+        const bool modified = m_renderingResponseHeaderMessage.extract_tile_count() > 0;
+        m_connectionOk = m_connectionOk && write_message(m_renderingResponseHeaderMessage) && (!modified || write_message(*m_renderingResponseMessage)) && read_message(ackMsg);
+        if(m_connectionOk)
+        {
+          if(ackMsg.extract_value() == 0) m_renderingResponseCompressor->acknowledge_rendering_response();
+          else m_renderingResponseCompressor->reject_rendering_response();
+        }
 
         break;
       }
@@ -155,9 +180,23 @@ void MappingClientHandler::run_iter()
             RGBDFrameMessageQueue::PushHandler_Ptr pushHandler = m_frameMessageQueue->begin_push();
             boost::optional<RGBDFrameMessage_Ptr&> elt = pushHandler->get();
             RGBDFrameMessage& msg = elt ? **elt : *m_dummyFrameMessage;
+            if(!elt) ++m_droppedFrameCount;
             m_frameCompressor->uncompress_rgbd_frame(*m_frameMessage, msg);
 
-            m_connectionOk = write_message(AckMessage());
+            // Rather than a plain acknowledgement, send the client a status message that tells it how well the server is
+            // keeping up with the frames it is sending, so that it can adapt its sending rate accordingly. Note that the
+            // queue size we report includes the frame we have just received (which is pushed when the handler is destroyed).
+            MappingStatusMessage statusMsg;
+            statusMsg.set_dropped_frame_count(m_droppedFrameCount);
+            statusMsg.set_queue_capacity(static_cast<uint32_t>(m_frameMessageQueueCapacity));
+            statusMsg.set_queue_size(static_cast<uint32_t>(m_frameMessageQueue->size() + (elt ? 1 : 0)));
+
+            {
+              boost::lock_guard<boost::mutex> lock(m_processingIntervalMutex);
+              statusMsg.set_processing_rate(m_processingInterval > 0.0 ? static_cast<float>(1.0 / m_processingInterval) : 0.0f);
+            }
+
+            m_connectionOk = write_message(statusMsg);
 
 #if DEBUGGING
             std::cout << "Got message: " << msg.extract_frame_index() << std::endl;
@@ -204,10 +243,15 @@ void MappingClientHandler::run_post()
 {
   // Destroy the frame compressor prior to stopping the client handler (this cleanly deallocates CUDA memory and avoids a crash on exit).
   m_frameCompressor.reset();
+  m_renderingResponseCompressor.reset();
 }
 
 void MappingClientHandler::run_pre()
 {
+  // Disable Nagle's algorithm on the connection, since (as on the client) holding back our short messages would just add latency.
+  boost::system::error_code err;
+  m_sock->set_option(boost::asio::ip::tcp::no_delay(true), err);
+
   // Read a calibration message from the client to get its camera's image sizes and calibration parameters.
   RGBDCalibrationMessage calibMsg;
   m_connectionOk = read_message(calibMsg);
@@ -222,14 +266,17 @@ void MappingClientHandler::run_pre()
     m_calib = calibMsg.extract_calib();
 
     // Initialise the frame message queue.
-    const size_t capacity = 5;
+    m_frameMessageQueueCapacity = 5;
     const Vector2i& rgbImageSize = get_rgb_image_size();
     const Vector2i& depthImageSize = get_depth_image_size();
-    m_frameMessageQueue->initialise(capacity, boost::bind(&RGBDFrameMessage::make, rgbImageSize, depthImageSize));
+    m_frameMessageQueue->initialise(m_frameMessageQueueCapacity, boost::bind(&RGBDFrameMessage::make, rgbImageSize, depthImageSize));
 
     // Set up the frame compressor.
     m_frameCompressor.reset(new RGBDFrameCompressor(rgbImageSize, depthImageSize, calibMsg.extract_rgb_compression_type(), calibMsg.extract_depth_compression_type()));
 
+    // Set up the compressor used to send server-rendered images back to the client.
+    m_renderingResponseCompressor.reset(new RenderingResponseCompressor(calibMsg.extract_rgb_compression_type()));
+
     // Construct a dummy frame message to consume messages that cannot be pushed onto the queue.
     m_dummyFrameMessage.reset(new RGBDFrameMessage(rgbImageSize, depthImageSize));
 
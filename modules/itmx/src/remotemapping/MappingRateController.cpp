@@ -0,0 +1,73 @@
+/**
+ * itmx: MappingRateController.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "remotemapping/MappingRateController.h"
+
+#include <algorithm>
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+MappingRateController::MappingRateController(double linkBudget, int minJpegQuality, int maxJpegQuality)
+: m_jpegQuality(maxJpegQuality),
+  m_lastDroppedFrameCount(0),
+  m_linkBudget(linkBudget),
+  m_maxJpegQuality(maxJpegQuality),
+  m_minJpegQuality(minJpegQuality),
+  m_minSendInterval(0.0)
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+int MappingRateController::get_jpeg_quality() const
+{
+  return m_jpegQuality;
+}
+
+double MappingRateController::get_min_send_interval() const
+{
+  return m_minSendInterval;
+}
+
+void MappingRateController::update(const MappingStatusMessage& status, double transferTime)
+{
+  const double maxSendInterval = 1.0;     // never send less than one frame a second
+  const double negligibleInterval = 1e-3; // intervals below this are treated as no throttling at all
+
+  const uint32_t droppedFrameCount = status.extract_dropped_frame_count();
+  const bool framesDropped = droppedFrameCount != m_lastDroppedFrameCount;
+  m_lastDroppedFrameCount = droppedFrameCount;
+
+  const uint32_t queueSize = status.extract_queue_size();
+  const float processingRate = status.extract_processing_rate();
+
+  if(framesDropped || queueSize * 2 > status.extract_queue_capacity())
+  {
+    // If the server has had to drop frames since the last update, or its queue is more than half full, it is not keeping up, so
+    // back off. We back off multiplicatively, but immediately slow down to the rate at which the server is processing frames.
+    const double processingInterval = processingRate > 0.0f ? 1.0 / processingRate : negligibleInterval;
+    m_minSendInterval = std::min(std::max(m_minSendInterval * 1.25, processingInterval), maxSendInterval);
+  }
+  else if(queueSize <= 1)
+  {
+    // If the server is keeping up, gradually reduce the interval to probe for spare capacity.
+    m_minSendInterval *= 0.9;
+    if(m_minSendInterval < negligibleInterval) m_minSendInterval = 0.0;
+  }
+
+  if(transferTime > m_linkBudget)
+  {
+    // If sending the frame took longer than the link budget, reduce the quality of the RGB compression to send fewer bytes.
+    m_jpegQuality = std::max(m_jpegQuality - 10, m_minJpegQuality);
+  }
+  else if(transferTime < m_linkBudget / 2)
+  {
+    // If sending the frame was comfortably within the link budget, gradually restore the quality of the RGB compression.
+    m_jpegQuality = std::min(m_jpegQuality + 5, m_maxJpegQuality);
+  }
+}
+
+}
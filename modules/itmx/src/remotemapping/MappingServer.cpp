@@ -44,12 +44,7 @@ void MappingServer::get_images(int clientID, ORUChar4Image *rgb, ORShortImage *r
 
   // If the images of the first message on the queue have already been read, it's time to
   // move on to the next frame, so pop the message from the queue and reset the flags.
-  if(clientHandler->images_dirty())
-  {
-    clientHandler->get_frame_message_queue()->pop();
-    clientHandler->set_images_dirty(false);
-    clientHandler->set_pose_dirty(false);
-  }
+  if(clientHandler->images_dirty()) clientHandler->pop_frame_message();
 
   // Extract the images from the first message on the queue. This will block until the queue
   // has a message from which to extract images.
@@ -75,12 +70,7 @@ void MappingServer::get_pose(int clientID, ORUtils::SE3Pose& pose)
 
   // If the pose of the first message on the queue has already been read, it's time to
   // move on to the next frame, so pop the message from the queue and reset the flags.
-  if(clientHandler->pose_dirty())
-  {
-    clientHandler->get_frame_message_queue()->pop();
-    clientHandler->set_images_dirty(false);
-    clientHandler->set_pose_dirty(false);
-  }
+  if(clientHandler->pose_dirty()) clientHandler->pop_frame_message();
 
   // Extract the pose from the first message on the queue. This will block until the queue
   // has a message from which to extract the pose.
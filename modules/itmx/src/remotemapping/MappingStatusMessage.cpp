@@ -0,0 +1,63 @@
+/**
+ * itmx: MappingStatusMessage.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "remotemapping/MappingStatusMessage.h"
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+MappingStatusMessage::MappingStatusMessage()
+{
+  m_droppedFrameCountSegment = std::make_pair(0, sizeof(uint32_t));
+  m_processingRateSegment = std::make_pair(end_of(m_droppedFrameCountSegment), sizeof(float));
+  m_queueCapacitySegment = std::make_pair(end_of(m_processingRateSegment), sizeof(uint32_t));
+  m_queueSizeSegment = std::make_pair(end_of(m_queueCapacitySegment), sizeof(uint32_t));
+  m_data.resize(end_of(m_queueSizeSegment));
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+uint32_t MappingStatusMessage::extract_dropped_frame_count() const
+{
+  return read_simple<uint32_t>(m_droppedFrameCountSegment);
+}
+
+float MappingStatusMessage::extract_processing_rate() const
+{
+  return read_simple<float>(m_processingRateSegment);
+}
+
+uint32_t MappingStatusMessage::extract_queue_capacity() const
+{
+  return read_simple<uint32_t>(m_queueCapacitySegment);
+}
+
+uint32_t MappingStatusMessage::extract_queue_size() const
+{
+  return read_simple<uint32_t>(m_queueSizeSegment);
+}
+
+void MappingStatusMessage::set_dropped_frame_count(uint32_t droppedFrameCount)
+{
+  write_simple(droppedFrameCount, m_droppedFrameCountSegment);
+}
+
+void MappingStatusMessage::set_processing_rate(float processingRate)
+{
+  write_simple(processingRate, m_processingRateSegment);
+}
+
+void MappingStatusMessage::set_queue_capacity(uint32_t queueCapacity)
+{
+  write_simple(queueCapacity, m_queueCapacitySegment);
+}
+
+void MappingStatusMessage::set_queue_size(uint32_t queueSize)
+{
+  write_simple(queueSize, m_queueSizeSegment);
+}
+
+}
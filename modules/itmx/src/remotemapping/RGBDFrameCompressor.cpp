@@ -34,6 +34,9 @@ struct RGBDFrameCompressor::Impl
   /** The type of compression algorithm to use for the RGB images. */
   RGBCompressionType rgbCompressionType;
 
+  /** The quality (in [0,100]) to use when compressing RGB images using JPG compression. */
+  int rgbJpegQuality;
+
   /** An image storing the temporary uncompressed depth data. */
   ORShortImage_Ptr uncompressedDepthImage;
 
@@ -60,6 +63,7 @@ RGBDFrameCompressor::RGBDFrameCompressor(const Vector2i& rgbImageSize, const Vec
 
   m_impl->depthCompressionType = depthCompressionType;
   m_impl->rgbCompressionType = rgbCompressionType;
+  m_impl->rgbJpegQuality = 95; // the OpenCV default
   m_impl->uncompressedDepthImage = mbf.make_image<short>(depthImageSize);
   m_impl->uncompressedRgbImage = mbf.make_image<Vector4u>(rgbImageSize);
 
@@ -117,6 +121,11 @@ void RGBDFrameCompressor::compress_rgbd_frame(const RGBDFrameMessage& uncompress
   compressedFrame.set_rgb_image_data(m_impl->compressedRgbBytes);
 }
 
+void RGBDFrameCompressor::set_rgb_jpeg_quality(int rgbJpegQuality)
+{
+  m_impl->rgbJpegQuality = rgbJpegQuality;
+}
+
 void RGBDFrameCompressor::uncompress_rgbd_frame(const CompressedRGBDFrameMessage& compressedFrame, RGBDFrameMessage& uncompressedFrame)
 {
   // First, copy the metadata.
@@ -189,8 +198,14 @@ void RGBDFrameCompressor::compress_rgb_image()
     cv::cvtColor(rgbWrapper, m_impl->uncompressedRgbMat, CV_RGBA2BGR);
 
     // Finally, compress the image using the appropriate format, storing the compressed representation in the internal buffer.
-    const std::string outputFormat = m_impl->rgbCompressionType == RGB_COMPRESSION_JPG ? ".jpg" : ".png";
-    cv::imencode(outputFormat, m_impl->uncompressedRgbMat, m_impl->compressedRgbBytes);
+    if(m_impl->rgbCompressionType == RGB_COMPRESSION_JPG)
+    {
+      std::vector<int> params;
+      params.push_back(cv::IMWRITE_JPEG_QUALITY);
+      params.push_back(m_impl->rgbJpegQuality);
+      cv::imencode(".jpg", m_impl->uncompressedRgbMat, m_impl->compressedRgbBytes, params);
+    }
+    else cv::imencode(".png", m_impl->uncompressedRgbMat, m_impl->compressedRgbBytes);
 #endif
   }
 }
@@ -0,0 +1,323 @@
+/**
+ * itmx: RenderingResponseCompressor.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "remotemapping/RenderingResponseCompressor.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef WITH_OPENCV
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#endif
+
+namespace itmx {
+
+//#################### NESTED TYPES ####################
+
+struct RenderingResponseCompressor::Impl
+{
+  /** A vector containing the compressed data for the mosaic of changed tiles. */
+  std::vector<uint8_t> compressedTileData;
+
+  /** A mosaic into which the changed tiles are packed. */
+  ORUChar4Image_Ptr mosaic;
+
+#ifdef WITH_OPENCV
+  /** An OpenCV image storing the temporary uncompressed mosaic data. */
+  cv::Mat mosaicMat;
+#endif
+
+  /** The image from which the most recent response was compressed (valid only if pendingImageValid is true). */
+  ORUChar4Image_Ptr pendingImage;
+
+  /** Whether or not a response has been compressed since the client last acknowledged one. */
+  bool pendingImageValid;
+
+  /** The image from which the last response the client acknowledged was compressed (if any). */
+  ORUChar4Image_Ptr referenceImage;
+
+  /** The type of compression algorithm to use for the mosaics of changed tiles. */
+  RGBCompressionType rgbCompressionType;
+
+  /** The indices of the changed tiles. */
+  std::vector<uint32_t> tileIndices;
+
+  /** The size (in pixels) of each (square) tile. */
+  int tileSize;
+};
+
+//#################### CONSTRUCTORS ####################
+
+RenderingResponseCompressor::RenderingResponseCompressor(RGBCompressionType rgbCompressionType, int tileSize)
+: m_impl(new Impl)
+{
+  if(tileSize <= 0) throw std::invalid_argument("Error: The tile size must be positive");
+
+#ifndef WITH_OPENCV
+  if(rgbCompressionType != RGB_COMPRESSION_NONE)
+  {
+    throw std::invalid_argument("Error: Cannot compress RGB images to PNG or JPG format. Reconfigure in CMake with the WITH_OPENCV option set to on.");
+  }
+#endif
+
+  m_impl->mosaic.reset(new ORUChar4Image(Vector2i(tileSize, tileSize), true, false));
+  m_impl->pendingImageValid = false;
+  m_impl->rgbCompressionType = rgbCompressionType;
+  m_impl->tileSize = tileSize;
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void RenderingResponseCompressor::acknowledge_rendering_response()
+{
+  // The client now has the image from which the most recent response was compressed, so make it the reference image
+  // for subsequent responses. (The old reference image will be reused to store the image for the next response.)
+  if(m_impl->pendingImageValid)
+  {
+    std::swap(m_impl->pendingImage, m_impl->referenceImage);
+    m_impl->pendingImageValid = false;
+  }
+}
+
+void RenderingResponseCompressor::reject_rendering_response()
+{
+  // The client could not apply the most recent response, so we can no longer be sure which image it has. Forget both
+  // the pending and reference images, so that the next response contains all of the tiles of the image.
+  m_impl->pendingImageValid = false;
+  m_impl->referenceImage.reset();
+}
+
+void RenderingResponseCompressor::compress_rendering_response(const ORUChar4Image *image, RenderingResponseHeaderMessage& compressedHeader, RenderingResponseMessage& compressedMsg)
+{
+  const Vector2i& imgSize = image->noDims;
+  const int tileSize = m_impl->tileSize;
+  const int tilesPerRow = (imgSize.x + tileSize - 1) / tileSize;
+  const int tilesPerColumn = (imgSize.y + tileSize - 1) / tileSize;
+
+  // Find the tiles that have changed since the last image the client acknowledged. If the client has not acknowledged
+  // an image of the right size, it needs all of them.
+  const ORUChar4Image *referenceImage = m_impl->referenceImage.get();
+  const bool haveReference = referenceImage && referenceImage->noDims.x == imgSize.x && referenceImage->noDims.y == imgSize.y;
+
+  m_impl->tileIndices.clear();
+  for(int ty = 0; ty < tilesPerColumn; ++ty)
+  {
+    for(int tx = 0; tx < tilesPerRow; ++tx)
+    {
+      if(!haveReference || tile_differs(image, referenceImage, Vector2i(tx * tileSize, ty * tileSize), tileSize))
+      {
+        m_impl->tileIndices.push_back(static_cast<uint32_t>(ty * tilesPerRow + tx));
+      }
+    }
+  }
+
+  // Keep a copy of the image, so that it can become the reference image if the client acknowledges the response.
+  if(!m_impl->pendingImage) m_impl->pendingImage.reset(new ORUChar4Image(imgSize, true, false));
+  m_impl->pendingImage->ChangeDims(imgSize);
+  m_impl->pendingImage->SetFrom(image, ORUChar4Image::CPU_TO_CPU);
+  m_impl->pendingImageValid = true;
+
+  // If any tiles have changed, pack them into the mosaic in order and compress it.
+  const int tileCount = static_cast<int>(m_impl->tileIndices.size());
+  if(tileCount > 0)
+  {
+    const Vector2i mosaicSize = compute_mosaic_size(imgSize, tileCount, tileSize);
+    const int mosaicTilesPerRow = (mosaicSize.x + tileSize - 1) / tileSize;
+    m_impl->mosaic->ChangeDims(mosaicSize);
+    m_impl->mosaic->Clear();
+
+    for(int i = 0; i < tileCount; ++i)
+    {
+      const int tileIndex = static_cast<int>(m_impl->tileIndices[i]);
+      const Vector2i imagePos((tileIndex % tilesPerRow) * tileSize, (tileIndex / tilesPerRow) * tileSize);
+      const Vector2i mosaicPos((i % mosaicTilesPerRow) * tileSize, (i / mosaicTilesPerRow) * tileSize);
+      copy_tile(image, imagePos, m_impl->mosaic.get(), mosaicPos, tileSize);
+    }
+
+    compress_mosaic();
+  }
+  else m_impl->compressedTileData.clear();
+
+  // Prepare the header and the message containing the changed tiles.
+  compressedHeader.set_compressed_tile_data_byte_size(static_cast<uint32_t>(m_impl->compressedTileData.size()));
+  compressedHeader.set_image_size(imgSize);
+  compressedHeader.set_tile_count(static_cast<uint32_t>(tileCount));
+  compressedHeader.set_tile_size(static_cast<uint32_t>(tileSize));
+
+  compressedMsg.set_segment_sizes(compressedHeader);
+  compressedMsg.set_tile_indices(m_impl->tileIndices);
+  compressedMsg.set_compressed_tile_data(m_impl->compressedTileData);
+}
+
+void RenderingResponseCompressor::uncompress_rendering_response(const RenderingResponseHeaderMessage& compressedHeader, const RenderingResponseMessage& compressedMsg, ORUChar4Image *image)
+{
+  // Note: The response is fully validated and uncompressed before the image is touched, so that if anything is wrong with it,
+  //       the image the client already has is left unchanged (and so still matches the server's reference image).
+  const Vector2i imgSize = compressedHeader.extract_image_size();
+  const bool sizeChanged = image->noDims.x != imgSize.x || image->noDims.y != imgSize.y;
+
+  // If this is a "not modified" reply, the image is already up to date (the server only sends one if the sizes match).
+  const int tileCount = static_cast<int>(compressedHeader.extract_tile_count());
+  if(tileCount == 0)
+  {
+    if(sizeChanged) throw std::runtime_error("Error: The rendering response is a \"not modified\" reply, but the size of the image has changed");
+    return;
+  }
+
+  // Otherwise, check that the tiles in the response are valid.
+  const int tileSize = static_cast<int>(compressedHeader.extract_tile_size());
+  if(tileSize <= 0) throw std::runtime_error("Error: The tile size in the rendering response is invalid");
+
+  const int tilesPerRow = (imgSize.x + tileSize - 1) / tileSize;
+  const int tilesPerColumn = (imgSize.y + tileSize - 1) / tileSize;
+  const int totalTileCount = tilesPerRow * tilesPerColumn;
+  if(sizeChanged && tileCount != totalTileCount)
+  {
+    throw std::runtime_error("Error: The size of the image has changed, but the rendering response does not contain all of the tiles");
+  }
+
+  compressedMsg.extract_tile_indices(m_impl->tileIndices);
+  if(static_cast<int>(m_impl->tileIndices.size()) != tileCount)
+  {
+    throw std::runtime_error("Error: The number of tile indices in the rendering response does not match the tile count");
+  }
+
+  for(int i = 0; i < tileCount; ++i)
+  {
+    if(m_impl->tileIndices[i] >= static_cast<uint32_t>(totalTileCount))
+    {
+      throw std::runtime_error("Error: A tile index in the rendering response is out of range");
+    }
+  }
+
+  // Uncompress the mosaic of changed tiles.
+  const Vector2i mosaicSize = compute_mosaic_size(imgSize, tileCount, tileSize);
+  const int mosaicTilesPerRow = (mosaicSize.x + tileSize - 1) / tileSize;
+
+  compressedMsg.extract_compressed_tile_data(m_impl->compressedTileData);
+  m_impl->mosaic->ChangeDims(mosaicSize);
+  uncompress_mosaic();
+
+  // Finally, make sure the image has the right size, and copy the changed tiles from the mosaic into it.
+  image->ChangeDims(imgSize);
+  for(int i = 0; i < tileCount; ++i)
+  {
+    const int tileIndex = static_cast<int>(m_impl->tileIndices[i]);
+    const Vector2i imagePos((tileIndex % tilesPerRow) * tileSize, (tileIndex / tilesPerRow) * tileSize);
+    const Vector2i mosaicPos((i % mosaicTilesPerRow) * tileSize, (i / mosaicTilesPerRow) * tileSize);
+    copy_tile(m_impl->mosaic.get(), mosaicPos, image, imagePos, tileSize);
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void RenderingResponseCompressor::compress_mosaic()
+{
+  const ORUChar4Image *mosaic = m_impl->mosaic.get();
+
+  if(m_impl->rgbCompressionType == RGB_COMPRESSION_NONE)
+  {
+    // If we're not using compression, simply copy the raw bytes of the mosaic into the internal buffer.
+    m_impl->compressedTileData.resize(mosaic->dataSize * sizeof(Vector4u));
+    memcpy(&m_impl->compressedTileData[0], mosaic->GetData(MEMORYDEVICE_CPU), m_impl->compressedTileData.size());
+  }
+  else
+  {
+#ifdef WITH_OPENCV
+    // Otherwise, first wrap the mosaic as an OpenCV image, and make a copy of it in which we reorder the colours and drop the alpha channel.
+    cv::Mat mosaicWrapper(mosaic->noDims.y, mosaic->noDims.x, CV_8UC4, const_cast<Vector4u*>(mosaic->GetData(MEMORYDEVICE_CPU)));
+    cv::cvtColor(mosaicWrapper, m_impl->mosaicMat, CV_RGBA2BGR);
+
+    // Then, compress the copy using the appropriate format, storing the compressed representation in the internal buffer.
+    cv::imencode(m_impl->rgbCompressionType == RGB_COMPRESSION_JPG ? ".jpg" : ".png", m_impl->mosaicMat, m_impl->compressedTileData);
+#endif
+  }
+}
+
+void RenderingResponseCompressor::uncompress_mosaic()
+{
+  ORUChar4Image *mosaic = m_impl->mosaic.get();
+
+  if(m_impl->rgbCompressionType == RGB_COMPRESSION_NONE)
+  {
+    // If we're not using compression, check that the size of the mosaic matches that of the compressed data.
+    if(mosaic->dataSize * sizeof(Vector4u) != m_impl->compressedTileData.size())
+    {
+      throw std::runtime_error("Error: The size of the tile data in the rendering response does not match the size of the mosaic");
+    }
+
+    // If it does, simply copy the bytes across.
+    memcpy(mosaic->GetData(MEMORYDEVICE_CPU), &m_impl->compressedTileData[0], m_impl->compressedTileData.size());
+  }
+  else
+  {
+#ifdef WITH_OPENCV
+    // Otherwise, first decode the mosaic into a preallocated internal buffer.
+    m_impl->mosaicMat = cv::imdecode(m_impl->compressedTileData, cv::IMREAD_COLOR, &m_impl->mosaicMat);
+    if(m_impl->mosaicMat.cols != mosaic->noDims.x || m_impl->mosaicMat.rows != mosaic->noDims.y)
+    {
+      throw std::runtime_error("Error: The size of the decoded mosaic in the rendering response is invalid");
+    }
+
+    // Then, copy it into the mosaic, reordering the bytes and re-adding the alpha channel as we do so.
+    cv::Mat mosaicWrapper(mosaic->noDims.y, mosaic->noDims.x, CV_8UC4, mosaic->GetData(MEMORYDEVICE_CPU));
+    cv::cvtColor(m_impl->mosaicMat, mosaicWrapper, CV_BGR2RGBA);
+#endif
+  }
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+Vector2i RenderingResponseCompressor::compute_mosaic_size(const Vector2i& imgSize, int tileCount, int tileSize)
+{
+  const int tilesPerRow = (imgSize.x + tileSize - 1) / tileSize;
+  const int tilesPerColumn = (imgSize.y + tileSize - 1) / tileSize;
+
+  // If all of the tiles have changed, the mosaic has exactly the same layout as the image, so make it the same size as the image
+  // to avoid transmitting any padding. (This matters in particular if the image is being sent uncompressed.)
+  if(tileCount == tilesPerRow * tilesPerColumn) return imgSize;
+
+  // Otherwise, make the mosaic as wide as the image (in tiles), and as tall as it needs to be to store all of the tiles.
+  const int mosaicTilesPerRow = std::min(tileCount, tilesPerRow);
+  const int mosaicTilesPerColumn = (tileCount + mosaicTilesPerRow - 1) / mosaicTilesPerRow;
+  return Vector2i(mosaicTilesPerRow * tileSize, mosaicTilesPerColumn * tileSize);
+}
+
+void RenderingResponseCompressor::copy_tile(const ORUChar4Image *source, const Vector2i& sourcePos, ORUChar4Image *target, const Vector2i& targetPos, int tileSize)
+{
+  const int width = std::min(tileSize, std::min(source->noDims.x - sourcePos.x, target->noDims.x - targetPos.x));
+  const int height = std::min(tileSize, std::min(source->noDims.y - sourcePos.y, target->noDims.y - targetPos.y));
+  if(width <= 0 || height <= 0) return;
+
+  const Vector4u *sourceData = source->GetData(MEMORYDEVICE_CPU);
+  Vector4u *targetData = target->GetData(MEMORYDEVICE_CPU);
+  for(int y = 0; y < height; ++y)
+  {
+    const Vector4u *sourceRow = sourceData + (sourcePos.y + y) * source->noDims.x + sourcePos.x;
+    Vector4u *targetRow = targetData + (targetPos.y + y) * target->noDims.x + targetPos.x;
+    memcpy(targetRow, sourceRow, width * sizeof(Vector4u));
+  }
+}
+
+bool RenderingResponseCompressor::tile_differs(const ORUChar4Image *image1, const ORUChar4Image *image2, const Vector2i& pos, int tileSize)
+{
+  const int imgWidth = image1->noDims.x;
+  const int width = std::min(tileSize, imgWidth - pos.x);
+  const int height = std::min(tileSize, image1->noDims.y - pos.y);
+
+  const Vector4u *data1 = image1->GetData(MEMORYDEVICE_CPU);
+  const Vector4u *data2 = image2->GetData(MEMORYDEVICE_CPU);
+  for(int y = 0; y < height; ++y)
+  {
+    const int offset = (pos.y + y) * imgWidth + pos.x;
+    if(memcmp(data1 + offset, data2 + offset, width * sizeof(Vector4u)) != 0) return true;
+  }
+
+  return false;
+}
+
+}
@@ -0,0 +1,63 @@
+/**
+ * itmx: RenderingResponseHeaderMessage.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "remotemapping/RenderingResponseHeaderMessage.h"
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+RenderingResponseHeaderMessage::RenderingResponseHeaderMessage()
+{
+  m_compressedTileDataByteSizeSegment = std::make_pair(0, sizeof(uint32_t));
+  m_imageSizeSegment = std::make_pair(end_of(m_compressedTileDataByteSizeSegment), sizeof(Vector2i));
+  m_tileCountSegment = std::make_pair(end_of(m_imageSizeSegment), sizeof(uint32_t));
+  m_tileSizeSegment = std::make_pair(end_of(m_tileCountSegment), sizeof(uint32_t));
+  m_data.resize(end_of(m_tileSizeSegment));
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+uint32_t RenderingResponseHeaderMessage::extract_compressed_tile_data_byte_size() const
+{
+  return read_simple<uint32_t>(m_compressedTileDataByteSizeSegment);
+}
+
+Vector2i RenderingResponseHeaderMessage::extract_image_size() const
+{
+  return read_simple<Vector2i>(m_imageSizeSegment);
+}
+
+uint32_t RenderingResponseHeaderMessage::extract_tile_count() const
+{
+  return read_simple<uint32_t>(m_tileCountSegment);
+}
+
+uint32_t RenderingResponseHeaderMessage::extract_tile_size() const
+{
+  return read_simple<uint32_t>(m_tileSizeSegment);
+}
+
+void RenderingResponseHeaderMessage::set_compressed_tile_data_byte_size(uint32_t compressedTileDataByteSize)
+{
+  write_simple(compressedTileDataByteSize, m_compressedTileDataByteSizeSegment);
+}
+
+void RenderingResponseHeaderMessage::set_image_size(const Vector2i& imageSize)
+{
+  write_simple(imageSize, m_imageSizeSegment);
+}
+
+void RenderingResponseHeaderMessage::set_tile_count(uint32_t tileCount)
+{
+  write_simple(tileCount, m_tileCountSegment);
+}
+
+void RenderingResponseHeaderMessage::set_tile_size(uint32_t tileSize)
+{
+  write_simple(tileSize, m_tileSizeSegment);
+}
+
+}
@@ -0,0 +1,72 @@
+/**
+ * itmx: RenderingResponseMessage.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "remotemapping/RenderingResponseMessage.h"
+
+#include <stdexcept>
+
+namespace itmx {
+
+//#################### CONSTRUCTORS ####################
+
+RenderingResponseMessage::RenderingResponseMessage(const RenderingResponseHeaderMessage& headerMsg)
+{
+  set_segment_sizes(headerMsg);
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void RenderingResponseMessage::extract_compressed_tile_data(std::vector<uint8_t>& compressedTileData) const
+{
+  compressedTileData.resize(m_compressedTileDataSegment.second);
+  if(!compressedTileData.empty())
+  {
+    memcpy(reinterpret_cast<char*>(&compressedTileData[0]), &m_data[m_compressedTileDataSegment.first], m_compressedTileDataSegment.second);
+  }
+}
+
+void RenderingResponseMessage::extract_tile_indices(std::vector<uint32_t>& tileIndices) const
+{
+  tileIndices.resize(m_tileIndicesSegment.second / sizeof(uint32_t));
+  if(!tileIndices.empty())
+  {
+    memcpy(reinterpret_cast<char*>(&tileIndices[0]), &m_data[m_tileIndicesSegment.first], m_tileIndicesSegment.second);
+  }
+}
+
+void RenderingResponseMessage::set_compressed_tile_data(const std::vector<uint8_t>& compressedTileData)
+{
+  if(compressedTileData.size() != m_compressedTileDataSegment.second)
+  {
+    throw std::runtime_error("Error: The compressed tile data has a different size to that of the tile data segment in the message");
+  }
+
+  if(!compressedTileData.empty())
+  {
+    memcpy(&m_data[m_compressedTileDataSegment.first], reinterpret_cast<const char*>(&compressedTileData[0]), m_compressedTileDataSegment.second);
+  }
+}
+
+void RenderingResponseMessage::set_segment_sizes(const RenderingResponseHeaderMessage& headerMsg)
+{
+  m_tileIndicesSegment = std::make_pair(0, headerMsg.extract_tile_count() * sizeof(uint32_t));
+  m_compressedTileDataSegment = std::make_pair(end_of(m_tileIndicesSegment), headerMsg.extract_compressed_tile_data_byte_size());
+  m_data.resize(end_of(m_compressedTileDataSegment));
+}
+
+void RenderingResponseMessage::set_tile_indices(const std::vector<uint32_t>& tileIndices)
+{
+  if(tileIndices.size() * sizeof(uint32_t) != m_tileIndicesSegment.second)
+  {
+    throw std::runtime_error("Error: The number of tile indices does not match the size of the tile indices segment in the message");
+  }
+
+  if(!tileIndices.empty())
+  {
+    memcpy(&m_data[m_tileIndicesSegment.first], reinterpret_cast<const char*>(&tileIndices[0]), m_tileIndicesSegment.second);
+  }
+}
+
+}
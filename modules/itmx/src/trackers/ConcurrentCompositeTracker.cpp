@@ -0,0 +1,323 @@
+/**
+ * itmx: ConcurrentCompositeTracker.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "trackers/ConcurrentCompositeTracker.h"
+using namespace ITMLib;
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+namespace itmx {
+
+//#################### ANONYMOUS FREE FUNCTIONS ####################
+
+namespace {
+
+/**
+ * \brief Deletes a nested tracker's tracking state, first detaching the point cloud it shares with the other nested trackers.
+ *
+ * \param trackingState The tracking state to delete.
+ */
+void delete_nested_tracking_state(ITMTrackingState *trackingState)
+{
+  trackingState->pointCloud = NULL;
+  delete trackingState;
+}
+
+#ifndef BOOST_NO_CXX11_HDR_EXCEPTION
+inline std::exception_ptr capture_exception() { return std::current_exception(); }
+inline void rethrow_captured_exception(const std::exception_ptr& e) { std::rethrow_exception(e); }
+#else
+inline boost::exception_ptr capture_exception() { return boost::current_exception(); }
+inline void rethrow_captured_exception(const boost::exception_ptr& e) { boost::rethrow_exception(e); }
+#endif
+
+}
+
+//#################### CONSTRUCTORS ####################
+
+ConcurrentCompositeTracker::ConcurrentCompositeTracker(MemoryDeviceType memoryType)
+: m_memoryType(memoryType), m_shuttingDown(false)
+{}
+
+//#################### DESTRUCTOR ####################
+
+ConcurrentCompositeTracker::~ConcurrentCompositeTracker()
+{
+  // Tell the worker threads to terminate once they have finished tracking their current frames (if any), and wait for them to do so.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_shuttingDown = true;
+  }
+  m_trackingStarted.notify_all();
+  m_threads.join_all();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ConcurrentCompositeTracker::add_tracker(const Tracker_Ptr& tracker, bool mustFinish)
+{
+  if(m_threads.size() != 0) throw std::runtime_error("Error: Cannot add a nested tracker to a concurrent composite tracker that is already in use");
+
+  NestedTracker nestedTracker;
+  nestedTracker.mustFinish = mustFinish;
+  nestedTracker.running = false;
+  nestedTracker.tracker = tracker;
+  m_nestedTrackers.push_back(nestedTracker);
+}
+
+bool ConcurrentCompositeTracker::CanKeepTracking() const
+{
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    if(m_nestedTrackers[i].tracker->CanKeepTracking()) return true;
+  }
+  return false;
+}
+
+bool ConcurrentCompositeTracker::requiresColourRendering() const
+{
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    if(m_nestedTrackers[i].tracker->requiresColourRendering()) return true;
+  }
+  return false;
+}
+
+bool ConcurrentCompositeTracker::requiresDepthReliability() const
+{
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    if(m_nestedTrackers[i].tracker->requiresDepthReliability()) return true;
+  }
+  return false;
+}
+
+bool ConcurrentCompositeTracker::requiresPointCloudRendering() const
+{
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    if(m_nestedTrackers[i].tracker->requiresPointCloudRendering()) return true;
+  }
+  return false;
+}
+
+void ConcurrentCompositeTracker::TrackCamera(ITMTrackingState *trackingState, const ITMView *view)
+{
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+
+  // If the worker threads have not yet been started, start them.
+  if(m_threads.size() == 0)
+  {
+    for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+    {
+      m_threads.create_thread(boost::bind(&ConcurrentCompositeTracker::run_worker, this, i));
+    }
+  }
+
+  // Wait for any nested trackers whose results were not needed for the previous frame to finish tracking it.
+  wait_for_trackers(lock);
+
+  // Copy the view and the tracking state so that every nested tracker can start from the same input, and
+  // so that any nested trackers that are still running when we return cannot be affected by the caller.
+  copy_view(view);
+  copy_point_cloud(trackingState->pointCloud);
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    NestedTracker& nestedTracker = m_nestedTrackers[i];
+    copy_tracking_state(trackingState, nestedTracker);
+    nestedTracker.error = ExceptionPtr();
+    nestedTracker.running = true;
+  }
+
+  // Start all of the nested trackers, and wait until we know whose result to adopt.
+  m_trackingStarted.notify_all();
+
+  boost::optional<size_t> adoptedTracker;
+  while(!try_select_result(adoptedTracker))
+  {
+    m_trackerFinished.wait(lock);
+  }
+
+  // Adopt the selected result (the selected tracker has finished, so its tracking state will not change until the next frame).
+  // If every nested tracker failed, leave the pose unchanged and report the failure.
+  if(adoptedTracker)
+  {
+    const ITMTrackingState *adoptedState = m_nestedTrackers[*adoptedTracker].trackingState.get();
+    trackingState->pose_d->SetFrom(adoptedState->pose_d);
+    trackingState->trackerResult = adoptedState->trackerResult;
+    trackingState->trackerScore = adoptedState->trackerScore;
+  }
+  else
+  {
+    trackingState->trackerResult = ITMTrackingState::TRACKING_FAILED;
+  }
+}
+
+void ConcurrentCompositeTracker::UpdateInitialPose(ITMTrackingState *trackingState)
+{
+  // As for a sequential composite, let each nested tracker update the initial pose in turn. Since this
+  // uses the caller's tracking state directly, we first wait for any nested trackers that are running.
+  boost::unique_lock<boost::mutex> lock(m_mutex);
+  wait_for_trackers(lock);
+
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    m_nestedTrackers[i].tracker->UpdateInitialPose(trackingState);
+  }
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+template <typename T>
+void ConcurrentCompositeTracker::copy_image(const ORUtils::Image<T> *source, ORUtils::Image<T> *target) const
+{
+  target->ChangeDims(source->noDims);
+  target->SetFrom(source, m_memoryType == MEMORYDEVICE_CUDA ? ORUtils::MemoryBlock<T>::CUDA_TO_CUDA : ORUtils::MemoryBlock<T>::CPU_TO_CPU);
+}
+
+void ConcurrentCompositeTracker::copy_point_cloud(const ITMPointCloud *pointCloud)
+{
+  // If none of the nested trackers needs the point cloud, there is no need to copy it.
+  if(!requiresPointCloudRendering()) return;
+
+  // If our copy of the point cloud does not yet exist, create it.
+  if(!m_pointCloud) m_pointCloud.reset(new ITMPointCloud(pointCloud->locations->noDims, m_memoryType));
+
+  m_pointCloud->noTotalPoints = pointCloud->noTotalPoints;
+  copy_image(pointCloud->locations, m_pointCloud->locations);
+  copy_image(pointCloud->colours, m_pointCloud->colours);
+}
+
+void ConcurrentCompositeTracker::copy_tracking_state(const ITMTrackingState *source, NestedTracker& nestedTracker) const
+{
+  // If the nested tracker's tracking state does not yet exist, create it. Since trackers only read the point cloud,
+  // the nested trackers can safely share our copy of it, which avoids the cost of making a copy for each of them.
+  if(!nestedTracker.trackingState)
+  {
+    ITMTrackingState *trackingState = new ITMTrackingState(source->pointCloud->locations->noDims, m_memoryType);
+    delete trackingState->pointCloud;
+    trackingState->pointCloud = m_pointCloud.get();
+    nestedTracker.trackingState.reset(trackingState, &delete_nested_tracking_state);
+  }
+
+  ITMTrackingState *target = nestedTracker.trackingState.get();
+  target->age_pointCloud = source->age_pointCloud;
+  target->pose_d->SetFrom(source->pose_d);
+  target->pose_pointCloud->SetFrom(source->pose_pointCloud);
+  target->requiresFullRendering = source->requiresFullRendering;
+  target->trackerResult = source->trackerResult;
+  target->trackerScore = source->trackerScore;
+}
+
+void ConcurrentCompositeTracker::copy_view(const ITMView *view)
+{
+  const bool useGPU = m_memoryType == MEMORYDEVICE_CUDA;
+
+  // If our copy of the view does not yet exist, create it.
+  if(!m_view) m_view.reset(new ITMView(view->calib, view->rgb->noDims, view->depth->noDims, useGPU));
+
+  m_view->calib = view->calib;
+  copy_image(view->rgb, m_view->rgb);
+  copy_image(view->depth, m_view->depth);
+
+  // The normal and uncertainty images are only allocated by the view builder if they are needed, so copy them if they exist.
+  if(view->depthNormal)
+  {
+    if(!m_view->depthNormal) m_view->depthNormal = new ORFloat4Image(view->depthNormal->noDims, true, useGPU);
+    copy_image(view->depthNormal, m_view->depthNormal);
+  }
+
+  if(view->depthUncertainty)
+  {
+    if(!m_view->depthUncertainty) m_view->depthUncertainty = new ORFloatImage(view->depthUncertainty->noDims, true, useGPU);
+    copy_image(view->depthUncertainty, m_view->depthUncertainty);
+  }
+}
+
+void ConcurrentCompositeTracker::run_worker(size_t i)
+{
+  NestedTracker& nestedTracker = m_nestedTrackers[i];
+
+  for(;;)
+  {
+    // Wait until there is a frame to track, or until the composite is being destroyed.
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(!nestedTracker.running && !m_shuttingDown) m_trackingStarted.wait(lock);
+      if(!nestedTracker.running) return;
+    }
+
+    // Track the frame, starting from the nested tracker's own copy of the tracking state. Any exception the nested tracker
+    // throws is captured (whatever its type), since letting it escape would terminate the process.
+    ExceptionPtr error;
+    try
+    {
+      nestedTracker.tracker->TrackCamera(nestedTracker.trackingState.get(), m_view.get());
+    }
+    catch(...)
+    {
+      error = capture_exception();
+    }
+
+    // Signal that the nested tracker has finished.
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      nestedTracker.error = error;
+      nestedTracker.running = false;
+    }
+    m_trackerFinished.notify_all();
+  }
+}
+
+bool ConcurrentCompositeTracker::try_select_result(boost::optional<size_t>& adoptedTracker) const
+{
+  adoptedTracker.reset();
+
+  // If any nested tracker that must finish before we return is still running, we cannot return yet.
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    if(m_nestedTrackers[i].running && m_nestedTrackers[i].mustFinish) return false;
+  }
+
+  // Look for a good result that no higher-priority tracker can still pre-empt. If a higher-priority tracker threw
+  // an exception, propagate it, as a sequential composite would have done. (Exceptions thrown by lower-priority
+  // trackers are ignored, since a sequential composite would never have run them.)
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    const NestedTracker& nestedTracker = m_nestedTrackers[i];
+    if(nestedTracker.running) return false;
+    if(nestedTracker.error) rethrow_captured_exception(nestedTracker.error);
+
+    if(nestedTracker.trackingState->trackerResult == ITMTrackingState::TRACKING_GOOD)
+    {
+      adoptedTracker = i;
+      return true;
+    }
+  }
+
+  // If we get here, all of the nested trackers have finished without a good result, so fall back to the highest-priority poor result (if any).
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    if(m_nestedTrackers[i].trackingState->trackerResult == ITMTrackingState::TRACKING_POOR)
+    {
+      adoptedTracker = i;
+      break;
+    }
+  }
+
+  return true;
+}
+
+void ConcurrentCompositeTracker::wait_for_trackers(boost::unique_lock<boost::mutex>& lock)
+{
+  for(size_t i = 0, size = m_nestedTrackers.size(); i < size; ++i)
+  {
+    while(m_nestedTrackers[i].running) m_trackerFinished.wait(lock);
+  }
+}
+
+}
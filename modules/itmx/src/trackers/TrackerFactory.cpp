@@ -19,6 +19,7 @@ using namespace orx;
 #include <tvgutil/persistence/PropertyUtil.h>
 using namespace tvgutil;
 
+#include "trackers/ConcurrentCompositeTracker.h"
 #include "trackers/GlobalTracker.h"
 #include "trackers/RemoteTracker.h"
 
@@ -153,6 +154,32 @@ Tracker_Ptr TrackerFactory::make_tracker(const Tree& trackerTree, const std::str
     std::string trackerPolicy;
     PropertyUtil::get_optional_property(trackerTree, "<xmlattr>.policy", trackerPolicy);
 
+    // If the nested trackers should be run concurrently, construct a concurrent composite tracker.
+    if(trackerPolicy == "concurrent")
+    {
+      ConcurrentCompositeTracker *compositeTracker = new ConcurrentCompositeTracker(settings->GetMemoryType());
+      for(boost::property_tree::ptree::const_iterator it = trackerTree.begin(), iend = trackerTree.end(); it != iend; ++it)
+      {
+        if(it->first != "tracker") continue;
+
+        // Note: Unlike an ITMCompositeTracker, the concurrent composite shares ownership of its nested trackers.
+        FallibleTracker *oldFallibleTracker = fallibleTracker;
+        Tracker_Ptr nestedTracker = make_tracker(
+          it->second, sceneID, trackSurfels, rgbImageSize, depthImageSize,
+          lowLevelEngine, imuCalibrator, settings, fallibleTracker,
+          mappingServer, UNNESTED
+        );
+
+        // If the nested tracker contains the fallible tracker, the composite must wait for it to finish on every frame,
+        // so that whether or not tracking has been lost can be safely checked as soon as the composite has returned.
+        const bool mustFinish = fallibleTracker != oldFallibleTracker;
+        compositeTracker->add_tracker(nestedTracker, mustFinish);
+      }
+
+      // Return the composite tracker, making sure to prevent double deletion if it will itself be added to another composite.
+      return nestingFlag == NESTED ? Tracker_Ptr(compositeTracker, boost::serialization::null_deleter()) : Tracker_Ptr(compositeTracker);
+    }
+
     ITMCompositeTracker::Policy policy = ITMCompositeTracker::POLICY_REFINE;
     if(trackerPolicy == "sequential") policy = ITMCompositeTracker::POLICY_SEQUENTIAL;
     else if(trackerPolicy == "stoponfirstsuccess") policy = ITMCompositeTracker::POLICY_STOP_ON_FIRST_SUCCESS;
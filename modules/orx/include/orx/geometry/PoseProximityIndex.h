@@ -0,0 +1,171 @@
+/**
+ * orx: PoseProximityIndex.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ORX_POSEPROXIMITYINDEX
+#define H_ORX_POSEPROXIMITYINDEX
+
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <Eigen/Dense>
+
+namespace orx {
+
+/**
+ * \brief An instance of this class can be used to find the poses in a fixed set (e.g. the training poses of a relocalisation
+ *        dataset) that are within a specified translation and rotation of a query pose.
+ *
+ * A pose p is within (maxTranslation, maxAngle) of a query pose q iff |t(p) - t(q)| <= maxTranslation and the angle of the
+ * rotation that maps R(p) to R(q) is <= maxAngle. The translations of the poses are stored in a k-d tree, so that only the
+ * poses within the specified translation of the query pose need to be considered, and a cheap trace-based bound on the angle
+ * between two rotations is used to reject most of those poses before the exact angle is computed. The exact tests match those
+ * performed by a brute-force scan, so the results of a query are identical to those that such a scan would produce.
+ *
+ * Poses that contain non-finite values can never be within any distance of a query pose, and so are not added to the tree.
+ */
+class PoseProximityIndex
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a node in the k-d tree.
+   */
+  struct Node
+  {
+    /** The axis along which the node's poses are split (or -1 if the node is a leaf). */
+    int axis;
+
+    /** The index (in the pose order) of the first pose in the node. */
+    size_t begin;
+
+    /** The index (in the pose order) one past the last pose in the node. */
+    size_t end;
+
+    /** The index of the node's left child (whose poses have coordinates <= split along the axis), if any. */
+    int left;
+
+    /** The index of the node's right child (whose poses have coordinates >= split along the axis), if any. */
+    int right;
+
+    /** The coordinate along the axis at which the node's poses are split. */
+    float split;
+  };
+
+  /**
+   * \brief An instance of this struct can be used to compare the indices of two poses based on their translations along an axis.
+   */
+  struct TranslationComparator
+  {
+    /** The axis along which to compare the translations. */
+    int axis;
+
+    /** The translations of the poses. */
+    const std::vector<Eigen::Vector3f> *translations;
+
+    TranslationComparator(const std::vector<Eigen::Vector3f> *translations_, int axis_)
+    : axis(axis_), translations(translations_)
+    {}
+
+    bool operator()(size_t i, size_t j) const
+    {
+      return (*translations)[i][axis] < (*translations)[j][axis];
+    }
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The nodes of the k-d tree (the root is node 0). */
+  std::vector<Node> m_nodes;
+
+  /** The indices of the finite poses, arranged so that the poses in each node of the k-d tree are contiguous. */
+  std::vector<size_t> m_order;
+
+  /** The rotations of the poses (indexed by pose). */
+  std::vector<Eigen::Matrix3f> m_rotations;
+
+  /** The translations of the poses (indexed by pose). */
+  std::vector<Eigen::Vector3f> m_translations;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a pose proximity index for the specified set of poses.
+   *
+   * \param poses The poses to index (the results of queries refer to these by their indices).
+   */
+  explicit PoseProximityIndex(const std::vector<Eigen::Matrix4f>& poses);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Finds the indexed pose whose translation is nearest to that of the query pose, out of those within the specified distances of it.
+   *
+   * If several poses are equally near, the one with the lowest index is returned.
+   *
+   * \param pose            The query pose.
+   * \param maxTranslation  The maximum distance (in m) between the translations of the query pose and an indexed pose.
+   * \param maxAngle        The maximum angle (in radians) between the rotations of the query pose and an indexed pose.
+   * \return                The index of the nearest pose within the specified distances, if any, or boost::none otherwise.
+   */
+  boost::optional<size_t> find_nearest_within(const Eigen::Matrix4f& pose, float maxTranslation, float maxAngle) const;
+
+  /**
+   * \brief Finds all of the indexed poses that are within the specified distances of the query pose.
+   *
+   * \param pose            The query pose.
+   * \param maxTranslation  The maximum distance (in m) between the translations of the query pose and an indexed pose.
+   * \param maxAngle        The maximum angle (in radians) between the rotations of the query pose and an indexed pose.
+   * \return                The indices of the poses within the specified distances, in increasing order.
+   */
+  std::vector<size_t> find_within(const Eigen::Matrix4f& pose, float maxTranslation, float maxAngle) const;
+
+  /**
+   * \brief Gets the number of poses in the set that was indexed (including any non-finite ones).
+   *
+   * \return  The number of poses in the set that was indexed.
+   */
+  size_t size() const;
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Calculates the angle of the rotation that maps one rotation to another.
+   *
+   * \param r1  The first rotation.
+   * \param r2  The second rotation.
+   * \return    The angle (in radians) of the rotation r2 * r1^T.
+   */
+  static float angular_separation(const Eigen::Matrix3f& r1, const Eigen::Matrix3f& r2);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Recursively builds the subtree of the k-d tree that contains the specified range of poses.
+   *
+   * \param begin The index (in the pose order) of the first pose in the range.
+   * \param end   The index (in the pose order) one past the last pose in the range.
+   * \return      The index of the root node of the subtree.
+   */
+  int build_subtree(size_t begin, size_t end);
+
+  /**
+   * \brief Recursively collects the indices of the poses in the specified subtree that are within the specified distances of the query pose.
+   *
+   * \param nodeIndex       The index of the root node of the subtree.
+   * \param r               The rotation of the query pose.
+   * \param t               The translation of the query pose.
+   * \param maxTranslation  The maximum distance (in m) between the translations of the query pose and an indexed pose.
+   * \param maxAngle        The maximum angle (in radians) between the rotations of the query pose and an indexed pose.
+   * \param minCosAngle     A lower bound on the cosine of the angle between the rotations of the query pose and any pose that could be within maxAngle of it.
+   * \param result          The vector to which to append the indices of the poses that are found.
+   */
+  void collect_within(int nodeIndex, const Eigen::Matrix3f& r, const Eigen::Vector3f& t, float maxTranslation, float maxAngle, float minCosAngle,
+                      std::vector<size_t>& result) const;
+};
+
+}
+
+#endif
@@ -6,8 +6,11 @@
 #ifndef H_ORX_IMAGEPERSISTER
 #define H_ORX_IMAGEPERSISTER
 
+#include <iostream>
+#include <stdexcept>
 #include <vector>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 
@@ -35,6 +38,21 @@ public:
     IFT_UNKNOWN
   };
 
+  /**
+   * \brief The values of this enumeration represent the supported levels of compression for images saved in PNG format.
+   */
+  enum PNGCompressionLevel
+  {
+    /** Compress the image as much as lodepng's default settings allow (this gives the smallest files, but is slow). */
+    PCL_DEFAULT,
+
+    /** Use a per-row filter and Huffman coding only (several times faster than the default, and barely larger for depth images). */
+    PCL_FAST,
+
+    /** Store the image data uncompressed (the fastest option, but the one that gives the largest files). */
+    PCL_NONE
+  };
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -47,15 +65,26 @@ public:
    */
   static ORUChar4Image_Ptr load_rgba_image(const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
 
+  /**
+   * \brief Attempts to load a short image (e.g. a raw depth image) from a file.
+   *
+   * \param path                The path to the file from which to load the image.
+   * \param fileType            The image file type.
+   * \return                    The loaded image.
+   * \throws std::runtime_error If the image could not be loaded.
+   */
+  static ORShortImage_Ptr load_short_image(const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
+
   /**
    * \brief Attempts to save a short image to a file.
    *
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use if the image is saved in PNG format.
    * \throws std::runtime_error If the image could not be saved.
    */
-  static void save_image(const ORShortImage_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
+  static void save_image(const ORShortImage_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN, PNGCompressionLevel compressionLevel = PCL_DEFAULT);
 
   /**
    * \brief Attempts to save an RGBA image to a file.
@@ -63,9 +92,10 @@ public:
    * \param image               The image to save.
    * \param path                The path to the file to which to save it.
    * \param fileType            The image file type.
+   * \param compressionLevel    The level of compression to use if the image is saved in PNG format.
    * \throws std::runtime_error If the image could not be saved.
    */
-  static void save_image(const ORUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN);
+  static void save_image(const ORUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN, PNGCompressionLevel compressionLevel = PCL_DEFAULT);
 
   /**
    * \brief Attempts to save an image to a file on a separate thread.
@@ -94,8 +124,8 @@ public:
   template <typename T>
   static void save_image_on_thread(const boost::shared_ptr<const ORUtils::Image<T> >& image, const std::string& path, ImageFileType fileType = IFT_UNKNOWN)
   {
-    void (*p)(const boost::shared_ptr<const ORUtils::Image<T> >&, const std::string&, ImageFileType) = &save_image;
-    tvgutil::ThreadPool::instance().post_task(boost::bind(p, image, path, fileType));
+    void (*p)(const boost::shared_ptr<const ORUtils::Image<T> >&, const std::string&, ImageFileType, PNGCompressionLevel) = &save_image;
+    tvgutil::ThreadPool::instance().post_task(boost::bind(p, image, path, fileType, PCL_DEFAULT));
   }
 
   /**
@@ -139,6 +169,15 @@ private:
    */
   static ORUChar4Image_Ptr decode_rgba_png(const std::vector<unsigned char>& buffer, const std::string& path);
 
+  /**
+   * \brief Decodes a buffer in 16-bit greyscale PNG format into a short image.
+   *
+   * \param buffer  The buffer to decode.
+   * \param path    The name of the file from which the buffer was originally loaded (if known).
+   * \return        The decoded image.
+   */
+  static ORShortImage_Ptr decode_short_png(const std::vector<unsigned char>& buffer, const std::string& path);
+
   /**
    * \brief Attempts to deduce an image file's type based on its file extension.
    *
@@ -150,20 +189,58 @@ private:
   /**
    * \brief Encodes a short image in PNG format and writes it into a buffer.
    *
-   * \param image   The image to encode.
-   * \param buffer  The buffer into which to write the encoded image.
+   * \param image             The image to encode.
+   * \param compressionLevel  The level of compression to use.
+   * \param buffer            The buffer into which to write the encoded image.
    */
-  static void encode_png(const ORShortImage_CPtr& image, std::vector<unsigned char>& buffer);
+  static void encode_png(const ORShortImage_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer);
 
   /**
    * \brief Encodes an RGBA image in PNG format and writes it into a buffer.
    *
-   * \param image   The image to encode.
-   * \param buffer  The buffer into which to write the encoded image.
+   * \param image             The image to encode.
+   * \param compressionLevel  The level of compression to use.
+   * \param buffer            The buffer into which to write the encoded image.
    */
-  static void encode_png(const ORUChar4Image_CPtr& image, std::vector<unsigned char>& buffer);
+  static void encode_png(const ORUChar4Image_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer);
 };
 
+//#################### STREAM OPERATORS ####################
+
+inline std::ostream& operator<<(std::ostream& os, ImagePersister::PNGCompressionLevel rhs)
+{
+  switch(rhs)
+  {
+    case ImagePersister::PCL_DEFAULT: os << "default"; break;
+    case ImagePersister::PCL_FAST:    os << "fast"; break;
+    case ImagePersister::PCL_NONE:    os << "none"; break;
+    default:
+    {
+      // This should never happen.
+      throw std::runtime_error("Error: Unknown PNG compression level");
+    }
+  }
+
+  return os;
+}
+
+inline std::istream& operator>>(std::istream& is, ImagePersister::PNGCompressionLevel& rhs)
+{
+  std::string temp;
+  is >> temp;
+  if(!is) return is;
+
+  boost::trim(temp);
+  boost::to_lower(temp);
+
+  if(temp == "default") rhs = ImagePersister::PCL_DEFAULT;
+  else if(temp == "fast") rhs = ImagePersister::PCL_FAST;
+  else if(temp == "none") rhs = ImagePersister::PCL_NONE;
+  else throw std::runtime_error("Error: Unknown PNG compression level '" + temp + "'");
+
+  return is;
+}
+
 }
 
 #endif
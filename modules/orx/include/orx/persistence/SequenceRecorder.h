@@ -0,0 +1,239 @@
+/**
+ * orx: SequenceRecorder.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_ORX_SEQUENCERECORDER
+#define H_ORX_SEQUENCERECORDER
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+#include <ORUtils/Math.h>
+
+#include <tvgutil/containers/PooledQueue.h>
+#include <tvgutil/filesystem/SequentialPathGenerator.h>
+
+#include "ImagePersister.h"
+
+namespace orx {
+
+/**
+ * \brief An instance of this class can be used to record an RGB-D sequence (with camera poses) to disk asynchronously.
+ *
+ * Each frame passed to the recorder is copied into a buffer from a fixed-size pool and added to a queue, from which a number of
+ * writer threads take frames, encode their images as PNGs and write them to disk. The buffers are reused once their frames have
+ * been written, so the memory used by the recorder is bounded. When every buffer is in use (i.e. when the writers cannot keep up
+ * with the rate at which frames are being recorded), the recorder follows an explicit policy: it either drops the new frame, or
+ * makes the caller wait for a buffer to become free. Statistics on the frames that were dropped or delayed are kept so that the
+ * caller can tell whether or not the recorder managed to keep up.
+ *
+ * Frames are numbered consecutively in the order in which they are accepted by the recorder, so a recorded sequence never has
+ * gaps in its numbering, even if some frames were dropped. The files for each frame are named frame-%06i.{color.png,depth.png,pose.txt},
+ * as for the sequences in the 7-Scenes dataset.
+ */
+class SequenceRecorder
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct contains statistics about the frames that have been passed to a sequence recorder.
+   */
+  struct Statistics
+  {
+    /** The number of frames that were accepted only after the caller had waited for a buffer to become free. */
+    size_t delayedFrameCount;
+
+    /** The number of frames that were dropped because no buffer was free. */
+    size_t droppedFrameCount;
+
+    /** The number of accepted frames that could not be written to disk. */
+    size_t failedFrameCount;
+
+    /** The longest time (in milliseconds) for which the caller had to wait for a buffer to become free. */
+    double maxDelayMs;
+
+    /** The largest number of frames that have been waiting to be written at any one time. */
+    size_t maxQueueSize;
+
+    /** The longest time (in milliseconds) between a frame being accepted and it having been written to disk. */
+    double maxWriteLatencyMs;
+
+    /** The number of frames that have been accepted by the recorder. */
+    size_t recordedFrameCount;
+
+    /** The total time (in milliseconds) for which the caller had to wait for buffers to become free. */
+    double totalDelayMs;
+
+    /** The sum of the times (in milliseconds) between the frames that have been written being accepted and them having been written to disk. */
+    double totalWriteLatencyMs;
+
+    /** The number of accepted frames that have been written to disk. */
+    size_t writtenFrameCount;
+
+    Statistics();
+  };
+
+private:
+  typedef boost::chrono::steady_clock Clock;
+
+  /**
+   * \brief An instance of this struct holds a frame that is waiting to be written to disk (or a free buffer for one).
+   */
+  struct Frame
+  {
+    /** The time at which the frame was accepted by the recorder. */
+    Clock::time_point acceptTime;
+
+    /** The path to the file to which to write the depth image. */
+    std::string depthPath;
+
+    /** The camera pose (a camera -> world transformation). */
+    Matrix4f pose;
+
+    /** The path to the file to which to write the camera pose. */
+    std::string posePath;
+
+    /** The depth image. */
+    ORShortImage_Ptr rawDepthImage;
+
+    /** The RGB image. */
+    ORUChar4Image_Ptr rgbImage;
+
+    /** The path to the file to which to write the RGB image. */
+    std::string rgbPath;
+  };
+
+  typedef boost::shared_ptr<Frame> Frame_Ptr;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The level of compression to use when encoding the images as PNGs. */
+  ImagePersister::PNGCompressionLevel m_compressionLevel;
+
+  /** Whether or not the recorder has been told to finish recording. */
+  bool m_finishing;
+
+  /** A condition variable used to signal that a frame has been written and its buffer has been returned to the pool. */
+  boost::condition_variable m_frameFreed;
+
+  /** A condition variable used to signal that a frame has been added to the queue (or that the recorder is finishing). */
+  boost::condition_variable m_frameQueued;
+
+  /** The synchronisation mutex. */
+  mutable boost::mutex m_mutex;
+
+  /** The path generator used to name the files for each frame. */
+  tvgutil::SequentialPathGenerator m_pathGenerator;
+
+  /** The buffers that are not currently in use. */
+  std::vector<Frame_Ptr> m_pool;
+
+  /** What to do when a frame is passed to the recorder and every buffer is in use. */
+  tvgutil::pooled_queue::PoolEmptyStrategy m_poolEmptyStrategy;
+
+  /** The frames that are waiting to be written to disk (in the order in which they were accepted). */
+  std::deque<Frame_Ptr> m_queue;
+
+  /** The statistics about the frames that have been passed to the recorder. */
+  Statistics m_statistics;
+
+  /** The writer threads. */
+  boost::thread_group m_writers;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a sequence recorder.
+   *
+   * \param baseDir             The directory into which to write the sequence (this must already exist).
+   * \param capacity            The number of frame buffers to allocate (i.e. the maximum number of frames that can be waiting to be written).
+   * \param writerCount         The number of writer threads to use.
+   * \param poolEmptyStrategy   What to do when a frame is passed to the recorder and every buffer is in use (either PES_DISCARD, PES_GROW or PES_WAIT).
+   * \param compressionLevel    The level of compression to use when encoding the images as PNGs.
+   * \throws std::invalid_argument  If the capacity or the number of writer threads is zero, or the pool empty strategy is PES_REPLACE_RANDOM.
+   */
+  SequenceRecorder(const boost::filesystem::path& baseDir, size_t capacity = 8, size_t writerCount = 2,
+                   tvgutil::pooled_queue::PoolEmptyStrategy poolEmptyStrategy = tvgutil::pooled_queue::PES_WAIT,
+                   ImagePersister::PNGCompressionLevel compressionLevel = ImagePersister::PCL_NONE);
+
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the sequence recorder, first waiting for any frames that are still in the queue to be written to disk.
+   */
+  ~SequenceRecorder();
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  SequenceRecorder(const SequenceRecorder&);
+  SequenceRecorder& operator=(const SequenceRecorder&);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Stops accepting frames, and waits for any frames that are still in the queue to be written to disk.
+   *
+   * \note  This may safely be called more than once.
+   */
+  void finish();
+
+  /**
+   * \brief Gets the directory into which the sequence is being written.
+   *
+   * \return  The directory into which the sequence is being written.
+   */
+  const boost::filesystem::path& get_base_dir() const;
+
+  /**
+   * \brief Gets the statistics about the frames that have been passed to the recorder so far.
+   *
+   * \return  The statistics about the frames that have been passed to the recorder so far.
+   */
+  Statistics get_statistics() const;
+
+  /**
+   * \brief Passes a frame to the recorder.
+   *
+   * The images and pose are copied before this function returns, so the caller is free to modify them afterwards.
+   *
+   * \param rgbImage                The RGB image.
+   * \param rawDepthImage           The depth image.
+   * \param pose                    The camera pose (a camera -> world transformation).
+   * \return                        true, if the frame was accepted, or false if it was dropped.
+   * \throws std::runtime_error     If the recorder has already been told to finish recording.
+   */
+  bool record_frame(const ORUChar4Image_CPtr& rgbImage, const ORShortImage_CPtr& rawDepthImage, const Matrix4f& pose);
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Runs a writer thread.
+   *
+   * The writer thread repeatedly takes a frame from the queue and writes it to disk, until the recorder is finishing and the queue is empty.
+   */
+  void run_writer();
+
+  /**
+   * \brief Writes a frame to disk.
+   *
+   * \param frame               The frame to write.
+   * \throws std::runtime_error If the frame could not be written.
+   */
+  void write_frame(const Frame& frame) const;
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<SequenceRecorder> SequenceRecorder_Ptr;
+typedef boost::shared_ptr<const SequenceRecorder> SequenceRecorder_CPtr;
+
+}
+
+#endif
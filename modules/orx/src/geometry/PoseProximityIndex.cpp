@@ -0,0 +1,170 @@
+/**
+ * orx: PoseProximityIndex.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "geometry/PoseProximityIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Geometry>
+
+namespace orx {
+
+//#################### CONSTANTS ####################
+
+/** The maximum number of poses in a leaf of the k-d tree. */
+static const size_t MAX_LEAF_SIZE = 8;
+
+//#################### CONSTRUCTORS ####################
+
+PoseProximityIndex::PoseProximityIndex(const std::vector<Eigen::Matrix4f>& poses)
+{
+  const size_t poseCount = poses.size();
+  m_rotations.reserve(poseCount);
+  m_translations.reserve(poseCount);
+
+  for(size_t i = 0; i < poseCount; ++i)
+  {
+    const Eigen::Matrix4f& pose = poses[i];
+    m_rotations.push_back(pose.block<3,3>(0,0));
+    m_translations.push_back(pose.block<3,1>(0,3));
+    if(pose.block<3,4>(0,0).allFinite()) m_order.push_back(i);
+  }
+
+  if(!m_order.empty()) build_subtree(0, m_order.size());
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+boost::optional<size_t> PoseProximityIndex::find_nearest_within(const Eigen::Matrix4f& pose, float maxTranslation, float maxAngle) const
+{
+  const std::vector<size_t> candidates = find_within(pose, maxTranslation, maxAngle);
+  const Eigen::Vector3f t = pose.block<3,1>(0,3);
+
+  // Note: The candidates are in increasing order, so using < ensures that the lowest index wins any ties.
+  boost::optional<size_t> result;
+  float bestDistance = 0.0f;
+  for(size_t i = 0, candidateCount = candidates.size(); i < candidateCount; ++i)
+  {
+    const float distance = (m_translations[candidates[i]] - t).norm();
+    if(!result || distance < bestDistance)
+    {
+      result = candidates[i];
+      bestDistance = distance;
+    }
+  }
+
+  return result;
+}
+
+std::vector<size_t> PoseProximityIndex::find_within(const Eigen::Matrix4f& pose, float maxTranslation, float maxAngle) const
+{
+  std::vector<size_t> result;
+
+  // A query pose that contains non-finite values cannot be within any distance of an indexed pose.
+  if(m_nodes.empty() || !pose.block<3,4>(0,0).allFinite()) return result;
+
+  // For a rotation, trace(R) = 1 + 2 cos(theta), so trace(r * R^T) = sum(r .* R) gives the cosine of the angle between r and R
+  // without needing to compute the angle itself. The bound is loosened slightly to allow for rounding (and for rotation matrices
+  // that are not quite orthonormal), so that it never rejects a pose that the exact test would accept.
+  const float minCosAngle = maxAngle >= static_cast<float>(M_PI) ? -2.0f : std::cos(maxAngle) - 1e-3f;
+
+  collect_within(0, pose.block<3,3>(0,0), pose.block<3,1>(0,3), maxTranslation, maxAngle, minCosAngle, result);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+size_t PoseProximityIndex::size() const
+{
+  return m_translations.size();
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+float PoseProximityIndex::angular_separation(const Eigen::Matrix3f& r1, const Eigen::Matrix3f& r2)
+{
+  // Calculate the rotation that maps r1 to r2, and return its angle.
+  const Eigen::Matrix3f dr = r2 * r1.transpose();
+  return Eigen::AngleAxisf(dr).angle();
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int PoseProximityIndex::build_subtree(size_t begin, size_t end)
+{
+  const int nodeIndex = static_cast<int>(m_nodes.size());
+  Node node;
+  node.axis = -1;
+  node.begin = begin;
+  node.end = end;
+  node.left = node.right = -1;
+  node.split = 0.0f;
+  m_nodes.push_back(node);
+
+  if(end - begin <= MAX_LEAF_SIZE) return nodeIndex;
+
+  // Split the poses along the axis on which their translations have the greatest extent.
+  Eigen::Vector3f lower = m_translations[m_order[begin]], upper = lower;
+  for(size_t i = begin + 1; i < end; ++i)
+  {
+    lower = lower.cwiseMin(m_translations[m_order[i]]);
+    upper = upper.cwiseMax(m_translations[m_order[i]]);
+  }
+
+  int axis;
+  (upper - lower).maxCoeff(&axis);
+
+  // Partition the poses about their median translation along the axis, so that the poses in [begin,mid) have coordinates
+  // <= the split and the poses in [mid,end) have coordinates >= it.
+  const size_t mid = begin + (end - begin) / 2;
+  std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end, TranslationComparator(&m_translations, axis));
+
+  const float split = m_translations[m_order[mid]][axis];
+  const int left = build_subtree(begin, mid);
+  const int right = build_subtree(mid, end);
+
+  // Note: The recursive calls may have reallocated the node array, so the node must be looked up again here.
+  Node& builtNode = m_nodes[nodeIndex];
+  builtNode.axis = axis;
+  builtNode.left = left;
+  builtNode.right = right;
+  builtNode.split = split;
+
+  return nodeIndex;
+}
+
+void PoseProximityIndex::collect_within(int nodeIndex, const Eigen::Matrix3f& r, const Eigen::Vector3f& t, float maxTranslation, float maxAngle, float minCosAngle,
+                                        std::vector<size_t>& result) const
+{
+  const Node& node = m_nodes[nodeIndex];
+
+  if(node.axis == -1)
+  {
+    for(size_t i = node.begin; i < node.end; ++i)
+    {
+      const size_t poseIndex = m_order[i];
+
+      // Note: The translation and rotation tests are performed in the same way as in a brute-force scan, so that the results are identical.
+      if((m_translations[poseIndex] - t).norm() > maxTranslation) continue;
+
+      const Eigen::Matrix3f& poseR = m_rotations[poseIndex];
+      const float cosAngle = (poseR.cwiseProduct(r).sum() - 1.0f) * 0.5f;
+      if(cosAngle < minCosAngle) continue;
+
+      if(angular_separation(poseR, r) <= maxAngle) result.push_back(poseIndex);
+    }
+  }
+  else
+  {
+    // A child can only be skipped if the query is definitely further than maxTranslation from the splitting plane on the far side
+    // of it (the slack allows for the fact that the norm computed by the exact test can be rounded down).
+    const float offset = t[node.axis] - node.split;
+    const float slack = maxTranslation * 1e-5f + 1e-6f;
+    if(offset <= maxTranslation + slack) collect_within(node.left, r, t, maxTranslation, maxAngle, minCosAngle, result);
+    if(-offset <= maxTranslation + slack) collect_within(node.right, r, t, maxTranslation, maxAngle, minCosAngle, result);
+  }
+}
+
+}
@@ -15,6 +15,51 @@
 
 namespace orx {
 
+//#################### ANONYMOUS FREE FUNCTIONS ####################
+
+namespace {
+
+/**
+ * \brief Configures a lodepng state to encode an image at the specified level of compression.
+ *
+ * \param compressionLevel  The level of compression to use.
+ * \param rawColourType     The colour type of the raw image data to be encoded.
+ * \param pngColourType     The colour type to use in the PNG (only used if the compression level is not the default).
+ * \param bitDepth          The bit depth of the raw image data (and of the PNG).
+ * \param state             The lodepng state to configure.
+ */
+void configure_png_encoder(ImagePersister::PNGCompressionLevel compressionLevel, LodePNGColorType rawColourType, LodePNGColorType pngColourType,
+                           unsigned int bitDepth, lodepng::State& state)
+{
+  state.info_raw.colortype = rawColourType;
+  state.info_raw.bitdepth = bitDepth;
+
+  // At the default level of compression, let lodepng choose the colour type of the PNG (it will
+  // pick the smallest one that can represent the image), and use its default compression settings.
+  if(compressionLevel == ImagePersister::PCL_DEFAULT) return;
+
+  // Otherwise, avoid the expensive scan of the image that lodepng uses to choose the colour type,
+  // and reduce the compression effort. Note that LZ77 matching accounts for most of the time spent
+  // encoding a PNG with lodepng, whereas a per-row filter followed by Huffman coding is cheap and
+  // still compresses smooth images such as depth images well.
+  state.encoder.auto_convert = 0;
+  state.info_png.color.colortype = pngColourType;
+  state.info_png.color.bitdepth = bitDepth;
+
+  if(compressionLevel == ImagePersister::PCL_FAST)
+  {
+    state.encoder.filter_strategy = LFS_MINSUM;
+    state.encoder.zlibsettings.use_lz77 = 0;
+  }
+  else
+  {
+    state.encoder.filter_strategy = LFS_ZERO;
+    state.encoder.zlibsettings.btype = 0;
+  }
+}
+
+}
+
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
 ORUChar4Image_Ptr ImagePersister::load_rgba_image(const std::string& path, ImageFileType fileType)
@@ -39,7 +84,35 @@ ORUChar4Image_Ptr ImagePersister::load_rgba_image(const std::string& path, Image
   }
 }
 
-void ImagePersister::save_image(const ORShortImage_CPtr& image, const std::string& path, ImageFileType fileType)
+ORShortImage_Ptr ImagePersister::load_short_image(const std::string& path, ImageFileType fileType)
+{
+  // If the image file type wasn't specified, try to deduce it.
+  if(fileType == IFT_UNKNOWN) fileType = deduce_image_file_type(path);
+
+  // Load the image in an appropriate way based on its file type.
+  switch(fileType)
+  {
+    case IFT_PGM:
+    {
+      ORShortImage_Ptr image(new ORShortImage(Vector2i(0, 0), true, true));
+      if(!ReadImageFromFile(image.get(), path.c_str())) throw std::runtime_error("Could not load PGM image from '" + path + "'");
+      return image;
+    }
+    case IFT_PNG:
+    {
+      std::vector<unsigned char> buffer;
+      lodepng::load_file(buffer, path);
+      if(buffer.empty()) throw std::runtime_error("Could not load PNG image from '" + path + "'");
+      return decode_short_png(buffer, path);
+    }
+    default:
+    {
+      throw std::runtime_error("Could not load image from '" + path + "': unsupported file type");
+    }
+  }
+}
+
+void ImagePersister::save_image(const ORShortImage_CPtr& image, const std::string& path, ImageFileType fileType, PNGCompressionLevel compressionLevel)
 {
   // If the image file type wasn't specified, try to deduce it.
   if(fileType == IFT_UNKNOWN) fileType = deduce_image_file_type(path);
@@ -55,7 +128,7 @@ void ImagePersister::save_image(const ORShortImage_CPtr& image, const std::strin
     case IFT_PNG:
     {
       std::vector<unsigned char> buffer;
-      encode_png(image, buffer);
+      encode_png(image, compressionLevel, buffer);
       lodepng::save_file(buffer, path);
       break;
     }
@@ -66,7 +139,7 @@ void ImagePersister::save_image(const ORShortImage_CPtr& image, const std::strin
   }
 }
 
-void ImagePersister::save_image(const ORUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType)
+void ImagePersister::save_image(const ORUChar4Image_CPtr& image, const std::string& path, ImageFileType fileType, PNGCompressionLevel compressionLevel)
 {
   // If the image file type wasn't specified, try to deduce it.
   if(fileType == IFT_UNKNOWN) fileType = deduce_image_file_type(path);
@@ -77,7 +150,7 @@ void ImagePersister::save_image(const ORUChar4Image_CPtr& image, const std::stri
     case IFT_PNG:
     {
       std::vector<unsigned char> buffer;
-      encode_png(image, buffer);
+      encode_png(image, compressionLevel, buffer);
       lodepng::save_file(buffer, path);
       break;
     }
@@ -127,6 +200,34 @@ ORUChar4Image_Ptr ImagePersister::decode_rgba_png(const std::vector<unsigned cha
   return image;
 }
 
+ORShortImage_Ptr ImagePersister::decode_short_png(const std::vector<unsigned char>& buffer, const std::string& path)
+{
+  // Decode the PNG (note that lodepng outputs 16-bit values in big-endian order).
+  std::vector<unsigned char> data;
+  unsigned int width, height;
+  if(lodepng::decode(data, width, height, buffer, LCT_GREY, 16) != 0)
+  {
+    throw std::runtime_error("Failed to decode PNG from '" + path + "'");
+  }
+
+  // Construct the image.
+  ORShortImage_Ptr image(new ORShortImage(Vector2i(width, height), true, true));
+  const int pixelCount = width * height;
+  const unsigned char *src = &data[0];
+  short *dest = image->GetData(MEMORYDEVICE_CPU);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    int offset = i * 2;
+    dest[i] = static_cast<short>((src[offset] << 8) | src[offset + 1]);
+  }
+
+  return image;
+}
+
 ImagePersister::ImageFileType ImagePersister::deduce_image_file_type(const std::string& path)
 {
   boost::filesystem::path bpath(path);
@@ -141,7 +242,7 @@ ImagePersister::ImageFileType ImagePersister::deduce_image_file_type(const std::
   return IFT_UNKNOWN;
 }
 
-void ImagePersister::encode_png(const ORShortImage_CPtr& image, std::vector<unsigned char>& buffer)
+void ImagePersister::encode_png(const ORShortImage_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer)
 {
   const int pixelCount = static_cast<int>(image->dataSize);
   std::vector<unsigned char> data(pixelCount * 2);
@@ -159,18 +260,21 @@ void ImagePersister::encode_png(const ORShortImage_CPtr& image, std::vector<unsi
     dest[offset + 1] = *pixel;
   }
 
-  lodepng::encode(buffer, &data[0], image->noDims.x, image->noDims.y, LCT_GREY, 16);
+  lodepng::State state;
+  configure_png_encoder(compressionLevel, LCT_GREY, LCT_GREY, 16, state);
+  lodepng::encode(buffer, &data[0], image->noDims.x, image->noDims.y, state);
 }
 
-void ImagePersister::encode_png(const ORUChar4Image_CPtr& image, std::vector<unsigned char>& buffer)
+void ImagePersister::encode_png(const ORUChar4Image_CPtr& image, PNGCompressionLevel compressionLevel, std::vector<unsigned char>& buffer)
 {
   const int pixelCount = static_cast<int>(image->dataSize);
   std::vector<unsigned char> data(pixelCount * 4);
   const Vector4u *src = image->GetData(MEMORYDEVICE_CPU);
   unsigned char *dest = &data[0];
+  int opaquePixelCount = 0;
 
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel for reduction(+:opaquePixelCount)
 #endif
   for(int i = 0; i < pixelCount; ++i)
   {
@@ -180,9 +284,13 @@ void ImagePersister::encode_png(const ORUChar4Image_CPtr& image, std::vector<uns
     dest[offset + 1] = pixel.g;
     dest[offset + 2] = pixel.b;
     dest[offset + 3] = pixel.a;
+    if(pixel.a == 255) ++opaquePixelCount;
   }
 
-  lodepng::encode(buffer, &data[0], image->noDims.x, image->noDims.y);
+  // If the image is fully opaque (as colour input images generally are), there is no need to store its alpha channel.
+  lodepng::State state;
+  configure_png_encoder(compressionLevel, LCT_RGBA, opaquePixelCount == pixelCount ? LCT_RGB : LCT_RGBA, 8, state);
+  lodepng::encode(buffer, &data[0], image->noDims.x, image->noDims.y, state);
 }
 
 }
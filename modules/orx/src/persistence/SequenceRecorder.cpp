@@ -0,0 +1,231 @@
+/**
+ * orx: SequenceRecorder.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "persistence/SequenceRecorder.h"
+using namespace tvgutil;
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include "persistence/PosePersister.h"
+
+namespace orx {
+
+//#################### CONSTRUCTORS ####################
+
+SequenceRecorder::Statistics::Statistics()
+: delayedFrameCount(0),
+  droppedFrameCount(0),
+  failedFrameCount(0),
+  maxDelayMs(0.0),
+  maxQueueSize(0),
+  maxWriteLatencyMs(0.0),
+  recordedFrameCount(0),
+  totalDelayMs(0.0),
+  totalWriteLatencyMs(0.0),
+  writtenFrameCount(0)
+{}
+
+SequenceRecorder::SequenceRecorder(const boost::filesystem::path& baseDir, size_t capacity, size_t writerCount,
+                                   pooled_queue::PoolEmptyStrategy poolEmptyStrategy, ImagePersister::PNGCompressionLevel compressionLevel)
+: m_compressionLevel(compressionLevel),
+  m_finishing(false),
+  m_pathGenerator(baseDir),
+  m_poolEmptyStrategy(poolEmptyStrategy)
+{
+  if(capacity == 0) throw std::invalid_argument("Error: A sequence recorder needs at least one frame buffer");
+  if(writerCount == 0) throw std::invalid_argument("Error: A sequence recorder needs at least one writer thread");
+
+  // Note: Replacing a random frame in the queue would leave a gap in the numbering of the recorded sequence, so we don't support it.
+  if(poolEmptyStrategy == pooled_queue::PES_REPLACE_RANDOM)
+  {
+    throw std::invalid_argument("Error: A sequence recorder cannot replace frames that have already been accepted");
+  }
+
+  // Allocate the frame buffers up-front. The images themselves are allocated when the first frame is recorded (and
+  // only reallocated if the image sizes change), so that the recorder does not need to know the image sizes in advance.
+  for(size_t i = 0; i < capacity; ++i)
+  {
+    m_pool.push_back(Frame_Ptr(new Frame));
+  }
+
+  // Start the writer threads.
+  for(size_t i = 0; i < writerCount; ++i)
+  {
+    m_writers.create_thread(boost::bind(&SequenceRecorder::run_writer, this));
+  }
+}
+
+//#################### DESTRUCTOR ####################
+
+SequenceRecorder::~SequenceRecorder()
+{
+  finish();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void SequenceRecorder::finish()
+{
+  // Tell the writer threads to terminate once the queue is empty, and wait for them to do so.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_finishing = true;
+  }
+  m_frameQueued.notify_all();
+  m_writers.join_all();
+
+  // Wake up any caller that is still waiting for a buffer to become free, so that it can report the error.
+  m_frameFreed.notify_all();
+}
+
+const boost::filesystem::path& SequenceRecorder::get_base_dir() const
+{
+  return m_pathGenerator.get_base_dir();
+}
+
+SequenceRecorder::Statistics SequenceRecorder::get_statistics() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_statistics;
+}
+
+bool SequenceRecorder::record_frame(const ORUChar4Image_CPtr& rgbImage, const ORShortImage_CPtr& rawDepthImage, const Matrix4f& pose)
+{
+  Frame_Ptr frame;
+
+  // Try to obtain a free buffer, following the pool empty strategy if there are none.
+  {
+    boost::unique_lock<boost::mutex> lock(m_mutex);
+    if(m_finishing) throw std::runtime_error("Error: Cannot record a frame once a sequence recorder has been told to finish");
+
+    if(m_pool.empty())
+    {
+      switch(m_poolEmptyStrategy)
+      {
+        case pooled_queue::PES_DISCARD:
+        {
+          ++m_statistics.droppedFrameCount;
+          return false;
+        }
+        case pooled_queue::PES_GROW:
+        {
+          m_pool.push_back(Frame_Ptr(new Frame));
+          break;
+        }
+        case pooled_queue::PES_WAIT:
+        {
+          const Clock::time_point waitStart = Clock::now();
+          while(m_pool.empty() && !m_finishing) m_frameFreed.wait(lock);
+          if(m_finishing) throw std::runtime_error("Error: A sequence recorder was told to finish while a frame was waiting to be recorded");
+
+          const double delayMs = boost::chrono::duration<double,boost::milli>(Clock::now() - waitStart).count();
+          ++m_statistics.delayedFrameCount;
+          m_statistics.maxDelayMs = std::max(m_statistics.maxDelayMs, delayMs);
+          m_statistics.totalDelayMs += delayMs;
+          break;
+        }
+        default:
+        {
+          // This should never happen.
+          throw std::runtime_error("Error: Unknown pool empty strategy");
+        }
+      }
+    }
+
+    frame = m_pool.back();
+    m_pool.pop_back();
+
+    // Assign the frame the next number in the sequence. We do this only once the frame has been accepted,
+    // so that frames that are dropped do not leave gaps in the numbering of the recorded sequence.
+    frame->depthPath = m_pathGenerator.make_path("frame-%06i.depth.png").string();
+    frame->posePath = m_pathGenerator.make_path("frame-%06i.pose.txt").string();
+    frame->rgbPath = m_pathGenerator.make_path("frame-%06i.color.png").string();
+    m_pathGenerator.increment_index();
+    ++m_statistics.recordedFrameCount;
+  }
+
+  // Copy the frame into the buffer. No other thread can access the buffer until it is added to the queue, so this can safely be done without the lock.
+  frame->acceptTime = Clock::now();
+  frame->pose = pose;
+
+  if(!frame->rgbImage) frame->rgbImage.reset(new ORUChar4Image(rgbImage->noDims, true, false));
+  frame->rgbImage->ChangeDims(rgbImage->noDims);
+  frame->rgbImage->SetFrom(rgbImage.get(), ORUChar4Image::CPU_TO_CPU);
+
+  if(!frame->rawDepthImage) frame->rawDepthImage.reset(new ORShortImage(rawDepthImage->noDims, true, false));
+  frame->rawDepthImage->ChangeDims(rawDepthImage->noDims);
+  frame->rawDepthImage->SetFrom(rawDepthImage.get(), ORShortImage::CPU_TO_CPU);
+
+  // Add the frame to the queue, and wake up a writer thread to write it.
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    m_queue.push_back(frame);
+    m_statistics.maxQueueSize = std::max(m_statistics.maxQueueSize, m_queue.size());
+  }
+  m_frameQueued.notify_one();
+
+  return true;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void SequenceRecorder::run_writer()
+{
+  for(;;)
+  {
+    Frame_Ptr frame;
+
+    // Wait until there is a frame to write, or until the recorder is finishing and there are no more frames to write.
+    {
+      boost::unique_lock<boost::mutex> lock(m_mutex);
+      while(m_queue.empty() && !m_finishing) m_frameQueued.wait(lock);
+      if(m_queue.empty()) return;
+
+      frame = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    // Write the frame to disk. If this fails, report the error and carry on, so that one bad frame does not stop the recording.
+    bool succeeded = true;
+    try
+    {
+      write_frame(*frame);
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << "Warning: Could not write frame to '" << frame->rgbPath << "': " << e.what() << '\n';
+      succeeded = false;
+    }
+
+    // Update the statistics and return the buffer to the pool.
+    {
+      boost::lock_guard<boost::mutex> lock(m_mutex);
+      if(succeeded)
+      {
+        const double latencyMs = boost::chrono::duration<double,boost::milli>(Clock::now() - frame->acceptTime).count();
+        ++m_statistics.writtenFrameCount;
+        m_statistics.maxWriteLatencyMs = std::max(m_statistics.maxWriteLatencyMs, latencyMs);
+        m_statistics.totalWriteLatencyMs += latencyMs;
+      }
+      else ++m_statistics.failedFrameCount;
+
+      m_pool.push_back(frame);
+    }
+    m_frameFreed.notify_one();
+  }
+}
+
+void SequenceRecorder::write_frame(const Frame& frame) const
+{
+  ImagePersister::save_image(frame.rawDepthImage, frame.depthPath, ImagePersister::IFT_PNG, m_compressionLevel);
+  ImagePersister::save_image(frame.rgbImage, frame.rgbPath, ImagePersister::IFT_PNG, m_compressionLevel);
+  PosePersister::save_pose(frame.pose, frame.posePath);
+}
+
+}
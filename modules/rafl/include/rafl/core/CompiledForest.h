@@ -0,0 +1,567 @@
+/**
+ * rafl: CompiledForest.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2015. All rights reserved.
+ */
+
+#ifndef H_RAFL_COMPILEDFOREST
+#define H_RAFL_COMPILEDFOREST
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "RandomForest.h"
+#include "../decisionfunctions/FeatureThresholdingDecisionFunction.h"
+#include "../decisionfunctions/PairwiseOpAndThresholdDecisionFunction.h"
+
+namespace rafl {
+
+/**
+ * \brief An instance of an instantiation of this class template represents an immutable, flattened version of a trained random forest.
+ *
+ * A compiled forest stores the nodes of all of its trees in a single contiguous array of tagged structs, with the children
+ * of each split node stored next to each other. Each leaf refers to a row of a dense table containing the masses of its PMF.
+ * This avoids the pointer chasing and virtual calls needed to traverse the live forest, and allows the forest to be saved
+ * and loaded as a single binary blob. Compiled forests produce exactly the same predictions as the forests from which they
+ * were compiled, but cannot be trained any further.
+ */
+template <typename Label>
+class CompiledForest
+{
+  //#################### ENUMERATIONS ####################
+private:
+  /**
+   * \brief The different types of node that can appear in a compiled forest.
+   */
+  enum NodeType
+  {
+    /** A leaf node. */
+    NT_LEAF,
+
+    /** A split node that compares a single feature against a threshold. */
+    NT_FEATURE_THRESHOLD,
+
+    /** A split node that compares the sum of two features against a threshold. */
+    NT_PAIRWISE_ADD,
+
+    /** A split node that compares the difference of two features against a threshold. */
+    NT_PAIRWISE_SUBTRACT
+  };
+
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents a node in a compiled forest.
+   */
+  struct Node
+  {
+    /** The type of the node (see NodeType). */
+    int type;
+
+    /** The index of the (first) feature tested by the node (split nodes only). */
+    int firstFeatureIndex;
+
+    /** The index of the second feature tested by the node (pairwise split nodes only). */
+    int secondFeatureIndex;
+
+    /** The threshold against which the node compares its feature value (split nodes only). */
+    float threshold;
+
+    /** For split nodes, the index of the node's left child (its right child immediately follows it); for leaves, the index of the leaf's row in the PMF table. */
+    int childIndex;
+  };
+
+  //#################### TYPEDEFS ####################
+public:
+  typedef boost::shared_ptr<CompiledForest<Label> > CompiledForest_Ptr;
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The labels corresponding to the columns of the PMF table (in ascending order). */
+  std::vector<Label> m_labels;
+
+  /** The PMF table, containing one row of label masses for each leaf in the forest. */
+  std::vector<float> m_leafMasses;
+
+  /** The nodes of all the trees in the forest. */
+  std::vector<Node> m_nodes;
+
+  /** The minimum number of features that each descriptor passed to the forest must have. */
+  size_t m_requiredFeatureCount;
+
+  /** The indices of the root nodes of the trees in the node array. */
+  std::vector<int> m_rootIndices;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Compiles the specified random forest.
+   *
+   * \param forest              The random forest to compile.
+   * \throws std::runtime_error If the forest is not valid or uses a decision function that cannot be compiled.
+   */
+  explicit CompiledForest(const RandomForest<Label>& forest)
+  {
+    if(!forest.is_valid()) throw std::runtime_error("Error: Cannot compile a forest that has not yet been trained");
+
+    // Build up the PMFs for all of the leaves in the forest, and flatten the trees as we go.
+    std::vector<std::map<Label,float> > leafPMFs;
+    std::set<Label> labels;
+    for(size_t treeIndex = 0, treeCount = forest.get_tree_count(); treeIndex < treeCount; ++treeIndex)
+    {
+      m_rootIndices.push_back(static_cast<int>(m_nodes.size()));
+      compile_tree(*forest.get_tree(treeIndex), leafPMFs, labels);
+    }
+
+    // Convert the leaf PMFs to a dense table whose columns are ordered by label.
+    m_labels.assign(labels.begin(), labels.end());
+    const size_t labelCount = m_labels.size();
+    m_leafMasses.resize(leafPMFs.size() * labelCount, 0.0f);
+    for(size_t leafIndex = 0, leafCount = leafPMFs.size(); leafIndex < leafCount; ++leafIndex)
+    {
+      for(typename std::map<Label,float>::const_iterator it = leafPMFs[leafIndex].begin(), iend = leafPMFs[leafIndex].end(); it != iend; ++it)
+      {
+        size_t labelIndex = std::lower_bound(m_labels.begin(), m_labels.end(), it->first) - m_labels.begin();
+        m_leafMasses[leafIndex * labelCount + labelIndex] = it->second;
+      }
+    }
+
+    m_requiredFeatureCount = compute_required_feature_count();
+  }
+
+private:
+  /**
+   * \brief Constructs an empty compiled forest.
+   *
+   * Note: This constructor is needed for loading and should not be used otherwise.
+   */
+  CompiledForest()
+  : m_requiredFeatureCount(0)
+  {}
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Loads a compiled forest from a binary file.
+   *
+   * \param filename            The name of the file.
+   * \return                    The compiled forest.
+   * \throws std::runtime_error If the compiled forest cannot be loaded.
+   */
+  static CompiledForest_Ptr load_from_file(const std::string& filename)
+  {
+    std::ifstream fs(filename.c_str(), std::ios::binary);
+    if(!fs) throw std::runtime_error("Error: Could not open compiled forest file '" + filename + "' for reading");
+
+    char magic[sizeof(MAGIC)];
+    fs.read(magic, sizeof(MAGIC));
+    int labelSize = 0, labelCount = 0, nodeCount = 0, treeCount = 0;
+    read_pod(fs, labelSize);
+    read_pod(fs, labelCount);
+    read_pod(fs, treeCount);
+    read_pod(fs, nodeCount);
+    if(!fs || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || labelSize != static_cast<int>(sizeof(Label)))
+    {
+      throw std::runtime_error("Error: '" + filename + "' is not a compatible compiled forest file");
+    }
+
+    CompiledForest_Ptr forest(new CompiledForest);
+    read_array(fs, forest->m_labels, labelCount);
+    read_array(fs, forest->m_rootIndices, treeCount);
+    read_array(fs, forest->m_nodes, nodeCount);
+
+    int leafCount = 0;
+    read_pod(fs, leafCount);
+    if(!fs || leafCount < 0 || labelCount <= 0) throw std::runtime_error("Error: Could not read compiled forest from '" + filename + "'");
+    read_array(fs, forest->m_leafMasses, static_cast<size_t>(leafCount) * static_cast<size_t>(labelCount));
+    if(!fs) throw std::runtime_error("Error: Could not read compiled forest from '" + filename + "'");
+
+    // Check that the forest is internally consistent, so that a corrupt file cannot cause out-of-bounds accesses during prediction.
+    if(!forest->is_consistent(leafCount)) throw std::runtime_error("Error: '" + filename + "' contains an inconsistent compiled forest");
+    forest->m_requiredFeatureCount = forest->compute_required_feature_count();
+
+    return forest;
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the number of nodes in the compiled forest.
+   *
+   * \return  The number of nodes in the compiled forest.
+   */
+  size_t get_node_count() const
+  {
+    return m_nodes.size();
+  }
+
+  /**
+   * \brief Gets the minimum number of features that each descriptor passed to the compiled forest must have.
+   *
+   * \return The minimum number of features that each descriptor passed to the compiled forest must have.
+   */
+  size_t get_required_feature_count() const
+  {
+    return m_requiredFeatureCount;
+  }
+
+  /**
+   * \brief Gets the number of trees in the compiled forest.
+   *
+   * \return  The number of trees in the compiled forest.
+   */
+  size_t get_tree_count() const
+  {
+    return m_rootIndices.size();
+  }
+
+  /**
+   * \brief Predicts a label for the descriptor whose features are stored contiguously at the specified location.
+   *
+   * \param features    A pointer to the features of the descriptor (there must be at least get_required_feature_count() of them).
+   * \param confidence  An optional location into which to write the forest's probability for the predicted label.
+   * \return            The predicted label.
+   */
+  Label predict(const float *features, float *confidence = NULL) const
+  {
+    std::vector<float> masses(m_labels.size());
+    return predict_using_buffer(features, &masses[0], confidence);
+  }
+
+  /**
+   * \brief Predicts labels for a batch of descriptors whose features are stored contiguously in row-major order (one descriptor per row).
+   *
+   * \param features        A pointer to the features of the descriptors.
+   * \param descriptorCount The number of descriptors.
+   * \param featureCount    The number of features in each descriptor.
+   * \param labels          An output array (of size descriptorCount) into which to write the predicted labels.
+   * \param confidences     An optional output array (of size descriptorCount) into which to write the forest's probability for each predicted label.
+   * \throws std::runtime_error If the descriptors have fewer features than the forest requires.
+   */
+  void predict_batch(const float *features, size_t descriptorCount, size_t featureCount, Label *labels, float *confidences = NULL) const
+  {
+    if(featureCount < m_requiredFeatureCount) throw std::runtime_error("Error: The descriptors have fewer features than the compiled forest requires");
+
+    const int labelCount = static_cast<int>(m_labels.size());
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel
+#endif
+    {
+      std::vector<float> masses(labelCount);
+
+#ifdef WITH_OPENMP
+      #pragma omp for
+#endif
+      for(int i = 0; i < static_cast<int>(descriptorCount); ++i)
+      {
+        labels[i] = predict_using_buffer(features + i * featureCount, &masses[0], confidences ? &confidences[i] : NULL);
+      }
+    }
+  }
+
+  /**
+   * \brief Saves the compiled forest to a binary file.
+   *
+   * \param filename            The name of the file.
+   * \throws std::runtime_error If the compiled forest cannot be saved.
+   */
+  void save_to_file(const std::string& filename) const
+  {
+    std::ofstream fs(filename.c_str(), std::ios::binary);
+    if(!fs) throw std::runtime_error("Error: Could not open compiled forest file '" + filename + "' for writing");
+
+    fs.write(MAGIC, sizeof(MAGIC));
+    write_pod(fs, static_cast<int>(sizeof(Label)));
+    write_pod(fs, static_cast<int>(m_labels.size()));
+    write_pod(fs, static_cast<int>(m_rootIndices.size()));
+    write_pod(fs, static_cast<int>(m_nodes.size()));
+    write_array(fs, m_labels);
+    write_array(fs, m_rootIndices);
+    write_array(fs, m_nodes);
+    write_pod(fs, static_cast<int>(m_labels.empty() ? 0 : m_leafMasses.size() / m_labels.size()));
+    write_array(fs, m_leafMasses);
+
+    if(!fs) throw std::runtime_error("Error: Could not write compiled forest to '" + filename + "'");
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Flattens the specified decision tree and appends its nodes to the node array.
+   *
+   * The tree is flattened breadth-first, so that the two children of each split node end up next to each other.
+   *
+   * \param tree      The decision tree to flatten.
+   * \param leafPMFs  The PMFs of the leaves that have been flattened so far (the PMFs of the tree's leaves will be appended to this).
+   * \param labels    The set of labels mentioned by the PMFs of the leaves that have been flattened so far (will be updated).
+   */
+  void compile_tree(const DecisionTree<Label>& tree, std::vector<std::map<Label,float> >& leafPMFs, std::set<Label>& labels)
+  {
+    // The original indices of the nodes in the order in which they are added to the node array.
+    std::vector<int> originalIndices(1, tree.get_root_index());
+    const int baseIndex = static_cast<int>(m_nodes.size());
+
+    for(size_t i = 0; i < originalIndices.size(); ++i)
+    {
+      const int originalIndex = originalIndices[i];
+      Node n;
+      n.firstFeatureIndex = n.secondFeatureIndex = -1;
+      n.threshold = 0.0f;
+
+      if(tree.is_leaf(originalIndex))
+      {
+        n.type = NT_LEAF;
+        n.childIndex = static_cast<int>(leafPMFs.size());
+        leafPMFs.push_back(tree.get_leaf_pmf(originalIndex).get_masses());
+        for(typename std::map<Label,float>::const_iterator it = leafPMFs.back().begin(), iend = leafPMFs.back().end(); it != iend; ++it)
+        {
+          labels.insert(it->first);
+        }
+      }
+      else
+      {
+        set_split_parameters(*tree.get_splitter(originalIndex), n);
+        n.childIndex = baseIndex + static_cast<int>(originalIndices.size());
+        originalIndices.push_back(tree.get_left_child_index(originalIndex));
+        originalIndices.push_back(tree.get_right_child_index(originalIndex));
+      }
+
+      m_nodes.push_back(n);
+    }
+  }
+
+  /**
+   * \brief Computes the minimum number of features that each descriptor passed to the compiled forest must have.
+   *
+   * \return The minimum number of features that each descriptor passed to the compiled forest must have.
+   */
+  size_t compute_required_feature_count() const
+  {
+    int maxFeatureIndex = -1;
+    for(size_t i = 0, size = m_nodes.size(); i < size; ++i)
+    {
+      maxFeatureIndex = std::max(maxFeatureIndex, std::max(m_nodes[i].firstFeatureIndex, m_nodes[i].secondFeatureIndex));
+    }
+    return static_cast<size_t>(maxFeatureIndex + 1);
+  }
+
+  /**
+   * \brief Checks whether or not all of the indices in the compiled forest refer to valid nodes, leaves and features.
+   *
+   * As well as being in range, the children of each split node must come after it in the node array. This holds for
+   * every forest we compile (since the trees are flattened breadth-first), and guarantees that traversal terminates.
+   *
+   * \param leafCount The number of rows in the PMF table.
+   * \return          true, if the compiled forest is consistent, or false otherwise.
+   */
+  bool is_consistent(int leafCount) const
+  {
+    const int nodeCount = static_cast<int>(m_nodes.size());
+    if(m_labels.empty() || m_rootIndices.empty() || m_leafMasses.size() != static_cast<size_t>(leafCount) * m_labels.size()) return false;
+
+    for(size_t i = 0, size = m_rootIndices.size(); i < size; ++i)
+    {
+      if(m_rootIndices[i] < 0 || m_rootIndices[i] >= nodeCount) return false;
+    }
+
+    for(int i = 0; i < nodeCount; ++i)
+    {
+      const Node& n = m_nodes[i];
+      switch(n.type)
+      {
+        case NT_LEAF:
+          if(n.childIndex < 0 || n.childIndex >= leafCount) return false;
+          break;
+        case NT_FEATURE_THRESHOLD:
+        case NT_PAIRWISE_ADD:
+        case NT_PAIRWISE_SUBTRACT:
+          if(n.firstFeatureIndex < 0 || (n.type != NT_FEATURE_THRESHOLD && n.secondFeatureIndex < 0)) return false;
+          if(n.childIndex <= i || n.childIndex >= nodeCount - 1) return false;
+          break;
+        default:
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * \brief Predicts a label for the descriptor whose features are stored contiguously at the specified location.
+   *
+   * The per-label masses are summed over the trees in tree order and normalised in label order, so that the result
+   * is exactly the same as that computed by RandomForest::predict.
+   *
+   * \param features    A pointer to the features of the descriptor.
+   * \param masses      A scratch buffer (with one element per label) in which to accumulate the label masses.
+   * \param confidence  An optional location into which to write the forest's probability for the predicted label.
+   * \return            The predicted label.
+   */
+  Label predict_using_buffer(const float *features, float *masses, float *confidence) const
+  {
+    const int labelCount = static_cast<int>(m_labels.size());
+    std::fill(masses, masses + labelCount, 0.0f);
+
+    for(size_t treeIndex = 0, treeCount = m_rootIndices.size(); treeIndex < treeCount; ++treeIndex)
+    {
+      // Find the leaf reached by the descriptor in this tree.
+      const Node *n = &m_nodes[m_rootIndices[treeIndex]];
+      while(n->type != NT_LEAF)
+      {
+        float value;
+        switch(n->type)
+        {
+          case NT_FEATURE_THRESHOLD:
+            value = features[n->firstFeatureIndex];
+            break;
+          case NT_PAIRWISE_ADD:
+            value = features[n->firstFeatureIndex] + features[n->secondFeatureIndex];
+            break;
+          default:
+            value = features[n->firstFeatureIndex] - features[n->secondFeatureIndex];
+            break;
+        }
+
+        n = &m_nodes[value < n->threshold ? n->childIndex : n->childIndex + 1];
+      }
+
+      // Add the leaf's masses to the running totals.
+      const float *leafMasses = &m_leafMasses[n->childIndex * labelCount];
+      for(int k = 0; k < labelCount; ++k) masses[k] += leafMasses[k];
+    }
+
+    // Normalise the masses and pick the first label with the highest mass.
+    float sum = 0.0f;
+    for(int k = 0; k < labelCount; ++k) sum += masses[k];
+
+    int bestK = 0;
+    float bestMass = masses[0] / sum;
+    for(int k = 1; k < labelCount; ++k)
+    {
+      float mass = masses[k] / sum;
+      if(mass > bestMass)
+      {
+        bestK = k;
+        bestMass = mass;
+      }
+    }
+
+    if(confidence) *confidence = bestMass;
+    return m_labels[bestK];
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Reads an array of plain-old-data values from a binary stream.
+   *
+   * \param is                  The stream.
+   * \param arr                 The array into which to read the values.
+   * \param size                The number of values to read.
+   * \throws std::runtime_error If the size is negative, or the stream does not contain enough data.
+   */
+  template <typename T>
+  static void read_array(std::istream& is, std::vector<T>& arr, int size)
+  {
+    if(size < 0) throw std::runtime_error("Error: Invalid array size in compiled forest file");
+    read_array(is, arr, static_cast<size_t>(size));
+  }
+
+  /**
+   * \brief Reads an array of plain-old-data values from a binary stream.
+   *
+   * \param is                  The stream.
+   * \param arr                 The array into which to read the values.
+   * \param size                The number of values to read.
+   * \throws std::runtime_error If the stream does not contain enough data.
+   */
+  template <typename T>
+  static void read_array(std::istream& is, std::vector<T>& arr, size_t size)
+  {
+    // Check that the stream contains enough data before allocating the array, so that a corrupt size cannot trigger a huge allocation.
+    const std::streampos pos = is.tellg();
+    is.seekg(0, std::ios::end);
+    const std::streamoff remaining = is.tellg() - pos;
+    is.seekg(pos);
+    if(!is || size > static_cast<size_t>(remaining) / sizeof(T)) throw std::runtime_error("Error: Truncated compiled forest file");
+
+    arr.resize(size);
+    if(size > 0) is.read(reinterpret_cast<char*>(&arr[0]), size * sizeof(T));
+  }
+
+  /**
+   * \brief Reads a plain-old-data value from a binary stream.
+   *
+   * \param is    The stream.
+   * \param value The variable into which to read the value.
+   */
+  template <typename T>
+  static void read_pod(std::istream& is, T& value)
+  {
+    is.read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+
+  /**
+   * \brief Sets the split parameters of a compiled node based on the decision function used by the original node.
+   *
+   * \param splitter            The decision function used by the original node.
+   * \param n                   The compiled node.
+   * \throws std::runtime_error If the decision function is of a type that cannot be compiled.
+   */
+  static void set_split_parameters(const DecisionFunction& splitter, Node& n)
+  {
+    if(const FeatureThresholdingDecisionFunction *ftdf = dynamic_cast<const FeatureThresholdingDecisionFunction*>(&splitter))
+    {
+      n.type = NT_FEATURE_THRESHOLD;
+      n.firstFeatureIndex = static_cast<int>(ftdf->get_feature_index());
+      n.threshold = ftdf->get_threshold();
+    }
+    else if(const PairwiseOpAndThresholdDecisionFunction *potdf = dynamic_cast<const PairwiseOpAndThresholdDecisionFunction*>(&splitter))
+    {
+      n.type = potdf->get_op() == PairwiseOpAndThresholdDecisionFunction::PO_ADD ? NT_PAIRWISE_ADD : NT_PAIRWISE_SUBTRACT;
+      n.firstFeatureIndex = static_cast<int>(potdf->get_first_feature_index());
+      n.secondFeatureIndex = static_cast<int>(potdf->get_second_feature_index());
+      n.threshold = potdf->get_threshold();
+    }
+    else throw std::runtime_error("Error: Cannot compile a forest containing an unknown type of decision function");
+  }
+
+  /**
+   * \brief Writes an array of plain-old-data values to a binary stream.
+   *
+   * \param os  The stream.
+   * \param arr The array of values to write.
+   */
+  template <typename T>
+  static void write_array(std::ostream& os, const std::vector<T>& arr)
+  {
+    if(!arr.empty()) os.write(reinterpret_cast<const char*>(&arr[0]), arr.size() * sizeof(T));
+  }
+
+  /**
+   * \brief Writes a plain-old-data value to a binary stream.
+   *
+   * \param os    The stream.
+   * \param value The value to write.
+   */
+  template <typename T>
+  static void write_pod(std::ostream& os, const T& value)
+  {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  //#################### PRIVATE STATIC VARIABLES ####################
+private:
+  /** The magic number at the start of a compiled forest file. */
+  static const char MAGIC[8];
+};
+
+//#################### STATIC VARIABLE DEFINITIONS ####################
+
+template <typename Label>
+const char CompiledForest<Label>::MAGIC[8] = { 'R', 'A', 'F', 'L', 'C', 'F', '0', '1' };
+
+}
+
+#endif
@@ -6,6 +6,7 @@
 #ifndef H_RAFL_DECISIONTREE
 #define H_RAFL_DECISIONTREE
 
+#include <algorithm>
 #include <set>
 #include <stdexcept>
 
@@ -380,6 +381,44 @@ public:
     return totalLeafEntropy / leafCount;
   }
 
+  /**
+   * \brief Finds the indices of the leaves to which examples with the specified descriptors would currently be added.
+   *
+   * The descriptors are expected to be stored contiguously in row-major order (one descriptor per row). The batch is
+   * traversed breadth-first: on each pass, every descriptor that has not yet reached a leaf descends by one level, and
+   * the descriptors that have reached leaves are dropped from the list of those still active. This keeps the nodes of
+   * each level of the tree hot in the cache while the whole batch passes through them.
+   *
+   * \param features        A pointer to the features of the descriptors.
+   * \param descriptorCount The number of descriptors.
+   * \param featureCount    The number of features in each descriptor.
+   * \param leafIndices     An output array (of size descriptorCount) into which to write the leaf indices.
+   */
+  void find_leaves(const float *features, size_t descriptorCount, size_t featureCount, int *leafIndices) const
+  {
+    // Start all of the descriptors at the root, and make them all active unless the root is itself a leaf.
+    std::fill(leafIndices, leafIndices + descriptorCount, m_rootIndex);
+    if(is_leaf(m_rootIndex)) return;
+
+    std::vector<size_t> active(descriptorCount);
+    for(size_t i = 0; i < descriptorCount; ++i) active[i] = i;
+
+    while(!active.empty())
+    {
+      // Move each active descriptor down one level, keeping only those that have not yet reached a leaf.
+      size_t activeCount = 0;
+      for(size_t j = 0, size = active.size(); j < size; ++j)
+      {
+        const size_t i = active[j];
+        const Node& n = *m_nodes[leafIndices[i]];
+        const int childIndex = n.m_splitter->classify_features(features + i * featureCount) == DecisionFunction::DC_LEFT ? n.m_leftChildIndex : n.m_rightChildIndex;
+        leafIndices[i] = childIndex;
+        if(!is_leaf(childIndex)) active[activeCount++] = i;
+      }
+      active.resize(activeCount);
+    }
+  }
+
   /**
    * \brief Gets a histogram holding the class frequencies observed in the training data.
    *
@@ -390,6 +429,28 @@ public:
     return m_classFrequencies;
   }
 
+  /**
+   * \brief Gets the probability mass function for the specified leaf.
+   *
+   * \param leafIndex The index of the leaf.
+   * \return          The probability mass function for the leaf.
+   */
+  tvgutil::ProbabilityMassFunction<Label> get_leaf_pmf(int leafIndex) const
+  {
+    return make_pmf(leafIndex);
+  }
+
+  /**
+   * \brief Gets the index of the left child of the specified node.
+   *
+   * \param nodeIndex The index of the node.
+   * \return          The index of the node's left child (or -1 if the node is a leaf).
+   */
+  int get_left_child_index(int nodeIndex) const
+  {
+    return m_nodes[nodeIndex]->m_leftChildIndex;
+  }
+
   /**
    * \brief Gets the number of nodes in the tree.
    *
@@ -400,6 +461,38 @@ public:
     return m_nodes.size();
   }
 
+  /**
+   * \brief Gets the index of the right child of the specified node.
+   *
+   * \param nodeIndex The index of the node.
+   * \return          The index of the node's right child (or -1 if the node is a leaf).
+   */
+  int get_right_child_index(int nodeIndex) const
+  {
+    return m_nodes[nodeIndex]->m_rightChildIndex;
+  }
+
+  /**
+   * \brief Gets the index of the root node in the tree.
+   *
+   * \return  The index of the root node in the tree.
+   */
+  int get_root_index() const
+  {
+    return m_rootIndex;
+  }
+
+  /**
+   * \brief Gets the decision function used to split the specified node.
+   *
+   * \param nodeIndex The index of the node.
+   * \return          The decision function used to split the node (or null if the node is a leaf).
+   */
+  DecisionFunction_CPtr get_splitter(int nodeIndex) const
+  {
+    return m_nodes[nodeIndex]->m_splitter;
+  }
+
   /**
    * \brief Gets the depth of the tree.
    *
@@ -410,6 +503,17 @@ public:
     return m_treeDepth;
   }
 
+  /**
+   * \brief Returns whether or not the specified node is a leaf.
+   *
+   * \param nodeIndex  The index of the node.
+   * \return           true, if the specified node is a leaf, or false otherwise.
+   */
+  bool is_leaf(int nodeIndex) const
+  {
+    return m_nodes[nodeIndex]->m_leftChildIndex == -1;
+  }
+
   /**
    * \brief Gets whether or not the tree is valid.
    *
@@ -591,17 +695,6 @@ private:
     return curIndex;
   }
 
-  /**
-   * \brief Returns whether or not the specified node is a leaf.
-   *
-   * \param nodeIndex  The index of the node.
-   * \return           true, if the specified node is a leaf, or false otherwise.
-   */
-  bool is_leaf(int nodeIndex) const
-  {
-    return m_nodes[nodeIndex]->m_leftChildIndex == -1;
-  }
-
   /**
    * \brief Makes a probability mass function for the specified leaf.
    *
@@ -6,6 +6,8 @@
 #ifndef H_RAFL_RANDOMFOREST
 #define H_RAFL_RANDOMFOREST
 
+#include <algorithm>
+
 #include "DecisionTree.h"
 
 namespace rafl {
@@ -198,6 +200,126 @@ public:
     return calculate_pmf(descriptor).calculate_best_label();
   }
 
+  /**
+   * \brief Predicts labels for a batch of descriptors whose features are stored contiguously in row-major order (one descriptor per row).
+   *
+   * This produces the same labels as calling predict() on each descriptor individually, but avoids the need to wrap each
+   * descriptor in a separate heap-allocated object and only constructs a PMF once for each distinct leaf that is reached.
+   * The descriptors are split into chunks, and each chunk is passed through each tree breadth-first (see DecisionTree::find_leaves).
+   *
+   * \param features        A pointer to the features of the descriptors.
+   * \param descriptorCount The number of descriptors.
+   * \param featureCount    The number of features in each descriptor.
+   * \param labels          An output array (of size descriptorCount) into which to write the predicted labels.
+   * \param confidences     An optional output array (of size descriptorCount) into which to write the forest's probability for each predicted label.
+   */
+  void predict_batch(const float *features, size_t descriptorCount, size_t featureCount, Label *labels, float *confidences = NULL) const
+  {
+    const int treeCount = static_cast<int>(m_trees.size());
+    if(descriptorCount == 0 || treeCount == 0) return;
+
+    // Find the leaf reached by each descriptor in each tree, traversing each (tree, chunk) pair level by level.
+    std::vector<int> leafIndices(treeCount * descriptorCount);
+    const int chunkSize = 1024;
+    const int chunksPerTree = static_cast<int>((descriptorCount + chunkSize - 1) / chunkSize);
+    const int jobCount = treeCount * chunksPerTree;
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int job = 0; job < jobCount; ++job)
+    {
+      const int treeIndex = job / chunksPerTree;
+      const size_t begin = static_cast<size_t>(job % chunksPerTree) * chunkSize;
+      const size_t count = std::min<size_t>(chunkSize, descriptorCount - begin);
+      m_trees[treeIndex]->find_leaves(features + begin * featureCount, count, featureCount, &leafIndices[treeIndex * descriptorCount + begin]);
+    }
+
+    // Construct a PMF for each distinct (tree, leaf) pair that was reached, and collect the labels they mention.
+    std::vector<std::vector<int> > leafSlots(treeCount);
+    std::vector<std::map<Label,float> > slotMasses;
+    std::map<Label,int> labelIndices;
+    for(int treeIndex = 0; treeIndex < treeCount; ++treeIndex)
+    {
+      const DT& tree = *m_trees[treeIndex];
+      std::vector<int>& slots = leafSlots[treeIndex];
+      slots.resize(tree.get_node_count(), -1);
+
+      int *treeLeafIndices = &leafIndices[treeIndex * descriptorCount];
+      for(size_t i = 0; i < descriptorCount; ++i)
+      {
+        int& slot = slots[treeLeafIndices[i]];
+        if(slot == -1)
+        {
+          slot = static_cast<int>(slotMasses.size());
+          slotMasses.push_back(tree.get_leaf_pmf(treeLeafIndices[i]).get_masses());
+          for(typename std::map<Label,float>::const_iterator it = slotMasses.back().begin(), iend = slotMasses.back().end(); it != iend; ++it)
+          {
+            labelIndices.insert(std::make_pair(it->first, 0));
+          }
+        }
+
+        // Replace the leaf index with its slot so that the masses can be looked up directly later.
+        treeLeafIndices[i] = slot;
+      }
+    }
+
+    // Assign dense indices to the labels in key order, so that summing and taking the argmax over the dense
+    // masses visits the labels in the same order as the map-based implementation in calculate_pmf().
+    std::vector<Label> denseLabels;
+    for(typename std::map<Label,int>::iterator it = labelIndices.begin(), iend = labelIndices.end(); it != iend; ++it)
+    {
+      it->second = static_cast<int>(denseLabels.size());
+      denseLabels.push_back(it->first);
+    }
+    const int labelCount = static_cast<int>(denseLabels.size());
+
+    // Convert the slot PMFs to a dense mass table.
+    std::vector<float> denseMasses(slotMasses.size() * labelCount, 0.0f);
+    for(size_t slot = 0, slotCount = slotMasses.size(); slot < slotCount; ++slot)
+    {
+      for(typename std::map<Label,float>::const_iterator it = slotMasses[slot].begin(), iend = slotMasses[slot].end(); it != iend; ++it)
+      {
+        denseMasses[slot * labelCount + labelIndices[it->first]] = it->second;
+      }
+    }
+
+    // Sum the tree masses for each descriptor, normalise them and pick the best label.
+    std::vector<float> summedMasses(descriptorCount * labelCount);
+
+#ifdef WITH_OPENMP
+    #pragma omp parallel for
+#endif
+    for(int i = 0; i < static_cast<int>(descriptorCount); ++i)
+    {
+      float *masses = &summedMasses[i * labelCount];
+      std::fill(masses, masses + labelCount, 0.0f);
+      for(int treeIndex = 0; treeIndex < treeCount; ++treeIndex)
+      {
+        const float *treeMasses = &denseMasses[leafIndices[treeIndex * descriptorCount + i] * labelCount];
+        for(int k = 0; k < labelCount; ++k) masses[k] += treeMasses[k];
+      }
+
+      float sum = 0.0f;
+      for(int k = 0; k < labelCount; ++k) sum += masses[k];
+
+      int bestK = 0;
+      float bestMass = masses[0] / sum;
+      for(int k = 1; k < labelCount; ++k)
+      {
+        float mass = masses[k] / sum;
+        if(mass > bestMass)
+        {
+          bestK = k;
+          bestMass = mass;
+        }
+      }
+
+      labels[i] = denseLabels[bestK];
+      if(confidences) confidences[i] = bestMass;
+    }
+  }
+
   /**
    * \brief Resets the specified tree.
    *
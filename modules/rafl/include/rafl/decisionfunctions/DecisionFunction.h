@@ -59,6 +59,14 @@ public:
    */
   virtual DescriptorClassification classify_descriptor(const Descriptor& descriptor) const = 0;
 
+  /**
+   * \brief Classifies the descriptor whose features are stored contiguously at the specified location using the decision function.
+   *
+   * \param features  A pointer to the features of the descriptor to classify.
+   * \return          DC_LEFT, if the descriptor should be sent down the left subtree of the node, or DC_RIGHT otherwise.
+   */
+  virtual DescriptorClassification classify_features(const float *features) const = 0;
+
   /**
    * \brief Outputs the decision function to the specified stream.
    *
@@ -101,6 +109,7 @@ inline std::ostream& operator<<(std::ostream& os, const DecisionFunction& rhs)
 //#################### TYPEDEFS ####################
 
 typedef boost::shared_ptr<DecisionFunction> DecisionFunction_Ptr;
+typedef boost::shared_ptr<const DecisionFunction> DecisionFunction_CPtr;
 
 }
 
@@ -74,6 +74,37 @@ public:
   /** Override */
   virtual DescriptorClassification classify_descriptor(const Descriptor& descriptor) const;
 
+  /** Override */
+  virtual DescriptorClassification classify_features(const float *features) const;
+
+  /**
+   * \brief Gets the index of the first feature in a feature descriptor.
+   *
+   * \return The index of the first feature in a feature descriptor.
+   */
+  size_t get_first_feature_index() const;
+
+  /**
+   * \brief Gets the pairwise operation to apply to the features.
+   *
+   * \return The pairwise operation to apply to the features.
+   */
+  Op get_op() const;
+
+  /**
+   * \brief Gets the index of the second feature in a feature descriptor.
+   *
+   * \return The index of the second feature in a feature descriptor.
+   */
+  size_t get_second_feature_index() const;
+
+  /**
+   * \brief Gets the threshold against which to compare the result of the operation.
+   *
+   * \return The threshold against which to compare the result of the operation.
+   */
+  float get_threshold() const;
+
   /** Override */
   virtual void output(std::ostream& os) const;
 
@@ -19,7 +19,22 @@ FeatureThresholdingDecisionFunction::FeatureThresholdingDecisionFunction(size_t
 
 DecisionFunction::DescriptorClassification FeatureThresholdingDecisionFunction::classify_descriptor(const Descriptor& descriptor) const
 {
-  return descriptor[m_featureIndex] < m_threshold ? DC_LEFT : DC_RIGHT;
+  return classify_features(&descriptor[0]);
+}
+
+DecisionFunction::DescriptorClassification FeatureThresholdingDecisionFunction::classify_features(const float *features) const
+{
+  return features[m_featureIndex] < m_threshold ? DC_LEFT : DC_RIGHT;
+}
+
+size_t FeatureThresholdingDecisionFunction::get_feature_index() const
+{
+  return m_featureIndex;
+}
+
+float FeatureThresholdingDecisionFunction::get_threshold() const
+{
+  return m_threshold;
 }
 
 void FeatureThresholdingDecisionFunction::output(std::ostream& os) const
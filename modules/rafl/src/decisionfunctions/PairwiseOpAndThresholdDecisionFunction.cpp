@@ -25,10 +25,35 @@ PairwiseOpAndThresholdDecisionFunction::PairwiseOpAndThresholdDecisionFunction()
 
 DecisionFunction::DescriptorClassification PairwiseOpAndThresholdDecisionFunction::classify_descriptor(const Descriptor& descriptor) const
 {
-  float result = apply_op(m_op, descriptor[m_firstFeatureIndex], descriptor[m_secondFeatureIndex]);
+  return classify_features(&descriptor[0]);
+}
+
+DecisionFunction::DescriptorClassification PairwiseOpAndThresholdDecisionFunction::classify_features(const float *features) const
+{
+  float result = apply_op(m_op, features[m_firstFeatureIndex], features[m_secondFeatureIndex]);
   return result < m_threshold ? DC_LEFT : DC_RIGHT;
 }
 
+size_t PairwiseOpAndThresholdDecisionFunction::get_first_feature_index() const
+{
+  return m_firstFeatureIndex;
+}
+
+PairwiseOpAndThresholdDecisionFunction::Op PairwiseOpAndThresholdDecisionFunction::get_op() const
+{
+  return m_op;
+}
+
+size_t PairwiseOpAndThresholdDecisionFunction::get_second_feature_index() const
+{
+  return m_secondFeatureIndex;
+}
+
+float PairwiseOpAndThresholdDecisionFunction::get_threshold() const
+{
+  return m_threshold;
+}
+
 void PairwiseOpAndThresholdDecisionFunction::output(std::ostream& os) const
 {
   os << "First Feature " << m_firstFeatureIndex << ' '
@@ -14,6 +14,29 @@ namespace spaint {
  */
 class VOPFeatureCalculator_CPU : public VOPFeatureCalculator
 {
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents an entry in a cache of RGB colours that have been converted to CIELab.
+   */
+  struct LabCacheEntry
+  {
+    /** The RGB colour (packed as 0xRRGGBB) plus one, or 0 if the entry is empty. */
+    unsigned int key;
+
+    /** The CIELab colour corresponding to the RGB colour. */
+    Vector3f lab;
+
+    LabCacheEntry()
+    : key(0)
+    {}
+  };
+
+  //#################### CONSTANTS ####################
+private:
+  /** The base-2 logarithm of the number of entries in each thread's CIELab cache. */
+  static const int LAB_CACHE_BITS = 14;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -12,6 +12,24 @@
 
 namespace spaint {
 
+/**
+ * \brief Quantizes the orientation of an intensity gradient into one of the bins of a histogram of oriented gradients.
+ *
+ * \param xDeriv    The x derivative of the intensity.
+ * \param yDeriv    The y derivative of the intensity.
+ * \param binCount  The number of bins into which to quantize the gradient orientations.
+ * \return          The index of the bin into which the gradient's orientation falls.
+ */
+_CPU_AND_GPU_CODE_
+inline int compute_orientation_bin(float xDeriv, float yDeriv, size_t binCount)
+{
+  // Compute the orientation.
+  double ori = atan2(yDeriv, xDeriv) + 2 * M_PI;
+
+  // Quantize the orientation.
+  return static_cast<int>(binCount * ori / (2 * M_PI)) % binCount;
+}
+
 /**
  * \brief Converts the RGB patch for the specified voxel to the CIELab colour space.
  *
@@ -66,11 +84,8 @@ inline void compute_histogram_for_patch(int tid, size_t patchSize, const float *
     // Compute the magnitude.
     float mag = static_cast<float>(sqrt(xDeriv * xDeriv + yDeriv * yDeriv));
 
-    // Compute the orientation.
-    double ori = atan2(yDeriv, xDeriv) + 2 * M_PI;
-
     // Quantize the orientation and update the histogram.
-    int bin = static_cast<int>(binCount * ori / (2 * M_PI)) % binCount;
+    int bin = compute_orientation_bin(xDeriv, yDeriv, binCount);
 
 #if defined(__CUDACC__) && defined(__CUDA_ARCH__)
     atomicAdd(&histogram[bin], mag);
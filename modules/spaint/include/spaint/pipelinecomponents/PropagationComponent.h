@@ -6,6 +6,8 @@
 #ifndef H_SPAINT_PROPAGATIONCOMPONENT
 #define H_SPAINT_PROPAGATIONCOMPONENT
 
+#include <tvgutil/timing/AverageTimer.h>
+
 #include "PropagationContext.h"
 #include "../propagation/interface/LabelPropagator.h"
 
@@ -16,6 +18,10 @@ namespace spaint {
  */
 class PropagationComponent
 {
+  //#################### TYPEDEFS ####################
+private:
+  typedef tvgutil::AverageTimer<boost::chrono::microseconds> AverageTimer;
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The shared context needed for propagation. */
@@ -24,9 +30,15 @@ private:
   /** The label propagator. */
   LabelPropagator_CPtr m_labelPropagator;
 
+  /** A timer recording the time spent on label propagation. */
+  AverageTimer m_propagationTimer;
+
   /** The ID of the scene on which the component should operate. */
   std::string m_sceneID;
 
+  /** Whether or not to time the label propagation and output the average time per frame on destruction. */
+  bool m_timePropagation;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -37,6 +49,13 @@ public:
    */
   PropagationComponent(const PropagationContext_Ptr& context, const std::string& sceneID);
 
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the propagation component.
+   */
+  ~PropagationComponent();
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
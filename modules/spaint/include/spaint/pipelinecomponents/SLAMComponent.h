@@ -9,9 +9,13 @@
 #include <ITMLib/Core/ITMDenseMapper.h>
 #include <ITMLib/Core/ITMDenseSurfelMapper.h>
 
+#include <itmx/imagesources/SensorClockImageSourceEngine.h>
 #include <itmx/remotemapping/MappingClient.h>
 #include <itmx/trackers/FallibleTracker.h>
 
+#include <tvgutil/misc/CachedSetting.h>
+#include <tvgutil/timing/LatencyRecorder.h>
+
 #include "SLAMContext.h"
 
 namespace spaint {
@@ -55,6 +59,12 @@ public:
 
   //#################### PRIVATE VARIABLES ####################
 private:
+  /**
+   * The RGB-D image (if any) that is currently borrowed from an asynchronous (or sensor clock) image source, and whose images are being used as the
+   * input images for the most recent frame. It is released (and thereby returned to the image source) when the next frame is read.
+   */
+  itmx::AsyncImageSourceEngine::RGBDImage_CPtr m_borrowedImages;
+
   /** The shared context needed for SLAM. */
   SLAMContext_Ptr m_context;
 
@@ -79,6 +89,9 @@ private:
   /** Whether or not the user wants fusion to be run. */
   bool m_fusionEnabled;
 
+  /** The specifier of the global poses file (if any), which determines whether or not we're using global poses. */
+  tvgutil::CachedSetting<std::string> m_globalPosesSpecifier;
+
   /** The engine used to provide input images to the fusion process. */
   ImageSourceEngine_Ptr m_imageSourceEngine;
 
@@ -95,6 +108,9 @@ private:
    */
   size_t m_initialFramesToFuse;
 
+  /** The recorder (if any) in which to record the latencies of the stages of processing each frame. */
+  tvgutil::LatencyRecorder_Ptr m_latencyRecorder;
+
   /** The engine used to perform low-level image processing operations. */
   LowLevelEngine_Ptr m_lowLevelEngine;
 
@@ -162,6 +178,13 @@ public:
    */
   bool get_fusion_enabled() const;
 
+  /**
+   * \brief Gets the ID of the scene (if any) whose pose this SLAM component is mirroring.
+   *
+   * \return  The ID of the scene (if any) whose pose this SLAM component is mirroring, or the empty string otherwise.
+   */
+  const std::string& get_mirror_scene_id() const;
+
   /**
    * \brief Gets the ID of the scene being reconstructed by this SLAM component.
    *
@@ -225,6 +248,13 @@ public:
    */
   void set_fusion_enabled(bool fusionEnabled);
 
+  /**
+   * \brief Sets the recorder (if any) in which to record the latencies of the stages of processing each frame.
+   *
+   * \param latencyRecorder The recorder (if any) in which to record the latencies of the stages of processing each frame.
+   */
+  void set_latency_recorder(const tvgutil::LatencyRecorder_Ptr& latencyRecorder);
+
   /**
    * \brief Sets the mapping client (if any) to use to communicate with the remote mapping server.
    *
@@ -253,6 +283,17 @@ private:
    */
   void process_relocalisation();
 
+  /**
+   * \brief Reads the next frame from the image source into the input images in the specified SLAM state.
+   *
+   * If the current image source is asynchronous (or a sensor clock), the next RGB-D image is borrowed from it without copying,
+   * and its images replace the input images in the SLAM state. If not, the next frame is copied into the
+   * existing input images.
+   *
+   * \param slamState The SLAM state.
+   */
+  void read_input_images(const SLAMState_Ptr& slamState);
+
   /**
    * \brief Decorates the specified relocaliser with one that uses an ICP tracker to refine the results.
    *
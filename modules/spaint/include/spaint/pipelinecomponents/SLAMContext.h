@@ -8,6 +8,8 @@
 
 #include <map>
 
+#include <boost/thread.hpp>
+
 #include <ITMLib/Engines/Visualisation/Interface/ITMSurfelVisualisationEngine.h>
 #include <ITMLib/Engines/Visualisation/Interface/ITMVisualisationEngine.h>
 
@@ -43,6 +45,13 @@ private:
   /** The mapping clients (if any) to use to communicate with the remote mapping server regarding the various scenes. */
   std::map<std::string,itmx::MappingClient_Ptr> m_mappingClients;
 
+  /**
+   * The mutex used to synchronise access to the per-scene maps. The scenes may be processed concurrently, so their SLAM components
+   * may look up their own entries at the same time. Since the maps are node-based, a reference to an entry remains valid after the
+   * mutex has been released, but the entries for a scene must only be replaced by the thread that is processing that scene.
+   */
+  mutable boost::mutex m_mutex;
+
   /** The relocalisers used to estimate the camera pose in the various scenes. */
   std::map<std::string,orx::Relocaliser_Ptr> m_relocalisers;
 
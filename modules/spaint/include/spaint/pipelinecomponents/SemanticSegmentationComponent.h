@@ -6,7 +6,9 @@
 #ifndef H_SPAINT_SEMANTICSEGMENTATIONCOMPONENT
 #define H_SPAINT_SEMANTICSEGMENTATIONCOMPONENT
 
-#include <rafl/core/RandomForest.h>
+#include <rafl/core/CompiledForest.h>
+
+#include <tvgutil/timing/AverageTimer.h>
 
 #include "SemanticSegmentationContext.h"
 #include "../features/interface/FeatureCalculator.h"
@@ -22,10 +24,15 @@ class SemanticSegmentationComponent
 {
   //#################### TYPEDEFS ####################
 private:
+  typedef tvgutil::AverageTimer<boost::chrono::microseconds> AverageTimer;
+  typedef boost::shared_ptr<rafl::CompiledForest<SpaintVoxel::Label> > CompiledForest_Ptr;
   typedef boost::shared_ptr<rafl::RandomForest<SpaintVoxel::Label> > RandomForest_Ptr;
 
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** A compiled version of the random forest that is used for prediction once training has stopped (rebuilt lazily whenever the forest changes). */
+  CompiledForest_Ptr m_compiledForest;
+
   /** The shared context needed for semantic segmentation. */
   SemanticSegmentationContext_Ptr m_context;
 
@@ -44,6 +51,9 @@ private:
   /** The side length of a VOP patch (must be odd). */
   size_t m_patchSize;
 
+  /** A buffer in which to store the labels predicted by the random forest before they are packed into the prediction labels memory block. */
+  std::vector<SpaintVoxel::Label> m_predictedLabels;
+
   /** A memory block in which to store the feature vectors computed for the various voxels during prediction. */
   boost::shared_ptr<ORUtils::MemoryBlock<float> > m_predictionFeaturesMB;
 
@@ -53,6 +63,9 @@ private:
   /** The voxel sampler used in prediction mode. */
   UniformVoxelSampler_CPtr m_predictionSampler;
 
+  /** A timer recording the time spent predicting labels for the sampled voxels using the random forest. */
+  AverageTimer m_predictionTimer;
+
   /** A memory block in which to store the locations of the voxels sampled for prediction purposes. */
   Selector::Selection_Ptr m_predictionVoxelLocationsMB;
 
@@ -62,6 +75,12 @@ private:
   /** The seed to use for the random number generators used by the voxel samplers. */
   unsigned int m_seed;
 
+  /** Whether or not to time the forest prediction stage and output the average time per frame on destruction. */
+  bool m_timePrediction;
+
+  /** Whether or not the forest has been trained since labels were last predicted (if so, training is assumed to be ongoing). */
+  bool m_trainedSinceLastPrediction;
+
   /** A memory block in which to store the feature vectors computed for the various voxels during training. */
   boost::shared_ptr<ORUtils::MemoryBlock<float> > m_trainingFeaturesMB;
 
@@ -88,6 +107,13 @@ public:
    */
   SemanticSegmentationComponent(const SemanticSegmentationContext_Ptr& context, const std::string& sceneID, unsigned int seed);
 
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the semantic segmentation component.
+   */
+  ~SemanticSegmentationComponent();
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
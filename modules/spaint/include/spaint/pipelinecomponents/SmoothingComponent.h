@@ -6,6 +6,8 @@
 #ifndef H_SPAINT_SMOOTHINGCOMPONENT
 #define H_SPAINT_SMOOTHINGCOMPONENT
 
+#include <tvgutil/timing/AverageTimer.h>
+
 #include "SmoothingContext.h"
 #include "../smoothing/interface/LabelSmoother.h"
 
@@ -16,6 +18,10 @@ namespace spaint {
  */
 class SmoothingComponent
 {
+  //#################### TYPEDEFS ####################
+private:
+  typedef tvgutil::AverageTimer<boost::chrono::microseconds> AverageTimer;
+
   //#################### PRIVATE VARIABLES ####################
 private:
   /** The shared context needed for smoothing. */
@@ -27,6 +33,12 @@ private:
   /** The ID of the scene on which the component should operate. */
   std::string m_sceneID;
 
+  /** A timer recording the time spent on label smoothing. */
+  AverageTimer m_smoothingTimer;
+
+  /** Whether or not to time the label smoothing and output the average time per frame on destruction. */
+  bool m_timeSmoothing;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -37,6 +49,13 @@ public:
    */
   SmoothingComponent(const SmoothingContext_Ptr& context, const std::string& sceneID);
 
+  //#################### DESTRUCTOR ####################
+public:
+  /**
+   * \brief Destroys the smoothing component.
+   */
+  ~SmoothingComponent();
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
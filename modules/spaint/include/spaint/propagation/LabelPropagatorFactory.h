@@ -29,12 +29,15 @@ struct LabelPropagatorFactory
    * \param maxAngleBetweenNormals            The largest angle allowed between the normals of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if propagation is to occur.
+   * \param incremental                       Whether or not the propagator should only reprocess the pixels whose neighbourhoods have changed since its previous pass
+   *                                          (currently only supported on the CPU, and ignored on the GPU).
    * \return                                  The label propagator.
    */
   static LabelPropagator_CPtr make_label_propagator(size_t raycastResultSize, ORUtils::DeviceType deviceType,
                                                     float maxAngleBetweenNormals = static_cast<float>(2.0f * M_PI / 180.0f),
                                                     float maxSquaredDistanceBetweenColours = 50.0f * 50.0f,
-                                                    float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f);
+                                                    float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f,
+                                                    bool incremental = false);
 };
 
 }
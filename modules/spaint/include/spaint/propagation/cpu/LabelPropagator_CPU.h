@@ -6,7 +6,10 @@
 #ifndef H_SPAINT_LABELPROPAGATOR_CPU
 #define H_SPAINT_LABELPROPAGATOR_CPU
 
+#include <vector>
+
 #include "../interface/LabelPropagator.h"
+#include "../../util/RaycastChangeTracker.h"
 
 namespace spaint {
 
@@ -15,6 +18,20 @@ namespace spaint {
  */
 class LabelPropagator_CPU : public LabelPropagator
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The tracker used to find the pixels whose neighbourhoods have changed (only used if incremental propagation is enabled). */
+  boost::shared_ptr<RaycastChangeTracker> m_changeTracker;
+
+  /** The label propagated on the previous pass (or -1 if there has not yet been a pass). */
+  mutable int m_previousLabel;
+
+  /** A compacted list of the pixels whose voxels should be marked on the current pass (only used if incremental propagation is enabled). */
+  mutable std::vector<int> m_pixelsToMark;
+
+  /** Flags indicating which of the dirty pixels should be marked on the current pass (only used if incremental propagation is enabled). */
+  mutable std::vector<unsigned char> m_shouldMarkFlags;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -24,14 +41,25 @@ public:
    * \param maxAngleBetweenNormals            The largest angle allowed between the normals of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of neighbouring voxels if propagation is to occur.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if propagation is to occur.
+   * \param incremental                       Whether or not to only reprocess the pixels whose neighbourhoods have changed since the previous pass.
    */
-  LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels);
+  LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                      bool incremental = false);
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
   /** Override */
   virtual void calculate_normals(const ORFloat4Image *raycastResult, const SpaintVoxelScene *scene) const;
 
+  /**
+   * \brief Propagates the specified label across the scene, reprocessing only those pixels whose neighbourhoods have changed since the previous pass.
+   *
+   * \param label         The label to propagate.
+   * \param raycastResult The raycast result.
+   * \param scene         The scene.
+   */
+  void perform_incremental_propagation(SpaintVoxel::Label label, const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const;
+
   /** Override */
   virtual void perform_propagation(SpaintVoxel::Label label, const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const;
 };
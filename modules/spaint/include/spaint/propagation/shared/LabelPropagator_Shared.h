@@ -74,7 +74,7 @@ inline bool should_propagate_from_neighbour(int neighbourX, int neighbourY, int
 }
 
 /**
- * \brief Propagates the specified label to the specified voxel as necessary, based on its own properties and those of its neighbours.
+ * \brief Determines whether or not the specified label should be propagated to the specified voxel, based on its own properties and those of its neighbours.
  *
  * \param voxelIndex                        The index of the voxel in the raycast result.
  * \param width                             The width of the raycast result.
@@ -87,11 +87,12 @@ inline bool should_propagate_from_neighbour(int neighbourX, int neighbourY, int
  * \param maxAngleBetweenNormals            The largest angle allowed between the normals of the neighbour and the voxel of interest if propagation is to occur.
  * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of the neighbour and the voxel of interest if propagation is to occur.
  * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of the neighbour and the voxel of interest if propagation is to occur.
+ * \return                                  true, if the voxel should be marked with the label being propagated, or false otherwise.
  */
 _CPU_AND_GPU_CODE_
-inline void propagate_from_neighbours(int voxelIndex, int width, int height, SpaintVoxel::Label label,
+inline bool should_propagate_to_voxel(int voxelIndex, int width, int height, SpaintVoxel::Label label,
                                       const Vector4f *raycastResult, const Vector3f *surfaceNormals,
-                                      SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                                      const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
                                       float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours,
                                       float maxSquaredDistanceBetweenVoxels)
 {
@@ -101,12 +102,12 @@ inline void propagate_from_neighbours(int voxelIndex, int width, int height, Spa
 
   bool foundPoint;
   const SpaintVoxel voxel = readVoxel(voxelData, indexData, loc.toIntRound(), foundPoint);
-  if(!foundPoint) return;
+  if(!foundPoint) return false;
 
   Vector3u colour = VoxelColourReader<SpaintVoxel::hasColorInformation>::read(voxel);
 
   // Based on these properties and the properties of the neighbouring voxels, decide whether or not
-  // the specified voxel should be marked with the label being propagated, and mark it if so.
+  // the specified voxel should be marked with the label being propagated.
   int x = voxelIndex % width;
   int y = voxelIndex / width;
 
@@ -116,17 +117,45 @@ inline void propagate_from_neighbours(int voxelIndex, int width, int height, Spa
   maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, \
   maxSquaredDistanceBetweenVoxels)
 
-  if((SPFN(x - 2, y) && SPFN(x - 5, y)) ||
-     (SPFN(x + 2, y) && SPFN(x + 5, y)) ||
-     (SPFN(x, y - 2) && SPFN(x, y - 5)) ||
-     (SPFN(x, y + 2) && SPFN(x, y + 5)))
-  {
-    mark_voxel(loc.toShortRound(), SpaintVoxel::PackedLabel(label, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, indexData);
-  }
+  return (SPFN(x - 2, y) && SPFN(x - 5, y)) ||
+         (SPFN(x + 2, y) && SPFN(x + 5, y)) ||
+         (SPFN(x, y - 2) && SPFN(x, y - 5)) ||
+         (SPFN(x, y + 2) && SPFN(x, y + 5));
 
 #undef SPFN
 }
 
+/**
+ * \brief Propagates the specified label to the specified voxel as necessary, based on its own properties and those of its neighbours.
+ *
+ * \param voxelIndex                        The index of the voxel in the raycast result.
+ * \param width                             The width of the raycast result.
+ * \param height                            The height of the raycast result.
+ * \param label                             The label being propagated.
+ * \param raycastResult                     The raycast result.
+ * \param surfaceNormals                    The surface normals for the voxels in the raycast result.
+ * \param voxelData                         The scene's voxel data.
+ * \param indexData                         The scene's index data.
+ * \param maxAngleBetweenNormals            The largest angle allowed between the normals of the neighbour and the voxel of interest if propagation is to occur.
+ * \param maxSquaredDistanceBetweenColours  The maximum squared distance allowed between the colours of the neighbour and the voxel of interest if propagation is to occur.
+ * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of the neighbour and the voxel of interest if propagation is to occur.
+ */
+_CPU_AND_GPU_CODE_
+inline void propagate_from_neighbours(int voxelIndex, int width, int height, SpaintVoxel::Label label,
+                                      const Vector4f *raycastResult, const Vector3f *surfaceNormals,
+                                      SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                                      float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours,
+                                      float maxSquaredDistanceBetweenVoxels)
+{
+  if(should_propagate_to_voxel(
+    voxelIndex, width, height, label, raycastResult, surfaceNormals, voxelData, indexData,
+    maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels
+  ))
+  {
+    mark_voxel(raycastResult[voxelIndex].toVector3().toShortRound(), SpaintVoxel::PackedLabel(label, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, indexData);
+  }
+}
+
 /**
  * \brief Calculates the normal of the specified voxel in the raycast result and writes it into the surface normals array.
  *
@@ -6,6 +6,8 @@
 #ifndef H_SPAINT_COLOURAPPEARANCEMODEL
 #define H_SPAINT_COLOURAPPEARANCEMODEL
 
+#include <vector>
+
 #include <orx/base/ORImagePtrTypes.h>
 
 #include <tvgutil/statistics/ProbabilityMassFunction.h>
@@ -43,6 +45,9 @@ private:
   // A (linearised) 2D probability mass function representing P(Colour | !object).
   PMF_Ptr m_pmfColourGivenNotObject;
 
+  // A (linearised) 2D lookup table containing P(object | Colour) for each bin (rebuilt from the PMFs each time the model is trained).
+  std::vector<float> m_posteriors;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -55,6 +60,18 @@ public:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Makes a mask denoting which pixels in an image are likely to be part of the object, i.e. for which P(object | colour) >= threshold.
+   *
+   * \note  This is equivalent to (but much faster than) thresholding compute_posterior_probability for each pixel.
+   *
+   * \param image         The image.
+   * \param candidateMask A binary mask specifying which pixels in the image should be considered (other pixels are never part of the output mask).
+   * \param threshold     The minimum posterior probability for a pixel to be considered part of the object.
+   * \param objectMask    A pointer to the memory (of the same size as the image) into which to write the mask (255 = object, 0 = not object).
+   */
+  void compute_object_mask(const ORUChar4Image_CPtr& image, const ORUCharImage_CPtr& candidateMask, float threshold, unsigned char *objectMask) const;
+
   /**
    * \brief Computes the posterior probability of a pixel being part of the object given its colour, i.e. P(object | colour).
    *
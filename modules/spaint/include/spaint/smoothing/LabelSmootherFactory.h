@@ -27,9 +27,12 @@ struct LabelSmootherFactory
    * \param maxLabelCount                     The maximum number of labels that can be in use.
    * \param deviceType                        The device on which the label smoother should operate.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if smoothing is to occur.
+   * \param incremental                       Whether or not the smoother should only reprocess the pixels whose neighbourhoods have changed since its previous pass
+   *                                          (currently only supported on the CPU, and ignored on the GPU).
    * \return                                  The label smoother.
    */
-  static LabelSmoother_CPtr make_label_smoother(size_t maxLabelCount, ORUtils::DeviceType deviceType, float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f);
+  static LabelSmoother_CPtr make_label_smoother(size_t maxLabelCount, ORUtils::DeviceType deviceType, float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f,
+                                                bool incremental = false);
 };
 
 }
@@ -6,7 +6,10 @@
 #ifndef H_SPAINT_LABELSMOOTHER_CPU
 #define H_SPAINT_LABELSMOOTHER_CPU
 
+#include <vector>
+
 #include "../interface/LabelSmoother.h"
+#include "../../util/RaycastChangeTracker.h"
 
 namespace spaint {
 
@@ -15,6 +18,14 @@ namespace spaint {
  */
 class LabelSmoother_CPU : public LabelSmoother
 {
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The tracker used to find the pixels whose neighbourhoods have changed (only used if incremental smoothing is enabled). */
+  boost::shared_ptr<RaycastChangeTracker> m_changeTracker;
+
+  /** The labels (if any) with which to fill in the voxels of the dirty pixels on the current pass (only used if incremental smoothing is enabled). */
+  mutable std::vector<SpaintVoxel::Label> m_smoothedLabels;
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -22,8 +33,9 @@ public:
    *
    * \param maxLabelCount                     The maximum number of labels that can be in use.
    * \param maxSquaredDistanceBetweenVoxels   The maximum squared distance allowed between the positions of neighbouring voxels if smoothing is to occur.
+   * \param incremental                       Whether or not to only reprocess the pixels whose neighbourhoods have changed since the previous pass.
    */
-  LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels);
+  LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, bool incremental = false);
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -34,6 +46,16 @@ public:
    * \param scene         The scene.
    */
   virtual void smooth_labels(const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Smooths the labelling of voxels in the scene, reprocessing only those pixels whose neighbourhoods have changed since the previous pass.
+   *
+   * \param raycastResult The raycast result.
+   * \param scene         The scene.
+   */
+  void smooth_labels_incrementally(const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const;
 };
 
 }
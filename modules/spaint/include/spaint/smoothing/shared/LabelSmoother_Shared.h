@@ -11,7 +11,7 @@
 namespace spaint {
 
 /**
- * \brief Fills in the label of the specified voxel from its neighbours if a significant number of those within range share the same label.
+ * \brief Calculates the label (if any) with which the specified voxel should be filled in, based on the labels of its neighbours.
  *
  * \param voxelIndex                      The index of the voxel in the raycast result.
  * \param width                           The width of the raycast result.
@@ -21,11 +21,12 @@ namespace spaint {
  * \param voxelData                       The scene's voxel data.
  * \param indexData                       The scene's index data.
  * \param maxSquaredDistanceBetweenVoxels The maximum squared distance allowed between the positions of the neighbour and the voxel of interest if smoothing is to occur.
+ * \return                                The label with which to fill in the voxel, or 0 if a significant number of its neighbours do not share a label.
  */
 _CPU_AND_GPU_CODE_
-inline void smooth_from_neighbours(int voxelIndex, int width, int height, int maxLabelCount, const Vector4f *raycastResult,
-                                   SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
-                                   float maxSquaredDistanceBetweenVoxels)
+inline SpaintVoxel::Label calculate_smoothed_label(int voxelIndex, int width, int height, int maxLabelCount, const Vector4f *raycastResult,
+                                                  const SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                                                  float maxSquaredDistanceBetweenVoxels)
 {
   // Note: We declare the label count array with a fixed maximum size here for simplicity.
   //       The size will need to be changed if we ever want to use more than 32 labels.
@@ -78,11 +79,32 @@ inline void smooth_from_neighbours(int voxelIndex, int width, int height, int ma
   }
 
   // If there is a best label, and at least a specified number of the neigbouring voxels are labelled with it,
-  // use it to update the label of the target voxel.
+  // it should be used to update the label of the target voxel.
   const int bestLabelThreshold = 6;
-  if(bestLabel != 0 && bestLabelCount >= bestLabelThreshold)
+  return bestLabelCount >= bestLabelThreshold ? bestLabel : SpaintVoxel::Label(0);
+}
+
+/**
+ * \brief Fills in the label of the specified voxel from its neighbours if a significant number of those within range share the same label.
+ *
+ * \param voxelIndex                      The index of the voxel in the raycast result.
+ * \param width                           The width of the raycast result.
+ * \param height                          The height of the raycast result.
+ * \param maxLabelCount                   The maximum number of labels that can be in use.
+ * \param raycastResult                   The raycast result.
+ * \param voxelData                       The scene's voxel data.
+ * \param indexData                       The scene's index data.
+ * \param maxSquaredDistanceBetweenVoxels The maximum squared distance allowed between the positions of the neighbour and the voxel of interest if smoothing is to occur.
+ */
+_CPU_AND_GPU_CODE_
+inline void smooth_from_neighbours(int voxelIndex, int width, int height, int maxLabelCount, const Vector4f *raycastResult,
+                                   SpaintVoxel *voxelData, const ITMVoxelIndex::IndexData *indexData,
+                                   float maxSquaredDistanceBetweenVoxels)
+{
+  SpaintVoxel::Label bestLabel = calculate_smoothed_label(voxelIndex, width, height, maxLabelCount, raycastResult, voxelData, indexData, maxSquaredDistanceBetweenVoxels);
+  if(bestLabel != 0)
   {
-    mark_voxel(loc.toShortRound(), SpaintVoxel::PackedLabel(bestLabel, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, indexData);
+    mark_voxel(raycastResult[voxelIndex].toVector3().toShortRound(), SpaintVoxel::PackedLabel(bestLabel, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, indexData);
   }
 }
 
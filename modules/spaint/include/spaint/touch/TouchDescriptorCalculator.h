@@ -17,6 +17,8 @@
   #pragma warning(default:4275)
 #endif
 
+#include <vector>
+
 #include <rafl/base/Descriptor.h>
 
 namespace spaint {
@@ -28,6 +30,14 @@ namespace spaint {
  */
 struct TouchDescriptorCalculator
 {
+  //#################### CONSTANTS ####################
+
+  /**
+   * \brief The version of the descriptors calculated. This must be incremented whenever the way in which they are calculated
+   *        changes (e.g. the number of bins or their normalisation), so that any descriptors that have been cached are recomputed.
+   */
+  static const int DESCRIPTOR_VERSION = 1;
+
   //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
   /**
@@ -37,6 +47,16 @@ struct TouchDescriptorCalculator
    * \return    The descriptor.
    */
   static rafl::Descriptor_CPtr calculate_histogram_descriptor(const af::array& img);
+
+  /**
+   * \brief Calculates a global histogram descriptor from a histogram of the values in an image that contains candidate touch components.
+   *
+   * The values are binned in the same way as by the ArrayFire version of this function, so the two versions produce the same descriptor.
+   *
+   * \param valueHistogram A 256-bin histogram of the values in the image, with one bin per possible value.
+   * \return               The descriptor.
+   */
+  static rafl::Descriptor_CPtr calculate_histogram_descriptor(const std::vector<int>& valueHistogram);
 };
 
 }
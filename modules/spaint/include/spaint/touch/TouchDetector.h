@@ -28,6 +28,7 @@
 #include <tvgutil/persistence/PropertyUtil.h>
 
 #include "TouchSettings.h"
+#include "cpu/TouchPipeline_CPU.h"
 #include "../imageprocessing/interface/ImageProcessor.h"
 
 namespace spaint {
@@ -54,19 +55,22 @@ private:
 
   //#################### PRIVATE VARIABLES ####################
 private:
-  /** An image in which to store a mask of the changes that have been detected in the scene with respect to the reconstructed model. */
+  /** An image in which to store a mask of the changes that have been detected in the scene with respect to the reconstructed model (unused by the native CPU pipeline). */
   AFArray_Ptr m_changeMask;
 
-  /** An image in which to store the connected components of the change mask. */
+  /** An image in which to store the connected components of the change mask (unused by the native CPU pipeline). */
   af::array m_connectedComponentImage;
 
+  /** The native CPU touch pipeline (only used when running on the CPU, in which case it replaces the ArrayFire-based analysis). */
+  TouchPipeline_CPU_Ptr m_cpuPipeline;
+
   /** An image in which to store the depth of the reconstructed model as viewed from the current camera pose. */
   ORFloatImage_Ptr m_depthRaycast;
 
   /** The depth visualiser. */
   itmx::DepthVisualiser_CPtr m_depthVisualiser;
 
-  /** An image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast. */
+  /** An image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast (unused by the native CPU pipeline). */
   AFArray_Ptr m_diffRawRaycast;
 
   /** The random forest used to score the candidate connected components. */
@@ -93,7 +97,7 @@ private:
   /** A thresholded version of the raw depth image captured from the camera in which parts of the scene > 2m away have been masked out. */
   ORFloatImage_Ptr m_thresholdedRawDepth;
 
-  /** An image in which to store a mask denoting the detected touch region. */
+  /** An image in which to store a mask denoting the detected touch region (unused by the native CPU pipeline). */
   AFArray_Ptr m_touchMask;
 
   /** The settings needed to configure the touch detector. */
@@ -172,6 +176,14 @@ private:
    */
   void detect_changes();
 
+  /**
+   * \brief Determines the points (if any) that the user is touching in the scene using the native CPU touch pipeline.
+   *
+   * \pre   The inputs have already been prepared by prepare_inputs.
+   * \return The points (if any) that the user is touching in the scene.
+   */
+  std::vector<Eigen::Vector2i> determine_touch_points_cpu();
+
   /**
    * \brief Extracts a set of touch points from the specified component in the connected component image.
    *
@@ -201,6 +213,17 @@ private:
    */
   int pick_best_candidate_component_based_on_forest(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const;
 
+  /**
+   * \brief Picks the candidate component most likely to correspond to a touch interaction based on predictions made by a random forest,
+   *        using the connected components found by the native CPU touch pipeline.
+   *
+   * If no candidates are classified as interactions by the forest, there is no best candidate and we return -1.
+   *
+   * \param candidateComponents The IDs of components in the pipeline's connected-component image that denote candidate touch interactions.
+   * \return                    The ID of the best candidate component, or -1 if no candidates are classified as interactions by the forest.
+   */
+  int pick_best_candidate_component_based_on_forest_cpu(const std::vector<int>& candidateComponents) const;
+
   /**
    * \brief Prepares a thresholded version of the raw depth image and a depth raycast ready for change detection.
    *
@@ -224,6 +247,13 @@ private:
    * \param diffRawRaycast      An image in which each pixel is the absolute difference between the raw depth image and the depth raycast.
    */
   void save_candidate_components(const af::array& candidateComponents, const af::array& diffRawRaycastInMm) const;
+
+  /**
+   * \brief Saves an image of each candidate component found by the native CPU touch pipeline to disk for use with the touchtrain application.
+   *
+   * \param candidateComponents The IDs of components in the pipeline's connected-component image that denote candidate touch interactions.
+   */
+  void save_candidate_components_cpu(const std::vector<int>& candidateComponents) const;
 #endif
 
   /**
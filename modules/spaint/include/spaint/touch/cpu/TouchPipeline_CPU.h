@@ -0,0 +1,245 @@
+/**
+ * spaint: TouchPipeline_CPU.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_SPAINT_TOUCHPIPELINE_CPU
+#define H_SPAINT_TOUCHPIPELINE_CPU
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <orx/base/ORImagePtrTypes.h>
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to perform the image analysis needed for touch detection natively on the CPU.
+ *
+ * The pipeline makes the same decisions as the ArrayFire-based analysis in TouchDetector, but works directly on row-major
+ * images, thereby avoiding the per-call overheads of the ArrayFire CPU backend and the conversions between row-major and
+ * column-major layouts. It consists of a fused depth differencing and thresholding pass, separable binary morphology,
+ * and a union-find connected-components labelling that also computes the statistics of each component.
+ */
+class TouchPipeline_CPU
+{
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct contains the statistics for a connected component of the change mask.
+   */
+  struct ComponentStats
+  {
+    /** The area of the component (in pixels). */
+    int area;
+
+    /** The maximum x coordinate of a pixel in the component. */
+    int maxX;
+
+    /** The maximum y coordinate of a pixel in the component. */
+    int maxY;
+
+    /** The minimum x coordinate of a pixel in the component. */
+    int minX;
+
+    /** The minimum y coordinate of a pixel in the component. */
+    int minY;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A mask of the changes that have been detected in the scene with respect to the reconstructed model. */
+  std::vector<unsigned char> m_changeMask;
+
+  /** The connected-component image (0 denotes the static scene, and the components are labelled from 1 in column-major order of appearance). */
+  std::vector<int> m_componentImage;
+
+  /** The statistics for the connected components (indexed by component ID, with element 0 unused). */
+  std::vector<ComponentStats> m_componentStats;
+
+  /** An image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast. */
+  ORFloatImage_Ptr m_diffRawRaycast;
+
+  /** The absolute differences between the raw depth image and the depth raycast, in mm and clamped to [0,255]. */
+  std::vector<unsigned char> m_diffRawRaycastInMm;
+
+  /** The column-major index of the first pixel (in column-major order) with each provisional component label. */
+  std::vector<int> m_firstColumnMajorIndices;
+
+  /** The height of the images on which the pipeline is running. */
+  int m_imageHeight;
+
+  /** The width of the images on which the pipeline is running. */
+  int m_imageWidth;
+
+  /** The union-find forest used to merge provisional component labels. */
+  std::vector<int> m_parents;
+
+  /** A scratch buffer used by the morphological operations. */
+  std::vector<unsigned char> m_scratch;
+
+  /** A mask denoting the pixels at which the user is touching the scene. */
+  std::vector<unsigned char> m_touchPixels;
+
+  /** A mask denoting the detected touch region. */
+  ORUCharImage_Ptr m_touchMask;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a CPU-based touch pipeline.
+   *
+   * \param imgSize The size of the images on which the pipeline is to run.
+   */
+  explicit TouchPipeline_CPU(const Vector2i& imgSize);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Calculates a histogram of the differences (in mm) between the raw depth image and the depth raycast within the specified component.
+   *
+   * As in the ArrayFire pipeline, pixels outside the component count as having a difference of 0.
+   *
+   * \param component The ID of a component in the connected-component image.
+   * \return          A 256-bin histogram of the differences, with one bin per possible value.
+   */
+  std::vector<int> calculate_value_histogram(int component) const;
+
+  /**
+   * \brief Clears the touch mask.
+   */
+  void clear_touch_mask();
+
+  /**
+   * \brief Detects changes between the raw depth image from the camera and a depth raycast of the reconstructed model.
+   *
+   * The depth difference, its conversion to mm and the thresholding are fused into a single pass, after which
+   * a morphological opening is applied to the change mask to reduce noise.
+   *
+   * \param thresholdedRawDepth   A thresholded version of the raw depth image captured from the camera.
+   * \param depthRaycast          A depth raycast of the reconstructed model from the current camera pose.
+   * \param lowerDepthThresholdMm The threshold (in mm) below which the raw and raycasted depths are assumed to be equal.
+   * \param morphKernelSize       The side length of the morphological opening kernel to apply to the change mask.
+   */
+  void detect_changes(const ORFloatImage *thresholdedRawDepth, const ORFloatImage *depthRaycast, int lowerDepthThresholdMm, int morphKernelSize);
+
+  /**
+   * \brief Extracts a set of touch points from the specified component in the connected-component image.
+   *
+   * This also updates the touch mask to denote the specified component.
+   *
+   * \param component             The ID of a component in the connected-component image.
+   * \param lowerDepthThresholdMm The threshold (in mm) below which the raw and raycasted depths are assumed to be equal.
+   * \param minTouchAreaFraction  The minimum fraction of the image that the touching part of the component must cover for the touch to be valid.
+   * \return                      The touch points extracted from the specified component.
+   */
+  std::vector<Eigen::Vector2i> extract_touch_points(int component, int lowerDepthThresholdMm, float minTouchAreaFraction);
+
+  /**
+   * \brief Labels the connected components of the change mask (using 4-connectivity) and calculates their statistics.
+   *
+   * As with af::regions, the components are numbered from 1 in column-major order of their first appearance.
+   */
+  void find_connected_components();
+
+  /**
+   * \brief Gets the (denoised) mask of the changes that have been detected in the scene.
+   *
+   * \return  The change mask (in row-major format).
+   */
+  const std::vector<unsigned char>& get_change_mask() const;
+
+  /**
+   * \brief Gets the connected-component image.
+   *
+   * \return  The connected-component image (in row-major format).
+   */
+  const std::vector<int>& get_component_image() const;
+
+  /**
+   * \brief Gets an image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast.
+   *
+   * \return  An image in which each pixel is the absolute difference (in m) between the raw depth image and the depth raycast.
+   */
+  ORFloatImage_CPtr get_diff_raw_raycast() const;
+
+  /**
+   * \brief Gets the absolute differences between the raw depth image and the depth raycast, in mm and clamped to [0,255].
+   *
+   * \return  The absolute differences between the raw depth image and the depth raycast (in row-major format).
+   */
+  const std::vector<unsigned char>& get_diff_raw_raycast_in_mm() const;
+
+  /**
+   * \brief Gets a mask denoting the detected touch region.
+   *
+   * \return  A mask denoting the detected touch region.
+   */
+  ORUCharImage_CPtr get_touch_mask() const;
+
+  /**
+   * \brief Selects the connected components whose areas fall within the specified range.
+   *
+   * \param minArea The minimum area (in pixels) that a component can have if it is to be selected.
+   * \param maxArea The maximum area (in pixels) that a component can have if it is to be selected.
+   * \return        The IDs of the selected components.
+   */
+  std::vector<int> select_candidate_components(int minArea, int maxArea) const;
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Finds the root of the tree in the union-find forest that contains the specified provisional label.
+   *
+   * \param label The provisional label.
+   * \return      The root of the tree containing the label.
+   */
+  int find_root(int label);
+
+  /**
+   * \brief Applies a morphological opening with a square kernel to a binary mask, in place.
+   *
+   * \param mask        The mask.
+   * \param kernelSize  The side length of the (odd-sized) square kernel.
+   */
+  void open(std::vector<unsigned char>& mask, int kernelSize);
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Erodes or dilates a binary image along its columns.
+   *
+   * Only the pixels within the bounds of the image are considered, so the image borders do not erode the mask.
+   *
+   * \param input   The input image.
+   * \param output  The output image.
+   * \param width   The width of the images.
+   * \param height  The height of the images.
+   * \param radius  The radius of the kernel.
+   * \param dilate  Whether to dilate (true) or erode (false) the image.
+   */
+  static void filter_columns(const unsigned char *input, unsigned char *output, int width, int height, int radius, bool dilate);
+
+  /**
+   * \brief Erodes or dilates a binary image along its rows.
+   *
+   * Only the pixels within the bounds of the image are considered, so the image borders do not erode the mask.
+   *
+   * \param input   The input image.
+   * \param output  The output image.
+   * \param width   The width of the images.
+   * \param height  The height of the images.
+   * \param radius  The radius of the kernel.
+   * \param dilate  Whether to dilate (true) or erode (false) the image.
+   */
+  static void filter_rows(const unsigned char *input, unsigned char *output, int width, int height, int radius, bool dilate);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<TouchPipeline_CPU> TouchPipeline_CPU_Ptr;
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * spaint: RaycastChangeTracker.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#ifndef H_SPAINT_RAYCASTCHANGETRACKER
+#define H_SPAINT_RAYCASTCHANGETRACKER
+
+#include <vector>
+
+#include <ORUtils/ImageTypes.h>
+
+#include "SpaintVoxelScene.h"
+
+namespace spaint {
+
+/**
+ * \brief An instance of this class can be used to track which pixels of a raycast result have changed between successive passes
+ *        of a neighbourhood-based labelling operation (e.g. label propagation or smoothing).
+ *
+ * A pixel is deemed to have changed if either its raycast point has moved by more than a specified tolerance, or the label of the
+ * voxel under it has changed, since the last time it was examined. The output of a neighbourhood-based operation at a pixel can
+ * only change if the pixel itself or one of the neighbours it reads has changed, so only the resulting "dirty" pixels need to be
+ * reprocessed. This makes the per-frame cost of such operations proportional to the amount of change rather than to the image size.
+ */
+class RaycastChangeTracker
+{
+  //#################### ENUMERATIONS ####################
+private:
+  /**
+   * \brief The flags that can be set for a pixel in the change mask.
+   */
+  enum ChangeFlag
+  {
+    CF_LABEL = 1,
+    CF_POSITION = 2
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The change flags for the pixels in the most recent raycast result. */
+  std::vector<unsigned char> m_changeMask;
+
+  /** A compacted list of the indices of the pixels that need to be reprocessed. */
+  std::vector<int> m_dirtyPixels;
+
+  /** A mask indicating which pixels need to be reprocessed. */
+  std::vector<unsigned char> m_dirtyMask;
+
+  /** The offsets of the neighbours that the labelling operation reads for each pixel. */
+  std::vector<Vector2i> m_neighbourOffsets;
+
+  /** The squared distance (in voxels) that a raycast point must move before its pixel is deemed to have changed. */
+  float m_positionToleranceSquared;
+
+  /** The labels of the voxels under the pixels when they were last examined. */
+  std::vector<SpaintVoxel::PackedLabel> m_previousLabels;
+
+  /** The raycast points for the pixels when they were last deemed to have changed. */
+  std::vector<Vector4f> m_previousPositions;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a raycast change tracker.
+   *
+   * \param neighbourOffsets  The offsets of the neighbours that the labelling operation reads for each pixel.
+   * \param positionTolerance The distance (in voxels) that a raycast point must move before its pixel is deemed to have changed.
+   */
+  RaycastChangeTracker(const std::vector<Vector2i>& neighbourOffsets, float positionTolerance);
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Compares the specified raycast result and the labels of the voxels under it with those seen on the previous call.
+   *
+   * \note On the first call (or if the size of the raycast result changes), every pixel is deemed to have changed.
+   *
+   * \param raycastResult The raycast result.
+   * \param scene         The scene.
+   */
+  void detect_changes(const ORFloat4Image *raycastResult, const SpaintVoxelScene *scene);
+
+  /**
+   * \brief Finds the pixels that need to be reprocessed, i.e. those that have changed or that have a changed neighbour.
+   *
+   * \param width     The width of the raycast result.
+   * \param height    The height of the raycast result.
+   * \param forceAll  Whether or not to deem every pixel to be dirty (e.g. because a parameter of the operation has changed).
+   * \return          A compacted list of the indices of the pixels that need to be reprocessed.
+   */
+  const std::vector<int>& find_dirty_pixels(int width, int height, bool forceAll);
+
+  /**
+   * \brief Gets whether or not the raycast point for the specified pixel changed on the most recent call to detect_changes.
+   *
+   * \param pixelIndex  The index of the pixel.
+   * \return            true, if the raycast point for the pixel changed, or false otherwise.
+   */
+  bool position_changed(int pixelIndex) const;
+};
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "features/cpu/VOPFeatureCalculator_CPU.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
@@ -43,14 +44,41 @@ void VOPFeatureCalculator_CPU::calculate_surface_normals(const ORUtils::MemoryBl
 void VOPFeatureCalculator_CPU::convert_patches_to_lab(int voxelLocationCount, ORUtils::MemoryBlock<float>& featuresMB) const
 {
   const size_t featureCount = get_feature_count();
+  const int patchFeatureCount = static_cast<int>(m_patchSize * m_patchSize * 3);
   float *features = featuresMB.GetData(MEMORYDEVICE_CPU);
 
+  // Note: The RGB patches are sampled from the voxel colours, so their components are integers in [0,255] and individual
+  //       colours tend to recur many times across the patches. Rather than converting every pixel independently (which
+  //       needs three calls to pow per pixel), each thread therefore caches the CIELab colours it has already computed
+  //       in a small direct-mapped table. The table is filled on demand using the same conversion as convert_patch_to_lab,
+  //       so the results are identical.
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel
 #endif
-  for(int voxelLocationIndex = 0; voxelLocationIndex < voxelLocationCount; ++voxelLocationIndex)
   {
-    convert_patch_to_lab(voxelLocationIndex, featureCount, features);
+    std::vector<LabCacheEntry> labCache(1 << LAB_CACHE_BITS);
+
+#ifdef WITH_OPENMP
+    #pragma omp for
+#endif
+    for(int voxelLocationIndex = 0; voxelLocationIndex < voxelLocationCount; ++voxelLocationIndex)
+    {
+      float *patch = features + voxelLocationIndex * featureCount;
+      for(int i = 0; i < patchFeatureCount; i += 3)
+      {
+        const unsigned int rgb = (static_cast<unsigned int>(patch[i]) << 16) | (static_cast<unsigned int>(patch[i+1]) << 8) | static_cast<unsigned int>(patch[i+2]);
+        LabCacheEntry& entry = labCache[(rgb * 2654435761u) >> (32 - LAB_CACHE_BITS)];
+        if(entry.key != rgb + 1)
+        {
+          entry.key = rgb + 1;
+          entry.lab = itmx::convert_rgb_to_lab(Vector3f(patch[i] / 255.0f, patch[i+1] / 255.0f, patch[i+2] / 255.0f));
+        }
+
+        patch[i] = entry.lab.x;
+        patch[i+1] = entry.lab.y;
+        patch[i+2] = entry.lab.z;
+      }
+    }
   }
 }
 
@@ -114,39 +142,50 @@ void VOPFeatureCalculator_CPU::update_coordinate_systems(int voxelLocationCount,
   Vector3f *xAxes = m_xAxesMB->GetData(MEMORYDEVICE_CPU);
   Vector3f *yAxes = m_yAxesMB->GetData(MEMORYDEVICE_CPU);
 
-  std::vector<std::vector<float> > histograms(voxelLocationCount, std::vector<float>(m_binCount));
-  std::vector<std::vector<float> > intensities(voxelLocationCount, std::vector<float>(patchArea));
-
-  int threadCount = voxelLocationCount * patchArea;
-
-  // Convert each voxel's RGB patch to an intensity patch.
+  // Note: Unlike on the GPU, where there is a thread per patch pixel and the histogram bins are updated atomically,
+  //       here each thread processes whole voxels using its own intensity patch and histogram, so no atomics are needed.
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
+  #pragma omp parallel
 #endif
-  for(int tid = 0; tid < threadCount; ++tid)
   {
-    int voxelLocationIndex = tid / patchArea;
-    compute_intensities_for_patch(tid, features, featureCount, patchSize, &intensities[voxelLocationIndex][0]);
-  }
+    std::vector<float> histogram(m_binCount);
+    std::vector<float> intensities(patchArea);
+    std::vector<float> mags(patchSize), xDerivs(patchSize), yDerivs(patchSize);
 
-  // Compute a histogram of oriented gradients from the intensity patch for each voxel.
 #ifdef WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for(int tid = 0; tid < threadCount; ++tid)
-  {
-    int voxelLocationIndex = tid / patchArea;
-    compute_histogram_for_patch(tid, m_patchSize, &intensities[voxelLocationIndex][0], m_binCount, &histograms[voxelLocationIndex][0]);
-  }
-
-  // Calculate the dominant orientation for each voxel and rotate its coordinate system to align with that as necessary.
-#ifdef WITH_OPENMP
-  #pragma omp parallel for
+    #pragma omp for
 #endif
-  for(int tid = 0; tid < threadCount; ++tid)
-  {
-    int voxelLocationIndex = tid / patchArea;
-    update_coordinate_system(tid, patchArea, &histograms[voxelLocationIndex][0], m_binCount, &xAxes[voxelLocationIndex], &yAxes[voxelLocationIndex]);
+    for(int voxelLocationIndex = 0; voxelLocationIndex < voxelLocationCount; ++voxelLocationIndex)
+    {
+      // Convert the voxel's RGB patch to an intensity patch.
+      for(int indexInPatch = 0; indexInPatch < patchArea; ++indexInPatch)
+      {
+        compute_intensities_for_patch(voxelLocationIndex * patchArea + indexInPatch, features, featureCount, patchSize, &intensities[0]);
+      }
+
+      // Compute a histogram of oriented gradients from the intensity patch. For each row of the patch, we first compute
+      // the derivatives and magnitudes for all of the pixels in the row (this loop is easily vectorised by the compiler),
+      // and then quantize the orientations and accumulate the magnitudes into the histogram.
+      std::fill(histogram.begin(), histogram.end(), 0.0f);
+      for(int y = 1; y < patchSize - 1; ++y)
+      {
+        const float *row = &intensities[y * patchSize];
+        for(int x = 1; x < patchSize - 1; ++x)
+        {
+          xDerivs[x] = row[x + 1] - row[x - 1];
+          yDerivs[x] = row[x + patchSize] - row[x - patchSize];
+          mags[x] = sqrtf(xDerivs[x] * xDerivs[x] + yDerivs[x] * yDerivs[x]);
+        }
+
+        for(int x = 1; x < patchSize - 1; ++x)
+        {
+          histogram[compute_orientation_bin(xDerivs[x], yDerivs[x], m_binCount)] += mags[x];
+        }
+      }
+
+      // Calculate the dominant orientation for the voxel and rotate its coordinate system to align with that as necessary.
+      update_coordinate_system(0, patchArea, &histogram[0], m_binCount, &xAxes[voxelLocationIndex], &yAxes[voxelLocationIndex]);
+    }
   }
 }
 
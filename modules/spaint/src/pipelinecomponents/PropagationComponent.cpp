@@ -5,6 +5,8 @@
 
 #include "pipelinecomponents/PropagationComponent.h"
 
+#include <iostream>
+
 #include "propagation/LabelPropagatorFactory.h"
 
 namespace spaint {
@@ -12,23 +14,48 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 PropagationComponent::PropagationComponent(const PropagationContext_Ptr& context, const std::string& sceneID)
-: m_context(context), m_sceneID(sceneID)
+: m_context(context), m_propagationTimer("Label Propagation"), m_sceneID(sceneID)
 {
+  m_timePropagation = context->get_settings()->get_first_value<bool>("PropagationComponent.timePropagation", false);
+
   const Vector2i& depthImageSize = context->get_slam_state(sceneID)->get_depth_image_size();
   const int raycastResultSize = depthImageSize.width * depthImageSize.height;
   reset_label_propagator(raycastResultSize);
 }
 
+//#################### DESTRUCTOR ####################
+
+PropagationComponent::~PropagationComponent()
+{
+  if(m_timePropagation && m_propagationTimer.count() > 0)
+  {
+    std::cout << m_propagationTimer.name() << ": " << m_propagationTimer.count() << " frames, avg: " << m_propagationTimer.average_duration() << '\n';
+  }
+}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void PropagationComponent::reset_label_propagator(int raycastResultSize)
 {
-  m_labelPropagator = LabelPropagatorFactory::make_label_propagator(raycastResultSize, m_context->get_settings()->deviceType);
+  const Settings_CPtr& settings = m_context->get_settings();
+
+  // If requested, make the propagator only reprocess the parts of the raycast result whose neighbourhoods have changed
+  // since its previous pass, so that its per-frame cost scales with the amount of change rather than the image size.
+  const bool incremental = settings->get_first_value<bool>("PropagationComponent.incremental", false);
+
+  const float maxAngleBetweenNormals = static_cast<float>(2.0f * M_PI / 180.0f);
+  const float maxSquaredDistanceBetweenColours = 50.0f * 50.0f;
+  const float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f;
+  m_labelPropagator = LabelPropagatorFactory::make_label_propagator(
+    raycastResultSize, settings->deviceType, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, incremental
+  );
 }
 
 void PropagationComponent::run(const VoxelRenderState_CPtr& renderState)
 {
+  if(m_timePropagation) m_propagationTimer.start_sync();
   m_labelPropagator->propagate_label(m_context->get_semantic_label(), renderState->raycastResult, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get());
+  if(m_timePropagation) m_propagationTimer.stop_sync();
 }
 
 }
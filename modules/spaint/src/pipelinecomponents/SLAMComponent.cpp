@@ -48,6 +48,7 @@ SLAMComponent::SLAMComponent(const SLAMContext_Ptr& context, const std::string&
 : m_context(context),
   m_detectFiducials(detectFiducials),
   m_fallibleTracker(NULL),
+  m_globalPosesSpecifier(context->get_settings(), "globalPosesSpecifier", ""),
   m_imageSourceEngine(imageSourceEngine),
   m_initialFramesToFuse(50), // FIXME: This value should be passed in rather than hard-coded.
   m_mappingMode(mappingMode),
@@ -127,6 +128,11 @@ bool SLAMComponent::get_fusion_enabled() const
   return m_fusionEnabled;
 }
 
+const std::string& SLAMComponent::get_mirror_scene_id() const
+{
+  return m_mirrorSceneID;
+}
+
 const std::string& SLAMComponent::get_scene_id() const
 {
   return m_sceneID;
@@ -202,9 +208,12 @@ bool SLAMComponent::process_frame()
   const View_Ptr& view = slamState->get_view();
   const SpaintVoxelScene_Ptr& voxelScene = slamState->get_voxel_scene();
 
-  // Get the next frame.
+  // If we're recording latencies, start timing the stages of processing the frame.
+  LatencyRecorder::StageTimer stageTimer(m_latencyRecorder, m_sceneID + ": ");
+
+  // Get the next frame. Note that this may replace the input images in the SLAM state (the references above will refer to the new ones).
   ITMView *newView = view.get();
-  m_imageSourceEngine->getImages(inputRGBImage.get(), inputRawDepthImage.get());
+  read_input_images(slamState);
   const bool useBilateralFilter = m_trackingMode == TRACK_SURFELS;
   m_viewBuilder->UpdateView(&newView, inputRGBImage.get(), inputRawDepthImage.get(), useBilateralFilter);
   slamState->set_view(newView);
@@ -220,6 +229,8 @@ bool SLAMComponent::process_frame()
     view->depth->Swap(*maskedDepthImage);
   }
 
+  stageTimer.finish_stage("Input");
+
   // Make a note of the current pose in case tracking fails.
   SE3Pose oldPose(*trackingState->pose_d);
 
@@ -240,6 +251,8 @@ bool SLAMComponent::process_frame()
   // If there was an active input mask, restore the original depth image after tracking.
   if(maskedDepthImage) view->depth->Swap(*maskedDepthImage);
 
+  stageTimer.finish_stage("Tracking");
+
   // Determine the tracking quality, taking into account the failure mode being used.
   switch(m_context->get_settings()->behaviourOnFailure)
   {
@@ -268,6 +281,8 @@ bool SLAMComponent::process_frame()
     }
   }
 
+  stageTimer.finish_stage("Relocalisation");
+
   // Decide whether or not fusion should be run.
   bool runFusion = m_fusionEnabled;
   if(trackingState->trackerResult == ITMTrackingState::TRACKING_FAILED ||
@@ -320,6 +335,8 @@ bool SLAMComponent::process_frame()
     *trackingState->pose_d = oldPose;
   }
 
+  stageTimer.finish_stage("Fusion");
+
   // Render from the live camera position to prepare for tracking in the next frame.
   prepare_for_tracking(m_trackingMode);
 
@@ -329,9 +346,11 @@ bool SLAMComponent::process_frame()
     m_context->get_surfel_visualisation_engine()->FindSurfaceSuper(surfelScene.get(), trackingState->pose_d, &view->calib.intrinsics_d, USR_RENDER, liveSurfelRenderState.get());
   }
 
+  stageTimer.finish_stage("Raycast");
+
   // If we're using a composite image source engine, the current sub-engine has run out of images and we're not using global poses, disable fusion.
   CompositeImageSourceEngine_CPtr compositeImageSourceEngine = boost::dynamic_pointer_cast<const CompositeImageSourceEngine>(m_imageSourceEngine);
-  const bool usingGlobalPoses = m_context->get_settings()->get_first_value<std::string>("globalPosesSpecifier", "") != "";
+  const bool usingGlobalPoses = !m_globalPosesSpecifier.get().empty();
   if(compositeImageSourceEngine && !compositeImageSourceEngine->getCurrentSubengine()->hasMoreImages() && !usingGlobalPoses) m_fusionEnabled = false;
 
   // If we're using a fiducial detector and the user wants to detect fiducials and the tracking is good, try to detect fiducial markers
@@ -433,6 +452,11 @@ void SLAMComponent::set_fusion_enabled(bool fusionEnabled)
   m_fusionEnabled = fusionEnabled;
 }
 
+void SLAMComponent::set_latency_recorder(const LatencyRecorder_Ptr& latencyRecorder)
+{
+  m_latencyRecorder = latencyRecorder;
+}
+
 void SLAMComponent::set_mapping_client(const MappingClient_Ptr& mappingClient)
 {
   m_context->get_mapping_client(m_sceneID) = mappingClient;
@@ -584,6 +608,40 @@ void SLAMComponent::process_relocalisation()
   }
 }
 
+void SLAMComponent::read_input_images(const SLAMState_Ptr& slamState)
+{
+  // Find the asynchronous or sensor clock image source (if any) from which the next frame will come. Note that the current sub-engine
+  // of a composite image source is only exposed as const, but it is safe to read from it, since it is owned by the composite.
+  const ImageSourceEngine *currentImageSourceEngine = m_imageSourceEngine.get();
+  CompositeImageSourceEngine_CPtr compositeImageSourceEngine = boost::dynamic_pointer_cast<const CompositeImageSourceEngine>(m_imageSourceEngine);
+  if(compositeImageSourceEngine) currentImageSourceEngine = compositeImageSourceEngine->getCurrentSubengine();
+  ImageSourceEngine *mutableImageSourceEngine = const_cast<ImageSourceEngine*>(currentImageSourceEngine);
+  AsyncImageSourceEngine *asyncImageSourceEngine = dynamic_cast<AsyncImageSourceEngine*>(mutableImageSourceEngine);
+  SensorClockImageSourceEngine *sensorClockImageSourceEngine = dynamic_cast<SensorClockImageSourceEngine*>(mutableImageSourceEngine);
+
+  if(asyncImageSourceEngine || sensorClockImageSourceEngine)
+  {
+    // If there is such a source, borrow the next RGB-D image from it and use its images as the input images, rather than copying them.
+    // The previously borrowed RGB-D image (if any) is released (and returned to the source) when it is replaced.
+    m_borrowedImages = asyncImageSourceEngine ? asyncImageSourceEngine->borrow_images() : sensorClockImageSourceEngine->borrow_images();
+    slamState->set_input_rgb_image(m_borrowedImages->rgb);
+    slamState->set_input_raw_depth_image(m_borrowedImages->rawDepth);
+  }
+  else
+  {
+    // Otherwise, if the input images currently belong to a borrowed RGB-D image, replace them with images of our own before releasing it.
+    if(m_borrowedImages)
+    {
+      slamState->set_input_rgb_image(ORUChar4Image_Ptr(new ORUChar4Image(m_borrowedImages->rgb->noDims, true, true)));
+      slamState->set_input_raw_depth_image(ORShortImage_Ptr(new ORShortImage(m_borrowedImages->rawDepth->noDims, true, true)));
+      m_borrowedImages.reset();
+    }
+
+    // Copy the next frame into the input images.
+    m_imageSourceEngine->getImages(slamState->get_input_rgb_image().get(), slamState->get_input_raw_depth_image().get());
+  }
+}
+
 Relocaliser_Ptr SLAMComponent::refine_with_icp(const Relocaliser_Ptr& relocaliser) const
 {
   const Vector2i depthImageSize = m_imageSourceEngine->getDepthImageSize();
@@ -21,26 +21,31 @@ void SLAMContext::add_scene_id(const std::string& sceneID)
 
 FiducialDetector_CPtr SLAMContext::get_fiducial_detector(const std::string& sceneID) const
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   return MapUtil::lookup(m_fiducialDetectors, sceneID, FiducialDetector_CPtr());
 }
 
 MappingClient_Ptr& SLAMContext::get_mapping_client(const std::string& sceneID)
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   return m_mappingClients[sceneID];
 }
 
 MappingClient_CPtr SLAMContext::get_mapping_client(const std::string& sceneID) const
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   return MapUtil::lookup(m_mappingClients, sceneID, itmx::MappingClient_Ptr());
 }
 
 Relocaliser_Ptr& SLAMContext::get_relocaliser(const std::string& sceneID)
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   return m_relocalisers[sceneID];
 }
 
 Relocaliser_CPtr SLAMContext::get_relocaliser(const std::string& sceneID) const
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   return MapUtil::lookup(m_relocalisers, sceneID);
 }
 
@@ -51,6 +56,7 @@ const std::vector<std::string>& SLAMContext::get_scene_ids() const
 
 const SLAMState_Ptr& SLAMContext::get_slam_state(const std::string& sceneID)
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   SLAMState_Ptr& result = m_slamStates[sceneID];
   if(!result) result.reset(new SLAMState);
   return result;
@@ -58,12 +64,14 @@ const SLAMState_Ptr& SLAMContext::get_slam_state(const std::string& sceneID)
 
 SLAMState_CPtr SLAMContext::get_slam_state(const std::string& sceneID) const
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   std::map<std::string,SLAMState_Ptr>::const_iterator it = m_slamStates.find(sceneID);
   return it != m_slamStates.end() ? it->second : SLAMState_CPtr();
 }
 
 void SLAMContext::set_fiducial_detector(const std::string& sceneID, const FiducialDetector_CPtr& fiducialDetector)
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   m_fiducialDetectors[sceneID] = fiducialDetector;
 }
 
@@ -5,6 +5,8 @@
 
 #include "pipelinecomponents/SemanticSegmentationComponent.h"
 
+#include <iostream>
+
 #ifdef WITH_OPENCV
 #include <itmx/ocv/OpenCVUtil.h>
 #endif
@@ -28,7 +30,7 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 SemanticSegmentationComponent::SemanticSegmentationComponent(const SemanticSegmentationContext_Ptr& context, const std::string& sceneID, unsigned int seed)
-: m_context(context), m_sceneID(sceneID), m_seed(seed)
+: m_context(context), m_predictionTimer("Forest Prediction"), m_sceneID(sceneID), m_seed(seed)
 {
   // Set the maximum numbers of voxels to use for training and prediction.
   // FIXME: These values shouldn't be hard-coded here ultimately.
@@ -69,6 +71,10 @@ SemanticSegmentationComponent::SemanticSegmentationComponent(const SemanticSegme
   m_trainingLabelMaskMB = mbf.make_block<bool>(maxLabelCount);
   m_trainingVoxelCountsMB = mbf.make_block<unsigned int>(maxLabelCount);
   m_trainingVoxelLocationsMB = mbf.make_block<Vector3s>(maxTrainingVoxelCount);
+  m_predictedLabels.resize(m_maxPredictionVoxelCount);
+
+  // Determine whether or not to time the forest prediction stage.
+  m_timePrediction = settings->get_first_value<bool>("SemanticSegmentationComponent.timePrediction", false);
 
   // Register the relevant decision function generators with the factory.
   DecisionFunctionGeneratorFactory<SpaintVoxel::Label>::instance().register_maker(
@@ -80,6 +86,16 @@ SemanticSegmentationComponent::SemanticSegmentationComponent(const SemanticSegme
   reset_forest();
 }
 
+//#################### DESTRUCTOR ####################
+
+SemanticSegmentationComponent::~SemanticSegmentationComponent()
+{
+  if(m_timePrediction && m_predictionTimer.count() > 0)
+  {
+    std::cout << m_predictionTimer.name() << ": " << m_predictionTimer.count() << " frames, avg: " << m_predictionTimer.average_duration() << '\n';
+  }
+}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void SemanticSegmentationComponent::reset_forest()
@@ -87,6 +103,8 @@ void SemanticSegmentationComponent::reset_forest()
   const size_t treeCount = 5;
   DecisionTree<SpaintVoxel::Label>::Settings dtSettings(m_context->get_resources_dir() + "/RaflSettings.xml");
   m_forest.reset(new RandomForest<SpaintVoxel::Label>(treeCount, dtSettings));
+  m_compiledForest.reset();
+  m_trainedSinceLastPrediction = false;
 }
 
 void SemanticSegmentationComponent::reset_voxel_samplers(int raycastResultSize)
@@ -138,9 +156,29 @@ void SemanticSegmentationComponent::run_prediction(const VoxelRenderState_CPtr&
 
   // Calculate feature descriptors for the sampled voxels.
   m_featureCalculator->calculate_features(*m_predictionVoxelLocationsMB, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get(), *m_predictionFeaturesMB);
-  std::vector<Descriptor_CPtr> descriptors = ForestUtil::make_descriptors(*m_predictionFeaturesMB, m_maxPredictionVoxelCount, m_featureCalculator->get_feature_count());
+  m_predictionFeaturesMB->UpdateHostFromDevice();
+
+  // Predict labels for the voxels based on the feature descriptors. Note that we predict directly from the feature
+  // memory block (rather than first wrapping each feature vector in a separate descriptor) to avoid per-voxel allocations.
+  // If the forest is still being trained, it will change again before the next prediction, so compiling it would not pay
+  // off, and we predict using the live forest. Once training has stopped, we compile the forest (once) and predict using
+  // the compiled version, which makes exactly the same predictions as the live forest but is much cheaper to evaluate.
+  const float *features = m_predictionFeaturesMB->GetData(MEMORYDEVICE_CPU);
+  const size_t featureCount = m_featureCalculator->get_feature_count();
+  if(m_timePrediction) m_predictionTimer.start_nosync();
+  if(m_trainedSinceLastPrediction)
+  {
+    m_forest->predict_batch(features, m_maxPredictionVoxelCount, featureCount, &m_predictedLabels[0]);
+    m_trainedSinceLastPrediction = false;
+  }
+  else
+  {
+    if(!m_compiledForest) m_compiledForest.reset(new CompiledForest<SpaintVoxel::Label>(*m_forest));
+    m_compiledForest->predict_batch(features, m_maxPredictionVoxelCount, featureCount, &m_predictedLabels[0]);
+  }
+  if(m_timePrediction) m_predictionTimer.stop_nosync();
 
-  // Predict labels for the voxels based on the feature descriptors.
+  // Pack the predicted labels so that they can be used to mark the voxels.
   SpaintVoxel::PackedLabel *labels = m_predictionLabelsMB->GetData(MEMORYDEVICE_CPU);
 
 #ifdef WITH_OPENMP
@@ -148,7 +186,7 @@ void SemanticSegmentationComponent::run_prediction(const VoxelRenderState_CPtr&
 #endif
   for(int i = 0; i < static_cast<int>(m_maxPredictionVoxelCount); ++i)
   {
-    labels[i] = SpaintVoxel::PackedLabel(m_forest->predict(descriptors[i]), SpaintVoxel::LG_FOREST);
+    labels[i] = SpaintVoxel::PackedLabel(m_predictedLabels[i], SpaintVoxel::LG_FOREST);
   }
 
   m_predictionLabelsMB->UpdateDeviceFromHost();
@@ -209,6 +247,11 @@ void SemanticSegmentationComponent::run_training(const VoxelRenderState_CPtr& re
   const size_t splitBudget = 20;
   m_forest->add_examples(examples);
   m_forest->train(splitBudget);
+
+  // Since the forest has changed (adding examples alone changes the PMFs at its leaves), the compiled version of it is now
+  // out of date. Rather than recompiling it straight away, we wait until we know that training has stopped (see run_prediction).
+  m_compiledForest.reset();
+  m_trainedSinceLastPrediction = true;
 }
 
 }
@@ -5,6 +5,8 @@
 
 #include "pipelinecomponents/SmoothingComponent.h"
 
+#include <iostream>
+
 #include "smoothing/LabelSmootherFactory.h"
 
 namespace spaint {
@@ -12,17 +14,36 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 SmoothingComponent::SmoothingComponent(const SmoothingContext_Ptr& context, const std::string& sceneID)
-: m_context(context), m_sceneID(sceneID)
+: m_context(context), m_sceneID(sceneID), m_smoothingTimer("Label Smoothing")
 {
+  const Settings_CPtr& settings = context->get_settings();
+  m_timeSmoothing = settings->get_first_value<bool>("SmoothingComponent.timeSmoothing", false);
+
+  // If requested, make the smoother only reprocess the parts of the raycast result whose neighbourhoods have changed since its previous pass.
+  const bool incremental = settings->get_first_value<bool>("SmoothingComponent.incremental", false);
+
   size_t maxLabelCount = context->get_label_manager()->get_max_label_count();
-  m_labelSmoother = LabelSmootherFactory::make_label_smoother(maxLabelCount, context->get_settings()->deviceType);
+  const float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f;
+  m_labelSmoother = LabelSmootherFactory::make_label_smoother(maxLabelCount, settings->deviceType, maxSquaredDistanceBetweenVoxels, incremental);
+}
+
+//#################### DESTRUCTOR ####################
+
+SmoothingComponent::~SmoothingComponent()
+{
+  if(m_timeSmoothing && m_smoothingTimer.count() > 0)
+  {
+    std::cout << m_smoothingTimer.name() << ": " << m_smoothingTimer.count() << " frames, avg: " << m_smoothingTimer.average_duration() << '\n';
+  }
 }
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void SmoothingComponent::run(const VoxelRenderState_CPtr& renderState)
 {
+  if(m_timeSmoothing) m_smoothingTimer.start_sync();
   m_labelSmoother->smooth_labels(renderState->raycastResult, m_context->get_slam_state(m_sceneID)->get_voxel_scene().get());
+  if(m_timeSmoothing) m_smoothingTimer.stop_sync();
 }
 
 }
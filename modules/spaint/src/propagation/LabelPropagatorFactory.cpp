@@ -19,7 +19,7 @@ namespace spaint {
 
 LabelPropagator_CPtr LabelPropagatorFactory::make_label_propagator(size_t raycastResultSize, DeviceType deviceType,
                                                                    float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours,
-                                                                   float maxSquaredDistanceBetweenVoxels)
+                                                                   float maxSquaredDistanceBetweenVoxels, bool incremental)
 {
   LabelPropagator_CPtr propagator;
 
@@ -34,7 +34,7 @@ LabelPropagator_CPtr LabelPropagatorFactory::make_label_propagator(size_t raycas
   }
   else
   {
-    propagator.reset(new LabelPropagator_CPU(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels));
+    propagator.reset(new LabelPropagator_CPU(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, incremental));
   }
 
   return propagator;
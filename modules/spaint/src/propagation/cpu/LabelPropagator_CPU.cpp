@@ -11,9 +11,30 @@ namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-LabelPropagator_CPU::LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels)
-: LabelPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels)
-{}
+LabelPropagator_CPU::LabelPropagator_CPU(size_t raycastResultSize, float maxAngleBetweenNormals, float maxSquaredDistanceBetweenColours, float maxSquaredDistanceBetweenVoxels,
+                                         bool incremental)
+: LabelPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels),
+  m_previousLabel(-1)
+{
+  if(incremental)
+  {
+    // The propagation decision for a pixel reads the pixels at offsets of 2 and 5 along each image axis.
+    std::vector<Vector2i> neighbourOffsets;
+    const int distances[] = { 2, 5 };
+    for(int i = 0; i < 2; ++i)
+    {
+      const int d = distances[i];
+      neighbourOffsets.push_back(Vector2i(-d, 0));
+      neighbourOffsets.push_back(Vector2i(d, 0));
+      neighbourOffsets.push_back(Vector2i(0, -d));
+      neighbourOffsets.push_back(Vector2i(0, d));
+    }
+
+    // Raycast points that move by less than a tenth of a voxel are treated as unchanged (their normals are also not recomputed).
+    const float positionTolerance = 0.1f;
+    m_changeTracker.reset(new RaycastChangeTracker(neighbourOffsets, positionTolerance));
+  }
+}
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
@@ -25,17 +46,83 @@ void LabelPropagator_CPU::calculate_normals(const ORFloat4Image *raycastResult,
   Vector3f *surfaceNormals = m_surfaceNormalsMB->GetData(MEMORYDEVICE_CPU);
   const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
 
+  // If propagation is incremental, find out which pixels have changed since the previous pass. Only the normals
+  // of pixels whose raycast points have moved need to be recomputed.
+  RaycastChangeTracker *changeTracker = m_changeTracker.get();
+  if(changeTracker) changeTracker->detect_changes(raycastResult, scene);
+
 #ifdef WITH_OPENMP
   #pragma omp parallel for
 #endif
   for(int voxelIndex = 0; voxelIndex < raycastResultSize; ++voxelIndex)
   {
-    write_surface_normal(voxelIndex, raycastResultData, voxelData, indexData, surfaceNormals);
+    if(!changeTracker || changeTracker->position_changed(voxelIndex))
+    {
+      write_surface_normal(voxelIndex, raycastResultData, voxelData, indexData, surfaceNormals);
+    }
+  }
+}
+
+void LabelPropagator_CPU::perform_incremental_propagation(SpaintVoxel::Label label, const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const
+{
+  const int height = raycastResult->noDims.y;
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  const Vector3f *surfaceNormals = m_surfaceNormalsMB->GetData(MEMORYDEVICE_CPU);
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const int width = raycastResult->noDims.x;
+
+  // Find the pixels whose neighbourhoods have changed since the previous pass. If the label being propagated
+  // has changed, every pixel needs to be reprocessed.
+  const bool labelChanged = static_cast<int>(label) != m_previousLabel;
+  m_previousLabel = static_cast<int>(label);
+  const std::vector<int>& dirtyPixels = m_changeTracker->find_dirty_pixels(width, height, labelChanged);
+  const int dirtyPixelCount = static_cast<int>(dirtyPixels.size());
+  if(dirtyPixelCount == 0) return;
+
+  // Decide which of the dirty pixels should be marked. The decisions are made before any voxels are marked, so that
+  // they do not depend on the order in which the pixels are processed. Any marks made will show up as label changes
+  // on the next pass, causing the propagation to continue from them.
+  m_shouldMarkFlags.resize(dirtyPixelCount);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < dirtyPixelCount; ++i)
+  {
+    m_shouldMarkFlags[i] = should_propagate_to_voxel(
+      dirtyPixels[i], width, height, label, raycastResultData, surfaceNormals, voxelData, indexData,
+      m_maxAngleBetweenNormals, m_maxSquaredDistanceBetweenColours, m_maxSquaredDistanceBetweenVoxels
+    ) ? 1 : 0;
+  }
+
+  // Compact the pixels to be marked into a list, and mark their voxels.
+  m_pixelsToMark.clear();
+  for(int i = 0; i < dirtyPixelCount; ++i)
+  {
+    if(m_shouldMarkFlags[i]) m_pixelsToMark.push_back(dirtyPixels[i]);
+  }
+
+  const int markCount = static_cast<int>(m_pixelsToMark.size());
+  const SpaintVoxel::PackedLabel packedLabel(label, SpaintVoxel::LG_PROPAGATED);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < markCount; ++i)
+  {
+    mark_voxel(raycastResultData[m_pixelsToMark[i]].toVector3().toShortRound(), packedLabel, NULL, voxelData, indexData);
   }
 }
 
 void LabelPropagator_CPU::perform_propagation(SpaintVoxel::Label label, const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const
 {
+  if(m_changeTracker)
+  {
+    perform_incremental_propagation(label, raycastResult, scene);
+    return;
+  }
+
   const int height = raycastResult->noDims.y;
   const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
   const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
@@ -5,6 +5,7 @@
 
 #include "segmentation/BackgroundSubtractingObjectSegmenter.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <boost/serialization/shared_ptr.hpp>
@@ -63,35 +64,15 @@ ORUCharImage_CPtr BackgroundSubtractingObjectSegmenter::segment(const ORUtils::S
   // Make the change mask.
   ORUCharImage_CPtr changeMask = make_change_mask(depthInput, pose, renderState);
 
-  // Make the hand mask.
+  // Make the hand mask, which contains all of the changed pixels whose colours make them likely to be part of the hand.
+  // If we don't have a hand appearance model, no pixel is considered to be part of the hand.
   static cv::Mat1b handMask = cv::Mat1b::zeros(m_view->rgb->noDims.y, m_view->rgb->noDims.x);
-  const Vector4u *rgbPtr = rgbInput->GetData(MEMORYDEVICE_CPU);
   const uchar *changeMaskPtr = changeMask->GetData(MEMORYDEVICE_CPU);
   const int pixelCount = static_cast<int>(rgbInput->dataSize);
+  const int handProbThreshold = 100 - objectProbThreshold;
 
-  // For each pixel in the current colour input image:
-#if WITH_OPENMP
-  #pragma omp parallel for
-#endif
-  for(int i = 0; i < pixelCount; ++i)
-  {
-    // Update the hand mask based on whether the pixel is part of the hand.
-    unsigned char value = 0;
-    if(changeMaskPtr[i])
-    {
-      float handProb = m_handAppearanceModel ? m_handAppearanceModel->compute_posterior_probability(rgbPtr[i].toVector3()) : 0.0f;
-      int handProbThreshold = 100 - objectProbThreshold;
-
-#if 1
-      if(handProb >= handProbThreshold / 100.0f) value = 255;
-#else
-      // For debugging purposes
-      if(handProb >= handProbThreshold / 100.0f) value = (uchar)(handProb * 255);
-#endif
-    }
-
-    handMask.data[i] = value;
-  }
+  if(m_handAppearanceModel) m_handAppearanceModel->compute_object_mask(rgbInput, changeMask, handProbThreshold / 100.0f, handMask.data);
+  else std::fill(handMask.data, handMask.data + pixelCount, 0);
 
   // If desired, update the hand mask to only contain components over a certain size.
   if(removeSmallHandComponents)
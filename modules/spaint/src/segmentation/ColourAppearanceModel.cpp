@@ -16,32 +16,38 @@ namespace spaint {
 //#################### CONSTRUCTORS ####################
 
 ColourAppearanceModel::ColourAppearanceModel(int binsCb, int binsCr)
-: m_binsCb(binsCb), m_binsCr(binsCr)
+: m_binsCb(binsCb), m_binsCr(binsCr), m_posteriors(binsCb * binsCr, 0.5f)
 {}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
-float ColourAppearanceModel::compute_posterior_probability(const Vector3u& rgbColour) const
+void ColourAppearanceModel::compute_object_mask(const ORUChar4Image_CPtr& image, const ORUCharImage_CPtr& candidateMask, float threshold, unsigned char *objectMask) const
 {
-  // If we haven't yet seen enough training data to successfully build our appearance model, early out.
-  if(!m_pmfColourGivenObject || !m_pmfColourGivenNotObject) return 0.5f;
+  // Threshold the posterior probabilities for the bins up-front, so that each pixel only needs a single lookup once it has been binned.
+  const int binCount = static_cast<int>(m_posteriors.size());
+  std::vector<unsigned char> binValues(binCount);
+  for(int bin = 0; bin < binCount; ++bin)
+  {
+    binValues[bin] = m_posteriors[bin] >= threshold ? 255 : 0;
+  }
 
-  /*
-  P(object | colour) =                   P(colour | object) * P(object)
-                       -----------------------------------------------------------------
-                       P(colour | object) * P(object) + P(colour | !object) * P(!object)
+  // Make the object mask.
+  const Vector4u *imagePtr = image->GetData(MEMORYDEVICE_CPU);
+  const uchar *candidateMaskPtr = candidateMask->GetData(MEMORYDEVICE_CPU);
+  const int pixelCount = static_cast<int>(image->dataSize);
 
-  For simplicity, assume that P(object) = P(!object) = 0.5. Then:
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    objectMask[i] = candidateMaskPtr[i] ? binValues[compute_bin(imagePtr[i].toVector3())] : 0;
+  }
+}
 
-  P(object | colour) =            P(colour | object)
-                       ----------------------------------------
-                       P(colour | object) + P(colour | !object)
-  */
-  int bin = compute_bin(rgbColour);
-  float colourGivenObject = MapUtil::lookup(m_pmfColourGivenObject->get_masses(), bin, 0.0f);
-  float colourGivenNotObject = MapUtil::lookup(m_pmfColourGivenNotObject->get_masses(), bin, 0.0f);
-  float denom = colourGivenObject + colourGivenNotObject;
-  return denom > 0.0f ? colourGivenObject / denom : 0.5f;
+float ColourAppearanceModel::compute_posterior_probability(const Vector3u& rgbColour) const
+{
+  return m_posteriors[compute_bin(rgbColour)];
 }
 
 void ColourAppearanceModel::train(const ORUChar4Image_CPtr& image, const ORUCharImage_CPtr& objectMask)
@@ -58,6 +64,32 @@ void ColourAppearanceModel::train(const ORUChar4Image_CPtr& image, const ORUChar
   // Update the likelihood PMFs from the histograms.
   if(m_histColourGivenObject.get_count() > 0) m_pmfColourGivenObject.reset(new ProbabilityMassFunction<int>(m_histColourGivenObject));
   if(m_histColourGivenNotObject.get_count() > 0) m_pmfColourGivenNotObject.reset(new ProbabilityMassFunction<int>(m_histColourGivenNotObject));
+
+  // If we haven't yet seen enough training data to successfully build our appearance model, early out (the posterior
+  // probabilities will remain at 0.5 for every bin).
+  if(!m_pmfColourGivenObject || !m_pmfColourGivenNotObject) return;
+
+  // Otherwise, update the posterior probabilities for every bin (they can all change, since the PMFs are renormalised).
+  /*
+  P(object | colour) =                   P(colour | object) * P(object)
+                       -----------------------------------------------------------------
+                       P(colour | object) * P(object) + P(colour | !object) * P(!object)
+
+  For simplicity, assume that P(object) = P(!object) = 0.5. Then:
+
+  P(object | colour) =            P(colour | object)
+                       ----------------------------------------
+                       P(colour | object) + P(colour | !object)
+  */
+  const std::map<int,float>& massesGivenObject = m_pmfColourGivenObject->get_masses();
+  const std::map<int,float>& massesGivenNotObject = m_pmfColourGivenNotObject->get_masses();
+  for(int bin = 0, binCount = static_cast<int>(m_posteriors.size()); bin < binCount; ++bin)
+  {
+    float colourGivenObject = MapUtil::lookup(massesGivenObject, bin, 0.0f);
+    float colourGivenNotObject = MapUtil::lookup(massesGivenNotObject, bin, 0.0f);
+    float denom = colourGivenObject + colourGivenNotObject;
+    m_posteriors[bin] = denom > 0.0f ? colourGivenObject / denom : 0.5f;
+  }
 }
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
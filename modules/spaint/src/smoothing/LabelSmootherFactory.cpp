@@ -17,7 +17,7 @@ namespace spaint {
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
-LabelSmoother_CPtr LabelSmootherFactory::make_label_smoother(size_t maxLabelCount, DeviceType deviceType, float maxSquaredDistanceBetweenVoxels)
+LabelSmoother_CPtr LabelSmootherFactory::make_label_smoother(size_t maxLabelCount, DeviceType deviceType, float maxSquaredDistanceBetweenVoxels, bool incremental)
 {
   LabelSmoother_CPtr smoother;
 
@@ -31,7 +31,7 @@ LabelSmoother_CPtr LabelSmootherFactory::make_label_smoother(size_t maxLabelCoun
   }
   else
   {
-    smoother.reset(new LabelSmoother_CPU(maxLabelCount, maxSquaredDistanceBetweenVoxels));
+    smoother.reset(new LabelSmoother_CPU(maxLabelCount, maxSquaredDistanceBetweenVoxels, incremental));
   }
 
   return smoother;
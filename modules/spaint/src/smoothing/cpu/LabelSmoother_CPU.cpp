@@ -11,14 +11,36 @@ namespace spaint {
 
 //#################### CONSTRUCTORS ####################
 
-LabelSmoother_CPU::LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels)
+LabelSmoother_CPU::LabelSmoother_CPU(size_t maxLabelCount, float maxSquaredDistanceBetweenVoxels, bool incremental)
 : LabelSmoother(maxLabelCount, maxSquaredDistanceBetweenVoxels)
-{}
+{
+  if(incremental)
+  {
+    // The smoothing decision for a pixel reads its 8-connected neighbours.
+    std::vector<Vector2i> neighbourOffsets;
+    for(int dy = -1; dy <= 1; ++dy)
+    {
+      for(int dx = -1; dx <= 1; ++dx)
+      {
+        if(dx != 0 || dy != 0) neighbourOffsets.push_back(Vector2i(dx, dy));
+      }
+    }
+
+    const float positionTolerance = 0.1f;
+    m_changeTracker.reset(new RaycastChangeTracker(neighbourOffsets, positionTolerance));
+  }
+}
 
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void LabelSmoother_CPU::smooth_labels(const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const
 {
+  if(m_changeTracker)
+  {
+    smooth_labels_incrementally(raycastResult, scene);
+    return;
+  }
+
   const int height = raycastResult->noDims.y;
   const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
   const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
@@ -35,4 +57,43 @@ void LabelSmoother_CPU::smooth_labels(const ORFloat4Image *raycastResult, Spaint
   }
 }
 
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+void LabelSmoother_CPU::smooth_labels_incrementally(const ORFloat4Image *raycastResult, SpaintVoxelScene *scene) const
+{
+  const int height = raycastResult->noDims.y;
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+  const int width = raycastResult->noDims.x;
+
+  // Find the pixels whose neighbourhoods have changed since the previous pass.
+  m_changeTracker->detect_changes(raycastResult, scene);
+  const std::vector<int>& dirtyPixels = m_changeTracker->find_dirty_pixels(width, height, false);
+  const int dirtyPixelCount = static_cast<int>(dirtyPixels.size());
+  if(dirtyPixelCount == 0) return;
+
+  // Calculate the smoothed labels for the dirty pixels before marking any voxels, so that the results
+  // do not depend on the order in which the pixels are processed.
+  m_smoothedLabels.resize(dirtyPixelCount);
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int i = 0; i < dirtyPixelCount; ++i)
+  {
+    m_smoothedLabels[i] = calculate_smoothed_label(dirtyPixels[i], width, height, static_cast<int>(m_maxLabelCount), raycastResultData, voxelData, indexData, m_maxSquaredDistanceBetweenVoxels);
+  }
+
+  // Mark the voxels for which a smoothed label was found.
+  for(int i = 0; i < dirtyPixelCount; ++i)
+  {
+    const SpaintVoxel::Label label = m_smoothedLabels[i];
+    if(label != 0)
+    {
+      mark_voxel(raycastResultData[dirtyPixels[i]].toVector3().toShortRound(), SpaintVoxel::PackedLabel(label, SpaintVoxel::LG_PROPAGATED), NULL, voxelData, indexData);
+    }
+  }
+}
+
 }
@@ -5,6 +5,8 @@
 #include "touch/TouchDescriptorCalculator.h"
 using namespace rafl;
 
+#include <algorithm>
+
 namespace spaint {
 
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
@@ -22,4 +24,19 @@ Descriptor_CPtr TouchDescriptorCalculator::calculate_histogram_descriptor(const
   return Descriptor_CPtr(new Descriptor(afHistogramPtr, afHistogramPtr + binCount));
 }
 
+Descriptor_CPtr TouchDescriptorCalculator::calculate_histogram_descriptor(const std::vector<int>& valueHistogram)
+{
+  // Combine the bins of the value histogram into the bins used by ArrayFire. Each of these covers a range of width 255 / binCount,
+  // and a value v falls into bin floor(v * binCount / 255) (with the maximum value falling into the last bin).
+  const int binCount = 64;
+  const int maxVal = 255;
+  Descriptor_Ptr descriptor(new Descriptor(binCount, 0.0f));
+  for(int value = 0, valueCount = static_cast<int>(valueHistogram.size()); value < valueCount; ++value)
+  {
+    const int bin = std::min(value * binCount / maxVal, binCount - 1);
+    (*descriptor)[bin] += static_cast<float>(valueHistogram[value]);
+  }
+  return descriptor;
+}
+
 }
@@ -49,17 +49,13 @@ TouchDetector::TouchDetector(const Vector2i& imgSize, const Settings_CPtr& itmSe
   m_touchDebuggingOutputWindowName("TouchDebuggingOutputWindow"),
 
   // Normal variables.
-  m_changeMask(new af::array(imgSize.y, imgSize.x)),
-  m_connectedComponentImage(imgSize.y, imgSize.x, u32),
   m_depthRaycast(new ORFloatImage(imgSize, true, true)),
   m_depthVisualiser(DepthVisualiserFactory::make_depth_visualiser(itmSettings->deviceType)),
-  m_diffRawRaycast(new af::array(imgSize.y, imgSize.x, f32)),
   m_imageHeight(imgSize.y),
   m_imageProcessor(ImageProcessorFactory::make_image_processor(itmSettings->deviceType)),
   m_imageWidth(imgSize.x),
   m_itmSettings(itmSettings),
   m_thresholdedRawDepth(new ORFloatImage(imgSize, true, true)),
-  m_touchMask(new af::array(imgSize.y, imgSize.x, u8)),
   m_touchSettings(touchSettings)
 {
   // Set the maximum and minimum areas (in pixels) of a connected change component for it to be considered a candidate touch interaction.
@@ -71,6 +67,21 @@ TouchDetector::TouchDetector(const Vector2i& imgSize, const Settings_CPtr& itmSe
   // Load the random forest used to score the candidate connected components.
   m_forest = m_touchSettings->load_forest();
 
+  // If we're running on the CPU, use the native CPU touch pipeline rather than the ArrayFire CPU backend, since the latter
+  // adds significant per-call overheads and requires the images to be converted between row-major and column-major layouts.
+  // Otherwise, allocate the arrays used by the ArrayFire-based analysis (these are not needed by the native CPU pipeline).
+  if(itmSettings->deviceType == ORUtils::DEVICE_CPU)
+  {
+    m_cpuPipeline.reset(new TouchPipeline_CPU(imgSize));
+  }
+  else
+  {
+    m_changeMask.reset(new af::array(imgSize.y, imgSize.x));
+    m_connectedComponentImage = af::array(imgSize.y, imgSize.x, u32);
+    m_diffRawRaycast.reset(new af::array(imgSize.y, imgSize.x, f32));
+    m_touchMask.reset(new af::array(imgSize.y, imgSize.x, u8));
+  }
+
 #if defined(DEBUG_TOUCH_OUTPUT_FOREST_STATISTICS)
   // Output the statistics of the forest for debugging purposes.
   m_forest->output_statistics(std::cout);
@@ -89,6 +100,9 @@ try
   // Prepare a thresholded version of the raw depth image and a depth raycast ready for change detection.
   prepare_inputs(camera, rawDepth, renderState);
 
+  // If we're running on the CPU, analyse the inputs using the native CPU touch pipeline.
+  if(m_cpuPipeline) return determine_touch_points_cpu();
+
   // Detect changes in the scene with respect to the reconstructed model.
   detect_changes();
 
@@ -154,7 +168,7 @@ catch(af::exception&)
 
 ORUChar4Image_CPtr TouchDetector::generate_touch_image(const View_CPtr& view) const
 {
-  static Vector2i imgSize = ImageProcessor::image_size(m_touchMask);
+  static Vector2i imgSize(m_imageWidth, m_imageHeight);
   static ORUCharImage_Ptr touchMask(new ORUCharImage(imgSize, true, true));
   ORUChar4Image_Ptr touchImage(new ORUChar4Image(imgSize, true, false));
 
@@ -162,13 +176,23 @@ ORUChar4Image_CPtr TouchDetector::generate_touch_image(const View_CPtr& view) co
   const ORUChar4Image *rgb = view->rgb;
   const ORFloatImage *depth = view->depth;
 
-  // Copy the touch mask across to an InfiniTAM image.
-  m_imageProcessor->copy_af_to_itm(m_touchMask, touchMask);
-
-  // Copy the RGB and depth images and the touch mask across to the CPU.
+  // Copy the RGB and depth images across to the CPU.
   rgb->UpdateHostFromDevice();
   depth->UpdateHostFromDevice();
-  touchMask->UpdateHostFromDevice();
+
+  // Get the touch mask on the CPU. If we're using the native CPU touch pipeline, it's already there; if not, we copy it across
+  // to an InfiniTAM image and then to the CPU.
+  const unsigned char *touchMaskData = NULL;
+  if(m_cpuPipeline)
+  {
+    touchMaskData = m_cpuPipeline->get_touch_mask()->GetData(MEMORYDEVICE_CPU);
+  }
+  else
+  {
+    m_imageProcessor->copy_af_to_itm(m_touchMask, touchMask);
+    touchMask->UpdateHostFromDevice();
+    touchMaskData = touchMask->GetData(MEMORYDEVICE_CPU);
+  }
 
   // Calculate a matrix that maps points in 3D depth image coordinates to 3D RGB image coordinates.
   Matrix4f depthToRGB3D = RGBDUtil::calculate_depth_to_rgb_matrix_3D(view->calib);
@@ -177,7 +201,6 @@ ORUChar4Image_CPtr TouchDetector::generate_touch_image(const View_CPtr& view) co
   const float *depthData = depth->GetData(MEMORYDEVICE_CPU);
   const Vector4u *rgbData = rgb->GetData(MEMORYDEVICE_CPU);
   Vector4u *touchImageData = touchImage->GetData(MEMORYDEVICE_CPU);
-  const unsigned char *touchMaskData = touchMask->GetData(MEMORYDEVICE_CPU);
 
   // Copy the RGB pixels to the touch image, using the touch mask to fill in the alpha values.
   const int width = imgSize.x;
@@ -225,12 +248,16 @@ ORFloatImage_CPtr TouchDetector::get_depth_raycast() const
 
 ORFloatImage_CPtr TouchDetector::get_diff_raw_raycast() const
 {
+  if(m_cpuPipeline) return m_cpuPipeline->get_diff_raw_raycast();
+
   static ORFloatImage_Ptr diffRawRaycast;
   return m_imageProcessor->convert_af_to_itm(m_diffRawRaycast, diffRawRaycast);
 }
 
 ORUCharImage_CPtr TouchDetector::get_touch_mask() const
 {
+  if(m_cpuPipeline) return m_cpuPipeline->get_touch_mask();
+
   static ORUCharImage_Ptr touchMask;
   return m_imageProcessor->convert_af_to_itm(m_touchMask, touchMask);
 }
@@ -289,6 +316,43 @@ void TouchDetector::detect_changes()
 #endif
 }
 
+std::vector<Eigen::Vector2i> TouchDetector::determine_touch_points_cpu()
+{
+  // Detect changes in the scene with respect to the reconstructed model.
+  m_cpuPipeline->detect_changes(m_thresholdedRawDepth.get(), m_depthRaycast.get(), m_touchSettings->lowerDepthThresholdMm, m_touchSettings->morphKernelSize);
+
+  // Label the connected components of the change mask.
+  m_cpuPipeline->find_connected_components();
+
+  // Select candidate connected components that fall within a certain size range. If no components meet the size constraints, clear the touch mask and early out.
+  std::vector<int> candidateComponents = m_cpuPipeline->select_candidate_components(m_minCandidateArea, m_maxCandidateArea);
+  if(candidateComponents.empty())
+  {
+    m_cpuPipeline->clear_touch_mask();
+    return std::vector<Eigen::Vector2i>();
+  }
+
+#ifdef WITH_OPENCV
+  // If desired, save the candidate connected components for use with the touchtrain application.
+  if(m_touchSettings->should_save_candidate_components())
+  {
+    save_candidate_components_cpu(candidateComponents);
+  }
+#endif
+
+  // Pick the candidate component most likely to correspond to a touch interaction.
+  int bestConnectedComponent = pick_best_candidate_component_based_on_forest_cpu(candidateComponents);
+  if(bestConnectedComponent == -1)
+  {
+    m_cpuPipeline->clear_touch_mask();
+    return std::vector<Eigen::Vector2i>();
+  }
+
+  // Extract a set of touch points from the chosen connected component that denote the parts of the scene touched by the user.
+  // Note that the set of touch points may end up being empty if the user is not touching the scene.
+  return m_cpuPipeline->extract_touch_points(bestConnectedComponent, m_touchSettings->lowerDepthThresholdMm, m_touchSettings->minTouchAreaFraction);
+}
+
 std::vector<Eigen::Vector2i> TouchDetector::extract_touch_points(int component, const af::array& diffRawRaycastInMm)
 {
   // Determine the component's binary mask and difference image.
@@ -409,6 +473,26 @@ int TouchDetector::pick_best_candidate_component_based_on_forest(const af::array
   return bestCandidateID;
 }
 
+int TouchDetector::pick_best_candidate_component_based_on_forest_cpu(const std::vector<int>& candidateComponents) const
+{
+  const int candidateCount = static_cast<int>(candidateComponents.size());
+  const Label isTouchLabel = 1;
+
+  std::vector<float> touchProb(candidateCount);
+  for(int i = 0; i < candidateCount; ++i)
+  {
+    Descriptor_CPtr descriptor = TouchDescriptorCalculator::calculate_histogram_descriptor(m_cpuPipeline->calculate_value_histogram(candidateComponents[i]));
+    touchProb[i] = MapUtil::lookup(m_forest->calculate_pmf(descriptor).get_masses(), isTouchLabel);
+
+#if defined(DEBUG_TOUCH_OUTPUT_PMF)
+    std::cout << "The PMF is: " << m_forest->calculate_pmf(descriptor) << '\n';
+#endif
+  }
+
+  const size_t maxIndex = ArgUtil::argmax(touchProb);
+  return touchProb[maxIndex] > 0.5f ? candidateComponents[maxIndex] : -1;
+}
+
 void TouchDetector::prepare_inputs(const rigging::MoveableCamera_CPtr& camera, const ORFloatImage_CPtr& rawDepth, const VoxelRenderState_CPtr& renderState)
 {
   // Make a copy of the raw depth image in which any parts of the scene that are at a distance of > 2m are set to -1.
@@ -477,6 +561,31 @@ void TouchDetector::save_candidate_components(const af::array& candidateComponen
     }
   }
 }
+
+void TouchDetector::save_candidate_components_cpu(const std::vector<int>& candidateComponents) const
+{
+  static size_t imageCounter = 0;
+
+  const std::vector<int>& componentImage = m_cpuPipeline->get_component_image();
+  const std::vector<unsigned char>& diffRawRaycastInMm = m_cpuPipeline->get_diff_raw_raycast_in_mm();
+  const int pixelCount = m_imageWidth * m_imageHeight;
+  cv::Mat1b candidateDiffCV(m_imageHeight, m_imageWidth);
+
+  for(size_t i = 0, candidateCount = candidateComponents.size(); i < candidateCount; ++i)
+  {
+    unsigned char *candidateDiff = candidateDiffCV.ptr<unsigned char>();
+    for(int pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex)
+    {
+      candidateDiff[pixelIndex] = componentImage[pixelIndex] == candidateComponents[i] ? diffRawRaycastInMm[pixelIndex] : 0;
+    }
+
+    if(imageCounter < 1e5)
+    {
+      std::string saveString = m_touchSettings->get_save_candidate_components_path() + "/img" + (boost::format("%05d") % imageCounter++).str() + ".ppm";
+      cv::imwrite(saveString, candidateDiffCV);
+    }
+  }
+}
 #endif
 
 af::array TouchDetector::select_candidate_components()
@@ -0,0 +1,380 @@
+/**
+ * spaint: TouchPipeline_CPU.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "touch/cpu/TouchPipeline_CPU.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+TouchPipeline_CPU::TouchPipeline_CPU(const Vector2i& imgSize)
+: m_changeMask(imgSize.x * imgSize.y),
+  m_componentImage(imgSize.x * imgSize.y),
+  m_diffRawRaycast(new ORFloatImage(imgSize, true, false)),
+  m_diffRawRaycastInMm(imgSize.x * imgSize.y),
+  m_imageHeight(imgSize.y),
+  m_imageWidth(imgSize.x),
+  m_scratch(imgSize.x * imgSize.y),
+  m_touchPixels(imgSize.x * imgSize.y),
+  m_touchMask(new ORUCharImage(imgSize, true, false))
+{
+  m_touchMask->Clear();
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+std::vector<int> TouchPipeline_CPU::calculate_value_histogram(int component) const
+{
+  std::vector<int> histogram(256, 0);
+  const ComponentStats& stats = m_componentStats[component];
+
+  // Count the differences within the component, visiting only the pixels in its bounding box.
+  for(int y = stats.minY; y <= stats.maxY; ++y)
+  {
+    for(int x = stats.minX; x <= stats.maxX; ++x)
+    {
+      const int pixelIndex = y * m_imageWidth + x;
+      if(m_componentImage[pixelIndex] == component) ++histogram[m_diffRawRaycastInMm[pixelIndex]];
+    }
+  }
+
+  // Count the pixels outside the component as having a difference of 0.
+  histogram[0] += m_imageWidth * m_imageHeight - stats.area;
+
+  return histogram;
+}
+
+void TouchPipeline_CPU::clear_touch_mask()
+{
+  m_touchMask->Clear();
+}
+
+void TouchPipeline_CPU::detect_changes(const ORFloatImage *thresholdedRawDepth, const ORFloatImage *depthRaycast, int lowerDepthThresholdMm, int morphKernelSize)
+{
+  const float *rawDepthData = thresholdedRawDepth->GetData(MEMORYDEVICE_CPU);
+  const float *depthRaycastData = depthRaycast->GetData(MEMORYDEVICE_CPU);
+  float *diffData = m_diffRawRaycast->GetData(MEMORYDEVICE_CPU);
+  unsigned char *diffInMmData = &m_diffRawRaycastInMm[0];
+  unsigned char *changeMask = &m_changeMask[0];
+
+  const float lowerDepthThreshold = lowerDepthThresholdMm / 1000.0f;
+  const int pixelCount = m_imageWidth * m_imageHeight;
+
+  // Calculate the difference between the raw depth image and the depth raycast, convert it to mm, and threshold it to find
+  // the locations in which the scene has changed since it was originally reconstructed (e.g. the locations of moving objects
+  // such as hands). If either depth is invalid (less than zero), the difference is set to -1, and so does not count as a change.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex)
+  {
+    const float rawDepth = rawDepthData[pixelIndex], raycastDepth = depthRaycastData[pixelIndex];
+    const float diff = rawDepth >= 0 && raycastDepth >= 0 ? fabs(rawDepth - raycastDepth) : -1.0f;
+    const float diffInMm = diff * 1000.0f;
+
+    diffData[pixelIndex] = diff;
+    diffInMmData[pixelIndex] = static_cast<unsigned char>(diffInMm < 0.0f ? 0.0f : diffInMm > 255.0f ? 255.0f : diffInMm);
+    changeMask[pixelIndex] = diff > lowerDepthThreshold ? 1 : 0;
+  }
+
+  // Apply a morphological opening operation to the change mask to reduce noise.
+  if(morphKernelSize < 3) morphKernelSize = 3;
+  if(morphKernelSize % 2 == 0) ++morphKernelSize;
+  open(m_changeMask, morphKernelSize);
+}
+
+std::vector<Eigen::Vector2i> TouchPipeline_CPU::extract_touch_points(int component, int lowerDepthThresholdMm, float minTouchAreaFraction)
+{
+  const int *componentImage = &m_componentImage[0];
+  const unsigned char *diffInMmData = &m_diffRawRaycastInMm[0];
+  unsigned char *touchMask = m_touchMask->GetData(MEMORYDEVICE_CPU);
+  unsigned char *touchPixels = &m_touchPixels[0];
+
+  const int pixelCount = m_imageWidth * m_imageHeight;
+  const int upperDepthThresholdMm = lowerDepthThresholdMm + 15;
+
+  // Determine the component's binary mask. At the same time, quantize the differences within the component to 32 levels
+  // (from a starting point of 256 levels) and threshold them, keeping only the parts of the component that are close to
+  // the surface.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex)
+  {
+    const bool inComponent = componentImage[pixelIndex] == component;
+    const int quantizedDiff = inComponent ? (diffInMmData[pixelIndex] / 8) * 8 : 0;
+    touchMask[pixelIndex] = inComponent ? 1 : 0;
+    touchPixels[pixelIndex] = quantizedDiff > lowerDepthThresholdMm && quantizedDiff < upperDepthThresholdMm ? 1 : 0;
+  }
+
+  // Apply a morphological opening operation to the touch pixels to reduce noise.
+  open(m_touchPixels, 5);
+
+  // Spatially quantize the touch pixels by sampling them (using nearest-neighbour interpolation) on a grid that is 30% of the
+  // size of the image. This has the effect of reducing the eventual number of touch points. The points are generated in
+  // column-major order to match the order produced by the ArrayFire pipeline.
+  const float scaleFactor = 0.3f;
+  const int resizedWidth = static_cast<int>(m_imageWidth * scaleFactor);
+  const int resizedHeight = static_cast<int>(m_imageHeight * scaleFactor);
+  const float xScale = static_cast<float>(resizedWidth) / m_imageWidth;
+  const float yScale = static_cast<float>(resizedHeight) / m_imageHeight;
+
+  std::vector<Eigen::Vector2i> touchPoints;
+  for(int x = 0; x < resizedWidth; ++x)
+  {
+    const int sourceX = std::min(static_cast<int>(floor(x / xScale + 0.5f)), m_imageWidth - 1);
+    for(int y = 0; y < resizedHeight; ++y)
+    {
+      const int sourceY = std::min(static_cast<int>(floor(y / yScale + 0.5f)), m_imageHeight - 1);
+      if(touchPixels[sourceY * m_imageWidth + sourceX])
+      {
+        touchPoints.push_back((Eigen::Vector2f(static_cast<float>(x), static_cast<float>(y)) / scaleFactor).cast<int>());
+      }
+    }
+  }
+
+  // If there are too few touch points, assume the user is not touching the scene in a meaningful way.
+  const float touchAreaLowerThreshold = minTouchAreaFraction * m_imageWidth * m_imageHeight;
+  if(touchPoints.size() <= touchAreaLowerThreshold) touchPoints.clear();
+
+  return touchPoints;
+}
+
+void TouchPipeline_CPU::find_connected_components()
+{
+  const unsigned char *changeMask = &m_changeMask[0];
+  int *componentImage = &m_componentImage[0];
+
+  // Make a first pass over the change mask, assigning provisional labels to the changed pixels and recording the
+  // equivalences between them in the union-find forest. Each tree is rooted at its smallest provisional label.
+  // At the same time, record the column-major index of the first pixel (in column-major order) with each label.
+  m_parents.clear();
+  m_parents.push_back(0);
+  m_firstColumnMajorIndices.clear();
+  m_firstColumnMajorIndices.push_back(0);
+
+  for(int y = 0; y < m_imageHeight; ++y)
+  {
+    for(int x = 0; x < m_imageWidth; ++x)
+    {
+      const int pixelIndex = y * m_imageWidth + x;
+      if(!changeMask[pixelIndex])
+      {
+        componentImage[pixelIndex] = 0;
+        continue;
+      }
+
+      const int left = x > 0 ? componentImage[pixelIndex - 1] : 0;
+      const int up = y > 0 ? componentImage[pixelIndex - m_imageWidth] : 0;
+
+      int label;
+      if(left != 0 && up != 0)
+      {
+        label = left;
+        if(left != up)
+        {
+          const int leftRoot = find_root(left), upRoot = find_root(up);
+          if(leftRoot < upRoot) m_parents[upRoot] = leftRoot;
+          else if(upRoot < leftRoot) m_parents[leftRoot] = upRoot;
+        }
+      }
+      else if(left != 0 || up != 0)
+      {
+        label = left != 0 ? left : up;
+      }
+      else
+      {
+        label = static_cast<int>(m_parents.size());
+        m_parents.push_back(label);
+        m_firstColumnMajorIndices.push_back(INT_MAX);
+      }
+
+      componentImage[pixelIndex] = label;
+      m_firstColumnMajorIndices[label] = std::min(m_firstColumnMajorIndices[label], x * m_imageHeight + y);
+    }
+  }
+
+  // Map each provisional label to a component. Since every label's parent is smaller than the label itself, we can do this
+  // in a single pass in increasing order. At the same time, find the column-major index of the first pixel in each component.
+  const int provisionalLabelCount = static_cast<int>(m_parents.size());
+  std::vector<int> finalLabels(provisionalLabelCount, 0);
+  std::vector<std::pair<int,int> > componentOrder;
+  for(int label = 1; label < provisionalLabelCount; ++label)
+  {
+    const int parent = m_parents[label];
+    if(parent == label)
+    {
+      finalLabels[label] = static_cast<int>(componentOrder.size());
+      componentOrder.push_back(std::make_pair(m_firstColumnMajorIndices[label], 0));
+    }
+    else
+    {
+      finalLabels[label] = finalLabels[parent];
+      int& firstIndex = componentOrder[finalLabels[label]].first;
+      firstIndex = std::min(firstIndex, m_firstColumnMajorIndices[label]);
+    }
+  }
+
+  // Number the components (from 1) in column-major order of their first appearance, as ArrayFire does. This ensures that the
+  // candidate components are considered in the same order as in the ArrayFire pipeline, and so that ties are broken the same way.
+  const int componentCount = static_cast<int>(componentOrder.size());
+  for(int i = 0; i < componentCount; ++i) componentOrder[i].second = i;
+  std::sort(componentOrder.begin(), componentOrder.end());
+
+  std::vector<int> componentNumbers(componentCount);
+  for(int i = 0; i < componentCount; ++i) componentNumbers[componentOrder[i].second] = i + 1;
+  for(int label = 1; label < provisionalLabelCount; ++label) finalLabels[label] = componentNumbers[finalLabels[label]];
+
+  // Make a second pass over the image to assign the final labels and calculate the statistics for the components.
+  ComponentStats emptyStats;
+  emptyStats.area = 0;
+  emptyStats.maxX = emptyStats.maxY = -1;
+  emptyStats.minX = m_imageWidth;
+  emptyStats.minY = m_imageHeight;
+  m_componentStats.assign(componentCount + 1, emptyStats);
+
+  for(int y = 0; y < m_imageHeight; ++y)
+  {
+    for(int x = 0; x < m_imageWidth; ++x)
+    {
+      int& label = componentImage[y * m_imageWidth + x];
+      if(label == 0) continue;
+
+      label = finalLabels[label];
+
+      ComponentStats& stats = m_componentStats[label];
+      ++stats.area;
+      if(x < stats.minX) stats.minX = x;
+      if(x > stats.maxX) stats.maxX = x;
+      if(y < stats.minY) stats.minY = y;
+      if(y > stats.maxY) stats.maxY = y;
+    }
+  }
+}
+
+const std::vector<unsigned char>& TouchPipeline_CPU::get_change_mask() const
+{
+  return m_changeMask;
+}
+
+const std::vector<int>& TouchPipeline_CPU::get_component_image() const
+{
+  return m_componentImage;
+}
+
+ORFloatImage_CPtr TouchPipeline_CPU::get_diff_raw_raycast() const
+{
+  return m_diffRawRaycast;
+}
+
+const std::vector<unsigned char>& TouchPipeline_CPU::get_diff_raw_raycast_in_mm() const
+{
+  return m_diffRawRaycastInMm;
+}
+
+ORUCharImage_CPtr TouchPipeline_CPU::get_touch_mask() const
+{
+  return m_touchMask;
+}
+
+std::vector<int> TouchPipeline_CPU::select_candidate_components(int minArea, int maxArea) const
+{
+  std::vector<int> candidates;
+  for(int component = 1, componentCount = static_cast<int>(m_componentStats.size()); component < componentCount; ++component)
+  {
+    const int area = m_componentStats[component].area;
+    if(area >= minArea && area <= maxArea) candidates.push_back(component);
+  }
+  return candidates;
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+int TouchPipeline_CPU::find_root(int label)
+{
+  // Find the root, halving the length of the path to it as we go.
+  while(m_parents[label] != label)
+  {
+    m_parents[label] = m_parents[m_parents[label]];
+    label = m_parents[label];
+  }
+  return label;
+}
+
+void TouchPipeline_CPU::open(std::vector<unsigned char>& mask, int kernelSize)
+{
+  // Since the kernel is square, each erosion or dilation can be performed as a pass along the rows followed by a pass along the columns.
+  const int radius = kernelSize / 2;
+  filter_rows(&mask[0], &m_scratch[0], m_imageWidth, m_imageHeight, radius, false);
+  filter_columns(&m_scratch[0], &mask[0], m_imageWidth, m_imageHeight, radius, false);
+  filter_rows(&mask[0], &m_scratch[0], m_imageWidth, m_imageHeight, radius, true);
+  filter_columns(&m_scratch[0], &mask[0], m_imageWidth, m_imageHeight, radius, true);
+}
+
+//#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+
+void TouchPipeline_CPU::filter_columns(const unsigned char *input, unsigned char *output, int width, int height, int radius, bool dilate)
+{
+  // Maintain a running count of the set pixels in the window centred on the current row in each column.
+  std::vector<int> counts(width, 0);
+  for(int y = 0; y <= radius && y < height; ++y)
+  {
+    const unsigned char *row = input + y * width;
+    for(int x = 0; x < width; ++x) counts[x] += row[x];
+  }
+
+  for(int y = 0; y < height; ++y)
+  {
+    const int windowSize = std::min(y + radius, height - 1) - std::max(y - radius, 0) + 1;
+    unsigned char *outputRow = output + y * width;
+    if(dilate) for(int x = 0; x < width; ++x) outputRow[x] = counts[x] > 0 ? 1 : 0;
+    else for(int x = 0; x < width; ++x) outputRow[x] = counts[x] == windowSize ? 1 : 0;
+
+    // Slide the window down by one row.
+    if(y + radius + 1 < height)
+    {
+      const unsigned char *row = input + (y + radius + 1) * width;
+      for(int x = 0; x < width; ++x) counts[x] += row[x];
+    }
+
+    if(y - radius >= 0)
+    {
+      const unsigned char *row = input + (y - radius) * width;
+      for(int x = 0; x < width; ++x) counts[x] -= row[x];
+    }
+  }
+}
+
+void TouchPipeline_CPU::filter_rows(const unsigned char *input, unsigned char *output, int width, int height, int radius, bool dilate)
+{
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = 0; y < height; ++y)
+  {
+    const unsigned char *inputRow = input + y * width;
+    unsigned char *outputRow = output + y * width;
+
+    // Maintain a running count of the set pixels in the window centred on the current pixel.
+    int count = 0;
+    for(int x = 0; x <= radius && x < width; ++x) count += inputRow[x];
+
+    for(int x = 0; x < width; ++x)
+    {
+      const int windowSize = std::min(x + radius, width - 1) - std::max(x - radius, 0) + 1;
+      outputRow[x] = (dilate ? count > 0 : count == windowSize) ? 1 : 0;
+
+      // Slide the window right by one pixel.
+      if(x + radius + 1 < width) count += inputRow[x + radius + 1];
+      if(x - radius >= 0) count -= inputRow[x - radius];
+    }
+  }
+}
+
+}
@@ -0,0 +1,118 @@
+/**
+ * spaint: RaycastChangeTracker.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2016. All rights reserved.
+ */
+
+#include "util/RaycastChangeTracker.h"
+
+#include "markers/shared/VoxelMarker_Shared.h"
+
+namespace spaint {
+
+//#################### CONSTRUCTORS ####################
+
+RaycastChangeTracker::RaycastChangeTracker(const std::vector<Vector2i>& neighbourOffsets, float positionTolerance)
+: m_neighbourOffsets(neighbourOffsets), m_positionToleranceSquared(positionTolerance * positionTolerance)
+{}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void RaycastChangeTracker::detect_changes(const ORFloat4Image *raycastResult, const SpaintVoxelScene *scene)
+{
+  const ITMVoxelIndex::IndexData *indexData = scene->index.getIndexData();
+  const Vector4f *raycastResultData = raycastResult->GetData(MEMORYDEVICE_CPU);
+  const int raycastResultSize = static_cast<int>(raycastResult->dataSize);
+  const SpaintVoxel *voxelData = scene->localVBA.GetVoxelBlocks();
+
+  // If this is the first call, or the raycast result has changed size, deem every pixel to have changed.
+  const bool firstPass = static_cast<int>(m_previousPositions.size()) != raycastResultSize;
+  if(firstPass)
+  {
+    m_changeMask.resize(raycastResultSize);
+    m_previousLabels.resize(raycastResultSize);
+    m_previousPositions.resize(raycastResultSize);
+  }
+
+  unsigned char *changeMask = &m_changeMask[0];
+  SpaintVoxel::PackedLabel *previousLabels = &m_previousLabels[0];
+  Vector4f *previousPositions = &m_previousPositions[0];
+
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int pixelIndex = 0; pixelIndex < raycastResultSize; ++pixelIndex)
+  {
+    unsigned char flags = 0;
+
+    // Check whether the raycast point has moved (or changed validity) since it was last deemed to have changed.
+    // Note that the previous point is only updated when a change is detected, so that slow drift eventually triggers an update.
+    const Vector4f& pos = raycastResultData[pixelIndex];
+    const Vector4f& previousPos = previousPositions[pixelIndex];
+    const float dx = pos.x - previousPos.x, dy = pos.y - previousPos.y, dz = pos.z - previousPos.z;
+    if(firstPass || (pos.w > 0) != (previousPos.w > 0) || dx * dx + dy * dy + dz * dz > m_positionToleranceSquared)
+    {
+      flags |= CF_POSITION;
+      previousPositions[pixelIndex] = pos;
+    }
+
+    // Check whether the label of the voxel under the pixel has changed since the last call.
+    bool foundPoint;
+    const SpaintVoxel voxel = readVoxel(voxelData, indexData, pos.toVector3().toIntRound(), foundPoint);
+    const SpaintVoxel::PackedLabel label = foundPoint ? voxel.packedLabel : SpaintVoxel::PackedLabel();
+    if(firstPass || !(label == previousLabels[pixelIndex]))
+    {
+      flags |= CF_LABEL;
+      previousLabels[pixelIndex] = label;
+    }
+
+    changeMask[pixelIndex] = flags;
+  }
+}
+
+const std::vector<int>& RaycastChangeTracker::find_dirty_pixels(int width, int height, bool forceAll)
+{
+  const int pixelCount = width * height;
+  m_dirtyMask.resize(pixelCount);
+
+  const unsigned char *changeMask = &m_changeMask[0];
+  unsigned char *dirtyMask = &m_dirtyMask[0];
+  const Vector2i *neighbourOffsets = m_neighbourOffsets.empty() ? NULL : &m_neighbourOffsets[0];
+  const int neighbourCount = static_cast<int>(m_neighbourOffsets.size());
+
+  // Mark as dirty every pixel that has changed or that reads a neighbour that has changed. Since the neighbourhoods
+  // used are symmetric, this is the same as dilating the change mask by the neighbourhood.
+#ifdef WITH_OPENMP
+  #pragma omp parallel for
+#endif
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      const int pixelIndex = y * width + x;
+      bool dirty = forceAll || changeMask[pixelIndex] != 0;
+      for(int i = 0; i < neighbourCount && !dirty; ++i)
+      {
+        const int nx = x + neighbourOffsets[i].x, ny = y + neighbourOffsets[i].y;
+        dirty = nx >= 0 && nx < width && ny >= 0 && ny < height && changeMask[ny * width + nx] != 0;
+      }
+
+      dirtyMask[pixelIndex] = dirty ? 1 : 0;
+    }
+  }
+
+  // Compact the dirty pixels into a list.
+  m_dirtyPixels.clear();
+  for(int pixelIndex = 0; pixelIndex < pixelCount; ++pixelIndex)
+  {
+    if(dirtyMask[pixelIndex]) m_dirtyPixels.push_back(pixelIndex);
+  }
+
+  return m_dirtyPixels;
+}
+
+bool RaycastChangeTracker::position_changed(int pixelIndex) const
+{
+  return (m_changeMask[pixelIndex] & CF_POSITION) != 0;
+}
+
+}
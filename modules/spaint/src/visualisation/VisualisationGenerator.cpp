@@ -83,7 +83,7 @@ void VisualisationGenerator::generate_surfel_visualisation(const ORUChar4Image_P
     case VT_SCENE_DEPTH:
     {
       // FIXME: This is a workaround that is needed because DepthToUchar4 is currently CPU-only.
-      static ORFloatImage temp(output->noDims, true, true);
+      ORFloatImage temp(output->noDims, true, true);
       m_surfelVisualisationEngine->RenderDepthImage(scene.get(), &pose, renderState.get(), &temp);
       if(m_settings->deviceType == DEVICE_CUDA) temp.UpdateHostFromDevice();
       IITMVisualisationEngine::DepthToUchar4(output.get(), &temp);
@@ -142,7 +142,8 @@ void VisualisationGenerator::generate_voxel_visualisation(const ORUChar4Image_Pt
     case VT_SCENE_DEPTH:
     {
       // FIXME: This is a workaround that is needed because DepthToUchar4 is currently CPU-only.
-      static ORFloatImage_Ptr temp(new ORFloatImage(output->noDims, true, true));
+      // Note: The temporary image is deliberately not static, so that images can be generated concurrently by multiple threads.
+      ORFloatImage_Ptr temp(new ORFloatImage(output->noDims, true, true));
       generate_depth_from_voxels(temp, scene, pose, intrinsics, renderState, DepthVisualiser::DT_ORTHOGRAPHIC);
       IITMVisualisationEngine::DepthToUchar4(output.get(), temp.get());
       if(m_settings->deviceType == DEVICE_CUDA) output->UpdateDeviceFromHost();
@@ -199,8 +200,7 @@ void VisualisationGenerator::get_depth_input(const ORUChar4Image_Ptr& output, co
   }
   else
   {
-    static ORUChar4Image_Ptr temp(new ORUChar4Image(view->depth->noDims, true, true));
-    temp->ChangeDims(view->depth->noDims);
+    ORUChar4Image_Ptr temp(new ORUChar4Image(view->depth->noDims, true, true));
     m_voxelVisualisationEngine->DepthToUchar4(temp.get(), view->depth);
     resize_into(output, temp.get());
   }
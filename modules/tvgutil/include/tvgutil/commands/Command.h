@@ -58,6 +58,28 @@ public:
    * \return  A short description of what the command does.
    */
   const std::string& get_description() const;
+
+  /**
+   * \brief Gets the number of bytes of memory used by the state that the command keeps so that it can be executed/undone/redone.
+   *
+   * \note  This is used to enforce a memory budget on the command history. By default, commands are assumed to keep no significant state.
+   *
+   * \return  The number of bytes of memory used by the command's state.
+   */
+  virtual size_t get_memory_usage() const;
+
+  /**
+   * \brief Attempts to merge this command with a command that has just been executed after it.
+   *
+   * If successful, this yields a single command whose effect is that of this command followed by the next one.
+   * This allows (e.g.) a long stream of similar commands to be stored compactly as a single history entry.
+   * By default, commands cannot be merged.
+   *
+   * \param next        The command that has just been executed after this one.
+   * \param description The description to give the merged command.
+   * \return            The merged command, if the commands can be merged, or NULL otherwise.
+   */
+  virtual boost::shared_ptr<const Command> merge_with(const boost::shared_ptr<const Command>& next, const std::string& description) const;
 };
 
 //#################### TYPEDEFS ####################
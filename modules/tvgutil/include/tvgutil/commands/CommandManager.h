@@ -8,6 +8,7 @@
 
 #include <climits>
 #include <deque>
+#include <limits>
 #include <map>
 
 #include "Command.h"
@@ -24,6 +25,9 @@ private:
   /** A stack containing commands that have been executed and not undone. */
   std::deque<Command_CPtr> m_executed;
 
+  /** The maximum number of bytes of memory that the commands in the history may use (the most recent command is always kept, regardless). */
+  size_t m_maxHistoryMemory;
+
   /** The maximum size of the command history (the maximum combined size of the two command stacks). */
   size_t m_maxHistorySize;
 
@@ -35,9 +39,10 @@ public:
   /**
    * \brief Constructs a command manager.
    *
-   * \param maxHistorySize  The maximum size of the command history (the maximum combined size of the two command stacks).
+   * \param maxHistorySize    The maximum size of the command history (the maximum combined size of the two command stacks).
+   * \param maxHistoryMemory  The maximum number of bytes of memory that the commands in the history may use (the most recent command is always kept, regardless).
    */
-  explicit CommandManager(size_t maxHistorySize = INT_MAX);
+  explicit CommandManager(size_t maxHistorySize = INT_MAX, size_t maxHistoryMemory = std::numeric_limits<size_t>::max());
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
@@ -68,7 +73,9 @@ public:
    * If the executed stack is non-empty and the description of the most recent command matches one
    * of the specified precursors, then we compress the previous command and this one into a single
    * command. Otherwise, we just execute the specified command as is. The idea is to avoid making
-   * undo/redo more user-intensive than it needs to be.
+   * undo/redo more user-intensive than it needs to be. Where possible, the two commands are merged
+   * (see Command::merge_with), so that long streams of similar commands are stored compactly;
+   * otherwise, they are simply sequenced.
    *
    * \param c           The command to execute.
    * \param precursors  A map containing possible precursors of the current command for compression purposes.
@@ -85,6 +92,13 @@ public:
    */
   size_t executed_count() const;
 
+  /**
+   * \brief Gets the number of bytes of memory currently used by the commands in the history.
+   *
+   * \return  The number of bytes of memory currently used by the commands in the history.
+   */
+  size_t memory_usage() const;
+
   /**
    * \brief Redoes the last command undone, if any.
    */
@@ -109,6 +123,11 @@ public:
 
   //#################### PRIVATE MEMBER FUNCTIONS ####################
 private:
+  /**
+   * \brief Discards the oldest executed commands as necessary to keep the command history within its memory budget.
+   */
+  void enforce_memory_budget();
+
   /**
    * \brief Makes space for a new command if the command history is full.
    */
@@ -50,6 +50,21 @@ public:
   /** Override */
   virtual void execute() const;
 
+  /** Override */
+  virtual size_t get_memory_usage() const;
+
+  /**
+   * \brief Attempts to merge this command with a command that has just been executed after it.
+   *
+   * This succeeds if the last command in the sequence can be merged with the next command, in which case the
+   * result is a sequence in which the last command has been replaced by the merged command.
+   *
+   * \param next        The command that has just been executed after this one.
+   * \param description The description to give the merged command.
+   * \return            The merged command, if the commands can be merged, or NULL otherwise.
+   */
+  virtual Command_CPtr merge_with(const Command_CPtr& next, const std::string& description) const;
+
   /** Override */
   virtual void undo() const;
 };
@@ -0,0 +1,154 @@
+/**
+ * tvgutil: CachedSetting.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2017. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_CACHEDSETTING
+#define H_TVGUTIL_CACHEDSETTING
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "SettingsContainer.h"
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of an instantiation of this class template provides cheap, repeated access to a typed setting in a settings container.
+ *
+ * The setting's key is resolved and its value parsed only when the settings container has changed since the value was last read.
+ * In the common case, reading the setting therefore costs two atomic loads and an integer comparison, and neither locks a mutex nor
+ * copies the value, rather than costing a string concatenation, a map lookup and a lexical cast. This makes it suitable for settings
+ * that are looked up repeatedly on per-frame code paths. Cached settings can safely be read from multiple threads (e.g. a relocalisation
+ * thread as well as the main thread).
+ *
+ * Each distinct value that the setting takes is kept alive for the lifetime of the cached setting, so that references to values that
+ * have since been superseded remain valid. Settings rarely change at runtime, so the memory this uses is negligible in practice.
+ */
+template <typename T>
+class CachedSetting
+{
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The most recently parsed value of the setting. */
+  mutable boost::atomic<const T*> m_currentValue;
+
+  /** The default value to use if the setting has not been specified. */
+  T m_defaultValue;
+
+  /** The key of the setting. */
+  std::string m_key;
+
+  /** The synchronisation mutex (this serialises refreshes of the cached value). */
+  mutable boost::mutex m_mutex;
+
+  /** The revision of the settings container at which the current value was last confirmed to be up to date. */
+  mutable boost::atomic<size_t> m_revision;
+
+  /** The settings container from which to read the setting. */
+  SettingsContainer_CPtr m_settings;
+
+  /** Every value that the setting has taken since the cached setting was constructed (these are kept alive so that references to them remain valid). */
+  mutable std::vector<boost::shared_ptr<const T> > m_values;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a cached setting.
+   *
+   * \param settings      The settings container from which to read the setting.
+   * \param key           The key of the setting.
+   * \param defaultValue  The default value to use if the setting has not been specified.
+   *
+   * \throws boost::bad_lexical_cast  If the setting exists but its first value cannot be converted to the specified type.
+   */
+  CachedSetting(const SettingsContainer_CPtr& settings, const std::string& key, const T& defaultValue)
+  : m_currentValue(NULL), m_defaultValue(defaultValue), m_key(key), m_revision(0), m_settings(settings)
+  {
+    refresh();
+  }
+
+  //#################### COPY CONSTRUCTOR & ASSIGNMENT OPERATOR ####################
+private:
+  // Deliberately private and unimplemented.
+  CachedSetting(const CachedSetting&);
+  CachedSetting& operator=(const CachedSetting&);
+
+  //#################### PUBLIC OPERATORS ####################
+public:
+  /**
+   * \brief Gets the current value of the setting.
+   *
+   * \return  The current value of the setting.
+   */
+  const T& operator*() const
+  {
+    return get();
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the current value of the setting.
+   *
+   * The returned reference remains valid for the lifetime of the cached setting, but will not reflect any subsequent changes
+   * to the setting (call get again to pick those up).
+   *
+   * \return  The current value of the setting.
+   *
+   * \throws boost::bad_lexical_cast  If the settings container has changed and the setting's new value cannot be converted to the specified type.
+   */
+  const T& get() const
+  {
+    // Fast path: if the settings container has not changed since the value was last confirmed, return it without locking.
+    // Note: The current value is published before the revision, so seeing an up-to-date revision implies seeing its value.
+    if(m_revision.load(boost::memory_order_acquire) == m_settings->get_revision())
+    {
+      return *m_currentValue.load(boost::memory_order_acquire);
+    }
+
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    if(m_revision.load(boost::memory_order_relaxed) != m_settings->get_revision()) refresh();
+    return *m_currentValue.load(boost::memory_order_relaxed);
+  }
+
+  /**
+   * \brief Gets the key of the setting.
+   *
+   * \return  The key of the setting.
+   */
+  const std::string& key() const
+  {
+    return m_key;
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Re-reads the value of the setting from the settings container (the mutex must be held by the caller, unless the setting is being constructed).
+   */
+  void refresh() const
+  {
+    // Note: We read the revision before the value, so that if the settings change in the meantime, the next call will refresh again.
+    const size_t revision = m_settings->get_revision();
+    boost::shared_ptr<const T> value(new T(m_settings->get_first_value<T>(m_key, m_defaultValue)));
+
+    // If the value has actually changed (rather than just some other setting), publish the new value.
+    const T *currentValue = m_currentValue.load(boost::memory_order_relaxed);
+    if(!currentValue || !(*value == *currentValue))
+    {
+      m_values.push_back(value);
+      m_currentValue.store(value.get(), boost::memory_order_release);
+    }
+
+    m_revision.store(revision, boost::memory_order_release);
+  }
+};
+
+}
+
+#endif
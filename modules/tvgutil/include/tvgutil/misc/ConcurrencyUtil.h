@@ -0,0 +1,39 @@
+/**
+ * tvgutil: ConcurrencyUtil.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_CONCURRENCYUTIL
+#define H_TVGUTIL_CONCURRENCYUTIL
+
+#include <boost/function.hpp>
+
+namespace tvgutil {
+
+/**
+ * \brief This class provides utility functions related to running tasks concurrently.
+ */
+class ConcurrencyUtil
+{
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Runs a set of independent tasks on a number of worker threads, and waits for them all to finish.
+   *
+   * Each worker thread repeatedly claims the lowest-indexed task that has not yet been claimed and runs it, so the load is
+   * balanced between the threads even if the tasks take very different lengths of time. The calling thread acts as one of
+   * the workers, and the others are drawn from a persistent pool of threads, so repeated calls (e.g. once per frame) do not
+   * pay to create and destroy threads. If the thread count is 1, the tasks are run in order on the calling thread. If any
+   * task throws, no further tasks are started, and the exception thrown by the first task to fail is rethrown (with its
+   * original type) once the tasks that are running have finished.
+   *
+   * \param taskCount   The number of tasks to run.
+   * \param threadCount The maximum number of worker threads to use (including the calling thread).
+   * \param task        A function that runs the task with a specified index.
+   */
+  static void run_tasks(size_t taskCount, size_t threadCount, const boost::function<void(size_t)>& task);
+};
+
+}
+
+#endif
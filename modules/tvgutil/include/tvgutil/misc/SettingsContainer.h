@@ -9,7 +9,10 @@
 #include <ostream>
 #include <vector>
 
+#include <boost/atomic.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "../containers/MapUtil.h"
 #include "ConversionUtil.h"
@@ -20,6 +23,7 @@ namespace tvgutil {
  * \brief An instance of this class can be used to store named settings for an application.
  *
  * The settings are represented as a key -> [value] map, i.e. there can be multiple values for the same setting.
+ * Settings can safely be read from multiple threads whilst another thread changes them.
  */
 class SettingsContainer
 {
@@ -30,9 +34,29 @@ public:
 
   //#################### PRIVATE VARIABLES ####################
 private:
+  /** A counter that is incremented whenever any of the settings changes (used to invalidate cached settings). This can be read without locking the mutex. */
+  boost::atomic<size_t> m_revision;
+
+  /** The synchronisation mutex (this protects the settings, and serialises changes to the revision counter). */
+  mutable boost::mutex m_mutex;
+
   /** The key -> [value] map storing the values for the settings. */
   std::map<std::string,std::vector<std::string> > m_settings;
 
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs an empty settings container.
+   */
+  SettingsContainer();
+
+  /**
+   * \brief Copy constructs a settings container.
+   *
+   * \param rhs The settings container to copy.
+   */
+  SettingsContainer(const SettingsContainer& rhs);
+
   //#################### DESTRUCTOR ####################
 public:
   /**
@@ -40,6 +64,16 @@ public:
    */
   virtual ~SettingsContainer();
 
+  //#################### COPY ASSIGNMENT OPERATOR ####################
+public:
+  /**
+   * \brief Assigns another settings container to this one.
+   *
+   * \param rhs The other settings container.
+   * \return    This settings container.
+   */
+  SettingsContainer& operator=(const SettingsContainer& rhs);
+
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
   /**
@@ -62,6 +96,7 @@ public:
   template <typename T>
   T get_first_value(const std::string& key) const
   {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
     const std::vector<std::string>& values = MapUtil::lookup(m_settings, key);
     if(values.empty() || values[0] == NOT_SET) throw std::runtime_error("Value for " + key + " not found in the container");
     return from_string<T>(values[0]);
@@ -80,7 +115,8 @@ public:
   template <typename T>
   T get_first_value(const std::string& key, typename boost::mpl::identity<const T>::type& defaultValue) const
   {
-    static std::vector<std::string> defaultEmptyVector;
+    static const std::vector<std::string> defaultEmptyVector;
+    boost::lock_guard<boost::mutex> lock(m_mutex);
     const std::vector<std::string>& values = MapUtil::lookup(m_settings, key, defaultEmptyVector);
     return values.empty() || values[0] == NOT_SET ? defaultValue : from_string<T>(values[0]);
   }
@@ -96,7 +132,8 @@ public:
   template <typename T>
   std::vector<T> get_values(const std::string& key) const
   {
-    static std::vector<std::string> defaultEmptyVector;
+    static const std::vector<std::string> defaultEmptyVector;
+    boost::lock_guard<boost::mutex> lock(m_mutex);
     const std::vector<std::string>& values = MapUtil::lookup(m_settings, key, defaultEmptyVector);
     if(values.empty() || values[0] == NOT_SET) return std::vector<T>();
 
@@ -108,6 +145,17 @@ public:
     return typedValues;
   }
 
+  /**
+   * \brief Gets the current revision of the settings container.
+   *
+   * The revision is incremented whenever any of the settings changes, which allows clients
+   * that cache parsed setting values (e.g. CachedSetting) to cheaply detect when they are stale. It can be
+   * read without locking, so checking it costs a single atomic load.
+   *
+   * \return The current revision of the settings container.
+   */
+  size_t get_revision() const;
+
   /**
    * \brief Gets whether or not the specified setting has any values.
    *
@@ -116,6 +164,14 @@ public:
    */
   bool has_values(const std::string& key) const;
 
+  /**
+   * \brief Replaces any existing values for the specified setting with a single value.
+   *
+   * \param key   The name of the setting whose value is to be set.
+   * \param value The new value for the setting.
+   */
+  void set_value(const std::string& key, const std::string& value);
+
   //#################### STREAM OPERATORS ####################
 public:
   /**
@@ -25,6 +25,9 @@ private:
   /** An I/O service used to schedule work for the threads. */
   boost::asio::io_service m_scheduler;
 
+  /** The synchronisation mutex used when adding threads to the pool. */
+  boost::mutex m_mutex;
+
   /** The threads in the pool. */
   boost::thread_group m_threads;
 
@@ -68,6 +71,13 @@ public:
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
 public:
+  /**
+   * \brief Adds threads to the pool as necessary to make sure that it contains at least the specified number of threads.
+   *
+   * \param threadCount The minimum number of threads that the pool should contain.
+   */
+  void ensure_thread_count(size_t threadCount);
+
   /**
    * \brief Posts a task to be executed by the thread pool.
    *
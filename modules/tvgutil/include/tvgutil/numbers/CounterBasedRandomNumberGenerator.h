@@ -0,0 +1,148 @@
+/**
+ * tvgutil: CounterBasedRandomNumberGenerator.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_COUNTERBASEDRANDOMNUMBERGENERATOR
+#define H_TVGUTIL_COUNTERBASEDRANDOMNUMBERGENERATOR
+
+#include <cmath>
+
+#include <boost/cstdint.hpp>
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class represents a counter-based random number generator.
+ *
+ * Unlike a conventional generator, a counter-based generator has no state that changes as numbers are generated: the random
+ * numbers are a pure function of a key (derived from the seed) and a counter that is supplied by the caller. Here, the counter
+ * is split into a stream and an index (e.g. a frame index and a pixel index). This means that the generator can be used from
+ * multiple threads without any synchronisation, and that the numbers generated for a given stream and index do not depend on
+ * the order in which they are generated (or on the number of threads used).
+ *
+ * The generator implements the Philox4x32-10 algorithm from "Parallel Random Numbers: As Easy as 1, 2, 3" (Salmon et al., 2011),
+ * which yields four 32-bit random words for each counter value.
+ */
+class CounterBasedRandomNumberGenerator
+{
+  //#################### CONSTANTS ####################
+private:
+  enum
+  {
+    /** The number of rounds to perform. */
+    ROUND_COUNT = 10
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The key used by the generator (derived from the seed). */
+  boost::uint32_t m_key[2];
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a counter-based random number generator.
+   *
+   * \param seed  The seed from which to derive the key used by the generator.
+   */
+  explicit CounterBasedRandomNumberGenerator(boost::uint64_t seed)
+  {
+    m_key[0] = static_cast<boost::uint32_t>(seed);
+    m_key[1] = static_cast<boost::uint32_t>(seed >> 32);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Generates four random 32-bit words for the specified stream and index.
+   *
+   * \param stream  The stream (e.g. a frame index).
+   * \param index   The index within the stream (e.g. a pixel index).
+   * \param words   An array into which to write the generated words.
+   */
+  void generate_words(boost::uint64_t stream, boost::uint64_t index, boost::uint32_t words[4]) const
+  {
+    words[0] = static_cast<boost::uint32_t>(index);
+    words[1] = static_cast<boost::uint32_t>(index >> 32);
+    words[2] = static_cast<boost::uint32_t>(stream);
+    words[3] = static_cast<boost::uint32_t>(stream >> 32);
+    philox(m_key, words);
+  }
+
+  /**
+   * \brief Generates four independent random numbers from a 1D Gaussian distribution with the specified parameters.
+   *
+   * The numbers are generated from the four words for the specified stream and index (using the Box-Muller transform).
+   *
+   * \param stream  The stream (e.g. a frame index).
+   * \param index   The index within the stream (e.g. the index of a block of four pixels).
+   * \param mean    The mean of the Gaussian distribution.
+   * \param sigma   The standard deviation of the Gaussian distribution.
+   * \param values  An array into which to write the generated numbers.
+   */
+  void generate_from_gaussian(boost::uint64_t stream, boost::uint64_t index, float mean, float sigma, float values[4]) const
+  {
+    boost::uint32_t words[4];
+    generate_words(stream, index, words);
+
+    const float twoPi = 6.28318530718f;
+    for(int i = 0; i < 4; i += 2)
+    {
+      const float r = sigma * std::sqrt(-2.0f * std::log(to_unit_interval(words[i])));
+      const float theta = twoPi * to_unit_interval(words[i + 1]);
+      values[i] = mean + r * std::cos(theta);
+      values[i + 1] = mean + r * std::sin(theta);
+    }
+  }
+
+  //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Applies the Philox4x32-10 bijection to a counter using the specified key.
+   *
+   * \param key     The key.
+   * \param counter The counter (this will be replaced with the generated words).
+   */
+  static void philox(const boost::uint32_t key[2], boost::uint32_t counter[4])
+  {
+    const boost::uint32_t multiplier0 = 0xD2511F53, multiplier1 = 0xCD9E8D57;
+    const boost::uint32_t weyl0 = 0x9E3779B9, weyl1 = 0xBB67AE85;
+
+    boost::uint32_t k0 = key[0], k1 = key[1];
+    boost::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+
+    for(int i = 0; i < ROUND_COUNT; ++i)
+    {
+      const boost::uint64_t product0 = static_cast<boost::uint64_t>(multiplier0) * c0;
+      const boost::uint64_t product1 = static_cast<boost::uint64_t>(multiplier1) * c2;
+
+      const boost::uint32_t n0 = static_cast<boost::uint32_t>(product1 >> 32) ^ c1 ^ k0;
+      const boost::uint32_t n1 = static_cast<boost::uint32_t>(product1);
+      const boost::uint32_t n2 = static_cast<boost::uint32_t>(product0 >> 32) ^ c3 ^ k1;
+      const boost::uint32_t n3 = static_cast<boost::uint32_t>(product0);
+
+      c0 = n0; c1 = n1; c2 = n2; c3 = n3;
+      k0 += weyl0;
+      k1 += weyl1;
+    }
+
+    counter[0] = c0; counter[1] = c1; counter[2] = c2; counter[3] = c3;
+  }
+
+  /**
+   * \brief Converts a random 32-bit word to a real number in the range (0,1].
+   *
+   * \param word  The word.
+   * \return      The corresponding real number in the range (0,1].
+   */
+  static float to_unit_interval(boost::uint32_t word)
+  {
+    // Use the top 24 bits of the word, since that's all the precision a float has.
+    return ((word >> 8) + 1) * (1.0f / 16777216.0f);
+  }
+};
+
+}
+
+#endif
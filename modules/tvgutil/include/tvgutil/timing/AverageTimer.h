@@ -16,11 +16,17 @@
 #include <cuda_runtime.h>
 #endif
 
+#ifdef USE_TRACING
+#include "Tracer.h"
+#endif
+
 namespace tvgutil {
 
 /**
  * \brief An instance of an instantiation of this class template represents a timer that can be
  *        used to time an event over multiple runs and compute the average time taken per run.
+ *
+ * If USE_TRACING is defined, each run of the event is also recorded as a span (named after the timer) by the tracer.
  */
 template <typename Scale>
 class AverageTimer
@@ -42,6 +48,23 @@ private:
   /** The time taken by the event over all runs up to this point. */
   Scale m_totalDuration;
 
+#ifdef USE_TRACING
+  /** The event buffer of the thread on which the event's current run is being traced (or NULL if the current run is not being traced). */
+  Tracer::ThreadBuffer *m_traceBuffer;
+
+  /** The ID of the span for the event's current run. */
+  boost::uint64_t m_traceId;
+
+  /** The interned name of the timer, as used for its trace spans. */
+  const char *m_traceName;
+
+  /** The ID of the parent of the span for the event's current run. */
+  boost::uint64_t m_traceParentId;
+
+  /** The start time of the span for the event's current run (in time-stamp counter ticks). */
+  boost::int64_t m_traceStartTicks;
+#endif
+
   //#################### CONSTRUCTORS ####################
 public:
   /**
@@ -51,6 +74,9 @@ public:
    */
   explicit AverageTimer(const std::string& name)
   : m_count(0), m_name(name), m_totalDuration(0)
+#ifdef USE_TRACING
+    , m_traceBuffer(NULL), m_traceId(0), m_traceName(Tracer::instance().intern(name)), m_traceParentId(0), m_traceStartTicks(0)
+#endif
   {}
 
   //#################### PUBLIC MEMBER FUNCTIONS ####################
@@ -112,6 +138,11 @@ public:
    */
   void start_nosync()
   {
+#ifdef USE_TRACING
+    Tracer& tracer = Tracer::instance();
+    if(tracer.is_enabled()) m_traceBuffer = tracer.begin_span(m_traceId, m_traceParentId, m_traceStartTicks);
+#endif
+
     m_t0 = boost::chrono::high_resolution_clock::now();
   }
 
@@ -139,6 +170,14 @@ public:
     m_lastDuration = boost::chrono::duration_cast<Scale>(t1 - m_t0);
     m_totalDuration += m_lastDuration;
     ++m_count;
+
+#ifdef USE_TRACING
+    if(m_traceBuffer)
+    {
+      Tracer::end_span(m_traceBuffer, m_traceName, m_traceId, m_traceParentId, m_traceStartTicks);
+      m_traceBuffer = NULL;
+    }
+#endif
   }
 
   /**
@@ -0,0 +1,203 @@
+/**
+ * tvgutil: LatencyRecorder.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#ifndef H_TVGUTIL_LATENCYRECORDER
+#define H_TVGUTIL_LATENCYRECORDER
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#ifdef WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+
+namespace tvgutil {
+
+/**
+ * \brief An instance of this class can be used to record the latencies of the various stages of processing a sequence of frames,
+ *        together with named counts of events (e.g. dropped frames), and to report percentile latencies for each stage.
+ *
+ * One latency sample is recorded per stage per frame, and every sample is retained, so that exact percentiles can be reported
+ * at the end of a run. Samples can be recorded from multiple threads concurrently (e.g. when scenes are processed in parallel).
+ */
+class LatencyRecorder
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents the latency statistics for a particular stage.
+   */
+  struct StageStatistics
+  {
+    /** The number of latency samples recorded for the stage. */
+    size_t count;
+
+    /** The maximum latency of the stage (in milliseconds). */
+    double maxMs;
+
+    /** The mean latency of the stage (in milliseconds). */
+    double meanMs;
+
+    /** The name of the stage. */
+    std::string name;
+
+    /** The 50th, 95th and 99th percentile latencies of the stage (in milliseconds). */
+    double p50Ms, p95Ms, p99Ms;
+  };
+
+  /**
+   * \brief An instance of this class can be used to time a sequence of consecutive stages, recording the latency of each one.
+   *
+   * Each stage is taken to start when the previous one finished (or when the timer was constructed, for the first stage).
+   * If no recorder is specified, the timer does nothing, so it can be left in place at negligible cost when latencies are
+   * not being recorded. If WITH_CUDA is defined, the GPU is synchronised at each stage boundary (when recording), so that
+   * the work that each stage launches on the GPU is attributed to that stage.
+   */
+  class StageTimer
+  {
+  private:
+    /** The prefix to prepend to the name of each stage. */
+    std::string m_prefix;
+
+    /** The recorder (if any) in which to record the stage latencies. */
+    LatencyRecorder *m_recorder;
+
+    /** The time at which the current stage started. */
+    boost::chrono::steady_clock::time_point m_t0;
+
+  public:
+    /**
+     * \brief Constructs a stage timer, and starts timing the first stage.
+     *
+     * \param recorder  The recorder (if any) in which to record the stage latencies.
+     * \param prefix    The prefix to prepend to the name of each stage.
+     */
+    explicit StageTimer(const boost::shared_ptr<LatencyRecorder>& recorder, const std::string& prefix = "")
+    : m_recorder(recorder.get())
+    {
+      if(m_recorder)
+      {
+        m_prefix = prefix;
+        synchronise();
+        m_t0 = boost::chrono::steady_clock::now();
+      }
+    }
+
+  public:
+    /**
+     * \brief Finishes timing the current stage, records its latency, and starts timing the next stage.
+     *
+     * \param stage The name of the stage that has just finished.
+     */
+    void finish_stage(const char *stage)
+    {
+      if(!m_recorder) return;
+
+      synchronise();
+      const boost::chrono::steady_clock::time_point t1 = boost::chrono::steady_clock::now();
+      m_recorder->record_latency(m_prefix + stage, boost::chrono::duration<double,boost::milli>(t1 - m_t0).count());
+      m_t0 = t1;
+    }
+
+    /**
+     * \brief Starts timing the next stage afresh, without recording the time that has elapsed since the previous stage finished.
+     */
+    void skip_stage()
+    {
+      if(!m_recorder) return;
+
+      synchronise();
+      m_t0 = boost::chrono::steady_clock::now();
+    }
+
+  private:
+    /**
+     * \brief Waits for any work that has been launched on the GPU to finish (if WITH_CUDA is defined).
+     */
+    static void synchronise()
+    {
+#ifdef WITH_CUDA
+      cudaDeviceSynchronize();
+#endif
+    }
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The named counts of events that have been recorded so far. */
+  std::map<std::string,size_t> m_counters;
+
+  /** The latency samples (in milliseconds) that have been recorded so far for each stage. */
+  std::map<std::string,std::vector<double> > m_latencies;
+
+  /** The synchronisation mutex. */
+  mutable boost::mutex m_mutex;
+
+  /** The order in which the stages were first recorded (this is the order in which they are reported). */
+  std::vector<std::string> m_stageOrder;
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Adds the specified amount to a named counter (creating it if necessary).
+   *
+   * \param name    The name of the counter.
+   * \param amount  The amount to add to the counter.
+   */
+  void add_to_counter(const std::string& name, size_t amount = 1);
+
+  /**
+   * \brief Computes latency statistics for the stages that have been recorded so far.
+   *
+   * \return  The statistics for each stage (in the order in which the stages were first recorded).
+   */
+  std::vector<StageStatistics> compute_statistics() const;
+
+  /**
+   * \brief Gets the value of a named counter.
+   *
+   * \param name  The name of the counter.
+   * \return      The value of the counter, or 0 if nothing has been added to it yet.
+   */
+  size_t get_counter(const std::string& name) const;
+
+  /**
+   * \brief Gets the named counters that have been recorded so far.
+   *
+   * \return  The named counters that have been recorded so far.
+   */
+  std::map<std::string,size_t> get_counters() const;
+
+  /**
+   * \brief Outputs the latency statistics for each stage, followed by the named counters, to a stream.
+   *
+   * \param os  The stream.
+   */
+  void output_report(std::ostream& os) const;
+
+  /**
+   * \brief Records a latency sample for the specified stage.
+   *
+   * \param stage     The name of the stage.
+   * \param latencyMs The latency (in milliseconds).
+   */
+  void record_latency(const std::string& stage, double latencyMs);
+};
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<LatencyRecorder> LatencyRecorder_Ptr;
+typedef boost::shared_ptr<const LatencyRecorder> LatencyRecorder_CPtr;
+
+}
+
+#endif
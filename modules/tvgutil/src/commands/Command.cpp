@@ -24,4 +24,14 @@ const std::string& Command::get_description() const
   return m_description;
 }
 
+size_t Command::get_memory_usage() const
+{
+  return 0;
+}
+
+Command_CPtr Command::merge_with(const Command_CPtr& next, const std::string& description) const
+{
+  return Command_CPtr();
+}
+
 }
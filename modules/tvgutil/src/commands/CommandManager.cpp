@@ -13,8 +13,8 @@ namespace tvgutil {
 
 //#################### CONSTRUCTORS ####################
 
-CommandManager::CommandManager(size_t maxHistorySize)
-: m_maxHistorySize(maxHistorySize)
+CommandManager::CommandManager(size_t maxHistorySize, size_t maxHistoryMemory)
+: m_maxHistoryMemory(maxHistoryMemory), m_maxHistorySize(maxHistorySize)
 {
   if(maxHistorySize == 0)
   {
@@ -40,6 +40,7 @@ void CommandManager::execute_command(const Command_CPtr& c)
   m_executed.push_back(c);
   m_undone.clear();
   c->execute();
+  enforce_memory_budget();
 }
 
 void CommandManager::execute_compressible_command(const Command_CPtr& c, const std::map<std::string,std::string>& precursors)
@@ -56,10 +57,16 @@ void CommandManager::execute_compressible_command(const Command_CPtr& c, const s
     if(it != precursors.end())
     {
       // Note: We don't need to make space for a command here, since we're just replacing one command with another.
-      m_executed.pop_back();
-      m_executed.push_back(Command_CPtr(new SeqCommand(last, c, it->second)));
+      //       The new command is executed before trying to merge it with the last one, since commands may only
+      //       finalise the state they need for undo purposes once they have been executed.
       m_undone.clear();
       c->execute();
+
+      Command_CPtr combined = last->merge_with(c, it->second);
+      if(!combined) combined.reset(new SeqCommand(last, c, it->second));
+
+      m_executed.back() = combined;
+      enforce_memory_budget();
       return;
     }
 
@@ -73,6 +80,20 @@ size_t CommandManager::executed_count() const
   return m_executed.size();
 }
 
+size_t CommandManager::memory_usage() const
+{
+  size_t result = 0;
+  for(std::deque<Command_CPtr>::const_iterator it = m_executed.begin(), iend = m_executed.end(); it != iend; ++it)
+  {
+    result += (*it)->get_memory_usage();
+  }
+  for(std::deque<Command_CPtr>::const_iterator it = m_undone.begin(), iend = m_undone.end(); it != iend; ++it)
+  {
+    result += (*it)->get_memory_usage();
+  }
+  return result;
+}
+
 void CommandManager::redo()
 {
   if(can_redo())
@@ -108,6 +129,20 @@ size_t CommandManager::undone_count() const
 
 //#################### PRIVATE MEMBER FUNCTIONS ####################
 
+void CommandManager::enforce_memory_budget()
+{
+  // This function is called just after the execution of a new command, at which point the undo stack is empty.
+  // We discard the oldest commands until the history fits within its budget, but always keep the newest one.
+  if(m_maxHistoryMemory == std::numeric_limits<size_t>::max()) return;
+
+  size_t memoryUsage = memory_usage();
+  while(memoryUsage > m_maxHistoryMemory && m_executed.size() > 1)
+  {
+    memoryUsage -= m_executed.front()->get_memory_usage();
+    m_executed.pop_front();
+  }
+}
+
 void CommandManager::make_space_for_command()
 {
   // This function is called just before the execution of a new command to ensure that
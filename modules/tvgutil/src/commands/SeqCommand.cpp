@@ -38,6 +38,26 @@ void SeqCommand::execute() const
   }
 }
 
+size_t SeqCommand::get_memory_usage() const
+{
+  size_t result = 0;
+  for(std::vector<Command_CPtr>::const_iterator it = m_cs.begin(), iend = m_cs.end(); it != iend; ++it)
+  {
+    result += (*it)->get_memory_usage();
+  }
+  return result;
+}
+
+Command_CPtr SeqCommand::merge_with(const Command_CPtr& next, const std::string& description) const
+{
+  Command_CPtr mergedLast = m_cs.back()->merge_with(next, m_cs.back()->get_description());
+  if(!mergedLast) return Command_CPtr();
+
+  std::vector<Command_CPtr> cs(m_cs);
+  cs.back() = mergedLast;
+  return Command_CPtr(new SeqCommand(cs, description));
+}
+
 void SeqCommand::undo() const
 {
   for(std::vector<Command_CPtr>::const_reverse_iterator it = m_cs.rbegin(), iend = m_cs.rend(); it != iend; ++it)
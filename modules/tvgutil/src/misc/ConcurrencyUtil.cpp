@@ -0,0 +1,158 @@
+/**
+ * tvgutil: ConcurrencyUtil.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "misc/ConcurrencyUtil.h"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/config.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#ifndef BOOST_NO_CXX11_HDR_EXCEPTION
+  #include <exception>
+#else
+  #include <boost/exception_ptr.hpp>
+#endif
+
+#include "misc/ThreadPool.h"
+
+namespace tvgutil {
+
+//#################### ANONYMOUS FREE FUNCTIONS ####################
+
+namespace {
+
+#ifndef BOOST_NO_CXX11_HDR_EXCEPTION
+typedef std::exception_ptr ExceptionPtr;
+inline ExceptionPtr capture_exception() { return std::current_exception(); }
+inline void rethrow_captured_exception(const ExceptionPtr& e) { std::rethrow_exception(e); }
+#else
+typedef boost::exception_ptr ExceptionPtr;
+inline ExceptionPtr capture_exception() { return boost::current_exception(); }
+inline void rethrow_captured_exception(const ExceptionPtr& e) { boost::rethrow_exception(e); }
+#endif
+
+/**
+ * \brief An instance of this struct holds the state shared by the worker threads that are running a set of tasks.
+ *
+ * The state is shared (rather than being owned by the caller of run_tasks) because a pool thread may only get around to
+ * starting its worker after all of the tasks have been finished by the other workers and run_tasks has returned.
+ */
+struct TaskQueue
+{
+  /** The number of workers that are currently claiming and running tasks. */
+  size_t activeWorkerCount;
+
+  /** A condition variable used to wait for the active workers to finish. */
+  boost::condition_variable finished;
+
+  /** The exception thrown by the first task to fail (if any). */
+  ExceptionPtr error;
+
+  /** The synchronisation mutex. */
+  boost::mutex mutex;
+
+  /** The index of the next unclaimed task. */
+  size_t nextTask;
+
+  /** A function that runs the task with a specified index. */
+  boost::function<void(size_t)> task;
+
+  /** The number of tasks to run. */
+  size_t taskCount;
+};
+
+typedef boost::shared_ptr<TaskQueue> TaskQueue_Ptr;
+
+/**
+ * \brief Gets the pool of threads used to run tasks concurrently.
+ *
+ * The pool is kept separate from the global thread pool, since the tasks it runs may block for a long time.
+ *
+ * \return  The pool of threads used to run tasks concurrently.
+ */
+ThreadPool& get_task_pool()
+{
+  static ThreadPool s_pool(0);
+  return s_pool;
+}
+
+/**
+ * \brief Repeatedly claims and runs the next unclaimed task in a task queue, until either there are no tasks left or a task has failed.
+ *
+ * \param queue The task queue.
+ */
+void run_worker(const TaskQueue_Ptr& queue)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(queue->mutex);
+    ++queue->activeWorkerCount;
+  }
+
+  for(;;)
+  {
+    size_t i;
+    {
+      boost::lock_guard<boost::mutex> lock(queue->mutex);
+      if(queue->nextTask == queue->taskCount || queue->error)
+      {
+        if(--queue->activeWorkerCount == 0) queue->finished.notify_all();
+        return;
+      }
+      i = queue->nextTask++;
+    }
+
+    try
+    {
+      queue->task(i);
+    }
+    catch(...)
+    {
+      boost::lock_guard<boost::mutex> lock(queue->mutex);
+      if(!queue->error) queue->error = capture_exception();
+    }
+  }
+}
+
+}
+
+//#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
+
+void ConcurrencyUtil::run_tasks(size_t taskCount, size_t threadCount, const boost::function<void(size_t)>& task)
+{
+  TaskQueue_Ptr queue(new TaskQueue);
+  queue->activeWorkerCount = 0;
+  queue->nextTask = 0;
+  queue->task = task;
+  queue->taskCount = taskCount;
+
+  // Post a helper worker to the task pool for each thread other than the calling thread, making sure that the pool is
+  // large enough to run them all at once. If we only need a single thread, no helpers are posted, and the tasks are
+  // simply run in order on the calling thread.
+  const size_t helperCount = std::min(threadCount, taskCount) > 1 ? std::min(threadCount, taskCount) - 1 : 0;
+  if(helperCount > 0)
+  {
+    ThreadPool& pool = get_task_pool();
+    pool.ensure_thread_count(helperCount);
+    for(size_t i = 0; i < helperCount; ++i)
+    {
+      pool.post_task(boost::bind(run_worker, queue));
+    }
+  }
+
+  // Run a worker on the calling thread. Once it returns, every task has been claimed, so we only need to wait for the
+  // helpers that are still running tasks (helpers that have not yet started will find nothing left to do). Not waiting
+  // for the helpers to start avoids deadlock when run_tasks is called from within a task that is itself running in the pool.
+  run_worker(queue);
+
+  boost::unique_lock<boost::mutex> lock(queue->mutex);
+  while(queue->activeWorkerCount > 0) queue->finished.wait(lock);
+
+  if(queue->error) rethrow_captured_exception(queue->error);
+}
+
+}
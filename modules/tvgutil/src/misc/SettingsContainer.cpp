@@ -11,26 +11,77 @@ namespace tvgutil {
 
 const std::string SettingsContainer::NOT_SET = "<Not Set>";
 
+//#################### CONSTRUCTORS ####################
+
+SettingsContainer::SettingsContainer()
+: m_revision(0)
+{}
+
+SettingsContainer::SettingsContainer(const SettingsContainer& rhs)
+{
+  boost::lock_guard<boost::mutex> lock(rhs.m_mutex);
+  m_revision.store(rhs.m_revision.load(boost::memory_order_relaxed), boost::memory_order_relaxed);
+  m_settings = rhs.m_settings;
+}
+
 //#################### DESTRUCTOR ####################
 
 SettingsContainer::~SettingsContainer() {}
 
+//#################### COPY ASSIGNMENT OPERATOR ####################
+
+SettingsContainer& SettingsContainer::operator=(const SettingsContainer& rhs)
+{
+  if(&rhs == this) return *this;
+
+  // Copy the settings whilst holding only the other container's mutex, so that there is no risk of deadlock.
+  std::map<std::string,std::vector<std::string> > settings;
+  {
+    boost::lock_guard<boost::mutex> lock(rhs.m_mutex);
+    settings = rhs.m_settings;
+  }
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_settings.swap(settings);
+  m_revision.fetch_add(1, boost::memory_order_release);
+  return *this;
+}
+
 //#################### PUBLIC MEMBER FUNCTIONS ####################
 
 void SettingsContainer::add_value(const std::string& key, const std::string& value)
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   m_settings[key].push_back(value);
+  m_revision.fetch_add(1, boost::memory_order_release);
+}
+
+size_t SettingsContainer::get_revision() const
+{
+  // Note: The revision is always incremented after the settings have been changed (with the mutex held), so a client that
+  //       sees a new revision and then reads a setting is guaranteed to see the change that caused it.
+  return m_revision.load(boost::memory_order_acquire);
 }
 
 bool SettingsContainer::has_values(const std::string& key) const
 {
+  boost::lock_guard<boost::mutex> lock(m_mutex);
   return MapUtil::contains(m_settings, key);
 }
 
+void SettingsContainer::set_value(const std::string& key, const std::string& value)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  std::vector<std::string>& values = m_settings[key];
+  values.assign(1, value);
+  m_revision.fetch_add(1, boost::memory_order_release);
+}
+
 //#################### STREAM OPERATORS ####################
 
 std::ostream& operator<<(std::ostream& os, const SettingsContainer& rhs)
 {
+  boost::lock_guard<boost::mutex> lock(rhs.m_mutex);
   for(std::map<std::string,std::vector<std::string> >::const_iterator it = rhs.m_settings.begin(), iend = rhs.m_settings.end(); it != iend; ++it)
   {
     os << it->first << ":\n";
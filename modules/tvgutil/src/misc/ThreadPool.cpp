@@ -34,6 +34,17 @@ ThreadPool::~ThreadPool()
   m_scheduler.stop();
 }
 
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void ThreadPool::ensure_thread_count(size_t threadCount)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  while(m_threads.size() < threadCount)
+  {
+    m_threads.create_thread(boost::bind(&boost::asio::io_service::run, &m_scheduler));
+  }
+}
+
 //#################### PUBLIC STATIC MEMBER FUNCTIONS ####################
 
 ThreadPool& ThreadPool::instance()
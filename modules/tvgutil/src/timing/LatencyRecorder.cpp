@@ -0,0 +1,126 @@
+/**
+ * tvgutil: LatencyRecorder.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include "timing/LatencyRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/format.hpp>
+
+namespace tvgutil {
+
+//#################### ANONYMOUS FREE FUNCTIONS ####################
+
+namespace {
+
+/**
+ * \brief Computes the specified percentile of a sorted, non-empty set of latencies (using the nearest-rank method).
+ *
+ * \param sortedLatencies The sorted latencies.
+ * \param percentile      The percentile (in the range [0,100]).
+ * \return                The specified percentile of the latencies.
+ */
+double nearest_rank_percentile(const std::vector<double>& sortedLatencies, double percentile)
+{
+  const size_t n = sortedLatencies.size();
+  size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * n));
+  if(rank < 1) rank = 1;
+  if(rank > n) rank = n;
+  return sortedLatencies[rank - 1];
+}
+
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+void LatencyRecorder::add_to_counter(const std::string& name, size_t amount)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_counters[name] += amount;
+}
+
+std::vector<LatencyRecorder::StageStatistics> LatencyRecorder::compute_statistics() const
+{
+  // Copy the latencies so that we can sort them without holding the lock.
+  std::vector<std::string> stageOrder;
+  std::map<std::string,std::vector<double> > latencies;
+  {
+    boost::lock_guard<boost::mutex> lock(m_mutex);
+    stageOrder = m_stageOrder;
+    latencies = m_latencies;
+  }
+
+  std::vector<StageStatistics> result;
+  for(size_t i = 0, size = stageOrder.size(); i < size; ++i)
+  {
+    std::vector<double>& ls = latencies[stageOrder[i]];
+    std::sort(ls.begin(), ls.end());
+
+    double total = 0.0;
+    for(size_t j = 0, lsSize = ls.size(); j < lsSize; ++j) total += ls[j];
+
+    StageStatistics stats;
+    stats.count = ls.size();
+    stats.maxMs = ls.back();
+    stats.meanMs = total / ls.size();
+    stats.name = stageOrder[i];
+    stats.p50Ms = nearest_rank_percentile(ls, 50.0);
+    stats.p95Ms = nearest_rank_percentile(ls, 95.0);
+    stats.p99Ms = nearest_rank_percentile(ls, 99.0);
+    result.push_back(stats);
+  }
+
+  return result;
+}
+
+size_t LatencyRecorder::get_counter(const std::string& name) const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  std::map<std::string,size_t>::const_iterator it = m_counters.find(name);
+  return it != m_counters.end() ? it->second : 0;
+}
+
+std::map<std::string,size_t> LatencyRecorder::get_counters() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_counters;
+}
+
+void LatencyRecorder::output_report(std::ostream& os) const
+{
+  std::vector<StageStatistics> stats = compute_statistics();
+  os << boost::format("%-40s %10s %12s %12s %12s %12s %12s\n") % "Stage" % "Count" % "Mean (ms)" % "p50 (ms)" % "p95 (ms)" % "p99 (ms)" % "Max (ms)";
+  for(size_t i = 0, size = stats.size(); i < size; ++i)
+  {
+    const StageStatistics& s = stats[i];
+    os << boost::format("%-40s %10d %12.2f %12.2f %12.2f %12.2f %12.2f\n") % s.name % s.count % s.meanMs % s.p50Ms % s.p95Ms % s.p99Ms % s.maxMs;
+  }
+
+  const std::map<std::string,size_t> counters = get_counters();
+  if(!counters.empty())
+  {
+    os << '\n' << boost::format("%-40s %10s\n") % "Counter" % "Value";
+    for(std::map<std::string,size_t>::const_iterator it = counters.begin(), iend = counters.end(); it != iend; ++it)
+    {
+      os << boost::format("%-40s %10d\n") % it->first % it->second;
+    }
+  }
+}
+
+void LatencyRecorder::record_latency(const std::string& stage, double latencyMs)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  std::map<std::string,std::vector<double> >::iterator it = m_latencies.find(stage);
+  if(it == m_latencies.end())
+  {
+    it = m_latencies.insert(std::make_pair(stage, std::vector<double>())).first;
+    m_stageOrder.push_back(stage);
+  }
+
+  it->second.push_back(latencyMs);
+}
+
+}
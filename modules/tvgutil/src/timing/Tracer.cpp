@@ -0,0 +1,371 @@
+/**
+ * tvgutil: Tracer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include "timing/Tracer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include <boost/format.hpp>
+
+// Note: We use the compiler-specific thread-local storage qualifiers rather than boost::thread_specific_ptr,
+//       since the latter would add a map lookup to the cost of recording every span.
+#ifdef _MSC_VER
+  #define TVGUTIL_THREAD_LOCAL __declspec(thread)
+#else
+  #define TVGUTIL_THREAD_LOCAL __thread
+#endif
+
+// Note: We timestamp spans using the CPU's time-stamp counter where possible, since reading it is much cheaper than reading the system clock.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+  #define TVGUTIL_HAS_TSC
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <x86intrin.h>
+  #define TVGUTIL_HAS_TSC
+#endif
+
+namespace tvgutil {
+
+//#################### NESTED TYPES ####################
+
+/**
+ * \brief An instance of this struct represents the event buffer for a single thread.
+ *
+ * Only the owning thread ever writes to the buffer. Each event is written before the buffer's size is incremented
+ * (with release semantics), so readers on other threads can safely read any event whose index is less than the size.
+ * The times of the events in the buffer are stored in time-stamp counter ticks, and converted to nanoseconds when read.
+ */
+struct Tracer::ThreadBuffer
+{
+  /** The number of events that have been dropped because the buffer was full. */
+  boost::atomic<size_t> droppedCount;
+
+  /** The storage for the events (allocated up-front, so that it is never reallocated while readers may be accessing it). */
+  std::vector<Event> events;
+
+  /** The local index to use for the next span opened on the thread. */
+  boost::uint64_t nextLocalId;
+
+  /** The number of spans that have been closed whilst spans they enclosed were still open. */
+  boost::atomic<size_t> nonNestedCount;
+
+  /** The IDs of the spans that are currently open on the thread, from outermost to innermost. */
+  std::vector<boost::uint64_t> openSpans;
+
+  /** The number of events in the buffer. */
+  boost::atomic<size_t> size;
+
+  /** The index of the thread. */
+  boost::uint32_t threadIndex;
+
+  ThreadBuffer(boost::uint32_t threadIndex_, size_t capacity)
+  : droppedCount(0), events(capacity), nextLocalId(0), nonNestedCount(0), size(0), threadIndex(threadIndex_)
+  {
+    // Reserve enough space for any reasonable nesting depth, so that opening a span does not normally allocate.
+    openSpans.reserve(64);
+  }
+};
+
+//#################### ANONYMOUS FREE FUNCTIONS ####################
+
+namespace {
+
+/** The current thread's event buffer. */
+TVGUTIL_THREAD_LOCAL Tracer::ThreadBuffer *t_threadBuffer = NULL;
+
+/**
+ * \brief Computes the specified percentile of a sorted, non-empty set of durations (using the nearest-rank method).
+ *
+ * \param sortedDurations The sorted durations.
+ * \param percentile      The percentile (in the range [0,100]).
+ * \return                The specified percentile of the durations.
+ */
+boost::int64_t nearest_rank_percentile(const std::vector<boost::int64_t>& sortedDurations, double percentile)
+{
+  const size_t n = sortedDurations.size();
+  size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * n));
+  if(rank < 1) rank = 1;
+  if(rank > n) rank = n;
+  return sortedDurations[rank - 1];
+}
+
+/**
+ * \brief Reads the current time in time-stamp counter ticks.
+ *
+ * \return  The current time in time-stamp counter ticks (or in nanoseconds, on platforms without a usable time-stamp counter).
+ */
+inline boost::int64_t read_ticks()
+{
+#ifdef TVGUTIL_HAS_TSC
+  return static_cast<boost::int64_t>(__rdtsc());
+#else
+  return boost::chrono::duration_cast<boost::chrono::nanoseconds>(boost::chrono::high_resolution_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * \brief Writes a string to a stream as a JSON string literal.
+ *
+ * \param os  The stream.
+ * \param s   The string.
+ */
+void write_json_string(std::ostream& os, const char *s)
+{
+  os << '"';
+  for(; *s; ++s)
+  {
+    const unsigned char c = static_cast<unsigned char>(*s);
+    switch(c)
+    {
+      case '"': os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\r': os << "\\r"; break;
+      case '\t': os << "\\t"; break;
+      default:
+      {
+        if(c < 0x20) os << boost::format("\\u%04x") % static_cast<int>(c);
+        else os << *s;
+        break;
+      }
+    }
+  }
+  os << '"';
+}
+
+}
+
+//#################### SINGLETON IMPLEMENTATION ####################
+
+Tracer::Tracer()
+: m_bufferCapacity(1 << 16), m_enabled(false), m_epoch(boost::chrono::high_resolution_clock::now()), m_epochTicks(read_ticks())
+{}
+
+Tracer& Tracer::instance()
+{
+  static Tracer s_instance;
+  return s_instance;
+}
+
+//#################### PUBLIC MEMBER FUNCTIONS ####################
+
+Tracer::ThreadBuffer *Tracer::begin_span(boost::uint64_t& id, boost::uint64_t& parentId, boost::int64_t& startTicks)
+{
+  ThreadBuffer *buffer = get_thread_buffer();
+
+  // Note: The thread index is stored in the upper bits of the ID, so that IDs are unique across threads without any synchronisation.
+  parentId = buffer->openSpans.empty() ? 0 : buffer->openSpans.back();
+  id = (static_cast<boost::uint64_t>(buffer->threadIndex + 1) << 40) | ++buffer->nextLocalId;
+  buffer->openSpans.push_back(id);
+
+  startTicks = read_ticks();
+  return buffer;
+}
+
+void Tracer::clear()
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  for(size_t i = 0, size = m_threadBuffers.size(); i < size; ++i)
+  {
+    m_threadBuffers[i]->droppedCount.store(0);
+    m_threadBuffers[i]->nonNestedCount.store(0);
+    m_threadBuffers[i]->size.store(0);
+  }
+}
+
+std::vector<Tracer::SpanStatistics> Tracer::compute_statistics() const
+{
+  // Group the span durations by name.
+  std::map<std::string,std::vector<boost::int64_t> > durations;
+  std::vector<Event> events = get_events();
+  for(size_t i = 0, size = events.size(); i < size; ++i)
+  {
+    durations[events[i].name].push_back(events[i].endNs - events[i].startNs);
+  }
+
+  // Compute the statistics for each name.
+  std::vector<SpanStatistics> result;
+  for(std::map<std::string,std::vector<boost::int64_t> >::iterator it = durations.begin(), iend = durations.end(); it != iend; ++it)
+  {
+    std::vector<boost::int64_t>& ds = it->second;
+    std::sort(ds.begin(), ds.end());
+
+    double total = 0.0;
+    for(size_t j = 0, size = ds.size(); j < size; ++j) total += static_cast<double>(ds[j]);
+
+    SpanStatistics stats;
+    stats.count = ds.size();
+    stats.maxNs = ds.back();
+    stats.meanNs = total / ds.size();
+    stats.name = it->first;
+    stats.p50Ns = nearest_rank_percentile(ds, 50.0);
+    stats.p95Ns = nearest_rank_percentile(ds, 95.0);
+    stats.p99Ns = nearest_rank_percentile(ds, 99.0);
+    result.push_back(stats);
+  }
+
+  return result;
+}
+
+size_t Tracer::dropped_event_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  size_t result = 0;
+  for(size_t i = 0, size = m_threadBuffers.size(); i < size; ++i)
+  {
+    result += m_threadBuffers[i]->droppedCount.load();
+  }
+  return result;
+}
+
+void Tracer::end_span(ThreadBuffer *buffer, const char *name, boost::uint64_t id, boost::uint64_t parentId, boost::int64_t startTicks)
+{
+  const boost::int64_t endTicks = read_ticks();
+
+  // Remove the span from the stack of open spans. In the common case, it will be the innermost open span; if not, it was
+  // closed whilst spans it enclosed were still open, so we remove it from the middle of the stack and count the closure.
+  std::vector<boost::uint64_t>& openSpans = buffer->openSpans;
+  if(!openSpans.empty() && openSpans.back() == id) openSpans.pop_back();
+  else
+  {
+    std::vector<boost::uint64_t>::iterator it = std::find(openSpans.begin(), openSpans.end(), id);
+    if(it != openSpans.end()) openSpans.erase(it);
+    buffer->nonNestedCount.fetch_add(1, boost::memory_order_relaxed);
+  }
+
+  // If there's space in the buffer, write the event and then publish it; otherwise, drop it.
+  const size_t size = buffer->size.load(boost::memory_order_relaxed);
+  if(size < buffer->events.size())
+  {
+    Event& event = buffer->events[size];
+    event.endNs = endTicks;
+    event.id = id;
+    event.name = name;
+    event.parentId = parentId;
+    event.startNs = startTicks;
+    event.threadIndex = buffer->threadIndex;
+    buffer->size.store(size + 1, boost::memory_order_release);
+  }
+  else buffer->droppedCount.fetch_add(1, boost::memory_order_relaxed);
+}
+
+std::vector<Tracer::Event> Tracer::get_events() const
+{
+  // Calibrate the time-stamp counter against the system clock over the whole lifetime of the tracer so far.
+  const boost::int64_t elapsedNs = boost::chrono::duration_cast<boost::chrono::nanoseconds>(boost::chrono::high_resolution_clock::now() - m_epoch).count();
+  const boost::int64_t elapsedTicks = read_ticks() - m_epochTicks;
+  const double nsPerTick = elapsedTicks > 0 ? static_cast<double>(elapsedNs) / elapsedTicks : 1.0;
+
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  std::vector<Event> result;
+  for(size_t i = 0, size = m_threadBuffers.size(); i < size; ++i)
+  {
+    const ThreadBuffer& buffer = *m_threadBuffers[i];
+    const size_t eventCount = buffer.size.load(boost::memory_order_acquire);
+    result.insert(result.end(), buffer.events.begin(), buffer.events.begin() + eventCount);
+  }
+
+  // Convert the event times from ticks to nanoseconds since the tracer was constructed.
+  for(size_t i = 0, size = result.size(); i < size; ++i)
+  {
+    result[i].startNs = static_cast<boost::int64_t>((result[i].startNs - m_epochTicks) * nsPerTick);
+    result[i].endNs = static_cast<boost::int64_t>((result[i].endNs - m_epochTicks) * nsPerTick);
+  }
+
+  return result;
+}
+
+const char *Tracer::intern(const std::string& name)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  return m_internedNames.insert(name).first->c_str();
+}
+
+size_t Tracer::non_nested_span_count() const
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  size_t result = 0;
+  for(size_t i = 0, size = m_threadBuffers.size(); i < size; ++i)
+  {
+    result += m_threadBuffers[i]->nonNestedCount.load();
+  }
+  return result;
+}
+
+void Tracer::output_statistics(std::ostream& os) const
+{
+  std::vector<SpanStatistics> stats = compute_statistics();
+  os << boost::format("%-40s %10s %12s %12s %12s %12s %12s\n") % "Span" % "Count" % "Mean (us)" % "p50 (us)" % "p95 (us)" % "p99 (us)" % "Max (us)";
+  for(size_t i = 0, size = stats.size(); i < size; ++i)
+  {
+    const SpanStatistics& s = stats[i];
+    os << boost::format("%-40s %10d %12.1f %12.1f %12.1f %12.1f %12.1f\n")
+          % s.name % s.count % (s.meanNs / 1000.0) % (s.p50Ns / 1000.0) % (s.p95Ns / 1000.0) % (s.p99Ns / 1000.0) % (s.maxNs / 1000.0);
+  }
+
+  const size_t droppedCount = dropped_event_count();
+  if(droppedCount > 0) os << "Warning: " << droppedCount << " events were dropped because a thread's trace buffer was full\n";
+
+  const size_t nonNestedCount = non_nested_span_count();
+  if(nonNestedCount > 0) os << "Warning: " << nonNestedCount << " spans were closed whilst spans they enclosed were still open\n";
+}
+
+void Tracer::set_buffer_capacity(size_t bufferCapacity)
+{
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  m_bufferCapacity = bufferCapacity;
+}
+
+void Tracer::set_enabled(bool enabled)
+{
+  m_enabled.store(enabled);
+}
+
+void Tracer::write_chrome_trace(std::ostream& os) const
+{
+  std::vector<Event> events = get_events();
+
+  // Note: Chrome expects the timestamps and durations of complete ("X") events to be specified in microseconds.
+  os << "{\"traceEvents\":[";
+  for(size_t i = 0, size = events.size(); i < size; ++i)
+  {
+    const Event& e = events[i];
+    if(i > 0) os << ',';
+    os << "\n{\"name\":";
+    write_json_string(os, e.name);
+    os << boost::format(",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":%d,\"parent\":%d}}")
+          % e.threadIndex % (e.startNs / 1000.0) % ((e.endNs - e.startNs) / 1000.0) % e.id % e.parentId;
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void Tracer::write_chrome_trace(const std::string& filename) const
+{
+  std::ofstream fs(filename.c_str());
+  if(!fs) throw std::runtime_error("Error: Could not open '" + filename + "' for writing");
+  write_chrome_trace(fs);
+}
+
+//#################### PRIVATE MEMBER FUNCTIONS ####################
+
+Tracer::ThreadBuffer *Tracer::get_thread_buffer()
+{
+  // If the current thread already has a buffer, return it (this is the fast path, and requires no locking).
+  if(t_threadBuffer) return t_threadBuffer;
+
+  // Otherwise, register a new buffer for the thread. Note that the tracer retains ownership of the buffer after
+  // the thread exits, so that the thread's events can still be exported.
+  boost::lock_guard<boost::mutex> lock(m_mutex);
+  ThreadBuffer_Ptr buffer(new ThreadBuffer(static_cast<boost::uint32_t>(m_threadBuffers.size()), m_bufferCapacity));
+  m_threadBuffers.push_back(buffer);
+  t_threadBuffer = buffer.get();
+  return t_threadBuffer;
+}
+
+}
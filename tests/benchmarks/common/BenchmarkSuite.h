@@ -0,0 +1,281 @@
+/**
+ * benchmarks: BenchmarkSuite.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#ifndef H_BENCHMARKS_BENCHMARKSUITE
+#define H_BENCHMARKS_BENCHMARKSUITE
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/format.hpp>
+#include <boost/function.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <tvgutil/timing/TimeUtil.h>
+
+namespace benchmarks {
+
+/**
+ * \brief Prevents the compiler from optimising away the computation of the specified value.
+ *
+ * \param value The value.
+ */
+template <typename T>
+inline void keep(const T& value)
+{
+#if defined(__GNUC__)
+  // The empty assembly block may read the value (or any other memory), so the compiler must have computed and stored it beforehand.
+  asm volatile("" : : "g"(&value) : "memory");
+#else
+  // Read the value byte by byte into a volatile sink, so that the compiler must have computed it beforehand.
+  static volatile unsigned char s_sink = 0;
+  const volatile unsigned char *bytes = reinterpret_cast<const volatile unsigned char*>(&value);
+  for(size_t i = 0; i < sizeof(T); ++i) s_sink = bytes[i];
+#endif
+}
+
+/**
+ * \brief An instance of this class can be used to run a suite of benchmarks and output the results in JSON format.
+ *
+ * Each benchmark is a function that performs one iteration of the operation being measured. The suite first runs the
+ * function once to warm up (and to estimate how long it takes), and then records a number of samples, each of which is
+ * the mean time per iteration over enough iterations to make the sample last for at least a minimum length of time.
+ * Recording the individual samples (rather than just their mean) allows the results of two runs to be compared using
+ * a statistical test (see compare_benchmarks.py).
+ *
+ * The behaviour of the suite can be controlled from the command line:
+ *
+ * --filter <substring>   Only run the benchmarks whose names contain the specified substring.
+ * --minSampleMs <ms>     The minimum length of time for which each sample should last (default: 50ms).
+ * --output <file>        The file to which to write the results in JSON format (if omitted, no JSON is written).
+ * --samples <count>      The number of samples to record for each benchmark (default: 20).
+ */
+class BenchmarkSuite
+{
+  //#################### TYPEDEFS ####################
+public:
+  typedef boost::function<void()> Benchmark;
+
+  //#################### NESTED TYPES ####################
+private:
+  /**
+   * \brief An instance of this struct represents the result of running a single benchmark.
+   */
+  struct Result
+  {
+    /** The number of iterations of the benchmark that were run to record each sample. */
+    size_t iterationsPerSample;
+
+    /** The number of items (e.g. pixels or frames) processed by each iteration of the benchmark. */
+    size_t itemsPerIteration;
+
+    /** The name of the benchmark. */
+    std::string name;
+
+    /** The samples (each of which is the mean time taken by an iteration of the benchmark, in nanoseconds). */
+    std::vector<double> samples;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** A substring that the names of the benchmarks to run must contain (if empty, all of the benchmarks will be run). */
+  std::string m_filter;
+
+  /** The minimum length of time for which each sample should last (in nanoseconds). */
+  double m_minSampleNs;
+
+  /** The file to which to write the results in JSON format (if empty, no JSON will be written). */
+  std::string m_outputFilename;
+
+  /** The results of the benchmarks that have been run so far. */
+  std::vector<Result> m_results;
+
+  /** The number of samples to record for each benchmark. */
+  size_t m_sampleCount;
+
+  /** The name of the suite. */
+  std::string m_suiteName;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Constructs a benchmark suite.
+   *
+   * \param suiteName The name of the suite.
+   * \param argc      The number of command-line arguments.
+   * \param argv      The command-line arguments.
+   *
+   * \throws std::runtime_error If the command-line arguments are invalid.
+   */
+  BenchmarkSuite(const std::string& suiteName, int argc, char *argv[])
+  : m_minSampleNs(50e6), m_sampleCount(20), m_suiteName(suiteName)
+  {
+    for(int i = 1; i < argc; ++i)
+    {
+      const std::string arg = argv[i];
+      if(i + 1 == argc) throw std::runtime_error("Error: Missing value for command-line argument '" + arg + "'");
+      const std::string value = argv[++i];
+
+      if(arg == "--filter") m_filter = value;
+      else if(arg == "--minSampleMs") m_minSampleNs = boost::lexical_cast<double>(value) * 1e6;
+      else if(arg == "--output") m_outputFilename = value;
+      else if(arg == "--samples") m_sampleCount = boost::lexical_cast<size_t>(value);
+      else throw std::runtime_error("Error: Unknown command-line argument '" + arg + "'");
+    }
+
+    if(m_sampleCount < 2) throw std::runtime_error("Error: At least two samples are needed for each benchmark");
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Writes the results of the benchmarks that have been run to the output file (if any).
+   *
+   * \return  EXIT_SUCCESS, if the results were successfully written, or EXIT_FAILURE otherwise.
+   */
+  int finish() const
+  {
+    if(m_outputFilename.empty()) return EXIT_SUCCESS;
+
+    std::ofstream fs(m_outputFilename.c_str());
+    if(!fs)
+    {
+      std::cerr << "Error: Could not open '" << m_outputFilename << "' for writing\n";
+      return EXIT_FAILURE;
+    }
+
+    write_json(fs);
+    return fs ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  /**
+   * \brief Runs the specified benchmark (if its name passes the filter) and records the result.
+   *
+   * \param name              The name of the benchmark.
+   * \param benchmark         A function that performs one iteration of the benchmark.
+   * \param itemsPerIteration The number of items (e.g. pixels or frames) processed by each iteration of the benchmark.
+   * \param sampleCount       The number of samples to record (if 0, the suite's default sample count will be used).
+   */
+  void run(const std::string& name, const Benchmark& benchmark, size_t itemsPerIteration = 1, size_t sampleCount = 0)
+  {
+    if(name.find(m_filter) == std::string::npos) return;
+
+    Result result;
+    result.itemsPerIteration = itemsPerIteration;
+    result.name = name;
+
+    // Run the benchmark once to warm up, and use the time it takes to decide how many iterations to run per sample.
+    const double warmupNs = time_iterations(benchmark, 1);
+    result.iterationsPerSample = static_cast<size_t>(std::max(1.0, std::ceil(m_minSampleNs / std::max(warmupNs, 1.0))));
+
+    // Record the samples.
+    if(sampleCount == 0) sampleCount = m_sampleCount;
+    result.samples.reserve(sampleCount);
+    for(size_t i = 0; i < sampleCount; ++i)
+    {
+      result.samples.push_back(time_iterations(benchmark, result.iterationsPerSample));
+    }
+
+    m_results.push_back(result);
+
+    // Output a summary of the result.
+    std::vector<double> sortedSamples = result.samples;
+    std::sort(sortedSamples.begin(), sortedSamples.end());
+    const double medianNs = compute_median(sortedSamples);
+    std::cout << boost::format("%-50s %14.3fus (min %.3fus, max %.3fus) %12.1f items/s\n")
+                 % name % (medianNs / 1000.0) % (sortedSamples.front() / 1000.0) % (sortedSamples.back() / 1000.0)
+                 % (itemsPerIteration * 1e9 / medianNs);
+  }
+
+  //#################### PRIVATE MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Writes the results of the benchmarks that have been run to a stream in JSON format.
+   *
+   * \param os  The stream.
+   */
+  void write_json(std::ostream& os) const
+  {
+    os << "{\n  \"suite\": \"" << m_suiteName << "\",\n";
+    os << "  \"timestamp\": \"" << tvgutil::TimeUtil::get_iso_timestamp() << "\",\n";
+    os << "  \"unit\": \"ns\",\n";
+    os << "  \"benchmarks\": [";
+
+    for(size_t i = 0, size = m_results.size(); i < size; ++i)
+    {
+      const Result& result = m_results[i];
+
+      std::vector<double> sortedSamples = result.samples;
+      std::sort(sortedSamples.begin(), sortedSamples.end());
+
+      double mean = 0.0;
+      for(size_t j = 0, sampleCount = sortedSamples.size(); j < sampleCount; ++j) mean += sortedSamples[j];
+      mean /= sortedSamples.size();
+
+      double variance = 0.0;
+      for(size_t j = 0, sampleCount = sortedSamples.size(); j < sampleCount; ++j) variance += (sortedSamples[j] - mean) * (sortedSamples[j] - mean);
+      variance /= sortedSamples.size() - 1;
+
+      os << (i > 0 ? "," : "") << "\n    {\n";
+      os << "      \"name\": \"" << result.name << "\",\n";
+      os << "      \"iterationsPerSample\": " << result.iterationsPerSample << ",\n";
+      os << "      \"itemsPerIteration\": " << result.itemsPerIteration << ",\n";
+      os << boost::format("      \"mean\": %.3f,\n") % mean;
+      os << boost::format("      \"median\": %.3f,\n") % compute_median(sortedSamples);
+      os << boost::format("      \"min\": %.3f,\n") % sortedSamples.front();
+      os << boost::format("      \"max\": %.3f,\n") % sortedSamples.back();
+      os << boost::format("      \"stddev\": %.3f,\n") % std::sqrt(variance);
+      os << "      \"samples\": [";
+      for(size_t j = 0, sampleCount = result.samples.size(); j < sampleCount; ++j)
+      {
+        os << (j > 0 ? ", " : "") << boost::format("%.3f") % result.samples[j];
+      }
+      os << "]\n    }";
+    }
+
+    os << "\n  ]\n}\n";
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes the median of a sorted, non-empty set of values.
+   *
+   * \param sortedValues  The sorted values.
+   * \return              The median of the values.
+   */
+  static double compute_median(const std::vector<double>& sortedValues)
+  {
+    const size_t n = sortedValues.size();
+    return n % 2 == 1 ? sortedValues[n / 2] : (sortedValues[n / 2 - 1] + sortedValues[n / 2]) / 2.0;
+  }
+
+  /**
+   * \brief Runs the specified number of iterations of a benchmark and computes the mean time taken per iteration.
+   *
+   * \param benchmark       The benchmark.
+   * \param iterationCount  The number of iterations to run.
+   * \return                The mean time taken per iteration (in nanoseconds).
+   */
+  static double time_iterations(const Benchmark& benchmark, size_t iterationCount)
+  {
+    typedef boost::chrono::steady_clock Clock;
+    Clock::time_point t0 = Clock::now();
+    for(size_t i = 0; i < iterationCount; ++i) benchmark();
+    Clock::time_point t1 = Clock::now();
+    return static_cast<double>(boost::chrono::duration_cast<boost::chrono::nanoseconds>(t1 - t0).count()) / iterationCount;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,181 @@
+/**
+ * benchmarks: SyntheticRGBDSequence.h
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#ifndef H_BENCHMARKS_SYNTHETICRGBDSEQUENCE
+#define H_BENCHMARKS_SYNTHETICRGBDSEQUENCE
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <ORUtils/SE3Pose.h>
+
+#include <orx/base/MemoryBlockFactory.h>
+
+namespace benchmarks {
+
+/**
+ * \brief An instance of this class represents a small, deterministic RGB-D sequence of a camera moving around inside a textured room.
+ *
+ * The sequence is rendered analytically when it is constructed, so that the benchmarks can replay realistic RGB-D frames
+ * without any data files needing to be shipped alongside them. The room is an axis-aligned box, each of whose walls is
+ * divided into cells of pseudo-random colour, so that the local appearance of the walls varies enough for relocalisation
+ * to be meaningful. Constructing two sequences with different phases yields interleaved camera poses along the same
+ * trajectory, which is useful for making disjoint training and test sets.
+ */
+class SyntheticRGBDSequence
+{
+  //#################### NESTED TYPES ####################
+public:
+  /**
+   * \brief An instance of this struct represents a single frame of the sequence.
+   */
+  struct Frame
+  {
+    /** The camera pose (as a transformation from world space to camera space). */
+    ORUtils::SE3Pose cameraPose;
+
+    /** The depth image (in metres). */
+    ORFloatImage_Ptr depthImage;
+
+    /** The colour image. */
+    ORUChar4Image_Ptr rgbImage;
+  };
+
+  //#################### PRIVATE VARIABLES ####################
+private:
+  /** The intrinsics of the (registered) depth and colour cameras. */
+  Vector4f m_depthIntrinsics;
+
+  /** The frames of the sequence. */
+  std::vector<Frame> m_frames;
+
+  //#################### CONSTRUCTORS ####################
+public:
+  /**
+   * \brief Renders a synthetic RGB-D sequence.
+   *
+   * \param frameCount  The number of frames in the sequence.
+   * \param phase       The offset (in frames) of the first camera pose along the trajectory.
+   * \param imageSize   The size of the images to render.
+   */
+  explicit SyntheticRGBDSequence(size_t frameCount, float phase = 0.0f, const Vector2i& imageSize = Vector2i(640, 480))
+  : m_depthIntrinsics(585.0f, 585.0f, imageSize.x / 2.0f, imageSize.y / 2.0f)
+  {
+    const orx::MemoryBlockFactory& mbf = orx::MemoryBlockFactory::instance();
+
+    m_frames.resize(frameCount);
+    for(size_t i = 0; i < frameCount; ++i)
+    {
+      // Move the camera around three quarters of a circle, wobbling it a little so that the views are not all coplanar.
+      const float theta = 1.5f * static_cast<float>(M_PI) * (i + phase) / frameCount;
+      Frame& frame = m_frames[i];
+      frame.cameraPose = ORUtils::SE3Pose(0.3f * cosf(3 * theta), 0.1f * sinf(2 * theta), 0.3f * sinf(3 * theta), 0.1f * sinf(theta), theta, 0.0f);
+      frame.depthImage = mbf.make_image<float>(imageSize);
+      frame.rgbImage = mbf.make_image<Vector4u>(imageSize);
+      render_frame(frame, m_depthIntrinsics);
+    }
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+public:
+  /**
+   * \brief Gets the intrinsics of the (registered) depth and colour cameras.
+   *
+   * \return  The intrinsics of the depth and colour cameras.
+   */
+  const Vector4f& get_depth_intrinsics() const
+  {
+    return m_depthIntrinsics;
+  }
+
+  /**
+   * \brief Gets the frames of the sequence.
+   *
+   * \return  The frames of the sequence.
+   */
+  const std::vector<Frame>& get_frames() const
+  {
+    return m_frames;
+  }
+
+  //#################### PRIVATE STATIC MEMBER FUNCTIONS ####################
+private:
+  /**
+   * \brief Computes a pseudo-random colour for the specified cell of the specified wall of the room.
+   *
+   * \param wall  The index of the wall.
+   * \param u     The first coordinate of the cell on the wall.
+   * \param v     The second coordinate of the cell on the wall.
+   * \return      The colour of the cell.
+   */
+  static Vector4u compute_cell_colour(int wall, int u, int v)
+  {
+    unsigned int h = static_cast<unsigned int>(wall) * 73856093u ^ static_cast<unsigned int>(u) * 19349663u ^ static_cast<unsigned int>(v) * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return Vector4u(static_cast<unsigned char>(h), static_cast<unsigned char>(h >> 8), static_cast<unsigned char>(h >> 16), 255);
+  }
+
+  /**
+   * \brief Renders the depth and colour images of a frame by ray casting the room from the frame's camera pose.
+   *
+   * \param frame           The frame.
+   * \param depthIntrinsics The intrinsics of the depth and colour cameras.
+   */
+  static void render_frame(Frame& frame, const Vector4f& depthIntrinsics)
+  {
+    const Vector3f roomMin(-2.5f, -1.5f, -2.5f), roomMax(2.5f, 1.5f, 2.5f);
+    const float cellsPerMetre = 5.0f;
+
+    const Matrix4f cameraToWorld = frame.cameraPose.GetInvM();
+    const Vector4f origin = cameraToWorld * Vector4f(0.0f, 0.0f, 0.0f, 1.0f);
+
+    const Vector2i& imgSize = frame.depthImage->noDims;
+    float *depths = frame.depthImage->GetData(MEMORYDEVICE_CPU);
+    Vector4u *colours = frame.rgbImage->GetData(MEMORYDEVICE_CPU);
+
+    for(int y = 0; y < imgSize.y; ++y)
+    {
+      for(int x = 0; x < imgSize.x; ++x)
+      {
+        // Compute the direction of the ray through the pixel (scaled so that its camera-space z component is 1, which
+        // means that the distance along the ray to the first intersection is equal to the depth of that intersection).
+        const Vector4f cameraDir((x - depthIntrinsics.z) / depthIntrinsics.x, (y - depthIntrinsics.w) / depthIntrinsics.y, 1.0f, 0.0f);
+        const Vector4f dir = cameraToWorld * cameraDir;
+
+        // Find the wall of the room that the ray hits first.
+        float t = std::numeric_limits<float>::max();
+        int hitAxis = 0, hitWall = 0;
+        for(int axis = 0; axis < 3; ++axis)
+        {
+          if(dir.v[axis] == 0.0f) continue;
+          const bool positive = dir.v[axis] > 0.0f;
+          const float axisT = ((positive ? roomMax.v[axis] : roomMin.v[axis]) - origin.v[axis]) / dir.v[axis];
+          if(axisT < t)
+          {
+            t = axisT;
+            hitAxis = axis;
+            hitWall = axis * 2 + (positive ? 1 : 0);
+          }
+        }
+
+        // Colour the pixel based on the cell of the wall that contains the intersection point.
+        const int uAxis = (hitAxis + 1) % 3, vAxis = (hitAxis + 2) % 3;
+        const int u = static_cast<int>(floorf((origin.v[uAxis] + t * dir.v[uAxis]) * cellsPerMetre));
+        const int v = static_cast<int>(floorf((origin.v[vAxis] + t * dir.v[vAxis]) * cellsPerMetre));
+
+        const int pixelIdx = y * imgSize.x + x;
+        depths[pixelIdx] = t;
+        colours[pixelIdx] = compute_cell_colour(hitWall, u, v);
+      }
+    }
+  }
+};
+
+}
+
+#endif
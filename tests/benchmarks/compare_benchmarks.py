@@ -0,0 +1,126 @@
+#! /usr/bin/env python3
+
+"""
+Compares two sets of benchmark results (as written by the benchmarks' --output option) and flags statistically
+significant changes.
+
+Each argument can be either a single JSON results file or a directory of them (as written by run_benchmarks.sh).
+A benchmark is flagged as having regressed (or improved) if a two-sided Mann-Whitney U test on its samples rejects
+the hypothesis that the two runs have the same distribution at the specified significance level, AND its median
+time has changed by more than the specified relative threshold (so that tiny but consistent changes are ignored).
+
+Exits with status 1 if any benchmark regressed, and 0 otherwise.
+"""
+
+import argparse
+import json
+import math
+import os
+import sys
+
+
+def load_results(path):
+    """Loads the benchmark results from a JSON file or a directory of JSON files into a map from name to samples."""
+    if os.path.isdir(path):
+        filenames = sorted(os.path.join(path, f) for f in os.listdir(path) if f.endswith(".json"))
+    else:
+        filenames = [path]
+
+    results = {}
+    for filename in filenames:
+        with open(filename) as f:
+            data = json.load(f)
+        for benchmark in data["benchmarks"]:
+            results[benchmark["name"]] = benchmark["samples"]
+    return results
+
+
+def median(values):
+    """Computes the median of a non-empty list of values."""
+    s = sorted(values)
+    n = len(s)
+    return s[n // 2] if n % 2 == 1 else (s[n // 2 - 1] + s[n // 2]) / 2.0
+
+
+def mann_whitney_u_test(xs, ys):
+    """
+    Performs a two-sided Mann-Whitney U test on two samples, using the normal approximation with tie and continuity
+    corrections (which is accurate enough for the sample sizes the benchmarks use), and returns the p-value.
+    """
+    n1, n2 = len(xs), len(ys)
+    combined = sorted([(x, 0) for x in xs] + [(y, 1) for y in ys])
+
+    # Assign ranks to the combined samples, averaging the ranks of tied values.
+    ranks = [0.0] * len(combined)
+    tie_term = 0.0
+    i = 0
+    while i < len(combined):
+        j = i
+        while j + 1 < len(combined) and combined[j + 1][0] == combined[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1.0
+        t = j - i + 1
+        tie_term += t ** 3 - t
+        i = j + 1
+
+    r1 = sum(rank for rank, (_, group) in zip(ranks, combined) if group == 0)
+    u1 = r1 - n1 * (n1 + 1) / 2.0
+    mean_u = n1 * n2 / 2.0
+    n = n1 + n2
+    var_u = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if var_u <= 0.0:
+        return 1.0
+
+    z = (abs(u1 - mean_u) - 0.5) / math.sqrt(var_u)
+    return math.erfc(max(z, 0.0) / math.sqrt(2.0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare two sets of benchmark results.")
+    parser.add_argument("baseline", help="the baseline results (a JSON file or a directory of them)")
+    parser.add_argument("candidate", help="the candidate results (a JSON file or a directory of them)")
+    parser.add_argument("--alpha", type=float, default=0.01, help="the significance level (default: 0.01)")
+    parser.add_argument("--threshold", type=float, default=0.05, help="the minimum relative change in the median to flag (default: 0.05)")
+    args = parser.parse_args()
+
+    baseline = load_results(args.baseline)
+    candidate = load_results(args.candidate)
+
+    regression_count = 0
+    print("%-50s %14s %14s %9s %10s  %s" % ("Benchmark", "Baseline (us)", "Candidate (us)", "Change", "p-value", "Verdict"))
+    for name in sorted(set(baseline) | set(candidate)):
+        if name not in baseline or name not in candidate:
+            print("%-50s %s" % (name, "only in baseline" if name in baseline else "only in candidate"))
+            continue
+
+        base_median = median(baseline[name])
+        cand_median = median(candidate[name])
+        p = mann_whitney_u_test(baseline[name], candidate[name])
+
+        # If the baseline median is zero (e.g. because the timings are below the clock resolution), the relative change is undefined,
+        # so we report it as n/a and don't flag the benchmark either way.
+        if base_median == 0:
+            print("%-50s %14.3f %14.3f %9s %10.2g  %s" % (name, base_median / 1000.0, cand_median / 1000.0, "n/a", p, ""))
+            continue
+
+        change = (cand_median - base_median) / base_median
+
+        verdict = ""
+        if p < args.alpha and abs(change) > args.threshold:
+            if change > 0:
+                verdict = "REGRESSION"
+                regression_count += 1
+            else:
+                verdict = "improvement"
+
+        print("%-50s %14.3f %14.3f %+8.1f%% %10.2g  %s" % (name, base_median / 1000.0, cand_median / 1000.0, change * 100.0, p, verdict))
+
+    if regression_count > 0:
+        print("\n%d benchmark(s) regressed" % regression_count)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
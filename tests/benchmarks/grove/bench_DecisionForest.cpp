@@ -0,0 +1,79 @@
+/**
+ * benchmarks/grove: bench_DecisionForest.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <grove/features/FeatureCalculatorFactory.h>
+#include <grove/forests/DecisionForestFactory.h>
+#include <grove/relocalisation/interface/ScoreForestRelocaliser.h>
+using namespace grove;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include <tvgutil/misc/SettingsContainer.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+//#################### TYPEDEFS ####################
+
+typedef DecisionForestFactory<ScoreForestRelocaliser::DescriptorType,ScoreForestRelocaliser::FOREST_TREE_COUNT> ForestFactory;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Finds the leaves into which each of the specified descriptors falls in each tree of a forest.
+ *
+ * \param forest        The forest.
+ * \param descriptors   The descriptors.
+ * \param leafIndices   The image into which to write the leaf indices.
+ */
+void find_leaves(const ForestFactory::Forest *forest, const RGBDPatchDescriptorImage_CPtr *descriptors, ForestFactory::Forest::LeafIndicesImage_Ptr *leafIndices)
+{
+  forest->find_leaves(*descriptors, *leafIndices);
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("grove", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+
+  // Compute realistic descriptors for a synthetic frame.
+  SyntheticRGBDSequence sequence(1);
+  const SyntheticRGBDSequence::Frame& frame = sequence.get_frames()[0];
+  DA_RGBDPatchFeatureCalculator_Ptr featureCalculator = FeatureCalculatorFactory::make_da_rgbd_patch_feature_calculator(ORUtils::DEVICE_CPU);
+  Keypoint3DColourImage_Ptr keypointsImage = mbf.make_image<Keypoint3DColour>();
+  RGBDPatchDescriptorImage_Ptr descriptorsImage = mbf.make_image<RGBDPatchDescriptor>();
+  featureCalculator->compute_keypoints_and_features(frame.rgbImage.get(), frame.depthImage.get(), sequence.get_depth_intrinsics(), keypointsImage.get(), descriptorsImage.get());
+  RGBDPatchDescriptorImage_CPtr descriptors = descriptorsImage;
+
+  // Pass the descriptors down randomly-generated forests of two different depths (the default forests are 15 levels deep).
+  const uint32_t treeDepths[] = { 10, 15 };
+  for(size_t i = 0; i < sizeof(treeDepths) / sizeof(treeDepths[0]); ++i)
+  {
+    SettingsContainer_Ptr settings(new SettingsContainer);
+    settings->add_value("DecisionForest.treeDepth", boost::lexical_cast<std::string>(treeDepths[i]));
+    ForestFactory::Forest_Ptr forest = ForestFactory::make_randomly_generated_forest(settings, ORUtils::DEVICE_CPU);
+
+    ForestFactory::Forest::LeafIndicesImage_Ptr leafIndices = mbf.make_image<ForestFactory::Forest::LeafIndices>();
+    suite.run(
+      "DecisionForest/find_leaves_depth" + boost::lexical_cast<std::string>(treeDepths[i]),
+      boost::bind(find_leaves, forest.get(), &descriptors, &leafIndices),
+      descriptors->dataSize
+    );
+  }
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+/**
+ * benchmarks/grove: bench_ExampleClusterer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <grove/clustering/ExampleClustererFactory.h>
+#include <grove/scoreforests/ScorePrediction.h>
+using namespace grove;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### TYPEDEFS ####################
+
+typedef ExampleClustererFactory<Keypoint3DColour,Keypoint3DColourCluster,ScorePrediction::Capacity> ClustererFactory;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Clusters the specified sets of examples.
+ *
+ * \param clusterer       The clusterer.
+ * \param exampleSets     The sets of examples (one per row).
+ * \param exampleSetSizes The number of valid examples in each set.
+ * \param predictions     The memory block into which to write the clusters for each set.
+ */
+void cluster_examples(ClustererFactory::Clusterer *clusterer, const Keypoint3DColourImage_CPtr *exampleSets,
+                      const ORIntMemoryBlock_CPtr *exampleSetSizes, ScorePredictionsMemoryBlock_Ptr *predictions)
+{
+  const uint32_t exampleSetCount = static_cast<uint32_t>((*exampleSets)->noDims.y);
+  clusterer->cluster_examples(*exampleSets, *exampleSetSizes, 0, exampleSetCount, *predictions);
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("grove", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+
+  // Use the same dimensions as the relocaliser does by default (256 reservoirs of capacity 1024 are clustered per frame).
+  const int exampleSetCount = 256, exampleSetCapacity = 1024;
+
+  // Fill each example set with examples drawn from a small number of tight Gaussian blobs (as the examples in a leaf's
+  // reservoir would be). Some sets are only partially full, as reservoirs would be early in a sequence.
+  RandomNumberGenerator rng(12345);
+  Keypoint3DColourImage_Ptr exampleSets = mbf.make_image<Keypoint3DColour>(Vector2i(exampleSetCapacity, exampleSetCount));
+  ORIntMemoryBlock_Ptr exampleSetSizes = mbf.make_block<int>(exampleSetCount);
+  Keypoint3DColour *examples = exampleSets->GetData(MEMORYDEVICE_CPU);
+  int *sizes = exampleSetSizes->GetData(MEMORYDEVICE_CPU);
+  for(int setIdx = 0; setIdx < exampleSetCount; ++setIdx)
+  {
+    const int blobCount = rng.generate_int_from_uniform(1, 5);
+    std::vector<Vector3f> blobCentres(blobCount);
+    for(int i = 0; i < blobCount; ++i)
+    {
+      blobCentres[i] = Vector3f(rng.generate_real_from_uniform(-2.0f, 2.0f), rng.generate_real_from_uniform(-2.0f, 2.0f), rng.generate_real_from_uniform(-2.0f, 2.0f));
+    }
+
+    sizes[setIdx] = rng.generate_int_from_uniform(exampleSetCapacity / 4, exampleSetCapacity);
+    for(int i = 0; i < exampleSetCapacity; ++i)
+    {
+      Keypoint3DColour& example = examples[setIdx * exampleSetCapacity + i];
+      const Vector3f& centre = blobCentres[rng.generate_int_from_uniform(0, blobCount - 1)];
+      example.position = centre + Vector3f(rng.generate_from_gaussian(0.0f, 0.02f), rng.generate_from_gaussian(0.0f, 0.02f), rng.generate_from_gaussian(0.0f, 0.02f));
+      example.colour = Vector3u(128, 128, 128);
+      example.valid = i < sizes[setIdx];
+    }
+  }
+
+  Keypoint3DColourImage_CPtr constExampleSets = exampleSets;
+  ORIntMemoryBlock_CPtr constExampleSetSizes = exampleSetSizes;
+  ScorePredictionsMemoryBlock_Ptr predictions = mbf.make_block<ScorePrediction>(exampleSetCount);
+
+  // Cluster the examples using the relocaliser's default clustering parameters.
+  ClustererFactory::Clusterer_Ptr clusterer = ClustererFactory::make_clusterer(0.1f, 0.05f, ScorePrediction::Capacity, 20, ORUtils::DEVICE_CPU);
+  suite.run(
+    "ExampleClusterer/cluster_examples",
+    boost::bind(cluster_examples, clusterer.get(), &constExampleSets, &constExampleSetSizes, &predictions),
+    exampleSetCount
+  );
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
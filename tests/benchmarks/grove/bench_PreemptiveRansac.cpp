@@ -0,0 +1,127 @@
+/**
+ * benchmarks/grove: bench_PreemptiveRansac.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <grove/ransac/PreemptiveRansacFactory.h>
+using namespace grove;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Estimates a camera pose from the specified keypoints and predictions.
+ *
+ * \param ransac      The preemptive RANSAC instance to use.
+ * \param keypoints   The keypoints.
+ * \param predictions The predictions.
+ */
+void estimate_pose(PreemptiveRansac *ransac, const Keypoint3DColourImage_CPtr *keypoints, const ScorePredictionsImage_CPtr *predictions)
+{
+  boost::optional<PoseCandidate> pose = ransac->estimate_pose(*keypoints, *predictions);
+  keep(pose);
+}
+
+/**
+ * \brief Makes a cluster (mode) with an isotropic covariance at the specified position.
+ *
+ * \param position  The position of the cluster.
+ * \param colour    The colour of the cluster.
+ * \param nbInliers The number of inliers in the cluster.
+ * \param sigma     The standard deviation of the cluster's position.
+ * \return          The cluster.
+ */
+Keypoint3DColourCluster make_cluster(const Vector3f& position, const Vector3u& colour, int nbInliers, float sigma)
+{
+  Keypoint3DColourCluster cluster;
+  cluster.colour = colour;
+  cluster.determinant = powf(sigma, 6.0f);
+  cluster.nbInliers = nbInliers;
+  cluster.position = position;
+  cluster.positionInvCovariance.setZeros();
+  cluster.positionInvCovariance.m[0] = cluster.positionInvCovariance.m[4] = cluster.positionInvCovariance.m[8] = 1.0f / (sigma * sigma);
+  return cluster;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("grove", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+
+  // Make a synthetic set of keypoints (in camera space) and predictions (in world space) that are consistent with a known
+  // camera pose. The keypoint grid has the size that the relocaliser produces for a 640x480 frame with a feature step of 4.
+  const Vector2i imgSize(160, 120);
+  const float inlierRatio = 0.5f;
+  const ORUtils::SE3Pose groundTruthPose(0.2f, -0.1f, 0.5f, 0.1f, 0.7f, -0.05f);
+  const Matrix4f cameraToWorld = groundTruthPose.GetInvM();
+
+  RandomNumberGenerator rng(12345);
+  Keypoint3DColourImage_Ptr keypointsImage = mbf.make_image<Keypoint3DColour>(imgSize);
+  ScorePredictionsImage_Ptr predictionsImage = mbf.make_image<ScorePrediction>(imgSize);
+  Keypoint3DColour *keypoints = keypointsImage->GetData(MEMORYDEVICE_CPU);
+  ScorePrediction *predictions = predictionsImage->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, pixelCount = imgSize.x * imgSize.y; i < pixelCount; ++i)
+  {
+    // Back-project the pixel to a random depth, and mark some of the keypoints as invalid (as for pixels with no depth).
+    const float depth = rng.generate_real_from_uniform(1.0f, 3.0f);
+    const int x = i % imgSize.x, y = i / imgSize.x;
+    Keypoint3DColour& keypoint = keypoints[i];
+    keypoint.position = Vector3f((x - imgSize.x / 2.0f) * depth / 146.0f, (y - imgSize.y / 2.0f) * depth / 146.0f, depth);
+    keypoint.colour = Vector3u(rng.generate_int_from_uniform(0, 255), rng.generate_int_from_uniform(0, 255), rng.generate_int_from_uniform(0, 255));
+    keypoint.valid = rng.generate_real_from_uniform(0.0f, 1.0f) < 0.9f;
+
+    // Make the prediction for the keypoint. Some predictions have a mode at the keypoint's true position in world space,
+    // and the rest of the modes are placed randomly.
+    ScorePrediction& prediction = predictions[i];
+    prediction.size = 0;
+    if(rng.generate_real_from_uniform(0.0f, 1.0f) < inlierRatio)
+    {
+      const Vector4f worldPos = cameraToWorld * Vector4f(keypoint.position, 1.0f);
+      const Vector3f noise(rng.generate_from_gaussian(0.0f, 0.01f), rng.generate_from_gaussian(0.0f, 0.01f), rng.generate_from_gaussian(0.0f, 0.01f));
+      prediction.elts[prediction.size++] = make_cluster(worldPos.toVector3() + noise, keypoint.colour, 100, 0.05f);
+    }
+
+    const int outlierCount = rng.generate_int_from_uniform(1, 4);
+    for(int j = 0; j < outlierCount; ++j)
+    {
+      const Vector3f position(rng.generate_real_from_uniform(-2.5f, 2.5f), rng.generate_real_from_uniform(-1.5f, 1.5f), rng.generate_real_from_uniform(-2.5f, 2.5f));
+      prediction.elts[prediction.size++] = make_cluster(position, keypoint.colour, rng.generate_int_from_uniform(10, 60), 0.05f);
+    }
+  }
+
+  Keypoint3DColourImage_CPtr constKeypointsImage = keypointsImage;
+  ScorePredictionsImage_CPtr constPredictionsImage = predictionsImage;
+
+  // Benchmark pose estimation both with and without the final (LM-based) pose optimisation step.
+  const bool poseUpdates[] = { true, false };
+  for(size_t i = 0; i < sizeof(poseUpdates) / sizeof(poseUpdates[0]); ++i)
+  {
+    SettingsContainer_Ptr settings(new SettingsContainer);
+    settings->add_value("PreemptiveRansac.poseUpdate", poseUpdates[i] ? "true" : "false");
+    PreemptiveRansac_Ptr ransac = PreemptiveRansacFactory::make_preemptive_ransac(settings, "PreemptiveRansac.", ORUtils::DEVICE_CPU);
+
+    suite.run(
+      std::string("PreemptiveRansac/estimate_pose") + (poseUpdates[i] ? "" : "_no_update"),
+      boost::bind(estimate_pose, ransac.get(), &constKeypointsImage, &constPredictionsImage)
+    );
+  }
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,81 @@
+/**
+ * benchmarks/grove: bench_RGBDPatchFeatureCalculator.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <grove/features/FeatureCalculatorFactory.h>
+using namespace grove;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Computes keypoints and features for a frame using the specified feature calculator.
+ *
+ * \param featureCalculator The feature calculator.
+ * \param frame             The frame.
+ * \param depthIntrinsics   The depth camera intrinsics.
+ * \param keypointsImage    The image into which to write the keypoints.
+ * \param descriptorsImage  The image into which to write the descriptors.
+ */
+template <typename KeypointType>
+void compute_features(const RGBDPatchFeatureCalculator<KeypointType,RGBDPatchDescriptor> *featureCalculator,
+                      const SyntheticRGBDSequence::Frame *frame, const Vector4f *depthIntrinsics,
+                      ORUtils::Image<KeypointType> *keypointsImage, RGBDPatchDescriptorImage *descriptorsImage)
+{
+  featureCalculator->compute_keypoints_and_features(frame->rgbImage.get(), frame->depthImage.get(), *depthIntrinsics, keypointsImage, descriptorsImage);
+}
+
+/**
+ * \brief Runs the feature calculation benchmark for the specified feature calculator.
+ *
+ * \param suite             The benchmark suite.
+ * \param name              The name of the benchmark.
+ * \param featureCalculator The feature calculator.
+ * \param sequence          The sequence whose first frame should be used.
+ */
+template <typename KeypointType>
+void run_benchmark(BenchmarkSuite& suite, const std::string& name,
+                   const boost::shared_ptr<RGBDPatchFeatureCalculator<KeypointType,RGBDPatchDescriptor> >& featureCalculator,
+                   const SyntheticRGBDSequence& sequence)
+{
+  const MemoryBlockFactory& mbf = MemoryBlockFactory::instance();
+  boost::shared_ptr<ORUtils::Image<KeypointType> > keypointsImage = mbf.make_image<KeypointType>();
+  RGBDPatchDescriptorImage_Ptr descriptorsImage = mbf.make_image<RGBDPatchDescriptor>();
+
+  // Compute the features once to size the output images, so that we know how many descriptors each iteration computes.
+  const SyntheticRGBDSequence::Frame& frame = sequence.get_frames()[0];
+  compute_features(featureCalculator.get(), &frame, &sequence.get_depth_intrinsics(), keypointsImage.get(), descriptorsImage.get());
+
+  suite.run(
+    name,
+    boost::bind(compute_features<KeypointType>, featureCalculator.get(), &frame, &sequence.get_depth_intrinsics(), keypointsImage.get(), descriptorsImage.get()),
+    descriptorsImage->dataSize
+  );
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("grove", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  SyntheticRGBDSequence sequence(1);
+  run_benchmark(suite, "RGBDPatchFeatureCalculator/da_rgbd", FeatureCalculatorFactory::make_da_rgbd_patch_feature_calculator(ORUtils::DEVICE_CPU), sequence);
+  run_benchmark(suite, "RGBDPatchFeatureCalculator/rgb", FeatureCalculatorFactory::make_rgb_patch_feature_calculator(ORUtils::DEVICE_CPU), sequence);
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,155 @@
+/**
+ * benchmarks/grove: bench_ScoreRelocaliser.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <grove/relocalisation/ScoreRelocaliserFactory.h>
+using namespace grove;
+
+#include <orx/base/MemoryBlockFactory.h>
+#include <orx/geometry/GeometryUtil.h>
+using namespace orx;
+
+#include <tvgutil/misc/SettingsContainer.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Makes a relocaliser that uses a randomly-generated forest (so that no pre-trained forest needs to be loaded).
+ *
+ * \param reuseBetweenQueries Whether or not the relocaliser should reuse predictions and P-RANSAC candidates between consecutive queries.
+ * \return                    The relocaliser.
+ */
+ScoreRelocaliser_Ptr make_relocaliser(bool reuseBetweenQueries = false)
+{
+  SettingsContainer_Ptr settings(new SettingsContainer);
+  settings->add_value("ScoreRelocaliser.randomlyGenerateForest", "true");
+  if(reuseBetweenQueries)
+  {
+    settings->add_value("ScoreRelocaliser.reusePredictions", "true");
+    settings->add_value("ScoreRelocaliser.PreemptiveRansac.maxWarmStartCandidates", "16");
+  }
+  return ScoreRelocaliserFactory::make_score_relocaliser("forest", "ScoreRelocaliser.", settings, ORUtils::DEVICE_CPU);
+}
+
+/**
+ * \brief Relocalises each frame of a sequence using the specified relocaliser, updating the relocaliser after each frame.
+ *
+ * \param relocaliser The relocaliser.
+ * \param sequence    The sequence.
+ * \return            The number of frames that were relocalised to within 5cm/5deg of their ground truth poses.
+ */
+size_t relocalise_sequence(ScoreRelocaliser *relocaliser, const SyntheticRGBDSequence *sequence)
+{
+  size_t correctFrameCount = 0;
+  const std::vector<SyntheticRGBDSequence::Frame>& frames = sequence->get_frames();
+  for(size_t i = 0, size = frames.size(); i < size; ++i)
+  {
+    const SyntheticRGBDSequence::Frame& frame = frames[i];
+    std::vector<Relocaliser::Result> results = relocaliser->relocalise(frame.rgbImage.get(), frame.depthImage.get(), sequence->get_depth_intrinsics());
+    if(!results.empty() && GeometryUtil::poses_are_similar(frame.cameraPose, results[0].pose, 5 * M_PI / 180, 0.05f))
+    {
+      ++correctFrameCount;
+    }
+
+    relocaliser->update();
+  }
+  return correctFrameCount;
+}
+
+/**
+ * \brief Relocalises each frame of a sequence twice in succession using the specified relocaliser (as happens when,
+ *        for example, the same viewpoint is re-rendered and re-queried).
+ *
+ * \param relocaliser The relocaliser.
+ * \param sequence    The sequence.
+ * \return            The number of repeated queries that were relocalised to within 5cm/5deg of their ground truth poses.
+ */
+size_t requery_sequence(ScoreRelocaliser *relocaliser, const SyntheticRGBDSequence *sequence)
+{
+  size_t correctFrameCount = 0;
+  const std::vector<SyntheticRGBDSequence::Frame>& frames = sequence->get_frames();
+  for(size_t i = 0, size = frames.size(); i < size; ++i)
+  {
+    const SyntheticRGBDSequence::Frame& frame = frames[i];
+    relocaliser->relocalise(frame.rgbImage.get(), frame.depthImage.get(), sequence->get_depth_intrinsics());
+    std::vector<Relocaliser::Result> results = relocaliser->relocalise(frame.rgbImage.get(), frame.depthImage.get(), sequence->get_depth_intrinsics());
+    if(!results.empty() && GeometryUtil::poses_are_similar(frame.cameraPose, results[0].pose, 5 * M_PI / 180, 0.05f))
+    {
+      ++correctFrameCount;
+    }
+  }
+  return correctFrameCount;
+}
+
+/**
+ * \brief Trains a new relocaliser on each frame of a sequence.
+ *
+ * \param sequence  The sequence.
+ */
+void train_sequence(const SyntheticRGBDSequence *sequence)
+{
+  ScoreRelocaliser_Ptr relocaliser = make_relocaliser();
+  const std::vector<SyntheticRGBDSequence::Frame>& frames = sequence->get_frames();
+  for(size_t i = 0, size = frames.size(); i < size; ++i)
+  {
+    const SyntheticRGBDSequence::Frame& frame = frames[i];
+    relocaliser->train(frame.rgbImage.get(), frame.depthImage.get(), sequence->get_depth_intrinsics(), frame.cameraPose);
+  }
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("grove", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  // Render a training sequence and a test sequence whose poses are interleaved with those of the training sequence.
+  const size_t trainingFrameCount = 60, testFrameCount = 20;
+  SyntheticRGBDSequence trainingSequence(trainingFrameCount);
+  SyntheticRGBDSequence testSequence(testFrameCount, 0.5f);
+
+  // Benchmark training a relocaliser from scratch on the training sequence (this includes making the relocaliser).
+  const size_t macroSampleCount = 5;
+  suite.run("ScoreRelocaliser/train_sequence", boost::bind(train_sequence, &trainingSequence), trainingFrameCount, macroSampleCount);
+
+  // Train a relocaliser on the training sequence and make sure that all of its clusters are up to date.
+  ScoreRelocaliser_Ptr relocaliser = make_relocaliser();
+  const std::vector<SyntheticRGBDSequence::Frame>& trainingFrames = trainingSequence.get_frames();
+  for(size_t i = 0; i < trainingFrameCount; ++i)
+  {
+    const SyntheticRGBDSequence::Frame& frame = trainingFrames[i];
+    relocaliser->train(frame.rgbImage.get(), frame.depthImage.get(), trainingSequence.get_depth_intrinsics(), frame.cameraPose);
+  }
+  relocaliser->update_all_clusters();
+
+  // Report the relocalisation accuracy as a sanity check (a large change in this indicates a behavioural change rather than a performance one).
+  const size_t correctFrameCount = relocalise_sequence(relocaliser.get(), &testSequence);
+  std::cout << "Relocalised " << correctFrameCount << '/' << testFrameCount << " test frames correctly\n";
+
+  // Benchmark relocalising each frame of the test sequence.
+  suite.run("ScoreRelocaliser/relocalise_sequence", boost::bind(relocalise_sequence, relocaliser.get(), &testSequence), testFrameCount, macroSampleCount);
+
+  // Make a second relocaliser that shares the first one's state, but reuses predictions and P-RANSAC candidates between
+  // consecutive queries, and compare the two on repeated queries of the same frames (both in terms of accuracy and speed).
+  ScoreRelocaliser_Ptr reusingRelocaliser = make_relocaliser(true);
+  reusingRelocaliser->set_backing_relocaliser(relocaliser);
+  std::cout << "Relocalised " << requery_sequence(relocaliser.get(), &testSequence) << '/' << testFrameCount << " repeated test queries correctly\n";
+  std::cout << "Relocalised " << requery_sequence(reusingRelocaliser.get(), &testSequence) << '/' << testFrameCount << " repeated test queries correctly with reuse\n";
+  suite.run("ScoreRelocaliser/requery_sequence", boost::bind(requery_sequence, relocaliser.get(), &testSequence), testFrameCount * 2, macroSampleCount);
+  suite.run("ScoreRelocaliser/requery_sequence_reuse", boost::bind(requery_sequence, reusingRelocaliser.get(), &testSequence), testFrameCount * 2, macroSampleCount);
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,212 @@
+/**
+ * benchmarks/itmx: bench_AsyncImageSource.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+
+#include <itmx/imagesources/AsyncImageSourceEngine.h>
+using namespace InputSource;
+using namespace itmx;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### CONSTANTS ####################
+
+/** The number of frames in the simulated sequence. */
+const size_t FRAME_COUNT = 60;
+
+/** The time (in milliseconds) spent processing each frame once it has been obtained (e.g. tracking and fusing it). */
+const int PROCESSING_MS = 15;
+
+/** The capacity of the asynchronous image source's queue. */
+const size_t QUEUE_CAPACITY = 8;
+
+/** The time (in milliseconds) that the simulated disk sequence takes to read and decode each frame. */
+const int READ_MS = 8;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this class simulates a disk sequence that takes a fixed time to read and decode each frame.
+ *
+ * The pixels of each frame are set to the index of the frame, so that the frames received can be checked.
+ */
+class SimulatedDiskSequence : public ImageSourceEngine
+{
+public:
+  /** The index of the next frame to read. */
+  size_t m_frameIndex;
+
+  /** The size of the images in the sequence. */
+  Vector2i m_imageSize;
+
+public:
+  explicit SimulatedDiskSequence(const Vector2i& imageSize)
+  : m_frameIndex(0), m_imageSize(imageSize)
+  {}
+
+public:
+  virtual ITMLib::ITMRGBDCalib getCalib() const
+  {
+    ITMLib::ITMRGBDCalib calib;
+    calib.intrinsics_rgb.imgSize = calib.intrinsics_d.imgSize = m_imageSize;
+    return calib;
+  }
+
+  virtual Vector2i getDepthImageSize() const { return m_imageSize; }
+
+  virtual void getImages(ORUChar4Image *rgb, ORShortImage *rawDepth)
+  {
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(READ_MS));
+
+    const unsigned char value = static_cast<unsigned char>(m_frameIndex);
+    std::fill(rgb->GetData(MEMORYDEVICE_CPU), rgb->GetData(MEMORYDEVICE_CPU) + rgb->dataSize, Vector4u(value, value, value, 255));
+    std::fill(rawDepth->GetData(MEMORYDEVICE_CPU), rawDepth->GetData(MEMORYDEVICE_CPU) + rawDepth->dataSize, static_cast<short>(m_frameIndex));
+    ++m_frameIndex;
+  }
+
+  virtual Vector2i getRGBImageSize() const { return m_imageSize; }
+
+  virtual bool hasMoreImages() const { return m_frameIndex < FRAME_COUNT; }
+};
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark a consumer reading a disk sequence via an asynchronous image source.
+ *
+ * The consumer either copies each frame into its own input images (as getImages does), or borrows each frame from the image source
+ * and holds on to it until it has finished processing it (as SLAMComponent does when its image source is asynchronous).
+ */
+struct AsyncImageSourceBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** Whether or not the consumer borrows the frames rather than copying them. */
+  bool borrow;
+
+  /** The size of the images in the sequence. */
+  Vector2i imageSize;
+
+  /** The consumer's own depth input image (used when copying). */
+  ORShortImage_Ptr inputRawDepthImage;
+
+  /** The consumer's own RGB input image (used when copying). */
+  ORUChar4Image_Ptr inputRGBImage;
+
+  /** The time (in milliseconds) the consumer spent obtaining each frame during the most recent iteration. */
+  std::vector<double> latenciesMs;
+
+  //#################### CONSTRUCTORS ####################
+
+  AsyncImageSourceBenchmark(const Vector2i& imageSize_, bool borrow_)
+  : borrow(borrow_),
+    imageSize(imageSize_),
+    inputRawDepthImage(new ORShortImage(imageSize_, true, false)),
+    inputRGBImage(new ORUChar4Image(imageSize_, true, false))
+  {}
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  void run()
+  {
+    // Only keep the latencies from the most recent iteration.
+    latenciesMs.clear();
+
+    AsyncImageSourceEngine imageSource(new SimulatedDiskSequence(imageSize), QUEUE_CAPACITY);
+    AsyncImageSourceEngine::RGBDImage_CPtr borrowedImages;
+
+    typedef boost::chrono::steady_clock Clock;
+    for(size_t frameIndex = 0; frameIndex < FRAME_COUNT; ++frameIndex)
+    {
+      // Obtain the next frame, and measure how long it takes for it to become available to the consumer.
+      Clock::time_point t0 = Clock::now();
+      if(!imageSource.hasMoreImages()) throw std::runtime_error("Error: The image source ran out of images");
+
+      const ORUChar4Image *rgb = NULL;
+      if(borrow)
+      {
+        // Note: This releases the previously borrowed frame, which the consumer has now finished processing.
+        borrowedImages = imageSource.borrow_images();
+        rgb = borrowedImages->rgb.get();
+      }
+      else
+      {
+        imageSource.getImages(inputRGBImage.get(), inputRawDepthImage.get());
+        rgb = inputRGBImage.get();
+      }
+
+      Clock::time_point t1 = Clock::now();
+      latenciesMs.push_back(boost::chrono::duration<double,boost::milli>(t1 - t0).count());
+
+      // Check that the consumer received the right frame, and then simulate processing it.
+      if(rgb->GetData(MEMORYDEVICE_CPU)[rgb->dataSize - 1].r != static_cast<unsigned char>(frameIndex))
+      {
+        throw std::runtime_error("Error: The consumer received the wrong frame");
+      }
+
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(PROCESSING_MS));
+    }
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Runs the benchmark for a particular image size and handoff method, and outputs the mean latency of obtaining a frame.
+ *
+ * \param suite     The benchmark suite.
+ * \param imageSize The size of the images in the sequence.
+ * \param borrow    Whether or not the consumer borrows the frames rather than copying them.
+ * \return          The mean time (in milliseconds) the consumer spent obtaining each frame.
+ */
+double run_benchmark(BenchmarkSuite& suite, const Vector2i& imageSize, bool borrow)
+{
+  const std::string name = (boost::format("%dx%d_%s") % imageSize.x % imageSize.y % (borrow ? "borrow" : "copy")).str();
+  AsyncImageSourceBenchmark benchmark(imageSize, borrow);
+
+  const size_t sampleCount = 3;
+  suite.run("AsyncImageSource/" + name, boost::bind(&AsyncImageSourceBenchmark::run, &benchmark), FRAME_COUNT, sampleCount);
+
+  const std::vector<double>& latencies = benchmark.latenciesMs;
+  double meanLatency = 0.0;
+  for(size_t i = 0, size = latencies.size(); i < size; ++i) meanLatency += latencies[i];
+  meanLatency /= latencies.size();
+
+  std::cout << boost::format("  (%s: mean latency to obtain a frame %.3fms)\n") % name % meanLatency;
+  return meanLatency;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("itmx", argc, argv);
+
+  const Vector2i imageSizes[] = { Vector2i(640, 480), Vector2i(1280, 720) };
+  for(size_t i = 0; i < sizeof(imageSizes) / sizeof(Vector2i); ++i)
+  {
+    const Vector2i& imageSize = imageSizes[i];
+    const double copyLatency = run_benchmark(suite, imageSize, false);
+    const double borrowLatency = run_benchmark(suite, imageSize, true);
+
+    // Output the amount of copying that borrowing the frames avoids (an RGB pixel takes 4 bytes and a depth pixel takes 2 bytes).
+    const double mbPerFrame = imageSize.x * imageSize.y * (sizeof(Vector4u) + sizeof(short)) / (1024.0 * 1024.0);
+    std::cout << boost::format("  (%dx%d: borrowing avoids copying %.2f MB per frame, i.e. %.1f MB/s at 30Hz, and saves %.3fms per frame)\n")
+                 % imageSize.x % imageSize.y % mbPerFrame % (mbPerFrame * 30) % (copyLatency - borrowLatency);
+  }
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,186 @@
+/**
+ * benchmarks/itmx: bench_CompositeTracking.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/format.hpp>
+#include <boost/thread.hpp>
+
+#include <ITMLib/Trackers/Interface/ITMCompositeTracker.h>
+using namespace ITMLib;
+
+#include <itmx/trackers/ConcurrentCompositeTracker.h>
+using namespace itmx;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### CONSTANTS ####################
+
+/** The number of frames in the simulated sequence. */
+const size_t FRAME_COUNT = 60;
+
+/** The size of the simulated images. */
+const Vector2i IMAGE_SIZE(640, 480);
+
+/** The number of consecutive frames in each burst of tracking loss. */
+const size_t LOSS_BURST_LENGTH = 4;
+
+/** The number of frames between the starts of successive bursts of tracking loss. */
+const size_t LOSS_PERIOD = 10;
+
+/** The time (in milliseconds) spent on mapping and rendering between successive calls to the tracker. */
+const int MAPPING_MS = 10;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this class simulates a tracker that takes a fixed time per frame and fails on some frames of the sequence.
+ */
+class SimulatedTracker : public ITMTracker
+{
+public:
+  /** The time (in milliseconds) that the tracker takes to track a frame. */
+  int m_latencyMs;
+
+  /** The offset (within a burst of tracking loss) of the first frame that the tracker can track again. */
+  size_t m_recoveryOffset;
+
+public:
+  SimulatedTracker(int latencyMs, size_t recoveryOffset)
+  : m_latencyMs(latencyMs), m_recoveryOffset(recoveryOffset)
+  {}
+
+public:
+  virtual bool requiresColourRendering() const { return false; }
+  virtual bool requiresDepthReliability() const { return false; }
+  virtual bool requiresPointCloudRendering() const { return true; }
+
+  virtual void TrackCamera(ITMTrackingState *trackingState, const ITMView *view)
+  {
+    // Note: The benchmark passes the index of the frame being tracked to the trackers via the x coordinate of the initial camera translation.
+    const size_t frameIndex = static_cast<size_t>(trackingState->pose_d->GetT().x);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(m_latencyMs));
+
+    const size_t offset = frameIndex % LOSS_PERIOD;
+    const bool lost = offset < LOSS_BURST_LENGTH && offset < m_recoveryOffset;
+    trackingState->trackerResult = lost ? ITMTrackingState::TRACKING_FAILED : ITMTrackingState::TRACKING_GOOD;
+  }
+};
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark a composite tracker on a sequence with frequent tracking loss.
+ *
+ * The composite contains (in priority order) a depth tracker that fails throughout each burst of tracking loss, a slower colour
+ * tracker that recovers halfway through each burst, and a fast but coarse fallback tracker that never fails.
+ */
+struct CompositeTrackingBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The time (in milliseconds) taken by each call to the composite tracker during the most recent iteration. */
+  std::vector<double> latenciesMs;
+
+  /** The composite tracker. */
+  Tracker_Ptr tracker;
+
+  /** The tracking state. */
+  ITMTrackingState trackingState;
+
+  /** The view. */
+  ITMView view;
+
+  //#################### CONSTRUCTORS ####################
+
+  explicit CompositeTrackingBenchmark(bool concurrent)
+  : trackingState(IMAGE_SIZE, MEMORYDEVICE_CPU), view(ITMRGBDCalib(), IMAGE_SIZE, IMAGE_SIZE, false)
+  {
+    ITMTracker *depthTracker = new SimulatedTracker(12, LOSS_BURST_LENGTH);
+    ITMTracker *colourTracker = new SimulatedTracker(18, LOSS_BURST_LENGTH / 2);
+    ITMTracker *fallbackTracker = new SimulatedTracker(6, 0);
+
+    if(concurrent)
+    {
+      ConcurrentCompositeTracker *compositeTracker = new ConcurrentCompositeTracker(MEMORYDEVICE_CPU);
+      compositeTracker->add_tracker(Tracker_Ptr(depthTracker));
+      compositeTracker->add_tracker(Tracker_Ptr(colourTracker));
+      compositeTracker->add_tracker(Tracker_Ptr(fallbackTracker));
+      tracker.reset(compositeTracker);
+    }
+    else
+    {
+      ITMCompositeTracker *compositeTracker = new ITMCompositeTracker(ITMCompositeTracker::POLICY_STOP_ON_FIRST_SUCCESS);
+      compositeTracker->AddTracker(depthTracker);
+      compositeTracker->AddTracker(colourTracker);
+      compositeTracker->AddTracker(fallbackTracker);
+      tracker.reset(compositeTracker);
+    }
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  void run()
+  {
+    // Only keep the latencies from the most recent iteration (this excludes the one-off costs of the first iteration).
+    latenciesMs.clear();
+
+    typedef boost::chrono::steady_clock Clock;
+    for(size_t frameIndex = 0; frameIndex < FRAME_COUNT; ++frameIndex)
+    {
+      trackingState.pose_d->SetT(Vector3f(static_cast<float>(frameIndex), 0.0f, 0.0f));
+
+      Clock::time_point t0 = Clock::now();
+      tracker->TrackCamera(&trackingState, &view);
+      Clock::time_point t1 = Clock::now();
+      latenciesMs.push_back(boost::chrono::duration<double,boost::milli>(t1 - t0).count());
+
+      // Simulate mapping and rendering the frame before tracking the next one.
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(MAPPING_MS));
+    }
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Runs the benchmark for a composite tracker, and outputs the mean and worst-case tracking latencies.
+ *
+ * \param suite       The benchmark suite.
+ * \param concurrent  Whether or not to run the nested trackers concurrently.
+ */
+void run_benchmark(BenchmarkSuite& suite, bool concurrent)
+{
+  const std::string name = concurrent ? "concurrent" : "stoponfirstsuccess";
+  CompositeTrackingBenchmark benchmark(concurrent);
+
+  const size_t sampleCount = 3;
+  suite.run("CompositeTracking/frequent_loss_" + name, boost::bind(&CompositeTrackingBenchmark::run, &benchmark), FRAME_COUNT, sampleCount);
+
+  const std::vector<double>& latencies = benchmark.latenciesMs;
+  double meanLatency = 0.0;
+  for(size_t i = 0, size = latencies.size(); i < size; ++i) meanLatency += latencies[i];
+  meanLatency /= latencies.size();
+  const double worstLatency = *std::max_element(latencies.begin(), latencies.end());
+
+  std::cout << boost::format("  (%s: mean tracking latency %.1fms, worst case %.1fms)\n") % name % meanLatency % worstLatency;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("itmx", argc, argv);
+  run_benchmark(suite, false);
+  run_benchmark(suite, true);
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+/**
+ * benchmarks/itmx: bench_RGBDFrameCompressor.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <itmx/remotemapping/RGBDFrameCompressor.h>
+using namespace itmx;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark compressing and uncompressing a frame with a particular pair of compression types.
+ */
+struct CompressorBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The compressed frame. */
+  boost::shared_ptr<CompressedRGBDFrameMessage> compressedFrame;
+
+  /** The compressed frame header. */
+  CompressedRGBDFrameHeaderMessage compressedHeader;
+
+  /** The compressor. */
+  RGBDFrameCompressor_Ptr compressor;
+
+  /** The frame to compress. */
+  RGBDFrameMessage_Ptr frame;
+
+  /** The message into which to uncompress the frame. */
+  RGBDFrameMessage_Ptr uncompressedFrame;
+
+  //#################### CONSTRUCTORS ####################
+
+  CompressorBenchmark(const RGBDFrameMessage_Ptr& frame_, RGBCompressionType rgbCompressionType, DepthCompressionType depthCompressionType)
+  : frame(frame_)
+  {
+    const Vector2i& rgbImageSize = frame->get_rgb_image_size();
+    const Vector2i& depthImageSize = frame->get_depth_image_size();
+    compressor.reset(new RGBDFrameCompressor(rgbImageSize, depthImageSize, rgbCompressionType, depthCompressionType));
+    compressedFrame.reset(new CompressedRGBDFrameMessage(compressedHeader));
+    uncompressedFrame = RGBDFrameMessage::make(rgbImageSize, depthImageSize);
+
+    // Compress the frame once, so that the uncompression benchmark has something to uncompress.
+    compress();
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  void compress()
+  {
+    compressor->compress_rgbd_frame(*frame, compressedHeader, *compressedFrame);
+  }
+
+  void uncompress()
+  {
+    compressor->uncompress_rgbd_frame(*compressedFrame, *uncompressedFrame);
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Runs the compression and uncompression benchmarks for the specified pair of compression types.
+ *
+ * \param suite                 The benchmark suite.
+ * \param frame                 The frame to compress.
+ * \param name                  The name to use for the pair of compression types.
+ * \param rgbCompressionType    The type of compression to use for the colour image.
+ * \param depthCompressionType  The type of compression to use for the depth image.
+ */
+void run_benchmarks(BenchmarkSuite& suite, const RGBDFrameMessage_Ptr& frame, const std::string& name,
+                    RGBCompressionType rgbCompressionType, DepthCompressionType depthCompressionType)
+{
+  CompressorBenchmark benchmark(frame, rgbCompressionType, depthCompressionType);
+  suite.run("RGBDFrameCompressor/compress_" + name, boost::bind(&CompressorBenchmark::compress, &benchmark));
+  suite.run("RGBDFrameCompressor/uncompress_" + name, boost::bind(&CompressorBenchmark::uncompress, &benchmark));
+
+  std::cout << boost::format("  (%s: %d RGB bytes, %d depth bytes)\n")
+               % name % benchmark.compressedHeader.extract_rgb_image_byte_size() % benchmark.compressedHeader.extract_depth_image_byte_size();
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("itmx", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  // Render a synthetic frame and convert its depth image to millimetres (the format in which depth is sent to the server).
+  SyntheticRGBDSequence sequence(1);
+  const SyntheticRGBDSequence::Frame& syntheticFrame = sequence.get_frames()[0];
+  const Vector2i& imageSize = syntheticFrame.depthImage->noDims;
+
+  ORShortImage_Ptr depthImage = MemoryBlockFactory::instance().make_image<short>(imageSize);
+  const float *depthsInMetres = syntheticFrame.depthImage->GetData(MEMORYDEVICE_CPU);
+  short *depthsInMillimetres = depthImage->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, pixelCount = imageSize.x * imageSize.y; i < pixelCount; ++i)
+  {
+    depthsInMillimetres[i] = static_cast<short>(depthsInMetres[i] * 1000.0f + 0.5f);
+  }
+
+  RGBDFrameMessage_Ptr frame = RGBDFrameMessage::make(imageSize, imageSize);
+  frame->set_frame_index(0);
+  frame->set_pose(syntheticFrame.cameraPose);
+  frame->set_rgb_image(syntheticFrame.rgbImage);
+  frame->set_depth_image(depthImage);
+
+  run_benchmarks(suite, frame, "none_none", RGB_COMPRESSION_NONE, DEPTH_COMPRESSION_NONE);
+#ifdef WITH_OPENCV
+  run_benchmarks(suite, frame, "jpg_png", RGB_COMPRESSION_JPG, DEPTH_COMPRESSION_PNG);
+  run_benchmarks(suite, frame, "png_png", RGB_COMPRESSION_PNG, DEPTH_COMPRESSION_PNG);
+#endif
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
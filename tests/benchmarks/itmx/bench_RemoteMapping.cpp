@@ -0,0 +1,197 @@
+/**
+ * benchmarks/itmx: bench_RemoteMapping.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <itmx/remotemapping/MappingClient.h>
+#include <itmx/remotemapping/MappingServer.h>
+using namespace itmx;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+//#################### CONSTANTS ####################
+
+/** The interval (in milliseconds) between successive frames from the client's camera. */
+const int CAMERA_FRAME_MS = 33;
+
+/** The port on which the local mapping server listens. */
+const int PORT = 7852;
+
+/** The time (in milliseconds) that the throttled server spends processing each frame. */
+const int SERVER_FRAME_MS = 66;
+
+/** The number of frames the server processes in each iteration of a benchmark. */
+const size_t USEFUL_FRAME_COUNT = 20;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark sending frames from a mapping client to a throttled local mapping server.
+ *
+ * The client's camera produces frames at 30Hz, but the server can only process them at 15Hz, as would happen if its SLAM were
+ * falling behind. Each iteration of the benchmark pushes frames onto the client's queue in real time until the server has
+ * processed a fixed number of them. The frames the server processes are the useful ones; all others are dropped, either by
+ * the client (before being compressed) or by the server (after having been compressed, transmitted and uncompressed).
+ */
+struct RemoteMappingBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The mapping client. */
+  MappingClient_Ptr client;
+
+  /** The ID used by the server to refer to the client (the server assigns 0 to its first client). */
+  int clientID;
+
+  /** The frame that the client's camera repeatedly produces. */
+  RGBDFrameMessage_Ptr frame;
+
+  /** The mapping server. */
+  MappingServer_Ptr server;
+
+  /** Whether or not the server has processed all of the frames it should process in the current iteration. */
+  boost::atomic<bool> serverFinished;
+
+  /** The total number of frames the server has processed. */
+  size_t usefulFrameCount;
+
+  //#################### CONSTRUCTORS ####################
+
+  RemoteMappingBenchmark(const MappingServer_Ptr& server_, const RGBDFrameMessage_Ptr& frame_, const RGBDCalibrationMessage& calibMsg)
+  : clientID(0), frame(frame_), server(server_), serverFinished(false), usefulFrameCount(0)
+  {
+    client.reset(new MappingClient("localhost", boost::lexical_cast<std::string>(PORT)));
+    client->send_calibration_message(calibMsg);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  void process_frames_on_server()
+  {
+    ORUChar4Image rgbImage(frame->get_rgb_image_size(), true, false);
+    ORShortImage depthImage(frame->get_depth_image_size(), true, false);
+
+    for(size_t i = 0; i < USEFUL_FRAME_COUNT; ++i)
+    {
+      // Get the next frame from the client (this will block until one is available), and then simulate processing it.
+      server->get_images(clientID, &rgbImage, &depthImage);
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(SERVER_FRAME_MS));
+      ++usefulFrameCount;
+    }
+
+    serverFinished = true;
+  }
+
+  void run()
+  {
+    serverFinished = false;
+    boost::thread serverThread(&RemoteMappingBenchmark::process_frames_on_server, this);
+
+    // Push frames onto the client's queue at the camera's frame rate until the server has processed enough of them.
+    while(!serverFinished)
+    {
+      {
+        MappingClient::RGBDFrameMessageQueue::PushHandler_Ptr pushHandler = client->begin_push_frame_message();
+        boost::optional<RGBDFrameMessage_Ptr&> elt = pushHandler->get();
+        if(elt) **elt = *frame;
+      }
+
+      boost::this_thread::sleep_for(boost::chrono::milliseconds(CAMERA_FRAME_MS));
+    }
+
+    serverThread.join();
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Runs the benchmark for sending frames to a throttled local server, either with or without rate control.
+ *
+ * \param suite               The benchmark suite.
+ * \param benchmark           The benchmark state.
+ * \param rateControlEnabled  Whether or not the client should use rate control.
+ */
+void run_benchmark(BenchmarkSuite& suite, RemoteMappingBenchmark& benchmark, bool rateControlEnabled)
+{
+  const std::string name = rateControlEnabled ? "rate_control" : "no_rate_control";
+  benchmark.client->set_rate_control_enabled(rateControlEnabled);
+
+  const MappingClient::Statistics statsBefore = benchmark.client->get_statistics();
+  const size_t usefulFrameCountBefore = benchmark.usefulFrameCount;
+
+  const size_t sampleCount = 3;
+  suite.run("RemoteMapping/throttled_server_" + name, boost::bind(&RemoteMappingBenchmark::run, &benchmark), USEFUL_FRAME_COUNT, sampleCount);
+
+  const MappingClient::Statistics statsAfter = benchmark.client->get_statistics();
+  const double kbPerUsefulFrame = (statsAfter.bytesSent - statsBefore.bytesSent) / 1024.0 / (benchmark.usefulFrameCount - usefulFrameCountBefore);
+  std::cout << boost::format("  (%s: %.1f KB on the wire per useful frame, %d frames sent, %d skipped by the client, %d dropped by the server)\n")
+               % name % kbPerUsefulFrame
+               % (statsAfter.framesSent - statsBefore.framesSent)
+               % (statsAfter.framesSkipped - statsBefore.framesSkipped)
+               % (statsAfter.framesDroppedByServer - statsBefore.framesDroppedByServer);
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("itmx", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  // Render a synthetic frame and convert its depth image to millimetres (the format in which depth is sent to the server).
+  SyntheticRGBDSequence sequence(1);
+  const SyntheticRGBDSequence::Frame& syntheticFrame = sequence.get_frames()[0];
+  const Vector2i& imageSize = syntheticFrame.depthImage->noDims;
+
+  ORShortImage_Ptr depthImage = MemoryBlockFactory::instance().make_image<short>(imageSize);
+  const float *depthsInMetres = syntheticFrame.depthImage->GetData(MEMORYDEVICE_CPU);
+  short *depthsInMillimetres = depthImage->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, pixelCount = imageSize.x * imageSize.y; i < pixelCount; ++i)
+  {
+    depthsInMillimetres[i] = static_cast<short>(depthsInMetres[i] * 1000.0f + 0.5f);
+  }
+
+  RGBDFrameMessage_Ptr frame = RGBDFrameMessage::make(imageSize, imageSize);
+  frame->set_frame_index(0);
+  frame->set_pose(syntheticFrame.cameraPose);
+  frame->set_rgb_image(syntheticFrame.rgbImage);
+  frame->set_depth_image(depthImage);
+
+  // Make the calibration message that the client will send to the server.
+  ITMLib::ITMRGBDCalib calib;
+  calib.intrinsics_rgb.imgSize = calib.intrinsics_d.imgSize = imageSize;
+
+  RGBDCalibrationMessage calibMsg;
+  calibMsg.set_calib(calib);
+#ifdef WITH_OPENCV
+  calibMsg.set_depth_compression_type(DEPTH_COMPRESSION_PNG);
+  calibMsg.set_rgb_compression_type(RGB_COMPRESSION_JPG);
+#else
+  calibMsg.set_depth_compression_type(DEPTH_COMPRESSION_NONE);
+  calibMsg.set_rgb_compression_type(RGB_COMPRESSION_NONE);
+#endif
+
+  // Start a local mapping server, connect a client to it, and run the benchmark both without and with rate control.
+  MappingServer_Ptr server(new MappingServer(MappingServer::SM_SINGLE_CLIENT, PORT));
+  server->start();
+
+  RemoteMappingBenchmark benchmark(server, frame, calibMsg);
+  run_benchmark(suite, benchmark, false);
+  run_benchmark(suite, benchmark, true);
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
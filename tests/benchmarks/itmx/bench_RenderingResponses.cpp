@@ -0,0 +1,220 @@
+/**
+ * benchmarks/itmx: bench_RenderingResponses.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include <iostream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <itmx/remotemapping/MappingClient.h>
+#include <itmx/remotemapping/MappingServer.h>
+using namespace itmx;
+using namespace tvgutil;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+//#################### CONSTANTS ####################
+
+/** The size (in pixels) of the square region that changes between successive images in the "small change" scenario. */
+const int CHANGED_REGION_SIZE = 24;
+
+/** The port on which the local mapping server listens. */
+const int PORT = 7853;
+
+/** The number of rendering responses the client retrieves in each iteration of a benchmark. */
+const size_t RESPONSE_COUNT = 30;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark a mapping client retrieving server-rendered images from a local mapping server.
+ *
+ * Each iteration of the benchmark cycles through a fixed list of images. Before each retrieval, the next image in the list is
+ * written into the server's rendered image for the client (as the server's renderer would), and the client then retrieves it.
+ */
+struct RenderingResponseBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The number of bytes of rendering responses the client received during the most recent iteration. */
+  uint64_t bytesReceived;
+
+  /** The mapping client. */
+  MappingClient_Ptr client;
+
+  /** The ID used by the server to refer to the client (the server assigns 0 to its first client). */
+  int clientID;
+
+  /** The images the server renders for the client (in order). */
+  std::vector<ORUChar4Image_Ptr> images;
+
+  /** The time (in milliseconds) taken by each retrieval during the most recent iteration. */
+  std::vector<double> latenciesMs;
+
+  /** The mapping server. */
+  MappingServer_Ptr server;
+
+  //#################### CONSTRUCTORS ####################
+
+  RenderingResponseBenchmark(const MappingServer_Ptr& server_, const RGBDCalibrationMessage& calibMsg)
+  : bytesReceived(0), clientID(0), server(server_)
+  {
+    client.reset(new MappingClient("localhost", boost::lexical_cast<std::string>(PORT)));
+    client->send_calibration_message(calibMsg);
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  void run()
+  {
+    // Only keep the results from the most recent iteration.
+    latenciesMs.clear();
+    const uint64_t bytesReceivedBefore = client->get_statistics().bytesReceived;
+
+    typedef boost::chrono::steady_clock Clock;
+    for(size_t i = 0; i < RESPONSE_COUNT; ++i)
+    {
+      // Simulate the server rendering the next image for the client.
+      {
+        ExclusiveHandle_Ptr<ORUChar4Image_Ptr>::Type imageHandle = server->get_rendered_image(clientID);
+        ORUChar4Image_Ptr& image = imageHandle->get();
+        const ORUChar4Image_Ptr& nextImage = images[i % images.size()];
+        if(!image) image.reset(new ORUChar4Image(nextImage->noDims, true, false));
+        image->ChangeDims(nextImage->noDims);
+        image->SetFrom(nextImage.get(), ORUChar4Image::CPU_TO_CPU);
+      }
+
+      // Retrieve the image from the server, and measure how long it takes for it to become available for display on the client.
+      Clock::time_point t0 = Clock::now();
+      ORUChar4Image_CPtr remoteImage = client->get_remote_image();
+      Clock::time_point t1 = Clock::now();
+      if(!remoteImage) throw std::runtime_error("Error: Failed to retrieve the server-rendered image");
+      latenciesMs.push_back(boost::chrono::duration<double,boost::milli>(t1 - t0).count());
+    }
+
+    bytesReceived = client->get_statistics().bytesReceived - bytesReceivedBefore;
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Makes a copy of an image in which a small square region (whose position depends on the specified index) has been inverted.
+ *
+ * \param image The image to copy.
+ * \param i     The index determining the position of the inverted region.
+ * \return      The modified copy of the image.
+ */
+ORUChar4Image_Ptr make_modified_image(const ORUChar4Image_CPtr& image, size_t i)
+{
+  ORUChar4Image_Ptr result(new ORUChar4Image(image->noDims, true, false));
+  result->SetFrom(image.get(), ORUChar4Image::CPU_TO_CPU);
+
+  const Vector2i& imgSize = image->noDims;
+  const int x0 = static_cast<int>(i * 3 * CHANGED_REGION_SIZE / 2) % (imgSize.x - CHANGED_REGION_SIZE);
+  const int y0 = imgSize.y / 2;
+  Vector4u *pixels = result->GetData(MEMORYDEVICE_CPU);
+  for(int y = y0; y < y0 + CHANGED_REGION_SIZE; ++y)
+  {
+    for(int x = x0; x < x0 + CHANGED_REGION_SIZE; ++x)
+    {
+      Vector4u& pixel = pixels[y * imgSize.x + x];
+      pixel.r = 255 - pixel.r;
+      pixel.g = 255 - pixel.g;
+      pixel.b = 255 - pixel.b;
+    }
+  }
+
+  return result;
+}
+
+/**
+ * \brief Runs the benchmark for a particular sequence of server-rendered images, and outputs the bytes received and the latency per response.
+ *
+ * \param suite     The benchmark suite.
+ * \param benchmark The benchmark state.
+ * \param name      The name of the scenario.
+ * \param images    The images the server renders for the client (in order).
+ */
+void run_benchmark(BenchmarkSuite& suite, RenderingResponseBenchmark& benchmark, const std::string& name, const std::vector<ORUChar4Image_Ptr>& images)
+{
+  benchmark.images = images;
+
+  const size_t sampleCount = 3;
+  suite.run("RenderingResponses/" + name, boost::bind(&RenderingResponseBenchmark::run, &benchmark), RESPONSE_COUNT, sampleCount);
+
+  const std::vector<double>& latencies = benchmark.latenciesMs;
+  double meanLatency = 0.0;
+  for(size_t i = 0, size = latencies.size(); i < size; ++i) meanLatency += latencies[i];
+  meanLatency /= latencies.size();
+
+  const double kbPerResponse = benchmark.bytesReceived / 1024.0 / RESPONSE_COUNT;
+  std::cout << boost::format("  (%s: %.1f KB on the wire per response, mean display latency %.2fms)\n") % name % kbPerResponse % meanLatency;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("itmx", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  // Render a short synthetic sequence, whose colour images stand in for the images the server renders for the client.
+  SyntheticRGBDSequence sequence(RESPONSE_COUNT);
+  const std::vector<SyntheticRGBDSequence::Frame>& frames = sequence.get_frames();
+  const Vector2i& imageSize = frames[0].rgbImage->noDims;
+
+  // Make the calibration message that the client will send to the server.
+  ITMLib::ITMRGBDCalib calib;
+  calib.intrinsics_rgb.imgSize = calib.intrinsics_d.imgSize = imageSize;
+
+  RGBDCalibrationMessage calibMsg;
+  calibMsg.set_calib(calib);
+#ifdef WITH_OPENCV
+  calibMsg.set_depth_compression_type(DEPTH_COMPRESSION_PNG);
+  calibMsg.set_rgb_compression_type(RGB_COMPRESSION_JPG);
+#else
+  calibMsg.set_depth_compression_type(DEPTH_COMPRESSION_NONE);
+  calibMsg.set_rgb_compression_type(RGB_COMPRESSION_NONE);
+#endif
+
+  // Start a local mapping server and connect a client to it.
+  MappingServer_Ptr server(new MappingServer(MappingServer::SM_SINGLE_CLIENT, PORT));
+  server->start();
+
+  // Note: The server sets up its acceptor on its own thread, so give it a moment to start listening before connecting to it.
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(100));
+  RenderingResponseBenchmark benchmark(server, calibMsg);
+
+  // Benchmark the three scenarios: an image that never changes (e.g. a static scene viewed from a static pose), an image in which
+  // only a small region changes each time (e.g. a moving marker), and an image that changes completely each time (e.g. a moving camera).
+  std::vector<ORUChar4Image_Ptr> staticImages(1, frames[0].rgbImage), smallChangeImages, fullChangeImages;
+  for(size_t i = 0; i < RESPONSE_COUNT; ++i)
+  {
+    smallChangeImages.push_back(make_modified_image(frames[0].rgbImage, i));
+    fullChangeImages.push_back(frames[i].rgbImage);
+  }
+
+  run_benchmark(suite, benchmark, "static", staticImages);
+  run_benchmark(suite, benchmark, "small_change", smallChangeImages);
+  run_benchmark(suite, benchmark, "full_change", fullChangeImages);
+
+  std::cout << boost::format("  (for comparison, an uncompressed %dx%d image is %.1f KB)\n") % imageSize.x % imageSize.y % (imageSize.x * imageSize.y * sizeof(Vector4u) / 1024.0);
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,216 @@
+/**
+ * benchmarks/orx: bench_PoseProximityIndex.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include <Eigen/Geometry>
+
+#include <orx/geometry/PoseProximityIndex.h>
+using namespace orx;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### CONSTANTS ####################
+
+/** The number of difficulty bins into which the test poses are classified (as in relocnovelposes). */
+const size_t BIN_COUNT = 10;
+
+/** The stride with which to sample the test poses classified by brute force (classifying all of them would take minutes). */
+const size_t BRUTE_FORCE_TEST_STRIDE = 20;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark classifying the test poses of a relocalisation dataset
+ *        into difficulty bins based on how close they are to the training poses (as relocnovelposes does).
+ *
+ * The i'th bin contains the test poses that are within (5(i+1)cm, 5(i+1) degrees) of at least one training pose, but
+ * not within the thresholds of any earlier bin. Each test pose is classified either by a brute-force scan over all
+ * of the training poses, or by querying a pose proximity index. To keep the running time reasonable, the brute-force
+ * approach is only used to classify a strided subset of the test poses.
+ */
+struct PoseClassificationBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The maximum angles (in radians) for each bin. */
+  std::vector<float> maxAngles;
+
+  /** The maximum translations (in m) for each bin. */
+  std::vector<float> maxTranslations;
+
+  /** The test poses. */
+  std::vector<Eigen::Matrix4f> testPoses;
+
+  /** The training poses. */
+  std::vector<Eigen::Matrix4f> trainPoses;
+
+  //#################### CONSTRUCTORS ####################
+
+  PoseClassificationBenchmark(const std::vector<Eigen::Matrix4f>& trainPoses_, const std::vector<Eigen::Matrix4f>& testPoses_)
+  : testPoses(testPoses_), trainPoses(trainPoses_)
+  {
+    for(size_t i = 0; i < BIN_COUNT; ++i)
+    {
+      maxAngles.push_back((i + 1) * 5.0f * static_cast<float>(M_PI) / 180.0f);
+      maxTranslations.push_back((i + 1) * 0.05f);
+    }
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  std::vector<size_t> classify_brute_force(size_t testStride) const
+  {
+    std::vector<size_t> bins;
+    for(size_t testIndex = 0, testCount = testPoses.size(); testIndex < testCount; testIndex += testStride)
+    {
+      const Eigen::Matrix4f& testPose = testPoses[testIndex];
+      size_t chosenBin = BIN_COUNT;
+      for(size_t trainIndex = 0, trainCount = trainPoses.size(); trainIndex < trainCount; ++trainIndex)
+      {
+        const Eigen::Matrix4f& trainPose = trainPoses[trainIndex];
+        for(size_t binIndex = 0; binIndex < chosenBin; ++binIndex)
+        {
+          const float translationError = (trainPose.block<3,1>(0,3) - testPose.block<3,1>(0,3)).norm();
+          const float angleError = PoseProximityIndex::angular_separation(trainPose.block<3,3>(0,0), testPose.block<3,3>(0,0));
+          if(translationError <= maxTranslations[binIndex] && angleError <= maxAngles[binIndex])
+          {
+            chosenBin = binIndex;
+            break;
+          }
+        }
+      }
+      bins.push_back(chosenBin);
+    }
+    return bins;
+  }
+
+  std::vector<size_t> classify_indexed(size_t testStride) const
+  {
+    std::vector<size_t> bins;
+    PoseProximityIndex index(trainPoses);
+    for(size_t testIndex = 0, testCount = testPoses.size(); testIndex < testCount; testIndex += testStride)
+    {
+      size_t chosenBin = BIN_COUNT;
+      for(size_t binIndex = 0; binIndex < BIN_COUNT; ++binIndex)
+      {
+        if(!index.find_within(testPoses[testIndex], maxTranslations[binIndex], maxAngles[binIndex]).empty())
+        {
+          chosenBin = binIndex;
+          break;
+        }
+      }
+      bins.push_back(chosenBin);
+    }
+    return bins;
+  }
+
+  void run_brute_force()
+  {
+    keep(classify_brute_force(BRUTE_FORCE_TEST_STRIDE));
+  }
+
+  void run_indexed()
+  {
+    keep(classify_indexed(1));
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Makes a synthetic camera trajectory that wanders smoothly around an axis-aligned box.
+ *
+ * \param rng       The random number generator to use.
+ * \param poseCount The number of poses in the trajectory.
+ * \param extent    The extent (in m) of the box.
+ * \param stepSize  The mean distance (in m) moved by the camera between successive poses.
+ * \return          The trajectory.
+ */
+std::vector<Eigen::Matrix4f> make_trajectory(RandomNumberGenerator& rng, size_t poseCount, const Eigen::Vector3f& extent, float stepSize)
+{
+  std::vector<Eigen::Matrix4f> poses;
+  poses.reserve(poseCount);
+
+  Eigen::Vector3f t(rng.generate_real_from_uniform(0.0f, extent.x()), rng.generate_real_from_uniform(0.0f, extent.y()), rng.generate_real_from_uniform(0.0f, extent.z()));
+  Eigen::Vector3f velocity = Eigen::Vector3f::Zero();
+  Eigen::Matrix3f r = Eigen::Matrix3f::Identity();
+
+  for(size_t i = 0; i < poseCount; ++i)
+  {
+    // Smoothly perturb the velocity, and bounce the camera off the walls of the box.
+    velocity = 0.9f * velocity + 0.1f * stepSize * Eigen::Vector3f(rng.generate_from_gaussian(0.0f, 1.0f), rng.generate_from_gaussian(0.0f, 1.0f), rng.generate_from_gaussian(0.0f, 1.0f));
+    t += velocity;
+    for(int j = 0; j < 3; ++j)
+    {
+      if(t[j] < 0.0f || t[j] > extent[j]) velocity[j] = -velocity[j];
+    }
+
+    // Rotate the camera by up to a few degrees about a random axis.
+    const Eigen::Vector3f axis(rng.generate_from_gaussian(0.0f, 1.0f), rng.generate_from_gaussian(0.0f, 1.0f), rng.generate_from_gaussian(0.0f, 1.0f));
+    r = Eigen::AngleAxisf(rng.generate_real_from_uniform(0.0f, 0.05f), axis.normalized()).toRotationMatrix() * r;
+
+    Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+    pose.block<3,3>(0,0) = r;
+    pose.block<3,1>(0,3) = t;
+    poses.push_back(pose);
+  }
+
+  return poses;
+}
+
+/**
+ * \brief Runs the benchmark for classifying the test poses of a synthetic dataset, both by brute force and using a pose proximity index.
+ *
+ * \param suite           The benchmark suite.
+ * \param name            The name of the dataset.
+ * \param trainPoseCount  The number of training poses in the dataset.
+ * \param testPoseCount   The number of test poses in the dataset.
+ * \param extent          The extent (in m) of the box around which the camera moves.
+ * \param stepSize        The mean distance (in m) moved by the camera between successive poses.
+ */
+void run_benchmark(BenchmarkSuite& suite, const std::string& name, size_t trainPoseCount, size_t testPoseCount, const Eigen::Vector3f& extent, float stepSize)
+{
+  RandomNumberGenerator rng(12345);
+  std::vector<Eigen::Matrix4f> trainPoses = make_trajectory(rng, trainPoseCount, extent, stepSize);
+  std::vector<Eigen::Matrix4f> testPoses = make_trajectory(rng, testPoseCount, extent, stepSize);
+  PoseClassificationBenchmark benchmark(trainPoses, testPoses);
+
+  // Check that both approaches assign the test poses to the same bins.
+  if(benchmark.classify_brute_force(BRUTE_FORCE_TEST_STRIDE) != benchmark.classify_indexed(BRUTE_FORCE_TEST_STRIDE))
+  {
+    throw std::runtime_error("Error: The indexed classification of the " + name + " poses does not match the brute-force one");
+  }
+
+  const size_t bruteForceTestCount = (testPoseCount + BRUTE_FORCE_TEST_STRIDE - 1) / BRUTE_FORCE_TEST_STRIDE;
+  const size_t bruteForceSampleCount = 3;
+  suite.run("PoseProximityIndex/" + name + "_brute_force", boost::bind(&PoseClassificationBenchmark::run_brute_force, &benchmark), bruteForceTestCount, bruteForceSampleCount);
+  suite.run("PoseProximityIndex/" + name + "_indexed", boost::bind(&PoseClassificationBenchmark::run_indexed, &benchmark), testPoseCount);
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("orx", argc, argv);
+
+  // A room-scale dataset with the pose counts of the largest 7-Scenes sequences (e.g. office).
+  run_benchmark(suite, "7scenes_scale", 6000, 4000, Eigen::Vector3f(3.0f, 2.0f, 1.5f), 0.01f);
+
+  // A street-scale dataset with the pose counts of the Cambridge Landmarks sequences, sampled more densely (e.g. at 15Hz).
+  run_benchmark(suite, "cambridge_scale", 10000, 5000, Eigen::Vector3f(100.0f, 50.0f, 5.0f), 0.1f);
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,250 @@
+/**
+ * benchmarks/orx: bench_SequenceRecorder.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2019. All rights reserved.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include <orx/base/MemoryBlockFactory.h>
+#include <orx/persistence/SequenceRecorder.h>
+using namespace orx;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+namespace bf = boost::filesystem;
+
+//#################### CONSTANTS ####################
+
+/** The rate (in Hz) at which frames are captured in the paced benchmarks. */
+const double CAPTURE_RATE = 30.0;
+
+/** The number of frames passed to the recorder in each iteration of a benchmark. */
+const size_t FRAME_COUNT = 60;
+
+/** The number of distinct frames in the synthetic sequence (the frames passed to the recorder cycle through them). */
+const size_t SEQUENCE_LENGTH = 30;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct holds a frame that can be passed to a sequence recorder.
+ */
+struct RecordableFrame
+{
+  /** The camera pose (a camera -> world transformation). */
+  Matrix4f pose;
+
+  /** The depth image (in millimetres). */
+  ORShortImage_Ptr rawDepthImage;
+
+  /** The RGB image. */
+  ORUChar4Image_Ptr rgbImage;
+};
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark recording a sequence to disk.
+ *
+ * Each iteration of the benchmark passes a fixed number of frames to a fresh sequence recorder, which writes them into a
+ * temporary directory, and then waits for the recorder to finish writing them. The frames are either passed to the recorder
+ * as quickly as it will accept them (to measure the sustained rate at which it can write frames), or at a fixed capture rate
+ * (to measure how well it keeps up with a live camera).
+ */
+struct SequenceRecorderBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The number of bytes written to disk during the most recent iteration. */
+  uintmax_t bytesWritten;
+
+  /** The level of compression to use when encoding the images as PNGs. */
+  ImagePersister::PNGCompressionLevel compressionLevel;
+
+  /** The time (in seconds) taken by the most recent iteration (including waiting for the recorder to finish). */
+  double elapsedSeconds;
+
+  /** The frames to pass to the recorder (in order, cycling if necessary). */
+  const std::vector<RecordableFrame> *frames;
+
+  /** Whether or not to pass the frames to the recorder at a fixed capture rate (rather than as quickly as it will accept them). */
+  bool paced;
+
+  /** What the recorder should do when a frame is passed to it and every buffer is in use. */
+  pooled_queue::PoolEmptyStrategy poolEmptyStrategy;
+
+  /** The statistics reported by the recorder during the most recent iteration. */
+  SequenceRecorder::Statistics statistics;
+
+  /** The number of writer threads the recorder should use. */
+  size_t writerCount;
+
+  //#################### CONSTRUCTORS ####################
+
+  SequenceRecorderBenchmark(const std::vector<RecordableFrame>& frames_, ImagePersister::PNGCompressionLevel compressionLevel_, size_t writerCount_,
+                            pooled_queue::PoolEmptyStrategy poolEmptyStrategy_, bool paced_)
+  : bytesWritten(0),
+    compressionLevel(compressionLevel_),
+    elapsedSeconds(0.0),
+    frames(&frames_),
+    paced(paced_),
+    poolEmptyStrategy(poolEmptyStrategy_),
+    writerCount(writerCount_)
+  {}
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  void run()
+  {
+    const bf::path dir = bf::temp_directory_path() / bf::unique_path("spaint-sequencerecorder-%%%%-%%%%");
+    bf::create_directories(dir);
+
+    typedef boost::chrono::steady_clock Clock;
+    const Clock::time_point t0 = Clock::now();
+    {
+      SequenceRecorder recorder(dir, 8, writerCount, poolEmptyStrategy, compressionLevel);
+      for(size_t i = 0; i < FRAME_COUNT; ++i)
+      {
+        // If we're simulating a live camera, wait until the frame would have been captured.
+        if(paced) boost::this_thread::sleep_until(t0 + boost::chrono::microseconds(static_cast<long>(i * 1e6 / CAPTURE_RATE)));
+
+        const RecordableFrame& frame = (*frames)[i % frames->size()];
+        recorder.record_frame(frame.rgbImage, frame.rawDepthImage, frame.pose);
+      }
+
+      recorder.finish();
+      statistics = recorder.get_statistics();
+    }
+    elapsedSeconds = boost::chrono::duration<double>(Clock::now() - t0).count();
+
+    bytesWritten = 0;
+    for(bf::directory_iterator it(dir), iend; it != iend; ++it)
+    {
+      bytesWritten += bf::file_size(it->path());
+    }
+
+    bf::remove_all(dir);
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Makes a set of frames that can be passed to a sequence recorder from a synthetic RGB-D sequence.
+ *
+ * The synthetic images are noise-free, which would make them unrealistically easy to compress, so we add
+ * some noise to them (and knock out some of the depth values) to make them look more like real sensor data.
+ *
+ * \return  The frames.
+ */
+std::vector<RecordableFrame> make_frames()
+{
+  SyntheticRGBDSequence sequence(SEQUENCE_LENGTH);
+  const std::vector<SyntheticRGBDSequence::Frame>& syntheticFrames = sequence.get_frames();
+  RandomNumberGenerator rng(12345);
+
+  std::vector<RecordableFrame> frames(syntheticFrames.size());
+  for(size_t i = 0, size = syntheticFrames.size(); i < size; ++i)
+  {
+    const SyntheticRGBDSequence::Frame& syntheticFrame = syntheticFrames[i];
+    const Vector2i& imageSize = syntheticFrame.rgbImage->noDims;
+    RecordableFrame& frame = frames[i];
+    frame.pose = syntheticFrame.cameraPose.GetInvM();
+    frame.rawDepthImage.reset(new ORShortImage(imageSize, true, false));
+    frame.rgbImage.reset(new ORUChar4Image(imageSize, true, false));
+
+    const float *depths = syntheticFrame.depthImage->GetData(MEMORYDEVICE_CPU);
+    const Vector4u *colours = syntheticFrame.rgbImage->GetData(MEMORYDEVICE_CPU);
+    short *rawDepths = frame.rawDepthImage->GetData(MEMORYDEVICE_CPU);
+    Vector4u *rgb = frame.rgbImage->GetData(MEMORYDEVICE_CPU);
+    for(int j = 0, pixelCount = static_cast<int>(frame.rgbImage->dataSize); j < pixelCount; ++j)
+    {
+      const bool missingDepth = rng.generate_int_from_uniform(0, 99) < 5;
+      rawDepths[j] = missingDepth ? 0 : static_cast<short>(depths[j] * 1000.0f + rng.generate_int_from_uniform(-3, 3));
+
+      const int noise = rng.generate_int_from_uniform(-4, 4);
+      for(int k = 0; k < 3; ++k)
+      {
+        rgb[j][k] = static_cast<unsigned char>(std::min(std::max(colours[j][k] + noise, 0), 255));
+      }
+      rgb[j].a = 255;
+    }
+  }
+
+  return frames;
+}
+
+/**
+ * \brief Runs the benchmark for a particular recorder configuration, and outputs the rates at which frames and bytes were written and the recorder's statistics.
+ *
+ * \param suite             The benchmark suite.
+ * \param frames            The frames to pass to the recorder.
+ * \param compressionLevel  The level of compression to use when encoding the images as PNGs.
+ * \param writerCount       The number of writer threads the recorder should use.
+ * \param poolEmptyStrategy What the recorder should do when a frame is passed to it and every buffer is in use.
+ * \param paced             Whether or not to pass the frames to the recorder at a fixed capture rate.
+ */
+void run_benchmark(BenchmarkSuite& suite, const std::vector<RecordableFrame>& frames, ImagePersister::PNGCompressionLevel compressionLevel,
+                   size_t writerCount, pooled_queue::PoolEmptyStrategy poolEmptyStrategy, bool paced)
+{
+  const std::string name = (boost::format("%s/%s_%dwriters_%s") % (paced ? "paced30Hz" : "unpaced") % compressionLevel % writerCount % poolEmptyStrategy).str();
+  SequenceRecorderBenchmark benchmark(frames, compressionLevel, writerCount, poolEmptyStrategy, paced);
+
+  const size_t sampleCount = 2;
+  suite.run("SequenceRecorder/" + name, boost::bind(&SequenceRecorderBenchmark::run, &benchmark), FRAME_COUNT, sampleCount);
+
+  const SequenceRecorder::Statistics& stats = benchmark.statistics;
+  std::cout << boost::format("  (%s: wrote %d/%d frames at %.1f frames/s and %.1f MB/s; dropped %d, delayed %d; write latency mean %.1fms, worst %.1fms; peak queue %d)\n")
+               % name % stats.writtenFrameCount % FRAME_COUNT % (stats.writtenFrameCount / benchmark.elapsedSeconds)
+               % (benchmark.bytesWritten / (1024.0 * 1024.0) / benchmark.elapsedSeconds) % stats.droppedFrameCount % stats.delayedFrameCount
+               % (stats.writtenFrameCount > 0 ? stats.totalWriteLatencyMs / stats.writtenFrameCount : 0.0) % stats.maxWriteLatencyMs % stats.maxQueueSize;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("orx", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  const std::vector<RecordableFrame> frames = make_frames();
+  const ImagePersister::PNGCompressionLevel compressionLevels[] = { ImagePersister::PCL_DEFAULT, ImagePersister::PCL_FAST, ImagePersister::PCL_NONE };
+  const size_t writerCounts[] = { 1, 2, 4 };
+
+  // Measure the sustained rate at which each configuration of the recorder can write frames.
+  for(size_t i = 0; i < sizeof(compressionLevels) / sizeof(ImagePersister::PNGCompressionLevel); ++i)
+  {
+    for(size_t j = 0; j < sizeof(writerCounts) / sizeof(size_t); ++j)
+    {
+      run_benchmark(suite, frames, compressionLevels[i], writerCounts[j], pooled_queue::PES_WAIT, false);
+    }
+  }
+
+  // Measure how well the recorder keeps up with a 30Hz camera, for each compression level and each way of handling a full queue.
+  // Note that growing the pool without bound (as posting each frame to the thread pool used to do) never drops or delays frames,
+  // but the queue and the write latency grow without bound if the writers cannot keep up.
+  for(size_t i = 0; i < sizeof(compressionLevels) / sizeof(ImagePersister::PNGCompressionLevel); ++i)
+  {
+    run_benchmark(suite, frames, compressionLevels[i], 2, pooled_queue::PES_DISCARD, true);
+    run_benchmark(suite, frames, compressionLevels[i], 2, pooled_queue::PES_GROW, true);
+    run_benchmark(suite, frames, compressionLevels[i], 2, pooled_queue::PES_WAIT, true);
+  }
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
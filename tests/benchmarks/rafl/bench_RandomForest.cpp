@@ -0,0 +1,110 @@
+/**
+ * benchmarks/rafl: bench_RandomForest.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+using boost::assign::map_list_of;
+
+#include <rafl/core/RandomForest.h>
+#include <rafl/decisionfunctions/DecisionFunctionGeneratorFactory.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+using namespace rafl;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### TYPEDEFS ####################
+
+typedef int Label;
+typedef DecisionTree<Label> DT;
+typedef RandomForest<Label> RF;
+typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Predicts the labels of the specified descriptors using a random forest.
+ *
+ * \param forest      The forest.
+ * \param descriptors The descriptors.
+ */
+void predict(const RF *forest, const std::vector<Descriptor_CPtr> *descriptors)
+{
+  Label total = 0;
+  for(size_t i = 0, size = descriptors->size(); i < size; ++i)
+  {
+    total += forest->predict((*descriptors)[i]);
+  }
+  keep(total);
+}
+
+/**
+ * \brief Adds the specified examples to a new random forest and trains it until no more nodes can be split.
+ *
+ * \param settings  The settings for the trees in the forest.
+ * \param examples  The examples.
+ */
+void train(const DT::Settings *settings, const std::vector<Example_CPtr> *examples)
+{
+  const size_t treeCount = 4;
+  const size_t splitBudget = 1024;
+  RF forest(treeCount, *settings);
+  forest.add_examples(*examples);
+  while(forest.train(splitBudget) > 0);
+  keep(forest);
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("rafl", argc, argv);
+
+  const unsigned int seed = 12345;
+  DecisionFunctionGeneratorFactory<Label>::instance().register_rafl_makers();
+
+  // Generate a set of training examples and a set of descriptors to classify.
+  std::set<Label> classLabels;
+  for(Label label = 0; label < 8; ++label) classLabels.insert(label);
+  UnitCircleExampleGenerator<Label> uceg(classLabels, seed);
+  std::vector<Example_CPtr> trainingExamples = uceg.generate_examples(classLabels, 500);
+  std::vector<Example_CPtr> testExamples = uceg.generate_examples(classLabels, 1250);
+
+  std::vector<Descriptor_CPtr> descriptors;
+  descriptors.reserve(testExamples.size());
+  for(size_t i = 0, size = testExamples.size(); i < size; ++i)
+  {
+    descriptors.push_back(testExamples[i]->get_descriptor());
+  }
+
+  // Set up the tree settings.
+  std::map<std::string,std::string> properties = map_list_of<std::string,std::string>
+    ("candidateCount", "256")
+    ("decisionFunctionGeneratorParams", "")
+    ("decisionFunctionGeneratorType", "FeatureThresholding")
+    ("gainThreshold", "0.0")
+    ("maxClassSize", "10000")
+    ("maxTreeHeight", "20")
+    ("randomSeed", boost::lexical_cast<std::string>(seed))
+    ("seenExamplesThreshold", "50")
+    ("splittabilityThreshold", "0.5")
+    ("usePMFReweighting", "0");
+  DT::Settings settings(properties);
+
+  suite.run("RandomForest/train", boost::bind(train, &settings, &trainingExamples), trainingExamples.size(), 5);
+
+  // Train a forest whose predictions can be benchmarked.
+  RF forest(4, settings);
+  forest.add_examples(trainingExamples);
+  while(forest.train(1024) > 0);
+
+  suite.run("RandomForest/predict", boost::bind(predict, &forest, &descriptors), descriptors.size());
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
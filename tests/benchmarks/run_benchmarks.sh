@@ -0,0 +1,29 @@
+#! /usr/bin/env bash
+
+# Runs all of the benchmarks and writes their results (in JSON format) to the specified output directory.
+# Parameters are: outputDir [extra arguments to pass to each benchmark, e.g. --samples 30]
+# The benchmark executables are located in the subdirectories of the folder containing this script.
+
+set -e
+
+if [ $# -lt 1 ]
+then
+  echo "Usage: run_benchmarks.sh <output dir> [benchmark args...]"
+  exit 1
+fi
+
+output_dir=$1
+shift
+
+mkdir -p "$output_dir"
+output_dir=`cd "$output_dir" && pwd`
+
+# Move to the script folder, to have relative paths.
+cd `dirname $0`
+
+for benchmark in `find . -mindepth 2 -maxdepth 2 -type f -name 'benchmark_*' -perm -u+x | sort`
+do
+  name=`basename "$benchmark"`
+  echo "Running $name..."
+  "$benchmark" --output "$output_dir/$name.json" "$@"
+done
@@ -0,0 +1,186 @@
+/**
+ * benchmarks/spaint: bench_TouchPipeline.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include <spaint/imageprocessing/cpu/ImageProcessor_CPU.h>
+#include <spaint/touch/TouchDescriptorCalculator.h>
+#include <spaint/touch/cpu/TouchPipeline_CPU.h>
+using namespace spaint;
+
+#include "../common/BenchmarkSuite.h"
+#include "../common/SyntheticRGBDSequence.h"
+using namespace benchmarks;
+
+//#################### CONSTANTS ####################
+
+/** The threshold (in mm) below which the raw and raycasted depths are assumed to be equal. */
+const int LOWER_DEPTH_THRESHOLD_MM = 10;
+
+/** The side length of the morphological opening kernel that is applied to the change mask. */
+const int MORPH_KERNEL_SIZE = 5;
+
+//#################### TYPES ####################
+
+/**
+ * \brief An instance of this struct holds the state needed to benchmark the image analysis performed by the touch detector.
+ *
+ * Both pipelines perform the same steps as TouchDetector: depth differencing and thresholding, a morphological opening,
+ * connected-components labelling, a histogram descriptor for each candidate component, and touch point extraction from
+ * the first candidate. The forest evaluation is not included, since it is the same for both pipelines.
+ */
+struct TouchPipelineBenchmark
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The ArrayFire image processor (using the CPU backend). */
+  ImageProcessor_CPU afImageProcessor;
+
+  /** The depth raycast of the reconstructed model. */
+  ORFloatImage_Ptr depthRaycast;
+
+  /** The native CPU touch pipeline. */
+  TouchPipeline_CPU nativePipeline;
+
+  /** The raw depth image (containing some synthetic hands in front of the reconstructed model). */
+  ORFloatImage_Ptr rawDepth;
+
+  //#################### CONSTRUCTORS ####################
+
+  TouchPipelineBenchmark(const ORFloatImage_Ptr& depthRaycast_, const ORFloatImage_Ptr& rawDepth_)
+  : depthRaycast(depthRaycast_), nativePipeline(depthRaycast_->noDims), rawDepth(rawDepth_)
+  {}
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  void run_arrayfire()
+  {
+    const Vector2i& imgSize = rawDepth->noDims;
+    const int imageArea = imgSize.x * imgSize.y;
+
+    boost::shared_ptr<af::array> diffRawRaycast(new af::array(imgSize.y, imgSize.x, f32));
+    afImageProcessor.calculate_depth_difference(rawDepth, depthRaycast, diffRawRaycast);
+
+    af::array changeMask = *diffRawRaycast > (LOWER_DEPTH_THRESHOLD_MM / 1000.0f);
+    af::array morphKernel = af::constant(1, MORPH_KERNEL_SIZE, MORPH_KERNEL_SIZE);
+    changeMask = af::dilate(af::erode(changeMask, morphKernel), morphKernel);
+
+    af::array componentImage = (af::regions(changeMask) + 1) * changeMask;
+    const int componentCount = af::max<int>(componentImage) + 1;
+    af::array componentAreas = af::histogram(componentImage, componentCount);
+    componentAreas(0) = 0;
+    componentAreas -= (componentAreas < imageArea / 100) * componentAreas;
+    componentAreas -= (componentAreas > imageArea / 5) * componentAreas;
+    af::array candidates = af::where(componentAreas).as(s32);
+    if(candidates.isempty()) return;
+
+    const int *candidateIDs = candidates.host<int>();
+    af::array diffRawRaycastInMm = af::max(af::min(*diffRawRaycast * 1000.0f, 255.0f), 0.0f).as(u8);
+    for(int i = 0, candidateCount = static_cast<int>(candidates.dims(0)); i < candidateCount; ++i)
+    {
+      keep(TouchDescriptorCalculator::calculate_histogram_descriptor((componentImage == candidateIDs[i]) * diffRawRaycastInMm));
+    }
+
+    af::array diffImage = diffRawRaycastInMm * (componentImage == candidateIDs[0]);
+    diffImage = (diffImage / 8).as(u8) * 8;
+    diffImage = (diffImage > LOWER_DEPTH_THRESHOLD_MM) && (diffImage < LOWER_DEPTH_THRESHOLD_MM + 15);
+    morphKernel = af::constant(1, 5, 5);
+    diffImage = af::dilate(af::erode(diffImage, morphKernel), morphKernel);
+    af::array touchIndicesImage = af::where(af::resize(0.3f, diffImage));
+    const int *touchIndices = touchIndicesImage.as(s32).host<int>();
+    keep(touchIndices);
+
+    af::freeHost(candidateIDs);
+    af::freeHost(touchIndices);
+  }
+
+  void run_native()
+  {
+    const Vector2i& imgSize = rawDepth->noDims;
+    const int imageArea = imgSize.x * imgSize.y;
+
+    nativePipeline.detect_changes(rawDepth.get(), depthRaycast.get(), LOWER_DEPTH_THRESHOLD_MM, MORPH_KERNEL_SIZE);
+    nativePipeline.find_connected_components();
+
+    std::vector<int> candidates = nativePipeline.select_candidate_components(imageArea / 100, imageArea / 5);
+    if(candidates.empty()) return;
+
+    for(size_t i = 0, candidateCount = candidates.size(); i < candidateCount; ++i)
+    {
+      keep(TouchDescriptorCalculator::calculate_histogram_descriptor(nativePipeline.calculate_value_histogram(candidates[i])));
+    }
+
+    keep(nativePipeline.extract_touch_points(candidates[0], LOWER_DEPTH_THRESHOLD_MM, 0.0001f));
+  }
+};
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Makes a raw depth image by adding some synthetic hands (elliptical blobs that are slightly in front of the scene) to a depth raycast.
+ *
+ * \param depthRaycast  The depth raycast.
+ * \return              The raw depth image.
+ */
+ORFloatImage_Ptr make_raw_depth(const ORFloatImage_CPtr& depthRaycast)
+{
+  const Vector2i& imgSize = depthRaycast->noDims;
+  ORFloatImage_Ptr rawDepth = MemoryBlockFactory::instance().make_image<float>(imgSize);
+  const float *raycastData = depthRaycast->GetData(MEMORYDEVICE_CPU);
+  float *rawData = rawDepth->GetData(MEMORYDEVICE_CPU);
+
+  const int blobCount = 3;
+  const float blobX[] = { 0.3f, 0.6f, 0.5f }, blobY[] = { 0.4f, 0.6f, 0.2f };
+  const float blobRadiusX[] = { 0.1f, 0.06f, 0.15f }, blobRadiusY[] = { 0.06f, 0.15f, 0.04f };
+  const float blobOffset[] = { 0.02f, 0.2f, 0.012f };
+
+  for(int y = 0; y < imgSize.y; ++y)
+  {
+    for(int x = 0; x < imgSize.x; ++x)
+    {
+      const int pixelIndex = y * imgSize.x + x;
+      float depth = raycastData[pixelIndex];
+
+      for(int i = 0; i < blobCount; ++i)
+      {
+        const float dx = (static_cast<float>(x) / imgSize.x - blobX[i]) / blobRadiusX[i];
+        const float dy = (static_cast<float>(y) / imgSize.y - blobY[i]) / blobRadiusY[i];
+        const float r2 = dx * dx + dy * dy;
+        if(r2 < 1.0f) depth = raycastData[pixelIndex] - blobOffset[i] * (1.0f - 0.5f * r2);
+      }
+
+      // Mask out parts of the scene that are more than 2m away, as the touch detector does.
+      rawData[pixelIndex] = depth > 2.0f ? -1.0f : depth;
+    }
+  }
+
+  return rawDepth;
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("spaint", argc, argv);
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  // Use the depth image of a synthetic frame as the depth raycast, and add some synthetic hands to it to make the raw depth image.
+  SyntheticRGBDSequence sequence(1);
+  const ORFloatImage_Ptr& depthRaycast = sequence.get_frames()[0].depthImage;
+  const size_t pixelCount = depthRaycast->dataSize;
+
+  TouchPipelineBenchmark benchmark(depthRaycast, make_raw_depth(depthRaycast));
+  suite.run("TouchPipeline/arrayfire_cpu_640x480", boost::bind(&TouchPipelineBenchmark::run_arrayfire, &benchmark), pixelCount);
+  suite.run("TouchPipeline/native_cpu_640x480", boost::bind(&TouchPipelineBenchmark::run_native, &benchmark), pixelCount);
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
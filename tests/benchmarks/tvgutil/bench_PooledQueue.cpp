@@ -0,0 +1,118 @@
+/**
+ * benchmarks/tvgutil: bench_PooledQueue.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+
+#include <tvgutil/containers/PooledQueue.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### TYPEDEFS ####################
+
+typedef boost::shared_ptr<std::vector<float> > Buffer_Ptr;
+typedef PooledQueue<Buffer_Ptr> BufferQueue;
+
+//#################### CONSTANTS ####################
+
+/** The number of elements in each buffer (roughly the size of a small depth image). */
+const size_t BUFFER_SIZE = 320 * 240;
+
+/** The number of elements pushed through the queue by each iteration of the benchmarks. */
+const size_t ELEMENTS_PER_ITERATION = 1000;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Makes a buffer of the size used by the benchmarks.
+ *
+ * \return  The buffer.
+ */
+Buffer_Ptr make_buffer()
+{
+  return boost::make_shared<std::vector<float> >(BUFFER_SIZE);
+}
+
+/**
+ * \brief Pushes the specified number of elements onto a queue, writing a value into each.
+ *
+ * \param queue The queue.
+ * \param count The number of elements to push.
+ */
+void push_elements(BufferQueue *queue, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    BufferQueue::PushHandler_Ptr pushHandler = queue->begin_push();
+    boost::optional<Buffer_Ptr&> elt = pushHandler->get();
+    if(elt) (**elt)[0] = static_cast<float>(i);
+  }
+}
+
+/**
+ * \brief Pops the specified number of elements from a queue, reading a value from each.
+ *
+ * \param queue The queue.
+ * \param count The number of elements to pop.
+ */
+void pop_elements(BufferQueue *queue, size_t count)
+{
+  float total = 0.0f;
+  for(size_t i = 0; i < count; ++i)
+  {
+    total += (*queue->peek())[0];
+    queue->pop();
+  }
+  keep(total);
+}
+
+/**
+ * \brief Pushes elements onto and pops them from a queue on a single thread.
+ *
+ * \param queue The queue.
+ */
+void push_pop_single_thread(BufferQueue *queue)
+{
+  push_elements(queue, ELEMENTS_PER_ITERATION);
+  pop_elements(queue, ELEMENTS_PER_ITERATION);
+}
+
+/**
+ * \brief Pushes elements onto a queue on a producer thread, and pops them from it on the current thread.
+ *
+ * \param queue The queue.
+ */
+void producer_consumer(BufferQueue *queue)
+{
+  boost::thread producer(boost::bind(push_elements, queue, ELEMENTS_PER_ITERATION));
+  pop_elements(queue, ELEMENTS_PER_ITERATION);
+  producer.join();
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("tvgutil", argc, argv);
+
+  // A queue whose pool is large enough for all of the elements pushed in an iteration.
+  BufferQueue growQueue(pooled_queue::PES_GROW);
+  growQueue.initialise(ELEMENTS_PER_ITERATION, make_buffer);
+  suite.run("PooledQueue/push_pop_single_thread", boost::bind(push_pop_single_thread, &growQueue), ELEMENTS_PER_ITERATION);
+
+  // A small queue that makes the producer wait for the consumer (as in the mapping client and the async image source).
+  BufferQueue waitQueue(pooled_queue::PES_WAIT);
+  waitQueue.initialise(8, make_buffer);
+  suite.run("PooledQueue/producer_consumer_wait", boost::bind(producer_consumer, &waitQueue), ELEMENTS_PER_ITERATION);
+
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+/**
+ * benchmarks/tvgutil: bench_Tracer.cpp
+ * Copyright (c) Torr Vision Group, University of Oxford, 2018. All rights reserved.
+ */
+
+#include <boost/bind.hpp>
+
+#include <tvgutil/timing/AverageTimer.h>
+#include <tvgutil/timing/Tracer.h>
+using namespace tvgutil;
+
+#include "../common/BenchmarkSuite.h"
+using namespace benchmarks;
+
+//#################### CONSTANTS ####################
+
+/** The number of spans recorded by each iteration of the benchmarks. */
+const size_t SPANS_PER_ITERATION = 1000;
+
+//#################### FUNCTIONS ####################
+
+/**
+ * \brief Records a number of pairs of nested spans using ScopedSpan.
+ */
+void record_scoped_spans()
+{
+  for(size_t i = 0; i < SPANS_PER_ITERATION / 2; ++i)
+  {
+    Tracer::ScopedSpan outer("Outer");
+    Tracer::ScopedSpan inner("Inner");
+  }
+}
+
+/**
+ * \brief Records a number of spans by starting and stopping an AverageTimer.
+ *
+ * \param timer The timer.
+ */
+void record_timer_spans(AverageTimer<boost::chrono::microseconds> *timer)
+{
+  for(size_t i = 0; i < SPANS_PER_ITERATION; ++i)
+  {
+    timer->start_nosync();
+    timer->stop_nosync();
+  }
+}
+
+/**
+ * \brief Clears the tracer's buffers after recording some spans, so that later iterations never run out of buffer space.
+ *
+ * \param benchmark The benchmark that records the spans.
+ */
+void record_and_clear(const BenchmarkSuite::Benchmark& benchmark)
+{
+  benchmark();
+
+  Tracer& tracer = Tracer::instance();
+  const bool enabled = tracer.is_enabled();
+  tracer.set_enabled(false);
+  tracer.clear();
+  tracer.set_enabled(enabled);
+}
+
+int main(int argc, char *argv[])
+try
+{
+  BenchmarkSuite suite("tvgutil", argc, argv);
+  Tracer& tracer = Tracer::instance();
+  tracer.set_buffer_capacity(SPANS_PER_ITERATION);
+
+  // The cost of a span when tracing is disabled at runtime.
+  tracer.set_enabled(false);
+  suite.run("Tracer/scoped_span_disabled", boost::bind(record_and_clear, BenchmarkSuite::Benchmark(record_scoped_spans)), SPANS_PER_ITERATION);
+
+  // The cost of a span when tracing is enabled (this should be well under 100ns per span). Note that clearing the
+  // buffers after each iteration is included in the timings, which makes them slightly pessimistic.
+  tracer.set_enabled(true);
+  suite.run("Tracer/scoped_span_enabled", boost::bind(record_and_clear, BenchmarkSuite::Benchmark(record_scoped_spans)), SPANS_PER_ITERATION);
+
+  // The cost of a span recorded by an AverageTimer (this includes the cost of the timer itself, which reads the system clock twice).
+  AverageTimer<boost::chrono::microseconds> timer("Timer");
+  suite.run("Tracer/average_timer_enabled", boost::bind(record_and_clear, BenchmarkSuite::Benchmark(boost::bind(record_timer_spans, &timer))), SPANS_PER_ITERATION);
+
+  tracer.set_enabled(false);
+  return suite.finish();
+}
+catch(std::exception& e)
+{
+  std::cerr << e.what() << '\n';
+  return EXIT_FAILURE;
+}
@@ -1,8 +1,12 @@
 #define BOOST_TEST_MAIN
 #include <boost/test/unit_test.hpp>
 
+#include <stdexcept>
+
 #include <boost/assign/list_of.hpp>
+#include <boost/chrono.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
 using boost::assign::list_of;
 using boost::assign::map_list_of;
 
@@ -25,6 +29,26 @@ float sum_squares_cost_fn(const ParamSet& params)
   return cost;
 }
 
+float slow_sum_squares_cost_fn(const ParamSet& params)
+{
+  // Simulate an expensive cost function (e.g. one that runs a relocaliser on several sequences).
+  boost::this_thread::sleep_for(boost::chrono::milliseconds(2));
+  return sum_squares_cost_fn(params);
+}
+
+float throwing_cost_fn(const ParamSet&)
+{
+  throw std::invalid_argument("Cost function failed");
+}
+
+void add_test_params(CoordinateDescentParameterOptimiser& optimiser, float barMin = -1000.0f)
+{
+  optimiser.add_param("Foo", NumberSequenceGenerator::generate_stepped<float>(-5.5f, 1.5f, 5.0f))
+           .add_param("Bar", NumberSequenceGenerator::generate_stepped<float>(barMin, 1.0f, 5.0f))
+           .add_param("Boo", list_of<float>(-10.0f)(-5.0f)(-2.0f)(0.0f)(5.0f)(15.0f))
+           .add_param("Dum", list_of<float>(0.0f));
+}
+
 //#################### TESTS ####################
 
 BOOST_AUTO_TEST_SUITE(test_CoordinateDescentParameterOptimiser)
@@ -35,10 +59,7 @@ BOOST_AUTO_TEST_CASE(optimise_for_parameters_test)
   const unsigned int seed = 12345;
   const size_t epochCount = 10;
   CoordinateDescentParameterOptimiser optimiser(sum_squares_cost_fn, epochCount, seed);
-  optimiser.add_param("Foo", NumberSequenceGenerator::generate_stepped<float>(-5.5f, 1.5f, 5.0f))
-           .add_param("Bar", NumberSequenceGenerator::generate_stepped<float>(-1000.0f, 1.0f, 5.0f))
-           .add_param("Boo", list_of<float>(-10.0f)(-5.0f)(-2.0f)(0.0f)(5.0f)(15.0f))
-           .add_param("Dum", list_of<float>(0.0f));
+  add_test_params(optimiser);
 
   // Use the optimiser to choose a set of parameters.
   float cost;
@@ -58,4 +79,46 @@ BOOST_AUTO_TEST_CASE(optimise_for_parameters_test)
   BOOST_CHECK_CLOSE(cost, expectedCost, TOL);
 }
 
+BOOST_AUTO_TEST_CASE(parallel_optimise_for_parameters_test)
+{
+  const unsigned int seed = 12345;
+  const size_t epochCount = 3;
+
+  // Optimise the parameters of a cost function with injected latency, first serially and then using several threads.
+  const float barMin = -50.0f;
+  CoordinateDescentParameterOptimiser serialOptimiser(slow_sum_squares_cost_fn, epochCount, seed);
+  add_test_params(serialOptimiser, barMin);
+
+  const size_t threadCount = 8;
+  CoordinateDescentParameterOptimiser parallelOptimiser(slow_sum_squares_cost_fn, epochCount, seed, threadCount);
+  add_test_params(parallelOptimiser, barMin);
+
+  float serialCost, parallelCost;
+
+  boost::chrono::steady_clock::time_point t0 = boost::chrono::steady_clock::now();
+  ParamSet serialParams = serialOptimiser.optimise_for_parameters(&serialCost);
+  boost::chrono::steady_clock::time_point t1 = boost::chrono::steady_clock::now();
+  ParamSet parallelParams = parallelOptimiser.optimise_for_parameters(&parallelCost);
+  boost::chrono::steady_clock::time_point t2 = boost::chrono::steady_clock::now();
+
+  BOOST_TEST_MESSAGE("Serial: " << boost::chrono::duration_cast<boost::chrono::milliseconds>(t1 - t0)
+                     << ", Parallel (" << threadCount << " threads): " << boost::chrono::duration_cast<boost::chrono::milliseconds>(t2 - t1));
+
+  // Check that using several threads doesn't change the results.
+  BOOST_CHECK_EQUAL(ParamSetUtil::param_set_to_string(parallelParams), ParamSetUtil::param_set_to_string(serialParams));
+  BOOST_CHECK_EQUAL(parallelCost, serialCost);
+}
+
+BOOST_AUTO_TEST_CASE(exceptions_test)
+{
+  // An exception thrown by the cost function should be propagated with its original type, whether or not the parameter sets are evaluated concurrently.
+  const std::vector<ParamSet> paramSets(8, map_list_of("Foo","1"));
+  const size_t threadCounts[] = { 1, 4 };
+  for(size_t i = 0; i < sizeof(threadCounts) / sizeof(size_t); ++i)
+  {
+    EpochBasedParameterOptimiser::BatchCostFunction batchCostFn = EpochBasedParameterOptimiser::make_batch_cost_function(throwing_cost_fn, threadCounts[i]);
+    BOOST_CHECK_THROW(batchCostFn(paramSets), std::invalid_argument);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <evaluation/core/LearnerEvaluator.h>
+#include <evaluation/splitgenerators/CrossValidationSplitGenerator.h>
+using namespace evaluation;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+//#################### HELPER TYPES ####################
+
+/**
+ * \brief An instance of this class evaluates a toy "learner" whose result for a split depends on both the split and a random seed.
+ */
+class ToyLearnerEvaluator : public LearnerEvaluator<float,float>
+{
+private:
+  unsigned int m_seed;
+
+public:
+  ToyLearnerEvaluator(const SplitGenerator_Ptr& splitGenerator, unsigned int seed)
+  : LearnerEvaluator<float,float>(splitGenerator), m_seed(seed)
+  {}
+
+protected:
+  /** Override */
+  virtual float average_results(const std::vector<float>& results) const
+  {
+    float sum = 0.0f;
+    for(size_t i = 0, size = results.size(); i < size; ++i) sum += results[i];
+    return sum / results.size();
+  }
+
+  /** Override */
+  virtual float evaluate_on_split(const std::vector<Example_CPtr>& examples, const SplitGenerator::Split& split) const
+  {
+    // Use a generator that is owned by the task, as a real learner (e.g. a random forest) would.
+    RandomNumberGenerator rng(m_seed);
+
+    float result = 0.0f;
+    for(size_t i = 0, size = split.second.size(); i < size; ++i)
+    {
+      result += *examples[split.second[i]] * rng.generate_real_from_uniform(0.0f, 1.0f) / (i + 1);
+    }
+    return result;
+  }
+};
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_LearnerEvaluator)
+
+BOOST_AUTO_TEST_CASE(test_evaluate_concurrently)
+{
+  std::vector<boost::shared_ptr<const float> > examples;
+  for(int i = 0; i < 100; ++i) examples.push_back(boost::shared_ptr<const float>(new float(static_cast<float>(i))));
+
+  const unsigned int seed = 12345;
+  const size_t foldCount = 5, learnerCount = 7;
+
+  // Evaluate the learners in sequence, with a shared split generator.
+  std::vector<float> expectedResults;
+  {
+    SplitGenerator_Ptr splitGenerator(new CrossValidationSplitGenerator(seed, foldCount));
+    for(size_t i = 0; i < learnerCount; ++i)
+    {
+      expectedResults.push_back(ToyLearnerEvaluator(splitGenerator, static_cast<unsigned int>(i)).evaluate(examples));
+    }
+  }
+
+  // Check that evaluating them concurrently produces identical results, whatever the thread count.
+  const size_t threadCounts[] = { 1, 3, 8 };
+  for(size_t t = 0; t < 3; ++t)
+  {
+    SplitGenerator_Ptr splitGenerator(new CrossValidationSplitGenerator(seed, foldCount));
+    std::vector<boost::shared_ptr<const LearnerEvaluator<float,float> > > evaluators;
+    for(size_t i = 0; i < learnerCount; ++i)
+    {
+      evaluators.push_back(boost::shared_ptr<const LearnerEvaluator<float,float> >(new ToyLearnerEvaluator(splitGenerator, static_cast<unsigned int>(i))));
+    }
+
+    std::vector<float> results = LearnerEvaluator<float,float>::evaluate_concurrently(evaluators, examples, threadCounts[t]);
+    BOOST_CHECK_EQUAL_COLLECTIONS(results.begin(), results.end(), expectedResults.begin(), expectedResults.end());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
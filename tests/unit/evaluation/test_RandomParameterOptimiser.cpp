@@ -0,0 +1,92 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+using boost::assign::list_of;
+
+#include <evaluation/util/RandomParameterOptimiser.h>
+using namespace evaluation;
+
+#include <tvgutil/numbers/NumberSequenceGenerator.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+float sum_squares_cost_fn(const ParamSet& params)
+{
+  float cost = 0.0f;
+  for(std::map<std::string,std::string>::const_iterator it = params.begin(), iend = params.end(); it != iend; ++it)
+  {
+    float value = boost::lexical_cast<float>(it->second);
+    cost += value * value;
+  }
+  return cost;
+}
+
+std::vector<float> counting_batch_cost_fn(const std::vector<ParamSet>& paramSets, std::vector<size_t>& batchSizes)
+{
+  batchSizes.push_back(paramSets.size());
+
+  std::vector<float> costs;
+  for(size_t i = 0, size = paramSets.size(); i < size; ++i)
+  {
+    costs.push_back(sum_squares_cost_fn(paramSets[i]));
+  }
+  return costs;
+}
+
+ParamSet optimise(size_t epochCount, size_t threadCount, size_t batchSize, float& cost)
+{
+  const unsigned int seed = 12345;
+  RandomParameterOptimiser optimiser(sum_squares_cost_fn, epochCount, seed, threadCount, batchSize);
+  optimiser.add_param("Foo", NumberSequenceGenerator::generate_stepped<float>(-5.5f, 1.5f, 5.0f))
+           .add_param("Bar", NumberSequenceGenerator::generate_stepped<float>(-10.0f, 1.0f, 10.0f))
+           .add_param("Boo", list_of<float>(-10.0f)(-5.0f)(-2.0f)(0.0f)(5.0f)(15.0f));
+  return optimiser.optimise_for_parameters(&cost);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_RandomParameterOptimiser)
+
+BOOST_AUTO_TEST_CASE(batch_invariance_test)
+{
+  const size_t epochCount = 50;
+
+  float serialCost;
+  ParamSet serialParams = optimise(epochCount, 1, 1, serialCost);
+
+  // Check that neither the batch size nor the number of threads used affects the results.
+  const size_t threadCounts[] = { 1, 4, 8 };
+  const size_t batchSizes[] = { 0, 3, 7, 64 };
+  for(size_t i = 0; i < sizeof(threadCounts) / sizeof(size_t); ++i)
+  {
+    for(size_t j = 0; j < sizeof(batchSizes) / sizeof(size_t); ++j)
+    {
+      float cost;
+      ParamSet params = optimise(epochCount, threadCounts[i], batchSizes[j], cost);
+      BOOST_CHECK_EQUAL(ParamSetUtil::param_set_to_string(params), ParamSetUtil::param_set_to_string(serialParams));
+      BOOST_CHECK_EQUAL(cost, serialCost);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch_size_test)
+{
+  const unsigned int seed = 12345;
+  const size_t epochCount = 10, threadCount = 1, batchSize = 4;
+  RandomParameterOptimiser optimiser(sum_squares_cost_fn, epochCount, seed, threadCount, batchSize);
+  optimiser.add_param("Foo", list_of<int>(0)(1)(2));
+
+  std::vector<size_t> batchSizes;
+  optimiser.set_batch_cost_function(boost::bind(counting_batch_cost_fn, _1, boost::ref(batchSizes)));
+  optimiser.optimise_for_parameters();
+
+  // Check that the epochs were evaluated in batches of the specified size (with a smaller final batch).
+  std::vector<size_t> expectedBatchSizes = list_of(4)(4)(2);
+  BOOST_CHECK_EQUAL_COLLECTIONS(batchSizes.begin(), batchSizes.end(), expectedBatchSizes.begin(), expectedBatchSizes.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
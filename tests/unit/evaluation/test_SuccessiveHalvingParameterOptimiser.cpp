@@ -0,0 +1,143 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+using boost::assign::list_of;
+using boost::assign::map_list_of;
+
+#include <evaluation/util/SuccessiveHalvingParameterOptimiser.h>
+using namespace evaluation;
+
+#include <tvgutil/numbers/NumberSequenceGenerator.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief A cost function whose partial-budget costs are noisy approximations of the sum of squares of the parameters.
+ *
+ * The cost for a budget of b is the sum of squares plus (maxBudget - b), so the parameter sets are ranked in the same way
+ * at every budget, and only the maximum budget yields the true cost.
+ */
+float budgeted_sum_squares_cost_fn(const ParamSet& params, size_t budget, size_t maxBudget, std::map<size_t,size_t>& evaluationCounts, boost::mutex& mutex)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    ++evaluationCounts[budget];
+  }
+
+  float cost = static_cast<float>(maxBudget - budget);
+  for(std::map<std::string,std::string>::const_iterator it = params.begin(), iend = params.end(); it != iend; ++it)
+  {
+    float value = boost::lexical_cast<float>(it->second);
+    cost += value * value;
+  }
+  return cost;
+}
+
+/**
+ * \brief A budgeted batch cost function that records the size and budget of each batch it evaluates.
+ */
+std::vector<float> recording_budgeted_batch_cost_fn(const std::vector<ParamSet>& paramSets, size_t budget, size_t maxBudget, std::vector<std::pair<size_t,size_t> >& batches)
+{
+  batches.push_back(std::make_pair(paramSets.size(), budget));
+
+  std::map<size_t,size_t> dummyCounts;
+  boost::mutex mutex;
+  std::vector<float> costs;
+  for(size_t i = 0, size = paramSets.size(); i < size; ++i)
+  {
+    costs.push_back(budgeted_sum_squares_cost_fn(paramSets[i], budget, maxBudget, dummyCounts, mutex));
+  }
+  return costs;
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_SuccessiveHalvingParameterOptimiser)
+
+BOOST_AUTO_TEST_CASE(optimise_for_parameters_test)
+{
+  const unsigned int seed = 12345;
+  const size_t bracketCount = 2, initialParamSetCount = 16, minBudget = 1, maxBudget = 8;
+
+  ParamSet firstParams;
+  float firstCost = 0.0f;
+
+  const size_t threadCounts[] = { 1, 4 };
+  for(size_t i = 0; i < sizeof(threadCounts) / sizeof(size_t); ++i)
+  {
+    std::map<size_t,size_t> evaluationCounts;
+    boost::mutex mutex;
+
+    SuccessiveHalvingParameterOptimiser optimiser(
+      boost::bind(budgeted_sum_squares_cost_fn, _1, _2, maxBudget, boost::ref(evaluationCounts), boost::ref(mutex)),
+      bracketCount, initialParamSetCount, minBudget, maxBudget, seed, threadCounts[i]
+    );
+    optimiser.add_param("Foo", NumberSequenceGenerator::generate_stepped<int>(-5, 1, 5))
+             .add_param("Bar", NumberSequenceGenerator::generate_stepped<int>(-5, 1, 5));
+
+    float cost;
+    ParamSet params = optimiser.optimise_for_parameters(&cost);
+
+    // Check that each bracket evaluated 16 parameter sets with budget 1, 8 with budget 2, 4 with budget 4 and 2 with budget 8.
+    std::map<size_t,size_t> expectedEvaluationCounts = map_list_of(1,32)(2,16)(4,8)(8,4);
+    BOOST_CHECK(evaluationCounts == expectedEvaluationCounts);
+
+    // Check that the returned cost is the true cost of the returned parameter set.
+    std::map<size_t,size_t> dummyCounts;
+    BOOST_CHECK_EQUAL(cost, budgeted_sum_squares_cost_fn(params, maxBudget, maxBudget, dummyCounts, mutex));
+
+    // Check that the number of threads used doesn't change the results.
+    if(i == 0)
+    {
+      firstParams = params;
+      firstCost = cost;
+    }
+    else
+    {
+      BOOST_CHECK_EQUAL(ParamSetUtil::param_set_to_string(params), ParamSetUtil::param_set_to_string(firstParams));
+      BOOST_CHECK_EQUAL(cost, firstCost);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batch_cost_function_test)
+{
+  const size_t maxBudget = 8;
+  std::map<size_t,size_t> evaluationCounts;
+  boost::mutex mutex;
+  SuccessiveHalvingParameterOptimiser optimiser(
+    boost::bind(budgeted_sum_squares_cost_fn, _1, _2, maxBudget, boost::ref(evaluationCounts), boost::ref(mutex)),
+    1, 16, 1, maxBudget, 12345
+  );
+  optimiser.add_param("Foo", NumberSequenceGenerator::generate_stepped<int>(-5, 1, 5));
+
+  // An unbudgeted batch cost function cannot be used, so trying to set one should fail.
+  std::vector<std::pair<size_t,size_t> > batches;
+  BOOST_CHECK_THROW(optimiser.set_batch_cost_function(EpochBasedParameterOptimiser::make_batch_cost_function(boost::bind(budgeted_sum_squares_cost_fn, _1, maxBudget, maxBudget, boost::ref(evaluationCounts), boost::ref(mutex)), 1)), std::runtime_error);
+
+  // A budgeted batch cost function should be used to evaluate each round of the bracket in a single batch.
+  optimiser.set_budgeted_batch_cost_function(boost::bind(recording_budgeted_batch_cost_fn, _1, _2, maxBudget, boost::ref(batches)));
+  optimiser.optimise_for_parameters();
+
+  std::vector<std::pair<size_t,size_t> > expectedBatches = list_of(std::make_pair(16,1))(std::make_pair(8,2))(std::make_pair(4,4))(std::make_pair(2,8));
+  BOOST_CHECK(batches == expectedBatches);
+  BOOST_CHECK(evaluationCounts.empty());
+}
+
+BOOST_AUTO_TEST_CASE(constructor_test)
+{
+  std::map<size_t,size_t> evaluationCounts;
+  boost::mutex mutex;
+  SuccessiveHalvingParameterOptimiser::BudgetedCostFunction costFn = boost::bind(budgeted_sum_squares_cost_fn, _1, _2, 8, boost::ref(evaluationCounts), boost::ref(mutex));
+
+  BOOST_CHECK_THROW(SuccessiveHalvingParameterOptimiser(costFn, 1, 16, 0, 8, 12345), std::invalid_argument);
+  BOOST_CHECK_THROW(SuccessiveHalvingParameterOptimiser(costFn, 1, 16, 9, 8, 12345), std::invalid_argument);
+  BOOST_CHECK_THROW(SuccessiveHalvingParameterOptimiser(costFn, 1, 16, 1, 8, 12345, 1, 1), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <vector>
+
+#include <grove/features/base/Descriptor.h>
+#include <grove/features/cpu/RGBDPatchFeatureKernels_CPU.h>
+using namespace grove;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+//#################### TYPES ####################
+
+typedef Descriptor<256> DescriptorType;
+
+/**
+ * \brief An instance of this struct holds a random RGB-D frame, together with random feature offsets and channels.
+ *
+ * The depth image contains a mixture of valid depths and invalid ones (stored as either 0 or -1, as InfiniTAM does),
+ * and the offsets are large enough relative to the image sizes that many of the secondary points need to be clamped.
+ */
+struct RandomFrame
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  std::vector<uchar> channels;
+  std::vector<float> depths;
+  Vector2i depthSize;
+  std::vector<Keypoint3DColour> keypoints;
+  std::vector<Vector4i> offsets;
+  std::vector<Vector4u> rgb;
+  Vector2i rgbSize;
+
+  //#################### CONSTRUCTORS ####################
+
+  RandomFrame(const Vector2i& depthSize_, const Vector2i& rgbSize_, uint32_t featureCount, unsigned int seed)
+  : channels(featureCount), depths(depthSize_.x * depthSize_.y), depthSize(depthSize_), keypoints(depthSize_.x * depthSize_.y),
+    offsets(featureCount), rgb(rgbSize_.x * rgbSize_.y), rgbSize(rgbSize_)
+  {
+    RandomNumberGenerator rng(seed);
+
+    for(size_t i = 0, size = depths.size(); i < size; ++i)
+    {
+      switch(rng.generate_int_from_uniform(0, 9))
+      {
+        case 0:  depths[i] = 0.0f; break;
+        case 1:  depths[i] = -1.0f; break;
+        default: depths[i] = rng.generate_real_from_uniform<float>(0.2f, 5.0f); break;
+      }
+
+      // As in the calculators, the keypoints are valid iff depth is available for them.
+      keypoints[i].valid = depths[i] > 0.0f;
+    }
+
+    for(size_t i = 0, size = rgb.size(); i < size; ++i)
+    {
+      for(int j = 0; j < 4; ++j) rgb[i][j] = static_cast<uchar>(rng.generate_int_from_uniform(0, 255));
+    }
+
+    for(uint32_t i = 0; i < featureCount; ++i)
+    {
+      channels[i] = static_cast<uchar>(rng.generate_int_from_uniform(0, 2));
+      for(int j = 0; j < 4; ++j) offsets[i][j] = rng.generate_int_from_uniform(-130, 130);
+    }
+  }
+};
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Counts the features computed by the tabulated kernels that are not bit-identical to those computed by the shared functions.
+ *
+ * The features are compared for every pixel (including those at the edges of the images) that has a valid keypoint.
+ *
+ * \param frame         The frame from which to compute the features.
+ * \param featureCount  The number of features to compute (deliberately not always a multiple of the SIMD width).
+ * \param normalise     Whether or not to normalise the offsets by the depth of each pixel.
+ * \return              The number of features that differ.
+ */
+template <RGBDPatchFeatureDifferenceType DifferenceType>
+int count_mismatches(const RandomFrame& frame, uint32_t featureCount, bool normalise)
+{
+  const Vector2i& outSize = frame.depthSize;
+  const RGBDPatchFeatureOffsetTable depthTable(&frame.offsets[0], NULL, featureCount, frame.depthSize);
+  const RGBDPatchFeatureOffsetTable rgbTable(&frame.offsets[0], &frame.channels[0], featureCount, frame.rgbSize);
+
+  std::vector<DescriptorType> expected(outSize.x * outSize.y);
+  DescriptorType actual;
+  int mismatchCount = 0;
+
+  for(int y = 0; y < outSize.y; ++y)
+  {
+    for(int x = 0; x < outSize.x; ++x)
+    {
+      const Vector2i xyOut(x, y);
+      const Vector2i xyDepth = map_pixel_coordinates(xyOut, outSize, frame.depthSize);
+      const Vector2i xyRgb = map_pixel_coordinates(xyOut, outSize, frame.rgbSize);
+      const int rasterIdxOut = y * outSize.x + x;
+      if(!frame.keypoints[rasterIdxOut].valid) continue;
+
+      // Compute the depth features both ways, and compare them.
+      compute_depth_features<DifferenceType>(
+        xyDepth, xyOut, frame.depthSize, outSize, &frame.depths[0], &frame.offsets[0], &frame.keypoints[0], featureCount, 0, normalise, &expected[0]
+      );
+      compute_depth_features_tabulated<DifferenceType>(xyDepth, frame.depthSize, &frame.depths[0], depthTable, normalise, actual.data);
+      if(memcmp(expected[rasterIdxOut].data, actual.data, featureCount * sizeof(float)) != 0) ++mismatchCount;
+
+      // Compute the colour features both ways, and compare them.
+      compute_colour_features<DifferenceType>(
+        xyDepth, xyRgb, xyOut, frame.depthSize, frame.rgbSize, outSize, &frame.depths[0], &frame.rgb[0], &frame.offsets[0],
+        &frame.channels[0], &frame.keypoints[0], featureCount, 0, normalise, &expected[0]
+      );
+      const float depth = normalise ? frame.depths[xyDepth.y * frame.depthSize.x + xyDepth.x] : 1.0f;
+      compute_colour_features_tabulated<DifferenceType>(xyRgb, frame.rgbSize, &frame.rgb[0], rgbTable, normalise, depth, actual.data);
+      if(memcmp(expected[rasterIdxOut].data, actual.data, featureCount * sizeof(float)) != 0) ++mismatchCount;
+    }
+  }
+
+  return mismatchCount;
+}
+
+/**
+ * \brief Checks that the tabulated kernels match the shared functions for all difference types and normalisation settings.
+ */
+void check_kernels(const RandomFrame& frame, uint32_t featureCount)
+{
+  BOOST_CHECK_EQUAL(count_mismatches<CENTRAL_DIFFERENCE>(frame, featureCount, false), 0);
+  BOOST_CHECK_EQUAL(count_mismatches<CENTRAL_DIFFERENCE>(frame, featureCount, true), 0);
+  BOOST_CHECK_EQUAL(count_mismatches<PAIRWISE_DIFFERENCE>(frame, featureCount, false), 0);
+  BOOST_CHECK_EQUAL(count_mismatches<PAIRWISE_DIFFERENCE>(frame, featureCount, true), 0);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_RGBDPatchFeatureKernels)
+
+BOOST_AUTO_TEST_CASE(same_size_test)
+{
+  // Note: The feature counts are chosen to exercise both the vectorised and scalar code paths (when AVX2 is enabled).
+  const RandomFrame frame(Vector2i(80, 60), Vector2i(80, 60), 128, 12345);
+  check_kernels(frame, 128);
+  check_kernels(frame, 13);
+  check_kernels(frame, 5);
+}
+
+BOOST_AUTO_TEST_CASE(different_size_test)
+{
+  // Use image sizes whose ratios to the training image size are not exact, so that the rescaling of the offsets is exercised.
+  const RandomFrame frame(Vector2i(97, 73), Vector2i(151, 113), 64, 54321);
+  check_kernels(frame, 64);
+  check_kernels(frame, 21);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
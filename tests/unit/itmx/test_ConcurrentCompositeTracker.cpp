@@ -0,0 +1,213 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include <itmx/trackers/ConcurrentCompositeTracker.h>
+using namespace ITMLib;
+using namespace itmx;
+
+//#################### HELPER TYPES ####################
+
+/**
+ * \brief An exception type that does not derive from std::exception.
+ */
+struct TrackerFailure {};
+
+/**
+ * \brief An instance of this class simulates a tracker that takes a fixed time to produce a fixed result.
+ */
+class MockTracker : public ITMTracker
+{
+public:
+  /** Whether or not the tracker has finished tracking the most recent frame. */
+  boost::atomic<bool> finished;
+
+  /** The x coordinate of the camera translation at the start of the most recent frame. */
+  float initialX;
+
+  /** The time (in milliseconds) that the tracker takes to track a frame. */
+  int latencyMs;
+
+  /** The result the tracker produces. */
+  ITMTrackingState::TrackingResult result;
+
+  /** Whether or not the tracker throws rather than producing a result. */
+  boost::atomic<bool> throws;
+
+  /** Whether or not the tracker throws an exception that does not derive from std::exception (if it throws). */
+  boost::atomic<bool> throwsNonStandard;
+
+  /** The x coordinate of the camera translation the tracker produces. */
+  float x;
+
+public:
+  MockTracker(int latencyMs_, ITMTrackingState::TrackingResult result_, float x_)
+  : finished(false), initialX(0.0f), latencyMs(latencyMs_), result(result_), throws(false), throwsNonStandard(false), x(x_)
+  {}
+
+public:
+  virtual bool requiresColourRendering() const { return false; }
+  virtual bool requiresDepthReliability() const { return false; }
+  virtual bool requiresPointCloudRendering() const { return true; }
+
+  virtual void TrackCamera(ITMTrackingState *trackingState, const ITMView *view)
+  {
+    finished = false;
+    initialX = trackingState->pose_d->GetT().x;
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(latencyMs));
+
+    if(throws)
+    {
+      finished = true;
+      if(throwsNonStandard) throw TrackerFailure();
+      else throw std::invalid_argument("Tracker failed");
+    }
+
+    trackingState->pose_d->SetT(Vector3f(x, 0.0f, 0.0f));
+    trackingState->trackerResult = result;
+    finished = true;
+  }
+};
+
+typedef boost::shared_ptr<MockTracker> MockTracker_Ptr;
+
+/**
+ * \brief An instance of this struct holds the objects needed to track frames with a concurrent composite tracker.
+ */
+struct Fixture
+{
+  ConcurrentCompositeTracker composite;
+  ITMTrackingState trackingState;
+  ITMView view;
+
+  Fixture()
+  : composite(MEMORYDEVICE_CPU), trackingState(Vector2i(4, 3), MEMORYDEVICE_CPU), view(ITMRGBDCalib(), Vector2i(4, 3), Vector2i(4, 3), false)
+  {}
+
+  /**
+   * \brief Tracks a frame starting from the identity pose, and returns the time taken (in milliseconds).
+   */
+  double track()
+  {
+    trackingState.pose_d->SetT(Vector3f(0.0f, 0.0f, 0.0f));
+    trackingState.trackerResult = ITMTrackingState::TRACKING_GOOD;
+
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    composite.TrackCamera(&trackingState, &view);
+    return boost::chrono::duration<double,boost::milli>(boost::chrono::steady_clock::now() - start).count();
+  }
+};
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_ConcurrentCompositeTracker)
+
+BOOST_AUTO_TEST_CASE(test_adopts_first_good_result_by_priority)
+{
+  Fixture f;
+  MockTracker_Ptr slow(new MockTracker(100, ITMTrackingState::TRACKING_GOOD, 1.0f));
+  MockTracker_Ptr fast(new MockTracker(0, ITMTrackingState::TRACKING_GOOD, 2.0f));
+  f.composite.add_tracker(slow);
+  f.composite.add_tracker(fast);
+
+  // The fast tracker finishes first, but the slow one has a higher priority, so its result should be adopted.
+  f.track();
+  BOOST_CHECK_EQUAL(f.trackingState.trackerResult, ITMTrackingState::TRACKING_GOOD);
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 1.0f);
+
+  // If the slow tracker fails, the fast tracker's result should be adopted instead. Both trackers should start from the original pose.
+  slow->result = ITMTrackingState::TRACKING_FAILED;
+  f.track();
+  BOOST_CHECK_EQUAL(f.trackingState.trackerResult, ITMTrackingState::TRACKING_GOOD);
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 2.0f);
+  BOOST_CHECK_EQUAL(slow->initialX, 0.0f);
+  BOOST_CHECK_EQUAL(fast->initialX, 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_does_not_wait_for_unneeded_trackers)
+{
+  Fixture f;
+  MockTracker_Ptr fast(new MockTracker(0, ITMTrackingState::TRACKING_GOOD, 1.0f));
+  MockTracker_Ptr slow(new MockTracker(300, ITMTrackingState::TRACKING_GOOD, 2.0f));
+  f.composite.add_tracker(fast);
+  f.composite.add_tracker(slow);
+
+  // The fast tracker has the higher priority and succeeds, so the composite should return without waiting for the slow tracker.
+  BOOST_CHECK_LT(f.track(), 200.0);
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 1.0f);
+
+  // The slow tracker should still be running, and the composite should wait for it before tracking the next frame.
+  BOOST_CHECK(!slow->finished);
+  fast->result = ITMTrackingState::TRACKING_FAILED;
+  f.track();
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 2.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_falls_back_to_poor_or_failed)
+{
+  Fixture f;
+  MockTracker_Ptr first(new MockTracker(0, ITMTrackingState::TRACKING_FAILED, 1.0f));
+  MockTracker_Ptr second(new MockTracker(20, ITMTrackingState::TRACKING_POOR, 2.0f));
+  MockTracker_Ptr third(new MockTracker(0, ITMTrackingState::TRACKING_POOR, 3.0f));
+  f.composite.add_tracker(first);
+  f.composite.add_tracker(second);
+  f.composite.add_tracker(third);
+
+  // If no tracker produces a good result, the highest-priority poor result should be adopted.
+  f.track();
+  BOOST_CHECK_EQUAL(f.trackingState.trackerResult, ITMTrackingState::TRACKING_POOR);
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 2.0f);
+
+  // If every tracker fails, tracking should fail and the pose should be left unchanged.
+  second->result = third->result = ITMTrackingState::TRACKING_FAILED;
+  f.track();
+  BOOST_CHECK_EQUAL(f.trackingState.trackerResult, ITMTrackingState::TRACKING_FAILED);
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_must_finish)
+{
+  Fixture f;
+  MockTracker_Ptr fast(new MockTracker(0, ITMTrackingState::TRACKING_GOOD, 1.0f));
+  MockTracker_Ptr fallible(new MockTracker(100, ITMTrackingState::TRACKING_FAILED, 2.0f));
+  f.composite.add_tracker(fast);
+  f.composite.add_tracker(fallible, true);
+
+  // A tracker that must finish should always have finished by the time the composite returns, even if its result is not adopted.
+  f.track();
+  BOOST_CHECK(fallible->finished);
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(test_exceptions)
+{
+  Fixture f;
+  MockTracker_Ptr first(new MockTracker(0, ITMTrackingState::TRACKING_GOOD, 1.0f));
+  MockTracker_Ptr second(new MockTracker(0, ITMTrackingState::TRACKING_GOOD, 2.0f));
+  f.composite.add_tracker(first);
+  f.composite.add_tracker(second);
+
+  // An exception thrown by a lower-priority tracker whose result is not needed should be ignored.
+  second->throws = true;
+  BOOST_CHECK_NO_THROW(f.track());
+  BOOST_CHECK_EQUAL(f.trackingState.pose_d->GetT().x, 1.0f);
+
+  // An exception thrown by a higher-priority tracker should be propagated with its original type.
+  first->throws = true;
+  second->throws = false;
+  BOOST_CHECK_THROW(f.track(), std::invalid_argument);
+
+  // This should also be the case for exceptions that do not derive from std::exception.
+  first->throwsNonStandard = true;
+  BOOST_CHECK_THROW(f.track(), TrackerFailure);
+
+  // Nested trackers cannot be added once the composite is in use.
+  BOOST_CHECK_THROW(f.composite.add_tracker(first), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <itmx/remotemapping/MappingRateController.h>
+using namespace itmx;
+
+//#################### HELPER FUNCTIONS ####################
+
+MappingStatusMessage make_status(uint32_t queueSize, uint32_t droppedFrameCount, float processingRate)
+{
+  MappingStatusMessage status;
+  status.set_dropped_frame_count(droppedFrameCount);
+  status.set_processing_rate(processingRate);
+  status.set_queue_capacity(5);
+  status.set_queue_size(queueSize);
+  return status;
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_MappingRateController)
+
+BOOST_AUTO_TEST_CASE(jpeg_quality_test)
+{
+  const double linkBudget = 0.1;
+  MappingRateController controller(linkBudget, 50, 90);
+  BOOST_CHECK_EQUAL(controller.get_jpeg_quality(), 90);
+
+  // Check that slow transfers reduce the quality, but not below the minimum.
+  for(int i = 0; i < 10; ++i) controller.update(make_status(0, 0, 0.0f), 0.2);
+  BOOST_CHECK_EQUAL(controller.get_jpeg_quality(), 50);
+
+  // Check that transfers within the budget (but not comfortably so) leave the quality unchanged.
+  controller.update(make_status(0, 0, 0.0f), 0.08);
+  BOOST_CHECK_EQUAL(controller.get_jpeg_quality(), 50);
+
+  // Check that fast transfers gradually restore the quality, but not above the maximum.
+  controller.update(make_status(0, 0, 0.0f), 0.01);
+  BOOST_CHECK_EQUAL(controller.get_jpeg_quality(), 55);
+  for(int i = 0; i < 10; ++i) controller.update(make_status(0, 0, 0.0f), 0.01);
+  BOOST_CHECK_EQUAL(controller.get_jpeg_quality(), 90);
+}
+
+BOOST_AUTO_TEST_CASE(send_interval_test)
+{
+  MappingRateController controller;
+  BOOST_CHECK_EQUAL(controller.get_min_send_interval(), 0.0);
+
+  // Check that a server that is keeping up does not cause any throttling.
+  controller.update(make_status(1, 0, 30.0f), 0.0);
+  BOOST_CHECK_EQUAL(controller.get_min_send_interval(), 0.0);
+
+  // Check that a server whose queue is filling up causes the client to slow down to the server's processing rate straight away.
+  controller.update(make_status(3, 0, 10.0f), 0.0);
+  BOOST_CHECK_CLOSE(controller.get_min_send_interval(), 0.1, 1e-4);
+
+  // Check that if the server keeps falling behind, the client backs off further.
+  controller.update(make_status(4, 0, 10.0f), 0.0);
+  BOOST_CHECK_CLOSE(controller.get_min_send_interval(), 0.125, 1e-4);
+
+  // Check that a part-full queue leaves the interval unchanged.
+  controller.update(make_status(2, 0, 10.0f), 0.0);
+  BOOST_CHECK_CLOSE(controller.get_min_send_interval(), 0.125, 1e-4);
+
+  // Check that dropped frames cause the client to back off, even if the queue is not full.
+  controller.update(make_status(0, 1, 10.0f), 0.0);
+  BOOST_CHECK_CLOSE(controller.get_min_send_interval(), 0.15625, 1e-4);
+
+  // Check that the interval is never more than a second, even if the server is very slow.
+  controller.update(make_status(5, 1, 0.5f), 0.0);
+  BOOST_CHECK_CLOSE(controller.get_min_send_interval(), 1.0, 1e-4);
+
+  // Check that once the server is keeping up again, the interval gradually shrinks away to nothing.
+  controller.update(make_status(0, 1, 10.0f), 0.0);
+  BOOST_CHECK_CLOSE(controller.get_min_send_interval(), 0.9, 1e-4);
+  for(int i = 0; i < 100; ++i) controller.update(make_status(0, 1, 10.0f), 0.0);
+  BOOST_CHECK_EQUAL(controller.get_min_send_interval(), 0.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
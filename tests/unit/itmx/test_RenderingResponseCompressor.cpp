@@ -0,0 +1,246 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include <itmx/remotemapping/RenderingResponseCompressor.h>
+using namespace itmx;
+
+//#################### CONSTANTS ####################
+
+/** The size (in pixels) of the tiles used by the compressors in the tests (chosen so that the images have partial tiles at their edges). */
+const int TILE_SIZE = 16;
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Checks whether or not two images have the same size and contents.
+ */
+bool images_equal(const ORUChar4Image *image1, const ORUChar4Image *image2)
+{
+  if(image1->noDims.x != image2->noDims.x || image1->noDims.y != image2->noDims.y) return false;
+
+  const Vector4u *data1 = image1->GetData(MEMORYDEVICE_CPU);
+  const Vector4u *data2 = image2->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, size = image1->noDims.x * image1->noDims.y; i < size; ++i)
+  {
+    if(data1[i] != data2[i]) return false;
+  }
+
+  return true;
+}
+
+/**
+ * \brief Makes an image of the specified size whose pixels are all different from each other (for images of a reasonable size).
+ */
+ORUChar4Image_Ptr make_image(const Vector2i& size, int seed = 0)
+{
+  ORUChar4Image_Ptr image(new ORUChar4Image(size, true, false));
+  Vector4u *data = image->GetData(MEMORYDEVICE_CPU);
+  for(int y = 0; y < size.y; ++y)
+  {
+    for(int x = 0; x < size.x; ++x)
+    {
+      data[y * size.x + x] = Vector4u((uchar)(x + seed), (uchar)(y + seed), (uchar)(x * y + seed), 255);
+    }
+  }
+  return image;
+}
+
+/**
+ * \brief Sets the pixel at the specified position in an image to a colour that does not appear in any image made by make_image.
+ */
+void set_pixel(const ORUChar4Image_Ptr& image, int x, int y)
+{
+  image->GetData(MEMORYDEVICE_CPU)[y * image->noDims.x + x] = Vector4u(1, 2, 3, 4);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_RenderingResponseCompressor)
+
+BOOST_AUTO_TEST_CASE(full_image_test)
+{
+  RenderingResponseCompressor serverCompressor(RGB_COMPRESSION_NONE, TILE_SIZE), clientCompressor;
+  RenderingResponseHeaderMessage header;
+  RenderingResponseMessage msg(header);
+
+  // The first response (for which the client has not acknowledged any previous image) should contain all of the tiles.
+  ORUChar4Image_Ptr image = make_image(Vector2i(70, 40));
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  BOOST_CHECK_EQUAL(header.extract_tile_count(), 5u * 3u);
+  BOOST_CHECK_EQUAL(header.extract_tile_size(), (uint32_t)TILE_SIZE);
+  BOOST_CHECK_EQUAL(header.extract_image_size(), Vector2i(70, 40));
+
+  // The mosaic should have the same layout as the image, and so contain no padding.
+  BOOST_CHECK_EQUAL(header.extract_compressed_tile_data_byte_size(), 70u * 40u * sizeof(Vector4u));
+
+  // The client should be able to reconstruct the image from scratch.
+  ORUChar4Image_Ptr clientImage(new ORUChar4Image(Vector2i(70, 40), true, false));
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  BOOST_CHECK(images_equal(clientImage.get(), image.get()));
+}
+
+BOOST_AUTO_TEST_CASE(not_modified_test)
+{
+  RenderingResponseCompressor serverCompressor(RGB_COMPRESSION_NONE, TILE_SIZE), clientCompressor;
+  RenderingResponseHeaderMessage header;
+  RenderingResponseMessage msg(header);
+
+  ORUChar4Image_Ptr image = make_image(Vector2i(70, 40));
+  ORUChar4Image_Ptr clientImage(new ORUChar4Image(image->noDims, true, false));
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  serverCompressor.acknowledge_rendering_response();
+
+  // Once the client has acknowledged the image, a response for the same image should be a "not modified" reply.
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  BOOST_CHECK_EQUAL(header.extract_tile_count(), 0u);
+  BOOST_CHECK_EQUAL(header.extract_compressed_tile_data_byte_size(), 0u);
+
+  // Applying it should leave the client's image unchanged.
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  BOOST_CHECK(images_equal(clientImage.get(), image.get()));
+
+  // A "not modified" reply should not be applicable to an image of a different size.
+  ORUChar4Image_Ptr wrongSizeImage(new ORUChar4Image(Vector2i(10, 10), true, false));
+  BOOST_CHECK_THROW(clientCompressor.uncompress_rendering_response(header, msg, wrongSizeImage.get()), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(partial_tile_test)
+{
+  RenderingResponseCompressor serverCompressor(RGB_COMPRESSION_NONE, TILE_SIZE), clientCompressor;
+  RenderingResponseHeaderMessage header;
+  RenderingResponseMessage msg(header);
+
+  const Vector2i imgSize(70, 40);
+  ORUChar4Image_Ptr image = make_image(imgSize);
+  ORUChar4Image_Ptr clientImage(new ORUChar4Image(imgSize, true, false));
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  serverCompressor.acknowledge_rendering_response();
+
+  // Change one pixel in an interior tile, and one in the partial tile at the bottom-right corner of the image.
+  ORUChar4Image_Ptr changedImage = make_image(imgSize);
+  set_pixel(changedImage, 20, 5);   // tile (1,0), i.e. index 1
+  set_pixel(changedImage, 69, 39);  // tile (4,2), i.e. index 14
+
+  serverCompressor.compress_rendering_response(changedImage.get(), header, msg);
+  BOOST_CHECK_EQUAL(header.extract_tile_count(), 2u);
+
+  std::vector<uint32_t> tileIndices;
+  msg.extract_tile_indices(tileIndices);
+  BOOST_REQUIRE_EQUAL(tileIndices.size(), 2u);
+  BOOST_CHECK_EQUAL(tileIndices[0], 1u);
+  BOOST_CHECK_EQUAL(tileIndices[1], 14u);
+
+  // Only the changed tiles should have been sent (packed into a two-tile mosaic).
+  BOOST_CHECK_EQUAL(header.extract_compressed_tile_data_byte_size(), 2u * TILE_SIZE * TILE_SIZE * sizeof(Vector4u));
+
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  BOOST_CHECK(images_equal(clientImage.get(), changedImage.get()));
+}
+
+BOOST_AUTO_TEST_CASE(size_change_test)
+{
+  RenderingResponseCompressor serverCompressor(RGB_COMPRESSION_NONE, TILE_SIZE), clientCompressor;
+  RenderingResponseHeaderMessage header;
+  RenderingResponseMessage msg(header);
+
+  ORUChar4Image_Ptr image = make_image(Vector2i(70, 40));
+  ORUChar4Image_Ptr clientImage(new ORUChar4Image(image->noDims, true, false));
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  serverCompressor.acknowledge_rendering_response();
+
+  // If the size of the image changes, the response should contain all of the tiles, and the client's image should be resized.
+  ORUChar4Image_Ptr resizedImage = make_image(Vector2i(33, 50), 7);
+  serverCompressor.compress_rendering_response(resizedImage.get(), header, msg);
+  BOOST_CHECK_EQUAL(header.extract_tile_count(), 3u * 4u);
+
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  BOOST_CHECK(images_equal(clientImage.get(), resizedImage.get()));
+}
+
+BOOST_AUTO_TEST_CASE(unacknowledged_test)
+{
+  RenderingResponseCompressor serverCompressor(RGB_COMPRESSION_NONE, TILE_SIZE), clientCompressor;
+  RenderingResponseHeaderMessage header;
+  RenderingResponseMessage msg(header);
+
+  const Vector2i imgSize(70, 40);
+  ORUChar4Image_Ptr image = make_image(imgSize);
+  ORUChar4Image_Ptr clientImage(new ORUChar4Image(imgSize, true, false));
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  serverCompressor.acknowledge_rendering_response();
+
+  // Compress a response for a changed image, but do not acknowledge it.
+  ORUChar4Image_Ptr changedImage1 = make_image(imgSize);
+  set_pixel(changedImage1, 0, 0);
+  serverCompressor.compress_rendering_response(changedImage1.get(), header, msg);
+  BOOST_CHECK_EQUAL(header.extract_tile_count(), 1u);
+
+  // The next response should still be a delta against the last acknowledged image, and so contain both changes.
+  ORUChar4Image_Ptr changedImage2 = make_image(imgSize);
+  set_pixel(changedImage2, 0, 0);
+  set_pixel(changedImage2, 50, 30);
+  serverCompressor.compress_rendering_response(changedImage2.get(), header, msg);
+  BOOST_CHECK_EQUAL(header.extract_tile_count(), 2u);
+
+  clientCompressor.uncompress_rendering_response(header, msg, clientImage.get());
+  BOOST_CHECK(images_equal(clientImage.get(), changedImage2.get()));
+}
+
+BOOST_AUTO_TEST_CASE(reject_test)
+{
+  RenderingResponseCompressor serverCompressor(RGB_COMPRESSION_NONE, TILE_SIZE);
+  RenderingResponseHeaderMessage header;
+  RenderingResponseMessage msg(header);
+
+  ORUChar4Image_Ptr image = make_image(Vector2i(70, 40));
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  serverCompressor.acknowledge_rendering_response();
+
+  // If the client rejects a response, the next response should contain all of the tiles, even if the image has not changed.
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  serverCompressor.reject_rendering_response();
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  BOOST_CHECK_EQUAL(header.extract_tile_count(), 5u * 3u);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_response_test)
+{
+  RenderingResponseCompressor serverCompressor(RGB_COMPRESSION_NONE, TILE_SIZE), clientCompressor;
+  RenderingResponseHeaderMessage header;
+  RenderingResponseMessage msg(header);
+
+  const Vector2i imgSize(70, 40);
+  ORUChar4Image_Ptr image = make_image(imgSize);
+  serverCompressor.compress_rendering_response(image.get(), header, msg);
+  serverCompressor.acknowledge_rendering_response();
+
+  ORUChar4Image_Ptr changedImage = make_image(imgSize);
+  set_pixel(changedImage, 20, 5);
+  serverCompressor.compress_rendering_response(changedImage.get(), header, msg);
+
+  // Corrupt the tile index in the response.
+  std::vector<uint32_t> tileIndices;
+  msg.extract_tile_indices(tileIndices);
+  tileIndices[0] = 5u * 3u;
+  msg.set_tile_indices(tileIndices);
+
+  // Applying the response should fail, and leave the client's image unchanged.
+  ORUChar4Image_Ptr clientImage = make_image(imgSize);
+  BOOST_CHECK_THROW(clientCompressor.uncompress_rendering_response(header, msg, clientImage.get()), std::runtime_error);
+  BOOST_CHECK(images_equal(clientImage.get(), image.get()));
+
+  // A partial response should not be applicable to an image of a different size.
+  tileIndices[0] = 1u;
+  msg.set_tile_indices(tileIndices);
+  ORUChar4Image_Ptr wrongSizeImage = make_image(Vector2i(10, 10));
+  BOOST_CHECK_THROW(clientCompressor.uncompress_rendering_response(header, msg, wrongSizeImage.get()), std::runtime_error);
+  BOOST_CHECK(images_equal(wrongSizeImage.get(), make_image(Vector2i(10, 10)).get()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include <boost/chrono.hpp>
+#include <boost/thread.hpp>
+
+#include <itmx/imagesources/SensorClockImageSourceEngine.h>
+using namespace ITMLib;
+using namespace itmx;
+using namespace tvgutil;
+
+//#################### HELPER TYPES ####################
+
+/**
+ * \brief An instance of this class simulates a disk sequence whose frames are numbered (the number is stored in the first depth pixel).
+ */
+class MockImageSourceEngine : public InputSource::ImageSourceEngine
+{
+private:
+  /** The number of frames in the sequence. */
+  int m_frameCount;
+
+  /** The index of the next frame to read. */
+  int m_nextFrame;
+
+public:
+  explicit MockImageSourceEngine(int frameCount)
+  : m_frameCount(frameCount), m_nextFrame(0)
+  {}
+
+public:
+  virtual ITMRGBDCalib getCalib() const { return ITMRGBDCalib(); }
+  virtual Vector2i getDepthImageSize() const { return Vector2i(2, 2); }
+  virtual Vector2i getRGBImageSize() const { return Vector2i(2, 2); }
+  virtual bool hasMoreImages() const { return m_nextFrame < m_frameCount; }
+
+  virtual void getImages(ORUChar4Image *rgb, ORShortImage *rawDepth)
+  {
+    rawDepth->GetData(MEMORYDEVICE_CPU)[0] = static_cast<short>(m_nextFrame++);
+  }
+};
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Consumes all of the frames from a sensor clock image source engine, simulating a fixed processing time for each frame.
+ *
+ * \param engine        The engine.
+ * \param processingMs  The time (in milliseconds) that it takes to process each frame.
+ * \return              The numbers of the frames that were processed, in the order in which they were processed.
+ */
+std::vector<int> consume_frames(SensorClockImageSourceEngine& engine, int processingMs)
+{
+  std::vector<int> frames;
+  while(engine.hasImagesNow())
+  {
+    SensorClockImageSourceEngine::RGBDImage_CPtr rgbdImage = engine.borrow_images();
+    frames.push_back(rgbdImage->rawDepth->GetData(MEMORYDEVICE_CPU)[0]);
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(processingMs));
+  }
+  return frames;
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_SensorClockImageSourceEngine)
+
+BOOST_AUTO_TEST_CASE(constructor_test)
+{
+  BOOST_CHECK_THROW(SensorClockImageSourceEngine(NULL, 30.0), std::runtime_error);
+  BOOST_CHECK_THROW(SensorClockImageSourceEngine(new AsyncImageSourceEngine(new MockImageSourceEngine(1)), 0.0), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(bounded_queue_test)
+{
+  // Simulate a 200Hz sensor whose frames are processed by a consumer that takes 20ms per frame.
+  const int frameCount = 40;
+  LatencyRecorder_Ptr recorder(new LatencyRecorder);
+  SensorClockImageSourceEngine engine(new AsyncImageSourceEngine(new MockImageSourceEngine(frameCount)), 200.0, 1, recorder, "Test");
+  std::vector<int> frames = consume_frames(engine, 20);
+
+  // The consumer cannot keep up, so frames should have been dropped, and the processed frames should have missed their deadlines.
+  BOOST_CHECK_EQUAL(recorder->get_counter("Test: Captured Frames"), frameCount);
+  BOOST_CHECK_EQUAL(recorder->get_counter("Test: Processed Frames"), frames.size());
+  BOOST_CHECK_EQUAL(recorder->get_counter("Test: Dropped Frames"), frameCount - frames.size());
+  BOOST_CHECK_GT(recorder->get_counter("Test: Dropped Frames"), 0);
+  BOOST_CHECK_GT(recorder->get_counter("Test: Deadline Misses"), 0);
+
+  // The frames that were processed should still have been processed in order.
+  for(size_t i = 1, size = frames.size(); i < size; ++i)
+  {
+    BOOST_CHECK_LT(frames[i - 1], frames[i]);
+  }
+
+  // An end-to-end latency should have been recorded for every processed frame.
+  std::vector<LatencyRecorder::StageStatistics> stats = recorder->compute_statistics();
+  bool foundEndToEnd = false;
+  for(size_t i = 0, size = stats.size(); i < size; ++i)
+  {
+    if(stats[i].name == "Test: End-to-End")
+    {
+      foundEndToEnd = true;
+      BOOST_CHECK_EQUAL(stats[i].count, frames.size());
+    }
+  }
+  BOOST_CHECK(foundEndToEnd);
+}
+
+BOOST_AUTO_TEST_CASE(unbounded_queue_test)
+{
+  // Simulate a 200Hz sensor whose frames are processed by a slow consumer, but without limiting the size of the queue.
+  const int frameCount = 20;
+  LatencyRecorder_Ptr recorder(new LatencyRecorder);
+  SensorClockImageSourceEngine engine(new AsyncImageSourceEngine(new MockImageSourceEngine(frameCount)), 200.0, 0, recorder, "Test");
+  std::vector<int> frames = consume_frames(engine, 10);
+
+  // Every frame should have been processed, in order.
+  BOOST_REQUIRE_EQUAL(frames.size(), frameCount);
+  for(int i = 0; i < frameCount; ++i)
+  {
+    BOOST_CHECK_EQUAL(frames[i], i);
+  }
+
+  BOOST_CHECK_EQUAL(recorder->get_counter("Test: Dropped Frames"), 0);
+  BOOST_CHECK_EQUAL(recorder->get_counter("Test: Processed Frames"), frameCount);
+}
+
+BOOST_AUTO_TEST_CASE(fast_consumer_test)
+{
+  // Simulate a 50Hz sensor whose frames are processed by a consumer that can easily keep up.
+  const int frameCount = 10;
+  LatencyRecorder_Ptr recorder(new LatencyRecorder);
+  SensorClockImageSourceEngine engine(new AsyncImageSourceEngine(new MockImageSourceEngine(frameCount)), 50.0, 1, recorder, "Test");
+
+  const boost::chrono::steady_clock::time_point t0 = boost::chrono::steady_clock::now();
+  std::vector<int> frames = consume_frames(engine, 0);
+  const boost::chrono::steady_clock::duration elapsed = boost::chrono::steady_clock::now() - t0;
+
+  // Every frame should have been processed, and the consumer should have had to wait for the sensor to capture them.
+  BOOST_CHECK_EQUAL(frames.size(), frameCount);
+  BOOST_CHECK_EQUAL(recorder->get_counter("Test: Dropped Frames"), 0);
+  BOOST_CHECK_GE(elapsed, boost::chrono::milliseconds((frameCount - 1) * 20));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,123 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+
+#include <Eigen/Geometry>
+
+#include <orx/geometry/PoseProximityIndex.h>
+using namespace orx;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Finds the poses that are within the specified distances of a query pose by brute force.
+ */
+std::vector<size_t> find_within_brute_force(const std::vector<Eigen::Matrix4f>& poses, const Eigen::Matrix4f& pose, float maxTranslation, float maxAngle)
+{
+  std::vector<size_t> result;
+  for(size_t i = 0, size = poses.size(); i < size; ++i)
+  {
+    const Eigen::Vector3f t = poses[i].block<3,1>(0,3);
+    const float translationError = (t - Eigen::Vector3f(pose.block<3,1>(0,3))).norm();
+    const float angleError = PoseProximityIndex::angular_separation(poses[i].block<3,3>(0,0), pose.block<3,3>(0,0));
+    if(translationError <= maxTranslation && angleError <= maxAngle) result.push_back(i);
+  }
+  return result;
+}
+
+/**
+ * \brief Makes a random pose with a translation in [0,1]^3 and a rotation of up to 1 radian about a random axis.
+ */
+Eigen::Matrix4f make_random_pose(RandomNumberGenerator& rng)
+{
+  Eigen::Vector3f axis(rng.generate_from_gaussian(0.0f, 1.0f), rng.generate_from_gaussian(0.0f, 1.0f), rng.generate_from_gaussian(0.0f, 1.0f));
+  const float angle = rng.generate_real_from_uniform(0.0f, 1.0f);
+
+  Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+  pose.block<3,3>(0,0) = Eigen::AngleAxisf(angle, axis.normalized()).toRotationMatrix();
+  pose.block<3,1>(0,3) = Eigen::Vector3f(rng.generate_real_from_uniform(0.0f, 1.0f), rng.generate_real_from_uniform(0.0f, 1.0f), rng.generate_real_from_uniform(0.0f, 1.0f));
+  return pose;
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_PoseProximityIndex)
+
+BOOST_AUTO_TEST_CASE(test_find_nearest_within)
+{
+  RandomNumberGenerator rng(12345);
+  std::vector<Eigen::Matrix4f> poses;
+  for(int i = 0; i < 1000; ++i) poses.push_back(make_random_pose(rng));
+
+  PoseProximityIndex index(poses);
+  for(int i = 0; i < 200; ++i)
+  {
+    const Eigen::Matrix4f query = make_random_pose(rng);
+    const std::vector<size_t> expectedCandidates = find_within_brute_force(poses, query, 0.2f, 0.5f);
+
+    boost::optional<size_t> expected;
+    float bestDistance = std::numeric_limits<float>::max();
+    for(size_t j = 0, size = expectedCandidates.size(); j < size; ++j)
+    {
+      const float distance = (poses[expectedCandidates[j]].block<3,1>(0,3) - query.block<3,1>(0,3)).norm();
+      if(distance < bestDistance)
+      {
+        expected = expectedCandidates[j];
+        bestDistance = distance;
+      }
+    }
+
+    BOOST_CHECK(index.find_nearest_within(query, 0.2f, 0.5f) == expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_find_within)
+{
+  RandomNumberGenerator rng(12345);
+  std::vector<Eigen::Matrix4f> poses;
+  for(int i = 0; i < 1000; ++i) poses.push_back(make_random_pose(rng));
+
+  // Duplicate some of the poses, to check that poses with identical translations are handled correctly.
+  for(int i = 0; i < 50; ++i) poses.push_back(poses[i]);
+
+  PoseProximityIndex index(poses);
+  BOOST_CHECK_EQUAL(index.size(), poses.size());
+
+  const float maxTranslations[] = { 0.0f, 0.05f, 0.1f, 0.25f, 0.5f, 2.0f };
+  const float maxAngles[] = { 0.0f, 0.0873f, 0.1745f, 0.5f, 1.0f, 4.0f };
+  for(int i = 0; i < 100; ++i)
+  {
+    // Query both with poses that are in the set and with random poses.
+    const Eigen::Matrix4f query = i % 2 == 0 ? poses[i] : make_random_pose(rng);
+    for(int j = 0; j < 6; ++j)
+    {
+      const std::vector<size_t> expected = find_within_brute_force(poses, query, maxTranslations[j], maxAngles[j]);
+      const std::vector<size_t> actual = index.find_within(query, maxTranslations[j], maxAngles[j]);
+      BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_non_finite)
+{
+  std::vector<Eigen::Matrix4f> poses(3, Eigen::Matrix4f::Identity());
+  poses[1].setConstant(std::numeric_limits<float>::quiet_NaN());
+
+  PoseProximityIndex index(poses);
+  const std::vector<size_t> result = index.find_within(Eigen::Matrix4f::Identity(), 1.0f, 1.0f);
+  BOOST_REQUIRE_EQUAL(result.size(), 2);
+  BOOST_CHECK_EQUAL(result[0], 0);
+  BOOST_CHECK_EQUAL(result[1], 2);
+
+  BOOST_CHECK(index.find_within(poses[1], 1.0f, 1.0f).empty());
+  BOOST_CHECK(!index.find_nearest_within(poses[1], 1.0f, 1.0f));
+
+  PoseProximityIndex emptyIndex((std::vector<Eigen::Matrix4f>()));
+  BOOST_CHECK(emptyIndex.find_within(Eigen::Matrix4f::Identity(), 1.0f, 1.0f).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
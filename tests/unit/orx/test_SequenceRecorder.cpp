@@ -0,0 +1,174 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+
+#include <orx/persistence/SequenceRecorder.h>
+using namespace orx;
+using namespace tvgutil;
+
+namespace bf = boost::filesystem;
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Makes a temporary directory into which a sequence can be recorded.
+ */
+bf::path make_temporary_directory()
+{
+  const bf::path dir = bf::temp_directory_path() / bf::unique_path("spaint-test-%%%%-%%%%-%%%%");
+  bf::create_directories(dir);
+  return dir;
+}
+
+/**
+ * \brief Makes a test frame whose pixel values depend on the specified index.
+ */
+void make_test_frame(int index, const Vector2i& imageSize, bool opaque, ORUChar4Image_Ptr& rgbImage, ORShortImage_Ptr& rawDepthImage)
+{
+  rgbImage.reset(new ORUChar4Image(imageSize, true, false));
+  rawDepthImage.reset(new ORShortImage(imageSize, true, false));
+
+  Vector4u *rgb = rgbImage->GetData(MEMORYDEVICE_CPU);
+  short *rawDepth = rawDepthImage->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, pixelCount = static_cast<int>(rgbImage->dataSize); i < pixelCount; ++i)
+  {
+    rgb[i] = Vector4u(static_cast<unsigned char>(i * 7 + index), static_cast<unsigned char>(i * 3), static_cast<unsigned char>(index), opaque || i % 5 != 0 ? 255 : 17);
+    rawDepth[i] = static_cast<short>(i * 13 + index * 1000);
+  }
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_SequenceRecorder)
+
+BOOST_AUTO_TEST_CASE(test_discard)
+{
+  const bf::path dir = make_temporary_directory();
+
+  ORUChar4Image_Ptr rgbImage;
+  ORShortImage_Ptr rawDepthImage;
+  make_test_frame(0, Vector2i(320, 240), true, rgbImage, rawDepthImage);
+
+  // Record frames much faster than a single writer can encode them at the default level of compression, so that some of them are dropped.
+  Matrix4f pose;
+  pose.setIdentity();
+
+  size_t acceptedFrameCount = 0;
+  const size_t frameCount = 20;
+  {
+    SequenceRecorder recorder(dir, 1, 1, pooled_queue::PES_DISCARD, ImagePersister::PCL_DEFAULT);
+    for(size_t i = 0; i < frameCount; ++i)
+    {
+      if(recorder.record_frame(rgbImage, rawDepthImage, pose)) ++acceptedFrameCount;
+    }
+
+    recorder.finish();
+    const SequenceRecorder::Statistics stats = recorder.get_statistics();
+    BOOST_CHECK_EQUAL(stats.recordedFrameCount, acceptedFrameCount);
+    BOOST_CHECK_EQUAL(stats.droppedFrameCount, frameCount - acceptedFrameCount);
+    BOOST_CHECK_EQUAL(stats.writtenFrameCount, acceptedFrameCount);
+    BOOST_CHECK_EQUAL(stats.delayedFrameCount, 0);
+  }
+
+  BOOST_CHECK(acceptedFrameCount >= 1);
+  BOOST_CHECK(acceptedFrameCount < frameCount);
+
+  // Check that the frames that were accepted were numbered without gaps.
+  for(size_t i = 0; i < acceptedFrameCount; ++i)
+  {
+    BOOST_CHECK(bf::exists(dir / (boost::format("frame-%06i.color.png") % i).str()));
+    BOOST_CHECK(bf::exists(dir / (boost::format("frame-%06i.depth.png") % i).str()));
+    BOOST_CHECK(bf::exists(dir / (boost::format("frame-%06i.pose.txt") % i).str()));
+  }
+  BOOST_CHECK(!bf::exists(dir / (boost::format("frame-%06i.color.png") % acceptedFrameCount).str()));
+
+  bf::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_invalid)
+{
+  const bf::path dir = make_temporary_directory();
+
+  BOOST_CHECK_THROW(SequenceRecorder(dir, 0), std::invalid_argument);
+  BOOST_CHECK_THROW(SequenceRecorder(dir, 8, 0), std::invalid_argument);
+  BOOST_CHECK_THROW(SequenceRecorder(dir, 8, 2, pooled_queue::PES_REPLACE_RANDOM), std::invalid_argument);
+
+  ORUChar4Image_Ptr rgbImage;
+  ORShortImage_Ptr rawDepthImage;
+  make_test_frame(0, Vector2i(8, 8), true, rgbImage, rawDepthImage);
+
+  Matrix4f pose;
+  pose.setIdentity();
+
+  SequenceRecorder recorder(dir);
+  recorder.finish();
+  BOOST_CHECK_THROW(recorder.record_frame(rgbImage, rawDepthImage, pose), std::runtime_error);
+
+  bf::remove_all(dir);
+}
+
+BOOST_AUTO_TEST_CASE(test_round_trip)
+{
+  const ImagePersister::PNGCompressionLevel compressionLevels[] = { ImagePersister::PCL_DEFAULT, ImagePersister::PCL_FAST, ImagePersister::PCL_NONE };
+  const Vector2i imageSize(64, 48);
+  const int frameCount = 5;
+
+  Matrix4f pose;
+  pose.setIdentity();
+
+  for(size_t i = 0; i < sizeof(compressionLevels) / sizeof(ImagePersister::PNGCompressionLevel); ++i)
+  {
+    for(int opaque = 0; opaque < 2; ++opaque)
+    {
+      const bf::path dir = make_temporary_directory();
+
+      // Record the frames, using fewer buffers than frames so that the buffers have to be reused.
+      std::vector<ORUChar4Image_Ptr> rgbImages(frameCount);
+      std::vector<ORShortImage_Ptr> rawDepthImages(frameCount);
+      {
+        SequenceRecorder recorder(dir, 2, 3, pooled_queue::PES_WAIT, compressionLevels[i]);
+        for(int j = 0; j < frameCount; ++j)
+        {
+          make_test_frame(j, imageSize, opaque == 1, rgbImages[j], rawDepthImages[j]);
+          BOOST_CHECK(recorder.record_frame(rgbImages[j], rawDepthImages[j], pose));
+        }
+
+        recorder.finish();
+        const SequenceRecorder::Statistics stats = recorder.get_statistics();
+        BOOST_CHECK_EQUAL(stats.droppedFrameCount, 0);
+        BOOST_CHECK_EQUAL(stats.failedFrameCount, 0);
+        BOOST_CHECK_EQUAL(stats.writtenFrameCount, frameCount);
+      }
+
+      // Check that the frames can be loaded back in losslessly.
+      for(int j = 0; j < frameCount; ++j)
+      {
+        const ORUChar4Image_Ptr rgbImage = ImagePersister::load_rgba_image((dir / (boost::format("frame-%06i.color.png") % j).str()).string());
+        const ORShortImage_Ptr rawDepthImage = ImagePersister::load_short_image((dir / (boost::format("frame-%06i.depth.png") % j).str()).string());
+        BOOST_REQUIRE_EQUAL(rgbImage->dataSize, rgbImages[j]->dataSize);
+        BOOST_REQUIRE_EQUAL(rawDepthImage->dataSize, rawDepthImages[j]->dataSize);
+
+        const Vector4u *expectedRGB = rgbImages[j]->GetData(MEMORYDEVICE_CPU), *actualRGB = rgbImage->GetData(MEMORYDEVICE_CPU);
+        const short *expectedDepth = rawDepthImages[j]->GetData(MEMORYDEVICE_CPU), *actualDepth = rawDepthImage->GetData(MEMORYDEVICE_CPU);
+        bool rgbMatches = true, depthMatches = true;
+        for(size_t k = 0, pixelCount = rgbImage->dataSize; k < pixelCount; ++k)
+        {
+          const Vector4u& e = expectedRGB[k], & a = actualRGB[k];
+          if(e.r != a.r || e.g != a.g || e.b != a.b || e.a != a.a) rgbMatches = false;
+          if(expectedDepth[k] != actualDepth[k]) depthMatches = false;
+        }
+
+        BOOST_CHECK(rgbMatches);
+        BOOST_CHECK(depthMatches);
+      }
+
+      bf::remove_all(dir);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
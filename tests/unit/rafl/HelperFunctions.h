@@ -0,0 +1,39 @@
+#include <map>
+#include <string>
+
+#include <boost/assign/list_of.hpp>
+
+#include <rafl/core/RandomForest.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Trains a small random forest on noisy examples drawn from around the unit circle.
+ *
+ * \param decisionFunctionGeneratorType The type of decision function generator to use.
+ * \param generator                     The generator to use to make the training examples.
+ * \return                              The trained random forest.
+ */
+template <typename Label>
+boost::shared_ptr<rafl::RandomForest<Label> > train_forest(const std::string& decisionFunctionGeneratorType, rafl::UnitCircleExampleGenerator<Label>& generator)
+{
+  rafl::DecisionFunctionGeneratorFactory<Label>::instance().register_rafl_makers();
+
+  std::map<std::string,std::string> properties;
+  properties["candidateCount"] = "64";
+  properties["decisionFunctionGeneratorParams"] = "";
+  properties["decisionFunctionGeneratorType"] = decisionFunctionGeneratorType;
+  properties["gainThreshold"] = "0";
+  properties["maxClassSize"] = "1000";
+  properties["maxTreeHeight"] = "10";
+  properties["randomSeed"] = "1234";
+  properties["seenExamplesThreshold"] = "20";
+  properties["splittabilityThreshold"] = "0.5";
+  properties["usePMFReweighting"] = "1";
+
+  boost::shared_ptr<rafl::RandomForest<Label> > forest(new rafl::RandomForest<Label>(3, typename rafl::DecisionTree<Label>::Settings(properties)));
+  forest->add_examples(generator.generate_examples(boost::assign::list_of(0)(1)(2)(3), 200));
+  for(int i = 0; i < 20; ++i) forest->train(4);
+  return forest;
+}
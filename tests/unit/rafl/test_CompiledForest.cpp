@@ -0,0 +1,164 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+using boost::assign::list_of;
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <iterator>
+
+#include <rafl/core/CompiledForest.h>
+#include <rafl/decisionfunctions/FeatureThresholdingDecisionFunctionGenerator.h>
+#include <rafl/decisionfunctions/PairwiseOpAndThresholdDecisionFunctionGenerator.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+using namespace rafl;
+
+#include "HelperFunctions.h"
+
+typedef int Label;
+typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+typedef CompiledForest<Label> CF;
+typedef RandomForest<Label> RF;
+
+/**
+ * \brief Checks that loading a compiled forest from a modified copy of a saved compiled forest fails.
+ *
+ * \param bytes     The bytes of the saved compiled forest.
+ * \param offset    The offset of the int to overwrite in the copy (if truncating is false).
+ * \param value     The value with which to overwrite the int.
+ * \param truncate  Whether to truncate the copy at the specified offset rather than overwrite an int.
+ */
+void check_corrupt_load_fails(const std::vector<char>& bytes, size_t offset, int value, bool truncate = false)
+{
+  std::vector<char> corruptBytes(bytes.begin(), truncate ? bytes.begin() + offset : bytes.end());
+  if(!truncate) memcpy(&corruptBytes[offset], &value, sizeof(int));
+
+  const std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rafl-%%%%-%%%%.cf")).string();
+  {
+    std::ofstream fs(filename.c_str(), std::ios::binary);
+    fs.write(&corruptBytes[0], corruptBytes.size());
+  }
+
+  BOOST_CHECK_THROW(CF::load_from_file(filename), std::runtime_error);
+  boost::filesystem::remove(filename);
+}
+
+/**
+ * \brief Checks that a compiled forest makes exactly the same predictions as the forest from which it was compiled.
+ *
+ * \param forest          The original forest.
+ * \param compiledForest  The compiled forest.
+ * \param generator       The generator to use to make the test examples.
+ */
+void check_predictions(const RF& forest, const CF& compiledForest, UnitCircleExampleGenerator<Label>& generator)
+{
+  std::vector<Example_CPtr> examples = generator.generate_examples(list_of(0)(1)(2)(3), 250);
+  const size_t descriptorCount = examples.size();
+  const size_t featureCount = examples[0]->get_descriptor()->size();
+  std::vector<float> features;
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    const Descriptor& descriptor = *examples[i]->get_descriptor();
+    features.insert(features.end(), descriptor.begin(), descriptor.end());
+  }
+
+  std::vector<Label> labels(descriptorCount);
+  std::vector<float> confidences(descriptorCount);
+  compiledForest.predict_batch(&features[0], descriptorCount, featureCount, &labels[0], &confidences[0]);
+
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    const Descriptor_CPtr& descriptor = examples[i]->get_descriptor();
+    Label expectedLabel = forest.predict(descriptor);
+    BOOST_CHECK_EQUAL(labels[i], expectedLabel);
+    BOOST_CHECK_EQUAL(compiledForest.predict(&(*descriptor)[0]), expectedLabel);
+    BOOST_CHECK_EQUAL(confidences[i], forest.calculate_pmf(descriptor).get_masses().find(expectedLabel)->second);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE(test_CompiledForest)
+
+BOOST_AUTO_TEST_CASE(predict_test)
+{
+  UnitCircleExampleGenerator<Label> generator(list_of(0)(1)(2)(3), 1234, 0.1f, 0.3f);
+
+  boost::shared_ptr<RF> forest = train_forest(FeatureThresholdingDecisionFunctionGenerator<Label>::get_static_type(), generator);
+  CF compiledForest(*forest);
+  BOOST_CHECK_EQUAL(compiledForest.get_tree_count(), forest->get_tree_count());
+  check_predictions(*forest, compiledForest, generator);
+
+  forest = train_forest(PairwiseOpAndThresholdDecisionFunctionGenerator<Label>::get_static_type(), generator);
+  check_predictions(*forest, CF(*forest), generator);
+}
+
+BOOST_AUTO_TEST_CASE(save_load_test)
+{
+  UnitCircleExampleGenerator<Label> generator(list_of(0)(1)(2)(3), 1234, 0.1f, 0.3f);
+  boost::shared_ptr<RF> forest = train_forest(PairwiseOpAndThresholdDecisionFunctionGenerator<Label>::get_static_type(), generator);
+
+  const std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rafl-%%%%-%%%%.cf")).string();
+  CF(*forest).save_to_file(filename);
+  CF::CompiledForest_Ptr loadedForest = CF::load_from_file(filename);
+  boost::filesystem::remove(filename);
+
+  BOOST_CHECK_EQUAL(loadedForest->get_node_count(), CF(*forest).get_node_count());
+  check_predictions(*forest, *loadedForest, generator);
+
+  BOOST_CHECK_THROW(CF::load_from_file(filename), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(load_corrupt_test)
+{
+  UnitCircleExampleGenerator<Label> generator(list_of(0)(1)(2)(3), 1234, 0.1f, 0.3f);
+  boost::shared_ptr<RF> forest = train_forest(FeatureThresholdingDecisionFunctionGenerator<Label>::get_static_type(), generator);
+
+  const std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("rafl-%%%%-%%%%.cf")).string();
+  CF(*forest).save_to_file(filename);
+  std::vector<char> bytes;
+  {
+    std::ifstream fs(filename.c_str(), std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+  }
+  boost::filesystem::remove(filename);
+
+  // The file starts with an 8-byte magic number, followed by the label size, label count, tree count and node count, the labels,
+  // the root indices and the nodes (each of which consists of five 4-byte fields, the last of which is the child index).
+  int labelCount, treeCount, nodeCount;
+  memcpy(&labelCount, &bytes[12], sizeof(int));
+  memcpy(&treeCount, &bytes[16], sizeof(int));
+  memcpy(&nodeCount, &bytes[20], sizeof(int));
+  const size_t rootsOffset = 24 + labelCount * sizeof(Label);
+  const size_t nodesOffset = rootsOffset + treeCount * sizeof(int);
+  const size_t nodeSize = 5 * sizeof(int);
+  const size_t leafCountOffset = nodesOffset + nodeCount * nodeSize;
+
+  // Truncated files.
+  check_corrupt_load_fails(bytes, leafCountOffset + 4, 0, true);
+  check_corrupt_load_fails(bytes, nodesOffset + nodeSize / 2, 0, true);
+
+  // Out-of-range counts.
+  check_corrupt_load_fails(bytes, 20, 1 << 30);
+  check_corrupt_load_fails(bytes, 12, 0);
+  check_corrupt_load_fails(bytes, leafCountOffset, -1);
+  check_corrupt_load_fails(bytes, leafCountOffset, 1 << 30);
+
+  // Out-of-range root, child and feature indices, and an unknown node type (the root of the first tree is a split node).
+  check_corrupt_load_fails(bytes, rootsOffset, nodeCount);
+  check_corrupt_load_fails(bytes, nodesOffset + 4 * sizeof(int), nodeCount - 1);
+  check_corrupt_load_fails(bytes, nodesOffset + 4 * sizeof(int), 0);
+  check_corrupt_load_fails(bytes, nodesOffset + sizeof(int), -1);
+  check_corrupt_load_fails(bytes, nodesOffset, 17);
+
+  // An out-of-range leaf index (the last node in the file is always a leaf).
+  check_corrupt_load_fails(bytes, leafCountOffset - sizeof(int), 1 << 20);
+
+  // Too few features passed to a batch prediction.
+  CF compiledForest(*forest);
+  std::vector<float> features(compiledForest.get_required_feature_count() - 1);
+  Label label;
+  BOOST_CHECK_THROW(compiledForest.predict_batch(features.empty() ? NULL : &features[0], 1, features.size(), &label), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,51 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/assign/list_of.hpp>
+using boost::assign::list_of;
+
+#include <rafl/core/RandomForest.h>
+#include <rafl/decisionfunctions/PairwiseOpAndThresholdDecisionFunctionGenerator.h>
+#include <rafl/examples/UnitCircleExampleGenerator.h>
+using namespace rafl;
+
+#include "HelperFunctions.h"
+
+typedef int Label;
+typedef boost::shared_ptr<const Example<Label> > Example_CPtr;
+typedef RandomForest<Label> RF;
+
+BOOST_AUTO_TEST_SUITE(test_RandomForest)
+
+BOOST_AUTO_TEST_CASE(predict_batch_test)
+{
+  // Train a small forest on some noisy examples drawn from around the unit circle.
+  std::set<Label> classLabels = list_of(0)(1)(2)(3);
+  UnitCircleExampleGenerator<Label> generator(classLabels, 1234, 0.1f, 0.3f);
+  boost::shared_ptr<RF> forest = train_forest(PairwiseOpAndThresholdDecisionFunctionGenerator<Label>::get_static_type(), generator);
+
+  // Pack a set of test descriptors into a single row-major feature array.
+  std::vector<Example_CPtr> examples = generator.generate_examples(classLabels, 500);
+  const size_t descriptorCount = examples.size();
+  const size_t featureCount = examples[0]->get_descriptor()->size();
+  std::vector<float> features;
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    const Descriptor& descriptor = *examples[i]->get_descriptor();
+    features.insert(features.end(), descriptor.begin(), descriptor.end());
+  }
+
+  // Check that batch prediction agrees exactly with per-descriptor prediction.
+  std::vector<Label> labels(descriptorCount);
+  std::vector<float> confidences(descriptorCount);
+  forest->predict_batch(&features[0], descriptorCount, featureCount, &labels[0], &confidences[0]);
+
+  for(size_t i = 0; i < descriptorCount; ++i)
+  {
+    tvgutil::ProbabilityMassFunction<Label> pmf = forest->calculate_pmf(examples[i]->get_descriptor());
+    BOOST_CHECK_EQUAL(labels[i], forest->predict(examples[i]->get_descriptor()));
+    BOOST_CHECK_EQUAL(confidences[i], pmf.get_masses().find(labels[i])->second);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,100 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include <spaint/segmentation/ColourAppearanceModel.h>
+using namespace spaint;
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Makes a test image in which the left half is red and the right half is a mixture of green and blue, together with a mask marking the left half.
+ */
+void make_test_image(ORUChar4Image_Ptr& image, ORUCharImage_Ptr& mask)
+{
+  const Vector2i imgSize(32, 16);
+  image.reset(new ORUChar4Image(imgSize, true, false));
+  mask.reset(new ORUCharImage(imgSize, true, false));
+
+  Vector4u *imagePtr = image->GetData(MEMORYDEVICE_CPU);
+  uchar *maskPtr = mask->GetData(MEMORYDEVICE_CPU);
+  for(int y = 0; y < imgSize.y; ++y)
+  {
+    for(int x = 0; x < imgSize.x; ++x)
+    {
+      const int i = y * imgSize.x + x;
+      const bool object = x < imgSize.x / 2;
+      imagePtr[i] = object ? Vector4u(200, 40, 30, 255) : x % 2 == 0 ? Vector4u(0, 255, 0, 255) : Vector4u(0, 0, 255, 255);
+      maskPtr[i] = object ? 255 : 0;
+    }
+  }
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_ColourAppearanceModel)
+
+BOOST_AUTO_TEST_CASE(compute_object_mask_test)
+{
+  ORUChar4Image_Ptr image;
+  ORUCharImage_Ptr mask;
+  make_test_image(image, mask);
+
+  ColourAppearanceModel model(30, 30);
+  model.train(image, mask);
+
+  // Use the object mask as the candidate mask for half of the image, and consider every pixel in the other half.
+  ORUCharImage_Ptr candidateMask(new ORUCharImage(image->noDims, true, false));
+  const int pixelCount = static_cast<int>(image->dataSize);
+  for(int i = 0; i < pixelCount; ++i)
+  {
+    candidateMask->GetData(MEMORYDEVICE_CPU)[i] = i < pixelCount / 2 ? mask->GetData(MEMORYDEVICE_CPU)[i] : 255;
+  }
+
+  // Check that the mask is equivalent to thresholding the posterior probability for each candidate pixel.
+  const float thresholds[] = { 0.0f, 0.2f, 0.5f, 0.8f, 1.0f };
+  for(size_t j = 0; j < sizeof(thresholds) / sizeof(float); ++j)
+  {
+    std::vector<unsigned char> objectMask(pixelCount);
+    model.compute_object_mask(image, candidateMask, thresholds[j], &objectMask[0]);
+
+    for(int i = 0; i < pixelCount; ++i)
+    {
+      const bool expected = candidateMask->GetData(MEMORYDEVICE_CPU)[i] && model.compute_posterior_probability(image->GetData(MEMORYDEVICE_CPU)[i].toVector3()) >= thresholds[j];
+      BOOST_CHECK_EQUAL(objectMask[i], expected ? 255 : 0);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(compute_posterior_probability_test)
+{
+  ORUChar4Image_Ptr image;
+  ORUCharImage_Ptr mask;
+  make_test_image(image, mask);
+
+  // Before training, the model should not favour either possibility.
+  ColourAppearanceModel model(30, 30);
+  BOOST_CHECK_EQUAL(model.compute_posterior_probability(Vector3u(200, 40, 30)), 0.5f);
+
+  // After training, colours only seen on the object should be classified as object, and vice versa.
+  model.train(image, mask);
+  BOOST_CHECK_EQUAL(model.compute_posterior_probability(Vector3u(200, 40, 30)), 1.0f);
+  BOOST_CHECK_EQUAL(model.compute_posterior_probability(Vector3u(0, 255, 0)), 0.0f);
+
+  // Colours that haven't been seen at all should still not favour either possibility.
+  BOOST_CHECK_EQUAL(model.compute_posterior_probability(Vector3u(255, 255, 255)), 0.5f);
+
+  // Retraining on the same data with the mask inverted should make the two colours equally likely to be object.
+  for(int i = 0, pixelCount = static_cast<int>(mask->dataSize); i < pixelCount; ++i)
+  {
+    uchar& m = mask->GetData(MEMORYDEVICE_CPU)[i];
+    m = m ? 0 : 255;
+  }
+
+  model.train(image, mask);
+  BOOST_CHECK_CLOSE(model.compute_posterior_probability(Vector3u(200, 40, 30)), 0.5f, 1e-3f);
+  BOOST_CHECK_CLOSE(model.compute_posterior_probability(Vector3u(0, 255, 0)), 0.5f, 1e-3f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,197 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <ITMLib/Core/ITMDenseMapper.h>
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+using namespace ITMLib;
+
+#include <orx/base/MemoryBlockFactory.h>
+using namespace orx;
+
+#include <spaint/propagation/cpu/LabelPropagator_CPU.h>
+using namespace spaint;
+
+//#################### HELPER TYPES ####################
+
+/**
+ * \brief An instance of this struct holds a small synthetic scene containing a flat, two-coloured surface, together with a raycast result that views it head-on.
+ *
+ * The surface lies in the plane z = 8 (in voxels), and consists of a red half (x < 16) and a dark blue half (x >= 16). The voxel blocks
+ * used all have non-negative coordinates, which keeps them from colliding in the hash table.
+ */
+struct TwoColouredPlane
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The raycast result, in which each pixel (x,y) views the voxel (x,y,8) offset by a specified amount. */
+  ORFloat4Image raycastResult;
+
+  /** The settings used to create the scene. */
+  ITMLibSettings settings;
+
+  /** The scene. */
+  SpaintVoxelScene scene;
+
+  //#################### CONSTRUCTORS ####################
+
+  explicit TwoColouredPlane(const Vector2i& imgSize)
+  : raycastResult(imgSize, true, false), scene(&settings.sceneParams, false, MEMORYDEVICE_CPU)
+  {
+    settings.deviceType = ORUtils::DEVICE_CPU;
+    ITMDenseMapper<SpaintVoxel,ITMVoxelIndex> denseMapper(&settings);
+    denseMapper.ResetScene(&scene);
+
+    // Allocate a 6x6x2 grid of voxel blocks, and fill in their voxels.
+    ITMHashEntry *hashTable = scene.index.GetEntries();
+    int *allocationList = scene.localVBA.GetAllocationList();
+    SpaintVoxel *voxelData = scene.localVBA.GetVoxelBlocks();
+
+    for(short bz = 0; bz < 2; ++bz)
+    {
+      for(short by = 0; by < 6; ++by)
+      {
+        for(short bx = 0; bx < 6; ++bx)
+        {
+          const Vector3s blockPos(bx, by, bz);
+          ITMHashEntry& hashEntry = hashTable[hashIndex(blockPos)];
+          BOOST_REQUIRE(hashEntry.ptr < 0);
+
+          hashEntry.pos = blockPos;
+          hashEntry.ptr = allocationList[scene.localVBA.lastFreeBlockId--];
+          hashEntry.offset = 0;
+
+          for(int i = 0; i < SDF_BLOCK_SIZE3; ++i)
+          {
+            const int x = bx * SDF_BLOCK_SIZE + i % SDF_BLOCK_SIZE;
+            const int z = bz * SDF_BLOCK_SIZE + i / (SDF_BLOCK_SIZE * SDF_BLOCK_SIZE);
+
+            SpaintVoxel& voxel = voxelData[hashEntry.ptr * SDF_BLOCK_SIZE3 + i];
+            voxel.sdf = SpaintVoxel::floatToValue((8 - z) * 0.1f);
+            voxel.w_depth = 1;
+            voxel.clr = x < 16 ? Vector3u(200, 50, 50) : Vector3u(20, 20, 60);
+            voxel.w_color = 1;
+          }
+        }
+      }
+    }
+
+    set_view(Vector2i(4, 4));
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Gets the voxel viewed by the specified pixel of the raycast result.
+   */
+  SpaintVoxel& get_voxel(int x, int y)
+  {
+    const Vector4f& loc = raycastResult.GetData(MEMORYDEVICE_CPU)[y * raycastResult.noDims.x + x];
+    bool isFound;
+    const int voxelAddress = findVoxel(scene.index.getIndexData(), loc.toVector3().toIntRound(), isFound);
+    BOOST_REQUIRE(isFound);
+    return scene.localVBA.GetVoxelBlocks()[voxelAddress];
+  }
+
+  /**
+   * \brief Labels the voxels viewed by the specified rectangle of pixels as if the user had labelled them.
+   */
+  void label_rectangle(int x0, int y0, int x1, int y1, SpaintVoxel::Label label)
+  {
+    for(int y = y0; y < y1; ++y)
+    {
+      for(int x = x0; x < x1; ++x) get_voxel(x, y).packedLabel = SpaintVoxel::PackedLabel(label, SpaintVoxel::LG_USER);
+    }
+  }
+
+  /**
+   * \brief Moves the view, so that each pixel (x,y) of the raycast result views the voxel (x,y,8) + offset.
+   */
+  void set_view(const Vector2i& offset)
+  {
+    Vector4f *raycastResultData = raycastResult.GetData(MEMORYDEVICE_CPU);
+    for(int y = 0; y < raycastResult.noDims.y; ++y)
+    {
+      for(int x = 0; x < raycastResult.noDims.x; ++x)
+      {
+        raycastResultData[y * raycastResult.noDims.x + x] = Vector4f(static_cast<float>(x + offset.x), static_cast<float>(y + offset.y), 8.0f, 1.0f);
+      }
+    }
+  }
+};
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Checks that two scenes have the same labels under the raycast result, and that those labels are as expected.
+ *
+ * \param full              The scene labelled by a full-image propagator.
+ * \param incremental       The scene labelled by an incremental propagator.
+ * \param blueHalfStartX    The x coordinate of the first pixel that views the blue half of the surface.
+ * \param expectedRedLabel  The label expected for the red half of the surface.
+ * \param expectedBlueLabel The label expected for the blue half of the surface.
+ */
+void check_labels(TwoColouredPlane& full, TwoColouredPlane& incremental, int blueHalfStartX, SpaintVoxel::Label expectedRedLabel, SpaintVoxel::Label expectedBlueLabel)
+{
+  int mismatchCount = 0;
+  for(int y = 0; y < full.raycastResult.noDims.y; ++y)
+  {
+    for(int x = 0; x < full.raycastResult.noDims.x; ++x)
+    {
+      const SpaintVoxel::Label expectedLabel = x < blueHalfStartX ? expectedRedLabel : expectedBlueLabel;
+      if(full.get_voxel(x, y).packedLabel.label != expectedLabel) ++mismatchCount;
+      if(!(incremental.get_voxel(x, y).packedLabel == full.get_voxel(x, y).packedLabel)) ++mismatchCount;
+    }
+  }
+
+  BOOST_CHECK_EQUAL(mismatchCount, 0);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_LabelPropagator_CPU)
+
+BOOST_AUTO_TEST_CASE(incremental_propagation_test)
+{
+  MemoryBlockFactory::instance().set_device_type(ORUtils::DEVICE_CPU);
+
+  const Vector2i imgSize(24, 24);
+  const float maxAngleBetweenNormals = static_cast<float>(2.0f * M_PI / 180.0f);
+  const float maxSquaredDistanceBetweenColours = 50.0f * 50.0f;
+  const float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f;
+  const size_t raycastResultSize = imgSize.x * imgSize.y;
+  LabelPropagator_CPU fullPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, false);
+  LabelPropagator_CPU incrementalPropagator(raycastResultSize, maxAngleBetweenNormals, maxSquaredDistanceBetweenColours, maxSquaredDistanceBetweenVoxels, true);
+
+  TwoColouredPlane full(imgSize), incremental(imgSize);
+
+  // Label a patch of the red half of the surface, and propagate the label. Since the incremental propagator advances
+  // the propagation front by a bounded amount on each pass, both propagators are given enough passes to converge.
+  // The label should fill the red half of the surface, but not cross the colour boundary into the blue half.
+  full.label_rectangle(2, 2, 8, 8, 1);
+  incremental.label_rectangle(2, 2, 8, 8, 1);
+  for(int i = 0; i < 20; ++i)
+  {
+    fullPropagator.propagate_label(1, &full.raycastResult, &full.scene);
+    incrementalPropagator.propagate_label(1, &incremental.raycastResult, &incremental.scene);
+  }
+  check_labels(full, incremental, 12, 1, 0);
+
+  // Once the propagation has converged, further passes should not change anything.
+  incrementalPropagator.propagate_label(1, &incremental.raycastResult, &incremental.scene);
+  check_labels(full, incremental, 12, 1, 0);
+
+  // Move the view so that every raycast point changes, label a patch of the blue half of the surface with a different
+  // label, and propagate that label instead. It should fill the blue half of the surface, but not overwrite the red half.
+  full.set_view(Vector2i(7, 4));
+  incremental.set_view(Vector2i(7, 4));
+  full.label_rectangle(14, 14, 20, 20, 2);
+  incremental.label_rectangle(14, 14, 20, 20, 2);
+  for(int i = 0; i < 20; ++i)
+  {
+    fullPropagator.propagate_label(2, &full.raycastResult, &full.scene);
+    incrementalPropagator.propagate_label(2, &incremental.raycastResult, &incremental.scene);
+  }
+  check_labels(full, incremental, 9, 1, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,187 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/assign/list_of.hpp>
+using boost::assign::list_of;
+
+#include <ITMLib/Core/ITMDenseMapper.h>
+#include <ITMLib/Objects/Scene/ITMRepresentationAccess.h>
+using namespace ITMLib;
+
+#include <spaint/smoothing/cpu/LabelSmoother_CPU.h>
+using namespace spaint;
+
+//#################### HELPER TYPES ####################
+
+/**
+ * \brief An instance of this struct holds a small synthetic scene containing a flat surface, together with a raycast result that views it head-on.
+ *
+ * Each pixel (x,y) of the raycast result views the voxel (x+4,y+4,8). The voxel blocks used all have non-negative coordinates,
+ * which keeps them from colliding in the hash table.
+ */
+struct Plane
+{
+  //#################### PUBLIC VARIABLES ####################
+
+  /** The raycast result. */
+  ORFloat4Image raycastResult;
+
+  /** The settings used to create the scene. */
+  ITMLibSettings settings;
+
+  /** The scene. */
+  SpaintVoxelScene scene;
+
+  //#################### CONSTRUCTORS ####################
+
+  explicit Plane(const Vector2i& imgSize)
+  : raycastResult(imgSize, true, false), scene(&settings.sceneParams, false, MEMORYDEVICE_CPU)
+  {
+    settings.deviceType = ORUtils::DEVICE_CPU;
+    ITMDenseMapper<SpaintVoxel,ITMVoxelIndex> denseMapper(&settings);
+    denseMapper.ResetScene(&scene);
+
+    // Allocate a 6x6x2 grid of voxel blocks (the voxels themselves can keep their default values).
+    ITMHashEntry *hashTable = scene.index.GetEntries();
+    int *allocationList = scene.localVBA.GetAllocationList();
+    for(short bz = 0; bz < 2; ++bz)
+    {
+      for(short by = 0; by < 6; ++by)
+      {
+        for(short bx = 0; bx < 6; ++bx)
+        {
+          const Vector3s blockPos(bx, by, bz);
+          ITMHashEntry& hashEntry = hashTable[hashIndex(blockPos)];
+          BOOST_REQUIRE(hashEntry.ptr < 0);
+
+          hashEntry.pos = blockPos;
+          hashEntry.ptr = allocationList[scene.localVBA.lastFreeBlockId--];
+          hashEntry.offset = 0;
+        }
+      }
+    }
+
+    Vector4f *raycastResultData = raycastResult.GetData(MEMORYDEVICE_CPU);
+    for(int y = 0; y < imgSize.y; ++y)
+    {
+      for(int x = 0; x < imgSize.x; ++x)
+      {
+        raycastResultData[y * imgSize.x + x] = Vector4f(static_cast<float>(x + 4), static_cast<float>(y + 4), 8.0f, 1.0f);
+      }
+    }
+  }
+
+  //#################### PUBLIC MEMBER FUNCTIONS ####################
+
+  /**
+   * \brief Gets the label of the voxel viewed by the specified pixel of the raycast result.
+   */
+  SpaintVoxel::PackedLabel& get_label(int x, int y)
+  {
+    const Vector4f& loc = raycastResult.GetData(MEMORYDEVICE_CPU)[y * raycastResult.noDims.x + x];
+    bool isFound;
+    const int voxelAddress = findVoxel(scene.index.getIndexData(), loc.toVector3().toIntRound(), isFound);
+    BOOST_REQUIRE(isFound);
+    return scene.localVBA.GetVoxelBlocks()[voxelAddress].packedLabel;
+  }
+};
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Labels the voxels viewed by every pixel of a plane's raycast result with label 1, except for those viewed by the specified holes.
+ */
+void label_all_but(Plane& plane, const std::vector<Vector2i>& holes)
+{
+  for(int y = 0; y < plane.raycastResult.noDims.y; ++y)
+  {
+    for(int x = 0; x < plane.raycastResult.noDims.x; ++x) plane.get_label(x, y) = SpaintVoxel::PackedLabel(1, SpaintVoxel::LG_USER);
+  }
+
+  for(size_t i = 0, size = holes.size(); i < size; ++i)
+  {
+    plane.get_label(holes[i].x, holes[i].y) = SpaintVoxel::PackedLabel();
+  }
+}
+
+/**
+ * \brief Checks that two planes have the same labels under the raycast result, and that only the specified holes are unlabelled.
+ */
+void check_labels(Plane& full, Plane& incremental, const std::vector<Vector2i>& expectedHoles)
+{
+  int mismatchCount = 0;
+  for(int y = 0; y < full.raycastResult.noDims.y; ++y)
+  {
+    for(int x = 0; x < full.raycastResult.noDims.x; ++x)
+    {
+      const bool expectedHole = std::find(expectedHoles.begin(), expectedHoles.end(), Vector2i(x, y)) != expectedHoles.end();
+      if(full.get_label(x, y).label != (expectedHole ? 0 : 1)) ++mismatchCount;
+      if(!(incremental.get_label(x, y) == full.get_label(x, y))) ++mismatchCount;
+    }
+  }
+
+  BOOST_CHECK_EQUAL(mismatchCount, 0);
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_LabelSmoother_CPU)
+
+BOOST_AUTO_TEST_CASE(incremental_smoothing_test)
+{
+  const Vector2i imgSize(24, 24);
+  const size_t maxLabelCount = 4;
+  const float maxSquaredDistanceBetweenVoxels = 10.0f * 10.0f;
+  LabelSmoother_CPU fullSmoother(maxLabelCount, maxSquaredDistanceBetweenVoxels, false);
+  LabelSmoother_CPU incrementalSmoother(maxLabelCount, maxSquaredDistanceBetweenVoxels, true);
+
+  // Make some holes in an otherwise uniformly labelled surface. The isolated holes in the interior have 8 labelled neighbours, and
+  // should be filled in; the holes on the corner and the border (with 3 and 5 labelled neighbours) and the 2x2 hole (whose pixels
+  // each have 5 labelled neighbours) have too few labelled neighbours, and should remain.
+  const std::vector<Vector2i> unfillableHoles = list_of
+    (Vector2i(0, 0))
+    (Vector2i(23, 12))
+    (Vector2i(15, 15))(Vector2i(16, 15))(Vector2i(15, 16))(Vector2i(16, 16));
+  std::vector<Vector2i> holes = unfillableHoles;
+  holes.push_back(Vector2i(5, 5));
+  holes.push_back(Vector2i(10, 7));
+
+  Plane full(imgSize), incremental(imgSize);
+  label_all_but(full, holes);
+  label_all_but(incremental, holes);
+
+  fullSmoother.smooth_labels(&full.raycastResult, &full.scene);
+  incrementalSmoother.smooth_labels(&incremental.raycastResult, &incremental.scene);
+  check_labels(full, incremental, unfillableHoles);
+
+  // If nothing has changed, a further pass should not change anything.
+  incrementalSmoother.smooth_labels(&incremental.raycastResult, &incremental.scene);
+  check_labels(full, incremental, unfillableHoles);
+
+  // If a new hole appears, the next pass should fill it in.
+  full.get_label(8, 18) = SpaintVoxel::PackedLabel();
+  incremental.get_label(8, 18) = SpaintVoxel::PackedLabel();
+  fullSmoother.smooth_labels(&full.raycastResult, &full.scene);
+  incrementalSmoother.smooth_labels(&incremental.raycastResult, &incremental.scene);
+  check_labels(full, incremental, unfillableHoles);
+
+  // If one of the 2x2 hole's neighbours loses its label, the next pass should fill it in again, and the 2x2 hole should remain.
+  full.get_label(14, 14) = SpaintVoxel::PackedLabel(0, SpaintVoxel::LG_PROPAGATED);
+  incremental.get_label(14, 14) = SpaintVoxel::PackedLabel(0, SpaintVoxel::LG_PROPAGATED);
+  fullSmoother.smooth_labels(&full.raycastResult, &full.scene);
+  incrementalSmoother.smooth_labels(&incremental.raycastResult, &incremental.scene);
+  check_labels(full, incremental, unfillableHoles);
+
+  // If one of the 2x2 hole's pixels is labelled, each of its other pixels should then have enough labelled neighbours to be filled in,
+  // even though they have not changed themselves.
+  full.get_label(16, 16) = SpaintVoxel::PackedLabel(1, SpaintVoxel::LG_USER);
+  incremental.get_label(16, 16) = SpaintVoxel::PackedLabel(1, SpaintVoxel::LG_USER);
+  fullSmoother.smooth_labels(&full.raycastResult, &full.scene);
+  incrementalSmoother.smooth_labels(&incremental.raycastResult, &incremental.scene);
+  check_labels(full, incremental, list_of(Vector2i(0, 0))(Vector2i(23, 12)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
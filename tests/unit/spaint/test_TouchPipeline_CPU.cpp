@@ -0,0 +1,417 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <boost/assign/list_of.hpp>
+using boost::assign::list_of;
+
+#include <arrayfire.h>
+
+#include <spaint/touch/cpu/TouchPipeline_CPU.h>
+using namespace spaint;
+
+#include <tvgutil/numbers/RandomNumberGenerator.h>
+using namespace tvgutil;
+
+//#################### CONSTANTS ####################
+
+/** The threshold (in mm) below which the raw and raycasted depths are assumed to be equal. */
+const int LOWER_DEPTH_THRESHOLD_MM = 10;
+
+//#################### HELPER FUNCTIONS ####################
+
+/**
+ * \brief Makes a pair of depth images whose absolute differences (in mm) are as specified.
+ *
+ * \param diffsInMm     The desired differences (in row-major format).
+ * \param imgSize       The size of the images.
+ * \param rawDepth      An image into which to write the raw depth image.
+ * \param depthRaycast  An image into which to write the depth raycast.
+ */
+void make_depth_images(const std::vector<float>& diffsInMm, const Vector2i& imgSize, ORFloatImage_Ptr& rawDepth, ORFloatImage_Ptr& depthRaycast)
+{
+  rawDepth.reset(new ORFloatImage(imgSize, true, false));
+  depthRaycast.reset(new ORFloatImage(imgSize, true, false));
+
+  float *rawDepthData = rawDepth->GetData(MEMORYDEVICE_CPU);
+  float *depthRaycastData = depthRaycast->GetData(MEMORYDEVICE_CPU);
+  for(int i = 0, size = imgSize.x * imgSize.y; i < size; ++i)
+  {
+    depthRaycastData[i] = 1.0f;
+    rawDepthData[i] = 1.0f - diffsInMm[i] / 1000.0f;
+  }
+}
+
+/**
+ * \brief Runs the change detection and connected-component labelling stages of a pipeline on a mask.
+ *
+ * The depth images passed to the pipeline differ by 30.5mm wherever the mask is set, and are equal elsewhere.
+ *
+ * \param pipeline        The pipeline.
+ * \param mask            The mask (in row-major format).
+ * \param imgSize         The size of the mask.
+ * \param morphKernelSize The side length of the morphological opening kernel to apply to the change mask.
+ */
+void run_on_mask(TouchPipeline_CPU& pipeline, const std::vector<unsigned char>& mask, const Vector2i& imgSize, int morphKernelSize = 3)
+{
+  std::vector<float> diffsInMm(mask.size());
+  for(size_t i = 0, size = mask.size(); i < size; ++i) diffsInMm[i] = mask[i] ? 30.5f : 0.0f;
+
+  ORFloatImage_Ptr rawDepth, depthRaycast;
+  make_depth_images(diffsInMm, imgSize, rawDepth, depthRaycast);
+  pipeline.detect_changes(rawDepth.get(), depthRaycast.get(), LOWER_DEPTH_THRESHOLD_MM, morphKernelSize);
+  pipeline.find_connected_components();
+}
+
+/**
+ * \brief Parses a hand-made image in which each row is a string, '.' denotes 0 and each digit denotes its value.
+ *
+ * \param rows    The rows of the image.
+ * \param imgSize Will be set to the size of the image.
+ * \return        The values of the image (in row-major format).
+ */
+std::vector<int> parse_image(const std::vector<std::string>& rows, Vector2i& imgSize)
+{
+  imgSize = Vector2i(static_cast<int>(rows[0].size()), static_cast<int>(rows.size()));
+  std::vector<int> values;
+  for(size_t y = 0; y < rows.size(); ++y)
+  {
+    for(size_t x = 0; x < rows[y].size(); ++x)
+    {
+      values.push_back(rows[y][x] == '.' ? 0 : rows[y][x] - '0');
+    }
+  }
+  return values;
+}
+
+/**
+ * \brief Computes the morphological opening of a binary mask with a square kernel by brute force.
+ *
+ * As with af::erode and af::dilate, only the pixels within the bounds of the mask are considered, so the
+ * mask is not eroded at the image borders.
+ */
+std::vector<unsigned char> reference_open(const std::vector<unsigned char>& mask, const Vector2i& imgSize, int kernelSize)
+{
+  const int radius = kernelSize / 2;
+  std::vector<unsigned char> eroded(mask.size()), opened(mask.size());
+
+  for(int pass = 0; pass < 2; ++pass)
+  {
+    const bool dilate = pass == 1;
+    const std::vector<unsigned char>& input = dilate ? eroded : mask;
+    std::vector<unsigned char>& output = dilate ? opened : eroded;
+
+    for(int y = 0; y < imgSize.y; ++y)
+    {
+      for(int x = 0; x < imgSize.x; ++x)
+      {
+        bool result = !dilate;
+        for(int dy = -radius; dy <= radius; ++dy)
+        {
+          for(int dx = -radius; dx <= radius; ++dx)
+          {
+            const int nx = x + dx, ny = y + dy;
+            if(nx < 0 || ny < 0 || nx >= imgSize.x || ny >= imgSize.y) continue;
+            const bool value = input[ny * imgSize.x + nx] != 0;
+            if(dilate) result = result || value;
+            else result = result && value;
+          }
+        }
+        output[y * imgSize.x + x] = result ? 1 : 0;
+      }
+    }
+  }
+
+  return opened;
+}
+
+/**
+ * \brief Makes a random binary mask in which each pixel is set with probability 0.6.
+ */
+std::vector<unsigned char> make_random_mask(const Vector2i& imgSize, RandomNumberGenerator& rng)
+{
+  std::vector<unsigned char> mask(imgSize.x * imgSize.y);
+  for(size_t i = 0, size = mask.size(); i < size; ++i) mask[i] = rng.generate_int_from_uniform(0, 9) < 6 ? 1 : 0;
+  return mask;
+}
+
+//#################### ARRAYFIRE REFERENCE FUNCTIONS ####################
+
+/**
+ * \brief Converts a row-major image to an ArrayFire array (which is column-major).
+ */
+template <typename T>
+af::array to_af(const std::vector<T>& image, const Vector2i& imgSize)
+{
+  return af::array(imgSize.x, imgSize.y, &image[0]).T();
+}
+
+/**
+ * \brief Converts an ArrayFire array (which is column-major) to a row-major image.
+ */
+template <typename T>
+std::vector<T> from_af(const af::array& arr)
+{
+  const af::array transposed = arr.T();
+  std::vector<T> image(static_cast<size_t>(transposed.elements()));
+  transposed.host(&image[0]);
+  return image;
+}
+
+/**
+ * \brief Opens a binary mask with a square kernel in the same way as TouchDetector's ArrayFire pipeline.
+ */
+std::vector<unsigned char> af_open(const std::vector<unsigned char>& mask, const Vector2i& imgSize, int kernelSize)
+{
+  af::array morphKernel = af::constant(1, kernelSize, kernelSize);
+  af::array changeMask = to_af(mask, imgSize) > 0;
+  changeMask = af::erode(changeMask, morphKernel);
+  changeMask = af::dilate(changeMask, morphKernel);
+  return from_af<unsigned char>(changeMask.as(u8));
+}
+
+/**
+ * \brief Extracts touch points from a component in the same way as TouchDetector's ArrayFire pipeline.
+ */
+std::vector<Eigen::Vector2i> af_extract_touch_points(const TouchPipeline_CPU& pipeline, int component, const Vector2i& imgSize)
+{
+  const af::array componentImage = to_af(pipeline.get_component_image(), imgSize);
+  const af::array diffRawRaycastInMm = to_af(pipeline.get_diff_raw_raycast_in_mm(), imgSize);
+
+  af::array touchMask = componentImage == component;
+  af::array diffImage = diffRawRaycastInMm * touchMask;
+  diffImage = (diffImage / 8).as(u8) * 8;
+
+  const int upperDepthThresholdMm = LOWER_DEPTH_THRESHOLD_MM + 15;
+  diffImage = (diffImage > LOWER_DEPTH_THRESHOLD_MM) && (diffImage < upperDepthThresholdMm);
+
+  af::array morphKernel = af::constant(1, 5, 5);
+  diffImage = af::erode(diffImage, morphKernel);
+  diffImage = af::dilate(diffImage, morphKernel);
+
+  const float scaleFactor = 0.3f;
+  diffImage = af::resize(scaleFactor, diffImage);
+
+  std::vector<Eigen::Vector2i> touchPoints;
+  af::array touchIndicesImage = af::where(diffImage);
+  if(touchIndicesImage.elements() == 0) return touchPoints;
+
+  const int resizedDiffHeight = static_cast<int>(imgSize.y * scaleFactor);
+  std::vector<int> touchIndices(static_cast<size_t>(touchIndicesImage.elements()));
+  touchIndicesImage.as(s32).host(&touchIndices[0]);
+  for(size_t i = 0, size = touchIndices.size(); i < size; ++i)
+  {
+    Eigen::Vector2f point(touchIndices[i] / resizedDiffHeight, touchIndices[i] % resizedDiffHeight);
+    touchPoints.push_back((point / scaleFactor).cast<int>());
+  }
+
+  return touchPoints;
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_TouchPipeline_CPU)
+
+BOOST_AUTO_TEST_CASE(labelling_test)
+{
+  // Each digit denotes the component to which the pixel should belong. The components are numbered in column-major order of their
+  // first appearance (as ArrayFire numbers them), rather than in row-major order (which would swap components 2 and 3). Component 2
+  // is U-shaped, so its two arms initially receive different labels that must be merged. Components 1 and 2 only touch diagonally,
+  // and so are separate under 4-connectivity. All of the components are unions of 3x3 squares, so opening the mask leaves it
+  // unchanged (provided that the image borders do not erode it).
+  Vector2i imgSize;
+  const std::vector<int> expectedComponents = parse_image(list_of<std::string>
+    ("111.........3333")
+    ("111.........3333")
+    ("111.........3333")
+    ("...222..222..333")
+    ("...222..222..333")
+    ("...222..222..333")
+    ("...222..222.....")
+    ("...22222222.....")
+    ("...22222222.....")
+    ("...22222222....."),
+    imgSize
+  );
+
+  std::vector<unsigned char> mask(expectedComponents.size());
+  for(size_t i = 0, size = mask.size(); i < size; ++i) mask[i] = expectedComponents[i] != 0 ? 1 : 0;
+
+  TouchPipeline_CPU pipeline(imgSize);
+  run_on_mask(pipeline, mask, imgSize);
+
+  BOOST_CHECK(pipeline.get_change_mask() == mask);
+  BOOST_CHECK(pipeline.get_component_image() == expectedComponents);
+
+  // Check that the components are selected in order, based on their areas (9, 48 and 21 pixels respectively).
+  BOOST_CHECK(pipeline.select_candidate_components(0, 1000) == list_of(1)(2)(3).convert_to_container<std::vector<int> >());
+  BOOST_CHECK(pipeline.select_candidate_components(10, 40) == list_of(3).convert_to_container<std::vector<int> >());
+  BOOST_CHECK(pipeline.select_candidate_components(9, 48) == list_of(1)(2)(3).convert_to_container<std::vector<int> >());
+  BOOST_CHECK(pipeline.select_candidate_components(49, 1000).empty());
+
+  // Check that the value histogram for a component counts its pixels' differences (30.5mm, truncated to 30mm), and all the other pixels as 0.
+  const std::vector<int> histogram = pipeline.calculate_value_histogram(3);
+  BOOST_CHECK_EQUAL(histogram[30], 21);
+  BOOST_CHECK_EQUAL(histogram[0], imgSize.x * imgSize.y - 21);
+}
+
+BOOST_AUTO_TEST_CASE(opening_test)
+{
+  // Opening with a 3x3 kernel should remove the thin structures (the line and the isolated pixels), but keep the 3x3 squares
+  // in the corners, since the image borders should not erode the mask.
+  Vector2i imgSize;
+  const std::vector<int> input = parse_image(list_of<std::string>
+    ("111.....1..111")
+    ("111.....1..111")
+    ("111.....1..111")
+    ("........1.....")
+    ("..1.....1.....")
+    ("111111111111..")
+    (".............1")
+    ("111..........1")
+    ("111..........1")
+    ("111..........1"),
+    imgSize
+  );
+
+  const std::vector<int> expected = parse_image(list_of<std::string>
+    ("111........111")
+    ("111........111")
+    ("111........111")
+    ("..............")
+    ("..............")
+    ("..............")
+    ("..............")
+    ("111...........")
+    ("111...........")
+    ("111..........."),
+    imgSize
+  );
+
+  std::vector<unsigned char> mask(input.begin(), input.end());
+  TouchPipeline_CPU pipeline(imgSize);
+  run_on_mask(pipeline, mask, imgSize);
+  BOOST_CHECK(pipeline.get_change_mask() == std::vector<unsigned char>(expected.begin(), expected.end()));
+}
+
+BOOST_AUTO_TEST_CASE(opening_reference_test)
+{
+  // Check that the running-count erosion and dilation match a brute-force implementation on random masks, for various kernel sizes.
+  RandomNumberGenerator rng(12345);
+  const Vector2i imgSize(23, 17);
+  const int kernelSizes[] = { 3, 5, 7, 9 };
+  for(int i = 0; i < 4; ++i)
+  {
+    for(int j = 0; j < 10; ++j)
+    {
+      const std::vector<unsigned char> mask = make_random_mask(imgSize, rng);
+      TouchPipeline_CPU pipeline(imgSize);
+      run_on_mask(pipeline, mask, imgSize, kernelSizes[i]);
+      BOOST_CHECK(pipeline.get_change_mask() == reference_open(mask, imgSize, kernelSizes[i]));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(touch_points_test)
+{
+  // Make a 20x20 image whose pixels all differ by 17.5mm (which quantizes to 16mm, and so lies within the touch range).
+  const Vector2i imgSize(20, 20);
+  ORFloatImage_Ptr rawDepth, depthRaycast;
+  make_depth_images(std::vector<float>(imgSize.x * imgSize.y, 17.5f), imgSize, rawDepth, depthRaycast);
+
+  TouchPipeline_CPU pipeline(imgSize);
+  pipeline.detect_changes(rawDepth.get(), depthRaycast.get(), LOWER_DEPTH_THRESHOLD_MM, 3);
+  pipeline.find_connected_components();
+  BOOST_REQUIRE(pipeline.select_candidate_components(0, 1000) == list_of(1).convert_to_container<std::vector<int> >());
+
+  // The touch pixels are sampled on a 6x6 grid, and the touch points should be generated in column-major order.
+  std::vector<Eigen::Vector2i> touchPoints = pipeline.extract_touch_points(1, LOWER_DEPTH_THRESHOLD_MM, 0.0f);
+  BOOST_REQUIRE_EQUAL(touchPoints.size(), 36);
+  BOOST_CHECK_EQUAL(touchPoints[0], Eigen::Vector2i(0, 0));
+  BOOST_CHECK_EQUAL(touchPoints[1], Eigen::Vector2i(0, 3));
+  BOOST_CHECK_EQUAL(touchPoints[6], Eigen::Vector2i(3, 0));
+  BOOST_CHECK_EQUAL(touchPoints[35], Eigen::Vector2i(16, 16));
+
+  // The touch mask should denote the component.
+  const unsigned char *touchMask = pipeline.get_touch_mask()->GetData(MEMORYDEVICE_CPU);
+  BOOST_CHECK_EQUAL(std::count(touchMask, touchMask + imgSize.x * imgSize.y, 1), imgSize.x * imgSize.y);
+
+  // If the minimum touch area is too large, there should be no touch points.
+  BOOST_CHECK(pipeline.extract_touch_points(1, LOWER_DEPTH_THRESHOLD_MM, 0.1f).empty());
+}
+
+BOOST_AUTO_TEST_CASE(arrayfire_opening_test)
+{
+  // Check that the running-count erosion and dilation match af::erode and af::dilate (including at the image borders).
+  RandomNumberGenerator rng(23456);
+  const Vector2i imgSize(23, 17);
+  const int kernelSizes[] = { 3, 5, 7 };
+  for(int i = 0; i < 3; ++i)
+  {
+    for(int j = 0; j < 10; ++j)
+    {
+      const std::vector<unsigned char> mask = make_random_mask(imgSize, rng);
+      TouchPipeline_CPU pipeline(imgSize);
+      run_on_mask(pipeline, mask, imgSize, kernelSizes[i]);
+      BOOST_CHECK(pipeline.get_change_mask() == af_open(mask, imgSize, kernelSizes[i]));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(arrayfire_labelling_test)
+{
+  // Check that the components (and hence the order in which the candidates are considered) match those found by af::regions.
+  RandomNumberGenerator rng(34567);
+  const Vector2i imgSize(40, 30);
+  for(int j = 0; j < 10; ++j)
+  {
+    const std::vector<unsigned char> mask = make_random_mask(imgSize, rng);
+    TouchPipeline_CPU pipeline(imgSize);
+    run_on_mask(pipeline, mask, imgSize);
+
+    const af::array changeMask = to_af(pipeline.get_change_mask(), imgSize) > 0;
+    BOOST_CHECK(pipeline.get_component_image() == from_af<int>(af::regions(changeMask).as(s32)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(arrayfire_touch_points_test)
+{
+  // Make random scenes containing rectangular regions whose differences lie either within or above the touch range,
+  // and check that the touch points extracted for each component match those extracted by the ArrayFire pipeline.
+  RandomNumberGenerator rng(45678);
+  const Vector2i imgSize(64, 48);
+  for(int j = 0; j < 10; ++j)
+  {
+    std::vector<float> diffsInMm(imgSize.x * imgSize.y, 0.0f);
+    for(int k = 0; k < 6; ++k)
+    {
+      const int x0 = rng.generate_int_from_uniform(0, imgSize.x - 1), y0 = rng.generate_int_from_uniform(0, imgSize.y - 1);
+      const int x1 = std::min(x0 + rng.generate_int_from_uniform(3, 25), imgSize.x), y1 = std::min(y0 + rng.generate_int_from_uniform(3, 25), imgSize.y);
+      const float diffInMm = rng.generate_real_from_uniform<float>(11.0f, 40.0f);
+      for(int y = y0; y < y1; ++y)
+      {
+        for(int x = x0; x < x1; ++x) diffsInMm[y * imgSize.x + x] = diffInMm;
+      }
+    }
+
+    ORFloatImage_Ptr rawDepth, depthRaycast;
+    make_depth_images(diffsInMm, imgSize, rawDepth, depthRaycast);
+
+    TouchPipeline_CPU pipeline(imgSize);
+    pipeline.detect_changes(rawDepth.get(), depthRaycast.get(), LOWER_DEPTH_THRESHOLD_MM, 3);
+    pipeline.find_connected_components();
+
+    const std::vector<int> candidates = pipeline.select_candidate_components(0, imgSize.x * imgSize.y);
+    for(size_t i = 0, size = candidates.size(); i < size; ++i)
+    {
+      const std::vector<Eigen::Vector2i> expected = af_extract_touch_points(pipeline, candidates[i], imgSize);
+      const std::vector<Eigen::Vector2i> actual = pipeline.extract_touch_points(candidates[i], LOWER_DEPTH_THRESHOLD_MM, 0.0f);
+      BOOST_CHECK(actual == expected);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
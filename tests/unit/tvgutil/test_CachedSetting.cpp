@@ -0,0 +1,90 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <tvgutil/misc/CachedSetting.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+void read_setting(const CachedSetting<int> *setting, size_t count, bool *valid)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    const int value = setting->get();
+    if(value != 1 && value != 2) *valid = false;
+  }
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_CachedSetting)
+
+BOOST_AUTO_TEST_CASE(get_test)
+{
+  SettingsContainer_Ptr settings(new SettingsContainer);
+  settings->add_value("Foo", "23");
+
+  CachedSetting<int> foo(settings, "Foo", 0);
+  CachedSetting<int> bar(settings, "Bar", 9);
+  BOOST_CHECK_EQUAL(foo.get(), 23);
+  BOOST_CHECK_EQUAL(*bar, 9);
+
+  // Settings that are added after the cached setting has been constructed should be picked up.
+  settings->add_value("Bar", "84");
+  BOOST_CHECK_EQUAL(bar.get(), 84);
+
+  // Values that are subsequently appended should not change the first value.
+  settings->add_value("Foo", "17");
+  BOOST_CHECK_EQUAL(foo.get(), 23);
+
+  // Values that are explicitly set should replace the existing values.
+  settings->set_value("Foo", "17");
+  BOOST_CHECK_EQUAL(foo.get(), 17);
+  BOOST_CHECK_EQUAL(settings->get_values<int>("Foo").size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(reference_test)
+{
+  SettingsContainer_Ptr settings(new SettingsContainer);
+  settings->add_value("Foo", "Bar");
+
+  CachedSetting<std::string> foo(settings, "Foo", "");
+  const std::string& value = foo.get();
+
+  // Reading the setting again should return a reference to the same cached value, even if other settings have changed in the meantime.
+  BOOST_CHECK_EQUAL(&foo.get(), &value);
+  settings->add_value("Baz", "1");
+  BOOST_CHECK_EQUAL(&foo.get(), &value);
+
+  // Changing the setting should change the value returned, but references to the old value should remain valid.
+  settings->set_value("Foo", "Wibble");
+  BOOST_CHECK_EQUAL(foo.get(), "Wibble");
+  BOOST_CHECK_EQUAL(value, "Bar");
+}
+
+BOOST_AUTO_TEST_CASE(multithreaded_get_test)
+{
+  SettingsContainer_Ptr settings(new SettingsContainer);
+  settings->add_value("Foo", "1");
+  CachedSetting<int> foo(settings, "Foo", 0);
+
+  // Read the setting from several threads whilst it is repeatedly refreshed (the revision changes without the value changing).
+  const size_t threadCount = 4, readCount = 10000;
+  bool valid[threadCount] = { true, true, true, true };
+  boost::thread_group threads;
+  for(size_t i = 0; i < threadCount; ++i)
+  {
+    threads.create_thread(boost::bind(read_setting, &foo, readCount, &valid[i]));
+  }
+
+  for(size_t i = 0; i < 1000; ++i) settings->add_value("Bar", "0");
+  threads.join_all();
+
+  for(size_t i = 0; i < threadCount; ++i) BOOST_CHECK(valid[i]);
+  BOOST_CHECK_EQUAL(foo.get(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
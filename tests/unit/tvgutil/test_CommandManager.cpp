@@ -30,6 +30,41 @@ struct TestCommand : Command
   }
 };
 
+struct SizedCommand : Command
+{
+  std::string m_executeText;
+  size_t m_memoryUsage;
+  std::string& m_output;
+  std::string m_undoText;
+
+  SizedCommand(std::string& output, const std::string& executeText, const std::string& undoText, size_t memoryUsage, const std::string& description)
+  : Command(description), m_executeText(executeText), m_memoryUsage(memoryUsage), m_output(output), m_undoText(undoText)
+  {}
+
+  virtual void execute() const
+  {
+    m_output += m_executeText;
+  }
+
+  virtual size_t get_memory_usage() const
+  {
+    return m_memoryUsage;
+  }
+
+  virtual Command_CPtr merge_with(const Command_CPtr& next, const std::string& description) const
+  {
+    // Commands with the same execute text can be merged into a single command that uses the memory of both.
+    const SizedCommand *nextSized = dynamic_cast<const SizedCommand*>(next.get());
+    if(!nextSized || nextSized->m_executeText != m_executeText) return Command_CPtr();
+    return Command_CPtr(new SizedCommand(m_output, m_executeText, m_undoText, m_memoryUsage + nextSized->m_memoryUsage, description));
+  }
+
+  virtual void undo() const
+  {
+    m_output += m_undoText;
+  }
+};
+
 BOOST_AUTO_TEST_SUITE(test_CommandManager)
 
 BOOST_AUTO_TEST_CASE(basic_test)
@@ -196,6 +231,71 @@ BOOST_AUTO_TEST_CASE(historysize_test)
     BOOST_CHECK_EQUAL(cm2.undone_count(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(memorybudget_test)
+{
+  std::string output;
+
+  Command_CPtr c1(new SizedCommand(output, "E1", "U1", 40, ""));
+  Command_CPtr c2(new SizedCommand(output, "E2", "U2", 40, ""));
+  Command_CPtr c3(new SizedCommand(output, "E3", "U3", 40, ""));
+  Command_CPtr big(new SizedCommand(output, "EB", "UB", 200, ""));
+
+  CommandManager cm(10, 100);
+
+  // Test that the oldest commands are discarded when the history exceeds its memory budget.
+  cm.execute_command(c1);
+  cm.execute_command(c2);
+    BOOST_CHECK_EQUAL(cm.executed_count(), 2);
+    BOOST_CHECK_EQUAL(cm.memory_usage(), 80);
+  cm.execute_command(c3);
+    BOOST_CHECK_EQUAL(cm.executed_count(), 2);
+    BOOST_CHECK_EQUAL(cm.memory_usage(), 80);
+  cm.undo();
+  cm.undo();
+    BOOST_CHECK_EQUAL(output, "E1E2E3U3U2");
+    BOOST_CHECK_EQUAL(cm.can_undo(), false);
+
+  // Test that the most recent command is always kept, even if it exceeds the budget on its own.
+  cm.execute_command(big);
+    BOOST_CHECK_EQUAL(cm.executed_count(), 1);
+    BOOST_CHECK_EQUAL(cm.undone_count(), 0);
+    BOOST_CHECK_EQUAL(cm.memory_usage(), 200);
+}
+
+BOOST_AUTO_TEST_CASE(merge_test)
+{
+  std::string output;
+
+  Command_CPtr begin(new TestCommand(output, "Eb", "Ub", "Begin"));
+  Command_CPtr middle(new SizedCommand(output, "Em", "Um", 10, "Middle"));
+  Command_CPtr other(new SizedCommand(output, "Eo", "Uo", 10, "Middle"));
+  Command_CPtr end(new TestCommand(output, "Ee", "Ue", "End"));
+
+  std::map<std::string,std::string> precursors = map_list_of("Begin","Middle")("Middle","Middle");
+
+  CommandManager cm;
+
+  // Test that compressible commands that can be merged are, and that those that can't are sequenced instead.
+  cm.execute_command(begin);
+  cm.execute_compressible_command(middle, precursors);
+  cm.execute_compressible_command(middle, precursors);
+  cm.execute_compressible_command(middle, precursors);
+    BOOST_CHECK_EQUAL(output, "EbEmEmEm");
+    BOOST_CHECK_EQUAL(cm.executed_count(), 1);
+    BOOST_CHECK_EQUAL(cm.memory_usage(), 30);
+  cm.execute_compressible_command(other, precursors);
+  cm.execute_compressible_command(end, precursors);
+    BOOST_CHECK_EQUAL(output, "EbEmEmEmEoEe");
+    BOOST_CHECK_EQUAL(cm.executed_count(), 1);
+    BOOST_CHECK_EQUAL(cm.memory_usage(), 40);
+
+  // The merged middle commands are undone as a single command.
+  cm.undo();
+    BOOST_CHECK_EQUAL(output, "EbEmEmEmEoEeUeUoUmUb");
+  cm.redo();
+    BOOST_CHECK_EQUAL(output, "EbEmEmEmEoEeUeUoUmUbEbEmEoEe");
+}
+
 BOOST_AUTO_TEST_CASE(seq_test)
 {
   std::string output;
@@ -0,0 +1,111 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <tvgutil/misc/ConcurrencyUtil.h>
+using namespace tvgutil;
+
+//#################### HELPER TYPES ####################
+
+struct CustomError : std::runtime_error
+{
+  explicit CustomError(const std::string& message)
+  : std::runtime_error(message)
+  {}
+};
+
+//#################### HELPER FUNCTIONS ####################
+
+void count_run(std::vector<int>& runCounts, boost::mutex& mutex, size_t i)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  ++runCounts[i];
+}
+
+void fail_on_task(size_t failingTask, size_t i)
+{
+  if(i == failingTask) throw std::runtime_error("Task failed");
+}
+
+void fail_on_task_with_custom_error(size_t failingTask, size_t i)
+{
+  if(i == failingTask) throw CustomError("Task failed");
+}
+
+void fail_on_task_with_int(size_t failingTask, size_t i)
+{
+  if(i == failingTask) throw 23;
+}
+
+void count_run_with_offset(std::vector<int>& runCounts, boost::mutex& mutex, size_t offset, size_t i)
+{
+  count_run(runCounts, mutex, offset + i);
+}
+
+void run_nested_tasks(std::vector<int>& runCounts, boost::mutex& mutex, size_t innerTaskCount, size_t i)
+{
+  ConcurrencyUtil::run_tasks(innerTaskCount, 4, boost::bind(count_run_with_offset, boost::ref(runCounts), boost::ref(mutex), i * innerTaskCount, _1));
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_ConcurrencyUtil)
+
+BOOST_AUTO_TEST_CASE(test_run_tasks)
+{
+  const size_t taskCount = 1000;
+  const size_t threadCounts[] = { 0, 1, 4, 2000 };
+  for(size_t i = 0; i < 4; ++i)
+  {
+    std::vector<int> runCounts(taskCount, 0);
+    boost::mutex mutex;
+    ConcurrencyUtil::run_tasks(taskCount, threadCounts[i], boost::bind(count_run, boost::ref(runCounts), boost::ref(mutex), _1));
+
+    // Check that each task was run exactly once.
+    for(size_t j = 0; j < taskCount; ++j)
+    {
+      BOOST_CHECK_EQUAL(runCounts[j], 1);
+    }
+  }
+
+  // Check that running no tasks is fine.
+  ConcurrencyUtil::run_tasks(0, 4, boost::bind(fail_on_task, 0, _1));
+}
+
+BOOST_AUTO_TEST_CASE(test_run_tasks_error)
+{
+  BOOST_CHECK_THROW(ConcurrencyUtil::run_tasks(100, 1, boost::bind(fail_on_task, 50, _1)), std::runtime_error);
+  BOOST_CHECK_THROW(ConcurrencyUtil::run_tasks(100, 4, boost::bind(fail_on_task, 50, _1)), std::runtime_error);
+
+  // Check that the type of the exception thrown by the failing task is preserved.
+  BOOST_CHECK_THROW(ConcurrencyUtil::run_tasks(100, 1, boost::bind(fail_on_task_with_custom_error, 50, _1)), CustomError);
+  BOOST_CHECK_THROW(ConcurrencyUtil::run_tasks(100, 4, boost::bind(fail_on_task_with_custom_error, 50, _1)), CustomError);
+
+  // Check that exceptions that do not derive from std::exception are also propagated to the caller.
+  BOOST_CHECK_THROW(ConcurrencyUtil::run_tasks(100, 4, boost::bind(fail_on_task_with_int, 50, _1)), int);
+}
+
+BOOST_AUTO_TEST_CASE(test_run_tasks_nested)
+{
+  // Check that tasks that themselves run tasks concurrently neither deadlock nor miss any of their inner tasks.
+  const size_t outerTaskCount = 8, innerTaskCount = 100;
+  for(int k = 0; k < 10; ++k)
+  {
+    std::vector<int> runCounts(outerTaskCount * innerTaskCount, 0);
+    boost::mutex mutex;
+    ConcurrencyUtil::run_tasks(outerTaskCount, 4, boost::bind(run_nested_tasks, boost::ref(runCounts), boost::ref(mutex), innerTaskCount, _1));
+
+    for(size_t j = 0, size = runCounts.size(); j < size; ++j)
+    {
+      BOOST_CHECK_EQUAL(runCounts[j], 1);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,84 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include <tvgutil/numbers/CounterBasedRandomNumberGenerator.h>
+using namespace tvgutil;
+
+BOOST_AUTO_TEST_SUITE(test_CounterBasedRandomNumberGenerator)
+
+BOOST_AUTO_TEST_CASE(philox_test)
+{
+  // Check the output against the known-answer tests for Philox4x32-10 from the Random123 library.
+  {
+    const boost::uint32_t key[2] = { 0, 0 };
+    boost::uint32_t counter[4] = { 0, 0, 0, 0 };
+    CounterBasedRandomNumberGenerator::philox(key, counter);
+    BOOST_CHECK_EQUAL(counter[0], 0x6627e8d5u);
+    BOOST_CHECK_EQUAL(counter[1], 0xe169c58du);
+    BOOST_CHECK_EQUAL(counter[2], 0xbc57ac4cu);
+    BOOST_CHECK_EQUAL(counter[3], 0x9b00dbd8u);
+  }
+
+  {
+    const boost::uint32_t key[2] = { 0xffffffff, 0xffffffff };
+    boost::uint32_t counter[4] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+    CounterBasedRandomNumberGenerator::philox(key, counter);
+    BOOST_CHECK_EQUAL(counter[0], 0x408f276du);
+    BOOST_CHECK_EQUAL(counter[1], 0x41c83b0eu);
+    BOOST_CHECK_EQUAL(counter[2], 0xa20bc7c6u);
+    BOOST_CHECK_EQUAL(counter[3], 0x6d5451fdu);
+  }
+
+  {
+    const boost::uint32_t key[2] = { 0xa4093822, 0x299f31d0 };
+    boost::uint32_t counter[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 };
+    CounterBasedRandomNumberGenerator::philox(key, counter);
+    BOOST_CHECK_EQUAL(counter[0], 0xd16cfe09u);
+    BOOST_CHECK_EQUAL(counter[1], 0x94fdccebu);
+    BOOST_CHECK_EQUAL(counter[2], 0x5001e420u);
+    BOOST_CHECK_EQUAL(counter[3], 0x24126ea1u);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(generate_from_gaussian_test)
+{
+  CounterBasedRandomNumberGenerator rng(12345);
+
+  // Check that the numbers generated for a given stream and index are reproducible, and differ between streams.
+  float a[4], b[4];
+  rng.generate_from_gaussian(7, 23, 0.0f, 1.0f, a);
+  rng.generate_from_gaussian(7, 23, 0.0f, 1.0f, b);
+  BOOST_CHECK_EQUAL_COLLECTIONS(a, a + 4, b, b + 4);
+
+  rng.generate_from_gaussian(8, 23, 0.0f, 1.0f, b);
+  BOOST_CHECK(a[0] != b[0]);
+
+  // Check that the generated numbers have roughly the right mean and standard deviation.
+  const int count = 100000;
+  const float mean = 2.0f, sigma = 0.5f;
+  double sum = 0.0, sumOfSquares = 0.0;
+  for(int i = 0; i < count; ++i)
+  {
+    rng.generate_from_gaussian(0, i, mean, sigma, a);
+    for(int j = 0; j < 4; ++j)
+    {
+      sum += a[j];
+      sumOfSquares += a[j] * a[j];
+    }
+  }
+
+  const double sampleMean = sum / (4 * count);
+  const double sampleSigma = sqrt(sumOfSquares / (4 * count) - sampleMean * sampleMean);
+  BOOST_CHECK_CLOSE(sampleMean, mean, 1.0);
+  BOOST_CHECK_CLOSE(sampleSigma, sigma, 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(to_unit_interval_test)
+{
+  BOOST_CHECK_GT(CounterBasedRandomNumberGenerator::to_unit_interval(0), 0.0f);
+  BOOST_CHECK_EQUAL(CounterBasedRandomNumberGenerator::to_unit_interval(0xffffffff), 1.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
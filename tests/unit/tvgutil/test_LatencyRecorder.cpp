@@ -0,0 +1,120 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <tvgutil/timing/LatencyRecorder.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+void record_latencies(LatencyRecorder& recorder, const std::string& stage, size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    recorder.record_latency(stage, static_cast<double>(i + 1));
+    recorder.add_to_counter("Frames");
+  }
+}
+
+//#################### TESTS ####################
+
+BOOST_AUTO_TEST_SUITE(test_LatencyRecorder)
+
+BOOST_AUTO_TEST_CASE(percentile_test)
+{
+  LatencyRecorder recorder;
+
+  // Record the latencies 100, 99, ..., 1 for stage B, followed by 1, 2, ..., 10 for stage A.
+  for(int i = 100; i >= 1; --i) recorder.record_latency("B", i);
+  for(int i = 1; i <= 10; ++i) recorder.record_latency("A", i);
+
+  // The stages should be reported in the order in which they were first recorded, with nearest-rank percentiles.
+  std::vector<LatencyRecorder::StageStatistics> stats = recorder.compute_statistics();
+  BOOST_REQUIRE_EQUAL(stats.size(), 2);
+
+  BOOST_CHECK_EQUAL(stats[0].name, "B");
+  BOOST_CHECK_EQUAL(stats[0].count, 100);
+  BOOST_CHECK_CLOSE(stats[0].meanMs, 50.5, 1e-6);
+  BOOST_CHECK_EQUAL(stats[0].p50Ms, 50.0);
+  BOOST_CHECK_EQUAL(stats[0].p95Ms, 95.0);
+  BOOST_CHECK_EQUAL(stats[0].p99Ms, 99.0);
+  BOOST_CHECK_EQUAL(stats[0].maxMs, 100.0);
+
+  BOOST_CHECK_EQUAL(stats[1].name, "A");
+  BOOST_CHECK_EQUAL(stats[1].count, 10);
+  BOOST_CHECK_EQUAL(stats[1].p50Ms, 5.0);
+  BOOST_CHECK_EQUAL(stats[1].p95Ms, 10.0);
+  BOOST_CHECK_EQUAL(stats[1].maxMs, 10.0);
+}
+
+BOOST_AUTO_TEST_CASE(counter_test)
+{
+  LatencyRecorder recorder;
+  BOOST_CHECK_EQUAL(recorder.get_counter("Dropped"), 0);
+
+  recorder.add_to_counter("Dropped");
+  recorder.add_to_counter("Dropped", 4);
+  recorder.add_to_counter("Missed", 2);
+  BOOST_CHECK_EQUAL(recorder.get_counter("Dropped"), 5);
+  BOOST_CHECK_EQUAL(recorder.get_counter("Missed"), 2);
+  BOOST_CHECK_EQUAL(recorder.get_counters().size(), 2);
+
+  std::ostringstream oss;
+  recorder.output_report(oss);
+  BOOST_CHECK(oss.str().find("Dropped") != std::string::npos);
+  BOOST_CHECK(oss.str().find("Missed") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(multithreaded_test)
+{
+  LatencyRecorder recorder;
+  const size_t threadCount = 4, sampleCount = 1000;
+  boost::thread_group threads;
+  for(size_t i = 0; i < threadCount; ++i)
+  {
+    threads.create_thread(boost::bind(record_latencies, boost::ref(recorder), i % 2 == 0 ? "Even" : "Odd", sampleCount));
+  }
+  threads.join_all();
+
+  std::vector<LatencyRecorder::StageStatistics> stats = recorder.compute_statistics();
+  BOOST_REQUIRE_EQUAL(stats.size(), 2);
+  for(size_t i = 0; i < stats.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(stats[i].count, threadCount / 2 * sampleCount);
+    BOOST_CHECK_EQUAL(stats[i].maxMs, static_cast<double>(sampleCount));
+  }
+  BOOST_CHECK_EQUAL(recorder.get_counter("Frames"), threadCount * sampleCount);
+}
+
+BOOST_AUTO_TEST_CASE(stage_timer_test)
+{
+  LatencyRecorder_Ptr recorder(new LatencyRecorder);
+  {
+    LatencyRecorder::StageTimer timer(recorder, "Scene: ");
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    timer.finish_stage("Slow");
+    timer.finish_stage("Fast");
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+    timer.skip_stage();
+    timer.finish_stage("AfterSkip");
+  }
+
+  std::vector<LatencyRecorder::StageStatistics> stats = recorder->compute_statistics();
+  BOOST_REQUIRE_EQUAL(stats.size(), 3);
+  BOOST_CHECK_EQUAL(stats[0].name, "Scene: Slow");
+  BOOST_CHECK_EQUAL(stats[1].name, "Scene: Fast");
+  BOOST_CHECK_EQUAL(stats[2].name, "Scene: AfterSkip");
+  BOOST_CHECK(stats[0].maxMs >= 19.0);
+  BOOST_CHECK(stats[1].maxMs < stats[0].maxMs);
+  BOOST_CHECK(stats[2].maxMs < stats[0].maxMs);
+
+  // A stage timer without a recorder should do nothing.
+  LatencyRecorder::StageTimer nullTimer((LatencyRecorder_Ptr()));
+  nullTimer.finish_stage("Ignored");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
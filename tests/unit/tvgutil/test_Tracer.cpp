@@ -0,0 +1,177 @@
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <map>
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <tvgutil/timing/Tracer.h>
+using namespace tvgutil;
+
+//#################### HELPER FUNCTIONS ####################
+
+void record_nested_spans(size_t count)
+{
+  for(size_t i = 0; i < count; ++i)
+  {
+    Tracer::ScopedSpan outer("Outer");
+    Tracer::ScopedSpan inner("Inner");
+  }
+}
+
+/**
+ * \brief Enables the tracer and clears any existing events when a test starts, and disables it again when the test ends.
+ */
+struct TracerFixture
+{
+  TracerFixture()
+  {
+    Tracer::instance().set_enabled(false);
+    Tracer::instance().clear();
+    Tracer::instance().set_enabled(true);
+  }
+
+  ~TracerFixture()
+  {
+    Tracer::instance().set_enabled(false);
+  }
+};
+
+//#################### TESTS ####################
+
+BOOST_FIXTURE_TEST_SUITE(test_Tracer, TracerFixture)
+
+BOOST_AUTO_TEST_CASE(nesting_test)
+{
+  {
+    Tracer::ScopedSpan a("A");
+    {
+      Tracer::ScopedSpan b("B");
+    }
+    Tracer::ScopedSpan c("C");
+  }
+
+  // The spans complete in the order B, C, A. B and C should both be children of A, which should have no parent.
+  std::vector<Tracer::Event> events = Tracer::instance().get_events();
+  BOOST_REQUIRE_EQUAL(events.size(), 3);
+  BOOST_CHECK_EQUAL(std::strcmp(events[0].name, "B"), 0);
+  BOOST_CHECK_EQUAL(std::strcmp(events[1].name, "C"), 0);
+  BOOST_CHECK_EQUAL(std::strcmp(events[2].name, "A"), 0);
+  BOOST_CHECK_EQUAL(events[0].parentId, events[2].id);
+  BOOST_CHECK_EQUAL(events[1].parentId, events[2].id);
+  BOOST_CHECK_EQUAL(events[2].parentId, 0);
+  BOOST_CHECK(events[2].startNs <= events[0].startNs && events[0].endNs <= events[2].endNs);
+}
+
+BOOST_AUTO_TEST_CASE(non_nested_test)
+{
+  // Open A and then B, but close A before B (as can happen with AverageTimer), and then open C.
+  Tracer& tracer = Tracer::instance();
+  boost::uint64_t idA, idB, idC, parentA, parentB, parentC;
+  boost::int64_t startA, startB, startC;
+  Tracer::ThreadBuffer *bufferA = tracer.begin_span(idA, parentA, startA);
+  Tracer::ThreadBuffer *bufferB = tracer.begin_span(idB, parentB, startB);
+  Tracer::end_span(bufferA, "A", idA, parentA, startA);
+  Tracer::ThreadBuffer *bufferC = tracer.begin_span(idC, parentC, startC);
+  Tracer::end_span(bufferC, "C", idC, parentC, startC);
+  Tracer::end_span(bufferB, "B", idB, parentB, startB);
+
+  // B's parent should be A, since A was open when B began. C's parent should be B rather than A, since A had been closed when C began.
+  BOOST_CHECK_EQUAL(parentA, 0);
+  BOOST_CHECK_EQUAL(parentB, idA);
+  BOOST_CHECK_EQUAL(parentC, idB);
+  BOOST_CHECK_EQUAL(tracer.non_nested_span_count(), 1);
+
+  // Once all of the spans have been closed, a new span should have no parent.
+  {
+    Tracer::ScopedSpan d("D");
+  }
+  std::vector<Tracer::Event> events = tracer.get_events();
+  BOOST_REQUIRE_EQUAL(events.size(), 4);
+  BOOST_CHECK_EQUAL(std::strcmp(events[3].name, "D"), 0);
+  BOOST_CHECK_EQUAL(events[3].parentId, 0);
+}
+
+BOOST_AUTO_TEST_CASE(disabled_test)
+{
+  Tracer::instance().set_enabled(false);
+  {
+    Tracer::ScopedSpan a("A");
+  }
+  BOOST_CHECK(Tracer::instance().get_events().empty());
+}
+
+BOOST_AUTO_TEST_CASE(multithreaded_test)
+{
+  const size_t threadCount = 4, spanCount = 1000;
+  boost::thread_group threads;
+  for(size_t i = 0; i < threadCount; ++i)
+  {
+    threads.create_thread(boost::bind(record_nested_spans, spanCount));
+  }
+  threads.join_all();
+
+  // Check that every span was recorded, and that each inner span's parent is an outer span on the same thread.
+  std::vector<Tracer::Event> events = Tracer::instance().get_events();
+  BOOST_REQUIRE_EQUAL(events.size(), threadCount * spanCount * 2);
+
+  std::map<boost::uint64_t,const Tracer::Event*> eventsByID;
+  for(size_t i = 0, size = events.size(); i < size; ++i)
+  {
+    BOOST_CHECK(eventsByID.insert(std::make_pair(events[i].id, &events[i])).second);
+  }
+
+  for(size_t i = 0, size = events.size(); i < size; ++i)
+  {
+    if(std::strcmp(events[i].name, "Inner") != 0) continue;
+    const Tracer::Event *parent = eventsByID[events[i].parentId];
+    BOOST_REQUIRE(parent != NULL);
+    BOOST_CHECK_EQUAL(std::strcmp(parent->name, "Outer"), 0);
+    BOOST_CHECK_EQUAL(parent->threadIndex, events[i].threadIndex);
+  }
+
+  // Check the statistics.
+  std::vector<Tracer::SpanStatistics> stats = Tracer::instance().compute_statistics();
+  BOOST_REQUIRE_EQUAL(stats.size(), 2);
+  BOOST_CHECK_EQUAL(stats[0].name, "Inner");
+  BOOST_CHECK_EQUAL(stats[1].name, "Outer");
+  for(size_t i = 0; i < stats.size(); ++i)
+  {
+    BOOST_CHECK_EQUAL(stats[i].count, threadCount * spanCount);
+    BOOST_CHECK(stats[i].p50Ns <= stats[i].p95Ns && stats[i].p95Ns <= stats[i].p99Ns && stats[i].p99Ns <= stats[i].maxNs);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(chrome_trace_test)
+{
+  {
+    Tracer::ScopedSpan a(Tracer::instance().intern("Quoted \"name\""));
+  }
+
+  std::ostringstream oss;
+  Tracer::instance().write_chrome_trace(oss);
+  const std::string trace = oss.str();
+  BOOST_CHECK(trace.find("{\"traceEvents\":[") == 0);
+  BOOST_CHECK(trace.find("\"name\":\"Quoted \\\"name\\\"\",\"ph\":\"X\"") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(overhead_test)
+{
+  // Measure the average cost of recording a span (this is for information only, since timings are unreliable on shared machines).
+  const size_t spanCount = 100000;
+  Tracer::instance().set_buffer_capacity(spanCount);
+
+  boost::chrono::steady_clock::time_point t0 = boost::chrono::steady_clock::now();
+  boost::thread t(boost::bind(record_nested_spans, spanCount / 2));
+  t.join();
+  boost::chrono::steady_clock::time_point t1 = boost::chrono::steady_clock::now();
+
+  BOOST_TEST_MESSAGE("Average cost per span: " << boost::chrono::duration_cast<boost::chrono::nanoseconds>(t1 - t0).count() / spanCount << "ns");
+  BOOST_CHECK_EQUAL(Tracer::instance().dropped_event_count(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()